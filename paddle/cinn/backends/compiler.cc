@@ -392,6 +392,24 @@ void Compiler::ExportObject(const std::string& path) {
   engine_->ExportObject(path);
 }
 
+bool Compiler::LoadObject(const std::string& object_code) {
+  return target_.arch.Match(
+      [&](common::X86Arch) { return engine_->AddObject(object_code); },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) { return false; });
+}
+
+std::string Compiler::GetCompiledObject() const {
+  return target_.arch.Match(
+      [&](common::X86Arch) { return engine_->GetCompiledObject(); },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) { return std::string(); });
+}
+
 void* Compiler::Lookup(absl::string_view fn_name) {
   CHECK(engine_);
   if (engine_->Lookup(fn_name) != nullptr) {
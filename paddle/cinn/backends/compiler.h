@@ -111,8 +111,26 @@ class Compiler final {
 
   void EndCompile();
 
+  /**
+   * Write the object code of GetCompiledObject() to \p path. Only supported
+   * on x86, after EndCompile() and a Lookup(); fails if there is no object.
+   */
   void ExportObject(const std::string& path);
 
+  /**
+   * Link the object code of a module compiled earlier, e.g. by another
+   * process, instead of building it. Only supported on x86.
+   * @return false if the object can not be linked.
+   */
+  bool LoadObject(const std::string& object_code);
+
+  /**
+   * Retrieve the object code of the modules compiled by EndCompile(). Only
+   * supported on x86, and only after a Lookup() materialized the modules.
+   * @return the object code or an empty string if not available.
+   */
+  std::string GetCompiledObject() const;
+
   std::string GetSourceCode(const ir::Module& module);
 
   void BuildDefault(const ir::Module& module);
@@ -17,6 +17,8 @@
 #include <absl/strings/string_view.h>
 #include <llvm/ADT/Triple.h>
 #include <llvm/AsmParser/Parser.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/Config/llvm-config.h>
 #include <llvm/ExecutionEngine/JITSymbol.h>
 #include <llvm/ExecutionEngine/Orc/Core.h>
@@ -64,6 +66,7 @@
 #include "paddle/cinn/ir/ir_printer.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 #include "paddle/cinn/utils/profiler.h"
+#include "paddle/common/enforce.h"
 
 namespace cinn::backends {
 namespace {
@@ -86,9 +89,31 @@ void InitializeLLVMPasses() {
   // llvm::initializeTarget(registry);
   // llvm::initializeCodeGenPreparePass(registry);
 }
+
+// Every engine starts from the runtime module. Parsing its textual IR takes
+// long compared to small kernels, so it is parsed once and every engine loads
+// it from bitcode instead.
+std::unique_ptr<llvm::Module> LoadRuntimeModule(llvm::LLVMContext *ctx) {
+  static const std::string runtime_bitcode = [] {
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        AsStringRef(backends::kRuntimeLlvmIr), error, context);
+    CHECK(module) << "Failed to parse the cinn runtime llvm ir: "
+                  << error.getMessage().str();
+    std::string bitcode;
+    llvm::raw_string_ostream os(bitcode);
+    llvm::WriteBitcodeToFile(*module, os);
+    os.flush();
+    return bitcode;
+  }();
+  return llvm::cantFail(llvm::parseBitcodeFile(
+      llvm::MemoryBufferRef(runtime_bitcode, "cinn_runtime"), *ctx));
+}
 }  // namespace
 void NaiveObjectCache::notifyObjectCompiled(const llvm::Module *m,
                                             llvm::MemoryBufferRef obj_buffer) {
+  std::lock_guard<std::mutex> lock(mu_);
   cached_objects_[m->getModuleIdentifier()] =
       llvm::MemoryBuffer::getMemBufferCopy(obj_buffer.getBuffer(),
                                            obj_buffer.getBufferIdentifier());
@@ -96,6 +121,7 @@ void NaiveObjectCache::notifyObjectCompiled(const llvm::Module *m,
 
 std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
     const llvm::Module *m) {
+  std::lock_guard<std::mutex> lock(mu_);
   auto it = cached_objects_.find(m->getModuleIdentifier());
   if (it == cached_objects_.end()) {
     VLOG(1) << "No object for " << m->getModuleIdentifier()
@@ -107,6 +133,14 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
   return llvm::MemoryBuffer::getMemBuffer(it->second->getMemBufferRef());
 }
 
+std::string NaiveObjectCache::GetObjectCode(
+    const std::string &module_id) const {
+  std::lock_guard<std::mutex> lock(mu_);
+  auto it = cached_objects_.find(module_id);
+  if (it == cached_objects_.end()) return "";
+  return it->second->getBuffer().str();
+}
+
 /*static*/ std::unique_ptr<ExecutionEngine> ExecutionEngine::Create(
     const ExecutionOptions &config) {
   VLOG(1) << "===================== Create CINN ExecutionEngine begin "
@@ -162,9 +196,12 @@ std::unique_ptr<llvm::MemoryBuffer> NaiveObjectCache::getObject(
              "====================";
   engine->ctx = std::make_unique<llvm::LLVMContext>();
   engine->b = std::make_unique<llvm::IRBuilder<>>(*engine->ctx);
-  llvm::SMDiagnostic error;
-  engine->m = llvm::parseAssemblyString(
-      AsStringRef(backends::kRuntimeLlvmIr), error, *engine->ctx);
+  engine->m = LoadRuntimeModule(engine->ctx.get());
+  for (const auto &fn : *engine->m) {
+    if (!fn.isDeclaration()) {
+      engine->runtime_fn_names_.push_back(fn.getName().str());
+    }
+  }
 
   return engine;
 }
@@ -179,23 +216,6 @@ void ExecutionEngine::Link(const ir::Module &module) {
   VLOG(3) << "ir_emitter->Compile(module) Succeed!";
   CHECK(!llvm::verifyModule(*m, &llvm::errs())) << "Invalid module found";
 
-  auto machine = std::move(llvm::cantFail(
-      llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
-          .createTargetMachine()));
-  LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
-  optimize(m.get());
-  CHECK(!llvm::verifyModule(*m, &llvm::errs()))
-      << "Invalid optimized module detected";
-  for (auto &f : *m) {
-    VLOG(5) << "function: " << DumpToString(f);
-  }
-
-  llvm::raw_svector_ostream rawstream(buffer_);
-  llvm::legacy::PassManager pass_manager;
-  machine->addPassesToEmitFile(
-      pass_manager, rawstream, nullptr, llvm::CGFT_ObjectFile);
-  pass_manager.run(*m);
-
   if (VLOG_IS_ON(5)) {
     VLOG(5) << "======= dump jit execution session ======";
     std::string buffer;
@@ -240,13 +260,72 @@ void ExecutionEngine::RegisterModuleRuntimeSymbols(
 }
 
 bool ExecutionEngine::AddSelfModule() {
+  OptimizeSelfModule();
+  self_module_id_ = m->getModuleIdentifier();
   return AddModule(std::move(m), std::move(ctx));
 }
 
+void ExecutionEngine::OptimizeSelfModule() {
+  utils::RecordEvent("ExecutionEngine OptimizeSelfModule",
+                     utils::EventType::kOrdinary);
+  // Only the kernels of this module call the runtime functions, and they are
+  // never looked up by name. Internal runtime functions are inlined or
+  // dropped when unused, instead of being optimized and compiled by every
+  // engine.
+  for (const auto &name : runtime_fn_names_) {
+    llvm::Function *fn = m->getFunction(name);
+    if (fn != nullptr && !fn->isDeclaration()) {
+      fn->setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+  }
+
+  auto machine = std::move(llvm::cantFail(
+      llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
+          .createTargetMachine()));
+  LLVMModuleOptimizer optimize(machine.get(), 3, {}, true);
+  optimize(m.get());
+  CHECK(!llvm::verifyModule(*m, &llvm::errs()))
+      << "Invalid optimized module detected";
+  for (auto &f : *m) {
+    VLOG(5) << "function: " << DumpToString(f);
+  }
+}
+
+bool ExecutionEngine::AddObject(const std::string &object_code) {
+  utils::RecordEvent("ExecutionEngine AddObject", utils::EventType::kOrdinary);
+  auto buffer = llvm::MemoryBuffer::getMemBufferCopy(object_code,
+                                                     "cinn_cached_object");
+  if (auto err = jit_->addObjectFile(std::move(buffer))) {
+    LOG(WARNING) << "Failed to add cached object: "
+                 << llvm::toString(std::move(err));
+    return false;
+  }
+  return true;
+}
+
+std::string ExecutionEngine::GetCompiledObject() const {
+  if (self_module_id_.empty()) return "";
+  return cache_->GetObjectCode(self_module_id_);
+}
+
 void ExecutionEngine::ExportObject(const std::string &path) {
-  FILE *of = fopen(path.c_str(), "w");
-  fwrite(buffer_.data(), 1, buffer_.size(), of);
+  const std::string object_code = GetCompiledObject();
+  PADDLE_ENFORCE_EQ(
+      object_code.empty(),
+      false,
+      phi::errors::PreconditionNotMet(
+          "No object code to export to %s, the self module is compiled by "
+          "AddSelfModule() and the first Lookup().",
+          path));
+  FILE *of = fopen(path.c_str(), "wb");
+  PADDLE_ENFORCE_NOT_NULL(
+      of, phi::errors::Unavailable("Failed to open %s for writing.", path));
+  size_t written = fwrite(object_code.data(), 1, object_code.size(), of);
   fclose(of);
+  PADDLE_ENFORCE_EQ(
+      written,
+      object_code.size(),
+      phi::errors::Unavailable("Failed to write the object code to %s.", path));
 }
 
 void *ExecutionEngine::Lookup(absl::string_view name) {
@@ -56,7 +56,12 @@ class NaiveObjectCache : public llvm::ObjectCache {
                             llvm::MemoryBufferRef) override;
   std::unique_ptr<llvm::MemoryBuffer> getObject(const llvm::Module *) override;
 
+  // Returns the object code compiled for module \p module_id, or an empty
+  // string if it has not been compiled yet.
+  std::string GetObjectCode(const std::string &module_id) const;
+
  private:
+  mutable std::mutex mu_;
   llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> cached_objects_;
 };
 
@@ -78,6 +83,9 @@ class ExecutionEngine {
   template <typename CodeGenT = CodeGenLLVM>
   void Link(const ir::Module &module);
 
+  // Writes the object code of GetCompiledObject() to \p path. Fails if the
+  // self module is not compiled yet, i.e. before AddSelfModule() and a
+  // Lookup().
   void ExportObject(const std::string &path);
 
   bool AddModule(std::unique_ptr<llvm::Module> module,
@@ -87,6 +95,14 @@ class ExecutionEngine {
 
   bool AddSelfModule();
 
+  // Links a relocatable object produced by GetCompiledObject() of another
+  // engine, in place of compiling the self module.
+  bool AddObject(const std::string &object_code);
+
+  // Returns the object code of the self module. It is only available after
+  // AddSelfModule() and a Lookup() that materialized the module.
+  std::string GetCompiledObject() const;
+
  protected:
   explicit ExecutionEngine(bool enable_object_cache)
       : cache_(std::make_unique<NaiveObjectCache>()),
@@ -97,16 +113,21 @@ class ExecutionEngine {
 
   bool SetupTargetTriple(llvm::Module *module);
 
+  // Optimizes the self module once, after all the modules are linked into it.
+  void OptimizeSelfModule();
+
   // This may not be a compatible implementation.
   friend std::unique_ptr<ExecutionEngine> std::make_unique<ExecutionEngine>(
       bool &&);
 
  private:
   mutable std::mutex mu_;
-  llvm::SmallString<0> buffer_;
   std::unique_ptr<llvm::orc::LLJIT> jit_;
   std::unique_ptr<NaiveObjectCache> cache_;
   RuntimeSymbols module_symbols_;
+  std::string self_module_id_;
+  // Functions defined by the runtime module the self module starts from.
+  std::vector<std::string> runtime_fn_names_;
 
   std::unique_ptr<llvm::LLVMContext> ctx;
   std::unique_ptr<llvm::Module> m;
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/backends/llvm/execution_engine.h"
+
+#include <gtest/gtest.h>
+#include <llvm/AsmParser/Parser.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/SourceMgr.h>
+#include <stdlib.h>
+
+#include <fstream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+
+#include "paddle/cinn/backends/compiler.h"
+#include "paddle/cinn/backends/llvm/cinn_runtime_llvm_ir.h"
+#include "paddle/cinn/backends/llvm/llvm_util.h"
+#include "paddle/cinn/cinn.h"
+#include "paddle/cinn/common/context.h"
+
+namespace cinn {
+namespace backends {
+namespace {
+
+// The functions defined by the runtime module every engine starts from.
+std::set<std::string> RuntimeFunctionNames() {
+  llvm::LLVMContext context;
+  llvm::SMDiagnostic error;
+  auto module =
+      llvm::parseAssemblyString(AsStringRef(kRuntimeLlvmIr), error, context);
+  CHECK(module) << error.getMessage().str();
+  std::set<std::string> names;
+  for (const auto& fn : *module) {
+    if (!fn.isDeclaration()) names.insert(fn.getName().str());
+  }
+  return names;
+}
+
+// The names of the symbols \p object_code defines with external linkage.
+std::set<std::string> GlobalDefinedSymbols(const std::string& object_code) {
+  auto object = llvm::cantFail(llvm::object::ObjectFile::createObjectFile(
+      llvm::MemoryBufferRef(object_code, "cinn_object")));
+  std::set<std::string> names;
+  for (const auto& symbol : object->symbols()) {
+    uint32_t flags = symbol.getFlags();
+    if ((flags & llvm::object::SymbolRef::SF_Global) &&
+        !(flags & llvm::object::SymbolRef::SF_Undefined)) {
+      names.insert(llvm::cantFail(symbol.getName()).str());
+    }
+  }
+  return names;
+}
+
+// A module of two kernels, whose arguments are unpacked by the runtime
+// functions.
+ir::Module BuildModule() {
+  cinn::common::Context::Global().ResetNameId();
+  Placeholder<float> A("A", {Expr(32), Expr(16)});
+  ir::Tensor B = Compute(
+      {Expr(32), Expr(16)}, [&](Var i, Var j) { return A(i, j) * 2.f; }, "B");
+  ir::Tensor C = Compute(
+      {Expr(32), Expr(16)}, [&](Var i, Var j) { return A(i, j) + 1.f; }, "C");
+  ast_gen_ius::TensorGroup scale_group({A, B});
+  ast_gen_ius::TensorGroup add_group({A, C});
+  ir::Module::Builder builder("runtime_linkage", common::DefaultHostTarget());
+  builder.AddFunction(lang::LowerToAst("scale_kernel", {A, B}, &scale_group));
+  builder.AddFunction(lang::LowerToAst("add_kernel", {A, C}, &add_group));
+  return builder.Build();
+}
+
+}  // namespace
+
+TEST(ExecutionEngine, RuntimeFunctionsAreInternal) {
+  auto compiler = Compiler::Create(common::DefaultHostTarget());
+  compiler->Build(BuildModule());
+  compiler->EndCompile();
+  ASSERT_NE(compiler->Lookup("scale_kernel"), nullptr);
+  ASSERT_NE(compiler->Lookup("add_kernel"), nullptr);
+
+  const std::string object_code = compiler->GetCompiledObject();
+  ASSERT_FALSE(object_code.empty());
+  const std::set<std::string> symbols = GlobalDefinedSymbols(object_code);
+  EXPECT_TRUE(symbols.count("scale_kernel"));
+  EXPECT_TRUE(symbols.count("add_kernel"));
+  // The runtime functions are inlined into the kernels or dropped, so the
+  // object does not define them again for every engine.
+  const std::set<std::string> runtime_fns = RuntimeFunctionNames();
+  ASSERT_FALSE(runtime_fns.empty());
+  for (const auto& name : runtime_fns) {
+    EXPECT_FALSE(symbols.count(name)) << name << " is exported";
+  }
+
+  // The object links into another engine, which finds the kernels without
+  // compiling them.
+  auto loader = Compiler::Create(common::DefaultHostTarget());
+  ASSERT_TRUE(loader->LoadObject(object_code));
+  EXPECT_NE(loader->Lookup("scale_kernel"), nullptr);
+  EXPECT_NE(loader->Lookup("add_kernel"), nullptr);
+}
+
+TEST(ExecutionEngine, ExportObject) {
+  char dir[] = "/tmp/cinn_export_object_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  const std::string path = std::string(dir) + "/runtime_linkage.o";
+
+  auto compiler = Compiler::Create(common::DefaultHostTarget());
+  compiler->Build(BuildModule());
+  // Nothing is compiled before EndCompile() and a Lookup().
+  EXPECT_ANY_THROW(compiler->ExportObject(path));
+  compiler->EndCompile();
+  EXPECT_ANY_THROW(compiler->ExportObject(path));
+  ASSERT_NE(compiler->Lookup("scale_kernel"), nullptr);
+
+  compiler->ExportObject(path);
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream exported;
+  exported << file.rdbuf();
+  EXPECT_EQ(exported.str(), compiler->GetCompiledObject());
+}
+
+}  // namespace backends
+}  // namespace cinn
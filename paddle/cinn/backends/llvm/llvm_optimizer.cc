@@ -126,9 +126,14 @@ LLVMModuleOptimizer::LLVMModuleOptimizer(llvm::TargetMachine *machine,
     : opt_level_(opt_level), print_passes_(print_passes), machine_(machine) {}
 
 void LLVMModuleOptimizer::operator()(llvm::Module *m) {
-  auto machine = std::move(llvm::cantFail(
-      llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
-          .createTargetMachine()));
+  std::unique_ptr<llvm::TargetMachine> host_machine;
+  llvm::TargetMachine *machine = machine_;
+  if (machine == nullptr) {
+    host_machine = std::move(llvm::cantFail(
+        llvm::cantFail(llvm::orc::JITTargetMachineBuilder::detectHost())
+            .createTargetMachine()));
+    machine = host_machine.get();
+  }
   auto fpm = std::make_unique<CustomFunctionPassManager>(print_passes_, m);
   // fpm->add(llvm::createTargetTransformInfoWrapperPass(llvm::TargetIRAnalysis()));
   // fpm->add(llvm::createInstructionCombiningPass());
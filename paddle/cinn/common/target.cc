@@ -328,6 +328,8 @@ const Target &DefaultDeviceTarget() {
   return DefaultNVGPUTarget();
 #elif defined(CINN_WITH_HIP)
   return DefaultHygonDcuHipTarget();
+#else
+  return DefaultHostTarget();
 #endif
 }
 
@@ -21,6 +21,7 @@
 #include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
 #include "paddle/cinn/hlir/dialect/runtime/ir/runtime_dialect.h"
 #include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specializer.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/cinn/runtime/flags.h"
@@ -32,6 +33,7 @@ namespace cinn::dialect::ir::details {
 
 using cinn::hlir::framework::CompilationCache;
 using cinn::hlir::framework::PirCompiler;
+using cinn::hlir::framework::ShapeSpecializer;
 using cinn::hlir::framework::pir::CINNKernelInfo;
 using cinn::hlir::framework::pir::CompatibleInfo;
 
@@ -89,10 +91,14 @@ std::unordered_map<std::string, ::pir::Attribute> GetJitKernelAttr(
       return pir_compiler.Build({group})[0];
     }
   };
+  const auto kernel_info = CreateKernelInfo();
+  // Keep the group to compile static-shape variants of the kernel later.
+  ShapeSpecializer::Instance().Register(
+      group, GetBlockOutsideInput(group->ops()), kernel_info);
   std::unordered_map<std::string, ::pir::Attribute> attrs{
       {cinn::dialect::JitKernelOp::kAttrName,
        cinn::dialect::CINNKernelInfoAttribute::get(pir::IrContext::Instance(),
-                                                   CreateKernelInfo())}};
+                                                   kernel_info)}};
   return attrs;
 }
 
@@ -52,6 +52,11 @@ std::string GroupCompilationContext::PrintPredicate2Funcs() const {
   return ss.str();
 }
 
+size_t GroupCompilationContext::BackendCost() const {
+  return group_->ops().size() *
+         (lowered_funcs_.size() + CX86_lowered_funcs_.size());
+}
+
 void GroupCompilationContext::PrepareModuleBuilder() {
   PADDLE_ENFORCE_EQ(predicates_.size(),
                     lowered_funcs_.size(),
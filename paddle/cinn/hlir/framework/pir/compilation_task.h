@@ -39,6 +39,9 @@ class GroupCompilationContext {
   void SetLoweredFuncs(BucketLoweredFuncsWrapper&& funcs);
   void PrepareModuleBuilder();
   std::string PrintPredicate2Funcs() const;
+  // Rough cost of compiling the lowered funcs with the backend, used to start
+  // the most expensive groups first.
+  size_t BackendCost() const;
 
  private:
   friend class CompilationTask;
@@ -66,12 +69,12 @@ class CompilationTask {
 
   std::shared_ptr<pir::CompilationResult> operator()();
   void Lowering();
+  std::shared_ptr<pir::CompilationResult> CodegenAndJit();
   std::shared_ptr<pir::CompilationResult> CompileBroadcastModules(
       std::vector<GroupCompilationContext>* leaf_group_contexts,
       const std::unordered_map<int, ir::Var>& symbolic_shape_var_index);
 
  private:
-  std::shared_ptr<pir::CompilationResult> CodegenAndJit();
   std::shared_ptr<pir::CompilationResult> BuildPirCINNKernelInfo(
       const ir::Module& module, const ir::Module& CX86module);
 
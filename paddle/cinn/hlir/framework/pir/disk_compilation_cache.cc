@@ -0,0 +1,571 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/Host.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/common/flags.h"
+#include "paddle/common/overloaded.h"
+#include "paddle/fluid/framework/commit.h"
+#include "paddle/pir/include/dialect/shape/utils/dim_expr_util.h"
+#include "paddle/pir/include/dialect/shape/utils/shape_analysis.h"
+
+PD_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_bool(cinn_bucket_compile);
+PD_DECLARE_bool(cinn_new_group_scheduler);
+PD_DECLARE_bool(group_schedule_tiling_first);
+PD_DECLARE_bool(cinn_cpu_tile_tactic);
+PD_DECLARE_string(cinn_compile_cache_dir);
+PD_DECLARE_int64(cinn_compile_cache_max_mb);
+
+namespace cinn::hlir::framework {
+
+namespace {
+
+// Bump it whenever the entry layout or the key changes.
+constexpr char kEntryMagic[] = "CINNOBJ2";
+constexpr size_t kEntryMagicSize = sizeof(kEntryMagic) - 1;
+constexpr char kEntrySuffix[] = ".cinnobj";
+constexpr char kEvictLockName[] = ".evict.lock";
+// Eviction removes entries until the cache is below this fraction of the
+// limit, so that it does not run again on every following insertion.
+constexpr double kEvictLowWatermark = 0.8;
+// Temporary files of crashed writers older than this are removed on eviction.
+constexpr time_t kStaleTmpSeconds = 3600;
+
+uint64_t Fnv1a64(const std::string& data, uint64_t basis) {
+  uint64_t hash = basis;
+  for (unsigned char c : data) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+// 128 bits is enough to make collisions practically impossible, and an entry
+// stores its full key anyway, so a collision is only a miss.
+std::string Digest(const std::string& key) {
+  char buf[33];
+  snprintf(buf,
+           sizeof(buf),
+           "%016llx%016llx",
+           static_cast<unsigned long long>(  // NOLINT
+               Fnv1a64(key, 14695981039346656037ULL)),
+           static_cast<unsigned long long>(  // NOLINT
+               Fnv1a64(key, 0x9e3779b97f4a7c15ULL)));
+  return std::string(buf);
+}
+
+bool EndsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+         str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool MakeDir(const std::string& path) {
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+std::string HostFingerprint() {
+  std::ostringstream os;
+  os << llvm::sys::getHostCPUName().str();
+  llvm::StringMap<bool> features;
+  if (llvm::sys::getHostCPUFeatures(features)) {
+    std::vector<std::string> enabled;
+    for (const auto& feature : features) {
+      if (feature.getValue()) enabled.push_back(feature.getKey().str());
+    }
+    std::sort(enabled.begin(), enabled.end());
+    for (const auto& feature : enabled) os << "+" << feature;
+  }
+  return os.str();
+}
+
+template <typename DoEachT>
+void VisitEachDimExpr(const symbol::ShapeOrDataDimExprs& shape_or_data,
+                      const DoEachT& DoEach) {
+  const auto VisitTensor =
+      [&](const symbol::TensorShapeOrDataDimExprs& tensor_shape_or_data) {
+        for (const auto& dim_expr : tensor_shape_or_data.shape()) {
+          DoEach(dim_expr);
+        }
+        if (!tensor_shape_or_data.data().has_value()) return;
+        for (const auto& dim_expr : tensor_shape_or_data.data().value()) {
+          DoEach(dim_expr);
+        }
+      };
+  auto lambdas = ::common::Overloaded{
+      [&](const symbol::TensorShapeOrDataDimExprs& tensor_shape_or_data) {
+        VisitTensor(tensor_shape_or_data);
+      },
+      [&](const symbol::TensorListShapeOrDataDimExprs& tensor_list) {
+        for (const auto& tensor_shape_or_data : tensor_list) {
+          VisitTensor(tensor_shape_or_data);
+        }
+      },
+      [&](const symbol::RankedTensorArrayShapeOrDataDimExprs& tensor_array) {
+        for (const auto& dim_expr : tensor_array.GetShapeHint()) {
+          DoEach(dim_expr);
+        }
+      },
+      [&](const symbol::NullShapeOrDataDimExpr& null_shape_or_data) {}};
+  std::visit(lambdas, shape_or_data.variant());
+}
+
+// Returns the constraints between the symbols of the group inputs, which
+// lowering may use to simplify the kernels. Constraints on other symbols of
+// the program do not change the code of the group, so they are left out and
+// the same group of another program shares the entry.
+std::vector<std::string> CollectInputConstraints(
+    const pir::OpLoweringGroup& group, const pir::FusionInfo& fusion_info) {
+  std::unordered_set<std::string> input_symbols;
+  for (const auto& shape_or_data : fusion_info.input_dim_exprs()) {
+    VisitEachDimExpr(shape_or_data, [&](const symbol::DimExpr& dim_expr) {
+      for (const auto& symbol : symbol::CollectDimExprSymbols(dim_expr)) {
+        input_symbols.insert(symbol);
+      }
+    });
+  }
+  std::vector<std::string> constraints;
+  if (input_symbols.empty()) return constraints;
+
+  const auto IsInputRelated = [&](const symbol::DimExpr& dim_expr,
+                                  bool* is_symbolic) -> bool {
+    const auto symbols = symbol::CollectDimExprSymbols(dim_expr);
+    *is_symbolic = !symbols.empty();
+    for (const auto& symbol : symbols) {
+      if (input_symbols.count(symbol) == 0) return false;
+    }
+    return true;
+  };
+  const auto ToString = [](const symbol::DimExpr& dim_expr) {
+    std::ostringstream os;
+    os << dim_expr;
+    return os.str();
+  };
+
+  auto& shape_analysis =
+      ::pir::ShapeAnalysisManager::Instance().Get(group.GetParentProgram());
+  const auto& constraints_manager = shape_analysis.constraints_manager();
+  constraints_manager.VisitEqualClusters(
+      [&](const std::vector<symbol::DimExpr>& cluster) {
+        std::vector<std::string> members;
+        bool has_symbol = false;
+        for (const auto& dim_expr : cluster) {
+          bool is_symbolic = false;
+          if (!IsInputRelated(dim_expr, &is_symbolic)) continue;
+          has_symbol |= is_symbolic;
+          members.push_back(ToString(dim_expr));
+        }
+        if (!has_symbol || members.size() < 2) return;
+        std::sort(members.begin(), members.end());
+        std::ostringstream os;
+        os << "eq";
+        for (const auto& member : members) os << " " << member;
+        constraints.push_back(os.str());
+      });
+  for (const auto& dim_expr : constraints_manager.gtones()) {
+    bool is_symbolic = false;
+    if (!IsInputRelated(dim_expr, &is_symbolic) || !is_symbolic) continue;
+    constraints.push_back("gt_one " + ToString(dim_expr));
+  }
+  for (const auto& broadcastable : constraints_manager.broadcastables()) {
+    bool lhs_symbolic = false;
+    bool rhs_symbolic = false;
+    if (!IsInputRelated(broadcastable->lhs, &lhs_symbolic) ||
+        !IsInputRelated(broadcastable->rhs, &rhs_symbolic) ||
+        !(lhs_symbolic || rhs_symbolic)) {
+      continue;
+    }
+    // Broadcastable is symmetric, print its sides in order.
+    auto lhs = ToString(broadcastable->lhs);
+    auto rhs = ToString(broadcastable->rhs);
+    if (rhs < lhs) std::swap(lhs, rhs);
+    constraints.push_back("broadcastable " + lhs + " " + rhs);
+  }
+  std::sort(constraints.begin(), constraints.end());
+  return constraints;
+}
+
+void AppendU64(uint64_t value, std::string* out) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void AppendString(const std::string& value, std::string* out) {
+  AppendU64(value.size(), out);
+  out->append(value);
+}
+
+class EntryReader {
+ public:
+  explicit EntryReader(const std::string& data) : data_(data) {}
+
+  bool ReadU64(uint64_t* value) {
+    if (data_.size() - pos_ < sizeof(*value)) return false;
+    memcpy(value, data_.data() + pos_, sizeof(*value));
+    pos_ += sizeof(*value);
+    return true;
+  }
+
+  bool ReadString(std::string* value) {
+    uint64_t size = 0;
+    if (!ReadU64(&size) || data_.size() - pos_ < size) return false;
+    value->assign(data_.data() + pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool AtEnd() const { return pos_ == data_.size(); }
+
+ private:
+  const std::string& data_;
+  size_t pos_{kEntryMagicSize};
+};
+
+std::string SerializeEntry(const std::string& key,
+                           const DiskCompilationCache::Entry& entry) {
+  std::string out(kEntryMagic, kEntryMagicSize);
+  AppendString(key, &out);
+  AppendString(entry.host_fn_name, &out);
+  AppendString(entry.infer_fn_name, &out);
+  AppendU64(entry.int_args_map.size(), &out);
+  for (const auto& [arg_idx, dim_idx] : entry.int_args_map) {
+    AppendU64(static_cast<int64_t>(arg_idx), &out);
+    AppendU64(static_cast<int64_t>(dim_idx.arg_idx), &out);
+    AppendU64(static_cast<int64_t>(dim_idx.dim_idx), &out);
+  }
+  AppendString(entry.object_code, &out);
+  return out;
+}
+
+bool DeserializeEntry(const std::string& data,
+                      const std::string& key,
+                      DiskCompilationCache::Entry* entry) {
+  if (data.size() < kEntryMagicSize ||
+      data.compare(0, kEntryMagicSize, kEntryMagic) != 0) {
+    return false;
+  }
+  EntryReader reader(data);
+  std::string stored_key;
+  if (!reader.ReadString(&stored_key) || stored_key != key) return false;
+  uint64_t num_int_args = 0;
+  if (!reader.ReadString(&entry->host_fn_name) ||
+      !reader.ReadString(&entry->infer_fn_name) ||
+      !reader.ReadU64(&num_int_args)) {
+    return false;
+  }
+  entry->int_args_map.clear();
+  for (uint64_t i = 0; i < num_int_args; ++i) {
+    uint64_t arg_idx = 0, dim_arg_idx = 0, dim_idx = 0;
+    if (!reader.ReadU64(&arg_idx) || !reader.ReadU64(&dim_arg_idx) ||
+        !reader.ReadU64(&dim_idx)) {
+      return false;
+    }
+    entry->int_args_map[static_cast<int>(arg_idx)] = {
+        static_cast<int>(dim_arg_idx), static_cast<int>(dim_idx)};
+  }
+  return reader.ReadString(&entry->object_code) && reader.AtEnd() &&
+         !entry->object_code.empty();
+}
+
+// Visits the entries and temporary files in the two levels of `cache_dir`.
+void VisitCacheFiles(
+    const std::string& cache_dir,
+    const std::function<void(const std::string&, const struct stat&)>&
+        DoEach) {
+  DIR* root = opendir(cache_dir.c_str());
+  if (root == nullptr) return;
+  while (struct dirent* sub = readdir(root)) {
+    const std::string sub_name = sub->d_name;
+    if (sub_name.size() != 2) continue;
+    const std::string sub_dir = cache_dir + "/" + sub_name;
+    DIR* dir = opendir(sub_dir.c_str());
+    if (dir == nullptr) continue;
+    while (struct dirent* file = readdir(dir)) {
+      const std::string name = file->d_name;
+      if (name == "." || name == "..") continue;
+      const std::string path = sub_dir + "/" + name;
+      struct stat st;
+      if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+      DoEach(path, st);
+    }
+    closedir(dir);
+  }
+  closedir(root);
+}
+
+}  // namespace
+
+DiskCompilationCache::DiskCompilationCache(const std::string& cache_dir,
+                                           int64_t max_bytes)
+    : cache_dir_(cache_dir), max_bytes_(max_bytes) {
+  if (cache_dir_.empty()) return;
+  if (!MakeDir(cache_dir_)) {
+    LOG(WARNING) << "Can not create the cinn compile cache dir " << cache_dir_
+                 << ", the on-disk compile cache is disabled.";
+    cache_dir_.clear();
+    return;
+  }
+  cached_bytes_ = ScanCachedBytes();
+}
+
+DiskCompilationCache& DiskCompilationCache::Instance() {
+  static DiskCompilationCache instance(
+      FLAGS_cinn_compile_cache_dir,
+      FLAGS_cinn_compile_cache_max_mb * 1024 * 1024);
+  return instance;
+}
+
+bool DiskCompilationCache::IsEnabled(const Target& target) const {
+  // Without FLAGS_enable_cinn_compile_cache every group is compiled with a
+  // unique function name, there is nothing to share.
+  if (cache_dir_.empty() || !FLAGS_enable_cinn_compile_cache) return false;
+  return target.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) { return false; });
+}
+
+std::string DiskCompilationCache::MakeKey(
+    const pir::OpLoweringGroup& group,
+    const pir::FusionInfo& fusion_info,
+    const std::string& kind,
+    const std::string& policy_fingerprint) const {
+  static const std::string kEnvironment = [] {
+    std::ostringstream os;
+    os << "paddle: " << ::paddle::framework::paddle_commit()
+       << ", llvm: " << LLVM_VERSION_STRING << "\n"
+       << "host: " << HostFingerprint() << "\n";
+    return os.str();
+  }();
+  std::ostringstream os;
+  os << kEntryMagic << "\n" << kEnvironment;
+  os << "target: " << common::DefaultHostTarget() << "\n";
+  os << "flags: bucket_compile=" << FLAGS_cinn_bucket_compile
+     << ", new_group_scheduler=" << FLAGS_cinn_new_group_scheduler
+     << ", tiling_first=" << FLAGS_group_schedule_tiling_first
+     << ", cpu_tile_tactic=" << FLAGS_cinn_cpu_tile_tactic << "\n";
+  // The tile configs the group is scheduled with, a searched config written
+  // to the database must not hit the kernel compiled before it.
+  os << "tile config policy: " << policy_fingerprint << "\n";
+  os << "kind: " << kind << "\n";
+  fusion_info.PrintStableKey(os);
+  os << "constraints:\n";
+  for (const auto& constraint : CollectInputConstraints(group, fusion_info)) {
+    os << constraint << "\n";
+  }
+  return os.str();
+}
+
+std::string DiskCompilationCache::EntryPath(const std::string& key) const {
+  const std::string digest = Digest(key);
+  return cache_dir_ + "/" + digest.substr(0, 2) + "/" + digest + kEntrySuffix;
+}
+
+int64_t DiskCompilationCache::ScanCachedBytes() const {
+  int64_t total = 0;
+  VisitCacheFiles(cache_dir_, [&](const std::string& path, const auto& st) {
+    if (EndsWith(path, kEntrySuffix)) total += st.st_size;
+  });
+  return total;
+}
+
+bool DiskCompilationCache::ReadEntry(const std::string& key, Entry* entry) {
+  if (cache_dir_.empty()) return false;
+  const std::string path = EntryPath(key);
+  std::ifstream fin(path, std::ios::binary);
+  if (!fin) return false;
+  std::string data((std::istreambuf_iterator<char>(fin)),
+                   std::istreambuf_iterator<char>());
+  if (!DeserializeEntry(data, key, entry)) {
+    VLOG(3) << "Ignore the mismatched or corrupted cinn compile cache entry "
+            << path;
+    return false;
+  }
+  // The modification time orders the entries for eviction.
+  utime(path.c_str(), nullptr);
+  return true;
+}
+
+bool DiskCompilationCache::WriteEntry(const std::string& key,
+                                      const Entry& entry) {
+  if (cache_dir_.empty()) return false;
+  const std::string path = EntryPath(key);
+  const std::string sub_dir = path.substr(0, path.rfind('/'));
+  if (!MakeDir(sub_dir)) return false;
+
+  static std::atomic<uint64_t> tmp_counter{0};
+  std::ostringstream tmp_path;
+  tmp_path << path << ".tmp." << getpid() << "."
+           << std::hash<std::thread::id>()(std::this_thread::get_id()) << "."
+           << tmp_counter++;
+  const std::string data = SerializeEntry(key, entry);
+  {
+    std::ofstream fout(tmp_path.str(), std::ios::binary | std::ios::trunc);
+    fout.write(data.data(), data.size());
+    if (!fout.good()) {
+      std::remove(tmp_path.str().c_str());
+      return false;
+    }
+  }
+  // Readers never see a partial entry, the complete file is renamed to
+  // `path`. Concurrent writers of the same key write the same entry.
+  if (std::rename(tmp_path.str().c_str(), path.c_str()) != 0) {
+    std::remove(tmp_path.str().c_str());
+    return false;
+  }
+  if ((cached_bytes_ += data.size()) > max_bytes_) Evict();
+  return true;
+}
+
+bool DiskCompilationCache::Evict() {
+  if (cache_dir_.empty()) return false;
+  const std::string lock_path = cache_dir_ + "/" + kEvictLockName;
+  int fd = open(lock_path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (fd < 0) return false;
+  if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+    close(fd);
+    return false;
+  }
+
+  struct CacheFile {
+    std::string path;
+    time_t mtime;
+    int64_t size;
+  };
+  std::vector<CacheFile> files;
+  int64_t total = 0;
+  const time_t now = time(nullptr);
+  VisitCacheFiles(cache_dir_, [&](const std::string& path, const auto& st) {
+    if (EndsWith(path, kEntrySuffix)) {
+      files.push_back({path, st.st_mtime, static_cast<int64_t>(st.st_size)});
+      total += st.st_size;
+    } else if (path.find(".tmp.") != std::string::npos &&
+               now - st.st_mtime > kStaleTmpSeconds) {
+      std::remove(path.c_str());
+    }
+  });
+  std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) {
+    return lhs.mtime < rhs.mtime;
+  });
+  const auto low_watermark =
+      static_cast<int64_t>(max_bytes_ * kEvictLowWatermark);
+  size_t num_evicted = 0;
+  for (const auto& file : files) {
+    if (total <= low_watermark) break;
+    // A process reading the entry keeps its open file, removing it is safe.
+    if (std::remove(file.path.c_str()) == 0) {
+      total -= file.size;
+      ++num_evicted;
+    }
+  }
+  cached_bytes_ = total;
+  VLOG(3) << "Evicted " << num_evicted << " cinn compile cache entries, "
+          << total << " bytes left in " << cache_dir_;
+
+  flock(fd, LOCK_UN);
+  close(fd);
+  return true;
+}
+
+std::shared_ptr<pir::CompilationResult> DiskCompilationCache::Load(
+    const Target& target, const std::string& key) {
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = loaded_.find(key);
+    if (it != loaded_.end()) return it->second;
+  }
+  Entry entry;
+  if (!ReadEntry(key, &entry)) return nullptr;
+
+  auto backend_resource =
+      std::make_shared<pir::BackendResource>(target,
+                                             entry.host_fn_name,
+                                             entry.infer_fn_name,
+                                             entry.int_args_map);
+  const auto& compiler = backend_resource->GetBackendCompiler();
+  if (!compiler->LoadObject(entry.object_code) ||
+      compiler->Lookup(entry.host_fn_name) == nullptr ||
+      compiler->Lookup(entry.infer_fn_name) == nullptr ||
+      compiler->Lookup(entry.host_fn_name + "_CX86") == nullptr) {
+    LOG(WARNING) << "Failed to link the cinn compile cache entry "
+                 << EntryPath(key) << ", recompile it.";
+    return nullptr;
+  }
+  auto result = std::make_shared<pir::CompilationResult>(target);
+  result->SetBackendResource(backend_resource);
+  disk_hits_.fetch_add(1);
+  VLOG(4) << "Load " << entry.host_fn_name << " from the cinn compile cache "
+          << EntryPath(key);
+
+  std::lock_guard<std::mutex> lock(mu_);
+  return loaded_.emplace(key, result).first->second;
+}
+
+void DiskCompilationCache::Save(
+    const std::string& key,
+    const std::shared_ptr<pir::CompilationResult>& result) {
+  const auto& backend_resource = result->GetBackendResource();
+  if (backend_resource == nullptr) return;
+  Entry entry;
+  entry.host_fn_name = backend_resource->GetHostFuncName();
+  entry.infer_fn_name = backend_resource->GetInferFuncName();
+  entry.int_args_map = backend_resource->GetIntArgsMap();
+  entry.object_code =
+      backend_resource->GetBackendCompiler()->GetCompiledObject();
+  if (entry.object_code.empty()) {
+    VLOG(3) << "No object code of " << entry.host_fn_name
+            << " to save in the cinn compile cache.";
+    return;
+  }
+  if (!WriteEntry(key, entry)) {
+    LOG(WARNING) << "Failed to write the cinn compile cache entry "
+                 << EntryPath(key);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mu_);
+  loaded_.emplace(key, result);
+}
+
+void DiskCompilationCache::ClearLoaded() {
+  std::lock_guard<std::mutex> lock(mu_);
+  loaded_.clear();
+}
+
+}  // namespace cinn::hlir::framework
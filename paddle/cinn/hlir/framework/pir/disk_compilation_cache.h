@@ -0,0 +1,114 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/fusion_info.h"
+
+namespace cinn::hlir::framework {
+
+/**
+ * A content-addressed cache of the x86 object code of compiled fusion groups,
+ * stored in FLAGS_cinn_compile_cache_dir.
+ *
+ * The key describes the group ops, the symbolic shapes of its inputs and the
+ * constraints between their symbols, the target, the host CPU, the compile
+ * flags and the paddle and LLVM versions. An entry holds the names of the
+ * kernel functions, the int args map and the relocatable object code, so a
+ * hit skips lowering, codegen and LLVM entirely.
+ *
+ * Entries are written to a temporary file and renamed into place, so readers
+ * never see a partial entry. When the cache grows above
+ * FLAGS_cinn_compile_cache_max_mb, the process holding the eviction lock
+ * removes the least recently used entries. Loaded results are also kept in
+ * memory, so all threads of a process share them.
+ */
+class DiskCompilationCache {
+ public:
+  struct Entry {
+    std::string host_fn_name;
+    std::string infer_fn_name;
+    std::map<int, pir::CINNKernelInfo::ArgDimIdx> int_args_map;
+    std::string object_code;
+  };
+
+  DiskCompilationCache(const std::string& cache_dir, int64_t max_bytes);
+
+  static DiskCompilationCache& Instance();
+
+  bool IsEnabled(const Target& target) const;
+
+  // Returns the key of \p group. \p kind separates the different ways a
+  // group can be compiled, e.g. "group" and "broadcast_tree".
+  // \p policy_fingerprint is the PolicyFingerprint of the tile configs, which
+  // reads the config files, so it is computed once per build.
+  std::string MakeKey(const pir::OpLoweringGroup& group,
+                      const pir::FusionInfo& fusion_info,
+                      const std::string& kind,
+                      const std::string& policy_fingerprint) const;
+
+  // Returns the compiled result of \p key, or nullptr on a miss.
+  std::shared_ptr<pir::CompilationResult> Load(const Target& target,
+                                               const std::string& key);
+
+  // Publishes the object code of a compiled and materialized \p result.
+  void Save(const std::string& key,
+            const std::shared_ptr<pir::CompilationResult>& result);
+
+  bool ReadEntry(const std::string& key, Entry* entry);
+  bool WriteEntry(const std::string& key, const Entry& entry);
+
+  // Removes the least recently used entries until the cache is below the
+  // low watermark. Returns false if another process is evicting.
+  bool Evict();
+
+  // Drops the results linked by this process, so that the next Load reads
+  // the disk as a new process would.
+  void ClearLoaded();
+
+  const std::string& cache_dir() const { return cache_dir_; }
+  int64_t cached_bytes() const { return cached_bytes_.load(); }
+  // The results Load linked from the disk.
+  int64_t disk_hits() const { return disk_hits_.load(); }
+
+ private:
+  CINN_DISALLOW_COPY_AND_ASSIGN(DiskCompilationCache);
+
+  std::string EntryPath(const std::string& key) const;
+  int64_t ScanCachedBytes() const;
+
+  std::string cache_dir_;
+  const int64_t max_bytes_;
+
+  // Approximate, it is recounted by every eviction.
+  std::atomic<int64_t> cached_bytes_{0};
+  std::atomic<int64_t> disk_hits_{0};
+  std::mutex mu_;
+  // key -> result linked by this process.
+  std::unordered_map<std::string, std::shared_ptr<pir::CompilationResult>>
+      loaded_;
+};
+
+}  // namespace cinn::hlir::framework
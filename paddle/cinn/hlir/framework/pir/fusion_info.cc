@@ -36,8 +36,17 @@ std::ostream& operator<<(std::ostream& os, const AttributeInfo& attr_info) {
   return os;
 }
 
+void AttributeInfo::PrintStableKey(std::ostream& os) const {
+  os << name_ << "=";
+  ::pir::IrPrinter(os).PrintAttribute(attr_);
+}
+
 std::size_t ValueInfo::hash() const { return type_.hash(); }
 
+void ValueInfo::PrintStableKey(std::ostream& os) const {
+  ::pir::IrPrinter(os).PrintType(type_);
+}
+
 std::ostream& operator<<(std::ostream& os, const ValueInfo& value_info) {
   os << "ValueInfo - " << value_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -81,6 +90,25 @@ std::size_t OperationInfo::hash() const {
   return seed;
 }
 
+void OperationInfo::PrintStableKey(std::ostream& os) const {
+  os << name_ << "(";
+  for (const auto& info : input_infos_) {
+    info.PrintStableKey(os);
+    os << ",";
+  }
+  os << ")->(";
+  for (const auto& info : output_infos_) {
+    info.PrintStableKey(os);
+    os << ",";
+  }
+  os << "){";
+  for (const auto& info : attr_infos_) {
+    info.PrintStableKey(os);
+    os << ",";
+  }
+  os << "}";
+}
+
 std::ostream& operator<<(std::ostream& os, const OperationInfo& op_info) {
   os << op_info.name_ << " - " << op_info.hash();
   if (VLOG_IS_ON(7)) {
@@ -115,6 +143,17 @@ std::size_t FusionOpInfo::hash() const {
   return seed;
 }
 
+void FusionOpInfo::PrintStableKey(std::ostream& os) const {
+  op_info_.PrintStableKey(os);
+  // Upstream hashes depend on storage addresses, the index is enough to
+  // identify the upstream op.
+  os << " deps{";
+  for (const auto& [value_index, dep_info] : inner_deps_) {
+    os << value_index << ":" << dep_info.upstream_index() << ",";
+  }
+  os << "}";
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionOpInfo& info) {
   os << info.op_info_ << ", inner_deps:{";
   for (const auto& [value_index, op_info_hash] : info.inner_deps_) {
@@ -160,6 +199,13 @@ void FusionInfo::ParseOpInfos(const OpLoweringGroup& group) {
     op_infos_.emplace_back(*op, GetInnerUpstreamOps(op));
     op_mapper.insert({op, i});
   }
+
+  for (const auto& value : group.output_values()) {
+    const auto* defining_op = value ? value.defining_op() : nullptr;
+    if (op_mapper.count(defining_op) == 0) continue;
+    output_indices_.emplace_back(
+        op_mapper[defining_op], value.dyn_cast<::pir::OpResult>().index());
+  }
 }
 
 void FusionInfo::ParseInputDimExprs(const OpLoweringGroup& group) {
@@ -203,6 +249,21 @@ std::size_t FusionInfo::hash() const {
   return seed;
 }
 
+void FusionInfo::PrintStableKey(std::ostream& os) const {
+  for (size_t i = 0; i < op_infos_.size(); ++i) {
+    os << "op " << i << ": ";
+    op_infos_[i].PrintStableKey(os);
+    os << "\n";
+  }
+  os << "outputs:";
+  for (const auto& [op_index, result_index] : output_indices_) {
+    os << " " << op_index << "." << result_index;
+  }
+  os << "\ninput_dim_exprs:";
+  for (const auto& dim_expr : input_dim_exprs_) os << " " << dim_expr;
+  os << "\n";
+}
+
 std::ostream& operator<<(std::ostream& os, const FusionInfo& fusion_info) {
   os << "FusionInfo - " << fusion_info.hash();
   if (VLOG_IS_ON(5)) {
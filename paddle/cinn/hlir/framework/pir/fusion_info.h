@@ -25,6 +25,7 @@ class AttributeInfo {
       : name_(name), attr_(attr) {}
 
   std::size_t hash() const;
+  void PrintStableKey(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const AttributeInfo &info);
 
  private:
@@ -37,6 +38,7 @@ class ValueInfo {
   explicit ValueInfo(const ::pir::Value &value) : type_(value.type()) {}
 
   std::size_t hash() const;
+  void PrintStableKey(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const ValueInfo &info);
 
  private:
@@ -49,6 +51,7 @@ class OperationInfo {
   explicit OperationInfo(const ::pir::Operation &op);
 
   std::size_t hash() const;
+  void PrintStableKey(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const OperationInfo &info);
 
  private:
@@ -68,6 +71,7 @@ class OpDepInfo {
   }
 
   std::size_t hash() const;
+  size_t upstream_index() const { return upstream_index_; }
   friend std::ostream &operator<<(std::ostream &os, const OpDepInfo &info);
 
  private:
@@ -82,6 +86,7 @@ class FusionOpInfo {
       : op_info_(op), inner_deps_(deps) {}
 
   std::size_t hash() const;
+  void PrintStableKey(std::ostream &os) const;
   friend std::ostream &operator<<(std::ostream &os, const FusionOpInfo &info);
 
  private:
@@ -101,6 +106,15 @@ class FusionInfo {
 
   std::size_t hash() const;
 
+  // Prints a description of the fusion group that, unlike hash(), does not
+  // depend on the addresses of IR storages, so it identifies the same group
+  // across processes. It is the key of the on-disk compilation cache.
+  void PrintStableKey(std::ostream &os) const;
+
+  const std::vector<::symbol::ShapeOrDataDimExprs> &input_dim_exprs() const {
+    return input_dim_exprs_;
+  }
+
   bool operator==(const FusionInfo &other) const {
     return this->hash() == other.hash();
   }
@@ -112,6 +126,8 @@ class FusionInfo {
 
   std::vector<FusionOpInfo> op_infos_;
   std::vector<::symbol::ShapeOrDataDimExprs> input_dim_exprs_;
+  // (op index, result index) of each output value of the group.
+  std::vector<std::pair<size_t, size_t>> output_indices_;
   std::size_t cached_hash_value_{0};
 
   // Used to make same subgraphs have unique FusionInfo while
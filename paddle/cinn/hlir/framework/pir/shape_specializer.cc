@@ -0,0 +1,299 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/hlir/framework/pir/shape_specializer.h"
+
+#include <thread>
+#include <utility>
+
+#include "paddle/cinn/hlir/framework/pir_compiler.h"
+#include "paddle/cinn/runtime/arch_device.h"
+#include "paddle/common/flags.h"
+#include "paddle/pir/include/core/builder.h"
+#include "paddle/pir/include/core/builtin_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/ir_mapping.h"
+#include "paddle/pir/include/dialect/shape/utils/dim_expr_util.h"
+#include "paddle/pir/include/dialect/shape/utils/shape_analysis.h"
+
+PD_DECLARE_int32(cinn_max_shape_specializations);
+
+namespace cinn::hlir::framework {
+
+namespace {
+
+using DimExprMap = std::unordered_map<symbol::DimExpr, symbol::DimExpr>;
+
+bool HasSymbolicDim(const symbol::ShapeOrDataDimExprs& shape_or_data) {
+  if (!shape_or_data.isa<symbol::TensorShapeOrDataDimExprs>()) return false;
+  for (const auto& dim : shape_or_data.shape()) {
+    if (!dim.isa<int64_t>()) return true;
+  }
+  return false;
+}
+
+std::optional<std::vector<symbol::DimExpr>> SubstituteToStatic(
+    const std::vector<symbol::DimExpr>& dims, const DimExprMap& bindings) {
+  std::vector<symbol::DimExpr> result;
+  result.reserve(dims.size());
+  for (const auto& dim : dims) {
+    result.push_back(
+        symbol::SimplifyDimExpr(symbol::SubstituteDimExpr(dim, bindings)));
+    if (!result.back().isa<int64_t>()) return std::nullopt;
+  }
+  return result;
+}
+
+// Returns std::nullopt if some dim or data of \p shape_or_data is not bound
+// to a constant by \p bindings.
+std::optional<symbol::ShapeOrDataDimExprs> SubstituteToStatic(
+    const symbol::ShapeOrDataDimExprs& shape_or_data,
+    const DimExprMap& bindings) {
+  if (shape_or_data.isa<symbol::NullShapeOrDataDimExpr>()) {
+    return shape_or_data;
+  }
+  if (!shape_or_data.isa<symbol::TensorShapeOrDataDimExprs>()) {
+    return std::nullopt;
+  }
+  const auto shape = SubstituteToStatic(shape_or_data.shape(), bindings);
+  if (!shape) return std::nullopt;
+  if (!shape_or_data.data()) {
+    return symbol::ShapeOrDataDimExprs{
+        symbol::TensorShapeOrDataDimExprs(shape.value())};
+  }
+  const auto data = SubstituteToStatic(shape_or_data.data().value(), bindings);
+  if (!data) return std::nullopt;
+  return symbol::ShapeOrDataDimExprs{
+      symbol::TensorShapeOrDataDimExprs(shape.value(), data.value())};
+}
+
+// Binds every symbol that is a whole input dim to the dim of the running
+// input. Returns false if the inputs contradict the group.
+bool BindInputSymbols(const std::vector<symbol::ShapeOrDataDimExprs>& inputs,
+                      const std::vector<std::vector<int64_t>>& input_dims,
+                      DimExprMap* bindings) {
+  if (inputs.size() != input_dims.size()) return false;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (inputs[i].isa<symbol::NullShapeOrDataDimExpr>()) continue;
+    if (!inputs[i].isa<symbol::TensorShapeOrDataDimExprs>()) return false;
+    const auto& shape = inputs[i].shape();
+    if (shape.size() != input_dims[i].size()) return false;
+    for (size_t j = 0; j < shape.size(); ++j) {
+      const symbol::DimExpr dim{input_dims[i][j]};
+      if (shape[j].isa<int64_t>()) {
+        if (shape[j] != dim) return false;
+      } else if (shape[j].isa<std::string>()) {
+        const auto& [it, inserted] = bindings->emplace(shape[j], dim);
+        if (!inserted && it->second != dim) return false;
+      }
+    }
+  }
+  // Dims like S0 * 2 are only known once all symbols are bound.
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    if (!inputs[i].isa<symbol::TensorShapeOrDataDimExprs>()) continue;
+    const auto shape = SubstituteToStatic(inputs[i].shape(), *bindings);
+    if (!shape) return false;
+    for (size_t j = 0; j < shape->size(); ++j) {
+      if (shape->at(j) != symbol::DimExpr{input_dims[i][j]}) return false;
+    }
+  }
+  return true;
+}
+
+struct ClonedGroup {
+  std::shared_ptr<::pir::Program> program;
+  pir::OpLoweringGroupPtr group;
+  std::vector<::pir::Value> inputs;
+  // From the values of the origin group to the values of group.
+  std::vector<std::pair<::pir::Value, ::pir::Value>> value_map;
+};
+
+// Clones \p group into a new program, where the inputs of the group are
+// parameters. The ops of the group may be erased after it is compiled.
+ClonedGroup CloneIntoProgram(const pir::OpLoweringGroupPtr& group,
+                             const std::vector<::pir::Value>& group_inputs) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ClonedGroup cloned;
+  cloned.program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder(ctx, cloned.program->block());
+  ::pir::IrMapping ir_mapping;
+  for (size_t i = 0; i < group_inputs.size(); ++i) {
+    auto param = builder
+                     .Build<::pir::ParameterOp>(
+                         "shape_specialization_input_" + std::to_string(i),
+                         group_inputs[i].type())
+                     .result(0);
+    ir_mapping.Add(group_inputs[i], param);
+    cloned.inputs.push_back(param);
+  }
+  cloned.group = group->Clone(cloned.program->block(), &ir_mapping);
+  cloned.group->set_op_pattern_kind(group->op_pattern_kind());
+  cloned.group->set_loop_ranges_expr(group->loop_ranges_expr());
+  for (const auto& [origin_val, new_val] : ir_mapping.GetMap<::pir::Value>()) {
+    cloned.value_map.emplace_back(origin_val, new_val);
+  }
+  return cloned;
+}
+
+}  // namespace
+
+ShapeSpecializer& ShapeSpecializer::Instance() {
+  // Leaked, the worker thread may still use it at exit.
+  static ShapeSpecializer* instance = new ShapeSpecializer();
+  return *instance;
+}
+
+bool ShapeSpecializer::IsEnabled() {
+  return FLAGS_cinn_max_shape_specializations > 0;
+}
+
+void ShapeSpecializer::Register(const pir::OpLoweringGroupPtr& group,
+                                const std::vector<::pir::Value>& group_inputs,
+                                const pir::CINNKernelInfo& kernel_info) {
+  if (!IsEnabled()) return;
+  auto& shape_analysis =
+      ::pir::ShapeAnalysisManager::Instance().Get(group->GetParentProgram());
+  const auto& GetShapeOrData =
+      [&](::pir::Value value) -> const symbol::ShapeOrDataDimExprs& {
+    return group->HasShapeOrDataExprs(value)
+               ? group->GetShapeOrDataExprs(value)
+               : shape_analysis.GetShapeOrDataForValue(value);
+  };
+  bool has_symbolic_input = false;
+  for (const auto& input : group_inputs) {
+    has_symbolic_input |= HasSymbolicDim(GetShapeOrData(input));
+  }
+  if (!has_symbolic_input || IsRegistered(kernel_info.fn_name)) return;
+
+  auto cloned = CloneIntoProgram(group, group_inputs);
+  for (const auto& [origin_val, new_val] : cloned.value_map) {
+    cloned.group->SetShapeOrDataExprs(new_val, GetShapeOrData(origin_val));
+  }
+  auto entry = std::make_shared<Entry>();
+  entry->target = common::DefaultDeviceTarget();
+  entry->programs.push_back(cloned.program);
+  entry->group = cloned.group;
+  entry->inputs = std::move(cloned.inputs);
+
+  std::lock_guard<std::mutex> guard(mu_);
+  if (!entries_.emplace(kernel_info.fn_name, std::move(entry)).second) return;
+  entry_order_.push_back(kernel_info.fn_name);
+  if (entry_order_.size() > kMaxEntries) {
+    // A variant being compiled holds the entry until it is done.
+    entries_.erase(entry_order_.front());
+    entry_order_.pop_front();
+  }
+}
+
+bool ShapeSpecializer::IsRegistered(const std::string& fn_name) const {
+  return GetEntry(fn_name) != nullptr;
+}
+
+std::shared_ptr<ShapeSpecializer::Entry> ShapeSpecializer::GetEntry(
+    const std::string& fn_name) const {
+  std::lock_guard<std::mutex> guard(mu_);
+  const auto it = entries_.find(fn_name);
+  return it == entries_.end() ? nullptr : it->second;
+}
+
+void ShapeSpecializer::SpecializeAsync(
+    const std::string& fn_name,
+    const std::vector<std::vector<int64_t>>& input_dims,
+    Callback done) {
+  const auto entry = GetEntry(fn_name);
+  if (!entry) {
+    done(std::nullopt);
+    return;
+  }
+  const auto device_id = runtime::GetArchDevice(entry->target);
+  auto task = [this, fn_name, input_dims, done, device_id, entry]() {
+    runtime::SetArchDevice(entry->target, device_id);
+    std::optional<pir::CINNKernelInfo> kernel_info;
+    try {
+      kernel_info = Specialize(fn_name, input_dims);
+    } catch (const std::exception& e) {
+      // The dynamic-shape kernel keeps serving these dims.
+      LOG(WARNING) << "Failed to compile a static-shape variant of "
+                   << fn_name << ": " << e.what();
+    }
+    done(kernel_info);
+  };
+
+  std::lock_guard<std::mutex> guard(mu_);
+  tasks_.emplace_back(std::move(task));
+  if (!worker_started_) {
+    worker_started_ = true;
+    std::thread([this] { WorkerLoop(); }).detach();
+  }
+  task_cv_.notify_one();
+}
+
+void ShapeSpecializer::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      task_cv_.wait(lock, [this] { return !tasks_.empty(); });
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+std::optional<pir::CINNKernelInfo> ShapeSpecializer::Specialize(
+    const std::string& fn_name,
+    const std::vector<std::vector<int64_t>>& input_dims) {
+  const auto entry = GetEntry(fn_name);
+  if (!entry) return std::nullopt;
+  std::lock_guard<std::mutex> guard(entry->mu);
+
+  std::vector<symbol::ShapeOrDataDimExprs> inputs;
+  for (const auto& input : entry->inputs) {
+    inputs.push_back(entry->group->GetShapeOrDataExprs(input));
+  }
+  DimExprMap bindings;
+  if (!BindInputSymbols(inputs, input_dims, &bindings)) {
+    VLOG(4) << "Can not bind the input dims of " << fn_name;
+    return std::nullopt;
+  }
+
+  auto cloned = CloneIntoProgram(entry->group, entry->inputs);
+  std::unordered_map<::pir::Value, symbol::ShapeOrDataDimExprs> static_exprs;
+  for (const auto& [origin_val, new_val] : cloned.value_map) {
+    auto shape_or_data = SubstituteToStatic(
+        entry->group->GetShapeOrDataExprs(origin_val), bindings);
+    if (!shape_or_data) {
+      VLOG(4) << "Shape of " << fn_name << " is not static for these dims";
+      return std::nullopt;
+    }
+    static_exprs.emplace(new_val, std::move(shape_or_data.value()));
+  }
+  // FusionInfo reads the input shapes from the analysis of the program.
+  auto& shape_analysis =
+      ::pir::ShapeAnalysisManager::Instance().Get(cloned.program.get());
+  for (const auto& [value, shape_or_data] : static_exprs) {
+    shape_analysis.SetShapeOrDataForValue(value, shape_or_data);
+  }
+  cloned.group->set_value_to_shape_or_data_exprs(static_exprs);
+
+  PirCompiler pir_compiler(entry->target);
+  auto kernel_info = pir_compiler.Build({cloned.group})[0];
+  entry->programs.push_back(cloned.program);
+  VLOG(4) << "Compiled " << kernel_info.fn_name << " for a shape of "
+          << fn_name;
+  return kernel_info;
+}
+
+}  // namespace cinn::hlir::framework
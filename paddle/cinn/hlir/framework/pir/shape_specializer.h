@@ -0,0 +1,105 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/common/macros.h"
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/pir/include/core/program.h"
+
+namespace cinn::hlir::framework {
+
+/**
+ * Compiles static-shape variants of dynamic-shape kernels.
+ *
+ * The lowering pass registers a copy of every group it compiles to a
+ * dynamic-shape kernel, keyed by the kernel name. When an input shape of the
+ * kernel becomes hot, CinnJitInstruction asks for a variant: the symbols of
+ * the group are bound to the input dims and the group is compiled again, so
+ * the variant has no symbolic index arithmetic left. Variants are compiled
+ * one at a time on a background thread.
+ */
+class ShapeSpecializer {
+ public:
+  // Receives std::nullopt if the variant can not be compiled.
+  using Callback =
+      std::function<void(const std::optional<pir::CINNKernelInfo>&)>;
+
+  // The registered groups kept, the oldest one is dropped beyond it. The
+  // variants compiled from a dropped group keep running.
+  static constexpr size_t kMaxEntries = 1024;
+
+  static ShapeSpecializer& Instance();
+
+  // Returns false if FLAGS_cinn_max_shape_specializations is 0.
+  static bool IsEnabled();
+
+  // Keeps a copy of \p group, whose inputs are the operands of the jit
+  // kernel op in order. Groups without symbolic input dims are skipped.
+  void Register(const pir::OpLoweringGroupPtr& group,
+                const std::vector<::pir::Value>& group_inputs,
+                const pir::CINNKernelInfo& kernel_info);
+
+  bool IsRegistered(const std::string& fn_name) const;
+
+  // Compiles the variant of kernel \p fn_name for \p input_dims on the
+  // background thread, then calls \p done on that thread.
+  void SpecializeAsync(const std::string& fn_name,
+                       const std::vector<std::vector<int64_t>>& input_dims,
+                       Callback done);
+
+  // Compiles the variant of kernel \p fn_name for \p input_dims on the
+  // calling thread.
+  std::optional<pir::CINNKernelInfo> Specialize(
+      const std::string& fn_name,
+      const std::vector<std::vector<int64_t>>& input_dims);
+
+ private:
+  struct Entry {
+    common::Target target;
+    // Owns the ops of group, and of every variant compiled from it.
+    std::vector<std::shared_ptr<::pir::Program>> programs;
+    pir::OpLoweringGroupPtr group;
+    std::vector<::pir::Value> inputs;
+    std::mutex mu;
+  };
+
+  ShapeSpecializer() = default;
+  CINN_DISALLOW_COPY_AND_ASSIGN(ShapeSpecializer);
+
+  std::shared_ptr<Entry> GetEntry(const std::string& fn_name) const;
+  void WorkerLoop();
+
+  mutable std::mutex mu_;
+  std::unordered_map<std::string, std::shared_ptr<Entry>> entries_;
+  // The keys of entries_ in registration order.
+  std::deque<std::string> entry_order_;
+  std::condition_variable task_cv_;
+  std::deque<std::function<void()>> tasks_;
+  bool worker_started_{false};
+};
+
+}  // namespace cinn::hlir::framework
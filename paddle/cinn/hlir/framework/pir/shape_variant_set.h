@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cinn::hlir::framework {
+
+/**
+ * The static-shape variants of one dynamic-shape kernel, see
+ * ShapeSpecializer.
+ *
+ * Select is called by the thread running the kernel. It returns the variant
+ * of the input shapes if there is one, and counts the runs of the other
+ * shapes to request a variant for a hot one. Requested variants are handed
+ * back by Finish on any thread and installed by the next Select.
+ */
+template <typename KernelT>
+class ShapeVariantSet {
+ public:
+  // The rank and dims of every input.
+  using Signature = std::vector<int64_t>;
+  using RequestFn = std::function<void(const Signature&)>;
+
+  // Keeps at most \p max_variants variants, a signature is requested once
+  // it ran \p threshold times.
+  ShapeVariantSet(int max_variants, int threshold)
+      : max_variants_(max_variants), threshold_(threshold) {}
+
+  // Returns nullptr if \p signature has no variant. Calls \p request once
+  // \p signature turns hot.
+  std::shared_ptr<KernelT> Select(const Signature& signature,
+                                  const RequestFn& request) {
+    InstallFinished();
+    // There are at most max_variants_ variants.
+    for (const auto& [variant_signature, kernel] : variants_) {
+      if (variant_signature == signature) return kernel;
+    }
+    MaybeRequest(signature, request);
+    return nullptr;
+  }
+
+  // Thread safe. A null \p kernel means the variant failed to compile, the
+  // signature is not requested again.
+  void Finish(const Signature& signature, std::shared_ptr<KernelT> kernel) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    finished_.emplace_back(signature, std::move(kernel));
+    has_finished_.store(true, std::memory_order_release);
+  }
+
+  size_t size() const { return variants_.size(); }
+  int num_requested() const { return num_requested_; }
+
+ private:
+  void InstallFinished() {
+    if (!has_finished_.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& variant : finished_) {
+      --num_requested_;
+      if (variant.second) variants_.push_back(std::move(variant));
+    }
+    finished_.clear();
+    has_finished_.store(false, std::memory_order_release);
+  }
+
+  void MaybeRequest(const Signature& signature, const RequestFn& request) {
+    if (static_cast<int>(variants_.size()) + num_requested_ >= max_variants_) {
+      return;
+    }
+    // Forget the counts of cold shapes once too many shapes are seen.
+    constexpr size_t kMaxCountedShapes = 1024;
+    if (hits_.size() >= kMaxCountedShapes && hits_.count(signature) == 0) {
+      hits_.clear();
+    }
+    // Requested once, a shape that fails to compile is not tried again.
+    if (++hits_[signature] != threshold_) return;
+    ++num_requested_;
+    request(signature);
+  }
+
+  const int max_variants_;
+  const int threshold_;
+  // Only used by the thread calling Select.
+  std::vector<std::pair<Signature, std::shared_ptr<KernelT>>> variants_;
+  std::map<Signature, int> hits_;
+  int num_requested_{0};
+
+  std::mutex mutex_;
+  std::vector<std::pair<Signature, std::shared_ptr<KernelT>>> finished_;
+  std::atomic<bool> has_finished_{false};
+};
+
+}  // namespace cinn::hlir::framework
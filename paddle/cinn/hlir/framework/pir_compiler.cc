@@ -15,6 +15,9 @@
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 
+#include <algorithm>
+
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
 #include "paddle/cinn/hlir/framework/pir/utils.h"
 #include "paddle/cinn/runtime/arch_device.h"
 #include "paddle/cinn/utils/multi_threading.h"
@@ -38,6 +41,11 @@ class CompilationContextMapper {
   MutableCompilationResult() {
     return compilation_results_;
   }
+  // Key of the index-th unique group in DiskCompilationCache, empty if the
+  // on-disk cache is disabled.
+  const std::string& DiskCacheKey(size_t index) const {
+    return disk_cache_keys_[index];
+  }
 
   std::vector<pir::CINNKernelInfo> RecoverKernelInfos();
   void UpdateGlobalCache();
@@ -50,6 +58,7 @@ class CompilationContextMapper {
   std::vector<pir::FusionInfo> fusion_infos_;
   std::vector<GroupCompilationContext> group_compilation_contexts_;
   std::vector<std::shared_ptr<pir::CompilationResult>> compilation_results_;
+  std::vector<std::string> disk_cache_keys_;
 
   bool is_finalized_{false};
 };
@@ -66,6 +75,8 @@ static size_t GetThreadNum(size_t task_size) {
 
 std::vector<pir::CINNKernelInfo> PirCompiler::Build(
     const std::vector<pir::OpLoweringGroupPtr>& groups) {
+  // Before the mapper, the on-disk cache keys on the schedule configs.
+  cinn::ir::InitScheduleConfig();
   CompilationContextMapper ctx_mapper(target_, groups);
   auto& group_compilation_contexts = ctx_mapper.UniqueCompilationContexts();
   auto& compilation_results = ctx_mapper.MutableCompilationResult();
@@ -74,22 +85,65 @@ std::vector<pir::CINNKernelInfo> PirCompiler::Build(
   const size_t thread_size = GetThreadNum(task_size);
   VLOG(5) << "Found " << task_size << " new groups parsed from "
           << groups.size() << " and compiles with " << thread_size;
-  cinn::ir::InitScheduleConfig();
   if (task_size > 0) {
     // See
     // https://developer.nvidia.com/blog/cuda-pro-tip-always-set-current-device-avoid-multithreading-bugs/
     // for details.
     const auto device_id = runtime::GetArchDevice(target_);
-    auto worker_fn = [&](int index) {
+    auto& disk_cache = DiskCompilationCache::Instance();
+
+    // Stage 1: lower every group that misses the on-disk cache.
+    // Not std::vector<bool>, the threads write to different elements.
+    std::vector<int> need_backend(task_size, 1);
+    auto lowering_fn = [&](int index) {
       runtime::SetArchDevice(target_, device_id);
+      const auto& disk_cache_key = ctx_mapper.DiskCacheKey(index);
+      if (!disk_cache_key.empty()) {
+        auto result = disk_cache.Load(target_, disk_cache_key);
+        if (result != nullptr) {
+          compilation_results[index] = result;
+          need_backend[index] = 0;
+          return;
+        }
+      }
       CompilationTask task(&group_compilation_contexts[index]);
-      compilation_results[index] = task();
-      // Triggering llvm compilation in thread
-      compilation_results[index]->GetKernelInfo();
+      task.Lowering();
     };
-    utils::parallel_run(worker_fn,
+    utils::parallel_run(lowering_fn,
                         utils::SequenceDispatcher(0, task_size),
                         /*thread_num=*/thread_size);
+
+    // Stage 2: codegen, optimize and compile the lowered groups. The most
+    // expensive groups start first, so that one large group does not keep a
+    // single thread busy after all the others are done.
+    std::vector<int> backend_order;
+    for (size_t i = 0; i < task_size; ++i) {
+      if (need_backend[i]) backend_order.push_back(i);
+    }
+    std::stable_sort(backend_order.begin(),
+                     backend_order.end(),
+                     [&](int lhs, int rhs) {
+                       return group_compilation_contexts[lhs].BackendCost() >
+                              group_compilation_contexts[rhs].BackendCost();
+                     });
+    auto backend_fn = [&](int order) {
+      runtime::SetArchDevice(target_, device_id);
+      const int index = backend_order[order];
+      CompilationTask task(&group_compilation_contexts[index]);
+      compilation_results[index] = task.CodegenAndJit();
+      // Triggering llvm compilation in thread
+      compilation_results[index]->GetKernelInfo();
+      const auto& disk_cache_key = ctx_mapper.DiskCacheKey(index);
+      if (!disk_cache_key.empty()) {
+        disk_cache.Save(disk_cache_key, compilation_results[index]);
+      }
+    };
+    if (!backend_order.empty()) {
+      utils::parallel_run(
+          backend_fn,
+          utils::SequenceDispatcher(0, backend_order.size()),
+          /*thread_num=*/std::min(thread_size, backend_order.size()));
+    }
   }
   VLOG(5) << "Finished compiling " << task_size << " Cinn Kernel info.";
   ctx_mapper.SetFinalize(true);
@@ -104,6 +158,23 @@ pir::CINNKernelInfo PirCompiler::BuildBroadcastTree(
   if (CompilationCache::Instance().Has(fusion_info)) {
     return CompilationCache::Instance().GetKernelInfo(fusion_info);
   }
+  auto& disk_cache = DiskCompilationCache::Instance();
+  cinn::ir::InitScheduleConfig();
+  const std::string disk_cache_key =
+      disk_cache.IsEnabled(target_)
+          ? disk_cache.MakeKey(*origin_group,
+                               fusion_info,
+                               "broadcast_tree",
+                               cinn::ir::ScheduleConfigManager::Instance()
+                                   .PolicyFingerprint(target_))
+          : "";
+  if (!disk_cache_key.empty()) {
+    auto result = disk_cache.Load(target_, disk_cache_key);
+    if (result != nullptr) {
+      CompilationCache::Instance().Insert(fusion_info, result);
+      return result->GetKernelInfo();
+    }
+  }
   CompilationContextMapper ctx_mapper(target_, leaf_groups);
   auto& group_compilation_contexts = ctx_mapper.UniqueCompilationContexts();
   auto& compilation_results = ctx_mapper.MutableCompilationResult();
@@ -139,6 +210,7 @@ pir::CINNKernelInfo PirCompiler::BuildBroadcastTree(
         &group_compilation_contexts, shape_idx);
     const auto kernel_info = result->GetKernelInfo();
     CompilationCache::Instance().Insert(fusion_info, result);
+    if (!disk_cache_key.empty()) disk_cache.Save(disk_cache_key, result);
     return kernel_info;
   };
 
@@ -151,6 +223,14 @@ pir::CINNKernelInfo PirCompiler::BuildBroadcastTree(
 
 void CompilationContextMapper::Construct(
     const Target& target, const std::vector<pir::OpLoweringGroupPtr>& groups) {
+  auto& disk_cache = DiskCompilationCache::Instance();
+  const bool use_disk_cache = disk_cache.IsEnabled(target);
+  // Reads the tile config files, once for all the groups of the build.
+  const std::string policy_fingerprint =
+      use_disk_cache
+          ? cinn::ir::ScheduleConfigManager::Instance().PolicyFingerprint(
+                target)
+          : "";
   std::unordered_set<size_t> unique_infos;
   const auto IsNewAndUnique =
       [&unique_infos](const pir::FusionInfo& info) -> bool {
@@ -170,6 +250,11 @@ void CompilationContextMapper::Construct(
       group_compilation_contexts_.emplace_back(target, groups[i]);
       compilation_results_.push_back(
           std::make_shared<pir::CompilationResult>(target));
+      disk_cache_keys_.push_back(
+          use_disk_cache
+              ? disk_cache.MakeKey(
+                    *groups[i], fusion_infos_[i], "group", policy_fingerprint)
+              : "");
     }
     unique_infos.insert(fusion_infos_[i].hash());
   }
@@ -14,6 +14,10 @@
 
 #include "paddle/cinn/ir/group_schedule/config/database.h"
 
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
 namespace cinn {
 namespace ir {
 
@@ -46,5 +50,26 @@ TileConfigMap NaiveTileConfigDatabase::GetConfigs(
   return config_map_.at(iter_space_type);
 }
 
+std::string NaiveTileConfigDatabase::Fingerprint(
+    const common::Target& target) const {
+  // The buckets are unordered, sort them to get a stable string.
+  std::vector<std::string> lines;
+  for (const auto& [iter_space_type, tile_config_map] : config_map_) {
+    for (const auto& [bucket_info, config] : tile_config_map) {
+      std::stringstream ss;
+      ss << bucket_info.ToString() << ": " << config.warp_num << ", "
+         << config.tree_reduce_num << ", " << config.spatial_inner_num << ", "
+         << config.vectorize_width << ", " << config.parallel_grain;
+      lines.push_back(ss.str());
+    }
+  }
+  std::sort(lines.begin(), lines.end());
+  std::stringstream ss;
+  for (const auto& line : lines) {
+    ss << line << "\n";
+  }
+  return ss.str();
+}
+
 }  // namespace ir
 }  // namespace cinn
@@ -39,6 +39,9 @@ class TileConfigDatabase {
   virtual TileConfigMap GetConfigs(
       const common::Target& target,
       const IterSpaceType& iter_space_type) const = 0;
+
+  // Changes whenever a config the database serves for \p target changes.
+  virtual std::string Fingerprint(const common::Target& target) const = 0;
 };
 
 class NaiveTileConfigDatabase final : public TileConfigDatabase {
@@ -51,6 +54,8 @@ class NaiveTileConfigDatabase final : public TileConfigDatabase {
   TileConfigMap GetConfigs(const common::Target& target,
                            const IterSpaceType& iter_space_type) const override;
 
+  std::string Fingerprint(const common::Target& target) const override;
+
  private:
   std::map<IterSpaceType, TileConfigMap> config_map_;
 };
@@ -14,11 +14,16 @@
 
 #include "paddle/cinn/ir/group_schedule/config/file_database.h"
 
+#include <dirent.h>
 #include <sys/stat.h>
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/json_util.h>
+#include <algorithm>
 #include <fstream>
+#include <functional>
+#include <iterator>
+#include <sstream>
 
 #include "paddle/cinn/utils/multi_threading.h"
 
@@ -61,6 +66,8 @@ bool TileConfigToProto(group_schedule::config::proto::TileData* tile_data,
     tc.set_warp_num(it.second.warp_num);
     tc.set_tree_reduce_num(it.second.tree_reduce_num);
     tc.set_spatial_inner_num(it.second.spatial_inner_num);
+    tc.set_vectorize_width(it.second.vectorize_width);
+    tc.set_parallel_grain(it.second.parallel_grain);
     *(tile_data->mutable_tile_config()) = tc;
     tile_data->set_priority(priority);
   }
@@ -228,6 +235,10 @@ TileConfigMap FileTileConfigDatabase::GetConfigs(
     tconfig.spatial_inner_num =
         piece_tileconfig.tile_config().spatial_inner_num();
     tconfig.warp_num = piece_tileconfig.tile_config().warp_num();
+    // Configs written before the x86 fields existed read them as 0.
+    tconfig.vectorize_width =
+        std::max<int64_t>(piece_tileconfig.tile_config().vectorize_width(), 1);
+    tconfig.parallel_grain = piece_tileconfig.tile_config().parallel_grain();
     tile_config_map[bucket_info] = tconfig;
     // TODO(XiaZichao): Add function to cut one lattice into smaller ones
   }
@@ -235,6 +246,40 @@ TileConfigMap FileTileConfigDatabase::GetConfigs(
   return tile_config_map;
 }
 
+std::string FileTileConfigDatabase::Fingerprint(
+    const common::Target& target) const {
+  // The files are <root>/<target>/<dirname>/<filename>.json, see
+  // IterSpaceTypeToDir.
+  const std::string target_path = FLAGS_cinn_tile_config_filename_label +
+                                  target.arch_str() + "_" +
+                                  target.device_name_str();
+  auto ListDir = [](const std::string& path) {
+    std::vector<std::string> names;
+    DIR* dir = opendir(path.c_str());
+    if (dir == nullptr) return names;
+    while (struct dirent* entry = readdir(dir)) {
+      const std::string name = entry->d_name;
+      if (name != "." && name != "..") names.push_back(name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+  };
+  std::stringstream ss;
+  for (const auto& dirname : ListDir(target_path)) {
+    const std::string dir_path = target_path + "/" + dirname;
+    for (const auto& filename : ListDir(dir_path)) {
+      std::ifstream is(dir_path + "/" + filename);
+      if (!is.good()) continue;
+      std::string content((std::istreambuf_iterator<char>(is)),
+                          std::istreambuf_iterator<char>());
+      ss << dirname << "/" << filename << ": "
+         << std::hash<std::string>()(content) << "\n";
+    }
+  }
+  return ss.str();
+}
+
 void FileTileConfigDatabase::AddConfig(const common::Target& target,
                                        const BucketInfo& bucket_info,
                                        const ScheduleConfig::TileConfig& config,
@@ -27,6 +27,8 @@ class FileTileConfigDatabase final : public TileConfigDatabase {
                  int priority) override;
   TileConfigMap GetConfigs(const common::Target& target,
                            const IterSpaceType& iter_space_type) const override;
+  // Hashes the contents of every config file of \p target.
+  std::string Fingerprint(const common::Target& target) const override;
 
  private:
   TileConfigMap target_config_data_;
@@ -14,6 +14,9 @@
 
 #include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
 #include "paddle/cinn/hlir/framework/pir/op_lowering_impl.h"
+#include "paddle/common/flags.h"
+
+PD_DECLARE_bool(cinn_cpu_tile_tactic);
 
 namespace cinn {
 namespace ir {
@@ -443,6 +446,41 @@ BuildDynamicShapeConfig(
   return {{bucket_info, tile_config}};
 }
 
+std::unordered_map<BucketInfo, ScheduleConfig::TileConfig, BucketInfoHash>
+BuildCpuConfig(const std::shared_ptr<ScheduleConfig::BaseInfo>& base_info,
+               const common::Target& target) {
+  // Elements a task of the parallel loop should process at least, so that
+  // launching the task costs little compared to running it.
+  constexpr int64_t kMinElementsPerTask = 16384;
+  const bool sp_is_dynamic = base_info->has_dynamic_spatial;
+  const bool rb_is_dynamic = base_info->has_dynamic_reduce;
+  const int64_t reduce_numel = rb_is_dynamic ? 256 : base_info->reduce_numel;
+
+  int64_t parallel_grain =
+      std::max<int64_t>(kMinElementsPerTask / reduce_numel, 1);
+  if (!sp_is_dynamic &&
+      base_info->spatial_numel * reduce_numel < 4 * kMinElementsPerTask) {
+    // Too small to be worth a parallel launch.
+    parallel_grain = 0;
+  }
+  const bool sp_is_one = !sp_is_dynamic && base_info->spatial_numel == 1;
+  const bool rb_is_one = !rb_is_dynamic && base_info->reduce_numel == 1;
+  BucketInfo bucket_info{/* sp_lower_bound = */ 1,
+                         /* sp_upper_bound = */ sp_is_one ? 1 : kMaxNumel,
+                         /* rb_lower_bound = */ 1,
+                         /* rb_upper_bound = */ rb_is_one ? 1 : kMaxNumel,
+                         /* sp_is_dynamic = */ sp_is_dynamic,
+                         /* rb_is_dynamic = */ rb_is_dynamic};
+  ScheduleConfig::TileConfig tile_config{
+      /* warp_num = */ 1,
+      /* tree_reduce_num = */ 1,
+      /* spatial_inner_num = */ 1,
+      /* reduce_method = */ NoneReduceMethod(),
+      /* vectorize_width = */ 8,
+      /* parallel_grain = */ parallel_grain};
+  return {{bucket_info, tile_config}};
+}
+
 std::unordered_map<BucketInfo, ScheduleConfig, BucketInfoHash>
 CombineBaseInfoAndConfig(
     const std::unordered_map<BucketInfo,
@@ -463,6 +501,11 @@ BuildScheduleConfig(
     const common::Target& target) {
   std::shared_ptr<ScheduleConfig::BaseInfo> base_info =
       InitBasicInfo(group_info);
+  if (UseCpuTileTactic(target)) {
+    VLOG(6) << "Building x86 config.";
+    return CombineBaseInfoAndConfig(BuildCpuConfig(base_info, target),
+                                    base_info);
+  }
   if (!base_info->has_dynamic_reduce && !base_info->has_dynamic_spatial) {
     VLOG(6) << "Building static sptial and static reduce config.";
     return CombineBaseInfoAndConfig(
@@ -482,5 +525,15 @@ BuildScheduleConfig(
   }
 }
 
+bool UseCpuTileTactic(const common::Target& target) {
+  if (!FLAGS_cinn_cpu_tile_tactic) return false;
+  return target.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) { return false; });
+}
+
 }  // namespace ir
 }  // namespace cinn
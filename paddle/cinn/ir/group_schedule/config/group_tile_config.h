@@ -52,6 +52,11 @@ struct ScheduleConfig {
     int64_t tree_reduce_num{1};
     int64_t spatial_inner_num{1};
     ReduceMethod reduce_method{NoneReduceMethod()};
+    // Only used by x86 kernels: the lanes of the innermost spatial loop, and
+    // the spatial iterations of a task of the outer parallel loop, 0 means
+    // the kernel runs serially.
+    int64_t vectorize_width{1};
+    int64_t parallel_grain{0};
   };
 
   std::shared_ptr<BaseInfo> base_info;
@@ -132,5 +137,10 @@ BuildScheduleConfig(
     const std::shared_ptr<hlir::framework::pir::GroupInfo>& group_info,
     const common::Target& target);
 
+// Whether the groups of \p target are scheduled by CpuTileTactic, which
+// reads the x86 fields of the tile config. Only x86 groups are, and only
+// with FLAGS_cinn_cpu_tile_tactic.
+bool UseCpuTileTactic(const common::Target& target);
+
 }  // namespace ir
 }  // namespace cinn
@@ -59,6 +59,14 @@ void ScheduleConfigManager::SetPolicy(const std::string& policy) {
   policy_ = policy;
 }
 
+std::string ScheduleConfigManager::PolicyFingerprint(
+    const common::Target& target) const {
+  if (policy_ == "default" || tile_config_data_.count(policy_) == 0) {
+    return "default\n";
+  }
+  return policy_ + "\n" + tile_config_data_.at(policy_)->Fingerprint(target);
+}
+
 void InitScheduleConfig() {
   auto& schedule_config_manager = cinn::ir::ScheduleConfigManager::Instance();
   std::string policy;
@@ -32,6 +32,10 @@ class ScheduleConfigManager {
 
   void SetPolicy(const std::string& policy);
 
+  // The policy, and the stored configs ExtractConfigs reads with it for
+  // \p target. Caches of compiled groups key on it.
+  std::string PolicyFingerprint(const common::Target& target) const;
+
  private:
   ScheduleConfigManager() = default;
   ~ScheduleConfigManager() = default;
@@ -16,6 +16,7 @@
 #include "paddle/cinn/common/cas.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 #include "paddle/cinn/ir/group_schedule/tactic/compute_inline_tactic.h"
+#include "paddle/cinn/ir/group_schedule/tactic/cpu_tile_tactic.h"
 #include "paddle/cinn/ir/group_schedule/tactic/tile_first_general_tactic.h"
 #include "paddle/cinn/ir/ir_analyzer/ir_analyzer.h"
 #include "paddle/cinn/ir/op/ir_operators.h"
@@ -32,8 +33,13 @@ void DynamicShapeGroupScheduler::Init() {
   VLOG(4) << "original group func body: \n"
           << ir_sch_->GetModule().GetExprs()[0];
   InitBuckets();
-  tactics_.emplace_back(CreateTileFirstGeneralTactic());
-  VLOG(4) << "CreateTileFirstGeneralTactic End";
+  if (UseCpuTileTactic(target_)) {
+    tactics_.emplace_back(CreateCpuTileTactic());
+    VLOG(4) << "CreateCpuTileTactic End";
+  } else {
+    tactics_.emplace_back(CreateTileFirstGeneralTactic());
+    VLOG(4) << "CreateTileFirstGeneralTactic End";
+  }
   tactics_.emplace_back(CreateComputeInlineTactic());
   VLOG(4) << "CreateTileCreateComputeInlineTactic End";
 }
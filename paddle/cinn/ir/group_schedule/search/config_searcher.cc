@@ -16,6 +16,7 @@
 
 #include "paddle/cinn/ir/group_schedule/search/config_searcher.h"
 #include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/file_database.h"
 #include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
 #include "paddle/cinn/utils/string.h"
 
@@ -23,16 +24,51 @@ namespace cinn {
 namespace ir {
 namespace search {
 
+// The priority of searched configs in the file database.
+constexpr int kSearchedConfigPriority = 0;
+
+ScheduleConfig::TileConfig CandidateToTileConfig(
+    const common::Target& target, const CandidateType& candidate) {
+  PADDLE_ENFORCE_EQ(candidate.size(),
+                    3,
+                    ::common::errors::InvalidArgument(
+                        "A candidate should have 3 elements, but got %d.",
+                        candidate.size()));
+  ScheduleConfig::TileConfig config;
+  if (UseCpuTileTactic(target)) {
+    config.vectorize_width = candidate[0];
+    config.parallel_grain = candidate[1];
+    config.tree_reduce_num = candidate[2];
+  } else {
+    config.warp_num = candidate[0];
+    config.tree_reduce_num = candidate[1];
+    config.spatial_inner_num = candidate[2];
+  }
+  return config;
+}
+
+void SaveBestCandidate(const common::Target& target,
+                       const BucketInfo& bucket_info,
+                       const CandidateType& candidate) {
+  FileTileConfigDatabase file_database;
+  file_database.AddConfig(target,
+                          bucket_info,
+                          CandidateToTileConfig(target, candidate),
+                          kSearchedConfigPriority);
+}
+
 WeightedSamplingTrailObjectiveFunc::WeightedSamplingTrailObjectiveFunc(
     ::pir::Program* program,
     const BucketInfo& bucket_info,
     double sampling_prob,
     int max_sampling_times,
     int repeats,
-    std::vector<std::vector<double>> weights)
+    std::vector<std::vector<double>> weights,
+    const common::Target& target)
     : program_(program),
       bucket_info_(bucket_info),
-      measurer_(program),
+      target_(target),
+      measurer_(program, target),
       sampling_prob_(sampling_prob),
       max_sampling_times_(max_sampling_times),
       repeats_(repeats) {
@@ -98,10 +134,8 @@ ScoreType WeightedSamplingTrailObjectiveFunc::operator()(
   auto tile_config_database = std::make_shared<NaiveTileConfigDatabase>();
   VLOG(3) << "Bucket_info_.space.size is " << bucket_info_.space.size();
   if (candidate.size() != 0) {
-    ScheduleConfig::TileConfig config{
-        candidate[0], candidate[1], candidate[2], NoneReduceMethod()};
     tile_config_database->AddConfig(
-        cinn::common::DefaultTarget(), bucket_info_, config);
+        target_, bucket_info_, CandidateToTileConfig(target_, candidate));
     auto& schedule_config_manager = ScheduleConfigManager::Instance();
     schedule_config_manager.AddConfigDatabase("search", tile_config_database);
   }
@@ -37,6 +37,18 @@ class BaseObjectiveFunc {
   virtual ScoreType operator()(const CandidateType& candidate) = 0;
 };
 
+// Converts a candidate to a tile config. If UseCpuTileTactic(target) a
+// candidate is {vectorize_width, parallel_grain, tree_reduce_num}, otherwise
+// it is {warp_num, tree_reduce_num, spatial_inner_num}.
+ScheduleConfig::TileConfig CandidateToTileConfig(
+    const common::Target& target, const CandidateType& candidate);
+
+// Writes the best candidate of a bucket to the file database, where the
+// "optimal" and "hybrid" tile config policies read it.
+void SaveBestCandidate(const common::Target& target,
+                       const BucketInfo& bucket_info,
+                       const CandidateType& candidate);
+
 class WeightedSamplingTrailObjectiveFunc : public BaseObjectiveFunc {
  public:
   WeightedSamplingTrailObjectiveFunc(
@@ -45,13 +57,15 @@ class WeightedSamplingTrailObjectiveFunc : public BaseObjectiveFunc {
       double sampling_prob = 1.0,
       int max_sampling_times = 65536,
       int repeats = 80,
-      std::vector<std::vector<double>> weights = {});
+      std::vector<std::vector<double>> weights = {},
+      const common::Target& target = common::DefaultTarget());
 
   ScoreType operator()(const CandidateType& candidate) override;
 
  private:
   ::pir::Program* program_;
   BucketInfo bucket_info_;
+  common::Target target_;
   Measurer measurer_;
   double sampling_prob_;
   int max_sampling_times_;
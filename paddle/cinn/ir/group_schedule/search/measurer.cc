@@ -16,11 +16,19 @@
 
 #include "paddle/cinn/ir/group_schedule/search/measurer.h"
 
+#include <cstring>
+
 #include "paddle/cinn/hlir/dialect/operator/ir/op_dialect.h"
 #include "paddle/cinn/hlir/dialect/operator/transforms/add_cinn_pass.h"
+#include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
+#include "paddle/cinn/runtime/cinn_runtime.h"
 #include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_type.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/fluid/pir/dialect/operator/utils/utils.h"
 #include "paddle/fluid/pir/transforms/build_cinn_pass.h"
 #include "paddle/fluid/pir/transforms/pd_op_to_kernel_pass.h"
+#include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_dialect.h"
 #include "paddle/pir/include/core/builtin_type.h"
 #include "paddle/pir/include/core/program.h"
@@ -47,14 +55,31 @@ std::shared_ptr<pir::PassManager> CreatePassManager() {
   return pass_manager;
 }
 
-Measurer::Measurer(::pir::Program* program) : program_(program) {
+Measurer::Measurer(::pir::Program* program, const common::Target& target)
+    : program_(program), target_(target) {
   std::stringstream ss;
   ss << *program_;
   compile_label_ = "Compile Program\n" + ss.str();
   execute_label_ = "Execute Program\n" + ss.str();
+  if (IsHost()) {
+    place_ = phi::CPUPlace();
+  }
+}
+
+bool Measurer::IsHost() const {
+  return target_.arch.Match(
+      [&](common::X86Arch) { return true; },
+      [&](std::variant<common::UnknownArch,
+                       common::ARMArch,
+                       common::NVGPUArch,
+                       common::HygonDCUArchHIP>) { return false; });
 }
 
 void Measurer::Compile() {
+  if (IsHost()) {
+    CompileForHost();
+    return;
+  }
   common::PerformanceStatisticsStart(compile_label_);
   ::pir::IrMapping ir_mapping;
   std::shared_ptr<::pir::Program> program_cloned = program_->Clone(ir_mapping);
@@ -82,9 +107,173 @@ std::string ConcatShapeAsLabel(
   return label;
 }
 
+void Measurer::CompileForHost() {
+  PADDLE_ENFORCE_EQ(
+      common::DefaultDeviceTarget() == common::DefaultHostTarget(),
+      true,
+      ::common::errors::Unimplemented(
+          "CINN compiles the fusion groups for the device target, measuring "
+          "x86 kernels needs a build without device."));
+  common::PerformanceStatisticsStart(compile_label_);
+  ::pir::IrMapping ir_mapping;
+  jit_program_ = program_->Clone(ir_mapping);
+  cinn::dialect::ir::ApplyCinnPass(jit_program_.get(), CreatePassManager);
+  common::PerformanceStatisticsEnd(compile_label_);
+}
+
+void Measurer::RunOnHost(
+    const std::unordered_map<std::string, std::vector<int64_t>>&
+        input_name_and_shape,
+    int repeat) {
+  using CINNKernelInfo = cinn::hlir::framework::pir::CINNKernelInfo;
+  using KernelFunc = void (*)(void*, int32_t, void*);
+  using InferShapeFunc = void (*)(void*, int32_t, int64_t**);
+
+  // The inputs are random with a fixed seed, so that every run of the same
+  // program sees the same data and the kernels do not measure a zero fast
+  // path. The outputs are zeroed.
+  std::mt19937 engine(kHostInputSeed);
+  const auto Allocate =
+      [&](::pir::Value value, phi::DenseTensor* tensor, bool random) {
+        const phi::DataType dtype = paddle::dialect::TransToPhiDataType(
+            value.type().dyn_cast<paddle::dialect::DenseTensorType>().dtype());
+        void* data = tensor->mutable_data(place_, dtype);
+        const int64_t numel = tensor->numel();
+        if (random && dtype == phi::DataType::FLOAT32) {
+          std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+          float* ptr = static_cast<float*>(data);
+          for (int64_t i = 0; i < numel; ++i) ptr[i] = dist(engine);
+        } else if (random && dtype == phi::DataType::FLOAT64) {
+          std::uniform_real_distribution<double> dist(-1.0, 1.0);
+          double* ptr = static_cast<double*>(data);
+          for (int64_t i = 0; i < numel; ++i) ptr[i] = dist(engine);
+        } else if (random && dtype == phi::DataType::INT32) {
+          std::uniform_int_distribution<int32_t> dist(0, 7);
+          int32_t* ptr = static_cast<int32_t*>(data);
+          for (int64_t i = 0; i < numel; ++i) ptr[i] = dist(engine);
+        } else if (random && dtype == phi::DataType::INT64) {
+          std::uniform_int_distribution<int64_t> dist(0, 7);
+          int64_t* ptr = static_cast<int64_t*>(data);
+          for (int64_t i = 0; i < numel; ++i) ptr[i] = dist(engine);
+        } else {
+          std::memset(data, 0, numel * phi::SizeOf(dtype));
+        }
+      };
+
+  struct Kernel {
+    CINNKernelInfo info;
+    std::vector<cinn_buffer_t> buffers;
+    std::vector<cinn_pod_value_t> args;
+  };
+  std::unordered_map<::pir::Value, phi::DenseTensor> tensors;
+  std::vector<Kernel> kernels;
+  for (auto& op : *jit_program_->block()) {
+    if (op.isa<paddle::dialect::DataOp>()) {
+      const std::string name =
+          op.attribute<::pir::StrAttribute>("name").AsString();
+      const auto iter = input_name_and_shape.find(name);
+      PADDLE_ENFORCE_NE(iter,
+                        input_name_and_shape.end(),
+                        ::common::errors::InvalidArgument(
+                            "The shape of input %s is not given.", name));
+      phi::DenseTensor* tensor = &tensors[op.result(0)];
+      tensor->Resize(phi::make_ddim(iter->second));
+      Allocate(op.result(0), tensor, /* random = */ true);
+    } else if (op.isa<cinn::dialect::JitKernelOp>()) {
+      Kernel kernel;
+      kernel.info =
+          op.dyn_cast<cinn::dialect::JitKernelOp>().cinn_kernel_info();
+      std::vector<phi::DenseTensor*> kernel_tensors;
+      for (size_t i = 0; i < op.num_operands(); ++i) {
+        kernel_tensors.push_back(&tensors.at(op.operand_source(i)));
+      }
+      for (size_t i = 0; i < op.num_results(); ++i) {
+        kernel_tensors.push_back(&tensors[op.result(i)]);
+      }
+      kernel.buffers.resize(kernel_tensors.size());
+      for (size_t i = 0; i < kernel_tensors.size(); ++i) {
+        kernel.args.emplace_back(&kernel.buffers[i]);
+      }
+      for (const auto& int_arg : kernel.info.int_args_map) {
+        const auto& dims = kernel_tensors[int_arg.second.arg_idx]->dims();
+        kernel.args.emplace_back(
+            static_cast<int64_t>(dims.at(int_arg.second.dim_idx)));
+      }
+
+      // Infer the output shapes, then allocate the outputs.
+      std::vector<std::vector<int64_t>> out_shapes;
+      std::vector<int64_t*> out_shape_ptrs;
+      for (size_t i = 0; i < op.num_results(); ++i) {
+        const auto rank = op.result(i)
+                              .type()
+                              .dyn_cast<paddle::dialect::DenseTensorType>()
+                              .dims()
+                              .size();
+        out_shapes.emplace_back(rank);
+      }
+      for (auto& shape : out_shapes) out_shape_ptrs.push_back(shape.data());
+      reinterpret_cast<InferShapeFunc>(kernel.info.infer_shape_fn_ptr)(
+          static_cast<void*>(kernel.args.data()),
+          kernel.args.size(),
+          out_shape_ptrs.data());
+      for (size_t i = 0; i < op.num_results(); ++i) {
+        phi::DenseTensor* tensor = &tensors[op.result(i)];
+        tensor->Resize(phi::make_ddim(out_shapes[i]));
+        Allocate(op.result(i), tensor, /* random = */ false);
+      }
+      for (size_t i = 0; i < kernel_tensors.size(); ++i) {
+        kernel.buffers[i].memory =
+            reinterpret_cast<uint8_t*>(kernel_tensors[i]->data());
+      }
+      kernels.emplace_back(std::move(kernel));
+    } else if (op.isa<paddle::dialect::FetchOp>()) {
+      const std::string name =
+          op.attribute<::pir::StrAttribute>("name").AsString();
+      const auto iter = tensors.find(op.operand_source(0));
+      PADDLE_ENFORCE_NE(iter,
+                        tensors.end(),
+                        ::common::errors::Unimplemented(
+                            "The output %s is not computed by a jit kernel.",
+                            name));
+      host_outputs_[name] = iter->second;
+    } else if (op.dialect()->name() != "builtin") {
+      PADDLE_THROW(::common::errors::Unimplemented(
+          "Measuring %s on x86 is not supported.", op.name()));
+    }
+  }
+
+  std::string intput_shape_label = ConcatShapeAsLabel(input_name_and_shape);
+  common::PerformanceStatistician& ps =
+      common::PerformanceStatistician::Instance();
+  for (int i = 0; i < repeat; ++i) {
+    ps.Start(execute_label_ + "\n" + intput_shape_label);
+    for (auto& kernel : kernels) {
+      ps.Start(FLAGS_cinn_kernel_execution_label);
+      reinterpret_cast<KernelFunc>(kernel.info.fn_ptr)(
+          static_cast<void*>(kernel.args.data()), kernel.args.size(), nullptr);
+      ps.End(FLAGS_cinn_kernel_execution_label);
+    }
+    ps.End(execute_label_ + "\n" + intput_shape_label);
+  }
+}
+
+const phi::DenseTensor& Measurer::HostOutput(const std::string& name) const {
+  const auto iter = host_outputs_.find(name);
+  PADDLE_ENFORCE_NE(iter,
+                    host_outputs_.end(),
+                    ::common::errors::NotFound(
+                        "The output %s is not fetched by a run on the host.",
+                        name));
+  return iter->second;
+}
+
 void Measurer::Run(const std::unordered_map<std::string, std::vector<int64_t>>&
                        input_name_and_shape,
                    int repeat) {
+  if (IsHost()) {
+    RunOnHost(input_name_and_shape, repeat);
+    return;
+  }
   std::vector<std::string> input_names;
   std::vector<phi::DenseTensor> input_tensors;
   for (const auto item : input_name_and_shape) {
@@ -18,12 +18,15 @@
 #include <map>
 #include <random>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "paddle/cinn/common/target.h"
 #include "paddle/common/performance_statistician.h"
 #include "paddle/fluid/framework/new_executor/interpretercore.h"
 #include "paddle/fluid/framework/scope.h"
 #include "paddle/phi/common/place.h"
+#include "paddle/phi/core/dense_tensor.h"
 #include "paddle/pir/include/core/program.h"
 
 namespace cinn {
@@ -37,9 +40,12 @@ struct MeasureResult {
   std::string err_msg;
 };
 
+// Compiles a program with CINN and measures its kernels. On x86 the kernels
+// run on host buffers directly instead of through an executor.
 class Measurer {
  public:
-  explicit Measurer(::pir::Program* program);
+  explicit Measurer(::pir::Program* program,
+                    const common::Target& target = common::DefaultTarget());
 
   void Compile();
 
@@ -49,11 +55,27 @@ class Measurer {
 
   MeasureResult Result() const;
 
+  // The fetched output \p name of the last Run on x86.
+  const phi::DenseTensor& HostOutput(const std::string& name) const;
+
  private:
+  static constexpr uint32_t kHostInputSeed = 2024;
+
+  bool IsHost() const;
+  void CompileForHost();
+  void RunOnHost(const std::unordered_map<std::string, std::vector<int64_t>>&
+                     input_name_and_shape,
+                 int repeat);
+
   std::string compile_label_;
   std::string execute_label_;
   ::pir::Program* program_;
+  common::Target target_;
   phi::Place place_ = phi::GPUPlace(0);
+  // The program with its fusion groups replaced by jit kernels, only used on
+  // x86.
+  std::shared_ptr<::pir::Program> jit_program_;
+  std::unordered_map<std::string, phi::DenseTensor> host_outputs_;
   std::unique_ptr<pir::Program> kernel_program_;
   std::unique_ptr<paddle::framework::Scope> exe_scope_ =
       std::make_unique<paddle::framework::Scope>();
@@ -0,0 +1,202 @@
+// Copyright (c) 2024 CINN Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/ir/group_schedule/tactic/cpu_tile_tactic.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+#include "paddle/cinn/ir/ir.h"
+#include "paddle/cinn/ir/utils/ir_nodes_collector.h"
+
+namespace cinn {
+namespace ir {
+
+/**
+ * Tiles the loops of every block for x86 kernels:
+ *
+ * 1. Fuses the spatial loops and the reduce loops, [S, S, R, R] => [S, R].
+ * 2. Splits the spatial loop of an elementwise block by vectorize_width and
+ *    vectorizes the inner loop, [S] => [S(-1), S(vectorize_width)].
+ * 3. Splits the reduce loop of a reduce block by tree_reduce_num and
+ *    unrolls the inner loop, [S, R] => [S, R(-1), R(tree_reduce_num)].
+ * 4. Splits the outer spatial loop into tasks of parallel_grain iterations
+ *    and runs the tasks in parallel.
+ *
+ * Vectorizing and unrolling only apply to loops whose extent is a multiple of
+ * the factor.
+ */
+class CpuTileTactic final : public ScheduleTactic {
+ public:
+  void Init(ScheduleContext* context) override;
+
+  void Apply(ir::IRSchedule* sch, const std::string& block_id) override;
+
+  std::string TacticName() const override { return "CpuTileTactic"; }
+
+ private:
+  // Fuses the loops of the block into [S], [S, R] or [R]. Returns false if
+  // the reduce loops are not the innermost ones.
+  bool MergeLoops(ir::IRSchedule* sch, const std::string& block_id);
+  void VectorizeSpatialInner(ir::IRSchedule* sch, const std::string& block_id);
+  void UnrollReduceInner(ir::IRSchedule* sch, const std::string& block_id);
+  void ParallelSpatialOuter(ir::IRSchedule* sch, const std::string& block_id);
+
+ private:
+  ScheduleContext* context_;
+  // The reduce loops and whether the innermost loop is vectorized, of the
+  // block being scheduled.
+  int num_reduce_loops_{0};
+  bool is_vectorized_{false};
+};
+
+namespace {
+
+bool IsConstantMultipleOf(const ir::Expr& loop, int64_t factor) {
+  const ir::Expr& extent = loop.As<ir::For>()->extent;
+  if (!extent.is_constant()) return false;
+  const int64_t extent_value = static_cast<int64_t>(extent.get_constant());
+  return extent_value > factor && extent_value % factor == 0;
+}
+
+std::vector<int> ReduceLoopIndices(ir::IRSchedule* sch,
+                                   const std::string& block_id) {
+  const std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  const ir::Expr block = sch->GetBlock(block_id);
+  const auto* realize = block.As<ir::ScheduleBlockRealize>();
+  const auto* schedule_block = realize->schedule_block.As<ir::ScheduleBlock>();
+  std::unordered_set<std::string> reduce_loop_vars;
+  for (size_t i = 0; i < schedule_block->iter_vars.size(); ++i) {
+    if (!schedule_block->iter_vars[i]->is_reduce_axis) continue;
+    ir::ir_utils::CollectIRNodesWithoutTensor(
+        realize->iter_values[i], [&](const ir::Expr* x) {
+          if (x->as_var()) reduce_loop_vars.insert(x->as_var()->name);
+          return false;
+        });
+  }
+  std::vector<int> indices;
+  for (int i = 0; i < loops.size(); ++i) {
+    if (reduce_loop_vars.count(loops[i].As<ir::For>()->loop_var->name) > 0) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+}  // namespace
+
+void CpuTileTactic::Init(ScheduleContext* context) { context_ = context; }
+
+void CpuTileTactic::Apply(ir::IRSchedule* sch, const std::string& block_id) {
+  if (ir::IsReduceInitTensorName(block_id)) return;
+  if (!MergeLoops(sch, block_id)) {
+    VLOG(4) << "Skip CpuTileTactic on block: [" << block_id
+            << "], its reduce loops are not the innermost ones";
+    return;
+  }
+  VLOG(6) << "After MergeLoops on block: [" << block_id << "], loop nest:\n"
+          << sch->GetLoops(block_id)[0];
+  if (num_reduce_loops_ > 0) {
+    UnrollReduceInner(sch, block_id);
+  } else {
+    VectorizeSpatialInner(sch, block_id);
+  }
+  ParallelSpatialOuter(sch, block_id);
+  VLOG(6) << "After CpuTileTactic on block: [" << block_id << "], loop nest:\n"
+          << sch->GetLoops(block_id)[0];
+}
+
+bool CpuTileTactic::MergeLoops(ir::IRSchedule* sch,
+                               const std::string& block_id) {
+  const int num_loops = sch->GetLoops(block_id).size();
+  const std::vector<int> reduce_indices = ReduceLoopIndices(sch, block_id);
+  const int num_spatial = num_loops - reduce_indices.size();
+  for (int i = 0; i < reduce_indices.size(); ++i) {
+    if (reduce_indices[i] != num_spatial + i) return false;
+  }
+  num_reduce_loops_ = reduce_indices.empty() ? 0 : 1;
+  is_vectorized_ = false;
+  // Fuse from bottom to top, fusing the upper loops changes the indices of
+  // the lower ones.
+  if (reduce_indices.size() >= 2) {
+    sch->Fuse(block_id, reduce_indices);
+  }
+  if (num_spatial >= 2) {
+    std::vector<int> spatial_indices(num_spatial);
+    std::iota(spatial_indices.begin(), spatial_indices.end(), 0);
+    sch->Fuse(block_id, spatial_indices);
+  }
+  return true;
+}
+
+void CpuTileTactic::VectorizeSpatialInner(ir::IRSchedule* sch,
+                                          const std::string& block_id) {
+  const int64_t vectorize_width =
+      context_->config.tile_config.vectorize_width;
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  if (vectorize_width <= 1 || loops.empty() ||
+      !IsConstantMultipleOf(loops.back(), vectorize_width)) {
+    return;
+  }
+  // [S] => [S(-1), S(vectorize_width)]
+  auto split_loops = sch->Split(
+      loops.back(), std::vector<int>{-1, static_cast<int>(vectorize_width)});
+  sch->Vectorize(split_loops.back(), vectorize_width);
+  is_vectorized_ = true;
+}
+
+void CpuTileTactic::UnrollReduceInner(ir::IRSchedule* sch,
+                                      const std::string& block_id) {
+  const int64_t unroll_factor = context_->config.tile_config.tree_reduce_num;
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  if (unroll_factor <= 1 ||
+      !IsConstantMultipleOf(loops.back(), unroll_factor)) {
+    return;
+  }
+  // [S, R] => [S, R(-1), R(tree_reduce_num)]
+  auto split_loops = sch->Split(
+      loops.back(), std::vector<int>{-1, static_cast<int>(unroll_factor)});
+  sch->Unroll(split_loops.back());
+  ++num_reduce_loops_;
+}
+
+void CpuTileTactic::ParallelSpatialOuter(ir::IRSchedule* sch,
+                                         const std::string& block_id) {
+  int64_t parallel_grain = context_->config.tile_config.parallel_grain;
+  std::vector<ir::Expr> loops = sch->GetLoops(block_id);
+  // A pure reduce block has no spatial loop to parallelize.
+  if (parallel_grain <= 0 || loops.size() <= num_reduce_loops_) return;
+
+  if (is_vectorized_) {
+    // The outer loop iterates over vectors.
+    parallel_grain = std::max<int64_t>(
+        parallel_grain / context_->config.tile_config.vectorize_width, 1);
+  }
+  const ir::Expr& extent = loops[0].As<ir::For>()->extent;
+  if (extent.is_constant() && extent.get_constant() <= parallel_grain) {
+    return;
+  }
+  if (parallel_grain > 1) {
+    // [S, ...] => [S(-1), S(parallel_grain), ...]
+    loops = sch->Split(loops[0],
+                       std::vector<int>{-1, static_cast<int>(parallel_grain)});
+  }
+  sch->Parallel(loops[0]);
+}
+
+std::unique_ptr<ScheduleTactic> CreateCpuTileTactic() {
+  return std::make_unique<CpuTileTactic>();
+}
+
+}  // namespace ir
+}  // namespace cinn
@@ -14,7 +14,13 @@
 
 #include "paddle/cinn/runtime/cpu/thread_backend.h"
 
+#include <glog/logging.h>
+
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #ifdef CINN_USE_OPENMP
@@ -26,6 +32,12 @@
 #include "paddle/cinn/common/cas.h"
 #include "paddle/cinn/runtime/intrinsic.h"
 #include "paddle/common/enforce.h"
+#include "paddle/common/flags.h"
+#include "paddle/phi/core/threadpool.h"
+
+PD_DECLARE_bool(cinn_cpu_work_stealing);
+PD_DECLARE_int32(cinn_cpu_tasks_per_thread);
+COMMON_DECLARE_bool(threadpool_bind_cpu);
 
 int max_concurrency() {
   int max_concurrency = 1;
@@ -44,9 +56,227 @@ int max_concurrency() {
   return std::max(max_concurrency, 1);
 }
 
+namespace {
+
+// Whether the calling thread is running the tasks of a parallel launch.
+thread_local bool in_parallel_launch = false;
+
+/**
+ * A persistent pool running the tasks of cinn_backend_parallel_launch.
+ *
+ * The caller of a launch and the workers share its task ids. Each of them
+ * starts with a contiguous range of ids and takes the tasks from its front.
+ * When its range is empty it steals the back half of the range of another
+ * one. A range is packed in one 64-bit word, so taking and stealing a task
+ * are a single CAS.
+ *
+ * Only one launch uses the workers at a time. A launch from inside a task
+ * (nested parallel loops) or while the workers are busy with a launch of
+ * another thread, e.g. another thread of a multithreaded executor, runs on
+ * the calling thread, so the kernels never run more threads than the pool.
+ */
+class ParallelPool {
+ public:
+  static ParallelPool& Instance() {
+    // Never destroyed, the workers live as long as the process.
+    static ParallelPool* pool = new ParallelPool(max_concurrency() - 1);
+    return *pool;
+  }
+
+  int num_threads() const { return num_workers_ + 1; }
+
+  // Runs the tasks on the pool and sets *ret to the launch result. Returns
+  // false without running anything if the calling thread should run them.
+  bool TryLaunch(FCINNParallelLambda flambda,
+                 void* datas,
+                 int num_task,
+                 int* ret) {
+    if (in_parallel_launch || num_workers_ == 0 ||
+        busy_.exchange(true, std::memory_order_acquire)) {
+      return false;
+    }
+    Job job(flambda, datas, num_task, num_threads());
+    {
+      std::lock_guard<std::mutex> lock(mu_);
+      job_ = &job;
+      joined_ = 0;
+      left_ = 0;
+      epoch_.fetch_add(1, std::memory_order_release);
+    }
+    job_cv_.notify_all();
+
+    in_parallel_launch = true;
+    RunJob(&job, 0);
+    in_parallel_launch = false;
+    {
+      // Workers that have not joined yet skip this job, the ones that have
+      // joined may still run the tasks they took.
+      std::unique_lock<std::mutex> lock(mu_);
+      job_ = nullptr;
+      done_cv_.wait(lock, [this] { return left_ == joined_; });
+    }
+    busy_.store(false, std::memory_order_release);
+    *ret = job.status.load();
+    return true;
+  }
+
+ private:
+  static constexpr int kSpinCount = 1 << 12;
+
+  struct alignas(64) Range {
+    std::atomic<uint64_t> value{0};
+  };
+
+  struct Job {
+    Job(FCINNParallelLambda flambda,
+        void* datas,
+        int num_task,
+        int num_participants)
+        : flambda(flambda),
+          datas(datas),
+          num_task(num_task),
+          num_participants(num_participants),
+          ranges(new Range[num_participants]) {
+      for (int i = 0; i < num_participants; ++i) {
+        const int64_t begin = int64_t{num_task} * i / num_participants;
+        const int64_t end = int64_t{num_task} * (i + 1) / num_participants;
+        ranges[i].value.store(Pack(begin, end), std::memory_order_relaxed);
+      }
+    }
+
+    FCINNParallelLambda flambda;
+    void* datas;
+    const int num_task;
+    const int num_participants;
+    std::unique_ptr<Range[]> ranges;
+    std::atomic<int> status{0};
+  };
+
+  static uint64_t Pack(uint64_t begin, uint64_t end) {
+    return (begin << 32) | end;
+  }
+  static uint32_t Begin(uint64_t range) { return range >> 32; }
+  static uint32_t End(uint64_t range) { return range & 0xffffffffu; }
+
+  explicit ParallelPool(int num_workers) : num_workers_(num_workers) {
+    for (int i = 0; i < num_workers_; ++i) {
+      std::thread([this, i] { WorkerLoop(i); }).detach();
+    }
+  }
+
+  void WorkerLoop(int worker_id) {
+    in_parallel_launch = true;
+    // The caller of a launch is the 0-th thread of the pool.
+    if (FLAGS_threadpool_bind_cpu &&
+        !phi::BindCurrentThreadToCpu(worker_id + 1)) {
+      VLOG(1) << "Failed to pin worker " << worker_id
+              << " of the CINN parallel pool to a cpu";
+    }
+    uint64_t seen_epoch = 0;
+    while (true) {
+      // Kernels often launch back to back, spin a little before sleeping.
+      for (int i = 0; i < kSpinCount; ++i) {
+        if (epoch_.load(std::memory_order_acquire) != seen_epoch) break;
+      }
+      Job* job = nullptr;
+      {
+        std::unique_lock<std::mutex> lock(mu_);
+        job_cv_.wait(lock, [&] {
+          return epoch_.load(std::memory_order_relaxed) != seen_epoch;
+        });
+        seen_epoch = epoch_.load(std::memory_order_relaxed);
+        job = job_;
+        if (job == nullptr) continue;
+        ++joined_;
+      }
+      RunJob(job, worker_id + 1);
+      {
+        std::lock_guard<std::mutex> lock(mu_);
+        ++left_;
+      }
+      done_cv_.notify_one();
+    }
+  }
+
+  void RunJob(Job* job, int self) {
+    uint32_t task = 0;
+    while (PopFront(&job->ranges[self], &task) || Steal(job, self, &task)) {
+      if ((*job->flambda)(task, job->num_task, job->datas) != 0) {
+        job->status.store(-1);
+      }
+    }
+  }
+
+  static bool PopFront(Range* range, uint32_t* task) {
+    uint64_t value = range->value.load(std::memory_order_acquire);
+    while (Begin(value) < End(value)) {
+      if (range->value.compare_exchange_weak(
+              value, Pack(Begin(value) + 1, End(value)))) {
+        *task = Begin(value);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Steals the back half of the range of another thread, returns its first
+  // task and keeps the rest as the range of self.
+  static bool Steal(Job* job, int self, uint32_t* task) {
+    for (int i = 1; i < job->num_participants; ++i) {
+      Range* victim = &job->ranges[(self + i) % job->num_participants];
+      uint64_t value = victim->value.load(std::memory_order_acquire);
+      while (Begin(value) < End(value)) {
+        const uint32_t mid = Begin(value) + (End(value) - Begin(value)) / 2;
+        if (victim->value.compare_exchange_weak(value,
+                                                Pack(Begin(value), mid))) {
+          // Nobody changes an empty range, so a plain store is enough.
+          job->ranges[self].value.store(Pack(mid + 1, End(value)),
+                                        std::memory_order_release);
+          *task = mid;
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  const int num_workers_;
+  std::atomic<bool> busy_{false};
+  std::atomic<uint64_t> epoch_{0};
+  std::mutex mu_;
+  std::condition_variable job_cv_;
+  std::condition_variable done_cv_;
+  // The running launch, nullptr once its caller is done with its tasks.
+  Job* job_ = nullptr;
+  int joined_ = 0;
+  int left_ = 0;
+};
+
+}  // namespace
+
 int cinn_backend_parallel_launch(FCINNParallelLambda flambda,
                                  void* datas,
                                  int num_task) {
+  if (FLAGS_cinn_cpu_work_stealing) {
+    auto& pool = ParallelPool::Instance();
+    const bool auto_split = num_task == 0;
+    if (auto_split) {
+      // Split the loop into chunks, so that idle threads can steal them.
+      num_task =
+          pool.num_threads() * std::max(FLAGS_cinn_cpu_tasks_per_thread, 1);
+    }
+    int ret = 0;
+    if (pool.TryLaunch(flambda, datas, num_task, &ret)) {
+      return ret;
+    }
+    // Run on the calling thread, as a single task when the kernel allows.
+    if (auto_split) num_task = 1;
+    for (int i = 0; i < num_task; ++i) {
+      if ((*flambda)(i, num_task, datas) != 0) ret = -1;
+    }
+    return ret;
+  }
+
   int num_workers = max_concurrency();
   if (num_task == 0) num_task = num_workers;
 #ifdef CINN_USE_OPENMP
@@ -36,8 +36,12 @@ typedef int (*FCINNParallelLambda)(int task_id, int num_task, void* datas);
  *
  * @param flambda The parallel function to be launched.
  * @param datas The closure datas.
- * @param num_task The Number of tasks to launch. If 0, it means to launch
- *           with all available threads.
+ * @param num_task The Number of tasks to launch. If 0, the runtime chooses
+ *           it, splitting the work into a few tasks per available thread.
+ *
+ * The tasks run on a work-stealing pool of max_concurrency() threads,
+ * including the calling one. A launch from inside a task, or while another
+ * thread's launch holds the pool, runs on the calling thread.
  *
  * @return 0 when no error is thrown, -1 when failure happens
  */
@@ -0,0 +1,98 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/cinn/runtime/cpu/thread_backend.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct CountData {
+  std::vector<std::atomic<int>>* counts;
+  std::atomic<int> num_task{0};
+};
+
+int CountTask(int task_id, int num_task, void* datas) {
+  auto* data = static_cast<CountData*>(datas);
+  data->num_task.store(num_task);
+  (*data->counts)[task_id].fetch_add(1);
+  return 0;
+}
+
+bool RunLaunchAndCheck(int num_task) {
+  std::vector<std::atomic<int>> counts(num_task);
+  CountData data;
+  data.counts = &counts;
+  if (cinn_backend_parallel_launch(CountTask, &data, num_task) != 0) {
+    return false;
+  }
+  for (auto& count : counts) {
+    if (count.load() != 1) return false;
+  }
+  return true;
+}
+
+int NestedTask(int task_id, int num_task, void* datas) {
+  return RunLaunchAndCheck(64) ? 0 : -1;
+}
+
+int FailTask(int task_id, int num_task, void* datas) {
+  return task_id == num_task / 2 ? -1 : 0;
+}
+
+}  // namespace
+
+TEST(ThreadBackend, RunEveryTaskOnce) {
+  for (int num_task : {1, 2, 7, max_concurrency(), 1000}) {
+    EXPECT_TRUE(RunLaunchAndCheck(num_task)) << num_task << " tasks";
+  }
+}
+
+TEST(ThreadBackend, ChooseNumTask) {
+  std::vector<std::atomic<int>> counts(max_concurrency() * 64);
+  CountData data;
+  data.counts = &counts;
+  ASSERT_EQ(cinn_backend_parallel_launch(CountTask, &data, 0), 0);
+  const int num_task = data.num_task.load();
+  EXPECT_GE(num_task, max_concurrency());
+  for (int i = 0; i < counts.size(); ++i) {
+    EXPECT_EQ(counts[i].load(), i < num_task ? 1 : 0);
+  }
+}
+
+TEST(ThreadBackend, NestedLaunch) {
+  EXPECT_EQ(cinn_backend_parallel_launch(NestedTask, nullptr, 16), 0);
+}
+
+TEST(ThreadBackend, ConcurrentLaunches) {
+  std::atomic<int> failures{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&failures] {
+      for (int i = 0; i < 200; ++i) {
+        if (!RunLaunchAndCheck(1 + i % 97)) failures.fetch_add(1);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  EXPECT_EQ(failures.load(), 0);
+}
+
+TEST(ThreadBackend, ReportFailedTask) {
+  EXPECT_EQ(cinn_backend_parallel_launch(FailTask, nullptr, 32), -1);
+}
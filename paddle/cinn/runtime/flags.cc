@@ -64,11 +64,48 @@ PD_DEFINE_string(
     StringFromEnv("FLAGS_tile_config_policy", "default"),
     "Which config does the compiler use, optimal, custom or default");
 
+PD_DEFINE_string(
+    cinn_compile_cache_dir,
+    StringFromEnv("FLAGS_cinn_compile_cache_dir", ""),
+    "Directory of the on-disk cache of compiled x86 fusion groups, which is "
+    "shared by threads and processes. Empty means disabled.");
+
+PD_DEFINE_int64(
+    cinn_compile_cache_max_mb,
+    Int64FromEnv("FLAGS_cinn_compile_cache_max_mb", 1024L),
+    "The size in MB above which the least recently used entries of "
+    "FLAGS_cinn_compile_cache_dir are evicted.");
+
 PD_DEFINE_int32(cinn_parallel_compile_thread,
                 Int32FromEnv("FLAGS_cinn_parallel_compile_thread",
                              (std::thread::hardware_concurrency() >> 1)),
                 "How much thread the parallel compile used.");
 
+PD_DEFINE_bool(cinn_cpu_work_stealing,
+               BoolFromEnv("FLAGS_cinn_cpu_work_stealing", true),
+               "Whether the parallel loops of x86 kernels run on the "
+               "work-stealing pool of CINN instead of OpenMP.");
+
+PD_DEFINE_int32(cinn_cpu_tasks_per_thread,
+                Int32FromEnv("FLAGS_cinn_cpu_tasks_per_thread", 4),
+                "The tasks per thread a parallel loop of x86 kernels is "
+                "split into when the kernel leaves it to the runtime.");
+
+PD_DEFINE_bool(cinn_cpu_tile_tactic,
+               BoolFromEnv("FLAGS_cinn_cpu_tile_tactic", false),
+               "Whether x86 groups are scheduled by the vectorized and "
+               "parallel CpuTileTactic instead of the general tile tactic.");
+
+PD_DEFINE_int32(cinn_max_shape_specializations,
+                Int32FromEnv("FLAGS_cinn_max_shape_specializations", 0),
+                "The static-shape variants a dynamic-shape kernel keeps for "
+                "its hot input shapes, 0 means no variant is compiled.");
+
+PD_DEFINE_int32(cinn_shape_specialization_threshold,
+                Int32FromEnv("FLAGS_cinn_shape_specialization_threshold", 100),
+                "The runs of a dynamic-shape kernel with the same input "
+                "shapes before a static-shape variant is compiled for them.");
+
 PD_DEFINE_bool(cinn_measure_kernel_time,
                BoolFromEnv("FLAGS_cinn_measure_kernel_time", false),
                "Whether to enable schedule config search mode.");
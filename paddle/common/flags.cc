@@ -389,6 +389,20 @@ PHI_DEFINE_EXPORTED_int32(dist_threadpool_size,
                           0,
                           "number of threads used for distributed executed.");
 
+/**
+ * Thread pool related FLAG
+ * Name: FLAGS_threadpool_bind_cpu
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_threadpool_bind_cpu=true pins every thread of phi's
+ * ThreadPool and of the CINN CPU runtime to one cpu.
+ * Note: The i-th thread of a pool runs on the i-th cpu the process may use.
+ */
+PHI_DEFINE_EXPORTED_bool(threadpool_bind_cpu,
+                         false,
+                         "Whether to pin the threads of the thread pools to "
+                         "cpus.");
+
 /**
  * Garbage collector related FLAG
  * Name: FLAGS_eager_delete_tensor_gb
@@ -462,8 +476,8 @@ PHI_DEFINE_EXPORTED_double(
  * Allocator related FLAG
  * Name: FLAGS_allocator_strategy
  * Since Version: 1.2
- * Value Range: string, {naive_best_fit, auto_growth, thread_local},
- * default=auto_growth
+ * Value Range: string, {naive_best_fit, auto_growth, thread_local,
+ * auto_growth_slab}, default=auto_growth
  * Example:
  * Note: For selecting allocator policy of PaddlePaddle.
  */
@@ -481,7 +495,10 @@ PHI_DEFINE_EXPORTED_string(
     "size of models may be larger). auto_growth strategy would allocate "
     "GPU memory on demand, which allows users to start several Paddle jobs "
     "on the same GPU card but may lead to more memory fragmentation "
-    "(i.e., maximum batch size of models may be smaller).");
+    "(i.e., maximum batch size of models may be smaller). "
+    "auto_growth_slab is auto_growth plus a per-thread size-class cache for "
+    "small CPU allocations, which reduces lock contention in multi-threaded "
+    "CPU inference.");
 
 /**
  * Memory related FLAG
@@ -672,6 +689,20 @@ PHI_DEFINE_EXPORTED_bool(
     "If set true, the queue.pop will only get data from queue but not "
     "remove the data from queue for speed testing");
 
+/**
+ * Data reader related FLAG
+ * Name: FLAGS_reader_queue_lock_free
+ * Since Version: 3.0.0
+ * Value Range: bool, default=false
+ * Example: FLAGS_reader_queue_lock_free=true passes the batches from the
+ * DataLoader to the executor through a lock-free ring buffer.
+ */
+PHI_DEFINE_EXPORTED_bool(
+    reader_queue_lock_free,
+    false,
+    "If set true, the LoDTensorBlockingQueue of the reader is a lock-free "
+    "ring buffer instead of a locked deque.");
+
 /**
  * MKLDNN related FLAG
  * Name: use_mkldnn
@@ -1195,6 +1226,38 @@ PD_DEFINE_bool(enable_slotrecord_reset_shrink,  // NOLINT
 PD_DEFINE_bool(enable_ins_parser_file,  // NOLINT
                false,
                "enable parser ins file, default false");
+PD_DEFINE_bool(enable_slotrecord_columnar_store,  // NOLINT
+               false,
+               "SlotRecordDataset keeps the loaded data by column and feeds "
+               "unshuffled batches with one copy per slot, default false");
+PD_DEFINE_int32(slotrecord_chunk_size,
+                65536,
+                "SlotRecordDataset instances per chunk of the columnar store");
+PD_DEFINE_string(dataset_cache_dir,
+                 "",
+                 "Directory of the binary cache of the instances parsed from "
+                 "local data files, empty to disable the cache");
+PD_DEFINE_int64(dataset_cache_max_mb,
+                102400,
+                "The total size in MB of the dataset cache files, the least "
+                "recently used ones are removed beyond it");
+PD_DEFINE_int64(streaming_shuffle_memory_mb,
+                8192,
+                "The memory in MB of the records a trainer receives in "
+                "PreGlobalShuffle, the later ones are spilled to disk");
+PD_DEFINE_string(streaming_shuffle_spill_dir,
+                 "/tmp",
+                 "Directory of the spill files of PreGlobalShuffle");
+PD_DEFINE_int32(downpour_prefetch_depth,
+                0,
+                "The batches DownpourWorker reads and pulls the sparse "
+                "values of ahead of the batch it trains, 0 to pull each "
+                "batch right before training it");
+PD_DEFINE_int32(downpour_prefetch_max_staleness,
+                -1,
+                "With downpour_prefetch_depth, the pull of a batch waits "
+                "until the sparse pushes of all but the last this many "
+                "batches are done, -1 for no bound");
 PHI_DEFINE_EXPORTED_bool(
     gpugraph_enable_hbm_table_collision_stat,
     false,
@@ -1302,6 +1365,21 @@ PHI_DEFINE_EXPORTED_bool(
  */
 PHI_DEFINE_EXPORTED_bool(use_autotune, false, "Whether enable autotune.");
 
+/**
+ * Autotune related FLAG
+ * Name: FLAGS_autotune_cache_file
+ * Since Version: 3.0.0
+ * Value Range: string, default=""
+ * Example: FLAGS_autotune_cache_file=/path/to/autotune_cache, the tuned
+ * algorithms are loaded from the file at startup and saved to it when the
+ * autotune range ends, so that later processes on the same hardware skip the
+ * tuning. Several processes may share the file.
+ */
+PHI_DEFINE_EXPORTED_string(autotune_cache_file,
+                           "",
+                           "The file to persist the autotune cache in, empty "
+                           "means the cache is kept in memory only.");
+
 /**
  * CINN training related FLAG
  * Name: FLAGS_disable_dyshape_in_train
@@ -1040,28 +1040,16 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   }
 
   for (size_t shard_idx = 0; shard_idx < request_call_num; ++shard_idx) {
-    auto kvs = ids[shard_idx];
-    auto value_ptr = value_ptrs[shard_idx];
-
-    size_t kv_size = kvs.size();
-    uint32_t value_size = accessor->GetAccessorInfo().update_size;
-
     // 发送RPC请求
     auto *push_request = closure->request(shard_idx);
     push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
     push_request->set_table_id(table_id);
     push_request->set_client_id(_client_id);
-    push_request->add_params((char *)&kv_size, sizeof(uint32_t));  // NOLINT
-    auto *push_data = push_request->mutable_data();
-    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
-    char *push_data_ptr = const_cast<char *>(push_data->data());
-    memcpy(push_data_ptr, kvs.data(), kv_size * sizeof(uint64_t));
-    push_data_ptr += kv_size * sizeof(uint64_t);
-
-    for (size_t i = 0; i < kv_size; ++i) {
-      memcpy(push_data_ptr, value_ptr[i], value_size);
-      push_data_ptr += value_size;
-    }
+    FillPushSparseRequest(table_id,
+                          accessor,
+                          &ids[shard_idx],
+                          &value_ptrs[shard_idx],
+                          push_request);
     PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
     closure->cntl(shard_idx)->set_request_compress_type(
         (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -1073,6 +1061,42 @@ std::future<int32_t> BrpcPsClient::PushSparseRawGradient(
   return fut;
 }
 
+void BrpcPsClient::FillPushSparseRequest(size_t table_id,
+                                         ValueAccessor *accessor,
+                                         std::vector<uint64_t> *keys,
+                                         std::vector<const float *> *values,
+                                         PsRequestMessage *request) {
+  uint32_t kv_size = keys->size();
+  request->add_params(reinterpret_cast<char *>(&kv_size), sizeof(uint32_t));
+  auto *push_data = request->mutable_data();
+  auto codec_type = ParseSparseValueCodec(FLAGS_pserver_sparse_push_codec);
+  if (codec_type == SparseValueCodecType::kFp32) {
+    // |---keys---|---values---|
+    size_t value_size = accessor->GetAccessorInfo().update_size;
+    push_data->resize(kv_size * (sizeof(uint64_t) + value_size));
+    char *push_data_ptr = const_cast<char *>(push_data->data());
+    memcpy(push_data_ptr, keys->data(), kv_size * sizeof(uint64_t));
+    push_data_ptr += kv_size * sizeof(uint64_t);
+    for (size_t i = 0; i < kv_size; ++i) {
+      memcpy(push_data_ptr, (*values)[i], value_size);
+      push_data_ptr += value_size;
+    }
+    return;
+  }
+  // 第二个param为编码类型, server按其解码
+  char codec_byte = static_cast<char>(codec_type);
+  request->add_params(&codec_byte, 1);
+  SparseValueCodec codec(codec_type,
+                         accessor->GetAccessorInfo().update_dim,
+                         accessor->UpdateHeaderDim());
+  push_data->clear();
+  EncodeSparsePush(codec,
+                   keys,
+                   values,
+                   GetSparseResidual(table_id, codec_type),
+                   push_data);
+}
+
 std::future<int32_t> BrpcPsClient::PushDenseRawGradient(
     int table_id,
     float *total_send_data,
@@ -1168,9 +1192,13 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
   auto *accessor = GetTableAccessor(table_id);
 
   size_t value_size = accessor->GetAccessorInfo().select_size;
+  SparseValueCodec codec(
+      ParseSparseValueCodec(FLAGS_pserver_sparse_pull_codec),
+      accessor->GetAccessorInfo().select_dim,
+      accessor->SelectHeaderDim());
 
   DownpourBrpcClosure *closure = new DownpourBrpcClosure(
-      request_call_num, [shard_sorted_kvs, value_size](void *done) {
+      request_call_num, [shard_sorted_kvs, value_size, codec](void *done) {
         int ret = 0;
         auto *closure = reinterpret_cast<DownpourBrpcClosure *>(done);
         for (size_t i = 0; i < shard_sorted_kvs->size(); ++i) {
@@ -1184,6 +1212,7 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
           butil::IOBufBytesIterator io_buffer_itr(res_io_buffer);
           uint64_t last_key = UINT64_MAX;
           float *last_value_data = NULL;
+          std::string row_buffer(codec.RowSize(), '\0');
 
           for (auto &kv_pair : request_kvs) {
             if (kv_pair.first == last_key) {
@@ -1193,13 +1222,24 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
             } else {
               last_key = kv_pair.first;
               last_value_data = kv_pair.second;
-              if (value_size !=
-                  io_buffer_itr.copy_and_forward(
-                      reinterpret_cast<void *>(last_value_data), value_size)) {
+              if (codec.type() == SparseValueCodecType::kFp32) {
+                if (value_size != io_buffer_itr.copy_and_forward(
+                                      reinterpret_cast<void *>(last_value_data),
+                                      value_size)) {
+                  LOG(WARNING) << "res data is lack or not in format";
+                  ret = -1;
+                  break;
+                }
+                continue;
+              }
+              if (row_buffer.size() !=
+                  io_buffer_itr.copy_and_forward(&row_buffer[0],
+                                                 row_buffer.size())) {
                 LOG(WARNING) << "res data is lack or not in format";
                 ret = -1;
                 break;
               }
+              codec.Decode(row_buffer.data(), 1, last_value_data);
             }
           }
         }
@@ -1253,6 +1293,11 @@ std::future<int32_t> BrpcPsClient::PullSparse(float **select_values,
       closure->request(i)->set_client_id(_client_id);
       closure->request(i)->add_params((char *)&kv_request_count,  // NOLINT
                                       sizeof(uint32_t));
+      if (codec.type() != SparseValueCodecType::kFp32) {
+        // 第二个param为编码类型, server按其编码返回的value
+        char codec_byte = static_cast<char>(codec.type());
+        closure->request(i)->add_params(&codec_byte, 1);
+      }
       PsService_Stub rpc_stub(GetCmdChannel(i));
       closure->cntl(i)->set_log_id(butil::gettimeofday_ms());
       rpc_stub.service(
@@ -1850,29 +1895,19 @@ int BrpcPsClient::PushSparseAsyncShardPush(
   auto &merged_value_list =
       task_list[0]->data()->shared_data[shard_idx].value_list;
 
+  std::vector<uint64_t> keys(merged_key_list.begin(),
+                             merged_key_list.begin() + merged_kv_count);
+  std::vector<const float *> values(merged_kv_count);
+  for (size_t i = 0; i < merged_kv_count; ++i) {
+    values[i] = reinterpret_cast<const float *>(merged_value_list[i].data());
+  }
+
   // 发送RPC请求
   auto *push_request = closure->request(shard_idx);
   push_request->set_cmd_id(PS_PUSH_SPARSE_TABLE);
   push_request->set_table_id(table_id);
   push_request->set_client_id(_client_id);
-  push_request->add_params(reinterpret_cast<char *>(&merged_kv_count),
-                           sizeof(uint32_t));  // NOLINT
-  auto *push_data = push_request->mutable_data();
-  int update_size = accessor->GetAccessorInfo().update_size;
-  push_data->resize(merged_kv_count * (sizeof(uint64_t) + update_size));
-  char *push_data_ptr = const_cast<char *>(push_data->data());
-  memcpy(push_data_ptr,
-         merged_key_list.data(),
-         merged_kv_count * sizeof(uint64_t));
-  push_data_ptr += merged_kv_count * sizeof(uint64_t);
-  for (size_t i = 0; i < merged_kv_count; ++i) {
-    const char *task_data_ptr = merged_value_list[i].data();
-
-    memcpy(push_data_ptr,
-           (float *)(task_data_ptr),  // NOLINT
-           update_size);
-    push_data_ptr += update_size;
-  }
+  FillPushSparseRequest(table_id, accessor, &keys, &values, push_request);
   PsService_Stub rpc_stub(GetSparseChannel(shard_idx));
   closure->cntl(shard_idx)->set_request_compress_type(
       (brpc::CompressType)FLAGS_pserver_communicate_compress_type);
@@ -378,6 +378,13 @@ class BrpcPsClient : public PSClient {
       DownpourBrpcClosure *closure,
       ValueAccessor *accessor);
 
+  // 填充push sparse请求的kv数量和数据, 按FLAGS_pserver_sparse_push_codec编码
+  void FillPushSparseRequest(size_t table_id,
+                             ValueAccessor *accessor,
+                             std::vector<uint64_t> *keys,
+                             std::vector<const float *> *values,
+                             PsRequestMessage *request);
+
   SparseTaskPool _sparse_task_pool;
 
   std::vector<std::shared_ptr<brpc::Channel>>
@@ -18,6 +18,7 @@
 
 #include "butil/object_pool.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
 #include "paddle/fluid/distributed/ps/table/depends/sparse_utils.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/framework/archive.h"
@@ -495,6 +496,22 @@ int32_t BrpcPsService::PullGeoParam(Table *table,
   return 0;
 }
 
+// sparse pull/push请求的第二个param为value的编码类型, 缺省为fp32
+static bool GetRequestCodec(const PsRequestMessage &request,
+                            SparseValueCodecType *type) {
+  *type = SparseValueCodecType::kFp32;
+  if (request.params_size() < 2) {
+    return true;
+  }
+  if (request.params(1).size() != 1 ||
+      static_cast<uint8_t>(request.params(1)[0]) >
+          static_cast<uint8_t>(SparseValueCodecType::kInt8)) {
+    return false;
+  }
+  *type = static_cast<SparseValueCodecType>(request.params(1)[0]);
+  return true;
+}
+
 int32_t BrpcPsService::PullSparse(Table *table,
                                   const PsRequestMessage &request,
                                   PsResponseMessage &response,
@@ -519,6 +536,12 @@ int32_t BrpcPsService::PullSparse(Table *table,
     return 0;
   }
 
+  SparseValueCodecType codec_type;
+  if (!GetRequestCodec(request, &codec_type)) {
+    set_response_code(response, -1, "PullSparse codec is not supported");
+    return 0;
+  }
+
   CostTimer timer("pserver_server_pull_sparse");
   const uint32_t num =
       *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
@@ -543,8 +566,22 @@ int32_t BrpcPsService::PullSparse(Table *table,
   table->Pull(table_context);
   // table->PullSparse(res_data->data(), value);
 
-  cntl->response_attachment().append(reinterpret_cast<char *>(res_data->data()),
-                                     res_data->size() * sizeof(float));
+  if (codec_type == SparseValueCodecType::kFp32) {
+    cntl->response_attachment().append(
+        reinterpret_cast<char *>(res_data->data()),
+        res_data->size() * sizeof(float));
+  } else {
+    SparseValueCodec codec(
+        codec_type, dim, table->GetValueAccessor()->SelectHeaderDim());
+    std::vector<const float *> rows(num);
+    for (uint32_t i = 0; i < num; ++i) {
+      rows[i] = res_data->data() + i * dim;
+    }
+    thread_local std::string encoded;
+    encoded.clear();
+    codec.Encode(rows.data(), nullptr, num, nullptr, &encoded);
+    cntl->response_attachment().append(encoded.data(), encoded.size());
+  }
   butil::return_object(res_data);
   return 0;
 }
@@ -568,6 +605,11 @@ int32_t BrpcPsService::PushSparse(Table *table,
                       "least 1 for num of sparse_key");
     return 0;
   }
+  SparseValueCodecType codec_type;
+  if (!GetRequestCodec(request, &codec_type)) {
+    set_response_code(response, -1, "PushSparse codec is not supported");
+    return 0;
+  }
   CostTimer timer("pserver_server_push_sparse");
   const uint32_t num =
       *(reinterpret_cast<const uint32_t *>(request.params(0).c_str()));
@@ -582,6 +624,26 @@ int32_t BrpcPsService::PushSparse(Table *table,
   table_context.push_context.values =
       (const float *)(push_data.data() + sizeof(uint64_t) * num);
   table_context.num = num;
+  // 编码的push见EncodeSparsePush, 解码后再push到table
+  thread_local std::vector<uint64_t> decoded_keys;
+  thread_local std::vector<float> decoded_values;
+  if (codec_type != SparseValueCodecType::kFp32) {
+    auto *accessor = table->GetValueAccessor();
+    SparseValueCodec codec(codec_type,
+                           accessor->GetAccessorInfo().update_dim,
+                           accessor->UpdateHeaderDim());
+    if (!DecodeSparsePush(codec,
+                          push_data.data(),
+                          push_data.size(),
+                          num,
+                          &decoded_keys,
+                          &decoded_values)) {
+      set_response_code(response, -1, "push sparse data is not in format");
+      return 0;
+    }
+    table_context.push_context.keys = decoded_keys.data();
+    table_context.push_context.values = decoded_values.data();
+  }
   // const uint64_t *keys = (const uint64_t *)push_data.data();
   // const float *values = (const float *)(push_data.data() + sizeof(uint64_t) *
   // num);
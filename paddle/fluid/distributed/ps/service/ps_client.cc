@@ -68,6 +68,24 @@ int32_t PSClient::Configure(  // called in FleetWrapper::InitWorker
   return Initialize();
 }
 
+SparseResidual *PSClient::GetSparseResidual(size_t table_id,
+                                            SparseValueCodecType codec) {
+  if (codec == SparseValueCodecType::kFp32 ||
+      !FLAGS_pserver_sparse_codec_error_feedback) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(_sparse_residual_mutex);
+  auto &residual = _sparse_residuals[table_id];
+  if (residual == nullptr) {
+    residual = std::make_unique<SparseResidual>();
+    if (FLAGS_pserver_sparse_codec_residual_max_keys > 0) {
+      residual->max_keys =
+          static_cast<size_t>(FLAGS_pserver_sparse_codec_residual_max_keys);
+    }
+  }
+  return residual.get();
+}
+
 PSClient *PSClientFactory::Create(const PSParameter &ps_config) {
   const auto &config = ps_config.server_param();
   if (!config.has_downpour_server_param()) {
@@ -17,6 +17,7 @@
 #include <future>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -25,6 +26,7 @@
 #include "paddle/fluid/distributed/ps/service/env.h"
 #include "paddle/fluid/distributed/ps/service/sendrecv.pb.h"
 #include "paddle/fluid/distributed/ps/service/sparse_shard_value.h"
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -369,12 +371,20 @@ class PSClient {
 
  protected:
   virtual int32_t Initialize() = 0;
+  // The error feedback of the sparse pushes of a table with a lossy `codec`,
+  // nullptr if there is none.
+  SparseResidual *GetSparseResidual(size_t table_id,
+                                    SparseValueCodecType codec);
+
   PSParameter _config;
   std::map<uint64_t, std::vector<paddle::distributed::Region>>
       _dense_pull_regions;
   std::unordered_map<uint32_t, std::shared_ptr<ValueAccessor>> _table_accessors;
   std::unordered_map<int32_t, MsgHandlerFunc>
       _msg_handler_map;  // 处理client2client消息
+  std::mutex _sparse_residual_mutex;
+  std::unordered_map<uint32_t, std::unique_ptr<SparseResidual>>
+      _sparse_residuals;
 
  public:
   size_t _client_id;
@@ -284,17 +284,7 @@ int32_t PsLocalClient::Initialize() {
     size_t num,
     void* callback) {
   PSClientClosure* closure = reinterpret_cast<PSClientClosure*>(callback);
-  auto* table_ptr = GetTable(table_id);
-
-  TableContext table_context;
-  table_context.value_type = Sparse;
-  table_context.push_context.keys = keys;
-  table_context.push_context.ptr_values = update_values;
-  table_context.num = num;
-  table_context.use_ptr = true;
-
-  // table_ptr->PushSparse(keys, update_values, num);
-  table_ptr->Push(table_context);
+  PushSparseToTable(table_id, keys, update_values, num);
   delete closure;
   return done();
 }
@@ -303,6 +293,14 @@ int32_t PsLocalClient::Initialize() {
                                                  const uint64_t* keys,
                                                  const float** update_values,
                                                  size_t num) {
+  PushSparseToTable(table_id, keys, update_values, num);
+  return done();
+}
+
+int32_t PsLocalClient::PushSparseToTable(size_t table_id,
+                                         const uint64_t* keys,
+                                         const float** update_values,
+                                         size_t num) {
   auto* table_ptr = GetTable(table_id);
 
   TableContext table_context;
@@ -312,9 +310,32 @@ int32_t PsLocalClient::Initialize() {
   table_context.num = num;
   table_context.use_ptr = true;
 
+  // 与BrpcPsClient一样按FLAGS_pserver_sparse_push_codec编码, 解码后再push
+  auto codec_type = ParseSparseValueCodec(FLAGS_pserver_sparse_push_codec);
+  std::vector<uint64_t> decoded_keys;
+  std::vector<float> decoded_values;
+  if (codec_type != SparseValueCodecType::kFp32) {
+    auto* accessor = table_ptr->GetValueAccessor();
+    SparseValueCodec codec(codec_type,
+                           accessor->GetAccessorInfo().update_dim,
+                           accessor->UpdateHeaderDim());
+    std::vector<uint64_t> sorted_keys(keys, keys + num);
+    std::vector<const float*> rows(update_values, update_values + num);
+    std::string data;
+    EncodeSparsePush(codec,
+                     &sorted_keys,
+                     &rows,
+                     GetSparseResidual(table_id, codec_type),
+                     &data);
+    DecodeSparsePush(
+        codec, data.data(), data.size(), num, &decoded_keys, &decoded_values);
+    table_context.push_context.keys = decoded_keys.data();
+    table_context.push_context.values = decoded_values.data();
+    table_context.use_ptr = false;
+  }
+
   //  table_ptr->PushSparse(keys, update_values, num);
-  table_ptr->Push(table_context);
-  return done();
+  return table_ptr->Push(table_context);
 }
 
 ::std::future<int32_t> PsLocalClient::SetDayId(size_t table_id, int day_id) {
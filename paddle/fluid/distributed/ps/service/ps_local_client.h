@@ -234,6 +234,11 @@ class PsLocalClient : public PSClient {
     return NULL;
   }
 
+  int32_t PushSparseToTable(size_t table_id,
+                            const uint64_t* keys,
+                            const float** update_values,
+                            size_t num);
+
   std::unordered_map<uint32_t, std::shared_ptr<Table>> _table_map;
 
   bool _running = false;
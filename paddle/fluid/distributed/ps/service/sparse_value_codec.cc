@@ -0,0 +1,285 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "paddle/fluid/distributed/common/local_random.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle {
+namespace distributed {
+
+PD_DEFINE_string(pserver_sparse_push_codec,
+                 "fp32",
+                 "codec of the sparse push values: fp32, fp16, bf16 or int8");
+PD_DEFINE_string(pserver_sparse_pull_codec,
+                 "fp32",
+                 "codec of the sparse pull values: fp32, fp16, bf16 or int8");
+PD_DEFINE_bool(pserver_sparse_codec_error_feedback,
+               true,
+               "add the quantization error of a sparse push to the next "
+               "push of the key");
+PD_DEFINE_int64(pserver_sparse_codec_residual_max_keys,
+                1 << 20,
+                "keys of a table a worker keeps the sparse push error "
+                "feedback of, 0 for no limit");
+
+SparseValueCodecType ParseSparseValueCodec(const std::string& name) {
+  if (name == "fp32") {
+    return SparseValueCodecType::kFp32;
+  } else if (name == "fp16") {
+    return SparseValueCodecType::kFp16;
+  } else if (name == "bf16") {
+    return SparseValueCodecType::kBf16;
+  } else if (name == "int8") {
+    return SparseValueCodecType::kInt8;
+  }
+  PADDLE_THROW(phi::errors::InvalidArgument(
+      "Unknown sparse value codec %s, expected fp32, fp16, bf16 or int8.",
+      name));
+}
+
+SparseValueCodec::SparseValueCodec(SparseValueCodecType type,
+                                   size_t dim,
+                                   size_t header_dim)
+    : _type(type), _dim(dim), _header_dim(std::min(header_dim, dim)) {
+  size_t body_dim = _dim - _header_dim;
+  _row_size = _header_dim * sizeof(float);
+  switch (_type) {
+    case SparseValueCodecType::kFp32:
+      _row_size += body_dim * sizeof(float);
+      break;
+    case SparseValueCodecType::kFp16:
+    case SparseValueCodecType::kBf16:
+      _row_size += body_dim * sizeof(uint16_t);
+      break;
+    case SparseValueCodecType::kInt8:
+      _row_size += sizeof(float) + body_dim * sizeof(int8_t);
+      break;
+    default:
+      PADDLE_THROW(phi::errors::InvalidArgument(
+          "Unknown sparse value codec %d.", static_cast<int>(_type)));
+  }
+}
+
+void SparseValueCodec::EncodeRow(const float* row,
+                                 char* out,
+                                 float* decoded) const {
+  memcpy(out, row, _header_dim * sizeof(float));
+  out += _header_dim * sizeof(float);
+  const float* body = row + _header_dim;
+  size_t body_dim = _dim - _header_dim;
+  switch (_type) {
+    case SparseValueCodecType::kFp32:
+      memcpy(out, body, body_dim * sizeof(float));
+      if (decoded != nullptr) {
+        memcpy(decoded, body, body_dim * sizeof(float));
+      }
+      break;
+    case SparseValueCodecType::kFp16:
+      for (size_t i = 0; i < body_dim; ++i) {
+        phi::dtype::float16 value(body[i]);
+        memcpy(out + i * sizeof(uint16_t), &value.x, sizeof(uint16_t));
+        if (decoded != nullptr) {
+          decoded[i] = static_cast<float>(value);
+        }
+      }
+      break;
+    case SparseValueCodecType::kBf16:
+      for (size_t i = 0; i < body_dim; ++i) {
+        phi::dtype::bfloat16 value(body[i]);
+        memcpy(out + i * sizeof(uint16_t), &value.x, sizeof(uint16_t));
+        if (decoded != nullptr) {
+          decoded[i] = static_cast<float>(value);
+        }
+      }
+      break;
+    case SparseValueCodecType::kInt8: {
+      float max_abs = 0;
+      for (size_t i = 0; i < body_dim; ++i) {
+        max_abs = std::max(max_abs, std::fabs(body[i]));
+      }
+      float scale = std::isfinite(max_abs) ? max_abs / 127 : 0;
+      memcpy(out, &scale, sizeof(float));
+      int8_t* q = reinterpret_cast<int8_t*>(out + sizeof(float));
+      for (size_t i = 0; i < body_dim; ++i) {
+        // Rounds up with the probability of the fraction, so that the
+        // rounding is unbiased.
+        float v = scale == 0 ? 0 : body[i] / scale;
+        float rounded = std::floor(v + uniform_real<float>());
+        q[i] = static_cast<int8_t>(
+            std::max(-127.0f, std::min(127.0f, rounded)));
+        if (decoded != nullptr) {
+          decoded[i] = q[i] * scale;
+        }
+      }
+      break;
+    }
+  }
+}
+
+void SparseValueCodec::Encode(const float* const* rows,
+                              const uint64_t* keys,
+                              size_t num,
+                              SparseResidual* residual,
+                              std::string* out) const {
+  size_t offset = out->size();
+  out->resize(offset + num * _row_size);
+  char* data = &(*out)[offset];
+  if (residual == nullptr || _type == SparseValueCodecType::kFp32) {
+    for (size_t i = 0; i < num; ++i) {
+      EncodeRow(rows[i], data + i * _row_size, nullptr);
+    }
+    return;
+  }
+  size_t body_dim = _dim - _header_dim;
+  std::vector<float> row(_dim);
+  std::vector<float> decoded(body_dim);
+  std::lock_guard<std::mutex> lock(residual->mutex);
+  auto& residuals = residual->residuals;
+  for (size_t i = 0; i < num; ++i) {
+    auto it = residuals.find(keys[i]);
+    if (it == residuals.end()) {
+      if (residual->max_keys > 0 && residuals.size() >= residual->max_keys) {
+        residuals.clear();
+      }
+      it = residuals.emplace(keys[i], std::vector<float>(body_dim, 0)).first;
+    }
+    auto& error = it->second;
+    memcpy(row.data(), rows[i], _dim * sizeof(float));
+    for (size_t j = 0; j < body_dim; ++j) {
+      row[_header_dim + j] += error[j];
+    }
+    EncodeRow(row.data(), data + i * _row_size, decoded.data());
+    for (size_t j = 0; j < body_dim; ++j) {
+      error[j] = row[_header_dim + j] - decoded[j];
+    }
+  }
+}
+
+void SparseValueCodec::Decode(const char* data,
+                              size_t num,
+                              float* values) const {
+  size_t body_dim = _dim - _header_dim;
+  for (size_t n = 0; n < num; ++n, data += _row_size, values += _dim) {
+    memcpy(values, data, _header_dim * sizeof(float));
+    const char* in = data + _header_dim * sizeof(float);
+    float* body = values + _header_dim;
+    switch (_type) {
+      case SparseValueCodecType::kFp32:
+        memcpy(body, in, body_dim * sizeof(float));
+        break;
+      case SparseValueCodecType::kFp16:
+        for (size_t i = 0; i < body_dim; ++i) {
+          phi::dtype::float16 value;
+          memcpy(&value.x, in + i * sizeof(uint16_t), sizeof(uint16_t));
+          body[i] = static_cast<float>(value);
+        }
+        break;
+      case SparseValueCodecType::kBf16:
+        for (size_t i = 0; i < body_dim; ++i) {
+          phi::dtype::bfloat16 value;
+          memcpy(&value.x, in + i * sizeof(uint16_t), sizeof(uint16_t));
+          body[i] = static_cast<float>(value);
+        }
+        break;
+      case SparseValueCodecType::kInt8: {
+        float scale = 0;
+        memcpy(&scale, in, sizeof(float));
+        const int8_t* q = reinterpret_cast<const int8_t*>(in + sizeof(float));
+        for (size_t i = 0; i < body_dim; ++i) {
+          body[i] = q[i] * scale;
+        }
+        break;
+      }
+    }
+  }
+}
+
+void EncodeSparsePush(const SparseValueCodec& codec,
+                      std::vector<uint64_t>* keys,
+                      std::vector<const float*>* rows,
+                      SparseResidual* residual,
+                      std::string* out) {
+  size_t num = keys->size();
+  std::vector<size_t> order(num);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [keys](size_t a, size_t b) {
+    return (*keys)[a] < (*keys)[b];
+  });
+  std::vector<uint64_t> sorted_keys(num);
+  std::vector<const float*> sorted_rows(num);
+  for (size_t i = 0; i < num; ++i) {
+    sorted_keys[i] = (*keys)[order[i]];
+    sorted_rows[i] = (*rows)[order[i]];
+  }
+  keys->swap(sorted_keys);
+  rows->swap(sorted_rows);
+
+  out->reserve(out->size() + num * (sizeof(uint64_t) + codec.RowSize()));
+  uint64_t last = 0;
+  for (uint64_t key : *keys) {
+    uint64_t delta = key - last;
+    last = key;
+    while (delta >= 0x80) {
+      out->push_back(static_cast<char>((delta & 0x7f) | 0x80));
+      delta >>= 7;
+    }
+    out->push_back(static_cast<char>(delta));
+  }
+  codec.Encode(rows->data(), keys->data(), num, residual, out);
+}
+
+bool DecodeSparsePush(const SparseValueCodec& codec,
+                      const char* data,
+                      size_t size,
+                      size_t num,
+                      std::vector<uint64_t>* keys,
+                      std::vector<float>* values) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+  const uint8_t* end = p + size;
+  keys->resize(num);
+  uint64_t last = 0;
+  for (size_t i = 0; i < num; ++i) {
+    uint64_t delta = 0;
+    for (int shift = 0;; shift += 7) {
+      if (p == end || shift > 63) {
+        return false;
+      }
+      uint8_t byte = *p++;
+      delta |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        break;
+      }
+    }
+    last += delta;
+    (*keys)[i] = last;
+  }
+  if (static_cast<size_t>(end - p) != num * codec.RowSize()) {
+    return false;
+  }
+  values->resize(num * codec.dim());
+  codec.Decode(reinterpret_cast<const char*>(p), num, values->data());
+  return true;
+}
+
+}  // namespace distributed
+}  // namespace paddle
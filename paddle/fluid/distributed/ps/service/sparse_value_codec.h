@@ -0,0 +1,104 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/common/flags.h"
+
+namespace paddle {
+namespace distributed {
+
+PD_DECLARE_string(pserver_sparse_push_codec);
+PD_DECLARE_string(pserver_sparse_pull_codec);
+PD_DECLARE_bool(pserver_sparse_codec_error_feedback);
+PD_DECLARE_int64(pserver_sparse_codec_residual_max_keys);
+
+// How the rows of the sparse pushes and pulls are sent between the workers
+// and the pservers. The first `header_dim` columns of a row, like slot, show
+// and click, are always sent as fp32, the others as:
+enum class SparseValueCodecType : uint8_t {
+  kFp32 = 0,
+  kFp16 = 1,
+  kBf16 = 2,
+  // A fp32 scale per row and a stochastically rounded int8 per column.
+  kInt8 = 3,
+};
+
+// Parses "fp32", "fp16", "bf16" or "int8".
+SparseValueCodecType ParseSparseValueCodec(const std::string& name);
+
+// The quantization errors of the rows a worker has pushed, added to the next
+// rows pushed for the same keys, so that the errors do not accumulate in the
+// model (error feedback). Once `max_keys` keys have a residual, all the
+// residuals are dropped before a new key is added, which only loses their
+// feedback. 0 keeps every key.
+struct SparseResidual {
+  std::mutex mutex;
+  size_t max_keys = 0;
+  std::unordered_map<uint64_t, std::vector<float>> residuals;
+};
+
+class SparseValueCodec {
+ public:
+  SparseValueCodec(SparseValueCodecType type, size_t dim, size_t header_dim);
+
+  SparseValueCodecType type() const { return _type; }
+  size_t dim() const { return _dim; }
+  // The encoded bytes of a row.
+  size_t RowSize() const { return _row_size; }
+
+  // Appends `num` encoded rows to `out`. With a `residual`, the residual of a
+  // key is added to its row before the row is encoded, and replaced with the
+  // error of the encoding.
+  void Encode(const float* const* rows,
+              const uint64_t* keys,
+              size_t num,
+              SparseResidual* residual,
+              std::string* out) const;
+  // Decodes `num` rows of `data` to `values`, `dim` floats per row.
+  void Decode(const char* data, size_t num, float* values) const;
+
+ private:
+  void EncodeRow(const float* row, char* out, float* decoded) const;
+
+  SparseValueCodecType _type;
+  size_t _dim;
+  size_t _header_dim;
+  size_t _row_size;
+};
+
+// A sparse push is encoded as the keys in ascending order, each as the
+// varint of its difference to the previous key, then the rows in the same
+// order. Sorts `keys` and `rows` together.
+void EncodeSparsePush(const SparseValueCodec& codec,
+                      std::vector<uint64_t>* keys,
+                      std::vector<const float*>* rows,
+                      SparseResidual* residual,
+                      std::string* out);
+// Decodes a push of `num` keys, returns false if `data` is not one.
+bool DecodeSparsePush(const SparseValueCodec& codec,
+                      const char* data,
+                      size_t size,
+                      size_t num,
+                      std::vector<uint64_t>* keys,
+                      std::vector<float>* values);
+
+}  // namespace distributed
+}  // namespace paddle
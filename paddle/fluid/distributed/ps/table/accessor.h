@@ -94,6 +94,11 @@ class ValueAccessor {
 
   virtual bool NeedExtendMF(float* value UNUSED) { return false; }
   virtual bool HasMF(size_t size UNUSED) { return false; }
+  // push value开头不是梯度的维度数(slot、show、click等)，
+  // 压缩传输时这些维度仍以fp32发送
+  virtual size_t UpdateHeaderDim() { return 0; }
+  // pull value开头不是参数的维度数(show、click等)
+  virtual size_t SelectHeaderDim() { return 0; }
   // converter for save
   virtual std::string GetConverter(int param) {
     auto itr = _data_converter_map.find(param);
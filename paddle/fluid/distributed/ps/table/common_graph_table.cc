@@ -57,9 +57,33 @@ PHI_DEFINE_EXPORTED_int32(graph_edges_debug_node_id, 0, "graph debug node id");
 PHI_DEFINE_EXPORTED_int32(graph_edges_debug_node_num,
                           2,
                           "graph debug node num");
+PHI_DEFINE_EXPORTED_bool(graph_build_csr_sampler,
+                         false,
+                         "build the lock-free CSR sampler of an edge type "
+                         "after its edges are loaded");
+PHI_DEFINE_EXPORTED_bool(
+    graph_compact_edge_storage,
+    false,
+    "load the edges into CompactEdgeShard instead of a GraphNode per node, "
+    "which serves the neighbor and node sampling, the CSR sampler and "
+    "get_all_id/get_all_neighbor_id of an edge type, the paths that need "
+    "a GraphNode of an edge type are rejected. Read when a table is "
+    "initialized");
 
 namespace paddle::distributed {
 
+namespace {
+// Rejects the edge paths that need a GraphNode per node, which the compact
+// edge storage does not keep.
+void EnforceNodeEdgeStorage(bool compact_edge_storage, const char *func) {
+  PADDLE_ENFORCE_EQ(
+      compact_edge_storage,
+      false,
+      phi::errors::Unimplemented(
+          "%s is not supported by the compact edge storage.", func));
+}
+}  // namespace
+
 #ifdef PADDLE_WITH_HETERPS
 int32_t GraphTable::Load_to_ssd(const std::string &path,
                                 const std::string &param) {
@@ -814,6 +838,7 @@ int32_t GraphTable::load_edges_to_ssd(const std::string &path,
 
 int32_t GraphTable::dump_edges_to_ssd(int idx) {
   VLOG(2) << "calling dump edges to ssd";
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   std::vector<std::future<int64_t>> tasks;
   auto &shards = edge_shards[idx];
   for (size_t i = 0; i < shards.size(); ++i) {
@@ -841,6 +866,7 @@ int32_t GraphTable::dump_edges_to_ssd(int idx) {
 }
 int32_t GraphTable::make_complementary_graph(int idx, int64_t byte_size) {
   VLOG(0) << "make_complementary_graph";
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   const size_t fixed_size = byte_size / 8;
   std::vector<std::unordered_map<uint64_t, int>> count(task_pool_size_);
   std::vector<std::future<int>> tasks;
@@ -932,6 +958,7 @@ void GraphTable::graph_partition(bool is_edge) {
 
 void GraphTable::dbh_graph_edge_partition() {
   VLOG(0) << "start to process dbh edge shard";
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   std::vector<std::vector<GraphShard *>> tmp_edge_shards;
   tmp_edge_shards.resize(edge_shards.size());
   for (size_t k = 0; k < edge_shards.size(); k++) {
@@ -1132,6 +1159,7 @@ void GraphTable::query_all_ids_rank(const size_t &total,
 }
 void GraphTable::fennel_graph_edge_partition() {
   VLOG(0) << "start to process fennel2 edge shard";
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   std::vector<std::future<size_t>> wait_tasks;
   robin_hood::unordered_flat_map<uint64_t, std::vector<Node *>>
       neighbor_nodes[shard_num_per_server];
@@ -1394,6 +1422,7 @@ void GraphTable::fennel_graph_edge_partition() {
 }
 void GraphTable::filter_graph_edge_nodes() {
   VLOG(0) << "begin filter graph edge nodes";
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   // 过滤不属于自己边表信息
   std::vector<std::future<std::pair<size_t, size_t>>> shard_tasks;
   std::vector<size_t> total_edge_count(shard_num_per_server, 0);
@@ -1548,44 +1577,40 @@ void GraphTable::fennel_graph_feature_partition() {
 void GraphTable::stat_graph_edge_info(int type) {
   std::vector<std::future<std::pair<size_t, size_t>>> shard_tasks;
   // 获取边是否跨机统计
-  std::function<size_t(Node *)> get_cross_edge_count = nullptr;
+  std::function<bool(uint64_t)> is_cross_edge = nullptr;
   if (type == 1) {
     // 贪心
-    get_cross_edge_count = [this](Node *node) {
-      size_t cnt = 0;
-      for (size_t i = 0; i < node->get_neighbor_size(); ++i) {
-        uint64_t nid = node->get_neighbor_id(i);
-        if (edge_node_rank_.find(nid) != node_id_) {
-          ++cnt;
-        }
-      }
-      return cnt;
+    is_cross_edge = [this](uint64_t nid) {
+      return edge_node_rank_.find(nid) != node_id_;
     };
   } else {
     // 硬拆
-    get_cross_edge_count = [this](Node *node) {
-      size_t cnt = 0;
-      for (size_t i = 0; i < node->get_neighbor_size(); ++i) {
-        uint64_t nid = node->get_neighbor_id(i);
-        if (is_key_for_self_rank(nid)) {
-          ++cnt;
-        }
-      }
-      return cnt;
-    };
+    is_cross_edge = [this](uint64_t nid) { return is_key_for_self_rank(nid); };
   }
   for (size_t idx = 0; idx < edge_shards.size(); ++idx) {
     for (size_t part_id = 0; part_id < shard_num_per_server; ++part_id) {
       shard_tasks.push_back(load_node_edge_task_pool->enqueue(
-          [this, part_id, idx, get_cross_edge_count]()
-              -> std::pair<size_t, size_t> {
+          [this, part_id, idx, is_cross_edge]() -> std::pair<size_t, size_t> {
             size_t total_cnt = 0;
             size_t cross_cnt = 0;
+            if (compact_edge_storage_) {
+              auto &shard = compact_edge_shards_[idx][part_id];
+              for (size_t k = 0; k < shard->node_size(); ++k) {
+                size_t degree = shard->degree(k);
+                total_cnt += degree;
+                for (size_t i = 0; i < degree; ++i) {
+                  cross_cnt += is_cross_edge(shard->get_neighbor_id(k, i));
+                }
+              }
+              return {total_cnt, cross_cnt};
+            }
             auto &nodes = edge_shards[idx][part_id]->get_bucket();
             for (auto &node : nodes) {
               // 统计各节点边分布情况
               total_cnt += node->get_neighbor_size();
-              cross_cnt += get_cross_edge_count(node);
+              for (size_t i = 0; i < node->get_neighbor_size(); ++i) {
+                cross_cnt += is_cross_edge(node->get_neighbor_id(i));
+              }
             }
             return {total_cnt, cross_cnt};
           }));
@@ -1606,6 +1631,10 @@ void GraphTable::stat_graph_edge_info(int type) {
 #endif  // PADDLE_WITH_HETERPS
 
 void GraphTable::clear_graph(int idx) {
+  clear_csr_snapshot(idx);
+  for (auto &shard : compact_edge_shards_[idx]) {
+    shard->clear();
+  }
   for (auto p : edge_shards[idx]) {
     p->clear();
     delete p;
@@ -1619,6 +1648,12 @@ void GraphTable::clear_graph(int idx) {
 
 void GraphTable::clear_edge_shard() {
   VLOG(0) << "begin clear edge shard";
+  for (size_t idx = 0; idx < csr_snapshots_.size(); ++idx) {
+    clear_csr_snapshot(idx);
+    for (auto &shard : compact_edge_shards_[idx]) {
+      shard->clear();
+    }
+  }
   std::vector<std::future<int>> tasks;
   for (auto &type_shards : edge_shards) {
     for (auto &shard : type_shards) {
@@ -1700,12 +1735,14 @@ std::vector<Node *> GraphShard::get_batch(int start, int end, int step) {
 size_t GraphShard::get_size() { return bucket.size(); }
 
 int32_t GraphTable::add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id) {
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   size_t src_shard_id = src_id % shard_num;
 
   if (src_shard_id >= shard_end || src_shard_id < shard_start) {
     return -1;
   }
   size_t index = src_shard_id - shard_start;
+  clear_csr_snapshot(idx);
   edge_shards[idx][index]->add_graph_node(src_id)->build_edges(false);
   edge_shards[idx][index]->add_neighbor(src_id, dst_id, 1.0);
   return 0;
@@ -1713,7 +1750,9 @@ int32_t GraphTable::add_comm_edge(int idx, uint64_t src_id, uint64_t dst_id) {
 int32_t GraphTable::add_graph_node(int idx,
                                    std::vector<uint64_t> &id_list,
                                    std::vector<bool> &is_weight_list) {
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   auto &shards = edge_shards[idx];
+  clear_csr_snapshot(idx);
   size_t node_size = id_list.size();
   std::vector<std::vector<std::pair<uint64_t, bool>>> batch(task_pool_size_);
   for (size_t i = 0; i < node_size; i++) {
@@ -1741,6 +1780,7 @@ int32_t GraphTable::add_graph_node(int idx,
 }
 
 int32_t GraphTable::remove_graph_node(int idx, std::vector<uint64_t> &id_list) {
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   size_t node_size = id_list.size();
   std::vector<std::vector<uint64_t>> batch(task_pool_size_);
   for (size_t i = 0; i < node_size; i++) {
@@ -1749,6 +1789,7 @@ int32_t GraphTable::remove_graph_node(int idx, std::vector<uint64_t> &id_list) {
     batch[get_thread_pool_index(id_list[i])].push_back(id_list[i]);
   }
   auto &shards = edge_shards[idx];
+  clear_csr_snapshot(idx);
   std::vector<std::future<int>> tasks;
   for (size_t i = 0; i < batch.size(); ++i) {
     if (batch[i].empty()) continue;
@@ -1973,7 +2014,11 @@ int32_t GraphTable::parse_edge_and_load(
     for (size_t part_id = 0; part_id < shard_num_per_server; ++part_id) {
       tasks.push_back(load_node_edge_task_pool->enqueue([this, idx, part_id]() {
         std::vector<std::vector<uint64_t>> all_keys;
-        edge_shards[idx][part_id]->get_all_id(&all_keys, 1);
+        if (compact_edge_storage_) {
+          compact_edge_shards_[idx][part_id]->get_all_id(&all_keys, 1);
+        } else {
+          edge_shards[idx][part_id]->get_all_id(&all_keys, 1);
+        }
         int cnt = all_keys[0].size();
         edge_shards_keys_[idx][part_id] = std::move(all_keys[0]);
         all_keys[0].clear();
@@ -2463,6 +2508,7 @@ int32_t GraphTable::load_nodes(const std::string &path,
 }
 
 int32_t GraphTable::build_sampler(int idx, std::string sample_type) {
+  EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
   for (auto &shard : edge_shards[idx]) {
     auto bucket = shard->get_bucket();
     for (auto item : bucket) {
@@ -2540,6 +2586,12 @@ std::pair<uint64_t, uint64_t> GraphTable::parse_edge_file(
       continue;
     }
     size_t index = src_shard_id - shard_start;
+    if (compact_edge_storage_) {
+      compact_edge_shards_[idx][index]->add_edge(
+          src_id, dst_id, use_weight ? weight : 1);
+      local_valid_count++;
+      continue;
+    }
     auto node = edge_shards[idx][index]->add_graph_node(src_id);
     if (node != NULL) {
       node->build_edges(is_weighted_);
@@ -2572,6 +2624,7 @@ int32_t GraphTable::load_edges(const std::string &path,
     }
     idx = edge_to_id[edge_type];
   }
+  clear_csr_snapshot(idx);
 
   auto paths = ::paddle::string::split_string<std::string>(path, ";");
   uint64_t count = 0;
@@ -2603,6 +2656,28 @@ int32_t GraphTable::load_edges(const std::string &path,
   std::string edge_size = edge_type + ":" + std::to_string(valid_count);
   edge_type_size.push_back(edge_size);
 
+  if (compact_edge_storage_) {
+    std::vector<std::future<int>> tasks;
+    for (auto &shard : compact_edge_shards_[idx]) {
+      tasks.push_back(
+          load_node_edge_task_pool->enqueue([&shard, use_weight]() -> int {
+            shard->finalize(use_weight);
+            return 0;
+          }));
+    }
+    for (auto &task : tasks) task.get();
+    size_t memory_size = 0;
+    for (auto &shard : compact_edge_shards_[idx]) {
+      memory_size += shard->memory_size();
+    }
+    VLOG(0) << "compact edges of edge_type[" << edge_type
+            << "] take memory: " << memory_size / 1024 / 1024 << "MB";
+    if (FLAGS_graph_build_csr_sampler) {
+      build_csr_snapshot(idx, use_weight);
+    }
+    return 0;
+  }
+
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   if (search_level == 2) {
     if (count > 0) {
@@ -2629,12 +2704,18 @@ int32_t GraphTable::load_edges(const std::string &path,
         item->build_sampler(sample_type);
       }
     }
+    if (FLAGS_graph_build_csr_sampler) {
+      build_csr_snapshot(idx, use_weight);
+    }
   }
 
   return 0;
 }
 
 Node *GraphTable::find_node(GraphTableType table_type, uint64_t id) {
+  if (table_type == GraphTableType::EDGE_TABLE) {
+    EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
+  }
   size_t shard_id = id % shard_num;
   if (shard_id >= shard_end || shard_id < shard_start) {
     return nullptr;
@@ -2658,6 +2739,9 @@ Node *GraphTable::find_node(GraphTableType table_type, uint64_t id) {
 }
 
 Node *GraphTable::find_node(GraphTableType table_type, int idx, uint64_t id) {
+  if (table_type == GraphTableType::EDGE_TABLE) {
+    EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
+  }
   size_t shard_id = id % shard_num;
   if (shard_id >= shard_end || shard_id < shard_start) {
     return nullptr;
@@ -2683,6 +2767,12 @@ uint32_t GraphTable::get_thread_pool_index_by_shard_index(
 }
 
 int32_t GraphTable::clear_nodes(GraphTableType table_type, int idx) {
+  if (table_type == GraphTableType::EDGE_TABLE) {
+    clear_csr_snapshot(idx);
+    for (auto &shard : compact_edge_shards_[idx]) {
+      shard->clear();
+    }
+  }
   auto &search_shards =
       table_type == GraphTableType::EDGE_TABLE      ? edge_shards[idx]
       : table_type == GraphTableType::FEATURE_TABLE ? feature_shards[idx]
@@ -2699,10 +2789,18 @@ int32_t GraphTable::random_sample_nodes(GraphTableType table_type,
                                         std::unique_ptr<char[]> &buffer,
                                         int &actual_size) {
   int total_size = 0;
-  auto &shards = table_type == GraphTableType::EDGE_TABLE ? edge_shards[idx]
-                                                          : feature_shards[idx];
-  for (auto shard : shards) {
-    total_size += shard->get_size();
+  if (table_type == GraphTableType::EDGE_TABLE &&
+      compact_edge_storage_) {
+    for (auto &shard : compact_edge_shards_[idx]) {
+      total_size += shard->node_size();
+    }
+  } else {
+    auto &shards = table_type == GraphTableType::EDGE_TABLE
+                       ? edge_shards[idx]
+                       : feature_shards[idx];
+    for (auto shard : shards) {
+      total_size += shard->get_size();
+    }
   }
   if (sample_size > total_size) sample_size = total_size;
   int range_num = random_sample_nodes_ranges;
@@ -2772,6 +2870,35 @@ int32_t GraphTable::random_sample_neighbors(
     bool need_weight) {
   size_t node_num = buffers.size();
   std::function<void(char *)> char_del = [](char *c) { delete[] c; };
+  auto snapshot = std::atomic_load(&csr_snapshots_[idx]);
+  if (snapshot != nullptr || compact_edge_storage_) {
+    GraphSampleHop hop;
+    hop.src_ids.assign(node_ids, node_ids + node_num);
+    if (snapshot != nullptr) {
+      sample_hop(*snapshot, sample_size, need_weight, &hop);
+    } else {
+      sample_hop(compact_edge_shards_[idx], sample_size, need_weight, &hop);
+    }
+    size_t item_size =
+        need_weight ? Node::id_size + Node::weight_size : Node::id_size;
+    for (size_t idy = 0; idy < node_num; ++idy) {
+      uint64_t begin = hop.offsets[idy];
+      uint64_t end = hop.offsets[idy + 1];
+      actual_sizes[idy] = (end - begin) * item_size;
+      if (begin == end) continue;
+      char *buffer_addr = new char[actual_sizes[idy]];
+      buffers[idy].reset(buffer_addr, char_del);
+      for (uint64_t j = begin; j < end; ++j) {
+        memcpy(buffer_addr, &hop.neighbors[j], Node::id_size);
+        buffer_addr += Node::id_size;
+        if (need_weight) {
+          memcpy(buffer_addr, &hop.weights[j], Node::weight_size);
+          buffer_addr += Node::weight_size;
+        }
+      }
+    }
+    return 0;
+  }
   std::vector<std::future<int>> tasks;
   std::vector<std::vector<uint32_t>> seq_id(task_pool_size_);
   std::vector<std::vector<SampleKey>> id_list(task_pool_size_);
@@ -2870,6 +2997,156 @@ int32_t GraphTable::random_sample_neighbors(
   return 0;
 }
 
+int32_t GraphTable::build_csr_snapshot(int idx, bool weighted) {
+  auto &shards = edge_shards[idx];
+  auto snapshot = std::make_shared<CsrGraphSnapshot>(shards.size());
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < shards.size(); ++i) {
+    tasks.push_back(load_node_edge_task_pool->enqueue([&, i]() -> int {
+      auto csr_shard = std::make_unique<CsrGraphShard>();
+      if (compact_edge_storage_) {
+        std::vector<uint64_t> node_ids, offsets, neighbors;
+        std::vector<float> weights;
+        compact_edge_shards_[idx][i]->to_csr(
+            &node_ids, &offsets, &neighbors, &weights);
+        if (!weighted) {
+          weights.clear();
+        }
+        csr_shard->build(std::move(node_ids),
+                         std::move(offsets),
+                         std::move(neighbors),
+                         std::move(weights));
+      } else {
+        csr_shard->build(shards[i]->get_bucket(), weighted);
+      }
+      (*snapshot)[i] = std::move(csr_shard);
+      return 0;
+    }));
+  }
+  for (auto &task : tasks) task.get();
+  size_t node_size = 0, edge_size = 0, memory_size = 0;
+  for (auto &csr_shard : *snapshot) {
+    node_size += csr_shard->node_size();
+    edge_size += csr_shard->edge_size();
+    memory_size += csr_shard->memory_size();
+  }
+  VLOG(0) << "build csr snapshot of edge_type[" << id_to_edge[idx]
+          << "] nodes: " << node_size << ", edges: " << edge_size
+          << ", memory: " << memory_size / 1024 / 1024 << "MB";
+  std::atomic_store(&csr_snapshots_[idx],
+                    std::shared_ptr<const CsrGraphSnapshot>(snapshot));
+  return 0;
+}
+
+void GraphTable::clear_csr_snapshot(int idx) {
+  std::atomic_store(&csr_snapshots_[idx],
+                    std::shared_ptr<const CsrGraphSnapshot>());
+}
+
+// Every task samples its nodes into its own buffers, and copies them to
+// the output once the offsets of all nodes are known, no lock is taken.
+template <typename Shards>
+void GraphTable::sample_hop(const Shards &shards,
+                            int sample_size,
+                            bool need_weight,
+                            GraphSampleHop *hop) {
+  size_t node_num = hop->src_ids.size();
+  std::vector<std::vector<uint32_t>> seq_id(task_pool_size_);
+  for (size_t idy = 0; idy < node_num; ++idy) {
+    seq_id[get_thread_pool_index(hop->src_ids[idy])].push_back(idy);
+  }
+  std::vector<std::vector<uint64_t>> task_neighbors(task_pool_size_);
+  std::vector<std::vector<float>> task_weights(task_pool_size_);
+  hop->offsets.assign(node_num + 1, 0);
+  std::vector<std::future<int>> tasks;
+  for (size_t i = 0; i < seq_id.size(); i++) {
+    if (seq_id[i].empty()) continue;
+    tasks.push_back(_shards_task_pool[i]->enqueue([&, i, this]() -> int {
+      auto &rng = _shards_task_rng_pool[i];
+      auto &neighbors = task_neighbors[i];
+      auto &weights = task_weights[i];
+      std::vector<uint32_t> res;
+      for (uint32_t idy : seq_id[i]) {
+        uint64_t node_id = hop->src_ids[idy];
+        size_t shard_id = node_id % shard_num;
+        res.clear();
+        if (shard_id >= shard_start && shard_id < shard_end) {
+          auto &shard = shards[shard_id - shard_start];
+          int64_t index = shard->find(node_id);
+          if (index >= 0) {
+            shard->sample_k(index, sample_size, rng.get(), &res);
+            for (uint32_t pos : res) {
+              neighbors.push_back(shard->get_neighbor_id(index, pos));
+              if (need_weight) {
+                weights.push_back(shard->get_neighbor_weight(index, pos));
+              }
+            }
+          }
+        }
+        hop->offsets[idy + 1] = res.size();
+      }
+      return 0;
+    }));
+  }
+  for (auto &t : tasks) {
+    t.get();
+  }
+  std::partial_sum(
+      hop->offsets.begin(), hop->offsets.end(), hop->offsets.begin());
+  hop->neighbors.resize(hop->offsets.back());
+  hop->weights.resize(need_weight ? hop->offsets.back() : 0);
+  tasks.clear();
+  for (size_t i = 0; i < seq_id.size(); i++) {
+    if (seq_id[i].empty()) continue;
+    tasks.push_back(_shards_task_pool[i]->enqueue([&, i]() -> int {
+      size_t from = 0;
+      for (uint32_t idy : seq_id[i]) {
+        size_t size = hop->offsets[idy + 1] - hop->offsets[idy];
+        std::copy_n(task_neighbors[i].begin() + from,
+                    size,
+                    hop->neighbors.begin() + hop->offsets[idy]);
+        if (need_weight) {
+          std::copy_n(task_weights[i].begin() + from,
+                      size,
+                      hop->weights.begin() + hop->offsets[idy]);
+        }
+        from += size;
+      }
+      return 0;
+    }));
+  }
+  for (auto &t : tasks) {
+    t.get();
+  }
+}
+
+int32_t GraphTable::sample_multi_hop(int idx,
+                                     const std::vector<uint64_t> &node_ids,
+                                     const std::vector<int> &fanouts,
+                                     bool need_weight,
+                                     std::vector<GraphSampleHop> *hops) {
+  auto snapshot = std::atomic_load(&csr_snapshots_[idx]);
+  PADDLE_ENFORCE_EQ(
+      snapshot != nullptr || compact_edge_storage_,
+      true,
+      phi::errors::PreconditionNotMet(
+          "The csr snapshot of edge_type[%s] is not built, call "
+          "build_csr_snapshot before sample_multi_hop.",
+          id_to_edge[idx]));
+  hops->clear();
+  hops->resize(fanouts.size());
+  for (size_t h = 0; h < fanouts.size(); ++h) {
+    auto &hop = (*hops)[h];
+    hop.src_ids = h == 0 ? node_ids : (*hops)[h - 1].neighbors;
+    if (snapshot != nullptr) {
+      sample_hop(*snapshot, fanouts[h], need_weight, &hop);
+    } else {
+      sample_hop(compact_edge_shards_[idx], fanouts[h], need_weight, &hop);
+    }
+  }
+  return 0;
+}
+
 int32_t GraphTable::get_nodes_ids_by_ranges(
     GraphTableType table_type,
     int idx,
@@ -2880,11 +3157,17 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
   res.clear();
   auto &shards = table_type == GraphTableType::EDGE_TABLE ? edge_shards[idx]
                                                           : feature_shards[idx];
+  bool compact = table_type == GraphTableType::EDGE_TABLE &&
+                 compact_edge_storage_;
+  auto shard_size = [&](size_t i) -> int {
+    return compact ? compact_edge_shards_[idx][i]->node_size()
+                   : shards[i]->get_size();
+  };
   std::vector<std::future<size_t>> tasks;
   for (size_t i = 0;
        i < shards.size() && index < static_cast<int>(ranges.size());
        i++) {
-    end = total_size + shards[i]->get_size();
+    end = total_size + shard_size(i);
     start = total_size;
     while (start < end && index < static_cast<int>(ranges.size())) {
       if (ranges[index].second <= start) {
@@ -2898,9 +3181,16 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
         first -= total_size;
         second -= total_size;
         tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
-            [&shards, first, second, i, &res, &mutex]() -> size_t {
+            [&, first, second, i, compact]() -> size_t {
               std::vector<uint64_t> keys;
-              shards[i]->get_ids_by_range(first, second, &keys);
+              if (compact) {
+                auto &shard = compact_edge_shards_[idx][i];
+                for (int k = first; k < second; ++k) {
+                  keys.push_back(shard->get_id(k));
+                }
+              } else {
+                shards[i]->get_ids_by_range(first, second, &keys);
+              }
 
               size_t num = keys.size();
               mutex.lock();
@@ -2916,7 +3206,7 @@ int32_t GraphTable::get_nodes_ids_by_ranges(
             }));
       }
     }
-    total_size += shards[i]->get_size();
+    total_size += shard_size(i);
   }
   for (auto &task : tasks) {
     task.get();
@@ -3149,6 +3439,13 @@ class MergeShardVector {
 int GraphTable::get_all_id(GraphTableType table_type,
                            int slice_num,
                            std::vector<std::vector<uint64_t>> *output) {
+  if (table_type == GraphTableType::EDGE_TABLE &&
+      compact_edge_storage_) {
+    for (size_t idx = 0; idx < compact_edge_shards_.size(); ++idx) {
+      get_all_id(table_type, idx, slice_num, output);
+    }
+    return 0;
+  }
   MergeShardVector shard_merge(output, slice_num);
   auto &search_shards = table_type == GraphTableType::EDGE_TABLE ? edge_shards
                         : table_type == GraphTableType::FEATURE_TABLE
@@ -3178,6 +3475,13 @@ int GraphTable::get_all_neighbor_id(
     GraphTableType table_type,
     int slice_num,
     std::vector<std::vector<uint64_t>> *output) {
+  if (table_type == GraphTableType::EDGE_TABLE &&
+      compact_edge_storage_) {
+    for (size_t idx = 0; idx < compact_edge_shards_.size(); ++idx) {
+      get_all_neighbor_id(table_type, idx, slice_num, output);
+    }
+    return 0;
+  }
   MergeShardVector shard_merge(output, slice_num);
   auto &search_shards = table_type == GraphTableType::EDGE_TABLE ? edge_shards
                         : table_type == GraphTableType::FEATURE_TABLE
@@ -3212,13 +3516,19 @@ int GraphTable::get_all_id(GraphTableType table_type,
       table_type == GraphTableType::EDGE_TABLE      ? edge_shards[idx]
       : table_type == GraphTableType::FEATURE_TABLE ? feature_shards[idx]
                                                     : node_shards[idx];
+  bool compact = table_type == GraphTableType::EDGE_TABLE &&
+                 compact_edge_storage_;
   std::vector<std::future<size_t>> tasks;
   VLOG(3) << "begin task, task_pool_size_[" << task_pool_size_ << "]";
   for (size_t i = 0; i < search_shards.size(); i++) {
     tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
-        [&search_shards, i, slice_num, &shard_merge]() -> size_t {
+        [&, i, slice_num, compact]() -> size_t {
           std::vector<std::vector<uint64_t>> shard_keys;
-          size_t num = search_shards[i]->get_all_id(&shard_keys, slice_num);
+          size_t num =
+              compact
+                  ? compact_edge_shards_[idx][i]->get_all_id(&shard_keys,
+                                                             slice_num)
+                  : search_shards[i]->get_all_id(&shard_keys, slice_num);
           // add to shard
           shard_merge.merge(shard_keys);
           return num;
@@ -3241,14 +3551,23 @@ int GraphTable::get_all_neighbor_id(
       table_type == GraphTableType::EDGE_TABLE      ? edge_shards[idx]
       : table_type == GraphTableType::FEATURE_TABLE ? feature_shards[idx]
                                                     : node_shards[idx];
+  bool compact = table_type == GraphTableType::EDGE_TABLE &&
+                 compact_edge_storage_;
   std::vector<std::future<size_t>> tasks;
   VLOG(3) << "begin task, task_pool_size_[" << task_pool_size_ << "]";
   for (size_t i = 0; i < search_shards.size(); i++) {
     tasks.push_back(_shards_task_pool[i % task_pool_size_]->enqueue(
-        [&search_shards, i, slice_num, &shard_merge]() -> size_t {
+        [&, i, slice_num, compact]() -> size_t {
           std::vector<std::vector<uint64_t>> shard_keys;
-          size_t num =
-              search_shards[i]->get_all_neighbor_id(&shard_keys, slice_num);
+          size_t num = 0;
+          if (compact) {
+            std::vector<uint64_t> keys;
+            compact_edge_shards_[idx][i]->get_all_neighbor_id(&keys);
+            num = GraphShard::dedup2shard_keys(&keys, &shard_keys, slice_num);
+          } else {
+            num = search_shards[i]->get_all_neighbor_id(&shard_keys,
+                                                        slice_num);
+          }
           // add to shard
           shard_merge.merge(shard_keys);
           return num;
@@ -3307,6 +3626,9 @@ int32_t GraphTable::pull_graph_list(GraphTableType table_type,
                                     int &actual_size,
                                     bool need_feature,
                                     int step) {
+  if (table_type == GraphTableType::EDGE_TABLE) {
+    EnforceNodeEdgeStorage(compact_edge_storage_, __func__);
+  }
   if (start < 0) start = 0;
   int size = 0, cur_size;
   auto &search_shards =
@@ -3542,16 +3864,22 @@ int32_t GraphTable::Initialize(const GraphParameter &graph) {
   VLOG(0) << "in init graph table shard idx = " << _shard_idx << " shard_start "
           << shard_start << " shard_end " << shard_end;
   edge_shards.resize(id_to_edge.size());
+  csr_snapshots_.resize(id_to_edge.size());
   node_weight.resize(2);
   node_weight[0].resize(id_to_edge.size());
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   partitions.resize(id_to_edge.size());
 #endif
   edge_shards_keys_.resize(id_to_edge.size());
+  // Read once, the edges already loaded stay where they are if the flag
+  // changes later.
+  compact_edge_storage_ = FLAGS_graph_compact_edge_storage;
+  compact_edge_shards_.resize(id_to_edge.size());
   for (size_t k = 0; k < edge_shards.size(); k++) {
     edge_shards_keys_[k].resize(shard_num_per_server);
     for (size_t i = 0; i < shard_num_per_server; i++) {
       edge_shards[k].push_back(new GraphShard());
+      compact_edge_shards_[k].push_back(std::make_unique<CompactEdgeShard>());
     }
   }
   node_weight[1].resize(id_to_feature.size());
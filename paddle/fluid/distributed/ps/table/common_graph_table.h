@@ -19,6 +19,7 @@
 #include <pthread.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdio>
 #include <ctime>
@@ -41,6 +42,8 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/graph/class_macro.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_compact_shard.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_sampler.h"
 #include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
 #include "paddle/fluid/distributed/ps/thirdparty/round_robin.h"
 #include "paddle/phi/core/utils/rw_lock.h"
@@ -99,9 +102,9 @@ class GraphShard {
     }
     return dedup2shard_keys(&keys, total_res, slice_num);
   }
-  size_t dedup2shard_keys(std::vector<uint64_t> *keys,
-                          std::vector<std::vector<uint64_t>> *total_res,
-                          int slice_num) {
+  static size_t dedup2shard_keys(std::vector<uint64_t> *keys,
+                                 std::vector<std::vector<uint64_t>> *total_res,
+                                 int slice_num) {
     size_t num = keys->size();
     uint64_t last_key = 0;
     // sort key insert to vector
@@ -551,6 +554,22 @@ class GraphTable : public Table {
       std::vector<int> &actual_sizes,               // NOLINT
       bool need_weight);
 
+  // Copies the edges of edge type `idx` into an immutable CSR snapshot,
+  // which random_sample_neighbors and sample_multi_hop then sample without
+  // locks and without the sample cache. The snapshot is dropped when the
+  // edges of the type change, build it again after that.
+  int32_t build_csr_snapshot(int idx, bool weighted);
+  void clear_csr_snapshot(int idx);
+  // Samples fanouts[h] neighbors of every node of hop h from the CSR
+  // snapshot, or from the compact edges without one, the nodes of hop 0 are
+  // `node_ids` and the nodes of hop h + 1 are the neighbors sampled at
+  // hop h.
+  int32_t sample_multi_hop(int idx,
+                           const std::vector<uint64_t> &node_ids,
+                           const std::vector<int> &fanouts,
+                           bool need_weight,
+                           std::vector<GraphSampleHop> *hops);
+
   int32_t random_sample_nodes(GraphTableType table_type,
                               int idx,
                               int sample_size,
@@ -849,6 +868,23 @@ class GraphTable : public Table {
   int node_num_ = 1;
   int node_id_ = 0;
   bool is_weighted_ = false;
+  // by edge type, read and replaced by std::atomic_load/std::atomic_store
+  std::vector<std::shared_ptr<const CsrGraphSnapshot>> csr_snapshots_;
+  // FLAGS_graph_compact_edge_storage when the table is initialized
+  bool compact_edge_storage_ = false;
+  // by edge type, the local shards of edge_shards when compact_edge_storage_
+  // is set
+  std::vector<std::vector<std::unique_ptr<CompactEdgeShard>>>
+      compact_edge_shards_;
+
+ private:
+  // Samples the neighbors of hop->src_ids from `shards`, the shards of a
+  // CsrGraphSnapshot or compact_edge_shards_, into `hop`.
+  template <typename Shards>
+  void sample_hop(const Shards &shards,
+                  int sample_size,
+                  bool need_weight,
+                  GraphSampleHop *hop);
 };
 }  // namespace distributed
 
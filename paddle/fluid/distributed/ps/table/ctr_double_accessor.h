@@ -165,6 +165,12 @@ class CtrDoubleAccessor : public ValueAccessor {
   // 判断该value是否进行shrink
   virtual bool Shrink(float* value);
   virtual bool NeedExtendMF(float* value);
+  size_t UpdateHeaderDim() override {
+    return CtrDoublePushValue::EmbedGIndex();
+  }
+  size_t SelectHeaderDim() override {
+    return CtrDoublePullValue::EmbedWIndex();
+  }
   // 判断该value是否在save阶段dump,
   // param作为参数用于标识save阶段，如downpour的xbox与batch_model
   // param = 0, save all feature
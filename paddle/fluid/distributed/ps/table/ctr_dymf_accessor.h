@@ -203,6 +203,12 @@ class CtrDymfAccessor : public ValueAccessor {
   // virtual bool save_ssd(float* value);
   virtual bool NeedExtendMF(float* value);
   virtual bool HasMF(int size);
+  size_t UpdateHeaderDim() override {
+    return CtrDymfPushValue::EmbedGIndex();
+  }
+  size_t SelectHeaderDim() override {
+    return CtrDymfPullValue::EmbedWIndex();
+  }
   // 判断该value是否在save阶段dump,
   // param作为参数用于标识save阶段，如downpour的xbox与batch_model
   // param = 0, save all feature
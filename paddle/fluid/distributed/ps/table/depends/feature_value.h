@@ -19,6 +19,7 @@
 #include <mct/hash-map.hpp>
 
 #include "paddle/common/flags.h"
+#include "paddle/common/macros.h"
 #include "paddle/fluid/distributed/common/chunk_allocator.h"
 
 namespace paddle {
@@ -46,6 +47,7 @@ struct alignas(64) SparseTableShard {
  public:
   typedef typename mct::closed_hash_map<KEY, mct::Pointer, std::hash<KEY>>
       map_type;
+  typedef VALUE value_type;
   struct iterator {
     typename map_type::iterator it;
     size_t bucket;
@@ -100,6 +102,8 @@ struct alignas(64) SparseTableShard {
       _buckets[bucket].max_load_factor(x);
     }
   }
+  // Values are resized on demand, kept for FlatSparseTableShard.
+  void set_value_dim(size_t dim UNUSED, size_t inline_dim UNUSED) {}
   size_t bucket_count() { return CTR_SPARSE_SHARD_BUCKET_NUM; }
   size_t bucket_size(size_t bucket) { return _buckets[bucket].size(); }
   void clear() {
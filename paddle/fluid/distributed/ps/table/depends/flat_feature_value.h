@@ -0,0 +1,654 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <mutex>         // NOLINT
+#include <shared_mutex>  // NOLINT
+#include <thread>        // NOLINT
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+// A reader-writer spin lock that fits in one word. Writers are preferred,
+// new readers back off as soon as a writer is waiting.
+class FlatBucketLock {
+ public:
+  void lock_shared() {
+    while (_state.fetch_add(1, std::memory_order_acquire) & kWriter) {
+      _state.fetch_sub(1, std::memory_order_relaxed);
+      while (_state.load(std::memory_order_relaxed) & kWriter) {
+        std::this_thread::yield();
+      }
+    }
+  }
+  void unlock_shared() { _state.fetch_sub(1, std::memory_order_release); }
+  void lock() {
+    while (_state.fetch_or(kWriter, std::memory_order_acquire) & kWriter) {
+      std::this_thread::yield();
+    }
+    while (_state.load(std::memory_order_acquire) != kWriter) {
+      std::this_thread::yield();
+    }
+  }
+  void unlock() { _state.fetch_and(~kWriter, std::memory_order_release); }
+
+ private:
+  static constexpr uint32_t kWriter = 1U << 31;
+  std::atomic<uint32_t> _state{0};
+};
+
+// Fixed width rows, allocated in chunks that grow geometrically so that
+// small pools stay small. Not thread safe.
+class FlatRowPool {
+ public:
+  FlatRowPool() {}
+  FlatRowPool(const FlatRowPool&) = delete;
+  ~FlatRowPool() {
+    for (char* chunk : _chunks) {
+      free(chunk);
+    }
+  }
+  void set_row_size(size_t size) {
+    PADDLE_ENFORCE_EQ(_chunks.empty(),
+                      true,
+                      phi::errors::PreconditionNotMet(
+                          "The row size of a FlatRowPool can only be set "
+                          "before any row is acquired."));
+    _row_size = std::max((size + 7) & ~7UL, sizeof(FreeRow));
+  }
+  void* acquire() {
+    if (_free_rows == NULL) {
+      create_new_chunk();
+    }
+    FreeRow* row = _free_rows;
+    _free_rows = row->next;
+    _counter++;
+    return row;
+  }
+  void release(void* ptr) {
+    FreeRow* row = reinterpret_cast<FreeRow*>(ptr);
+    row->next = _free_rows;
+    _free_rows = row;
+    _counter--;
+  }
+  size_t size() const { return _counter; }
+  size_t memory_size() const { return _allocated_rows * _row_size; }
+
+ private:
+  struct FreeRow {
+    FreeRow* next;
+  };
+  static constexpr size_t kMinChunkRows = 64;
+  static constexpr size_t kMaxChunkRows = 8192;
+
+  size_t _row_size = 0;
+  std::vector<char*> _chunks;
+  FreeRow* _free_rows = NULL;
+  size_t _allocated_rows = 0;
+  size_t _counter = 0;
+
+  void create_new_chunk() {
+    PADDLE_ENFORCE_GT(_row_size,
+                      0,
+                      phi::errors::PreconditionNotMet(
+                          "set_row_size must be called before the first "
+                          "row of a FlatRowPool is acquired."));
+    size_t rows = std::min(kMinChunkRows << _chunks.size(), kMaxChunkRows);
+    size_t alloc_size = rows * _row_size;
+    char* chunk = NULL;
+    int error =
+        posix_memalign(reinterpret_cast<void**>(&chunk), 64, alloc_size);
+    PADDLE_ENFORCE_EQ(error,
+                      0,
+                      phi::errors::ResourceExhausted(
+                          "Fail to alloc memory of %ld size, error code is %d.",
+                          alloc_size,
+                          error));
+    _chunks.push_back(chunk);
+    _allocated_rows += rows;
+    for (size_t i = rows; i > 0; --i) {
+      FreeRow* row = (FreeRow*)(void*)(chunk + (i - 1) * _row_size);  // NOLINT
+      row->next = _free_rows;
+      _free_rows = row;
+    }
+  }
+};
+
+class FlatValueSlab;
+
+// A feature value allocated by a FlatValueSlab. The header never moves once
+// acquired, so a pointer to the value stays valid until the key is erased.
+// The floats of a value up to the inline dim follow the header, a larger
+// value is moved to a row of the full dim, so data() changes on resize like
+// the data of a std::vector.
+class FlatFeatureValue {
+ public:
+  float* data() { return _data; }
+  size_t size() { return _size; }
+  size_t capacity() { return _capacity; }
+  void resize(size_t size);
+  void shrink_to_fit() {}
+
+ private:
+  friend class FlatValueSlab;
+  float* inline_data() { return reinterpret_cast<float*>(this + 1); }
+
+  FlatValueSlab* _slab;
+  float* _data;
+  uint32_t _size;
+  uint32_t _capacity;
+};
+
+// The values of a bucket. A value is allocated with the inline dim, which
+// holds a feature without its mf part, and moved to a row of the full dim
+// from a separate pool once it grows past it. Acquire and release are
+// called under the bucket lock, the mf rows have their own lock since
+// values of the bucket are resized concurrently.
+class FlatValueSlab {
+ public:
+  FlatValueSlab() {}
+  FlatValueSlab(const FlatValueSlab&) = delete;
+  // \p inline_dim is clamped to \p dim, values never grow past \p dim.
+  void set_value_dim(size_t dim, size_t inline_dim) {
+    _dim = dim;
+    _inline_dim = std::min(inline_dim, dim);
+    _rows.set_row_size(sizeof(FlatFeatureValue) +
+                       sizeof(float) * _inline_dim);
+    if (_inline_dim < _dim) {
+      _mf_rows.set_row_size(sizeof(float) * _dim);
+    }
+  }
+  size_t value_dim() const { return _dim; }
+  size_t inline_dim() const { return _inline_dim; }
+  FlatFeatureValue* acquire() {
+    FlatFeatureValue* value =
+        reinterpret_cast<FlatFeatureValue*>(_rows.acquire());
+    value->_slab = this;
+    value->_data = value->inline_data();
+    value->_size = 0;
+    value->_capacity = static_cast<uint32_t>(_inline_dim);
+    return value;
+  }
+  void release(FlatFeatureValue* value) {
+    if (value->_data != value->inline_data()) {
+      std::lock_guard<FlatBucketLock> lock(_mf_mutex);
+      _mf_rows.release(value->_data);
+    }
+    _rows.release(value);
+  }
+  size_t size() const { return _rows.size(); }
+  // The values with a row of the full dim.
+  size_t mf_size() {
+    std::lock_guard<FlatBucketLock> lock(_mf_mutex);
+    return _mf_rows.size();
+  }
+  size_t memory_size() {
+    std::lock_guard<FlatBucketLock> lock(_mf_mutex);
+    return _rows.memory_size() + _mf_rows.memory_size();
+  }
+
+ private:
+  friend class FlatFeatureValue;
+
+  // Moves the floats of \p value to a row of the full dim.
+  void extend(FlatFeatureValue* value) {
+    float* row = NULL;
+    {
+      std::lock_guard<FlatBucketLock> lock(_mf_mutex);
+      row = reinterpret_cast<float*>(_mf_rows.acquire());
+    }
+    memcpy(row, value->_data, sizeof(float) * value->_size);
+    value->_data = row;
+    value->_capacity = static_cast<uint32_t>(_dim);
+  }
+  // Moves the first \p size floats of \p value back inline.
+  void shrink(FlatFeatureValue* value, size_t size) {
+    float* row = value->_data;
+    memcpy(value->inline_data(),
+           row,
+           sizeof(float) * std::min<size_t>(size, value->_size));
+    value->_data = value->inline_data();
+    value->_capacity = static_cast<uint32_t>(_inline_dim);
+    std::lock_guard<FlatBucketLock> lock(_mf_mutex);
+    _mf_rows.release(row);
+  }
+
+  size_t _dim = 0;
+  size_t _inline_dim = 0;
+  FlatRowPool _rows;
+  FlatRowPool _mf_rows;
+  FlatBucketLock _mf_mutex;
+};
+
+inline void FlatFeatureValue::resize(size_t size) {
+  PADDLE_ENFORCE_LE(
+      size,
+      _slab->value_dim(),
+      phi::errors::OutOfRange("The size of a flat feature value (%d) "
+                              "exceeds its value dim (%d).",
+                              size,
+                              _slab->value_dim()));
+  if (size > _capacity) {
+    _slab->extend(this);
+  } else if (size <= _slab->inline_dim() && _data != inline_data()) {
+    _slab->shrink(this, size);
+  }
+  if (size > _size) {
+    memset(_data + _size, 0, sizeof(float) * (size - _size));
+  }
+  _size = static_cast<uint32_t>(size);
+}
+
+// Control byte of an index slot. A full slot keeps the low 7 bits of the
+// hash, empty and deleted slots are negative.
+static const int8_t FLAT_CTRL_EMPTY = -128;
+static const int8_t FLAT_CTRL_DELETED = -2;
+
+// A group of control bytes that is probed at once, with SSE2 when available
+// and with 64-bit SWAR otherwise. Match results are bit masks, one bit (or
+// one byte with SWAR) per slot.
+struct FlatCtrlGroup {
+#if defined(__SSE2__)
+  static constexpr size_t kWidth = 16;
+  static constexpr size_t kShift = 0;
+
+  explicit FlatCtrlGroup(const int8_t* pos)
+      : ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {}
+  uint64_t match(int8_t h2) const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+  }
+  uint64_t match_empty() const { return match(FLAT_CTRL_EMPTY); }
+  uint64_t match_empty_or_deleted() const {
+    return static_cast<uint32_t>(
+        _mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl)));
+  }
+
+  __m128i ctrl;
+#else
+  static constexpr size_t kWidth = 8;
+  static constexpr size_t kShift = 3;
+  static constexpr uint64_t kLsbs = 0x0101010101010101ULL;
+  static constexpr uint64_t kMsbs = 0x8080808080808080ULL;
+
+  explicit FlatCtrlGroup(const int8_t* pos) { memcpy(&ctrl, pos, kWidth); }
+  // May report a false positive right after a true match, the caller
+  // compares the keys anyway.
+  uint64_t match(int8_t h2) const {
+    uint64_t x = ctrl ^ (kLsbs * static_cast<uint8_t>(h2));
+    return (x - kLsbs) & ~x & kMsbs;
+  }
+  uint64_t match_empty() const { return ctrl & ~(ctrl << 6) & kMsbs; }
+  uint64_t match_empty_or_deleted() const {
+    return ctrl & ~(ctrl << 7) & kMsbs;
+  }
+
+  uint64_t ctrl;
+#endif
+
+  static size_t lowest(uint64_t mask) {
+    return static_cast<size_t>(__builtin_ctzll(mask)) >> kShift;
+  }
+};
+
+// An alternative to SparseTableShard<KEY, FixedFeatureValue> with the same
+// interface. Each of the CTR_SPARSE_SHARD_BUCKET_NUM buckets is an open
+// addressing (swiss table style) index of {key, value row} slots probed a
+// group of control bytes at a time, and the values are kept inline in the
+// fixed width rows of a per bucket slab, so a lookup touches the control
+// bytes, one slot and the value itself.
+//
+// Every bucket has its own reader-writer lock: find() may run concurrently
+// with emplace() and erase() of other keys, and the value pointer it returns
+// stays valid until that key is erased. Iterating over the shard and erasing
+// by iterator still require that no other thread modifies the shard.
+template <class KEY>
+struct alignas(64) FlatSparseTableShard {
+ public:
+  typedef FlatFeatureValue value_type;
+
+  struct Slot {
+    KEY key;
+    FlatFeatureValue* value;
+  };
+  struct alignas(64) Bucket {
+    std::vector<int8_t> ctrl;
+    std::vector<Slot> slots;
+    size_t capacity = 0;
+    size_t size = 0;
+    size_t growth_left = 0;
+    FlatValueSlab slab;
+    FlatBucketLock mutex;
+  };
+
+  struct iterator {
+    FlatSparseTableShard* shard;
+    size_t bucket;
+    size_t index;
+    KEY _key;
+    FlatFeatureValue* _value;
+    friend bool operator==(const iterator& a, const iterator& b) {
+      return a.bucket == b.bucket && a.index == b.index;
+    }
+    friend bool operator!=(const iterator& a, const iterator& b) {
+      return !(a == b);
+    }
+    const KEY& key() const { return _key; }
+    FlatFeatureValue& value() const { return *_value; }
+    FlatFeatureValue* value_ptr() const { return _value; }
+    iterator& operator++() {
+      ++index;
+      shard->seek(this);
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+  };
+  struct local_iterator {
+    Bucket* bucket;
+    size_t index;
+    friend bool operator==(const local_iterator& a, const local_iterator& b) {
+      return a.index == b.index;
+    }
+    friend bool operator!=(const local_iterator& a, const local_iterator& b) {
+      return a.index != b.index;
+    }
+    const KEY& key() const { return bucket->slots[index].key; }
+    FlatFeatureValue& value() const { return *bucket->slots[index].value; }
+    local_iterator& operator++() {
+      index = next_full(*bucket, index + 1);
+      return *this;
+    }
+    local_iterator operator++(int) {
+      local_iterator ret = *this;
+      ++*this;
+      return ret;
+    }
+  };
+
+  ~FlatSparseTableShard() { clear(); }
+  bool empty() { return size() == 0; }
+  size_t size() {
+    size_t total = 0;
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      total += _buckets[bucket].size;
+    }
+    return total;
+  }
+  void set_max_load_factor(float x) {
+    _max_load_factor = std::min(std::max(x, 0.1f), 0.9375f);
+  }
+  // Must be called before the first insertion. Values hold up to `dim`
+  // floats, the first `inline_dim` of them next to the value header.
+  void set_value_dim(size_t dim, size_t inline_dim) {
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      _buckets[bucket].slab.set_value_dim(dim, inline_dim);
+    }
+  }
+  size_t bucket_count() { return CTR_SPARSE_SHARD_BUCKET_NUM; }
+  size_t bucket_size(size_t bucket) { return _buckets[bucket].size; }
+  // Bytes used by the index and the value rows.
+  size_t memory_size() {
+    size_t total = 0;
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      Bucket& b = _buckets[bucket];
+      total += b.ctrl.size() + b.slots.size() * sizeof(Slot) +
+               b.slab.memory_size();
+    }
+    return total;
+  }
+  void clear() {
+    for (size_t bucket = 0; bucket < CTR_SPARSE_SHARD_BUCKET_NUM; bucket++) {
+      Bucket& b = _buckets[bucket];
+      std::unique_lock<FlatBucketLock> lock(b.mutex);
+      for (size_t i = next_full(b, 0); i < b.capacity;
+           i = next_full(b, i + 1)) {
+        b.slab.release(b.slots[i].value);
+      }
+      std::vector<int8_t>().swap(b.ctrl);
+      std::vector<Slot>().swap(b.slots);
+      b.capacity = 0;
+      b.size = 0;
+      b.growth_left = 0;
+    }
+  }
+  iterator begin() {
+    iterator it = {this, 0, 0, KEY(), NULL};
+    seek(&it);
+    return it;
+  }
+  iterator end() { return {this, CTR_SPARSE_SHARD_BUCKET_NUM, 0, KEY(), NULL}; }
+  local_iterator begin(size_t bucket) {
+    return {&_buckets[bucket], next_full(_buckets[bucket], 0)};
+  }
+  local_iterator end(size_t bucket) {
+    return {&_buckets[bucket], _buckets[bucket].capacity};
+  }
+  iterator find(const KEY& key) {
+    size_t hash = hash_key(key);
+    size_t bucket = compute_bucket(hash);
+    Bucket& b = _buckets[bucket];
+    std::shared_lock<FlatBucketLock> lock(b.mutex);
+    size_t index = find_index(b, key, hash);
+    if (index == b.capacity) {
+      return end();
+    }
+    return {this, bucket, index, key, b.slots[index].value};
+  }
+  FlatFeatureValue& operator[](const KEY& key) {
+    return emplace(key).first.value();
+  }
+  std::pair<iterator, bool> emplace(const KEY& key) {
+    size_t hash = hash_key(key);
+    size_t bucket = compute_bucket(hash);
+    Bucket& b = _buckets[bucket];
+    std::unique_lock<FlatBucketLock> lock(b.mutex);
+    size_t index = find_index(b, key, hash);
+    if (index != b.capacity) {
+      return {{this, bucket, index, key, b.slots[index].value}, false};
+    }
+    if (b.growth_left == 0) {
+      rehash(&b);
+    }
+    index = find_insert_index(b, hash);
+    if (b.ctrl[index] == FLAT_CTRL_EMPTY) {
+      b.growth_left--;
+    }
+    set_ctrl(&b, index, static_cast<int8_t>(hash & 0x7F));
+    b.slots[index].key = key;
+    b.slots[index].value = b.slab.acquire();
+    b.size++;
+    return {{this, bucket, index, key, b.slots[index].value}, true};
+  }
+  iterator erase(iterator it) {
+    quick_erase(it);
+    ++it;
+    return it;
+  }
+  void quick_erase(iterator it) {
+    Bucket& b = _buckets[it.bucket];
+    std::unique_lock<FlatBucketLock> lock(b.mutex);
+    erase_index(&b, it.index);
+  }
+  local_iterator erase(size_t bucket, local_iterator it) {
+    quick_erase(bucket, it);
+    ++it;
+    return it;
+  }
+  void quick_erase(size_t bucket, local_iterator it) {
+    Bucket& b = _buckets[bucket];
+    std::unique_lock<FlatBucketLock> lock(b.mutex);
+    erase_index(&b, it.index);
+  }
+  size_t erase(const KEY& key) {
+    size_t hash = hash_key(key);
+    Bucket& b = _buckets[compute_bucket(hash)];
+    std::unique_lock<FlatBucketLock> lock(b.mutex);
+    size_t index = find_index(b, key, hash);
+    if (index == b.capacity) {
+      return 0;
+    }
+    erase_index(&b, index);
+    return 1;
+  }
+  size_t compute_bucket(size_t hash) {
+    if (CTR_SPARSE_SHARD_BUCKET_NUM == 1) {
+      return 0;
+    } else {
+      return hash >> (sizeof(size_t) * 8 - CTR_SPARSE_SHARD_BUCKET_NUM_BITS);
+    }
+  }
+
+ private:
+  static constexpr size_t kGroupWidth = FlatCtrlGroup::kWidth;
+  static constexpr size_t kMinCapacity = 16;
+
+  // Feasigns are often used as their own hash, mix them so that both the
+  // bucket (high bits) and the control byte (low bits) are well spread.
+  size_t hash_key(const KEY& key) const {
+    uint64_t h = _hasher(key);
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return static_cast<size_t>(h);
+  }
+
+  static size_t next_full(const Bucket& b, size_t index) {
+    while (index < b.capacity && b.ctrl[index] < 0) {
+      ++index;
+    }
+    return index;
+  }
+
+  void seek(iterator* it) {
+    while (it->bucket < CTR_SPARSE_SHARD_BUCKET_NUM) {
+      Bucket& b = _buckets[it->bucket];
+      it->index = next_full(b, it->index);
+      if (it->index < b.capacity) {
+        it->_key = b.slots[it->index].key;
+        it->_value = b.slots[it->index].value;
+        return;
+      }
+      it->bucket++;
+      it->index = 0;
+    }
+    it->_value = NULL;
+  }
+
+  // Returns b.capacity when the key is absent.
+  static size_t find_index(const Bucket& b, const KEY& key, size_t hash) {
+    if (b.capacity == 0) {
+      return 0;
+    }
+    const int8_t h2 = static_cast<int8_t>(hash & 0x7F);
+    const size_t mask = b.capacity - 1;
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      FlatCtrlGroup group(&b.ctrl[pos]);
+      for (uint64_t match = group.match(h2); match != 0; match &= match - 1) {
+        size_t index = (pos + FlatCtrlGroup::lowest(match)) & mask;
+        if (b.slots[index].key == key) {
+          return index;
+        }
+      }
+      if (group.match_empty() != 0) {
+        return b.capacity;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  static size_t find_insert_index(const Bucket& b, size_t hash) {
+    const size_t mask = b.capacity - 1;
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = kGroupWidth;; step += kGroupWidth) {
+      FlatCtrlGroup group(&b.ctrl[pos]);
+      uint64_t match = group.match_empty_or_deleted();
+      if (match != 0) {
+        return (pos + FlatCtrlGroup::lowest(match)) & mask;
+      }
+      pos = (pos + step) & mask;
+    }
+  }
+
+  // The first kGroupWidth - 1 control bytes are mirrored after the last one,
+  // so that a group starting near the end wraps around without a branch.
+  static void set_ctrl(Bucket* b, size_t index, int8_t h) {
+    b->ctrl[index] = h;
+    b->ctrl[((index - (kGroupWidth - 1)) & (b->capacity - 1)) +
+            (kGroupWidth - 1)] = h;
+  }
+
+  void erase_index(Bucket* b, size_t index) {
+    b->slab.release(b->slots[index].value);
+    set_ctrl(b, index, FLAT_CTRL_DELETED);
+    b->size--;
+  }
+
+  size_t max_size(size_t capacity) const {
+    return std::min(static_cast<size_t>(capacity * _max_load_factor),
+                    capacity - 1);
+  }
+
+  // Grows the bucket, or only drops the deleted slots when they take up
+  // most of the room.
+  void rehash(Bucket* b) {
+    size_t capacity = std::max(b->capacity, kMinCapacity);
+    if (b->capacity != 0 && b->size * 2 >= max_size(b->capacity)) {
+      capacity = b->capacity * 2;
+    }
+    std::vector<int8_t> ctrl(capacity + kGroupWidth - 1, FLAT_CTRL_EMPTY);
+    std::vector<Slot> slots(capacity);
+    ctrl.swap(b->ctrl);
+    slots.swap(b->slots);
+    size_t old_capacity = b->capacity;
+    b->capacity = capacity;
+    // ctrl and slots now hold the previous index.
+    for (size_t i = 0; i < old_capacity; ++i) {
+      if (ctrl[i] < 0) {
+        continue;
+      }
+      size_t index = find_insert_index(*b, hash_key(slots[i].key));
+      set_ctrl(b, index, ctrl[i]);
+      b->slots[index] = slots[i];
+    }
+    b->growth_left = max_size(capacity) - b->size;
+  }
+
+  Bucket _buckets[CTR_SPARSE_SHARD_BUCKET_NUM];
+  std::hash<KEY> _hasher;
+  float _max_load_factor = 0.875f;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,329 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_compact_shard.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_sampler.h"
+#include "paddle/phi/core/enforce.h"
+namespace paddle::distributed {
+
+namespace {
+
+inline void write_varint(uint64_t value, std::vector<uint8_t> *out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+inline const uint8_t *read_varint(const uint8_t *p, uint64_t *value) {
+  uint64_t result = 0;
+  int shift = 0;
+  while (*p & 0x80) {
+    result |= static_cast<uint64_t>(*p & 0x7f) << shift;
+    shift += 7;
+    ++p;
+  }
+  *value = result | static_cast<uint64_t>(*p) << shift;
+  return p + 1;
+}
+
+inline size_t block_num(size_t degree) {
+  return (degree + CompactEdgeShard::kBlockSize - 1) /
+         CompactEdgeShard::kBlockSize;
+}
+
+}  // namespace
+
+void CompactEdgeShard::add_edge(uint64_t src_id,
+                                uint64_t dst_id,
+                                float weight) {
+  if (!loading_) {
+    loading_ = true;
+    weighted_before_load_ = is_weighted();
+  }
+  pending_edges_.push_back({src_id, dst_id, weight});
+  pending_weighted_ = pending_weighted_ || weight != 1;
+  // Bounds the buffered edges, which take 24 bytes each, while merging
+  // about as many bytes of encoded edges per buffered one as they take.
+  // The weights are kept until finalize tells whether the load needs them.
+  if (pending_edges_.size() >= std::max(kMinPendingEdges, edge_size() / 8)) {
+    merge_pending(is_weighted() || pending_weighted_);
+  }
+}
+
+void CompactEdgeShard::finalize(bool weighted) {
+  if (!loading_) {
+    return;
+  }
+  merge_pending(weighted || weighted_before_load_);
+  std::vector<PendingEdge>().swap(pending_edges_);
+  loading_ = false;
+  pending_weighted_ = false;
+  node_ids_.shrink_to_fit();
+  offsets_.shrink_to_fit();
+  edge_offsets_.shrink_to_fit();
+  arena_.shrink_to_fit();
+  weights_.shrink_to_fit();
+}
+
+void CompactEdgeShard::merge_pending(bool weighted) {
+  const auto less = [](const PendingEdge &a, const PendingEdge &b) {
+    return a.src_id < b.src_id || (a.src_id == b.src_id && a.dst_id < b.dst_id);
+  };
+  std::sort(pending_edges_.begin(), pending_edges_.end(), less);
+
+  size_t edge_num = edge_size() + pending_edges_.size();
+  size_t node_num = node_ids_.size();
+  for (size_t i = 0; i < pending_edges_.size(); ++i) {
+    if (i == 0 || pending_edges_[i].src_id != pending_edges_[i - 1].src_id) {
+      ++node_num;
+    }
+  }
+  std::vector<uint64_t> node_ids;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> edge_offsets(1, 0);
+  std::vector<uint8_t> arena;
+  std::vector<float> weights;
+  node_ids.reserve(node_num);
+  offsets.reserve(node_num + 1);
+  edge_offsets.reserve(node_num + 1);
+  // about 3 bytes per delta of the random neighbors of a sparse graph
+  arena.reserve(arena_.size() + pending_edges_.size() * 3);
+  if (weighted) {
+    weights.reserve(edge_num);
+  }
+  const auto add_weights = [&](const PendingEdge *edges, size_t size) {
+    if (!weighted) return;
+    for (size_t i = 0; i < size; ++i) {
+      weights.push_back(edges[i].weight);
+    }
+  };
+
+  // A node with edges in only one side is copied or encoded, one with
+  // edges in both sides is decoded and merged.
+  std::vector<PendingEdge> merged;
+  size_t old_index = 0, begin = 0;
+  const size_t old_num = node_ids_.size(), pending_num = pending_edges_.size();
+  while (old_index < old_num || begin < pending_num) {
+    size_t end = begin;
+    uint64_t src_id = begin < pending_num
+                          ? pending_edges_[begin].src_id
+                          : std::numeric_limits<uint64_t>::max();
+    while (end < pending_num && pending_edges_[end].src_id == src_id) {
+      ++end;
+    }
+    bool has_old = old_index < old_num && node_ids_[old_index] <= src_id;
+    bool has_pending =
+        begin < pending_num && !(has_old && node_ids_[old_index] < src_id);
+    node_ids.push_back(has_old ? node_ids_[old_index] : src_id);
+    offsets.push_back(arena.size());
+    if (has_old && !has_pending) {
+      size_t size = degree(old_index);
+      arena.insert(arena.end(),
+                   arena_.begin() + offsets_[old_index],
+                   arena_.begin() + offsets_[old_index + 1]);
+      if (weighted) {
+        for (uint32_t j = 0; j < size; ++j) {
+          weights.push_back(get_neighbor_weight(old_index, j));
+        }
+      }
+      edge_offsets.push_back(edge_offsets.back() + size);
+      ++old_index;
+      continue;
+    }
+    const PendingEdge *edges = &pending_edges_[begin];
+    size_t size = end - begin;
+    if (has_old) {
+      std::vector<uint64_t> neighbors;
+      get_neighbors(old_index, &neighbors);
+      std::vector<PendingEdge> old_edges(neighbors.size());
+      for (uint32_t j = 0; j < neighbors.size(); ++j) {
+        old_edges[j] = {
+            src_id, neighbors[j], get_neighbor_weight(old_index, j)};
+      }
+      merged.clear();
+      std::merge(old_edges.begin(),
+                 old_edges.end(),
+                 pending_edges_.begin() + begin,
+                 pending_edges_.begin() + end,
+                 std::back_inserter(merged),
+                 less);
+      edges = merged.data();
+      size = merged.size();
+      ++old_index;
+    }
+    encode_neighbors(edges, size, &arena);
+    add_weights(edges, size);
+    edge_offsets.push_back(edge_offsets.back() + size);
+    begin = end;
+  }
+  offsets.push_back(arena.size());
+
+  node_ids_.swap(node_ids);
+  offsets_.swap(offsets);
+  edge_offsets_.swap(edge_offsets);
+  arena_.swap(arena);
+  weights_.swap(weights);
+  pending_edges_.clear();
+}
+
+// The blocks after the first one start at offsets stored as uint32 before
+// the first block, relative to the first block, so the bytes of a node are
+// copied as they are.
+void CompactEdgeShard::encode_neighbors(const PendingEdge *edges,
+                                        size_t size,
+                                        std::vector<uint8_t> *arena) const {
+  size_t header = arena->size();
+  arena->resize(header + (block_num(size) - 1) * sizeof(uint32_t));
+  size_t first_block = arena->size();
+  for (size_t i = 0; i < size; ++i) {
+    if (i % kBlockSize != 0) {
+      write_varint(edges[i].dst_id - edges[i - 1].dst_id, arena);
+      continue;
+    }
+    if (i > 0) {
+      size_t block_offset = arena->size() - first_block;
+      PADDLE_ENFORCE_LE(block_offset,
+                        std::numeric_limits<uint32_t>::max(),
+                        phi::errors::OutOfRange(
+                            "The neighbors of node %d are too many to "
+                            "encode.",
+                            edges[i].src_id));
+      uint32_t offset = block_offset;
+      memcpy(&(*arena)[header + (i / kBlockSize - 1) * sizeof(uint32_t)],
+             &offset,
+             sizeof(uint32_t));
+    }
+    write_varint(edges[i].dst_id, arena);
+  }
+}
+
+void CompactEdgeShard::clear() {
+  std::vector<uint64_t>().swap(node_ids_);
+  std::vector<uint64_t>().swap(offsets_);
+  std::vector<uint64_t>().swap(edge_offsets_);
+  std::vector<uint8_t>().swap(arena_);
+  std::vector<float>().swap(weights_);
+  std::vector<PendingEdge>().swap(pending_edges_);
+  loading_ = false;
+  pending_weighted_ = false;
+}
+
+int64_t CompactEdgeShard::find(uint64_t id) const {
+  auto it = std::lower_bound(node_ids_.begin(), node_ids_.end(), id);
+  if (it == node_ids_.end() || *it != id) {
+    return -1;
+  }
+  return it - node_ids_.begin();
+}
+
+const uint8_t *CompactEdgeShard::blocks_begin(int64_t index) const {
+  return arena_.data() + offsets_[index] +
+         (block_num(degree(index)) - 1) * sizeof(uint32_t);
+}
+
+uint64_t CompactEdgeShard::get_neighbor_id(int64_t index,
+                                           uint32_t pos) const {
+  const uint8_t *p = blocks_begin(index);
+  uint32_t block = pos / kBlockSize;
+  if (block > 0) {
+    uint32_t offset;
+    memcpy(&offset,
+           arena_.data() + offsets_[index] + (block - 1) * sizeof(uint32_t),
+           sizeof(uint32_t));
+    p += offset;
+  }
+  uint64_t id, delta;
+  p = read_varint(p, &id);
+  for (uint32_t i = block * kBlockSize; i < pos; ++i) {
+    p = read_varint(p, &delta);
+    id += delta;
+  }
+  return id;
+}
+
+void CompactEdgeShard::get_neighbors(int64_t index,
+                                     std::vector<uint64_t> *res) const {
+  size_t size = degree(index);
+  const uint8_t *p = blocks_begin(index);
+  uint64_t id = 0, value;
+  for (size_t i = 0; i < size; ++i) {
+    p = read_varint(p, &value);
+    id = i % kBlockSize == 0 ? value : id + value;
+    res->push_back(id);
+  }
+}
+
+void CompactEdgeShard::sample_k(int64_t index,
+                                int k,
+                                std::mt19937_64 *rng,
+                                std::vector<uint32_t> *res) const {
+  uint32_t size = degree(index);
+  if (weights_.empty()) {
+    sample_uniform_positions(size, k, rng, res);
+  } else {
+    sample_weighted_positions(
+        weights_.data() + edge_offsets_[index], size, k, rng, res);
+  }
+}
+
+size_t CompactEdgeShard::get_all_id(
+    std::vector<std::vector<uint64_t>> *shard_keys, int slice_num) const {
+  shard_keys->resize(slice_num);
+  for (int i = 0; i < slice_num; ++i) {
+    (*shard_keys)[i].reserve(node_ids_.size() / slice_num);
+  }
+  for (uint64_t k : node_ids_) {
+    (*shard_keys)[k % slice_num].emplace_back(k);
+  }
+  return node_ids_.size();
+}
+
+size_t CompactEdgeShard::get_all_neighbor_id(
+    std::vector<uint64_t> *keys) const {
+  keys->reserve(keys->size() + edge_size());
+  for (size_t i = 0; i < node_ids_.size(); ++i) {
+    get_neighbors(i, keys);
+  }
+  return edge_size();
+}
+
+void CompactEdgeShard::to_csr(std::vector<uint64_t> *node_ids,
+                              std::vector<uint64_t> *offsets,
+                              std::vector<uint64_t> *neighbors,
+                              std::vector<float> *weights) const {
+  *node_ids = node_ids_;
+  *offsets = edge_offsets_.empty() ? std::vector<uint64_t>(1, 0)
+                                   : edge_offsets_;
+  neighbors->clear();
+  get_all_neighbor_id(neighbors);
+  *weights = weights_;
+}
+
+size_t CompactEdgeShard::memory_size() const {
+  return node_ids_.capacity() * sizeof(uint64_t) +
+         offsets_.capacity() * sizeof(uint64_t) +
+         edge_offsets_.capacity() * sizeof(uint64_t) + arena_.capacity() +
+         weights_.capacity() * sizeof(float) +
+         pending_edges_.capacity() * sizeof(PendingEdge);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace paddle {
+namespace distributed {
+
+// The edges of a graph shard in columns instead of a GraphNode per node:
+// the sorted ids of the source nodes, the offsets of their neighbors, and
+// the neighbors of every node sorted and encoded as varint deltas in one
+// arena. The neighbors are split in blocks of kBlockSize, each starting
+// with a full id, so the neighbor at a position is decoded from its block.
+// An edge takes a few bytes where a GraphNode takes tens.
+//
+// The edges are buffered by add_edge and merged into the encoded ones in
+// chunks of at least kMinPendingEdges and at most an eighth of the encoded
+// edges, and by finalize. Only the nodes of a chunk that already have
+// edges are decoded, the others are copied as they are. add_edge and
+// finalize are not thread safe. Once finalized the shard is read by any
+// number of threads.
+class CompactEdgeShard {
+ public:
+  static constexpr uint32_t kBlockSize = 128;
+  static constexpr size_t kMinPendingEdges = 1 << 20;
+
+  void add_edge(uint64_t src_id, uint64_t dst_id, float weight);
+  // Encodes the buffered edges together with the ones encoded before. The
+  // weights are kept if `weighted` or if they were kept before the first
+  // add_edge since the last finalize, the edges without a weight then
+  // weigh 1.
+  void finalize(bool weighted);
+  void clear();
+
+  // The index of node `id`, -1 if it has no edges in the shard.
+  int64_t find(uint64_t id) const;
+  size_t degree(int64_t index) const {
+    return edge_offsets_[index + 1] - edge_offsets_[index];
+  }
+  uint64_t get_id(int64_t index) const { return node_ids_[index]; }
+  uint64_t get_neighbor_id(int64_t index, uint32_t pos) const;
+  float get_neighbor_weight(int64_t index, uint32_t pos) const {
+    return weights_.empty() ? 1.0 : weights_[edge_offsets_[index] + pos];
+  }
+  // Appends the neighbors of the node at `index` to `res`.
+  void get_neighbors(int64_t index, std::vector<uint64_t> *res) const;
+  // Samples min(k, degree) distinct neighbors of the node at `index` in
+  // proportion to their weights, and appends their positions to `res`.
+  void sample_k(int64_t index,
+                int k,
+                std::mt19937_64 *rng,
+                std::vector<uint32_t> *res) const;
+
+  // Splits the node ids by id % slice_num, as GraphShard::get_all_id.
+  size_t get_all_id(std::vector<std::vector<uint64_t>> *shard_keys,
+                    int slice_num) const;
+  // Appends the neighbors of every node to `keys`.
+  size_t get_all_neighbor_id(std::vector<uint64_t> *keys) const;
+  // Decodes the shard to the arrays of CsrGraphShard::build.
+  void to_csr(std::vector<uint64_t> *node_ids,
+              std::vector<uint64_t> *offsets,
+              std::vector<uint64_t> *neighbors,
+              std::vector<float> *weights) const;
+
+  size_t node_size() const { return node_ids_.size(); }
+  size_t edge_size() const {
+    return edge_offsets_.empty() ? 0 : edge_offsets_.back();
+  }
+  bool is_weighted() const { return !weights_.empty(); }
+  size_t memory_size() const;
+
+ private:
+  struct PendingEdge {
+    uint64_t src_id;
+    uint64_t dst_id;
+    float weight;
+  };
+  // The start of the first block of the node at `index`.
+  const uint8_t *blocks_begin(int64_t index) const;
+  // Merges the sorted pending edges into the encoded ones.
+  void merge_pending(bool weighted);
+  void encode_neighbors(const PendingEdge *edges,
+                        size_t size,
+                        std::vector<uint8_t> *arena) const;
+
+  std::vector<uint64_t> node_ids_;
+  // the first byte of every node in arena_, and the index of its first
+  // edge, which is also the index of its first weight
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> edge_offsets_;
+  std::vector<uint8_t> arena_;
+  std::vector<float> weights_;
+  std::vector<PendingEdge> pending_edges_;
+  // whether add_edge was called since the last finalize, and is_weighted()
+  // before that call
+  bool loading_ = false;
+  bool weighted_before_load_ = false;
+  // whether an edge added since the last finalize weighs other than 1
+  bool pending_weighted_ = false;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -0,0 +1,314 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_set>
+#include <utility>
+
+#include "paddle/phi/core/enforce.h"
+namespace paddle::distributed {
+
+namespace {
+
+// The finalizer of splitmix64, the node ids are often sequential.
+inline uint64_t mix(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// The positions sampled so far for a node, searched linearly while few.
+class SampledSet {
+ public:
+  SampledSet(std::vector<uint32_t> *res, size_t start, int k)
+      : res_(res), start_(start), use_set_(k > 64) {}
+
+  bool insert(uint32_t pos) {
+    if (use_set_) {
+      if (!set_.insert(pos).second) {
+        return false;
+      }
+    } else if (std::find(res_->begin() + start_, res_->end(), pos) !=
+               res_->end()) {
+      return false;
+    }
+    res_->push_back(pos);
+    return true;
+  }
+
+  bool contains(uint32_t pos) const {
+    if (use_set_) {
+      return set_.count(pos) > 0;
+    }
+    return std::find(res_->begin() + start_, res_->end(), pos) != res_->end();
+  }
+
+ private:
+  std::vector<uint32_t> *res_;
+  size_t start_;
+  bool use_set_;
+  std::unordered_set<uint32_t> set_;
+};
+
+}  // namespace
+
+void sample_uniform_positions(uint32_t n,
+                              int k,
+                              std::mt19937_64 *rng,
+                              std::vector<uint32_t> *res) {
+  if (k <= 0) {
+    return;
+  }
+  if (static_cast<uint32_t>(k) >= n) {
+    for (uint32_t i = 0; i < n; ++i) {
+      res->push_back(i);
+    }
+    return;
+  }
+  // Floyd's algorithm, one draw per position.
+  SampledSet sampled(res, res->size(), k);
+  for (uint32_t j = n - k; j < n; ++j) {
+    uint32_t pos = std::uniform_int_distribution<uint32_t>(0, j)(*rng);
+    if (sampled.contains(pos)) {
+      sampled.insert(j);
+    } else {
+      sampled.insert(pos);
+    }
+  }
+}
+
+// Efraimidis and Spirakis: the k largest u^(1 / w), compared by their logs.
+void sample_weighted_positions(const float *weights,
+                               uint32_t n,
+                               int k,
+                               std::mt19937_64 *rng,
+                               std::vector<uint32_t> *res) {
+  if (k <= 0) {
+    return;
+  }
+  if (static_cast<uint32_t>(k) >= n) {
+    for (uint32_t i = 0; i < n; ++i) {
+      res->push_back(i);
+    }
+    return;
+  }
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::vector<std::pair<double, uint32_t>> keys(n);
+  for (uint32_t i = 0; i < n; ++i) {
+    double w = weights[i];
+    double u = std::max(uniform(*rng), std::numeric_limits<double>::min());
+    keys[i].first = w > 0 ? std::log(u) / w
+                          : -std::numeric_limits<double>::infinity();
+    keys[i].second = i;
+  }
+  std::nth_element(keys.begin(),
+                   keys.begin() + k,
+                   keys.end(),
+                   std::greater<std::pair<double, uint32_t>>());
+  for (int i = 0; i < k; ++i) {
+    res->push_back(keys[i].second);
+  }
+}
+
+void CsrGraphShard::build(const std::vector<Node *> &nodes, bool weighted) {
+  std::vector<uint64_t> node_ids;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> neighbors;
+  std::vector<float> weights;
+  size_t edge_num = 0;
+  for (auto *node : nodes) {
+    edge_num += node->get_neighbor_size();
+  }
+  node_ids.reserve(nodes.size());
+  offsets.reserve(nodes.size() + 1);
+  neighbors.reserve(edge_num);
+  if (weighted) {
+    weights.reserve(edge_num);
+  }
+  offsets.push_back(0);
+  for (auto *node : nodes) {
+    node_ids.push_back(node->get_id());
+    size_t degree = node->get_neighbor_size();
+    for (size_t i = 0; i < degree; ++i) {
+      neighbors.push_back(node->get_neighbor_id(i));
+      if (weighted) {
+        weights.push_back(static_cast<float>(node->get_neighbor_weight(i)));
+      }
+    }
+    offsets.push_back(neighbors.size());
+  }
+  build(std::move(node_ids),
+        std::move(offsets),
+        std::move(neighbors),
+        std::move(weights));
+}
+
+void CsrGraphShard::build(std::vector<uint64_t> &&node_ids,
+                          std::vector<uint64_t> &&offsets,
+                          std::vector<uint64_t> &&neighbors,
+                          std::vector<float> &&weights) {
+  PADDLE_ENFORCE_EQ(offsets.size(),
+                    node_ids.size() + 1,
+                    phi::errors::InvalidArgument(
+                        "The CSR offsets should have one more element than "
+                        "the %d nodes, but got %d.",
+                        node_ids.size(),
+                        offsets.size()));
+  PADDLE_ENFORCE_EQ(
+      weights.empty() || weights.size() == neighbors.size(),
+      true,
+      phi::errors::InvalidArgument(
+          "The CSR weights should be empty or one per edge, but got %d "
+          "weights of %d edges.",
+          weights.size(),
+          neighbors.size()));
+  PADDLE_ENFORCE_LT(node_ids.size(),
+                    std::numeric_limits<uint32_t>::max(),
+                    phi::errors::InvalidArgument(
+                        "Too many nodes in a graph shard: %d.",
+                        node_ids.size()));
+  node_ids_ = std::move(node_ids);
+  offsets_ = std::move(offsets);
+  neighbors_ = std::move(neighbors);
+  weights_ = std::move(weights);
+
+  // At most half of the slots are used.
+  size_t slot_num = 2;
+  while (slot_num < node_ids_.size() * 2) {
+    slot_num <<= 1;
+  }
+  slots_.assign(slot_num, 0);
+  slot_mask_ = slot_num - 1;
+  for (size_t i = 0; i < node_ids_.size(); ++i) {
+    uint64_t slot = mix(node_ids_[i]) & slot_mask_;
+    while (slots_[slot] != 0) {
+      slot = (slot + 1) & slot_mask_;
+    }
+    slots_[slot] = i + 1;
+  }
+
+  alias_prob_.clear();
+  alias_.clear();
+  if (!weights_.empty()) {
+    alias_prob_.resize(neighbors_.size());
+    alias_.resize(neighbors_.size());
+    for (size_t i = 0; i < node_ids_.size(); ++i) {
+      build_alias(offsets_[i], offsets_[i + 1]);
+    }
+  }
+}
+
+// Vose's method: the weights scaled to a mean of 1 are split into the
+// columns under 1, each topped up by one column over 1, its alias.
+void CsrGraphShard::build_alias(uint64_t begin, uint64_t end) {
+  uint32_t n = end - begin;
+  double sum = 0;
+  for (uint64_t i = begin; i < end; ++i) {
+    sum += std::max(weights_[i], 0.0f);
+  }
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (uint32_t i = 0; i < n; ++i) {
+    scaled[i] = sum > 0 ? std::max(weights_[begin + i], 0.0f) * n / sum : 1;
+    if (scaled[i] < 1) {
+      small.push_back(i);
+    } else {
+      large.push_back(i);
+    }
+  }
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back();
+    small.pop_back();
+    uint32_t l = large.back();
+    alias_prob_[begin + s] = scaled[s];
+    alias_[begin + s] = l;
+    scaled[l] -= 1 - scaled[s];
+    if (scaled[l] < 1) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Left by rounding, their columns are full.
+  for (auto *rest : {&small, &large}) {
+    for (uint32_t i : *rest) {
+      alias_prob_[begin + i] = 1;
+      alias_[begin + i] = i;
+    }
+  }
+}
+
+int64_t CsrGraphShard::find(uint64_t id) const {
+  if (node_ids_.empty()) {
+    return -1;
+  }
+  uint64_t slot = mix(id) & slot_mask_;
+  while (slots_[slot] != 0) {
+    uint32_t index = slots_[slot] - 1;
+    if (node_ids_[index] == id) {
+      return index;
+    }
+    slot = (slot + 1) & slot_mask_;
+  }
+  return -1;
+}
+
+void CsrGraphShard::sample_k(int64_t index,
+                             int k,
+                             std::mt19937_64 *rng,
+                             std::vector<uint32_t> *res) const {
+  uint32_t n = degree(index);
+  if (weights_.empty() || k <= 0 || static_cast<uint32_t>(k) >= n) {
+    sample_uniform_positions(n, k, rng, res);
+    return;
+  }
+  // Drawing from the alias table until k distinct neighbors are found
+  // samples them without replacement in proportion to their weights. A node
+  // whose weight is on a few neighbors rejects most draws, its sample is
+  // then drawn again by the exponential keys of the weights.
+  uint64_t begin = offsets_[index];
+  size_t start = res->size();
+  SampledSet sampled(res, start, k);
+  std::uniform_int_distribution<uint32_t> column(0, n - 1);
+  std::uniform_real_distribution<float> coin(0, 1);
+  int found = 0;
+  for (int draw = 0; draw < 4 * k + 16 && found < k; ++draw) {
+    uint32_t pos = column(*rng);
+    if (coin(*rng) >= alias_prob_[begin + pos]) {
+      pos = alias_[begin + pos];
+    }
+    if (sampled.insert(pos)) {
+      ++found;
+    }
+  }
+  if (found < k) {
+    res->resize(start);
+    sample_weighted_positions(weights_.data() + begin, n, k, rng, res);
+  }
+}
+
+size_t CsrGraphShard::memory_size() const {
+  return node_ids_.capacity() * sizeof(uint64_t) +
+         slots_.capacity() * sizeof(uint32_t) +
+         offsets_.capacity() * sizeof(uint64_t) +
+         neighbors_.capacity() * sizeof(uint64_t) +
+         weights_.capacity() * sizeof(float) +
+         alias_prob_.capacity() * sizeof(float) +
+         alias_.capacity() * sizeof(uint32_t);
+}
+
+}  // namespace paddle::distributed
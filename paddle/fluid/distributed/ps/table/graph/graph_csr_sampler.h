@@ -0,0 +1,109 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_node.h"
+namespace paddle {
+namespace distributed {
+
+// Appends min(k, n) distinct positions in [0, n) drawn uniformly to `res`.
+void sample_uniform_positions(uint32_t n,
+                              int k,
+                              std::mt19937_64 *rng,
+                              std::vector<uint32_t> *res);
+// Appends min(k, n) distinct positions in [0, n), each draw picks a position
+// not drawn yet in proportion to weights[position], in O(n).
+void sample_weighted_positions(const float *weights,
+                               uint32_t n,
+                               int k,
+                               std::mt19937_64 *rng,
+                               std::vector<uint32_t> *res);
+
+// An immutable copy of the edges of a GraphShard in CSR form. It is never
+// written after build, so any number of threads sample it without locks.
+// A node is found by an open addressing table, and the edges of a node in
+// a weighted shard have a Walker alias table, so a weighted draw is O(1).
+class CsrGraphShard {
+ public:
+  // Copies the edges of `nodes`. The weights are kept only if `weighted`,
+  // otherwise the neighbors are sampled uniformly.
+  void build(const std::vector<Node *> &nodes, bool weighted);
+  // Takes the CSR arrays, the neighbors of node_ids[i] are
+  // neighbors[offsets[i]] to neighbors[offsets[i + 1] - 1]. `weights` is
+  // empty or has the weight of every edge.
+  void build(std::vector<uint64_t> &&node_ids,
+             std::vector<uint64_t> &&offsets,
+             std::vector<uint64_t> &&neighbors,
+             std::vector<float> &&weights);
+
+  // The index of node `id`, -1 if it is not in the shard.
+  int64_t find(uint64_t id) const;
+  size_t degree(int64_t index) const {
+    return offsets_[index + 1] - offsets_[index];
+  }
+  uint64_t get_neighbor_id(int64_t index, uint32_t pos) const {
+    return neighbors_[offsets_[index] + pos];
+  }
+  float get_neighbor_weight(int64_t index, uint32_t pos) const {
+    return weights_.empty() ? 1.0 : weights_[offsets_[index] + pos];
+  }
+  // Samples min(k, degree) distinct neighbors of the node at `index`, each
+  // draw picks a neighbor not sampled yet in proportion to its weight, and
+  // appends their positions among the neighbors of the node to `res`.
+  void sample_k(int64_t index,
+                int k,
+                std::mt19937_64 *rng,
+                std::vector<uint32_t> *res) const;
+
+  size_t node_size() const { return node_ids_.size(); }
+  size_t edge_size() const { return neighbors_.size(); }
+  size_t memory_size() const;
+
+ private:
+  void build_alias(uint64_t begin, uint64_t end);
+
+  std::vector<uint64_t> node_ids_;
+  // index + 1 of the nodes by the hash of their ids, 0 for an empty slot
+  std::vector<uint32_t> slots_;
+  uint64_t slot_mask_ = 0;
+  std::vector<uint64_t> offsets_;
+  std::vector<uint64_t> neighbors_;
+  std::vector<float> weights_;
+  // the alias table of every edge, the alias is a position among the
+  // neighbors of the same node
+  std::vector<float> alias_prob_;
+  std::vector<uint32_t> alias_;
+};
+
+// The CSR copy of the local shards of an edge type of GraphTable.
+using CsrGraphSnapshot = std::vector<std::unique_ptr<CsrGraphShard>>;
+
+// The neighbors sampled for one hop of GraphTable::sample_multi_hop, the
+// neighbors of src_ids[i] are neighbors[offsets[i]] to
+// neighbors[offsets[i + 1] - 1].
+struct GraphSampleHop {
+  std::vector<uint64_t> src_ids;
+  std::vector<uint64_t> offsets;
+  std::vector<uint64_t> neighbors;
+  // empty if the weights are not needed
+  std::vector<float> weights;
+};
+
+}  // namespace distributed
+}  // namespace paddle
@@ -20,6 +20,7 @@
 #include "paddle/fluid/distributed/common/local_random.h"
 #include "paddle/fluid/distributed/common/topk_calculator.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint.h"
 #include "paddle/fluid/framework/archive.h"
 #include "paddle/fluid/framework/io/fs.h"
 
@@ -38,10 +39,22 @@ PD_DEFINE_bool(pserver_enable_create_feasign_randomly,
 PD_DEFINE_int32(pserver_table_save_max_retry,
                 3,
                 "pserver_table_save_max_retry");
+PD_DEFINE_bool(pserver_sparse_table_binary_checkpoint,
+               false,
+               "save the checkpoint (param 0) of MemorySparseTable in the "
+               "binary block compressed format, Load tells it by the .bin "
+               "suffix of the files");
+PD_DEFINE_int32(pserver_sparse_checkpoint_block_kb,
+                4096,
+                "raw size of the blocks of the binary sparse checkpoint");
 
 namespace paddle::distributed {
 
-int32_t MemorySparseTable::Initialize() {
+// The number of values PushSparse hands to the accessor in one Update call.
+static constexpr size_t kPushBatchSize = 64;
+
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Initialize() {
   auto &profiler = CostProfiler::instance();
   profiler.register_profiler("pserver_sparse_update_all");
   profiler.register_profiler("pserver_sparse_select_all");
@@ -54,7 +67,8 @@ int32_t MemorySparseTable::Initialize() {
   return 0;
 }
 
-int32_t MemorySparseTable::InitializeValue() {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::InitializeValue() {
   _sparse_table_shard_num = static_cast<int>(_config.shard_num());
   _avg_local_shard_num =
       sparse_local_shard_num(_sparse_table_shard_num, _shard_num);
@@ -76,7 +90,7 @@ int32_t MemorySparseTable::InitializeValue() {
           << " _task_pool_size:" << _task_pool_size
           << " _use_gpu_graph:" << _use_gpu_graph;
 
-  _local_shards.reset(new shard_type[_real_local_shard_num]);
+  _local_shards.reset(CreateShards());
 
   if (_config.enable_revert()) {
     // calculate merged shard number based on config param;
@@ -100,13 +114,28 @@ int32_t MemorySparseTable::InitializeValue() {
     LOG(INFO) << "merged shard info: [" << _m_sparse_table_shard_num << "|"
               << _m_avg_local_shard_num << "|" << _m_real_local_shard_num
               << "]";
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
+    _local_shards_new.reset(CreateShards());
   }
   return 0;
 }
 
-int32_t MemorySparseTable::Load(const std::string &path,
-                                const std::string &param) {
+template <class SHARD>
+typename MemorySparseTableImpl<SHARD>::shard_type *
+MemorySparseTableImpl<SHARD>::CreateShards() {
+  shard_type *shards = new shard_type[_real_local_shard_num];  // NOLINT
+  const auto &info = _value_accessor->GetAccessorInfo();
+  size_t value_dim = info.size / sizeof(float);
+  // most features are never extended with their mf part
+  size_t inline_dim = (info.size - info.mf_size) / sizeof(float);
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    shards[i].set_value_dim(value_dim, inline_dim);
+  }
+  return shards;
+}
+
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Load(const std::string &path,
+                                            const std::string &param) {
   std::string table_path = TableDir(path);
   auto file_list = _afs_client.list(table_path);
 
@@ -153,6 +182,11 @@ int32_t MemorySparseTable::Load(const std::string &path,
     channel_config.path = file_list[file_start_idx + i];
     VLOG(1) << "MemorySparseTable::load begin load " << channel_config.path
             << " into local shard " << i;
+    if (::paddle::string::ends_with(channel_config.path,
+                                    kSparseCheckpointSuffix)) {
+      LoadBinaryShard(channel_config.path, i);
+      continue;
+    }
     channel_config.converter = _value_accessor->Converter(load_param).converter;
     channel_config.deconverter =
         _value_accessor->Converter(load_param).deconverter;
@@ -203,8 +237,9 @@ int32_t MemorySparseTable::Load(const std::string &path,
   return 0;
 }
 
-int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
-                                     int load_param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::LoadPatch(
+    const std::vector<std::string> &file_list, int load_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -303,18 +338,21 @@ int32_t MemorySparseTable::LoadPatch(const std::vector<std::string> &file_list,
   return 0;
 }
 
-void MemorySparseTable::Revert() {
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::Revert() {
   for (int i = 0; i < _real_local_shard_num; ++i) {
     _local_shards_new[i].clear();
   }
 }
 
-void MemorySparseTable::CheckSavePrePatchDone() {
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::CheckSavePrePatchDone() {
   _save_patch_model_thread.join();
 }
 
-int32_t MemorySparseTable::Save(const std::string &dirname,
-                                const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Save(const std::string &dirname,
+                                            const std::string &param) {
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -336,9 +374,12 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   // patch model
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);  // NOLINT
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _local_shards_new.reset(CreateShards());
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
@@ -353,6 +394,12 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
 
   size_t file_start_idx = _avg_local_shard_num * _shard_idx;
 
+  if (save_param == 0 && FLAGS_pserver_sparse_table_binary_checkpoint) {
+    SaveBinary(table_path, save_param, &tk);
+    _local_show_threshold = tk.top();
+    return 0;
+  }
+
 #ifdef PADDLE_WITH_HETERPS
   int thread_num = _real_local_shard_num;
 #else
@@ -453,9 +500,166 @@ int32_t MemorySparseTable::Save(const std::string &dirname,
   return 0;
 }
 
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::SaveBinary(const std::string &table_path,
+                                                  int save_param,
+                                                  TopkCalculator *tk) {
+#ifdef PADDLE_WITH_HETERPS
+  int thread_num = _real_local_shard_num;
+#else
+  int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
+#endif
+  // An exception must not leave the parallel region, the error of every
+  // shard is kept and thrown after it.
+  std::vector<std::string> shard_errors(_real_local_shard_num);
+  omp_set_num_threads(thread_num);
+#pragma omp parallel for schedule(dynamic)
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    try {
+      SaveBinaryShard(table_path, save_param, i, tk);
+    } catch (const std::exception &e) {
+      shard_errors[i] = e.what();
+    } catch (...) {
+      shard_errors[i] = "unknown exception";
+    }
+  }
+  for (int i = 0; i < _real_local_shard_num; ++i) {
+    PADDLE_ENFORCE_EQ(
+        shard_errors[i].empty(),
+        true,
+        phi::errors::External(
+            "MemorySparseTable save binary of local shard %d failed: %s",
+            i,
+            shard_errors[i]));
+  }
+  return 0;
+}
+
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::SaveBinaryShard(
+    const std::string &table_path,
+    int save_param,
+    int shard_id,
+    TopkCalculator *tk) {
+  size_t file_start_idx = _avg_local_shard_num * _shard_idx;
+  const size_t block_bytes =
+      static_cast<size_t>(FLAGS_pserver_sparse_checkpoint_block_kb) * 1024;
+  FsChannelConfig channel_config = {};
+  channel_config.path =
+      ::paddle::string::format_string("%s/part-%03d-%05d%s",
+                                      table_path.c_str(),
+                                      _shard_idx,
+                                      file_start_idx + shard_id,
+                                      kSparseCheckpointSuffix);
+  auto &shard = _local_shards[shard_id];
+  auto &task_pool = _shards_task_pool[shard_id % _task_pool_size];
+  bool is_write_failed = false;
+  int retry_num = 0;
+  int err_no = 0;
+  uint64_t feasign_size = 0;
+  do {
+    err_no = 0;
+    feasign_size = 0;
+    auto write_channel =
+        _afs_client.open_w(channel_config, 1024 * 1024 * 40, &err_no);
+    SparseCheckpointWriter writer(write_channel);
+    SparseCheckpointBlock block;
+    // Copies the values one bucket at a time in the task pool of the shard,
+    // so pull and push of the shard only wait for one bucket, while the
+    // blocks copied before are compressed and written.
+    for (size_t bucket = 0; bucket < shard.bucket_count(); ++bucket) {
+      task_pool
+          ->enqueue([this, &shard, &block, bucket, save_param, tk, shard_id]() {
+            for (auto it = shard.begin(bucket); it != shard.end(bucket); ++it) {
+              auto &value = it.value();
+              if (_config.enable_sparse_table_cache() &&
+                  (save_param == 1 || save_param == 2) &&
+                  _value_accessor->Save(value.data(), 4)) {
+                tk->push(shard_id,
+                         _value_accessor->GetField(value.data(), "show"));
+              }
+              if (_value_accessor->Save(value.data(), save_param)) {
+                block.Add(it.key(), value.data(), value.size());
+              }
+            }
+          })
+          .get();
+      if (block.RawSize() >= block_bytes) {
+        feasign_size += block.RecordNum();
+        writer.Append(std::move(block));
+        block = SparseCheckpointBlock();
+      }
+    }
+    feasign_size += block.RecordNum();
+    writer.Append(std::move(block));
+    is_write_failed = writer.Finish() != 0;
+    // err_no of the pipe is only set when it is closed.
+    write_channel->close();
+    if (err_no == -1) {
+      is_write_failed = true;
+    }
+    if (is_write_failed) {
+      ++retry_num;
+      LOG(ERROR) << "MemorySparseTable save binary failed, retry it! path:"
+                 << channel_config.path << " , retry_num=" << retry_num;
+      _afs_client.remove(channel_config.path);
+    }
+    if (retry_num > FLAGS_pserver_table_save_max_retry) {
+      LOG(ERROR) << "MemorySparseTable save binary failed reach max limit!";
+      exit(-1);
+    }
+  } while (is_write_failed);
+  task_pool
+      ->enqueue([this, &shard, save_param]() {
+        for (auto it = shard.begin(); it != shard.end(); ++it) {
+          _value_accessor->UpdateStatAfterSave(it.value().data(), save_param);
+        }
+      })
+      .get();
+  LOG(INFO) << "MemorySparseTable save binary success, path: "
+            << channel_config.path << " feasign_size: " << feasign_size;
+}
+
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::LoadBinaryShard(const std::string &path,
+                                                   int shard_id) {
+  FsChannelConfig channel_config = {};
+  channel_config.path = path;
+  auto &shard = _local_shards[shard_id];
+  int retry_num = 0;
+  while (true) {
+    int err_no = 0;
+    try {
+      auto read_channel = _afs_client.open_r(channel_config, 0, &err_no);
+      ReadSparseCheckpoint(
+          read_channel.get(),
+          path,
+          [&shard](uint64_t key, const float *data, uint32_t dim) {
+            auto &value = shard[key];
+            value.resize(dim);
+            memcpy(value.data(), data, sizeof(float) * dim);
+          });
+      read_channel->close();
+      if (err_no != -1) {
+        return;
+      }
+    } catch (const std::exception &e) {
+      LOG(ERROR) << e.what();
+    }
+    ++retry_num;
+    LOG(ERROR) << "MemorySparseTable load binary failed, retry it! path:"
+               << path << " , retry_num=" << retry_num;
+    if (retry_num > FLAGS_pserver_table_save_max_retry) {
+      LOG(ERROR) << "MemorySparseTable load failed reach max limit!";
+      exit(-1);
+    }
+  }
+}
+
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
-int32_t MemorySparseTable::Save_v2(const std::string &dirname,
-                                   const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Save_v2(const std::string &dirname,
+                                               const std::string &param) {
   if (_real_local_shard_num == 0) {
     _local_show_threshold = -1;
     return 0;
@@ -468,9 +672,12 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
   // patch model
   if (save_param == 5) {
     _local_shards_patch_model.reset(_local_shards_new.release());
-    _local_shards_new.reset(new shard_type[_real_local_shard_num]);
-    _save_patch_model_thread = std::thread(std::bind(
-        &MemorySparseTable::SavePatch, this, std::string(dirname), save_param));
+    _local_shards_new.reset(CreateShards());
+    _save_patch_model_thread =
+        std::thread(std::bind(&MemorySparseTableImpl::SavePatch,
+                              this,
+                              std::string(dirname),
+                              save_param));
     return 0;
   }
 
@@ -655,7 +862,9 @@ int32_t MemorySparseTable::Save_v2(const std::string &dirname,
 }
 #endif
 
-int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::SavePatch(const std::string &path,
+                                                 int save_param) {
   if (!_config.enable_revert()) {
     LOG(INFO) << "MemorySparseTable should be enabled revert.";
     return 0;
@@ -744,7 +953,8 @@ int32_t MemorySparseTable::SavePatch(const std::string &path, int save_param) {
   return 0;
 }
 
-int64_t MemorySparseTable::CacheShuffle(
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::CacheShuffle(
     const std::string &path,
     const std::string &param,
     double cache_threshold,
@@ -857,7 +1067,8 @@ int64_t MemorySparseTable::CacheShuffle(
   return 0;
 }
 
-int32_t MemorySparseTable::SaveCache(
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::SaveCache(
     const std::string &path,
     const std::string &param,
     ::paddle::framework::Channel<std::pair<uint64_t, std::string>>
@@ -906,7 +1117,8 @@ int32_t MemorySparseTable::SaveCache(
   return feasign_size;
 }
 
-int64_t MemorySparseTable::LocalSize() {
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::LocalSize() {
   int64_t local_size = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     local_size += _local_shards[i].size();
@@ -914,7 +1126,8 @@ int64_t MemorySparseTable::LocalSize() {
   return local_size;
 }
 
-int64_t MemorySparseTable::LocalMFSize() {
+template <class SHARD>
+int64_t MemorySparseTableImpl<SHARD>::LocalMFSize() {
   std::vector<int64_t> size_arr(_real_local_shard_num, 0);
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   int64_t ret_size = 0;
@@ -941,13 +1154,15 @@ int64_t MemorySparseTable::LocalMFSize() {
   return ret_size;
 }
 
-std::pair<int64_t, int64_t> MemorySparseTable::PrintTableStat() {
+template <class SHARD>
+std::pair<int64_t, int64_t> MemorySparseTableImpl<SHARD>::PrintTableStat() {
   int64_t feasign_size = LocalSize();
   int64_t mf_size = LocalMFSize();
   return {feasign_size, mf_size};
 }
 
-int32_t MemorySparseTable::Pull(TableContext &context) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Pull(TableContext &context) {
   CHECK(context.value_type == Sparse);
   if (context.use_ptr) {
     char **pull_values = context.pull_context.ptr_values;
@@ -961,7 +1176,8 @@ int32_t MemorySparseTable::Pull(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::Push(TableContext &context) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Push(TableContext &context) {
   CHECK(context.value_type == Sparse);
   if (!context.use_ptr) {
     return PushSparse(
@@ -973,8 +1189,9 @@ int32_t MemorySparseTable::Push(TableContext &context) {
   }
 }
 
-int32_t MemorySparseTable::PullSparse(float *pull_values,
-                                      const PullSparseValue &pull_value) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PullSparse(
+    float *pull_values, const PullSparseValue &pull_value) {
   CostTimer timer("pserver_sparse_select_all");
   std::vector<std::future<int>> tasks(_real_local_shard_num);
 
@@ -1050,11 +1267,13 @@ int32_t MemorySparseTable::PullSparse(float *pull_values,
   return 0;
 }
 
-int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
-                                         char **pull_values,
-                                         const uint64_t *keys,
-                                         size_t num,
-                                         uint16_t pass_id) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PullSparsePtr(
+    int shard_id,  // fake num
+    char **pull_values,
+    const uint64_t *keys,
+    size_t num,
+    uint16_t pass_id) {
   CostTimer timer("pscore_sparse_select_all");
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
@@ -1085,7 +1304,7 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
                 uint64_t key = item.first;
                 auto itr = local_shard.find(key);
                 size_t data_size = value_size - mf_value_size;
-                FixedFeatureValue *ret = NULL;
+                feature_value_type *ret = NULL;
                 if (itr == local_shard.end()) {
                   // ++missed_keys;
                   auto &feature_value = local_shard[key];
@@ -1109,9 +1328,10 @@ int32_t MemorySparseTable::PullSparsePtr(int shard_id,  // fake num
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float *values,
-                                      size_t num) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PushSparse(const uint64_t *keys,
+                                                  const float *values,
+                                                  size_t num) {
   CostTimer timer("pserver_sparse_update_all");
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
@@ -1142,6 +1362,26 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard_new = _local_shards_new[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          // The values extended to the full size are updated in place, a
+          // batch at a time, the values never move while the shard is pushed.
+          uint64_t batch_keys[kPushBatchSize];
+          float *batch_values[kPushBatchSize];
+          const float *batch_updates[kPushBatchSize];
+          size_t batch_num = 0;
+          auto update_batch = [&]() {
+            _value_accessor->Update(batch_values, batch_updates, batch_num);
+            if (_config.enable_revert()) {
+              for (size_t i = 0; i < batch_num; ++i) {
+                feature_value_type *feature_value_new =
+                    &(local_shard_new[batch_keys[i]]);
+                feature_value_new->resize(value_col);
+                memcpy(feature_value_new->data(),
+                       batch_values[i],
+                       value_col * sizeof(float));
+              }
+            }
+            batch_num = 0;
+          };
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
@@ -1168,21 +1408,26 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
             size_t value_size = feature_value.size();
 
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
-            } else {
-              // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
-              memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
-              _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
-
-              if (_value_accessor->NeedExtendMF(data_buffer)) {
-                feature_value.resize(value_col);
-                value_data = feature_value.data();
-                _value_accessor->Create(&value_data, 1);
+              batch_keys[batch_num] = key;
+              batch_values[batch_num] = value_data;
+              batch_updates[batch_num] = update_data;
+              if (++batch_num == kPushBatchSize) {
+                update_batch();
               }
-              memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
+              continue;
             }
+            // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+            memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
+            _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+
+            if (_value_accessor->NeedExtendMF(data_buffer)) {
+              feature_value.resize(value_col);
+              value_data = feature_value.data();
+              _value_accessor->Create(&value_data, 1);
+            }
+            memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             if (_config.enable_revert()) {
-              FixedFeatureValue *feature_value_new = &(local_shard_new[key]);
+              feature_value_type *feature_value_new = &(local_shard_new[key]);
               auto new_size = feature_value.size();
               feature_value_new->resize(new_size);
               memcpy(feature_value_new->data(),
@@ -1190,6 +1435,7 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
                      new_size * sizeof(float));
             }
           }
+          update_batch();
           return 0;
         });
   }
@@ -1200,9 +1446,10 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
-                                      const float **values,
-                                      size_t num) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::PushSparse(const uint64_t *keys,
+                                                  const float **values,
+                                                  size_t num) {
   std::vector<std::future<int>> tasks(_real_local_shard_num);
   std::vector<std::vector<std::pair<uint64_t, int>>> task_keys(
       _real_local_shard_num);
@@ -1222,6 +1469,9 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
           auto &local_shard = _local_shards[shard_id];
           float data_buffer[value_col];  // NOLINT
           float *data_buffer_ptr = data_buffer;
+          float *batch_values[kPushBatchSize];
+          const float *batch_updates[kPushBatchSize];
+          size_t batch_num = 0;
           for (auto &item : keys) {
             uint64_t key = item.first;
             uint64_t push_data_idx = item.second;
@@ -1245,7 +1495,12 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
             float *value_data = feature_value.data();
             size_t value_size = feature_value.size();
             if (value_size == value_col) {  // 已拓展到最大size, 则就地update
-              _value_accessor->Update(&value_data, &update_data, 1);
+              batch_values[batch_num] = value_data;
+              batch_updates[batch_num] = update_data;
+              if (++batch_num == kPushBatchSize) {
+                _value_accessor->Update(batch_values, batch_updates, batch_num);
+                batch_num = 0;
+              }
             } else {
               // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
               memcpy(data_buffer_ptr, value_data, value_size * sizeof(float));
@@ -1258,6 +1513,7 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
               memcpy(value_data, data_buffer_ptr, value_size * sizeof(float));
             }
           }
+          _value_accessor->Update(batch_values, batch_updates, batch_num);
           return 0;
         });
   }
@@ -1268,9 +1524,11 @@ int32_t MemorySparseTable::PushSparse(const uint64_t *keys,
   return 0;
 }
 
-int32_t MemorySparseTable::Flush() { return 0; }
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Flush() { return 0; }
 
-int32_t MemorySparseTable::Shrink(const std::string &param) {
+template <class SHARD>
+int32_t MemorySparseTableImpl<SHARD>::Shrink(const std::string &param) {
   VLOG(0) << "MemorySparseTable::Shrink";
   std::atomic<uint32_t> shrink_size_all{0};
   int thread_num = _real_local_shard_num;
@@ -1295,6 +1553,13 @@ int32_t MemorySparseTable::Shrink(const std::string &param) {
   return 0;
 }
 
-void MemorySparseTable::Clear() { VLOG(0) << "clear coming soon"; }
+template <class SHARD>
+void MemorySparseTableImpl<SHARD>::Clear() {
+  VLOG(0) << "clear coming soon";
+}
+
+template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+template class MemorySparseTableImpl<FlatSparseTableShard<uint64_t>>;
 
 }  // namespace paddle::distributed
@@ -29,6 +29,7 @@
 #include "paddle/fluid/distributed/ps/table/accessor.h"
 #include "paddle/fluid/distributed/ps/table/common_table.h"
 #include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/flat_feature_value.h"
 #include "paddle/utils/string/string_helper.h"
 
 #define PSERVER_SAVE_SUFFIX ".shard"
@@ -36,11 +37,17 @@
 namespace paddle {
 namespace distributed {
 
-class MemorySparseTable : public Table {
+class TopkCalculator;
+
+// SHARD is the storage of one local shard, SparseTableShard or
+// FlatSparseTableShard.
+template <class SHARD>
+class MemorySparseTableImpl : public Table {
  public:
-  typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
-  MemorySparseTable() {}
-  virtual ~MemorySparseTable() {}
+  typedef SHARD shard_type;
+  typedef typename SHARD::value_type feature_value_type;
+  MemorySparseTableImpl() {}
+  virtual ~MemorySparseTableImpl() {}
 
   // unused method end
   static int32_t sparse_local_shard_num(uint32_t shard_num,
@@ -118,6 +125,17 @@ class MemorySparseTable : public Table {
   virtual int32_t SavePatch(const std::string& path, int save_param);
   virtual int32_t LoadPatch(const std::vector<std::string>& file_list,
                             int save_param);
+  // Binary checkpoint, see sparse_checkpoint.h. Fills \p tk like the text
+  // save does.
+  int32_t SaveBinary(const std::string& table_path,
+                     int save_param,
+                     TopkCalculator* tk);
+  void SaveBinaryShard(const std::string& table_path,
+                       int save_param,
+                       int shard_id,
+                       TopkCalculator* tk);
+  void LoadBinaryShard(const std::string& path, int shard_id);
+  shard_type* CreateShards();
 
   int _task_pool_size = 24;
   int _avg_local_shard_num;
@@ -139,5 +157,18 @@ class MemorySparseTable : public Table {
   bool _use_gpu_graph = false;
 };
 
+typedef MemorySparseTableImpl<SparseTableShard<uint64_t, FixedFeatureValue>>
+    MemorySparseTable;
+// Keeps the values inline in a flat hash index, see FlatSparseTableShard.
+// A value holds the floats without mf inline and moves to a row of the full
+// accessor dim once extended. PullSparsePtr hands out FlatFeatureValue
+// pointers, so it does not work with heter ps.
+typedef MemorySparseTableImpl<FlatSparseTableShard<uint64_t>>
+    MemoryFlatSparseTable;
+
+extern template class MemorySparseTableImpl<
+    SparseTableShard<uint64_t, FixedFeatureValue>>;
+extern template class MemorySparseTableImpl<FlatSparseTableShard<uint64_t>>;
+
 }  // namespace distributed
 }  // namespace paddle
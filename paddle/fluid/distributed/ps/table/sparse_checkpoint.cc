@@ -0,0 +1,295 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint.h"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <exception>
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+struct BlockHeader {
+  uint32_t raw_size;
+  uint32_t compressed_size;
+  uint32_t crc;
+  uint32_t record_num;
+};
+
+template <typename T>
+void AppendPod(std::string* out, const T& value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void ReadExactly(FsReadChannel* channel,
+                 char* data,
+                 size_t size,
+                 const std::string& path) {
+  PADDLE_ENFORCE_EQ(
+      static_cast<size_t>(channel->read(data, size)),
+      size,
+      phi::errors::InvalidArgument(
+          "The sparse checkpoint %s is truncated, please check whether it is "
+          "complete or damaged.",
+          path));
+}
+
+uint32_t Crc32(const std::string& data) {
+  return static_cast<uint32_t>(
+      crc32(0L, reinterpret_cast<const Bytef*>(data.data()), data.size()));
+}
+
+}  // namespace
+
+void SparseCheckpointBlock::Add(uint64_t key,
+                                const float* value,
+                                uint32_t dim) {
+  AppendPod(&raw_, key);
+  AppendPod(&raw_, dim);
+  raw_.append(reinterpret_cast<const char*>(value), sizeof(float) * dim);
+  ++record_num_;
+}
+
+SparseCheckpointWriter::SparseCheckpointWriter(
+    std::shared_ptr<FsWriteChannel> channel, size_t max_pending_blocks)
+    : channel_(std::move(channel)),
+      raw_blocks_(paddle::framework::MakeChannel<SparseCheckpointBlock>(
+          max_pending_blocks)),
+      compressed_blocks_(paddle::framework::MakeChannel<CompressedBlock>(
+          max_pending_blocks)) {
+  write_failed_ = channel_->write(kSparseCheckpointMagic,
+                                  sizeof(kSparseCheckpointMagic)) != 0;
+  compress_thread_ = std::thread(&SparseCheckpointWriter::Compress, this);
+  write_thread_ = std::thread(&SparseCheckpointWriter::Write, this);
+}
+
+SparseCheckpointWriter::~SparseCheckpointWriter() {
+  if (!finished_) {
+    Finish();
+  }
+}
+
+void SparseCheckpointWriter::Append(SparseCheckpointBlock&& block) {
+  if (block.Empty()) {
+    return;
+  }
+  PADDLE_ENFORCE_LE(
+      block.RawSize(),
+      static_cast<size_t>(UINT32_MAX),
+      phi::errors::InvalidArgument(
+          "A sparse checkpoint block must be smaller than 4GB, but got %d "
+          "bytes.",
+          block.RawSize()));
+  record_num_ += block.RecordNum();
+  raw_blocks_->Put(std::move(block));
+}
+
+void SparseCheckpointWriter::Compress() {
+  SparseCheckpointBlock block;
+  while (raw_blocks_->Get(block)) {
+    // Keeps draining after a failure, so that Append never blocks.
+    if (compress_failed_) {
+      continue;
+    }
+    CompressedBlock compressed;
+    uLongf size = compressBound(block.raw_.size());
+    compressed.payload.resize(size);
+    int ret = compress2(reinterpret_cast<Bytef*>(&compressed.payload[0]),
+                        &size,
+                        reinterpret_cast<const Bytef*>(block.raw_.data()),
+                        block.raw_.size(),
+                        Z_BEST_SPEED);
+    if (ret != Z_OK) {
+      LOG(ERROR) << "compress sparse checkpoint block failed: " << ret;
+      compress_failed_ = true;
+      continue;
+    }
+    compressed.payload.resize(size);
+    compressed.raw_size = static_cast<uint32_t>(block.raw_.size());
+    compressed.crc = Crc32(compressed.payload);
+    compressed.record_num = block.record_num_;
+    compressed_blocks_->Put(std::move(compressed));
+  }
+  compressed_blocks_->Close();
+}
+
+void SparseCheckpointWriter::Write() {
+  CompressedBlock block;
+  while (compressed_blocks_->Get(block)) {
+    // Keeps draining after a failure, so that the other stages never block.
+    if (write_failed_) {
+      continue;
+    }
+    BlockHeader header = {block.raw_size,
+                          static_cast<uint32_t>(block.payload.size()),
+                          block.crc,
+                          block.record_num};
+    write_failed_ =
+        channel_->write(reinterpret_cast<const char*>(&header),
+                        sizeof(header)) != 0 ||
+        channel_->write(block.payload.data(), block.payload.size()) != 0;
+  }
+}
+
+int SparseCheckpointWriter::Finish() {
+  finished_ = true;
+  raw_blocks_->Close();
+  compress_thread_.join();
+  write_thread_.join();
+  write_failed_ = write_failed_ || compress_failed_;
+  if (!write_failed_) {
+    BlockHeader end = {0, 0, 0, 0};
+    write_failed_ =
+        channel_->write(reinterpret_cast<const char*>(&end), sizeof(end)) !=
+            0 ||
+        channel_->write(reinterpret_cast<const char*>(&record_num_),
+                        sizeof(record_num_)) != 0;
+  }
+  return write_failed_ ? -1 : 0;
+}
+
+uint64_t ReadSparseCheckpoint(
+    FsReadChannel* channel,
+    const std::string& path,
+    const std::function<void(uint64_t key, const float* value, uint32_t dim)>&
+        fn) {
+  char magic[sizeof(kSparseCheckpointMagic)];
+  ReadExactly(channel, magic, sizeof(magic), path);
+  PADDLE_ENFORCE_EQ(memcmp(magic, kSparseCheckpointMagic, sizeof(magic)),
+                    0,
+                    phi::errors::InvalidArgument(
+                        "%s is not a sparse checkpoint file.", path));
+
+  struct Block {
+    BlockHeader header;
+    std::string payload;
+  };
+  auto blocks = paddle::framework::MakeChannel<Block>(4);
+  uint64_t record_num = 0;
+  std::exception_ptr decode_error;
+  std::thread decode_thread([&]() {
+    Block block;
+    std::string raw;
+    std::vector<float> value;
+    while (blocks->Get(block)) {
+      if (decode_error) {
+        continue;
+      }
+      try {
+        PADDLE_ENFORCE_EQ(
+            Crc32(block.payload),
+            block.header.crc,
+            phi::errors::InvalidArgument(
+                "The checksum of a block of the sparse checkpoint %s "
+                "mismatches, the file is damaged.",
+                path));
+        raw.resize(block.header.raw_size);
+        uLongf size = block.header.raw_size;
+        int ret =
+            uncompress(reinterpret_cast<Bytef*>(&raw[0]),
+                       &size,
+                       reinterpret_cast<const Bytef*>(block.payload.data()),
+                       block.payload.size());
+        PADDLE_ENFORCE_EQ(
+            ret == Z_OK && size == block.header.raw_size,
+            true,
+            phi::errors::InvalidArgument(
+                "Fail to decompress a block of the sparse checkpoint %s.",
+                path));
+        size_t pos = 0;
+        for (uint32_t i = 0; i < block.header.record_num; ++i) {
+          uint64_t key;
+          uint32_t dim;
+          PADDLE_ENFORCE_LE(pos + sizeof(key) + sizeof(dim),
+                            raw.size(),
+                            phi::errors::InvalidArgument(
+                                "A record of the sparse checkpoint %s is out "
+                                "of its block.",
+                                path));
+          memcpy(&key, raw.data() + pos, sizeof(key));
+          memcpy(&dim, raw.data() + pos + sizeof(key), sizeof(dim));
+          pos += sizeof(key) + sizeof(dim);
+          PADDLE_ENFORCE_LE(pos + sizeof(float) * dim,
+                            raw.size(),
+                            phi::errors::InvalidArgument(
+                                "A record of the sparse checkpoint %s is out "
+                                "of its block.",
+                                path));
+          // The records are not aligned in the block.
+          value.resize(dim);
+          memcpy(value.data(), raw.data() + pos, sizeof(float) * dim);
+          pos += sizeof(float) * dim;
+          fn(key, value.data(), dim);
+        }
+        record_num += block.header.record_num;
+      } catch (...) {
+        decode_error = std::current_exception();
+      }
+    }
+  });
+
+  std::exception_ptr read_error;
+  uint64_t expect_record_num = 0;
+  try {
+    while (true) {
+      Block block;
+      ReadExactly(channel,
+                  reinterpret_cast<char*>(&block.header),
+                  sizeof(block.header),
+                  path);
+      if (block.header.compressed_size == 0 && block.header.raw_size == 0) {
+        ReadExactly(channel,
+                    reinterpret_cast<char*>(&expect_record_num),
+                    sizeof(expect_record_num),
+                    path);
+        break;
+      }
+      block.payload.resize(block.header.compressed_size);
+      ReadExactly(channel, &block.payload[0], block.payload.size(), path);
+      blocks->Put(std::move(block));
+    }
+  } catch (...) {
+    read_error = std::current_exception();
+  }
+  blocks->Close();
+  decode_thread.join();
+  if (read_error) {
+    std::rethrow_exception(read_error);
+  }
+  if (decode_error) {
+    std::rethrow_exception(decode_error);
+  }
+  PADDLE_ENFORCE_EQ(record_num,
+                    expect_record_num,
+                    phi::errors::InvalidArgument(
+                        "The sparse checkpoint %s has %d records, but %d are "
+                        "expected.",
+                        path,
+                        record_num,
+                        expect_record_num));
+  VLOG(3) << "Read " << record_num << " records from " << path;
+  return record_num;
+}
+
+}  // namespace distributed
+}  // namespace paddle
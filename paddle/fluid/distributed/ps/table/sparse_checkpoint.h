@@ -0,0 +1,103 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <stdint.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+
+#include "paddle/fluid/distributed/common/afs_warpper.h"
+#include "paddle/fluid/framework/channel.h"
+
+namespace paddle {
+namespace distributed {
+
+// Binary checkpoint of one shard of a sparse table.
+//
+// A file is the magic followed by blocks. Every block has a 16 bytes header
+// {raw_size, compressed_size, crc32 of the compressed payload, record_num}
+// and a zlib compressed payload of records {uint64 key, uint32 dim,
+// float[dim]}. The file ends with an empty block header and the uint64 total
+// record number, so a file truncated at a block boundary is detected too.
+constexpr char kSparseCheckpointMagic[8] = {
+    'P', 'D', 'S', 'P', 'C', 'K', 'P', '1'};
+constexpr char kSparseCheckpointSuffix[] = ".bin";
+
+// Collects records into the raw payload of a block.
+class SparseCheckpointBlock {
+ public:
+  void Add(uint64_t key, const float* value, uint32_t dim);
+  size_t RawSize() const { return raw_.size(); }
+  uint32_t RecordNum() const { return record_num_; }
+  bool Empty() const { return record_num_ == 0; }
+
+ private:
+  friend class SparseCheckpointWriter;
+  std::string raw_;
+  uint32_t record_num_ = 0;
+};
+
+// Compresses and writes the blocks of a file in two threads, so that
+// collecting the next block, compressing and writing overlap. At most
+// `max_pending_blocks` blocks wait in each stage, Append blocks the caller
+// when the writing falls behind.
+class SparseCheckpointWriter {
+ public:
+  SparseCheckpointWriter(std::shared_ptr<FsWriteChannel> channel,
+                         size_t max_pending_blocks = 4);
+  ~SparseCheckpointWriter();
+
+  void Append(SparseCheckpointBlock&& block);
+  // Waits for all the blocks to be written and writes the end of the file.
+  // Returns 0 on success and -1 if any block failed to compress or write.
+  int Finish();
+
+ private:
+  struct CompressedBlock {
+    std::string payload;
+    uint32_t raw_size;
+    uint32_t crc;
+    uint32_t record_num;
+  };
+
+  void Compress();
+  void Write();
+
+  std::shared_ptr<FsWriteChannel> channel_;
+  paddle::framework::Channel<SparseCheckpointBlock> raw_blocks_;
+  paddle::framework::Channel<CompressedBlock> compressed_blocks_;
+  std::thread compress_thread_;
+  std::thread write_thread_;
+  uint64_t record_num_ = 0;
+  bool compress_failed_ = false;
+  bool write_failed_ = false;
+  bool finished_ = false;
+};
+
+// Reads a binary checkpoint file, calls `fn` for every record. Reading the
+// next block overlaps with decompressing and visiting the current one, `fn`
+// is always called from the same thread. Throws if the file is damaged or
+// any checksum mismatches. Returns the record number.
+uint64_t ReadSparseCheckpoint(
+    FsReadChannel* channel,
+    const std::string& path,
+    const std::function<void(uint64_t key, const float* value, uint32_t dim)>&
+        fn);
+
+}  // namespace distributed
+}  // namespace paddle
@@ -17,11 +17,37 @@
 #include "glog/logging.h"
 
 #include "paddle/common/flags.h"
+#include "paddle/phi/kernels/funcs/jit/kernels.h"
 
 PD_DEFINE_bool(enable_show_scale_gradient, true, "enable show scale gradient");
 
 namespace paddle::distributed {
 
+namespace {
+
+// The kSgd kernel updating one row of `dim` floats in place.
+struct RowSgdKernel {
+  explicit RowSgdKernel(size_t dim)
+      : attr(1,
+             static_cast<int64_t>(dim),
+             1,
+             static_cast<int64_t>(dim),
+             1),
+        func(phi::jit::KernelFuncs<phi::jit::SgdTuple<float>,
+                                   phi::CPUPlace>::Cache()
+                 .At(attr)) {}
+  // w -= lr * grad
+  void operator()(float lr, float *w, const float *grad) const {
+    const int64_t rows_idx = 0;
+    func(&lr, w, grad, &rows_idx, w, &attr);
+  }
+
+  phi::jit::sgd_attr_t attr;
+  phi::jit::SgdTuple<float>::func_type func;
+};
+
+}  // namespace
+
 void SparseNaiveSGDRule::LoadConfig(const SparseCommonSGDRuleParameter &param,
                                     size_t emb_dim) {
   _embedding_dim = emb_dim;
@@ -50,6 +76,19 @@ void SparseNaiveSGDRule::UpdateValueWork(float *w,
   }
 }
 
+void SparseNaiveSGDRule::UpdateValueBatchWork(float **w,
+                                              float **sgd,
+                                              const float **push_value,
+                                              const float *scale,
+                                              size_t num) {
+  RowSgdKernel row_sgd(_embedding_dim);
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    row_sgd(learning_rate_, w[i], push_value[i]);
+    BoundRow(w[i]);
+  }
+}
+
 void SparseNaiveSGDRule::InitValueWork(float *value,
                                        float *sgd,
                                        bool zero_init) {
@@ -105,6 +144,31 @@ void SparseAdaGradSGDRule::UpdateValueWork(float *w,
   g2sum += add_g2sum / _embedding_dim;
 }
 
+void SparseAdaGradSGDRule::UpdateValueBatchWork(float **w,
+                                                float **sgd,
+                                                const float **push_value,
+                                                const float *scale,
+                                                size_t num) {
+  RowSgdKernel row_sgd(_embedding_dim);
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    const float *grad = push_value[i];
+    float &g2sum = sgd[i][G2SumIndex()];
+    // The scale of the gradient is folded into the learning rate.
+    float lr = learning_rate_ *
+               sqrt(_initial_g2sum / (_initial_g2sum + g2sum)) / scale[i];
+    row_sgd(lr, w[i], grad);
+    BoundRow(w[i]);
+
+    double add_g2sum = 0;
+    for (size_t j = 0; j < _embedding_dim; j++) {
+      double scaled_grad = grad[j] / scale[i];
+      add_g2sum += scaled_grad * scaled_grad;
+    }
+    g2sum += add_g2sum / _embedding_dim;
+  }
+}
+
 void SparseAdaGradSGDRule::InitValueWork(float *value,
                                          float *sgd,
                                          bool zero_init) {
@@ -158,6 +222,19 @@ void StdAdaGradSGDRule::UpdateValueWork(float *w,
   }
 }
 
+// Each dim has its own g2sum, the rows are updated with the per row
+// implementation called without the virtual dispatch.
+void StdAdaGradSGDRule::UpdateValueBatchWork(float **w,
+                                             float **sgd,
+                                             const float **push_value,
+                                             const float *scale,
+                                             size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    StdAdaGradSGDRule::UpdateValueWork(w[i], sgd[i], push_value[i], scale[i]);
+  }
+}
+
 void StdAdaGradSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -226,6 +303,46 @@ void SparseAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+void SparseAdamSGDRule::UpdateValueBatchWork(float **w,
+                                             float **sgd,
+                                             const float **push_value,
+                                             const float *scale,
+                                             size_t num) {
+  phi::jit::adam_attr_t attr(_beta1_decay_rate, _beta2_decay_rate);
+  auto adam =
+      phi::jit::KernelFuncs<phi::jit::AdamTuple<float>, phi::CPUPlace>::Cache()
+          .At(attr);
+  const int64_t dim = static_cast<int64_t>(_embedding_dim);
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    float *gsum = sgd[i] + GSumIndex();
+    float *g2sum = sgd[i] + G2SumIndex();
+    float *beta1_pow = sgd[i] + Beta1PowIndex();
+    float *beta2_pow = sgd[i] + Beta2PowIndex();
+
+    float lr = learning_rate_;
+    lr *= sqrt(1 - *beta2_pow) / (1 - *beta1_pow);
+    // The kernel adds lr * gsum / (sqrt(g2sum) + epsilon) to w, the moments
+    // and w are updated in place.
+    adam(_beta1_decay_rate,
+         _beta2_decay_rate,
+         -lr,
+         _ada_epsilon,
+         dim,
+         push_value[i],
+         gsum,
+         g2sum,
+         w[i],
+         gsum,
+         g2sum,
+         w[i]);
+    BoundRow(w[i]);
+    // update beta_pow_decay
+    (*beta1_pow) *= _beta1_decay_rate;
+    (*beta2_pow) *= _beta2_decay_rate;
+  }
+}
+
 void SparseAdamSGDRule::InitValueWork(float *value,
                                       float *sgd,
                                       bool zero_init) {
@@ -309,6 +426,20 @@ void SparseSharedAdamSGDRule::UpdateValueWork(float *w,
   (*beta2_pow) *= _beta2_decay_rate;
 }
 
+// The moments are shared by the dims of a row, the rows are updated with the
+// per row implementation called without the virtual dispatch.
+void SparseSharedAdamSGDRule::UpdateValueBatchWork(float **w,
+                                                   float **sgd,
+                                                   const float **push_value,
+                                                   const float *scale,
+                                                   size_t num) {
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    SparseSharedAdamSGDRule::UpdateValueWork(
+        w[i], sgd[i], push_value[i], scale[i]);
+  }
+}
+
 void SparseSharedAdamSGDRule::InitValueWork(float *value,
                                             float *sgd,
                                             bool zero_init) {
@@ -375,6 +506,31 @@ void SparseAdaGradV2SGDRule::UpdateValueWork(float *w,
   }
 }
 
+void SparseAdaGradV2SGDRule::UpdateValueBatchWork(float **w,
+                                                  float **sgd,
+                                                  const float **push_value,
+                                                  const float *scale,
+                                                  size_t num) {
+  RowSgdKernel row_sgd(_embedding_dim);
+  float epsilon = 1e-8;
+  for (size_t i = 0; i < num; ++i) {
+    PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+    const float *grad = push_value[i];
+    float &g2sum = sgd[i][G2SumIndex()];
+    double add_g2sum = 0;
+    for (size_t j = 0; j < _embedding_dim; j++) {
+      double scaled_grad = grad[j] / scale[i];
+      add_g2sum += scaled_grad * scaled_grad;
+    }
+    g2sum += add_g2sum / _embedding_dim;
+
+    // The scale of the gradient is folded into the learning rate.
+    float lr = learning_rate_ / ((sqrt(g2sum) + epsilon) * scale[i]);
+    row_sgd(lr, w[i], grad);
+    BoundRow(w[i]);
+  }
+}
+
 void SparseAdaGradV2SGDRule::InitValueWork(float *value,
                                            float *sgd,
                                            bool zero_init) {
@@ -39,6 +39,18 @@ class SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale) = 0;
+  // The default updates the rows one by one, the rules override it to set
+  // up the vectorized kernels once per batch.
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num) {
+    for (size_t i = 0; i < num; ++i) {
+      PrefetchRow(w, sgd, push_value, i + kPrefetchDistance, num);
+      UpdateValueWork(w[i], sgd[i], push_value[i], scale[i]);
+    }
+  }
   virtual void InitValueWork(float* value, float* sgd, bool zero_init) = 0;
   virtual size_t Dim() = 0;
   const std::string& GetName() const { return _name; }
@@ -51,6 +63,22 @@ class SparseValueSGDRule {
                    float scale = 1) {
     UpdateValueWork(w, sgd, push_value, scale);
   }
+  // Updates `num` rows in one call, the i-th row is w[i], sgd[i],
+  // push_value[i] and scale[i]. The same row may appear more than once, the
+  // rows are updated in order.
+  void UpdateValueBatch(float** w,
+                        float** sgd,
+                        const float** push_value,
+                        const float* scale,
+                        size_t num) {
+    if (_embedding_dim == 0) {
+      // Nothing to vectorize, the rules may still update their state.
+      SparseValueSGDRule::UpdateValueBatchWork(
+          w, sgd, push_value, scale, num);
+    } else {
+      UpdateValueBatchWork(w, sgd, push_value, scale, num);
+    }
+  }
   template <class T>
   void BoundValue(T& w) {  // NOLINT
     if (!(w >= _min_bound)) {
@@ -63,6 +91,29 @@ class SparseValueSGDRule {
   float& MaxBound() { return _max_bound; }
 
  protected:
+  // The rows of a batch are scattered over the table, the ones a few rows
+  // ahead are brought into the cache while the current one is updated.
+  static constexpr size_t kPrefetchDistance = 4;
+
+  void PrefetchRow(float** w,
+                   float** sgd,
+                   const float** push_value,
+                   size_t i,
+                   size_t num) {
+#if defined(__GNUC__)
+    if (i < num) {
+      __builtin_prefetch(w[i], 1);
+      __builtin_prefetch(sgd[i], 1);
+      __builtin_prefetch(push_value[i], 0);
+    }
+#endif
+  }
+  void BoundRow(float* w) {
+    for (size_t i = 0; i < _embedding_dim; ++i) {
+      BoundValue(w[i]);
+    }
+  }
+
   float _min_bound;
   float _max_bound;
   float _initial_range;
@@ -82,6 +133,11 @@ class SparseNaiveSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 0; }
 
@@ -97,6 +153,11 @@ class SparseAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -117,6 +178,11 @@ class SparseAdaGradV2SGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 1; }
   size_t G2SumIndex() { return 0; }
@@ -134,6 +200,11 @@ class StdAdaGradSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim; }
   size_t G2SumIndex() { return 0; }
@@ -151,6 +222,11 @@ class SparseAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return _embedding_dim * 2 + 2; }
   size_t GSumIndex() { return 0; }
@@ -173,6 +249,11 @@ class SparseSharedAdamSGDRule : public SparseValueSGDRule {
                                float* sgd,
                                const float* push_value,
                                float scale);
+  virtual void UpdateValueBatchWork(float** w,
+                                    float** sgd,
+                                    const float** push_value,
+                                    const float* scale,
+                                    size_t num);
   virtual void InitValueWork(float* value, float* sgd, bool zero_init);
   virtual size_t Dim() { return 4; }
   size_t GSumIndex() { return 0; }
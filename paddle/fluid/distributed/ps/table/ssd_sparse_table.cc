@@ -14,6 +14,8 @@
 
 #include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
 
+#include <algorithm>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/common/cost_timer.h"
 #include "paddle/fluid/distributed/common/local_random.h"
@@ -25,6 +27,13 @@ PD_DECLARE_bool(pserver_create_value_when_push);
 PD_DECLARE_bool(pserver_enable_create_feasign_randomly);
 PD_DEFINE_bool(pserver_open_strict_check, false, "pserver_open_strict_check");
 PD_DEFINE_int32(pserver_load_batch_size, 5000, "load batch size for ssd");
+PD_DEFINE_int64(pserver_ssd_tier_mem_capacity,
+                0,
+                "max number of values of a ssd table kept in memory on a "
+                "pserver, the others stay in rocksdb, 0 means no limit");
+PD_DEFINE_int32(pserver_ssd_tier_admit_freq,
+                2,
+                "how many recent pulls move a value from rocksdb to memory");
 PHI_DEFINE_EXPORTED_string(rocksdb_path,
                            "database",
                            "path of sparse table rocksdb file");
@@ -36,6 +45,16 @@ int32_t SSDSparseTable::Initialize() {
   MemorySparseTable::Initialize();
   _db = ::paddle::distributed::RocksDBHandler::GetInstance();
   _db->initialize(FLAGS_rocksdb_path, _real_local_shard_num);
+  if (FLAGS_pserver_ssd_tier_mem_capacity > 0 && _real_local_shard_num > 0) {
+    _shard_mem_capacity = std::max<int64_t>(
+        FLAGS_pserver_ssd_tier_mem_capacity / _real_local_shard_num, 1);
+    for (int i = 0; i < _real_local_shard_num; ++i) {
+      _tiers.emplace_back(new SSDShardTier(_shard_mem_capacity));
+    }
+    VLOG(0) << "SSDSparseTable keeps " << _shard_mem_capacity
+            << " values in memory per shard, admit freq "
+            << FLAGS_pserver_ssd_tier_admit_freq;
+  }
   VLOG(0) << "initialize SSDSparseTable succ";
   VLOG(0) << "SSD FLAGS_pserver_print_missed_key_num_every_push:"
           << FLAGS_pserver_print_missed_key_num_every_push;
@@ -105,6 +124,11 @@ int32_t SSDSparseTable::PullSparse(float* pull_values,
                select_value_size,
                pull_values,
                &missed_keys]() -> int {
+                if (!_tiers.empty()) {
+                  PullShardTiered(
+                      shard_id, task_keys[shard_id], pull_values, &missed_keys);
+                  return 0;
+                }
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_size];  // NOLINT
@@ -183,6 +207,9 @@ int32_t SSDSparseTable::PullSparsePtr(int shard_id,
                                       const uint64_t* pull_keys,
                                       size_t num,
                                       uint16_t pass_id) {
+  // The pointers would be left dangling by the demotion of the shard.
+  CHECK(_tiers.empty())
+      << "FLAGS_pserver_ssd_tier_mem_capacity does not support PullSparsePtr";
   CostTimer timer("pserver_ssd_sparse_select_all");
   size_t value_size = _value_accessor->GetAccessorInfo().size / sizeof(float);
   size_t mf_value_size =
@@ -357,6 +384,13 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
                update_value_col,
                values,
                &task_keys]() -> int {
+                if (!_tiers.empty()) {
+                  PushShardTiered(
+                      shard_id, task_keys[shard_id], [&](int idx) {
+                        return values + idx * update_value_col;
+                      });
+                  return 0;
+                }
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
@@ -458,6 +492,12 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
           _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
               [this, shard_id, value_col, mf_value_col, values, &task_keys]()
                   -> int {
+                if (!_tiers.empty()) {
+                  PushShardTiered(shard_id,
+                                  task_keys[shard_id],
+                                  [&](int idx) { return values[idx]; });
+                  return 0;
+                }
                 auto& keys = task_keys[shard_id];
                 auto& local_shard = _local_shards[shard_id];
                 float data_buffer[value_col];  // NOLINT
@@ -514,7 +554,336 @@ int32_t SSDSparseTable::PushSparse(const uint64_t* keys,
   return 0;
 }
 
+void SSDSparseTable::PullShardTiered(
+    int shard_id,
+    const std::vector<std::pair<uint64_t, int>>& keys,
+    float* pull_values,
+    std::atomic<uint32_t>* missed_keys) {
+  const auto& info = _value_accessor->GetAccessorInfo();
+  size_t value_size = info.size / sizeof(float);
+  size_t mf_value_size = info.mf_size / sizeof(float);
+  size_t select_value_size = info.select_size / sizeof(float);
+  uint32_t admit_freq = FLAGS_pserver_ssd_tier_admit_freq;
+  auto& local_shard = _local_shards[shard_id];
+  auto& tier = *_tiers[shard_id];
+  std::vector<float> data_buffer(value_size);
+  float* data_buffer_ptr = data_buffer.data();
+  auto select = [&](int pull_data_idx, size_t data_size) {
+    for (size_t mf_idx = data_size; mf_idx < value_size; ++mf_idx) {
+      data_buffer[mf_idx] = 0.0;
+    }
+    float* select_data = pull_values + pull_data_idx * select_value_size;
+    _value_accessor->Select(&select_data, (const float**)&data_buffer_ptr, 1);
+  };
+
+  uint64_t mem_hit = 0;
+  uint64_t ssd_hit = 0;
+  uint64_t miss = 0;
+  uint64_t admit = 0;
+  std::vector<std::pair<uint64_t, int>> cold_keys;
+  for (auto& key : keys) {
+    tier.sketch.Add(key.first);
+    auto itr = local_shard.find(key.first);
+    if (itr == local_shard.end()) {
+      cold_keys.push_back(key);
+      continue;
+    }
+    ++mem_hit;
+    size_t data_size = itr.value().size();
+    memcpy(data_buffer_ptr, itr.value().data(), data_size * sizeof(float));
+    select(key.second, data_size);
+  }
+
+  // The keys not in memory are read from rocksdb with a MultiGet per batch,
+  // which wants them sorted.
+  std::sort(cold_keys.begin(), cold_keys.end());
+  const size_t batch_size = 1024;
+  std::vector<rocksdb::Slice> db_keys;
+  std::vector<rocksdb::PinnableSlice> db_values(batch_size);
+  std::vector<rocksdb::Status> status(batch_size);
+  for (size_t begin = 0; begin < cold_keys.size(); begin += batch_size) {
+    size_t n = std::min(batch_size, cold_keys.size() - begin);
+    db_keys.clear();
+    for (size_t i = begin; i < begin + n; ++i) {
+      db_keys.emplace_back(reinterpret_cast<const char*>(&cold_keys[i].first),
+                           sizeof(uint64_t));
+    }
+    _db->multi_get(
+        shard_id, n, db_keys.data(), db_values.data(), status.data());
+    for (size_t idx = 0; idx < n; ++idx) {
+      uint64_t key = cold_keys[begin + idx].first;
+      size_t data_size = value_size - mf_value_size;
+      // A key repeated in the batch is in memory once it is admitted.
+      auto itr = local_shard.find(key);
+      if (itr != local_shard.end()) {
+        ++mem_hit;
+        data_size = itr.value().size();
+        memcpy(data_buffer_ptr, itr.value().data(), data_size * sizeof(float));
+      } else if (status[idx].IsNotFound()) {
+        missed_keys->fetch_add(1, std::memory_order_relaxed);
+        ++miss;
+        if (FLAGS_pserver_create_value_when_push) {
+          memset(data_buffer_ptr, 0, sizeof(float) * data_size);
+        } else {
+          auto& feature_value = local_shard[key];
+          feature_value.resize(data_size);
+          _value_accessor->Create(&data_buffer_ptr, 1);
+          memcpy(const_cast<float*>(feature_value.data()),
+                 data_buffer_ptr,
+                 data_size * sizeof(float));
+        }
+      } else {
+        CHECK(status[idx].ok()) << status[idx].ToString();
+        ++ssd_hit;
+        data_size = db_values[idx].size() / sizeof(float);
+        memcpy(data_buffer_ptr, db_values[idx].data(), db_values[idx].size());
+        if (tier.sketch.Estimate(key) >= admit_freq) {
+          ++admit;
+          auto& feature_value = local_shard[key];
+          feature_value.resize(data_size);
+          memcpy(const_cast<float*>(feature_value.data()),
+                 data_buffer_ptr,
+                 data_size * sizeof(float));
+          _db->del_data(
+              shard_id, reinterpret_cast<char*>(&key), sizeof(uint64_t));
+        }
+      }
+      db_values[idx].Reset();
+      select(cold_keys[begin + idx].second, data_size);
+    }
+  }
+  tier.stat.mem_hit += mem_hit;
+  tier.stat.ssd_hit += ssd_hit;
+  tier.stat.miss += miss;
+  tier.stat.admit += admit;
+  MaybeDemoteShard(shard_id);
+}
+
+void SSDSparseTable::PushShardTiered(
+    int shard_id,
+    const std::vector<std::pair<uint64_t, int>>& keys,
+    const std::function<const float*(int)>& update_data_of) {
+  const auto& info = _value_accessor->GetAccessorInfo();
+  size_t value_col = info.size / sizeof(float);
+  size_t mf_value_col = info.mf_size / sizeof(float);
+  uint32_t admit_freq = FLAGS_pserver_ssd_tier_admit_freq;
+  auto& local_shard = _local_shards[shard_id];
+  auto& tier = *_tiers[shard_id];
+  std::vector<float> data_buffer(value_col);
+  float* data_buffer_ptr = data_buffer.data();
+
+  std::vector<std::pair<uint64_t, int>> cold_keys;
+  for (auto& key : keys) {
+    auto itr = local_shard.find(key.first);
+    if (itr == local_shard.end()) {
+      cold_keys.push_back(key);
+      continue;
+    }
+    UpdateValue(&itr.value(), update_data_of(key.second), data_buffer_ptr);
+  }
+
+  std::sort(cold_keys.begin(), cold_keys.end());
+  const size_t batch_size = 1024;
+  uint64_t admit = 0;
+  std::vector<rocksdb::Slice> db_keys;
+  std::vector<rocksdb::PinnableSlice> db_values(batch_size);
+  std::vector<rocksdb::Status> status(batch_size);
+  // The values updated in rocksdb, written back once per batch.
+  std::vector<uint64_t> put_keys;
+  std::vector<std::string> put_values;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  for (size_t begin = 0; begin < cold_keys.size(); begin += batch_size) {
+    size_t n = std::min(batch_size, cold_keys.size() - begin);
+    db_keys.clear();
+    for (size_t i = begin; i < begin + n; ++i) {
+      db_keys.emplace_back(reinterpret_cast<const char*>(&cold_keys[i].first),
+                           sizeof(uint64_t));
+    }
+    _db->multi_get(
+        shard_id, n, db_keys.data(), db_values.data(), status.data());
+    put_keys.clear();
+    put_values.clear();
+    for (size_t idx = 0; idx < n; ++idx) {
+      uint64_t key = cold_keys[begin + idx].first;
+      const float* update_data = update_data_of(cold_keys[begin + idx].second);
+      auto itr = local_shard.find(key);
+      if (itr != local_shard.end()) {
+        UpdateValue(&itr.value(), update_data, data_buffer_ptr);
+        continue;
+      }
+      if (status[idx].IsNotFound()) {
+        if (FLAGS_pserver_enable_create_feasign_randomly &&
+            !_value_accessor->CreateValue(1, update_data)) {
+          continue;
+        }
+        auto value_size = value_col - mf_value_col;
+        auto& feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        _value_accessor->Create(&data_buffer_ptr, 1);
+        memcpy(const_cast<float*>(feature_value.data()),
+               data_buffer_ptr,
+               value_size * sizeof(float));
+        UpdateValue(&feature_value, update_data, data_buffer_ptr);
+        continue;
+      }
+      CHECK(status[idx].ok()) << status[idx].ToString();
+      size_t value_size = db_values[idx].size() / sizeof(float);
+      // A key repeated in the batch is admitted, so that its next update
+      // sees this one.
+      bool repeated = begin + idx + 1 < cold_keys.size() &&
+                      cold_keys[begin + idx + 1].first == key;
+      if (repeated || tier.sketch.Estimate(key) >= admit_freq) {
+        ++admit;
+        auto& feature_value = local_shard[key];
+        feature_value.resize(value_size);
+        memcpy(const_cast<float*>(feature_value.data()),
+               db_values[idx].data(),
+               value_size * sizeof(float));
+        _db->del_data(
+            shard_id, reinterpret_cast<char*>(&key), sizeof(uint64_t));
+        UpdateValue(&feature_value, update_data, data_buffer_ptr);
+        db_values[idx].Reset();
+        continue;
+      }
+      memcpy(data_buffer_ptr, db_values[idx].data(), db_values[idx].size());
+      db_values[idx].Reset();
+      _value_accessor->Update(&data_buffer_ptr, &update_data, 1);
+      put_keys.push_back(key);
+      if (value_size < value_col &&
+          _value_accessor->NeedExtendMF(data_buffer_ptr)) {
+        std::vector<float> extended(value_col);
+        float* extended_ptr = extended.data();
+        _value_accessor->Create(&extended_ptr, 1);
+        memcpy(extended_ptr, data_buffer_ptr, value_size * sizeof(float));
+        put_values.emplace_back(reinterpret_cast<char*>(extended_ptr),
+                                value_col * sizeof(float));
+      } else {
+        put_values.emplace_back(reinterpret_cast<char*>(data_buffer_ptr),
+                                value_size * sizeof(float));
+      }
+    }
+    if (!put_keys.empty()) {
+      ssd_keys.clear();
+      ssd_values.clear();
+      for (size_t i = 0; i < put_keys.size(); ++i) {
+        ssd_keys.emplace_back(reinterpret_cast<char*>(&put_keys[i]),
+                              sizeof(uint64_t));
+        ssd_values.emplace_back(&put_values[i][0], put_values[i].size());
+      }
+      _db->put_batch(shard_id, ssd_keys, ssd_values, put_keys.size());
+    }
+  }
+  tier.stat.admit += admit;
+  MaybeDemoteShard(shard_id);
+}
+
+void SSDSparseTable::UpdateValue(FixedFeatureValue* feature_value,
+                                 const float* update_data,
+                                 float* data_buffer) {
+  size_t value_col = _value_accessor->GetAccessorInfo().size / sizeof(float);
+  float* value_data = const_cast<float*>(feature_value->data());
+  size_t value_size = feature_value->size();
+  if (value_size == value_col) {  // 已拓展到最大size, 则就地update
+    _value_accessor->Update(&value_data, &update_data, 1);
+    return;
+  }
+  // 拷入buffer区进行update，然后再回填，不需要的mf则回填时抛弃了
+  memcpy(data_buffer, value_data, value_size * sizeof(float));
+  _value_accessor->Update(&data_buffer, &update_data, 1);
+  if (_value_accessor->NeedExtendMF(data_buffer)) {
+    feature_value->resize(value_col);
+    value_data = const_cast<float*>(feature_value->data());
+    _value_accessor->Create(&value_data, 1);
+  }
+  memcpy(value_data, data_buffer, value_size * sizeof(float));
+}
+
+void SSDSparseTable::MaybeDemoteShard(int shard_id) {
+  if (_local_shards[shard_id].size() <= _shard_mem_capacity ||
+      _tiers[shard_id]->demoting.exchange(true)) {
+    return;
+  }
+  // Runs after the tasks already queued on the shard, the pull or push that
+  // queues it does not wait for it.
+  _shards_task_pool[shard_id % _shards_task_pool.size()]->enqueue(
+      [this, shard_id]() -> int {
+        DemoteShard(shard_id);
+        _tiers[shard_id]->demoting = false;
+        return 0;
+      });
+}
+
+void SSDSparseTable::DemoteShard(int shard_id) {
+  auto& local_shard = _local_shards[shard_id];
+  auto& tier = *_tiers[shard_id];
+  uint32_t admit_freq = FLAGS_pserver_ssd_tier_admit_freq;
+  // Demotes a tenth more than needed, so that a shard at its capacity is
+  // not demoted after every pull.
+  size_t target = _shard_mem_capacity - _shard_mem_capacity / 10;
+  size_t bucket_count = local_shard.bucket_count();
+  uint64_t demote = 0;
+  std::vector<uint64_t> keys;
+  std::vector<FixedFeatureValue*> values;
+  std::vector<std::pair<char*, int>> ssd_keys;
+  std::vector<std::pair<char*, int>> ssd_values;
+  // A CLOCK over the buckets of the shard with the sketch as the reference
+  // bit: the first lap only demotes the values pulled less often than a
+  // value is admitted, the second any value.
+  for (int lap = 0; lap < 2 && local_shard.size() > target; ++lap) {
+    for (size_t i = 0; i < bucket_count && local_shard.size() > target; ++i) {
+      size_t bucket = tier.hand;
+      tier.hand = (tier.hand + 1) % bucket_count;
+      keys.clear();
+      values.clear();
+      for (auto it = local_shard.begin(bucket);
+           it != local_shard.end(bucket) &&
+           local_shard.size() - keys.size() > target;
+           ++it) {
+        if (lap == 0 && tier.sketch.Estimate(it.key()) >= admit_freq) {
+          continue;
+        }
+        keys.push_back(it.key());
+        values.push_back(&it.value());
+      }
+      if (keys.empty()) {
+        continue;
+      }
+      ssd_keys.clear();
+      ssd_values.clear();
+      for (size_t k = 0; k < keys.size(); ++k) {
+        ssd_keys.emplace_back(reinterpret_cast<char*>(&keys[k]),
+                              sizeof(uint64_t));
+        ssd_values.emplace_back(reinterpret_cast<char*>(values[k]->data()),
+                                values[k]->size() * sizeof(float));
+      }
+      _db->put_batch(shard_id, ssd_keys, ssd_values, keys.size());
+      for (auto key : keys) {
+        local_shard.erase(key);
+      }
+      demote += keys.size();
+    }
+  }
+  tier.stat.demote += demote;
+}
+
+void SSDSparseTable::WaitDemotion() {
+  if (_tiers.empty()) {
+    return;
+  }
+  // The demotions are queued on the task pools, behind them an empty task
+  // runs last.
+  std::vector<std::future<int>> tasks;
+  for (auto& pool : _shards_task_pool) {
+    tasks.push_back(pool->enqueue([]() -> int { return 0; }));
+  }
+  for (auto& task : tasks) {
+    task.wait();
+  }
+}
+
 int32_t SSDSparseTable::Shrink(const std::string& param) {
+  WaitDemotion();
   int thread_num = _real_local_shard_num < 20 ? _real_local_shard_num : 20;
   omp_set_num_threads(thread_num);
 #pragma omp parallel for schedule(dynamic)
@@ -555,6 +924,7 @@ int32_t SSDSparseTable::Shrink(const std::string& param) {
 }
 
 int32_t SSDSparseTable::UpdateTable() {
+  WaitDemotion();
   int count = 0;
   for (int i = 0; i < _real_local_shard_num; ++i) {
     auto& shard = _local_shards[i];
@@ -588,6 +958,7 @@ int64_t SSDSparseTable::LocalSize() {
 
 int32_t SSDSparseTable::Save(const std::string& path,
                              const std::string& param) {
+  WaitDemotion();
 #if defined(PADDLE_WITH_HETERPS) && defined(PADDLE_WITH_PSCORE)
   // gpu graph mode
   if (_use_gpu_graph) {
@@ -2942,11 +3313,19 @@ int32_t SSDSparseTable::LoadWithBinary(const std::string& path, int param) {
 
 std::pair<int64_t, int64_t> SSDSparseTable::PrintTableStat() {
   int64_t feasign_size = LocalSize();
+  if (!_tiers.empty()) {
+    SSDTierStat stat;
+    for (auto& tier : _tiers) {
+      stat.Add(tier->stat);
+    }
+    VLOG(0) << "SSDSparseTable tier: " << stat.ToString();
+  }
   return {feasign_size, -1};
 }
 
 int32_t SSDSparseTable::CacheTable(uint16_t pass_id) {
   std::lock_guard<std::mutex> guard(_table_mutex);
+  WaitDemotion();
   VLOG(0) << "cache_table";
   std::atomic<uint32_t> count{0};
   std::vector<std::future<int>> tasks;
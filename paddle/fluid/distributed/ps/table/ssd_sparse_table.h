@@ -14,9 +14,15 @@
 
 #pragma once
 
+#include <gtest/gtest_prod.h>
+
+#include <functional>
+#include <memory>
+
 #include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/depends/rocksdb_warpper.h"
 #include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/ssd_tier_cache.h"
 
 namespace paddle {
 namespace distributed {
@@ -60,7 +66,7 @@ class SSDSparseTable : public MemorySparseTable {
  public:
   typedef SparseTableShard<uint64_t, FixedFeatureValue> shard_type;
   SSDSparseTable() {}
-  virtual ~SSDSparseTable() {}
+  virtual ~SSDSparseTable() { WaitDemotion(); }
 
   int32_t Initialize() override;
   int32_t InitializeShard() override;
@@ -131,12 +137,37 @@ class SSDSparseTable : public MemorySparseTable {
   void SetDayId(int day_id) override;
 
  private:
+  FRIEND_TEST(SSDSparseTable, TieredPullPushPastCapacity);
+
+  // The pull and push of a shard when FLAGS_pserver_ssd_tier_mem_capacity
+  // bounds the values in memory: the values in rocksdb are only moved to
+  // memory once they are pulled often enough.
+  void PullShardTiered(int shard_id,
+                       const std::vector<std::pair<uint64_t, int>>& keys,
+                       float* pull_values,
+                       std::atomic<uint32_t>* missed_keys);
+  void PushShardTiered(
+      int shard_id,
+      const std::vector<std::pair<uint64_t, int>>& keys,
+      const std::function<const float*(int)>& update_data_of);
+  void UpdateValue(FixedFeatureValue* feature_value,
+                   const float* update_data,
+                   float* data_buffer);
+  // Queues a demotion of the shard on its task pool if it is over capacity.
+  void MaybeDemoteShard(int shard_id);
+  // Moves the values of the shard that are pulled the least to rocksdb,
+  // until it is below its capacity.
+  void DemoteShard(int shard_id);
+  void WaitDemotion();
+
   RocksDBHandler* _db;
   int64_t _cache_tk_size;
   double _local_show_threshold{0.0};
   std::vector<paddle::framework::Channel<std::string>> _fs_channel;
   std::mutex _table_mutex;
   int _day_id = 0;
+  size_t _shard_mem_capacity = 0;
+  std::vector<std::unique_ptr<SSDShardTier>> _tiers;
 };
 
 }  // namespace distributed
@@ -0,0 +1,152 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "paddle/utils/string/string_helper.h"
+
+namespace paddle {
+namespace distributed {
+
+// A count-min sketch of how often the keys of a shard are pulled, with
+// 4 rows of 4-bit counters. A row has 8 counters per key of `capacity`, and
+// all the counters are halved after 10 times as many additions as keys of
+// `capacity`, so the estimate follows the recent frequency of a key rather
+// than its all-time count, and a key seen once rarely estimates more.
+class FrequencySketch {
+ public:
+  explicit FrequencySketch(size_t capacity) {
+    size_t width = 64;
+    shift_ = 58;
+    while (width < capacity * 8) {
+      width <<= 1;
+      --shift_;
+    }
+    width_ = width;
+    counters_.resize(width * kRows / 2, 0);
+    sample_size_ = std::max<size_t>(capacity, 1) * 10;
+  }
+
+  void Add(uint64_t key) {
+    uint64_t hash = Mix(key);
+    for (int row = 0; row < kRows; ++row) {
+      size_t index = Index(hash, row);
+      uint8_t& pair = counters_[index / 2];
+      int shift = (index % 2) * 4;
+      if (((pair >> shift) & 0xf) < kMaxCount) {
+        pair += 1 << shift;
+      }
+    }
+    if (++additions_ >= sample_size_) {
+      for (auto& pair : counters_) {
+        pair = (pair >> 1) & 0x77;
+      }
+      additions_ /= 2;
+    }
+  }
+
+  uint32_t Estimate(uint64_t key) const {
+    uint64_t hash = Mix(key);
+    uint32_t count = kMaxCount;
+    for (int row = 0; row < kRows; ++row) {
+      size_t index = Index(hash, row);
+      uint32_t counter = (counters_[index / 2] >> ((index % 2) * 4)) & 0xf;
+      count = std::min(count, counter);
+    }
+    return count;
+  }
+
+ private:
+  static constexpr int kRows = 4;
+  static constexpr uint32_t kMaxCount = 15;
+
+  // The finalizer of splitmix64, the keys are often sequential ids.
+  static uint64_t Mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+
+  // Multiplicative hashing with an odd seed per row, the top bits index the
+  // row.
+  size_t Index(uint64_t hash, int row) const {
+    static constexpr uint64_t kSeeds[kRows] = {0x9e3779b97f4a7c15ULL,
+                                               0xc2b2ae3d27d4eb4fULL,
+                                               0x165667b19e3779f9ULL,
+                                               0xd6e8feb86659fd93ULL};
+    return row * width_ + ((hash * kSeeds[row]) >> shift_);
+  }
+
+  // Two counters per byte, the even one in the low bits.
+  std::vector<uint8_t> counters_;
+  size_t width_ = 0;
+  int shift_ = 0;
+  size_t additions_ = 0;
+  size_t sample_size_ = 0;
+};
+
+// Where the pulls of a shard are served from, and how many values move
+// between memory and rocksdb.
+struct SSDTierStat {
+  std::atomic<uint64_t> mem_hit{0};
+  std::atomic<uint64_t> ssd_hit{0};
+  std::atomic<uint64_t> miss{0};
+  std::atomic<uint64_t> admit{0};
+  std::atomic<uint64_t> demote{0};
+
+  void Add(const SSDTierStat& other) {
+    mem_hit += other.mem_hit.load(std::memory_order_relaxed);
+    ssd_hit += other.ssd_hit.load(std::memory_order_relaxed);
+    miss += other.miss.load(std::memory_order_relaxed);
+    admit += other.admit.load(std::memory_order_relaxed);
+    demote += other.demote.load(std::memory_order_relaxed);
+  }
+
+  std::string ToString() const {
+    uint64_t total = mem_hit + ssd_hit + miss;
+    double mem_rate = total == 0 ? 0.0 : static_cast<double>(mem_hit) / total;
+    double ssd_rate = total == 0 ? 0.0 : static_cast<double>(ssd_hit) / total;
+    return paddle::string::format_string(
+        "pull %llu, mem hit %.4f, ssd hit %.4f, miss %llu, admit %llu, "
+        "demote %llu",
+        static_cast<unsigned long long>(total),  // NOLINT
+        mem_rate,
+        ssd_rate,
+        static_cast<unsigned long long>(miss.load()),    // NOLINT
+        static_cast<unsigned long long>(admit.load()),   // NOLINT
+        static_cast<unsigned long long>(demote.load()));  // NOLINT
+  }
+};
+
+// The tiering state of a shard of SSDSparseTable. It is only used by the
+// task pool thread of the shard, except for the stat.
+struct SSDShardTier {
+  explicit SSDShardTier(size_t capacity) : sketch(capacity) {}
+
+  FrequencySketch sketch;
+  // The next bucket of the shard to look for values to demote.
+  size_t hand = 0;
+  // Whether a demotion of the shard is already queued.
+  std::atomic<bool> demoting{false};
+  SSDTierStat stat;
+};
+
+}  // namespace distributed
+}  // namespace paddle
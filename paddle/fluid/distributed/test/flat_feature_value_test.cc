@@ -0,0 +1,201 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/depends/flat_feature_value.h"
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+typedef FlatSparseTableShard<uint64_t> flat_shard_type;
+
+TEST(FlatSparseTableShard, FindAndResize) {
+  std::unique_ptr<flat_shard_type> shard(new flat_shard_type());
+  shard->set_value_dim(8, 8);
+  uint64_t key = 1;
+  auto itr = shard->find(key);
+  ASSERT_TRUE(itr == shard->end());
+
+  std::vector<float> vec = {0.0, 0.1, 0.2, 0.3};
+  auto& feature_value = (*shard)[key];
+  feature_value.resize(vec.size());
+  memcpy(feature_value.data(), vec.data(), vec.size() * sizeof(float));
+
+  itr = shard->find(key);
+  ASSERT_TRUE(itr != shard->end());
+  ASSERT_EQ(itr.value_ptr(), &feature_value);
+  ASSERT_EQ(itr.value().size(), vec.size());
+  float* value_data = itr.value().data();
+  ASSERT_FLOAT_EQ(value_data[0], 0.0);
+  ASSERT_FLOAT_EQ(value_data[3], 0.3);
+
+  // growing a value keeps its data and zero fills the rest
+  itr.value().resize(8);
+  ASSERT_FLOAT_EQ(value_data[1], 0.1);
+  ASSERT_FLOAT_EQ(value_data[7], 0.0);
+  ASSERT_ANY_THROW(itr.value().resize(9));
+}
+
+TEST(FlatSparseTableShard, MfRowsOnDemand) {
+  // CtrCommonAccessor with embedx_dim 8: 9 floats without mf, 17 with mf.
+  const size_t inline_dim = 9, dim = 17;
+  std::unique_ptr<flat_shard_type> shard(new flat_shard_type());
+  shard->set_value_dim(dim, inline_dim);
+  std::unique_ptr<flat_shard_type> full_shard(new flat_shard_type());
+  full_shard->set_value_dim(dim, dim);
+  const uint64_t num = 100000;
+  for (auto* s : {shard.get(), full_shard.get()}) {
+    for (uint64_t key = 0; key < num; ++key) {
+      auto& value = (*s)[key];
+      value.resize(inline_dim);
+      for (size_t i = 0; i < inline_dim; ++i) {
+        value.data()[i] = static_cast<float>(key + i);
+      }
+    }
+  }
+
+  // one value in ten is extended, it moves to an mf row but keeps its data
+  for (auto* s : {shard.get(), full_shard.get()}) {
+    for (uint64_t key = 0; key < num; key += 10) {
+      auto itr = s->find(key);
+      ASSERT_TRUE(itr != s->end());
+      auto& value = itr.value();
+      value.resize(dim);
+      ASSERT_EQ(s->find(key).value_ptr(), &value);
+      ASSERT_EQ(value.size(), dim);
+      for (size_t i = 0; i < inline_dim; ++i) {
+        ASSERT_FLOAT_EQ(value.data()[i], static_cast<float>(key + i));
+      }
+      for (size_t i = inline_dim; i < dim; ++i) {
+        ASSERT_FLOAT_EQ(value.data()[i], 0.0);
+        value.data()[i] = static_cast<float>(key * 2 + i);
+      }
+    }
+  }
+  ASSERT_ANY_THROW(shard->find(0).value().resize(dim + 1));
+  EXPECT_LT(shard->memory_size(), full_shard->memory_size());
+
+  for (uint64_t key = 0; key < num; ++key) {
+    auto& value = shard->find(key).value();
+    ASSERT_EQ(value.size(), key % 10 == 0 ? dim : inline_dim);
+    for (size_t i = 0; i < value.size(); ++i) {
+      float expected = i < inline_dim ? key + i : key * 2 + i;
+      ASSERT_FLOAT_EQ(value.data()[i], expected);
+    }
+  }
+
+  // shrinking a value moves it back inline and frees its mf row, which the
+  // next extended value reuses
+  size_t memory_size = shard->memory_size();
+  for (uint64_t key = 0; key < num; key += 10) {
+    auto& value = shard->find(key).value();
+    value.resize(inline_dim - 1);
+    ASSERT_FLOAT_EQ(value.data()[inline_dim - 2],
+                    static_cast<float>(key + inline_dim - 2));
+    ASSERT_EQ(shard->erase(key + 1), 1UL);
+  }
+  for (uint64_t key = 1; key < num; key += 10) {
+    auto& value = (*shard)[key];
+    value.resize(dim);
+    ASSERT_FLOAT_EQ(value.data()[dim - 1], 0.0);
+  }
+  EXPECT_EQ(shard->memory_size(), memory_size);
+}
+
+TEST(FlatSparseTableShard, InsertEraseIterate) {
+  std::unique_ptr<flat_shard_type> shard(new flat_shard_type());
+  shard->set_value_dim(4, 4);
+  const uint64_t num = 100000;
+  for (uint64_t key = 0; key < num; ++key) {
+    auto& value = (*shard)[key * 37];
+    value.resize(1);
+    value.data()[0] = static_cast<float>(key);
+  }
+  ASSERT_EQ(shard->size(), num);
+
+  // erase the odd keys while iterating, as MemorySparseTable::Shrink does
+  for (auto it = shard->begin(); it != shard->end();) {
+    if ((it.key() / 37) % 2 == 1) {
+      it = shard->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  ASSERT_EQ(shard->size(), num / 2);
+
+  size_t count = 0;
+  for (auto it = shard->begin(); it != shard->end(); ++it) {
+    ASSERT_EQ(it.key() % 2, 0UL);
+    ASSERT_FLOAT_EQ(it.value().data()[0], static_cast<float>(it.key() / 37));
+    ++count;
+  }
+  ASSERT_EQ(count, num / 2);
+
+  // reuse the deleted slots and rows
+  for (uint64_t key = 0; key < num; ++key) {
+    auto res = shard->emplace(key * 37);
+    ASSERT_EQ(res.second, key % 2 == 1);
+  }
+  ASSERT_EQ(shard->size(), num);
+  ASSERT_EQ(shard->erase(37), 1UL);
+  ASSERT_EQ(shard->erase(37), 0UL);
+  shard->clear();
+  ASSERT_TRUE(shard->empty());
+  ASSERT_TRUE(shard->begin() == shard->end());
+}
+
+TEST(FlatSparseTableShard, ConcurrentReaders) {
+  std::unique_ptr<flat_shard_type> shard(new flat_shard_type());
+  shard->set_value_dim(2, 2);
+  const uint64_t num = 20000;
+  for (uint64_t key = 0; key < num; ++key) {
+    auto& value = (*shard)[key];
+    value.resize(2);
+    value.data()[0] = static_cast<float>(key);
+  }
+
+  // readers look up the existing keys while the writer keeps inserting new
+  // ones, which rehashes the buckets under them
+  std::atomic<bool> failed{false};
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([&shard, &failed, num, t]() {
+      for (int round = 0; round < 5; ++round) {
+        for (uint64_t key = t; key < num; key += 4) {
+          auto itr = shard->find(key);
+          if (itr == shard->end() ||
+              itr.value().data()[0] != static_cast<float>(key)) {
+            failed = true;
+          }
+        }
+      }
+    });
+  }
+  for (uint64_t key = num; key < num * 10; ++key) {
+    (*shard)[key].resize(1);
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  ASSERT_FALSE(failed);
+  ASSERT_EQ(shard->size(), num * 10);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,157 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/graph/graph_compact_shard.h"
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+
+namespace paddle::distributed {
+
+namespace {
+
+// Adds `degree` random edges to every node of `src_ids`, and to `expected`.
+void AddEdges(const std::vector<uint64_t>& src_ids,
+              size_t degree,
+              uint64_t id_range,
+              std::mt19937_64* rng,
+              CompactEdgeShard* shard,
+              std::map<uint64_t, std::multiset<uint64_t>>* expected) {
+  std::uniform_int_distribution<uint64_t> neighbor(0, id_range - 1);
+  for (auto src_id : src_ids) {
+    for (size_t i = 0; i < degree; ++i) {
+      uint64_t dst_id = neighbor(*rng);
+      shard->add_edge(src_id, dst_id, static_cast<float>(dst_id % 7));
+      (*expected)[src_id].insert(dst_id);
+    }
+  }
+}
+
+void CheckEdges(const CompactEdgeShard& shard,
+                const std::map<uint64_t, std::multiset<uint64_t>>& expected) {
+  ASSERT_EQ(shard.node_size(), expected.size());
+  for (auto& item : expected) {
+    int64_t index = shard.find(item.first);
+    ASSERT_GE(index, 0);
+    ASSERT_EQ(shard.degree(index), item.second.size());
+    std::vector<uint64_t> neighbors;
+    shard.get_neighbors(index, &neighbors);
+    ASSERT_TRUE(
+        std::equal(neighbors.begin(), neighbors.end(), item.second.begin()));
+    for (uint32_t pos = 0; pos < neighbors.size(); ++pos) {
+      ASSERT_EQ(shard.get_neighbor_id(index, pos), neighbors[pos]);
+      if (shard.is_weighted()) {
+        ASSERT_EQ(shard.get_neighbor_weight(index, pos), neighbors[pos] % 7);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(CompactEdgeShard, Encode) {
+  std::mt19937_64 rng(0);
+  CompactEdgeShard shard;
+  std::map<uint64_t, std::multiset<uint64_t>> expected;
+  // A few nodes with more than one block of neighbors, and ids of 64 bits.
+  AddEdges({3, 1ULL << 40, UINT64_MAX},
+           1000,
+           UINT64_MAX,
+           &rng,
+           &shard,
+           &expected);
+  AddEdges({5, 8, 13}, 3, 100, &rng, &shard, &expected);
+  shard.finalize(true);
+  CheckEdges(shard, expected);
+  EXPECT_EQ(shard.find(4), -1);
+
+  // A second load merges with the encoded edges.
+  AddEdges({8, 21}, 200, 1000, &rng, &shard, &expected);
+  shard.finalize(false);
+  ASSERT_TRUE(shard.is_weighted());
+  CheckEdges(shard, expected);
+
+  std::vector<uint64_t> node_ids, offsets, neighbors;
+  std::vector<float> weights;
+  shard.to_csr(&node_ids, &offsets, &neighbors, &weights);
+  ASSERT_EQ(offsets.size(), node_ids.size() + 1);
+  ASSERT_EQ(neighbors.size(), shard.edge_size());
+  ASSERT_EQ(weights.size(), shard.edge_size());
+
+  shard.clear();
+  EXPECT_EQ(shard.node_size(), 0u);
+  EXPECT_EQ(shard.find(8), -1);
+}
+
+TEST(CompactEdgeShard, MergeInChunks) {
+  std::mt19937_64 rng(0);
+  CompactEdgeShard shard;
+  std::map<uint64_t, std::multiset<uint64_t>> expected;
+  std::vector<uint64_t> src_ids(1000);
+  for (size_t i = 0; i < src_ids.size(); ++i) {
+    src_ids[i] = i * 31;
+  }
+  // More than two chunks of buffered edges before finalize.
+  size_t degree = CompactEdgeShard::kMinPendingEdges * 5 / 2 / src_ids.size();
+  AddEdges(src_ids, degree, 100000, &rng, &shard, &expected);
+  // less than the edges buffered with their weights
+  EXPECT_LT(shard.memory_size(),
+            src_ids.size() * degree * (sizeof(uint64_t) * 2 + sizeof(float)));
+  // The weights kept for the chunks are dropped.
+  shard.finalize(false);
+  ASSERT_FALSE(shard.is_weighted());
+  CheckEdges(shard, expected);
+}
+
+TEST(CompactEdgeShard, Sample) {
+  std::mt19937_64 rng(0);
+  CompactEdgeShard shard;
+  std::map<uint64_t, std::multiset<uint64_t>> expected;
+  AddEdges({1}, 300, 1000000, &rng, &shard, &expected);
+  AddEdges({2}, 3, 1000000, &rng, &shard, &expected);
+  shard.finalize(false);
+  std::vector<uint32_t> res;
+  shard.sample_k(shard.find(1), 20, &rng, &res);
+  ASSERT_EQ(res.size(), 20u);
+  EXPECT_EQ(std::set<uint32_t>(res.begin(), res.end()).size(), 20u);
+  res.clear();
+  shard.sample_k(shard.find(2), 20, &rng, &res);
+  EXPECT_EQ(res.size(), 3u);
+}
+
+TEST(CompactEdgeShard, Memory) {
+  std::mt19937_64 rng(0);
+  CompactEdgeShard shard;
+  std::map<uint64_t, std::multiset<uint64_t>> expected;
+  std::vector<uint64_t> src_ids(100000);
+  for (size_t i = 0; i < src_ids.size(); ++i) {
+    src_ids[i] = i * 127;
+  }
+  // ids of a graph of 10M nodes with 16 edges per node
+  AddEdges(src_ids, 16, 10000000, &rng, &shard, &expected);
+  shard.finalize(false);
+  double bytes_per_edge =
+      static_cast<double>(shard.memory_size()) / shard.edge_size();
+  LOG(INFO) << "compact edges take " << bytes_per_edge << " bytes per edge";
+  // 8 bytes of a neighbor id alone in GraphEdgeBlob
+  EXPECT_LT(bytes_per_edge, 6);
+}
+
+}  // namespace paddle::distributed
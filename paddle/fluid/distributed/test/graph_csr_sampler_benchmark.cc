@@ -0,0 +1,182 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Samples the neighbors of a synthetic graph with power-law degrees from
+// CsrGraphShard on every core and reports the sampled edges per second.
+// The default graph has 1B weighted edges and takes about 20GB, set
+// --graph_benchmark_edges for a smaller one.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_set>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_sampler.h"
+
+PD_DEFINE_int64(graph_benchmark_edges, 1000000000, "edges of the graph");
+PD_DEFINE_double(graph_benchmark_alpha,
+                 2.2,
+                 "exponent of the power law of the degrees");
+PD_DEFINE_int32(graph_benchmark_fanout, 10, "neighbors sampled per node");
+PD_DEFINE_int64(graph_benchmark_samples,
+                100000000,
+                "nodes sampled by all the threads");
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr uint64_t kMinDegree = 2;
+constexpr uint64_t kMaxDegree = 1000000;
+
+// The nodes of shard s are s, s + shard_num, ..., with degrees drawn from a
+// Pareto distribution until the shard has edge_num edges.
+std::unique_ptr<CsrGraphShard> BuildShard(int s,
+                                          int shard_num,
+                                          uint64_t edge_num,
+                                          uint64_t id_range) {
+  std::mt19937_64 rng(s);
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::uniform_int_distribution<uint64_t> neighbor(0, id_range - 1);
+  std::vector<uint64_t> node_ids, offsets(1, 0), neighbors;
+  std::vector<float> weights;
+  neighbors.reserve(edge_num);
+  weights.reserve(edge_num);
+  const double exponent = -1 / (FLAGS_graph_benchmark_alpha - 1);
+  for (uint64_t id = s; neighbors.size() < edge_num; id += shard_num) {
+    double pareto = kMinDegree * std::pow(1 - uniform(rng), exponent);
+    uint64_t degree = std::min<uint64_t>({static_cast<uint64_t>(pareto),
+                                          kMaxDegree,
+                                          edge_num - neighbors.size()});
+    node_ids.push_back(id);
+    for (uint64_t i = 0; i < degree; ++i) {
+      neighbors.push_back(neighbor(rng));
+      weights.push_back(1 - uniform(rng));
+    }
+    offsets.push_back(neighbors.size());
+  }
+  auto shard = std::make_unique<CsrGraphShard>();
+  shard->build(std::move(node_ids),
+               std::move(offsets),
+               std::move(neighbors),
+               std::move(weights));
+  return shard;
+}
+
+}  // namespace
+
+TEST(CsrGraphShard, WeightedSample) {
+  std::vector<float> weights = {1, 2, 3, 4, 0, 10};
+  std::vector<uint64_t> neighbors = {10, 11, 12, 13, 14, 15};
+  auto weights_copy = weights;
+  CsrGraphShard shard;
+  shard.build({7, 9}, {0, 6, 6}, std::move(neighbors), std::move(weights));
+  ASSERT_EQ(shard.find(9), 1);
+  ASSERT_EQ(shard.find(8), -1);
+  std::vector<uint32_t> res;
+  std::mt19937_64 rng(0);
+  shard.sample_k(1, 3, &rng, &res);
+  EXPECT_TRUE(res.empty());
+
+  // One draw follows the weights.
+  const int rounds = 200000;
+  std::vector<int> counts(6, 0);
+  for (int r = 0; r < rounds; ++r) {
+    res.clear();
+    shard.sample_k(0, 1, &rng, &res);
+    ASSERT_EQ(res.size(), 1u);
+    ++counts[res[0]];
+  }
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_NEAR(static_cast<double>(counts[i]) / rounds,
+                weights_copy[i] / 20.0,
+                0.01);
+  }
+  // Five draws without replacement leave out the zero weight.
+  for (int r = 0; r < 1000; ++r) {
+    res.clear();
+    shard.sample_k(0, 5, &rng, &res);
+    std::unordered_set<uint32_t> sampled(res.begin(), res.end());
+    ASSERT_EQ(sampled.size(), 5u);
+    EXPECT_EQ(sampled.count(4), 0u);
+  }
+}
+
+TEST(CsrGraphShard, Benchmark) {
+  const int thread_num = std::max(1u, std::thread::hardware_concurrency());
+  const uint64_t edge_num = FLAGS_graph_benchmark_edges;
+  // about kMinDegree * (alpha - 1) / (alpha - 2) edges per node
+  const uint64_t id_range = edge_num / 10 + 1;
+  std::vector<std::unique_ptr<CsrGraphShard>> shards(thread_num);
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (int s = 0; s < thread_num; ++s) {
+    threads.emplace_back([&, s]() {
+      uint64_t shard_edge_num =
+          edge_num / thread_num +
+          (static_cast<uint64_t>(s) < edge_num % thread_num ? 1 : 0);
+      shards[s] = BuildShard(s, thread_num, shard_edge_num, id_range);
+    });
+  }
+  for (auto& t : threads) t.join();
+  double build_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  uint64_t node_num = 0, memory_size = 0;
+  for (auto& shard : shards) {
+    node_num += shard->node_size();
+    memory_size += shard->memory_size();
+  }
+  LOG(INFO) << "built " << node_num << " nodes, " << edge_num << " edges, "
+            << memory_size / 1024 / 1024 << "MB in " << build_seconds << "s";
+
+  // Every thread samples random nodes of its own shard, as a shard task
+  // pool of GraphTable samples the nodes of its shards.
+  std::vector<uint64_t> sampled(thread_num, 0);
+  threads.clear();
+  start = std::chrono::steady_clock::now();
+  for (int t = 0; t < thread_num; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937_64 rng(t + 1000);
+      std::vector<uint32_t> res;
+      auto& shard = shards[t];
+      std::uniform_int_distribution<int64_t> node(0, shard->node_size() - 1);
+      for (int64_t i = 0; i < FLAGS_graph_benchmark_samples / thread_num;
+           ++i) {
+        res.clear();
+        shard->sample_k(node(rng), FLAGS_graph_benchmark_fanout, &rng, &res);
+        sampled[t] += res.size();
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+  double sample_seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+          .count();
+  uint64_t total = 0;
+  for (auto n : sampled) total += n;
+  LOG(INFO) << thread_num << " threads sampled " << total << " edges in "
+            << sample_seconds << "s, " << total / sample_seconds / 1e6
+            << "M edges/s";
+  EXPECT_GT(total, 0u);
+}
+
+}  // namespace paddle::distributed
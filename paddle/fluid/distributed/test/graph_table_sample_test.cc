@@ -14,10 +14,15 @@
 
 #include <unistd.h>
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>  // NOLINT
+#include <cstring>
 #include <fstream>
 #include <iomanip>
+#include <map>
+#include <random>
+#include <set>
 #include <string>
 #include <thread>  // NOLINT
 #include <unordered_set>
@@ -25,9 +30,13 @@
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/common_graph_table.h"
+#include "paddle/fluid/distributed/ps/table/graph/graph_csr_sampler.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
+COMMON_DECLARE_bool(graph_compact_edge_storage);
+
 namespace distributed = paddle::distributed;
 
 std::vector<std::string> edges = {std::string("37\t45\t0.34"),
@@ -83,3 +92,240 @@ void testGraphSample() {
 }
 
 TEST(testGraphSample, Run) { testGraphSample(); }
+
+void testCsrSample() {
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.add_edge_types("u2u");
+  table_proto.set_shard_num(8);
+  table_proto.set_task_pool_size(4);
+  distributed::GraphTable graph_table;
+  graph_table.Initialize(table_proto);
+
+  std::map<uint64_t, std::set<uint64_t>> neighbors;
+  for (uint64_t src = 1; src <= 32; ++src) {
+    for (uint64_t dst = 1; dst <= src % 7; ++dst) {
+      graph_table.add_comm_edge(0, src, (src * 3 + dst) % 32 + 1);
+      neighbors[src].insert((src * 3 + dst) % 32 + 1);
+    }
+  }
+  graph_table.build_csr_snapshot(0, false);
+
+  std::vector<uint64_t> node_ids = {1, 5, 6, 7, 13, 100};
+  std::vector<distributed::GraphSampleHop> hops;
+  graph_table.sample_multi_hop(0, node_ids, {3, 2}, false, &hops);
+  ASSERT_EQ(hops.size(), 2u);
+  ASSERT_EQ(hops[0].src_ids, node_ids);
+  ASSERT_EQ(hops[1].src_ids, hops[0].neighbors);
+  for (auto &hop : hops) {
+    int fanout = &hop == &hops[0] ? 3 : 2;
+    ASSERT_EQ(hop.offsets.size(), hop.src_ids.size() + 1);
+    for (size_t i = 0; i < hop.src_ids.size(); ++i) {
+      auto &expected = neighbors[hop.src_ids[i]];
+      std::set<uint64_t> sampled(hop.neighbors.begin() + hop.offsets[i],
+                                 hop.neighbors.begin() + hop.offsets[i + 1]);
+      EXPECT_EQ(hop.offsets[i + 1] - hop.offsets[i],
+                std::min<size_t>(fanout, expected.size()));
+      EXPECT_EQ(sampled.size(), hop.offsets[i + 1] - hop.offsets[i]);
+      for (auto id : sampled) {
+        EXPECT_EQ(expected.count(id), 1u);
+      }
+    }
+  }
+
+  std::vector<std::shared_ptr<char>> buffers(node_ids.size());
+  std::vector<int> actual_sizes(node_ids.size());
+  graph_table.random_sample_neighbors(
+      0, node_ids.data(), 4, buffers, actual_sizes, true);
+  for (size_t i = 0; i < node_ids.size(); ++i) {
+    int item_size =
+        distributed::Node::id_size + distributed::Node::weight_size;
+    auto &expected = neighbors[node_ids[i]];
+    ASSERT_EQ(actual_sizes[i],
+              std::min<int>(4, expected.size()) * item_size);
+    for (int offset = 0; offset < actual_sizes[i]; offset += item_size) {
+      uint64_t id;
+      memcpy(&id, buffers[i].get() + offset, sizeof(id));
+      EXPECT_EQ(expected.count(id), 1u);
+    }
+  }
+
+  // The snapshot is dropped once the edges change.
+  graph_table.add_comm_edge(0, 1, 2);
+  EXPECT_ANY_THROW(
+      graph_table.sample_multi_hop(0, node_ids, {1}, false, &hops));
+}
+
+TEST(testGraphSample, CsrSample) { testCsrSample(); }
+
+// The probability of every position to be among k positions drawn one by
+// one without replacement, each in proportion to the weights left.
+void inclusion_probabilities(const std::vector<double> &weights,
+                             int k,
+                             uint32_t drawn,
+                             double prob,
+                             std::vector<double> *res) {
+  if (k == 0) return;
+  double left = 0;
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if (!(drawn & (1u << i))) left += weights[i];
+  }
+  for (size_t i = 0; i < weights.size(); ++i) {
+    if (drawn & (1u << i)) continue;
+    double p = prob * weights[i] / left;
+    (*res)[i] += p;
+    inclusion_probabilities(weights, k - 1, drawn | (1u << i), p, res);
+  }
+}
+
+std::vector<double> inclusion_probabilities(const std::vector<double> &weights,
+                                            int k) {
+  std::vector<double> res(weights.size());
+  inclusion_probabilities(weights, k, 0, 1.0, &res);
+  return res;
+}
+
+void testWeightedPositions() {
+  const std::vector<float> weights = {8, 4, 2, 1, 1};
+  const int trials = 20000;
+  std::mt19937_64 rng(7);
+  for (int k : {1, 2, 3}) {
+    std::vector<int> counts(weights.size());
+    for (int t = 0; t < trials; ++t) {
+      std::vector<uint32_t> res;
+      distributed::sample_weighted_positions(
+          weights.data(), weights.size(), k, &rng, &res);
+      ASSERT_EQ(res.size(), static_cast<size_t>(k));
+      ASSERT_EQ(std::set<uint32_t>(res.begin(), res.end()).size(), res.size());
+      for (auto pos : res) ++counts[pos];
+    }
+    auto expected = inclusion_probabilities(
+        std::vector<double>(weights.begin(), weights.end()), k);
+    for (size_t i = 0; i < weights.size(); ++i) {
+      EXPECT_NEAR(static_cast<double>(counts[i]) / trials, expected[i], 0.02)
+          << "position " << i << " of " << k << " draws";
+    }
+  }
+}
+
+TEST(testGraphSample, WeightedPositions) { testWeightedPositions(); }
+
+void testWeightedCsrSample() {
+  // Node 7 draws a distinct neighbor from the alias table most times. Almost
+  // all the weight of node 9 is on one neighbor, so its alias draws are
+  // mostly rejected and the sample falls back to the exponential keys.
+  const std::map<uint64_t, std::vector<std::pair<uint64_t, float>>> edges = {
+      {7, {{101, 8}, {102, 4}, {103, 2}, {104, 1}, {105, 1}}},
+      {9, {{201, 1000}, {202, 1}, {203, 1}, {204, 1}}}};
+  std::vector<std::string> lines;
+  for (auto &node : edges) {
+    for (auto &edge : node.second) {
+      lines.push_back(std::to_string(node.first) + "\t" +
+                      std::to_string(edge.first) + "\t" +
+                      std::to_string(edge.second));
+    }
+  }
+  char weighted_edge_file_name[] = "weighted_edges.txt";  // NOLINT
+  prepare_file(weighted_edge_file_name, lines);
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.add_edge_types("u2i");
+  table_proto.set_shard_num(8);
+  table_proto.set_task_pool_size(4);
+  distributed::GraphTable graph_table;
+  graph_table.Initialize(table_proto);
+  graph_table.load_edges(
+      std::string(weighted_edge_file_name), false, "u2i", true);
+  graph_table.build_csr_snapshot(0, true);
+
+  const int trials = 20000;
+  for (auto &node : edges) {
+    std::map<uint64_t, size_t> position;
+    std::vector<double> weights;
+    for (auto &edge : node.second) {
+      position[edge.first] = weights.size();
+      weights.push_back(edge.second);
+    }
+    for (int k : {1, 2, 3}) {
+      std::vector<distributed::GraphSampleHop> hops;
+      graph_table.sample_multi_hop(0,
+                                   std::vector<uint64_t>(trials, node.first),
+                                   {k},
+                                   true,
+                                   &hops);
+      auto &hop = hops[0];
+      ASSERT_EQ(hop.offsets.back(), static_cast<uint64_t>(trials) * k);
+      std::vector<int> counts(weights.size());
+      for (int t = 0; t < trials; ++t) {
+        ASSERT_EQ(hop.offsets[t + 1] - hop.offsets[t],
+                  static_cast<uint64_t>(k));
+        std::set<uint64_t> sampled;
+        for (uint64_t j = hop.offsets[t]; j < hop.offsets[t + 1]; ++j) {
+          auto it = position.find(hop.neighbors[j]);
+          ASSERT_NE(it, position.end());
+          EXPECT_FLOAT_EQ(hop.weights[j], weights[it->second]);
+          sampled.insert(hop.neighbors[j]);
+          ++counts[it->second];
+        }
+        ASSERT_EQ(sampled.size(), static_cast<size_t>(k));
+      }
+      auto expected = inclusion_probabilities(weights, k);
+      for (size_t i = 0; i < weights.size(); ++i) {
+        EXPECT_NEAR(
+            static_cast<double>(counts[i]) / trials, expected[i], 0.02)
+            << "neighbor " << node.second[i].first << " of node "
+            << node.first << " with " << k << " draws";
+      }
+    }
+  }
+}
+
+TEST(testGraphSample, WeightedCsrSample) { testWeightedCsrSample(); }
+
+void testCompactSample() {
+  FLAGS_graph_compact_edge_storage = true;
+  prepare_file(edge_file_name, edges);
+  ::paddle::distributed::GraphParameter table_proto;
+  table_proto.add_edge_types("u2i");
+  table_proto.set_shard_num(8);
+  table_proto.set_task_pool_size(4);
+  distributed::GraphTable graph_table;
+  graph_table.Initialize(table_proto);
+  graph_table.load_edges(std::string(edge_file_name), false, "u2i", true);
+
+  // 37 -> 45 0.34, 145 0.31, 112 0.21
+  std::map<uint64_t, float> expected = {{45, 0.34}, {145, 0.31}, {112, 0.21}};
+  std::vector<uint64_t> node_ids = {37, 45};
+  std::vector<std::shared_ptr<char>> buffers(node_ids.size());
+  std::vector<int> actual_sizes(node_ids.size());
+  graph_table.random_sample_neighbors(
+      0, node_ids.data(), 2, buffers, actual_sizes, true);
+  int item_size = distributed::Node::id_size + distributed::Node::weight_size;
+  ASSERT_EQ(actual_sizes[0], 2 * item_size);
+  ASSERT_EQ(actual_sizes[1], 0);
+  std::set<uint64_t> sampled;
+  for (int offset = 0; offset < actual_sizes[0]; offset += item_size) {
+    uint64_t id;
+    float weight;
+    memcpy(&id, buffers[0].get() + offset, sizeof(id));
+    memcpy(&weight, buffers[0].get() + offset + sizeof(id), sizeof(weight));
+    ASSERT_EQ(expected.count(id), 1u);
+    EXPECT_FLOAT_EQ(weight, expected[id]);
+    sampled.insert(id);
+  }
+  EXPECT_EQ(sampled.size(), 2u);
+
+  std::vector<std::vector<uint64_t>> ids;
+  graph_table.get_all_id(distributed::GraphTableType::EDGE_TABLE, 0, 1, &ids);
+  ASSERT_EQ(ids.size(), 1u);
+  std::sort(ids[0].begin(), ids[0].end());
+  EXPECT_EQ(ids[0], std::vector<uint64_t>({37, 59, 96, 97}));
+
+  // A second load adds to the loaded edges.
+  prepare_file(edge_file_name, {std::string("37\t46\t0.5")});
+  graph_table.load_edges(std::string(edge_file_name), false, "u2i", true);
+  std::vector<distributed::GraphSampleHop> hops;
+  graph_table.sample_multi_hop(0, {37}, {10}, false, &hops);
+  EXPECT_EQ(hops[0].neighbors.size(), 4u);
+  FLAGS_graph_compact_edge_storage = false;
+}
+
+TEST(testGraphSample, CompactSample) { testCompactSample(); }
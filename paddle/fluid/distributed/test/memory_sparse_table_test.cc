@@ -22,9 +22,12 @@ limitations under the License. */
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
+#include "paddle/common/flags.h"
 #include "paddle/fluid/distributed/ps/table/table.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
 
+PD_DECLARE_bool(pserver_sparse_table_binary_checkpoint);
+
 namespace paddle {
 namespace distributed {
 
@@ -152,5 +155,131 @@ TEST(MemorySparseTable, SGD) {
   }
 }
 
+namespace {
+
+const int kFlatEmbDim = 8;
+
+// The values are created with zeros, so that tables of different backends
+// hold the same values after the same pushes.
+void InitFlatTestTable(Table *table, const std::string &table_class) {
+  TableParameter table_config;
+  table_config.set_table_class(table_class);
+  table_config.set_shard_num(10);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kFlatEmbDim + 3);
+  accessor_config->set_embedx_dim(kFlatEmbDim);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  accessor_config->mutable_ctr_accessor_param()->set_zero_init(true);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto *naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+}
+
+std::vector<float> PullValues(Table *table,
+                              const std::vector<uint64_t> &keys) {
+  std::vector<uint32_t> fres(keys.size(), 1);
+  std::vector<float> values(keys.size() * (kFlatEmbDim + 3));
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value = PullSparseValue(keys, fres, kFlatEmbDim);
+  context.pull_context.values = values.data();
+  EXPECT_EQ(table->Pull(context), 0);
+  return values;
+}
+
+// One key in four is shown often enough to be extended with its mf part.
+void PushGradients(Table *table, const std::vector<uint64_t> &keys, int round) {
+  std::vector<float> grads;
+  for (auto key : keys) {
+    grads.push_back(1);                                      // slot
+    grads.push_back((key / 7) % 4 == 0 ? 30 : 1);            // show
+    grads.push_back(static_cast<float>((key + round) % 2));  // click
+    grads.push_back(0.01f * ((key + round) % 13));           // embed g
+    for (int i = 0; i < kFlatEmbDim; ++i) {
+      grads.push_back(0.01f * ((key * 3 + i + round) % 11) - 0.05f);
+    }
+  }
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  ASSERT_EQ(table->Push(context), 0);
+}
+
+}  // namespace
+
+TEST(MemoryFlatSparseTable, PullPushSaveLoad) {
+  std::unique_ptr<Table> table(new MemoryFlatSparseTable());
+  InitFlatTestTable(table.get(), "MemoryFlatSparseTable");
+  std::unique_ptr<Table> reference(new MemorySparseTable());
+  InitFlatTestTable(reference.get(), "MemorySparseTable");
+
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 4000; ++key) {
+    keys.push_back(key * 7);
+  }
+  for (int round = 0; round < 3; ++round) {
+    ASSERT_EQ(PullValues(table.get(), keys),
+              PullValues(reference.get(), keys));
+    PushGradients(table.get(), keys, round);
+    PushGradients(reference.get(), keys, round);
+  }
+  std::vector<float> values = PullValues(table.get(), keys);
+  ASSERT_EQ(values, PullValues(reference.get(), keys));
+
+  auto *flat_table = dynamic_cast<MemoryFlatSparseTable *>(table.get());
+  auto *reference_table = dynamic_cast<MemorySparseTable *>(reference.get());
+  EXPECT_EQ(flat_table->LocalSize(), static_cast<int64_t>(keys.size()));
+  EXPECT_EQ(flat_table->LocalMFSize(), reference_table->LocalMFSize());
+  EXPECT_GT(flat_table->LocalMFSize(), 0);
+  EXPECT_LT(flat_table->LocalMFSize(), flat_table->LocalSize());
+
+  // A loaded value keeps its mf part only if it was saved with it.
+  for (bool binary : {false, true}) {
+    const std::string path =
+        binary ? "flat_sparse_table_binary" : "flat_sparse_table_text";
+    FLAGS_pserver_sparse_table_binary_checkpoint = binary;
+    ASSERT_EQ(table->Save(path, "0"), 0);
+    FLAGS_pserver_sparse_table_binary_checkpoint = false;
+    values = PullValues(table.get(), keys);
+
+    std::unique_ptr<Table> loaded(new MemoryFlatSparseTable());
+    InitFlatTestTable(loaded.get(), "MemoryFlatSparseTable");
+    ASSERT_EQ(loaded->Load(path, "0"), 0);
+    auto *loaded_table = dynamic_cast<MemoryFlatSparseTable *>(loaded.get());
+    EXPECT_EQ(loaded_table->LocalSize(), flat_table->LocalSize()) << path;
+    EXPECT_EQ(loaded_table->LocalMFSize(), flat_table->LocalMFSize())
+        << path;
+    EXPECT_EQ(PullValues(loaded.get(), keys), values) << path;
+
+    // the loaded values are updated as the saved ones
+    PushGradients(loaded.get(), keys, 3);
+    PushGradients(reference.get(), keys, 3);
+    EXPECT_EQ(PullValues(loaded.get(), keys),
+              PullValues(reference.get(), keys))
+        << path;
+    PushGradients(table.get(), keys, 3);
+  }
+}
+
 }  // namespace distributed
 }  // namespace paddle
@@ -0,0 +1,163 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Compares the text checkpoint of MemorySparseTable with the binary one:
+// the time of Save and Load, and the pushes served while the binary
+// checkpoint is saved. Run with --checkpoint_benchmark_keys=100000000 for
+// the 100M keys scale.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+PD_DEFINE_int64(checkpoint_benchmark_keys, 2000000, "keys of the table");
+PD_DECLARE_bool(pserver_sparse_table_binary_checkpoint);
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+constexpr size_t kBatch = 10000;
+
+std::unique_ptr<Table> CreateTable() {
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(16);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter* accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbDim + 3);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  table->Initialize(table_config, fs_config);
+  return table;
+}
+
+void Push(Table* table, const std::vector<uint64_t>& keys) {
+  // slot, show, click, embed_g and embedx_g of every key.
+  std::vector<float> grads(keys.size() * (kEmbDim + 4), 0.01f);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    grads[i * (kEmbDim + 4) + 1] = 1.0f;
+  }
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  table->Push(context);
+}
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+template <typename Fn>
+double Time(Fn&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  return ElapsedSeconds(start);
+}
+
+}  // namespace
+
+TEST(SparseCheckpointBenchmark, TextVersusBinary) {
+  const uint64_t num = FLAGS_checkpoint_benchmark_keys;
+  auto table = CreateTable();
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < num; ++key) {
+    keys.push_back(key);
+    if (keys.size() == kBatch || key + 1 == num) {
+      Push(table.get(), keys);
+      keys.clear();
+    }
+  }
+
+  FLAGS_pserver_sparse_table_binary_checkpoint = false;
+  double text_save = Time([&] { table->Save("checkpoint_text", "0"); });
+
+  // Keeps pushing existing keys while the binary checkpoint is saved.
+  std::atomic<bool> saving{true};
+  uint64_t pushed = 0;
+  double max_push_ms = 0;
+  std::thread pusher([&]() {
+    std::mt19937_64 rng(0);
+    std::vector<uint64_t> batch(kBatch);
+    while (saving) {
+      for (auto& key : batch) {
+        key = rng() % num;
+      }
+      auto start = std::chrono::steady_clock::now();
+      Push(table.get(), batch);
+      max_push_ms = std::max(max_push_ms, ElapsedSeconds(start) * 1000);
+      pushed += batch.size();
+    }
+  });
+  FLAGS_pserver_sparse_table_binary_checkpoint = true;
+  double binary_save = Time([&] { table->Save("checkpoint_binary", "0"); });
+  saving = false;
+  pusher.join();
+  FLAGS_pserver_sparse_table_binary_checkpoint = false;
+
+  auto text_table = CreateTable();
+  double text_load = Time([&] { text_table->Load("checkpoint_text", "0"); });
+  auto binary_table = CreateTable();
+  double binary_load =
+      Time([&] { binary_table->Load("checkpoint_binary", "0"); });
+
+  LOG(INFO) << num << " keys: text save " << text_save << " s, load "
+            << text_load << " s; binary save " << binary_save << " s, load "
+            << binary_load << " s, " << pushed
+            << " keys pushed during the binary save, max push latency "
+            << max_push_ms << " ms";
+  EXPECT_EQ(dynamic_cast<MemorySparseTable*>(binary_table.get())->LocalSize(),
+            static_cast<int64_t>(num));
+  EXPECT_EQ(dynamic_cast<MemorySparseTable*>(text_table.get())->LocalSize(),
+            static_cast<int64_t>(num));
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,179 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/sparse_checkpoint.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+PD_DECLARE_bool(pserver_sparse_table_binary_checkpoint);
+PD_DECLARE_int32(pserver_sparse_checkpoint_block_kb);
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+void WriteCheckpoint(const std::string& path, uint64_t num, size_t per_block) {
+  AfsClient client;
+  FsChannelConfig config = {};
+  config.path = path;
+  int err_no = 0;
+  SparseCheckpointWriter writer(client.open_w(config, 0, &err_no), 2);
+  SparseCheckpointBlock block;
+  for (uint64_t key = 0; key < num; ++key) {
+    std::vector<float> value(key % 5 + 1, static_cast<float>(key) * 0.5f);
+    block.Add(key * 7, value.data(), value.size());
+    if (block.RecordNum() == per_block) {
+      writer.Append(std::move(block));
+      block = SparseCheckpointBlock();
+    }
+  }
+  writer.Append(std::move(block));
+  ASSERT_EQ(writer.Finish(), 0);
+}
+
+uint64_t ReadCheckpoint(const std::string& path) {
+  AfsClient client;
+  FsChannelConfig config = {};
+  config.path = path;
+  int err_no = 0;
+  auto channel = client.open_r(config, 0, &err_no);
+  uint64_t expect_key = 0;
+  return ReadSparseCheckpoint(
+      channel.get(), path, [&](uint64_t key, const float* value, uint32_t dim) {
+        EXPECT_EQ(key, expect_key * 7);
+        EXPECT_EQ(dim, expect_key % 5 + 1);
+        for (uint32_t i = 0; i < dim; ++i) {
+          EXPECT_EQ(value[i], static_cast<float>(expect_key) * 0.5f);
+        }
+        ++expect_key;
+      });
+}
+
+void RewriteFile(const std::string& path, bool truncate, size_t flip_pos) {
+  std::ifstream fin(path, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  if (truncate) {
+    content.resize(content.size() - sizeof(uint64_t) - 16);
+  } else {
+    content[flip_pos] ^= 0x5a;
+  }
+  std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+  fout.write(content.data(), content.size());
+}
+
+void InitTable(Table* table) {
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(10);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter* accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(11);
+  accessor_config->set_embedx_dim(8);
+  accessor_config->set_embedx_threshold(5);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+  ASSERT_EQ(table->Initialize(table_config, fs_config), 0);
+}
+
+std::vector<float> PullAll(Table* table, const std::vector<uint64_t>& keys) {
+  const int emb_dim = 8;
+  std::vector<uint32_t> fres(keys.size(), 1);
+  std::vector<float> values(keys.size() * (emb_dim + 3));
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.pull_value = PullSparseValue(keys, fres, emb_dim);
+  context.pull_context.values = values.data();
+  table->Pull(context);
+  return values;
+}
+
+}  // namespace
+
+TEST(SparseCheckpoint, WriteAndRead) {
+  const std::string path = "sparse_checkpoint_test.bin";
+  WriteCheckpoint(path, 10000, 333);
+  EXPECT_EQ(ReadCheckpoint(path), 10000UL);
+
+  WriteCheckpoint(path, 0, 1);
+  EXPECT_EQ(ReadCheckpoint(path), 0UL);
+}
+
+TEST(SparseCheckpoint, DamagedFile) {
+  const std::string path = "sparse_checkpoint_damaged.bin";
+  WriteCheckpoint(path, 1000, 100);
+  // A byte in the payload of the first block.
+  RewriteFile(path, false, sizeof(kSparseCheckpointMagic) + 16 + 10);
+  EXPECT_ANY_THROW(ReadCheckpoint(path));
+
+  WriteCheckpoint(path, 1000, 100);
+  RewriteFile(path, true, 0);
+  EXPECT_ANY_THROW(ReadCheckpoint(path));
+
+  WriteCheckpoint(path, 1000, 100);
+  RewriteFile(path, false, 0);
+  EXPECT_ANY_THROW(ReadCheckpoint(path));
+}
+
+TEST(SparseCheckpoint, MemorySparseTableSaveLoad) {
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  InitTable(table.get());
+  std::vector<uint64_t> keys;
+  for (uint64_t key = 0; key < 5000; ++key) {
+    keys.push_back(key * 13);
+  }
+  std::vector<float> values = PullAll(table.get(), keys);
+
+  FLAGS_pserver_sparse_table_binary_checkpoint = true;
+  FLAGS_pserver_sparse_checkpoint_block_kb = 4;
+  ASSERT_EQ(table->Save("sparse_checkpoint_table", "0"), 0);
+  FLAGS_pserver_sparse_table_binary_checkpoint = false;
+
+  std::unique_ptr<Table> loaded(new MemorySparseTable());
+  InitTable(loaded.get());
+  ASSERT_EQ(loaded->Load("sparse_checkpoint_table", "0"), 0);
+  auto* memory_table = dynamic_cast<MemorySparseTable*>(loaded.get());
+  EXPECT_EQ(memory_table->LocalSize(), static_cast<int64_t>(keys.size()));
+  EXPECT_EQ(PullAll(loaded.get(), keys), values);
+}
+
+}  // namespace distributed
+}  // namespace paddle
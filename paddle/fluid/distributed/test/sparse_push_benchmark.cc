@@ -0,0 +1,217 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Measures the sparse push of the pserver with small embeddings: the rows
+// the sgd rules update per second one by one and in batches, and the keys
+// MemorySparseTable::Push serves per second and per server core.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/sparse_sgd_rule.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+PD_DEFINE_int64(push_benchmark_keys, 1000000, "keys of the table");
+PD_DEFINE_int32(push_benchmark_rounds, 10, "pushes of every key");
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+constexpr size_t kBatch = 10000;
+constexpr int kShardNum = 16;
+
+double ElapsedSeconds(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+void SetSGDParam(const std::string& name,
+                 SparseCommonSGDRuleParameter* param) {
+  param->set_name(name);
+  if (name == "SparseNaiveSGDRule") {
+    auto* naive_param = param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  } else if (name == "SparseAdamSGDRule") {
+    auto* adam_param = param->mutable_adam();
+    adam_param->set_learning_rate(0.1);
+    adam_param->set_initial_range(0.3);
+    adam_param->set_beta1_decay_rate(0.9);
+    adam_param->set_beta2_decay_rate(0.999);
+    adam_param->set_ada_epsilon(1e-08);
+    adam_param->add_weight_bounds(-10.0);
+    adam_param->add_weight_bounds(10.0);
+  } else {
+    auto* adagrad_param = param->mutable_adagrad();
+    adagrad_param->set_learning_rate(0.1);
+    adagrad_param->set_initial_g2sum(3);
+    adagrad_param->set_initial_range(0.3);
+    adagrad_param->add_weight_bounds(-10.0);
+    adagrad_param->add_weight_bounds(10.0);
+  }
+}
+
+std::unique_ptr<Table> CreateTable(const std::string& sgd_rule) {
+  std::unique_ptr<Table> table(new MemorySparseTable());
+  TableParameter table_config;
+  table_config.set_table_class("MemorySparseTable");
+  table_config.set_shard_num(kShardNum);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter* accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbDim + 3);
+  accessor_config->set_embedx_dim(kEmbDim);
+  // The embedx is created on the first push, later pushes update in place.
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  SetSGDParam(sgd_rule, accessor_config->mutable_embed_sgd_param());
+  SetSGDParam(sgd_rule, accessor_config->mutable_embedx_sgd_param());
+  table->Initialize(table_config, fs_config);
+  return table;
+}
+
+void Push(Table* table,
+          const std::vector<uint64_t>& keys,
+          const std::vector<float>& grads) {
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  table->Push(context);
+}
+
+void BenchmarkRule(const std::string& name,
+                   std::unique_ptr<SparseValueSGDRule> rule) {
+  SparseCommonSGDRuleParameter param;
+  SetSGDParam(name, &param);
+  rule->LoadConfig(param, kEmbDim);
+  // Rows scattered over a table much larger than the caches.
+  const size_t row_num = 1 << 20;
+  const size_t value_dim = kEmbDim + rule->Dim();
+  std::vector<float> values(row_num * value_dim);
+  for (size_t i = 0; i < row_num; ++i) {
+    rule->InitValue(&values[i * value_dim], &values[i * value_dim + kEmbDim]);
+  }
+  std::vector<float> grads(kBatch * kEmbDim, 0.01f);
+  std::vector<float> scale(kBatch, 1.0f);
+  std::vector<float*> w(kBatch), sgd(kBatch);
+  std::vector<const float*> push_value(kBatch);
+  std::mt19937_64 rng(0);
+  for (size_t i = 0; i < kBatch; ++i) {
+    size_t row = rng() % row_num;
+    w[i] = &values[row * value_dim];
+    sgd[i] = &values[row * value_dim + kEmbDim];
+    push_value[i] = &grads[i * kEmbDim];
+  }
+
+  const int rounds = 100;
+  auto start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (size_t i = 0; i < kBatch; ++i) {
+      rule->UpdateValue(w[i], sgd[i], push_value[i], scale[i]);
+    }
+  }
+  double row_seconds = ElapsedSeconds(start);
+  start = std::chrono::steady_clock::now();
+  for (int r = 0; r < rounds; ++r) {
+    for (size_t i = 0; i < kBatch; i += 64) {
+      size_t num = std::min<size_t>(64, kBatch - i);
+      rule->UpdateValueBatch(&w[i], &sgd[i], &push_value[i], &scale[i], num);
+    }
+  }
+  double batch_seconds = ElapsedSeconds(start);
+  LOG(INFO) << name << ": UpdateValue " << kBatch * rounds / row_seconds
+            << " rows/s, UpdateValueBatch "
+            << kBatch * rounds / batch_seconds << " rows/s";
+}
+
+}  // namespace
+
+TEST(SparsePushBenchmark, SGDRule) {
+  BenchmarkRule("SparseNaiveSGDRule", std::make_unique<SparseNaiveSGDRule>());
+  BenchmarkRule("SparseAdaGradSGDRule",
+                std::make_unique<SparseAdaGradSGDRule>());
+  BenchmarkRule("StdAdaGradSGDRule", std::make_unique<StdAdaGradSGDRule>());
+  BenchmarkRule("SparseAdamSGDRule", std::make_unique<SparseAdamSGDRule>());
+}
+
+TEST(SparsePushBenchmark, PushPerCore) {
+  const uint64_t num = FLAGS_push_benchmark_keys;
+  // The shards are pushed by one thread each.
+  const int cores = std::max(
+      1,
+      std::min(kShardNum,
+               static_cast<int>(std::thread::hardware_concurrency())));
+  for (const std::string& sgd_rule :
+       {"SparseNaiveSGDRule", "SparseAdaGradSGDRule", "SparseAdamSGDRule"}) {
+    auto table = CreateTable(sgd_rule);
+    // slot, show, click, embed_g and embedx_g of every key.
+    std::vector<float> grads(kBatch * (kEmbDim + 4), 0.01f);
+    for (size_t i = 0; i < kBatch; ++i) {
+      grads[i * (kEmbDim + 4) + 1] = 1.0f;
+    }
+    std::vector<uint64_t> keys(kBatch);
+    for (uint64_t begin = 0; begin < num; begin += kBatch) {
+      keys.resize(std::min<uint64_t>(kBatch, num - begin));
+      for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = begin + i;
+      }
+      Push(table.get(), keys, grads);
+    }
+
+    std::mt19937_64 rng(0);
+    keys.resize(kBatch);
+    uint64_t pushed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t round = 0; round < num * FLAGS_push_benchmark_rounds;
+         round += kBatch) {
+      for (auto& key : keys) {
+        key = rng() % num;
+      }
+      Push(table.get(), keys, grads);
+      pushed += keys.size();
+    }
+    double keys_per_second = pushed / ElapsedSeconds(start);
+    LOG(INFO) << sgd_rule << ": " << keys_per_second << " keys/s, "
+              << keys_per_second / cores << " keys/s per core";
+    EXPECT_EQ(dynamic_cast<MemorySparseTable*>(table.get())->LocalSize(),
+              static_cast<int64_t>(num));
+  }
+}
+
+}  // namespace paddle::distributed
@@ -16,6 +16,8 @@ limitations under the License. */
 
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/distributed/the_one_ps.pb.h"
@@ -205,5 +207,91 @@ TEST(downpour_sparse_adam_test, test_init_and_update) {
     ASSERT_FLOAT_EQ(value[i], label[i]) << "i is " << i;
   }
 }
+
+// Updates the same rows one by one and in a batch that pushes the first row
+// twice, the results of the two are expected to be the same.
+void CheckUpdateValueBatch(SparseValueSGDRule* rule, size_t embed_dim) {
+  const size_t row_num = 7;
+  const size_t value_dim = embed_dim + rule->Dim();
+  std::vector<float> row_values(row_num * value_dim);
+  std::vector<float> grads(row_num * embed_dim);
+  for (size_t i = 0; i < row_num; ++i) {
+    rule->InitValue(&row_values[i * value_dim],
+                    &row_values[i * value_dim + embed_dim],
+                    false);
+  }
+  for (size_t i = 0; i < grads.size(); ++i) {
+    grads[i] = std::sin(static_cast<float>(i)) * 0.5;
+  }
+  std::vector<float> batch_values = row_values;
+
+  std::vector<size_t> order = {0, 1, 2, 3, 4, 5, 6, 0};
+  std::vector<float*> w, sgd;
+  std::vector<const float*> push_value;
+  std::vector<float> scale;
+  for (size_t i : order) {
+    rule->UpdateValue(&row_values[i * value_dim],
+                      &row_values[i * value_dim + embed_dim],
+                      &grads[i * embed_dim],
+                      1.0f + i);
+    w.push_back(&batch_values[i * value_dim]);
+    sgd.push_back(&batch_values[i * value_dim + embed_dim]);
+    push_value.push_back(&grads[i * embed_dim]);
+    scale.push_back(1.0f + i);
+  }
+  rule->UpdateValueBatch(
+      w.data(), sgd.data(), push_value.data(), scale.data(), order.size());
+
+  for (size_t i = 0; i < row_values.size(); ++i) {
+    ASSERT_NEAR(batch_values[i], row_values[i], 1e-5) << "i is " << i;
+  }
+}
+
+TEST(sparse_sgd_rule_test, update_value_batch) {
+  for (size_t embed_dim : {1, 8, 13, 16}) {
+    SparseCommonSGDRuleParameter naive_param;
+    auto* naive = naive_param.mutable_naive();
+    naive->set_learning_rate(0.1);
+    naive->set_initial_range(0.3);
+    naive->add_weight_bounds(-0.2);
+    naive->add_weight_bounds(0.2);
+    SparseNaiveSGDRule naive_rule;
+    naive_rule.LoadConfig(naive_param, embed_dim);
+    CheckUpdateValueBatch(&naive_rule, embed_dim);
+
+    SparseCommonSGDRuleParameter adagrad_param;
+    auto* adagrad = adagrad_param.mutable_adagrad();
+    adagrad->set_learning_rate(0.1);
+    adagrad->set_initial_g2sum(3);
+    adagrad->set_initial_range(0.3);
+    adagrad->add_weight_bounds(-10.0);
+    adagrad->add_weight_bounds(10.0);
+    std::vector<std::unique_ptr<SparseValueSGDRule>> adagrad_rules;
+    adagrad_rules.emplace_back(new SparseAdaGradSGDRule());
+    adagrad_rules.emplace_back(new SparseAdaGradV2SGDRule());
+    adagrad_rules.emplace_back(new StdAdaGradSGDRule());
+    for (auto& rule : adagrad_rules) {
+      rule->LoadConfig(adagrad_param, embed_dim);
+      CheckUpdateValueBatch(rule.get(), embed_dim);
+    }
+
+    SparseCommonSGDRuleParameter adam_param;
+    auto* adam = adam_param.mutable_adam();
+    adam->set_learning_rate(0.1);
+    adam->set_initial_range(0.3);
+    adam->set_beta1_decay_rate(0.9);
+    adam->set_beta2_decay_rate(0.999);
+    adam->set_ada_epsilon(1e-08);
+    adam->add_weight_bounds(-10.0);
+    adam->add_weight_bounds(10.0);
+    std::vector<std::unique_ptr<SparseValueSGDRule>> adam_rules;
+    adam_rules.emplace_back(new SparseAdamSGDRule());
+    adam_rules.emplace_back(new SparseSharedAdamSGDRule());
+    for (auto& rule : adam_rules) {
+      rule->LoadConfig(adam_param, embed_dim);
+      CheckUpdateValueBatch(rule.get(), embed_dim);
+    }
+  }
+}
 }  // namespace distributed
 }  // namespace paddle
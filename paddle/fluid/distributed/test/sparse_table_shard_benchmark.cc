@@ -0,0 +1,143 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Compares SparseTableShard with FlatSparseTableShard the way
+// MemorySparseTable drives them: one thread per local shard inserts the keys
+// and then serves random pulls that copy the value out. Run with
+// --shard_benchmark_keys=100000000 for the 100M keys scale.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/depends/feature_value.h"
+#include "paddle/fluid/distributed/ps/table/depends/flat_feature_value.h"
+
+PD_DEFINE_int64(shard_benchmark_keys, 2000000, "total keys of the benchmark");
+PD_DEFINE_int32(shard_benchmark_threads, 16, "local shards, one per thread");
+
+namespace paddle::distributed {
+
+namespace {
+
+// CtrCommonAccessor with embedx_dim 8: 9 floats without mf, 17 with mf.
+constexpr size_t kValueSize = 9;
+constexpr size_t kValueDim = 17;
+
+size_t ResidentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+template <class ShardT>
+void RunShardBenchmark(const std::string& name) {
+  const int num_shards = FLAGS_shard_benchmark_threads;
+  const uint64_t keys_per_shard = FLAGS_shard_benchmark_keys / num_shards;
+  std::vector<std::unique_ptr<ShardT>> shards(num_shards);
+
+  auto run = [&](auto&& fn) {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_shards; ++i) {
+      threads.emplace_back(fn, i);
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() /
+           (keys_per_shard * num_shards);
+  };
+
+  size_t rss_before = ResidentBytes();
+  double insert_ns = run([&](int shard_id) {
+    shards[shard_id].reset(new ShardT());
+    auto& shard = *shards[shard_id];
+    shard.set_value_dim(kValueDim, kValueSize);
+    std::mt19937_64 rng(shard_id);
+    for (uint64_t i = 0; i < keys_per_shard; ++i) {
+      auto& value = shard[rng() * num_shards + shard_id];
+      value.resize(kValueSize);
+      value.data()[0] = 1.0f;
+    }
+  });
+  size_t rss_after = ResidentBytes();
+
+  // half of the pulls hit existing keys, in a different order
+  std::vector<std::vector<uint64_t>> pull_keys(num_shards);
+  for (int shard_id = 0; shard_id < num_shards; ++shard_id) {
+    std::mt19937_64 rng(shard_id);
+    auto& keys = pull_keys[shard_id];
+    keys.resize(keys_per_shard);
+    for (auto& key : keys) {
+      key = rng() * num_shards + shard_id;
+    }
+    std::shuffle(keys.begin(), keys.end(), rng);
+    for (size_t i = 1; i < keys.size(); i += 2) {
+      keys[i] = rng() * num_shards + shard_id;
+    }
+  }
+
+  std::vector<size_t> found(num_shards, 0);
+  double pull_ns = run([&](int shard_id) {
+    auto& shard = *shards[shard_id];
+    float buffer[kValueDim];  // NOLINT
+    size_t hit = 0;
+    for (uint64_t key : pull_keys[shard_id]) {
+      auto itr = shard.find(key);
+      if (itr != shard.end()) {
+        memcpy(buffer, itr.value().data(), itr.value().size() * sizeof(float));
+        hit += buffer[0] > 0.0f;
+      }
+    }
+    found[shard_id] = hit;
+  });
+
+  size_t total = 0;
+  for (auto& shard : shards) {
+    total += shard->size();
+  }
+  LOG(INFO) << name << ": " << total << " keys, insert " << insert_ns
+            << " ns/key, pull " << pull_ns << " ns/key, "
+            << (static_cast<double>(rss_after) - rss_before) / total
+            << " bytes/key";
+  EXPECT_GT(total, 0UL);
+  EXPECT_GT(found[0], 0UL);
+}
+
+}  // namespace
+
+TEST(SparseTableShardBenchmark, ClosedHashMap) {
+  RunShardBenchmark<SparseTableShard<uint64_t, FixedFeatureValue>>(
+      "SparseTableShard");
+}
+
+TEST(SparseTableShardBenchmark, FlatHashMap) {
+  RunShardBenchmark<FlatSparseTableShard<uint64_t>>("FlatSparseTableShard");
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,269 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/service/sparse_value_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/distributed/ps/service/env.h"
+#include "paddle/fluid/distributed/ps/service/ps_local_client.h"
+#include "paddle/fluid/distributed/ps/table/memory_sparse_table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+namespace paddle::distributed {
+
+constexpr size_t kDim = 12;
+constexpr size_t kHeaderDim = 3;
+
+std::vector<float> RandomRows(size_t num, std::mt19937* rng) {
+  std::normal_distribution<float> dist(0, 0.01);
+  std::vector<float> rows(num * kDim);
+  for (size_t i = 0; i < rows.size(); ++i) {
+    rows[i] = i % kDim < kHeaderDim ? static_cast<float>(i) : dist(*rng);
+  }
+  return rows;
+}
+
+TEST(SparseValueCodec, RowSize) {
+  EXPECT_EQ(SparseValueCodec(SparseValueCodecType::kFp32, kDim, kHeaderDim)
+                .RowSize(),
+            kDim * sizeof(float));
+  EXPECT_EQ(SparseValueCodec(SparseValueCodecType::kFp16, kDim, kHeaderDim)
+                .RowSize(),
+            kHeaderDim * sizeof(float) + (kDim - kHeaderDim) * 2);
+  EXPECT_EQ(SparseValueCodec(SparseValueCodecType::kInt8, kDim, kHeaderDim)
+                .RowSize(),
+            (kHeaderDim + 1) * sizeof(float) + kDim - kHeaderDim);
+  EXPECT_EQ(ParseSparseValueCodec("bf16"), SparseValueCodecType::kBf16);
+  EXPECT_ANY_THROW(ParseSparseValueCodec("fp8"));
+}
+
+TEST(SparseValueCodec, RoundTrip) {
+  std::mt19937 rng(0);
+  const size_t num = 64;
+  auto rows = RandomRows(num, &rng);
+  std::vector<const float*> row_ptrs(num);
+  for (size_t i = 0; i < num; ++i) {
+    row_ptrs[i] = rows.data() + i * kDim;
+  }
+  // The largest error of a column relative to the largest column of its row.
+  std::vector<std::pair<SparseValueCodecType, float>> bounds = {
+      {SparseValueCodecType::kFp32, 0},
+      {SparseValueCodecType::kFp16, 1e-3},
+      {SparseValueCodecType::kBf16, 8e-3},
+      {SparseValueCodecType::kInt8, 1.0 / 127}};
+  for (auto& bound : bounds) {
+    SparseValueCodec codec(bound.first, kDim, kHeaderDim);
+    std::string data;
+    codec.Encode(row_ptrs.data(), nullptr, num, nullptr, &data);
+    ASSERT_EQ(data.size(), num * codec.RowSize());
+    std::vector<float> decoded(num * kDim);
+    codec.Decode(data.data(), num, decoded.data());
+    for (size_t i = 0; i < num; ++i) {
+      float max_abs = 0;
+      for (size_t j = kHeaderDim; j < kDim; ++j) {
+        max_abs = std::max(max_abs, std::fabs(rows[i * kDim + j]));
+      }
+      for (size_t j = 0; j < kDim; ++j) {
+        float error = std::fabs(decoded[i * kDim + j] - rows[i * kDim + j]);
+        if (j < kHeaderDim) {
+          EXPECT_EQ(error, 0);
+        } else {
+          EXPECT_LE(error, bound.second * max_abs + 1e-8);
+        }
+      }
+    }
+  }
+}
+
+TEST(SparseValueCodec, PushKeys) {
+  std::mt19937 rng(0);
+  std::vector<uint64_t> keys = {
+      UINT64_MAX, 7, 0, 1ULL << 40, 7, 128, 127, UINT64_MAX - 1};
+  const size_t num = keys.size();
+  auto rows = RandomRows(num, &rng);
+  std::vector<const float*> row_ptrs(num);
+  for (size_t i = 0; i < num; ++i) {
+    row_ptrs[i] = rows.data() + i * kDim;
+  }
+  auto origin_keys = keys;
+  auto origin_rows = row_ptrs;
+
+  SparseValueCodec codec(SparseValueCodecType::kFp32, kDim, kHeaderDim);
+  std::string data;
+  EncodeSparsePush(codec, &keys, &row_ptrs, nullptr, &data);
+  std::vector<uint64_t> decoded_keys;
+  std::vector<float> decoded_values;
+  ASSERT_TRUE(DecodeSparsePush(codec,
+                               data.data(),
+                               data.size(),
+                               num,
+                               &decoded_keys,
+                               &decoded_values));
+  ASSERT_EQ(decoded_keys, keys);
+  ASSERT_TRUE(std::is_sorted(keys.begin(), keys.end()));
+  // Every row still goes with its key.
+  for (size_t i = 0; i < num; ++i) {
+    for (size_t j = 0; j < num; ++j) {
+      if (origin_rows[j] == row_ptrs[i]) {
+        EXPECT_EQ(origin_keys[j], keys[i]);
+      }
+    }
+    for (size_t j = 0; j < kDim; ++j) {
+      EXPECT_EQ(decoded_values[i * kDim + j], row_ptrs[i][j]);
+    }
+  }
+  EXPECT_FALSE(DecodeSparsePush(codec,
+                                data.data(),
+                                data.size() - 1,
+                                num,
+                                &decoded_keys,
+                                &decoded_values));
+}
+
+TEST(SparseValueCodec, ErrorFeedback) {
+  std::mt19937 rng(0);
+  const size_t steps = 200;
+  SparseValueCodec codec(SparseValueCodecType::kInt8, kDim, kHeaderDim);
+  SparseResidual residual;
+  std::vector<double> raw_sum(kDim, 0);
+  std::vector<double> decoded_sum(kDim, 0);
+  std::vector<float> decoded(kDim);
+  uint64_t key = 42;
+  for (size_t step = 0; step < steps; ++step) {
+    auto row = RandomRows(1, &rng);
+    // A column much smaller than the others of the row, which int8 alone
+    // would mostly round to zero.
+    row[kDim - 1] = 1e-5;
+    const float* row_ptr = row.data();
+    std::string data;
+    codec.Encode(&row_ptr, &key, 1, &residual, &data);
+    codec.Decode(data.data(), 1, decoded.data());
+    for (size_t j = kHeaderDim; j < kDim; ++j) {
+      raw_sum[j] += row[j];
+      decoded_sum[j] += decoded[j];
+    }
+  }
+  // The sum of the pushes only misses the last residual.
+  auto& error = residual.residuals[key];
+  for (size_t j = kHeaderDim; j < kDim; ++j) {
+    EXPECT_NEAR(decoded_sum[j] + error[j - kHeaderDim], raw_sum[j], 1e-4);
+    EXPECT_NEAR(decoded_sum[j], raw_sum[j], 1e-3);
+  }
+}
+
+TEST(SparseValueCodec, ResidualMaxKeys) {
+  std::mt19937 rng(0);
+  SparseValueCodec codec(SparseValueCodecType::kInt8, kDim, kHeaderDim);
+  SparseResidual residual;
+  residual.max_keys = 4;
+  auto row = RandomRows(1, &rng);
+  const float* row_ptr = row.data();
+  for (uint64_t key = 0; key < 10; ++key) {
+    std::string data;
+    codec.Encode(&row_ptr, &key, 1, &residual, &data);
+    EXPECT_LE(residual.residuals.size(), residual.max_keys);
+    EXPECT_EQ(residual.residuals.count(key), 1UL);
+  }
+}
+
+// Exposes the tables of the client.
+class LocalClientForTest : public PsLocalClient {
+ public:
+  using PsLocalClient::GetTable;
+};
+
+TEST(SparseValueCodec, PsLocalClientPush) {
+  const int emb_dim = 8;
+  PSParameter ps_param;
+  auto* table_param = ps_param.mutable_server_param()
+                          ->mutable_downpour_server_param()
+                          ->add_downpour_table_param();
+  table_param->set_table_id(0);
+  table_param->set_table_class("MemorySparseTable");
+  table_param->set_shard_num(1);
+  auto* accessor_config = table_param->mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(emb_dim + 3);
+  accessor_config->set_embedx_dim(emb_dim);
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    auto* naive_param = sgd_param->mutable_naive();
+    naive_param->set_learning_rate(0.1);
+    naive_param->set_initial_range(0.3);
+    naive_param->add_weight_bounds(-10.0);
+    naive_param->add_weight_bounds(10.0);
+  }
+
+  LocalClientForTest client;
+  PaddlePSEnvironment env;
+  std::map<uint64_t, std::vector<Region>> regions;
+  ASSERT_EQ(client.Configure(ps_param, regions, env, 0), 0);
+  Table* table = client.GetTable(0);
+  ASSERT_NE(table, nullptr);
+
+  std::vector<uint64_t> keys = {1, 2};
+  std::vector<uint32_t> fres = {1, 1};
+  auto pull = [&]() {
+    // show, click, embed_w, embedx_w of every key
+    std::vector<float> values(keys.size() * (emb_dim + 3));
+    auto pull_value = PullSparseValue(keys, fres, emb_dim);
+    TableContext table_context;
+    table_context.value_type = Sparse;
+    table_context.pull_context.pull_value = pull_value;
+    table_context.pull_context.values = values.data();
+    table->Pull(table_context);
+    return values;
+  };
+  auto init_values = pull();
+
+  // slot, show, click, embed_g, embedx_g. The scale of int8 follows embedx_g,
+  // so a single push mostly rounds embed_g to 0.
+  const float embed_g = 1e-4;
+  std::vector<float> grad = {0, 1, 0, embed_g};
+  grad.resize(emb_dim + 4, 0.1);
+  std::vector<const float*> grads(keys.size(), grad.data());
+  const int steps = 100;
+  FLAGS_pserver_sparse_push_codec = "int8";
+  for (int step = 0; step < steps; ++step) {
+    client.PushSparse(0, keys.data(), grads.data(), keys.size()).wait();
+  }
+  FLAGS_pserver_sparse_push_codec = "fp32";
+
+  auto values = pull();
+  for (size_t i = 0; i < keys.size(); ++i) {
+    size_t embed_w = i * (emb_dim + 3) + 2;
+    // Only the last residual is not applied, less than one step of int8.
+    EXPECT_NEAR(values[embed_w],
+                init_values[embed_w] - 0.1 * steps * embed_g,
+                0.1 * 0.1 / 127 * 1.1);
+  }
+}
+
+}  // namespace paddle::distributed
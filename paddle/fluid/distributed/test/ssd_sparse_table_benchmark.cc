@@ -0,0 +1,207 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+// Replays a Zipfian trace of pulls and pushes on SSDSparseTable, with all
+// the values in rocksdb at the start, and compares the pull latency and the
+// values kept in memory of the default table, which moves every pulled value
+// to memory, with a table whose memory is bounded by
+// FLAGS_pserver_ssd_tier_mem_capacity.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+PD_DEFINE_int64(ssd_benchmark_keys, 1000000, "keys of the table");
+PD_DEFINE_int64(ssd_benchmark_pulls, 20000000, "keys pulled by the trace");
+PD_DEFINE_double(ssd_benchmark_zipf, 1.0, "exponent of the key popularity");
+
+COMMON_DECLARE_string(rocksdb_path);
+PD_DECLARE_int64(pserver_ssd_tier_mem_capacity);
+
+namespace paddle::distributed {
+
+namespace {
+
+constexpr int kEmbDim = 8;
+constexpr size_t kBatch = 10000;
+constexpr int kShardNum = 16;
+
+std::unique_ptr<Table> CreateTable() {
+  std::unique_ptr<Table> table(new SSDSparseTable());
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(kShardNum);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter* accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbDim + 3);
+  accessor_config->set_embedx_dim(kEmbDim);
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  for (auto* sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseAdaGradSGDRule");
+    sgd_param->mutable_adagrad()->set_learning_rate(0.1);
+    sgd_param->mutable_adagrad()->set_initial_g2sum(3);
+    sgd_param->mutable_adagrad()->set_initial_range(0.3);
+    sgd_param->mutable_adagrad()->add_weight_bounds(-10.0);
+    sgd_param->mutable_adagrad()->add_weight_bounds(10.0);
+  }
+  table->Initialize(table_config, fs_config);
+  return table;
+}
+
+void Push(Table* table,
+          const std::vector<uint64_t>& keys,
+          const std::vector<float>& grads) {
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  table->Push(context);
+}
+
+void Pull(Table* table, std::vector<uint64_t>* keys, std::vector<float>* out) {
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.values = out->data();
+  context.pull_context.pull_value.feasigns_ = keys->data();
+  context.pull_context.pull_value.numel_ = keys->size();
+  context.num = keys->size();
+  table->Pull(context);
+}
+
+// Creates every key, then moves all the values to rocksdb, like a table
+// loaded from the ssd.
+void Prefill(Table* table, uint64_t num, const std::vector<float>& grads) {
+  std::vector<uint64_t> keys;
+  for (uint64_t begin = 0; begin < num; begin += kBatch) {
+    keys.resize(std::min<uint64_t>(kBatch, num - begin));
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = begin + i;
+    }
+    Push(table, keys, grads);
+  }
+  auto* db = RocksDBHandler::GetInstance();
+  for (int shard_id = 0; shard_id < kShardNum; ++shard_id) {
+    auto* shard =
+        static_cast<SSDSparseTable::shard_type*>(table->GetShard(shard_id));
+    for (auto it = shard->begin(); it != shard->end(); ++it) {
+      db->put(shard_id,
+              reinterpret_cast<const char*>(&it.key()),
+              sizeof(uint64_t),
+              reinterpret_cast<const char*>(it.value().data()),
+              it.value().size() * sizeof(float));
+    }
+  }
+  table->Clear();
+}
+
+// The keys of the trace, the rank r drawn with a probability in 1 / r^s.
+class ZipfGenerator {
+ public:
+  ZipfGenerator(uint64_t num, double s) : cdf_(num) {
+    double sum = 0;
+    for (uint64_t i = 0; i < num; ++i) {
+      sum += 1.0 / std::pow(i + 1, s);
+      cdf_[i] = sum;
+    }
+    for (auto& c : cdf_) {
+      c /= sum;
+    }
+  }
+
+  uint64_t operator()(std::mt19937_64* rng) {
+    double u = std::uniform_real_distribution<double>(0, 1)(*rng);
+    uint64_t rank =
+        std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    // Spreads the popular ranks over the shards.
+    return (rank * 0x9e3779b97f4a7c15ULL) % cdf_.size();
+  }
+
+ private:
+  std::vector<double> cdf_;
+};
+
+void Replay(const std::string& name, int64_t mem_capacity) {
+  FLAGS_rocksdb_path = "/tmp/ssd_sparse_table_benchmark_" + name;
+  FLAGS_pserver_ssd_tier_mem_capacity = mem_capacity;
+  const uint64_t num = FLAGS_ssd_benchmark_keys;
+  auto table = CreateTable();
+  // slot, show, click, embed_g and embedx_g of every key.
+  std::vector<float> grads(kBatch * (kEmbDim + 4), 0.01f);
+  Prefill(table.get(), num, grads);
+
+  size_t select_dim =
+      table->GetValueAccessor()->GetAccessorInfo().select_size /
+      sizeof(float);
+  std::vector<float> out(kBatch * select_dim);
+  std::vector<uint64_t> keys(kBatch);
+  ZipfGenerator zipf(num, FLAGS_ssd_benchmark_zipf);
+  std::mt19937_64 rng(0);
+  double pull_seconds = 0;
+  int64_t batches = 0;
+  for (int64_t pulled = 0; pulled < FLAGS_ssd_benchmark_pulls;
+       pulled += kBatch) {
+    for (auto& key : keys) {
+      key = zipf(&rng);
+    }
+    auto start = std::chrono::steady_clock::now();
+    Pull(table.get(), &keys, &out);
+    pull_seconds += std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+    Push(table.get(), keys, grads);
+    ++batches;
+  }
+  auto* ssd_table = dynamic_cast<SSDSparseTable*>(table.get());
+  // Logs the hit rates of the tiers.
+  ssd_table->PrintTableStat();
+  LOG(INFO) << name << ": " << pull_seconds / batches * 1000
+            << " ms per pull of " << kBatch << " keys, "
+            << ssd_table->LocalSize() << " of " << num
+            << " values in memory";
+  if (mem_capacity > 0) {
+    EXPECT_LE(ssd_table->LocalSize(), mem_capacity + 2 * kBatch);
+  }
+}
+
+}  // namespace
+
+TEST(SSDSparseTableBenchmark, ZipfianPull) {
+  Replay("promote_all", 0);
+  Replay("tiered", FLAGS_ssd_benchmark_keys / 10);
+}
+
+}  // namespace paddle::distributed
@@ -0,0 +1,228 @@
+/* Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/distributed/ps/table/ssd_sparse_table.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/distributed/ps/table/ctr_accessor.h"
+#include "paddle/fluid/distributed/ps/table/table.h"
+#include "paddle/fluid/distributed/the_one_ps.pb.h"
+
+COMMON_DECLARE_string(rocksdb_path);
+PD_DECLARE_int64(pserver_ssd_tier_mem_capacity);
+PD_DECLARE_int32(pserver_ssd_tier_admit_freq);
+
+namespace paddle {
+namespace distributed {
+
+namespace {
+
+constexpr int kEmbxDim = 8;
+constexpr int kShardNum = 4;
+constexpr int kMemCapacity = 40;
+constexpr uint64_t kKeyNum = 400;
+constexpr float kLearningRate = 0.5f;
+
+// The values are created with zeros and updated by a naive sgd, so the pulled
+// values can be computed aside.
+std::unique_ptr<Table> CreateTable() {
+  std::unique_ptr<Table> table(new SSDSparseTable());
+  TableParameter table_config;
+  table_config.set_table_class("SSDSparseTable");
+  table_config.set_shard_num(kShardNum);
+  FsClientParameter fs_config;
+  table->SetShard(0, 1);
+
+  TableAccessorParameter *accessor_config = table_config.mutable_accessor();
+  accessor_config->set_accessor_class("CtrCommonAccessor");
+  accessor_config->set_fea_dim(kEmbxDim + 3);
+  accessor_config->set_embedx_dim(kEmbxDim);
+  // every push extends the embedx of a value
+  accessor_config->set_embedx_threshold(0);
+  accessor_config->mutable_ctr_accessor_param()->set_nonclk_coeff(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_click_coeff(1);
+  accessor_config->mutable_ctr_accessor_param()->set_base_threshold(0.5);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_threshold(0.2);
+  accessor_config->mutable_ctr_accessor_param()->set_delta_keep_days(16);
+  accessor_config->mutable_ctr_accessor_param()->set_show_click_decay_rate(
+      0.99);
+  accessor_config->mutable_ctr_accessor_param()->set_zero_init(true);
+  for (auto *sgd_param : {accessor_config->mutable_embed_sgd_param(),
+                          accessor_config->mutable_embedx_sgd_param()}) {
+    sgd_param->set_name("SparseNaiveSGDRule");
+    sgd_param->mutable_naive()->set_learning_rate(kLearningRate);
+    sgd_param->mutable_naive()->set_initial_range(0);
+    sgd_param->mutable_naive()->add_weight_bounds(-1000.0);
+    sgd_param->mutable_naive()->add_weight_bounds(1000.0);
+  }
+  EXPECT_EQ(table->Initialize(table_config, fs_config), 0);
+  return table;
+}
+
+// The pulled value of a key, with whether its embedx is extended.
+struct RefValue {
+  bool has_mf = false;
+  std::vector<float> pull =
+      std::vector<float>(CtrCommonPullValue::Dim(kEmbxDim));
+};
+
+class Reference {
+ public:
+  void Push(uint64_t key, const float *grad) {
+    auto &value = values_[key];
+    value.pull[CtrCommonPullValue::ShowIndex()] +=
+        grad[CtrCommonPushValue::ShowIndex()];
+    value.pull[CtrCommonPullValue::ClickIndex()] +=
+        grad[CtrCommonPushValue::ClickIndex()];
+    value.pull[CtrCommonPullValue::EmbedWIndex()] -=
+        kLearningRate * grad[CtrCommonPushValue::EmbedGIndex()];
+    // the push that extends the embedx of a value creates it, its gradient
+    // is dropped
+    if (value.has_mf) {
+      for (int i = 0; i < kEmbxDim; ++i) {
+        value.pull[CtrCommonPullValue::EmbedxWIndex() + i] -=
+            kLearningRate * grad[CtrCommonPushValue::EmbedxGIndex() + i];
+      }
+    }
+    value.has_mf = true;
+  }
+
+  std::vector<float> Pull(uint64_t key) const {
+    auto it = values_.find(key);
+    return it == values_.end() ? RefValue().pull : it->second.pull;
+  }
+
+ private:
+  std::map<uint64_t, RefValue> values_;
+};
+
+std::vector<float> Gradient(uint64_t key, int round) {
+  std::vector<float> grad(CtrCommonPushValue::Dim(kEmbxDim));
+  grad[CtrCommonPushValue::SlotIndex()] = 1;
+  grad[CtrCommonPushValue::ShowIndex()] = 1;
+  grad[CtrCommonPushValue::ClickIndex()] = (key + round) % 2;
+  grad[CtrCommonPushValue::EmbedGIndex()] = 0.25f * ((key + round) % 5);
+  for (int i = 0; i < kEmbxDim; ++i) {
+    grad[CtrCommonPushValue::EmbedxGIndex() + i] =
+        0.125f * ((key * 3 + i + round) % 7) - 0.375f;
+  }
+  return grad;
+}
+
+void Push(Table *table,
+          const std::vector<uint64_t> &keys,
+          int round,
+          Reference *reference) {
+  std::vector<float> grads;
+  for (auto key : keys) {
+    auto grad = Gradient(key, round);
+    grads.insert(grads.end(), grad.begin(), grad.end());
+    reference->Push(key, grad.data());
+  }
+  TableContext context;
+  context.value_type = Sparse;
+  context.push_context.keys = keys.data();
+  context.push_context.values = grads.data();
+  context.num = keys.size();
+  ASSERT_EQ(table->Push(context), 0);
+}
+
+void PullAndCheck(Table *table,
+                  std::vector<uint64_t> keys,
+                  const Reference &reference) {
+  const int dim = CtrCommonPullValue::Dim(kEmbxDim);
+  std::vector<float> values(keys.size() * dim);
+  TableContext context;
+  context.value_type = Sparse;
+  context.pull_context.values = values.data();
+  context.pull_context.pull_value.feasigns_ = keys.data();
+  context.pull_context.pull_value.numel_ = keys.size();
+  context.num = keys.size();
+  ASSERT_EQ(table->Pull(context), 0);
+  for (size_t i = 0; i < keys.size(); ++i) {
+    auto expected = reference.Pull(keys[i]);
+    for (int j = 0; j < dim; ++j) {
+      ASSERT_NEAR(values[i * dim + j], expected[j], 1e-4)
+          << "key " << keys[i] << " at " << j;
+    }
+  }
+}
+
+std::vector<uint64_t> KeyRange(uint64_t begin, uint64_t end) {
+  std::vector<uint64_t> keys;
+  for (uint64_t key = begin; key < end; ++key) {
+    keys.push_back(key);
+  }
+  return keys;
+}
+
+}  // namespace
+
+TEST(SSDSparseTable, TieredPullPushPastCapacity) {
+  char dir[] = "/tmp/ssd_sparse_table_test_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  FLAGS_rocksdb_path = dir;
+  FLAGS_pserver_ssd_tier_mem_capacity = kMemCapacity;
+  FLAGS_pserver_ssd_tier_admit_freq = 2;
+  auto table = CreateTable();
+  auto *ssd_table = dynamic_cast<SSDSparseTable *>(table.get());
+  ASSERT_NE(ssd_table, nullptr);
+  ASSERT_EQ(ssd_table->_shard_mem_capacity,
+            static_cast<size_t>(kMemCapacity / kShardNum));
+
+  Reference reference;
+  // The hot keys are pulled every round and admitted to memory, the others
+  // are created, demoted and then read and updated in rocksdb.
+  const std::vector<uint64_t> hot_keys = KeyRange(0, 16);
+  for (int round = 0; round < 6; ++round) {
+    PullAndCheck(table.get(), hot_keys, reference);
+    Push(table.get(), hot_keys, round, &reference);
+    for (uint64_t begin = 16; begin < kKeyNum; begin += 96) {
+      auto keys = KeyRange(begin, std::min(begin + 96, kKeyNum));
+      PullAndCheck(table.get(), keys, reference);
+      Push(table.get(), keys, round, &reference);
+    }
+  }
+
+  // A pull or push queues a demotion of its shard once the shard is over
+  // capacity, it runs after the pull or push.
+  ssd_table->WaitDemotion();
+  EXPECT_LE(ssd_table->LocalSize(), kMemCapacity);
+  // A demotion leaves a tenth of the capacity free.
+  for (int shard_id = 0; shard_id < kShardNum; ++shard_id) {
+    ssd_table->DemoteShard(shard_id);
+  }
+  EXPECT_LE(ssd_table->LocalSize(), kMemCapacity - kMemCapacity / 10);
+  EXPECT_GT(ssd_table->LocalSize(), 0);
+
+  // The values demoted to rocksdb are read back unchanged, the ones still
+  // in memory too.
+  PullAndCheck(table.get(), KeyRange(0, kKeyNum), reference);
+  Push(table.get(), KeyRange(0, kKeyNum), 6, &reference);
+  ssd_table->WaitDemotion();
+  PullAndCheck(table.get(), KeyRange(0, kKeyNum), reference);
+  // Keys never pushed are zeros.
+  PullAndCheck(table.get(), KeyRange(kKeyNum, kKeyNum + 8), reference);
+}
+
+}  // namespace distributed
+}  // namespace paddle
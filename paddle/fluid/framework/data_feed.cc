@@ -19,7 +19,12 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/data_feed.h"
 
+#include <atomic>
+#include <limits>
+
+#include "paddle/fluid/framework/data_feed_cache.h"
 #include "paddle/fluid/framework/fleet/ps_gpu_wrapper.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
 #ifdef _LINUX
 #include <stdio_ext.h>
 #include <sys/mman.h>
@@ -547,13 +552,35 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
   while (this->PickOneFile(&filename)) {
     VLOG(3) << "PickOneFile, filename=" << filename
             << ", thread_id=" << thread_id_;
+    platform::Timer timeline;
+    timeline.Start();
+    std::string cache_key = CacheKey(filename);
+    if (!cache_key.empty() &&
+        data_feed_cache::LoadCache<T>(cache_key, [this](std::vector<T>* ins) {
+          for (auto& r : *ins) {
+            fea_num_ += data_feed_cache::FeasignNum(r);
+          }
+          input_channel_->Write(std::move(*ins));
+        })) {
+      STAT_ADD(STAT_total_feasign_num_in_mem, fea_num_);
+      {
+        std::lock_guard<std::mutex> flock(*mutex_for_fea_num_);
+        *total_fea_num_ += fea_num_;
+        fea_num_ = 0;
+      }
+      timeline.Pause();
+      VLOG(3) << "LoadIntoMemory() read dataset cache, file=" << filename
+              << ", cost time=" << timeline.ElapsedSec()
+              << " seconds, thread_id=" << thread_id_;
+      continue;
+    }
+    int err_no = 0;
 #ifdef PADDLE_WITH_BOX_PS
     if (BoxWrapper::GetInstance()->UseAfsApi()) {
       this->fp_ = BoxWrapper::GetInstance()->afs_manager->GetFile(
           filename, this->pipe_command_);
     } else {
 #endif
-      int err_no = 0;
       this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
 #ifdef PADDLE_WITH_BOX_PS
     }
@@ -561,13 +588,26 @@ void InMemoryDataFeed<T>::LoadIntoMemory() {
     CHECK(this->fp_ != nullptr);
     __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
     paddle::framework::ChannelWriter<T> writer(input_channel_);
+    std::unique_ptr<data_feed_cache::CacheWriter<T>> cache_writer;
+    if (!cache_key.empty()) {
+      cache_writer = std::make_unique<data_feed_cache::CacheWriter<T>>(
+          cache_key);
+    }
     T instance;
-    platform::Timer timeline;
-    timeline.Start();
     while (ParseOneInstanceFromPipe(&instance)) {
+      if (cache_writer != nullptr) {
+        cache_writer->Append(instance);
+      }
       writer << std::move(instance);
       instance = T();
     }
+    // Closing the pipe sets err_no. A pipe that failed may have stopped
+    // early, so its instances are not cached.
+    this->fp_ = nullptr;
+    if (cache_writer != nullptr && err_no == 0) {
+      cache_writer->Finish();
+    }
+    cache_writer = nullptr;
     STAT_ADD(STAT_total_feasign_num_in_mem, fea_num_);
     {
       std::lock_guard<std::mutex> flock(*mutex_for_fea_num_);
@@ -636,6 +676,44 @@ void InMemoryDataFeed<T>::LoadIntoMemoryFromSo() {
 }
 
 // explicit instantiation
+template <typename T>
+std::string InMemoryDataFeed<T>::ParseConfig() const {
+  std::ostringstream config;
+  config << parse_ins_id_ << parse_uid_ << parse_content_ << parse_logkey_
+         << ' ' << uid_slot_;
+  for (size_t i = 0; i < all_slots_.size(); ++i) {
+    config << ' ' << all_slots_[i] << ':' << all_slots_type_[i];
+  }
+  for (size_t i = 0; i < use_slots_.size(); ++i) {
+    config << ' ' << use_slots_[i] << ':' << use_slots_is_dense_[i];
+  }
+  return config.str();
+}
+
+template <typename T>
+std::string InMemoryDataFeed<T>::CacheKey(const std::string& filename) const {
+#ifdef _LINUX
+  // Only a local file has a size and mtime to tell whether it changed.
+  if (FLAGS_dataset_cache_dir.empty() || !so_parser_name_.empty() ||
+      fs_select_internal(filename) != 0) {
+    return "";
+  }
+  struct stat st;
+  if (stat(filename.c_str(), &st) != 0) {
+    return "";
+  }
+  std::ostringstream key;
+  key << filename << '\n'
+      << st.st_size << ' ' << st.st_mtim.tv_sec << '.' << st.st_mtim.tv_nsec
+      << '\n'
+      << pipe_command_ << '\n'
+      << ParseConfig();
+  return key.str();
+#else
+  return "";
+#endif
+}
+
 template class InMemoryDataFeed<Record>;
 
 void MultiSlotDataFeed::Init(
@@ -868,11 +946,13 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
     const char* str = reader.get();
     std::string line = std::string(str);
 
-    char* endptr = const_cast<char*>(str);
+    const char* end = str + reader.length();
+    const char* endptr = str;
     int pos = 0;
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = 0;
+      endptr = slot_text::ParseInt(&str[pos], end, &num);
 
       if (num <= 0) {
         std::stringstream ss;
@@ -899,12 +979,14 @@ bool MultiSlotDataFeed::ParseOneInstanceFromPipe(
         (*instance)[idx].Init(all_slots_type_[i]);
         if ((*instance)[idx].GetType()[0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = 0;
+            endptr = slot_text::ParseFloat(endptr, end, &feasign);
             (*instance)[idx].AddValue(feasign);
           }
         } else if ((*instance)[idx].GetType()[0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = 0;
+            endptr = slot_text::ParseUInt64(endptr, end, &feasign);
             (*instance)[idx].AddValue(feasign);
           }
         }
@@ -1155,10 +1237,12 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     const char* str = reader.get();
     std::string line = std::string(str);
     // VLOG(3) << line;
-    char* endptr = const_cast<char*>(str);
+    const char* end = str + reader.length();
+    const char* endptr = str;
     int pos = 0;
     if (parse_ins_id_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+      int num = 0;
+      endptr = slot_text::ParseInt(&str[pos], end, &num);
       CHECK(num == 1);  // NOLINT
       pos = static_cast<int>(endptr - str + 1);
       size_t len = 0;
@@ -1170,7 +1254,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       VLOG(3) << "ins_id " << instance->ins_id_;
     }
     if (parse_content_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+      int num = 0;
+      endptr = slot_text::ParseInt(&str[pos], end, &num);
       CHECK(num == 1);  // NOLINT
       pos = static_cast<int>(endptr - str + 1);
       size_t len = 0;
@@ -1182,7 +1267,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
       VLOG(3) << "content " << instance->content_;
     }
     if (parse_logkey_) {
-      int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+      int num = 0;
+      endptr = slot_text::ParseInt(&str[pos], end, &num);
       CHECK(num == 1);  // NOLINT
       pos = static_cast<int>(endptr - str + 1);
       size_t len = 0;
@@ -1204,7 +1290,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
     }
     for (size_t i = 0; i < use_slots_index_.size(); ++i) {
       int idx = use_slots_index_[i];
-      int num = strtol(&str[pos], &endptr, 10);
+      int num = 0;
+      endptr = slot_text::ParseInt(&str[pos], end, &num);
       PADDLE_ENFORCE_NE(
           num,
           0,
@@ -1229,15 +1316,16 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
                            "please check this error line: %s",
                            str));
 
-        char* uidptr = endptr;
-        uint64_t feasign = (uint64_t)strtoull(uidptr, &uidptr, 10);
+        uint64_t feasign = 0;
+        slot_text::ParseUInt64(endptr, end, &feasign);
         instance->uid_ = feasign;
       }
 #endif
       if (idx != -1) {
         if (all_slots_type_[i][0] == 'f') {  // float
           for (int j = 0; j < num; ++j) {
-            float feasign = strtof(endptr, &endptr);
+            float feasign = 0;
+            endptr = slot_text::ParseFloat(endptr, end, &feasign);
             // if float feasign is equal to zero, ignore it
             // except when slot is dense
             if (fabs(feasign) < 1e-6 && !use_slots_is_dense_[i]) {
@@ -1249,7 +1337,8 @@ bool MultiSlotInMemoryDataFeed::ParseOneInstanceFromPipe(Record* instance) {
           }
         } else if (all_slots_type_[i][0] == 'u') {  // uint64
           for (int j = 0; j < num; ++j) {
-            uint64_t feasign = (uint64_t)strtoull(endptr, &endptr, 10);
+            uint64_t feasign = 0;
+            endptr = slot_text::ParseUInt64(endptr, end, &feasign);
             // if uint64 feasign is equal to zero, ignore it
             // except when slot is dense
             if (feasign == 0 && !use_slots_is_dense_[i]) {
@@ -2021,6 +2110,175 @@ void PaddleBoxDataFeed::PutToFeedVec(const std::vector<Record*>& ins_vec) {
 #endif
 }
 
+namespace {
+
+template <typename T>
+const T* GetSlotValues(const SlotValues<T>& slot_values,
+                       int slot_value_idx,
+                       size_t* num) {
+  const auto& offsets = slot_values.slot_offsets;
+  if (offsets.size() < static_cast<size_t>(slot_value_idx) + 2) {
+    *num = 0;
+    return nullptr;
+  }
+  uint32_t offset = offsets[slot_value_idx];
+  *num = offsets[slot_value_idx + 1] - offset;
+  return slot_values.slot_values.data() + offset;
+}
+
+const SlotColumn<uint64_t>& GetColumn(const SlotRecordChunk& chunk,
+                                      int slot_value_idx,
+                                      uint64_t) {
+  return chunk.uint64_column(slot_value_idx);
+}
+
+const SlotColumn<float>& GetColumn(const SlotRecordChunk& chunk,
+                                   int slot_value_idx,
+                                   float) {
+  return chunk.float_column(slot_value_idx);
+}
+
+}  // namespace
+
+SlotRecordChunk::SlotRecordChunk(const SlotRecord* records,
+                                 size_t num,
+                                 int uint64_slot_num,
+                                 int float_slot_num)
+    : num_(num),
+      uint64_columns_(uint64_slot_num),
+      float_columns_(float_slot_num),
+      ins_ids_(num) {
+  // Counts the values first, so that every column is allocated once.
+  std::vector<size_t> uint64_sizes(uint64_slot_num, 0);
+  std::vector<size_t> float_sizes(float_slot_num, 0);
+  size_t fea_num = 0;
+  for (size_t i = 0; i < num; ++i) {
+    for (int j = 0; j < uint64_slot_num; ++j) {
+      GetSlotValues(records[i]->slot_uint64_feasigns_, j, &fea_num);
+      uint64_sizes[j] += std::max(fea_num, static_cast<size_t>(1));
+    }
+    for (int j = 0; j < float_slot_num; ++j) {
+      GetSlotValues(records[i]->slot_float_feasigns_, j, &fea_num);
+      float_sizes[j] += fea_num;
+    }
+  }
+  for (int j = 0; j < uint64_slot_num; ++j) {
+    uint64_columns_[j].values.reserve(uint64_sizes[j]);
+    uint64_columns_[j].offsets.reserve(num + 1);
+    uint64_columns_[j].offsets.push_back(0);
+  }
+  for (int j = 0; j < float_slot_num; ++j) {
+    float_columns_[j].values.reserve(float_sizes[j]);
+    float_columns_[j].offsets.reserve(num + 1);
+    float_columns_[j].offsets.push_back(0);
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    const SlotRecord& r = records[i];
+    for (int j = 0; j < uint64_slot_num; ++j) {
+      auto& column = uint64_columns_[j];
+      const uint64_t* values =
+          GetSlotValues(r->slot_uint64_feasigns_, j, &fea_num);
+      if (fea_num == 0) {
+        column.values.push_back(0);
+      } else {
+        column.values.insert(column.values.end(), values, values + fea_num);
+      }
+      column.offsets.push_back(column.values.size());
+    }
+    for (int j = 0; j < float_slot_num; ++j) {
+      auto& column = float_columns_[j];
+      const float* values = GetSlotValues(r->slot_float_feasigns_, j, &fea_num);
+      column.values.insert(column.values.end(), values, values + fea_num);
+      column.offsets.push_back(column.values.size());
+    }
+    ins_ids_[i] = r->ins_id_;
+  }
+}
+
+size_t SlotRecordChunk::MemorySize() const {
+  size_t size = sizeof(SlotRecordChunk);
+  for (auto& column : uint64_columns_) {
+    size += column.values.capacity() * sizeof(uint64_t) +
+            column.offsets.capacity() * sizeof(size_t);
+  }
+  for (auto& column : float_columns_) {
+    size += column.values.capacity() * sizeof(float) +
+            column.offsets.capacity() * sizeof(size_t);
+  }
+  for (auto& ins_id : ins_ids_) {
+    size += sizeof(std::string) + ins_id.capacity();
+  }
+  return size;
+}
+
+void SlotRecordColumnStore::Build(std::vector<SlotRecord>* records,
+                                  int uint64_slot_num,
+                                  int float_slot_num,
+                                  size_t chunk_size,
+                                  int thread_num) {
+  PADDLE_ENFORCE_GT(
+      chunk_size,
+      0,
+      phi::errors::InvalidArgument(
+          "The chunk size of SlotRecordColumnStore should be greater than 0."));
+  PADDLE_ENFORCE_LE(
+      chunk_size,
+      std::numeric_limits<uint32_t>::max(),
+      phi::errors::InvalidArgument(
+          "The chunk size of SlotRecordColumnStore should be less than 2^32, "
+          "but received %d.",
+          chunk_size));
+  size_t num = records->size();
+  size_t chunk_num = (num + chunk_size - 1) / chunk_size;
+  chunks_.assign(chunk_num, nullptr);
+  std::atomic<size_t> next_chunk{0};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < std::max(thread_num, 1); ++i) {
+    threads.emplace_back([&]() {
+      for (size_t c = next_chunk++; c < chunk_num; c = next_chunk++) {
+        size_t begin = c * chunk_size;
+        size_t end = std::min(num, begin + chunk_size);
+        chunks_[c] = std::make_shared<const SlotRecordChunk>(
+            &(*records)[begin], end - begin, uint64_slot_num, float_slot_num);
+        // The records of a chunk are released right away, which keeps the
+        // peak memory close to that of the records alone.
+        SlotRecordPool().put(&(*records)[begin], end - begin);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  records->clear();
+  records->shrink_to_fit();
+
+  rows_.clear();
+  rows_.reserve(num);
+  for (size_t c = 0; c < chunk_num; ++c) {
+    for (size_t r = 0; r < chunks_[c]->size(); ++r) {
+      rows_.push_back({static_cast<uint32_t>(c), static_cast<uint32_t>(r)});
+    }
+  }
+  shuffled_ = false;
+}
+
+bool SlotRecordColumnStore::IsContiguous(size_t begin, size_t num) const {
+  // Before any shuffle the rows are in the order of the chunks.
+  if (shuffled_ || num == 0) {
+    return false;
+  }
+  return rows_[begin].chunk == rows_[begin + num - 1].chunk;
+}
+
+size_t SlotRecordColumnStore::MemorySize() const {
+  size_t size = rows_.capacity() * sizeof(Row);
+  for (auto& chunk : chunks_) {
+    size += chunk->MemorySize();
+  }
+  return size;
+}
+
 SlotRecordInMemoryDataFeed::~SlotRecordInMemoryDataFeed() {  // NOLINT
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
   stop_token_.store(true);
@@ -2369,19 +2627,43 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
     std::vector<SlotRecord> record_vec;
     platform::Timer timeline;
     timeline.Start();
+    // A sampled file is not cached, the next load samples it again.
+    std::string cache_key = sample_rate_ == 1.0f ? CacheKey(filename) : "";
+    if (!cache_key.empty() &&
+        data_feed_cache::LoadCache<SlotRecord>(
+            cache_key, [this](std::vector<SlotRecord>* ins) {
+              input_channel_->Write(std::move(*ins));
+            })) {
+      timeline.Pause();
+      VLOG(3) << "LoadIntoMemory() read dataset cache, file=" << filename
+              << ", cost time=" << timeline.ElapsedSec()
+              << " seconds, thread_id=" << thread_id_;
+      continue;
+    }
     SlotRecordPool().get(&record_vec, OBJPOOL_BLOCK_SIZE);
     int offset = 0;
+    std::unique_ptr<data_feed_cache::CacheWriter<SlotRecord>> cache_writer;
+    if (!cache_key.empty()) {
+      cache_writer =
+          std::make_unique<data_feed_cache::CacheWriter<SlotRecord>>(
+              cache_key);
+    }
 
+    int err_no = 0;
     do {
-      int err_no = 0;
+      err_no = 0;
       this->fp_ = fs_open_read(filename, &err_no, this->pipe_command_, true);
       CHECK(this->fp_ != nullptr);
       __fsetlocking(&*(this->fp_), FSETLOCKING_BYCALLER);
 
       lines = line_reader.read_file(
           this->fp_.get(),
-          [this, &record_vec, &offset, &filename](const std::string& line) {
+          [this, &record_vec, &offset, &filename, &cache_writer](
+              const std::string& line) {
             if (ParseOneInstance(line, &record_vec[offset])) {
+              if (cache_writer != nullptr) {
+                cache_writer->Append(record_vec[offset]);
+              }
               ++offset;
             } else {
               LOG(WARNING) << "read file:[" << filename
@@ -2397,7 +2679,19 @@ void SlotRecordInMemoryDataFeed::LoadIntoMemoryByCommand() {
             return true;
           },
           lines);
+      // Closing the pipe sets err_no.
+      this->fp_ = nullptr;
+      if (line_reader.is_error()) {
+        // A file with bad lines is read again and not cached.
+        cache_writer = nullptr;
+      }
     } while (line_reader.is_error());
+    // A pipe that failed may have stopped early, so its instances are not
+    // cached.
+    if (cache_writer != nullptr && err_no == 0) {
+      cache_writer->Finish();
+    }
+    cache_writer = nullptr;
     if (offset > 0) {
       input_channel_->WriteMove(offset, &record_vec[0]);
       if (offset < OBJPOOL_BLOCK_SIZE) {
@@ -2434,12 +2728,25 @@ static void parser_log_key(const std::string& log_key,
   *rank = static_cast<uint32_t>(strtoul(rank_str.c_str(), nullptr, 16));
 }
 
+std::string SlotRecordInMemoryDataFeed::ParseConfig() const {
+  std::ostringstream config;
+  config << parse_ins_id_ << parse_logkey_;
+  for (auto& info : all_slots_info_) {
+    config << ' ' << info.slot << ':' << info.type << ':' << info.used_idx;
+  }
+  for (auto& info : used_slots_info_) {
+    config << ' ' << info.slot << ':' << info.dense;
+  }
+  return config.str();
+}
+
 bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
                                                   SlotRecord* ins) {
   SlotRecord& rec = (*ins);
   // parse line
   const char* str = line.c_str();
-  char* endptr = const_cast<char*>(str);
+  const char* end = str + line.size();
+  const char* endptr = str;
   int pos = 0;
 
   thread_local std::vector<std::vector<float>> slot_float_feasigns;
@@ -2448,7 +2755,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   slot_uint64_feasigns.resize(uint64_use_slot_size_);
 
   if (parse_ins_id_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = 0;
+    endptr = slot_text::ParseInt(&str[pos], end, &num);
     CHECK(num == 1);  // NOLINT
     pos = static_cast<int>(endptr - str + 1);
     size_t len = 0;
@@ -2459,7 +2767,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
     pos += static_cast<int>(len + 1);
   }
   if (parse_logkey_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = 0;
+    endptr = slot_text::ParseInt(&str[pos], end, &num);
     CHECK(num == 1);  // NOLINT
     pos = static_cast<int>(endptr - str + 1);
     size_t len = 0;
@@ -2484,7 +2793,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
   int uint64_total_slot_num = 0;
 
   for (auto& info : all_slots_info_) {
-    int num = static_cast<int>(strtol(&str[pos], &endptr, 10));
+    int num = 0;
+    endptr = slot_text::ParseInt(&str[pos], end, &num);
     PADDLE_ENFORCE(num,
                    "The number of ids can not be zero, you need padding "
                    "it in data generator; or if there is something wrong with "
@@ -2496,7 +2806,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_float_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          float feasign = strtof(endptr, &endptr);
+          float feasign = 0;
+          endptr = slot_text::ParseFloat(endptr, end, &feasign);
           if (fabs(feasign) < 1e-6 && !used_slots_info_[info.used_idx].dense) {
             continue;
           }
@@ -2507,8 +2818,8 @@ bool SlotRecordInMemoryDataFeed::ParseOneInstance(const std::string& line,
         auto& slot_fea = slot_uint64_feasigns[info.slot_value_idx];
         slot_fea.clear();
         for (int j = 0; j < num; ++j) {
-          uint64_t feasign =
-              static_cast<uint64_t>(strtoull(endptr, &endptr, 10));
+          uint64_t feasign = 0;
+          endptr = slot_text::ParseUInt64(endptr, end, &feasign);
           slot_fea.push_back(feasign);
           ++uint64_total_slot_num;
         }
@@ -2644,6 +2955,101 @@ void SlotRecordInMemoryDataFeed::PutToFeedVec(const SlotRecord* ins_vec,
 #endif
 }
 
+void SlotRecordInMemoryDataFeed::PutToFeedVec(
+    const SlotRecordColumnStore& store, size_t begin, int num) {
+  if (parse_ins_id_) {
+    ins_id_vec_.clear();
+    ins_id_vec_.resize(num);
+    for (int i = 0; i < num; ++i) {
+      const auto& row = store.row(begin + i);
+      ins_id_vec_[i] = store.chunk(row.chunk)->ins_id(row.row);
+    }
+  }
+#if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
+  // do nothing
+#else
+  for (int j = 0; j < use_slot_size_; ++j) {
+    auto& feed = feed_vec_[j];
+    if (feed == nullptr) {
+      continue;
+    }
+
+    auto& slot_offset = offset_[j];
+    slot_offset.clear();
+    slot_offset.reserve(num + 1);
+    slot_offset.push_back(0);
+
+    int total_instance = 0;
+    auto& info = used_slots_info_[j];
+    if (info.type[0] == 'f') {  // float
+      total_instance =
+          PutColumnToFeed(store, begin, num, j, &batch_float_feasigns_[j]);
+    } else if (info.type[0] == 'u') {  // uint64
+      total_instance =
+          PutColumnToFeed(store, begin, num, j, &batch_uint64_feasigns_[j]);
+    }
+
+    if (info.dense) {
+      if (info.inductive_shape_index != -1) {
+        info.local_shape[info.inductive_shape_index] =
+            total_instance / info.total_dims_without_inductive;
+      }
+      feed->Resize(common::make_ddim(info.local_shape));
+    } else {
+      LoD data_lod{slot_offset};
+      feed_vec_[j]->set_lod(data_lod);
+    }
+  }
+#endif
+}
+
+template <typename T>
+int SlotRecordInMemoryDataFeed::PutColumnToFeed(
+    const SlotRecordColumnStore& store,
+    size_t begin,
+    int num,
+    int slot,
+    std::vector<T>* batch_fea) {
+  // no uint64_t type in paddlepaddle
+  using FeedT = typename std::
+      conditional<std::is_same<T, uint64_t>::value, int64_t, T>::type;
+  auto& feed = feed_vec_[slot];
+  auto& slot_offset = offset_[slot];
+  int slot_value_idx = used_slots_info_[slot].slot_value_idx;
+  const T* feasign = nullptr;
+  int total_instance = 0;
+  if (store.IsContiguous(begin, num)) {
+    const auto& first = store.row(begin);
+    const auto& chunk = store.chunk(first.chunk);
+    const auto& column = GetColumn(*chunk, slot_value_idx, T());
+    size_t value_begin = column.offsets[first.row];
+    for (int i = 1; i <= num; ++i) {
+      slot_offset.push_back(column.offsets[first.row + i] - value_begin);
+    }
+    total_instance = static_cast<int>(slot_offset.back());
+    // The feed tensor may be written by the program, so the values are copied
+    // out of the chunk, but at once.
+    feasign = column.values.data() + value_begin;
+  } else {
+    batch_fea->clear();
+    for (int i = 0; i < num; ++i) {
+      const auto& row = store.row(begin + i);
+      const auto& column =
+          GetColumn(*store.chunk(row.chunk), slot_value_idx, T());
+      batch_fea->insert(batch_fea->end(),
+                        column.values.begin() + column.offsets[row.row],
+                        column.values.begin() + column.offsets[row.row + 1]);
+      slot_offset.push_back(batch_fea->size());
+    }
+    total_instance = static_cast<int>(batch_fea->size());
+    feasign = batch_fea->data();
+  }
+  FeedT* tensor_ptr =
+      feed->mutable_data<FeedT>({total_instance, 1}, this->place_);
+  CopyToFeedTensor(tensor_ptr, feasign, total_instance * sizeof(T));
+  return total_instance;
+}
+
 void SlotRecordInMemoryDataFeed::ExpandSlotRecord(SlotRecord* rec) {
   SlotRecord& ins = (*rec);
   if (ins->slot_float_feasigns_.slot_offsets.empty()) {
@@ -2802,7 +3208,9 @@ int SlotRecordInMemoryDataFeed::Next() {
     this->batch_size_ = batch.second;
     VLOG(3) << "batch_size_=" << this->batch_size_
             << ", thread_id=" << thread_id_;
-    if (this->batch_size_ != 0) {  // NOLINT
+    if (this->batch_size_ != 0 && column_store_ != nullptr) {
+      PutToFeedVec(*column_store_, batch.first, this->batch_size_);
+    } else if (this->batch_size_ != 0) {  // NOLINT
       PutToFeedVec(&records_[batch.first], this->batch_size_);
     } else {
       VLOG(3) << "finish reading for heterps, batch size zero, thread_id="
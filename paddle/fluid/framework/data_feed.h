@@ -19,6 +19,7 @@ limitations under the License. */
 #define _LINUX
 #endif
 
+#include <algorithm>
 #include <fstream>
 #include <future>  // NOLINT
 #include <memory>
@@ -379,6 +380,81 @@ inline SlotObjPool& SlotRecordPool() {
   static SlotObjPool pool;
   return pool;
 }
+
+// The values of one slot for a range of instances, stored contiguously:
+// values[offsets[i], offsets[i + 1]) belong to the i-th instance. An empty
+// uint64 slot holds a single 0, the same as the feed fills in, so the values
+// of consecutive instances can be fed as they are.
+template <typename T>
+struct SlotColumn {
+  std::vector<T> values;
+  std::vector<size_t> offsets;
+};
+
+// A chunk of instances stored by column, one SlotColumn per used slot.
+// Chunks are immutable once built and shared with the feed tensors that
+// point into them.
+class SlotRecordChunk {
+ public:
+  SlotRecordChunk(const SlotRecord* records,
+                  size_t num,
+                  int uint64_slot_num,
+                  int float_slot_num);
+  size_t size() const { return num_; }
+  const SlotColumn<uint64_t>& uint64_column(int slot_value_idx) const {
+    return uint64_columns_[slot_value_idx];
+  }
+  const SlotColumn<float>& float_column(int slot_value_idx) const {
+    return float_columns_[slot_value_idx];
+  }
+  const std::string& ins_id(size_t row) const { return ins_ids_[row]; }
+  size_t MemorySize() const;
+
+ private:
+  size_t num_;
+  std::vector<SlotColumn<uint64_t>> uint64_columns_;
+  std::vector<SlotColumn<float>> float_columns_;
+  std::vector<std::string> ins_ids_;
+};
+
+// The in-memory data of SlotRecordDataset as columnar chunks, read through
+// an index of (chunk, row). The shuffles permute the index only. A batch of
+// rows that are consecutive in one chunk is copied to the feed with one copy
+// per slot instead of being gathered row by row.
+class SlotRecordColumnStore {
+ public:
+  struct Row {
+    uint32_t chunk;
+    uint32_t row;
+  };
+
+  // Moves `records` into chunks of `chunk_size` instances, built by
+  // `thread_num` threads. The records are put back to SlotRecordPool.
+  void Build(std::vector<SlotRecord>* records,
+             int uint64_slot_num,
+             int float_slot_num,
+             size_t chunk_size,
+             int thread_num);
+  size_t size() const { return rows_.size(); }
+  const Row& row(size_t i) const { return rows_[i]; }
+  const std::shared_ptr<const SlotRecordChunk>& chunk(uint32_t i) const {
+    return chunks_[i];
+  }
+  template <typename Engine>
+  void Shuffle(Engine&& engine) {
+    std::shuffle(rows_.begin(), rows_.end(), engine);
+    shuffled_ = true;
+  }
+  // Whether the rows [begin, begin + num) are consecutive rows of a chunk.
+  bool IsContiguous(size_t begin, size_t num) const;
+  size_t MemorySize() const;
+
+ private:
+  std::vector<std::shared_ptr<const SlotRecordChunk>> chunks_;
+  std::vector<Row> rows_;
+  bool shuffled_ = false;
+};
+
 struct PvInstanceObject {
   std::vector<Record*> ads;
   void merge_instance(Record* ins) { ads.push_back(ins); }
@@ -1566,6 +1642,12 @@ class InMemoryDataFeed : public DataFeed {
   }
   virtual void PutToFeedVec(const std::vector<T>& ins_vec) = 0;
   virtual void PutToFeedVec(const T* ins_vec, int num) = 0;
+  // The config the instances are parsed with, part of the key of the
+  // dataset cache.
+  virtual std::string ParseConfig() const;
+  // The key of `filename` in the dataset cache, empty if it is not cached.
+  // See FLAGS_dataset_cache_dir.
+  std::string CacheKey(const std::string& filename) const;
 
   std::vector<std::vector<float>> batch_float_feasigns_;
   std::vector<std::vector<uint64_t>> batch_uint64_feasigns_;
@@ -1964,6 +2046,10 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   void Init(const DataFeedDesc& data_feed_desc) override;
   void LoadIntoMemory() override;
   void ExpandSlotRecord(SlotRecord* ins);
+  // Batches are read from `store` instead of the records when it is set.
+  void SetColumnStore(std::shared_ptr<const SlotRecordColumnStore> store) {
+    column_store_ = store;
+  }
 
  protected:
   bool Start() override;
@@ -1984,7 +2070,15 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
     input_channel_ = static_cast<ChannelObject<SlotRecord>*>(channel);
   }
   bool ParseOneInstance(const std::string& line, SlotRecord* rec);
+  std::string ParseConfig() const override;
   void PutToFeedVec(const SlotRecord* ins_vec, int num) override;
+  void PutToFeedVec(const SlotRecordColumnStore& store, size_t begin, int num);
+  template <typename T>
+  int PutColumnToFeed(const SlotRecordColumnStore& store,
+                      size_t begin,
+                      int num,
+                      int slot,
+                      std::vector<T>* batch_fea);
   void AssignFeedVar(const Scope& scope) override;
   std::vector<std::string> GetInputVarNames() override {
     std::vector<std::string> var_names;
@@ -2052,6 +2146,7 @@ class SlotRecordInMemoryDataFeed : public InMemoryDataFeed<SlotRecord> {
   std::vector<UsedSlotInfo> used_slots_info_;
   size_t float_total_dims_size_ = 0;
   std::vector<int> float_total_dims_without_inductives_;
+  std::shared_ptr<const SlotRecordColumnStore> column_store_;
 
 #if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
   int pack_thread_num_{5};
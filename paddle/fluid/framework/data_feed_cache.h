@@ -0,0 +1,391 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/data_feed.h"
+
+#ifdef _LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include <mutex>  // NOLINT
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/archive.h"
+#include "paddle/phi/core/enforce.h"
+
+COMMON_DECLARE_string(dataset_cache_dir);
+COMMON_DECLARE_int64(dataset_cache_max_mb);
+
+// An on-disk cache of the instances parsed from the data files, so that a
+// file is parsed once and later loads only copy its instances back. A cache
+// file is named by the hash of a key, which holds the path, size and mtime
+// of the data file and the config that parses it. The key itself is kept in
+// the file and compared on load.
+//
+// Layout of a cache file, integers are uint64 in host byte order:
+//   header: magic | key length | key | block num | index offset
+//   blocks: per block, payload length | instance num | payload, where the
+//           payload is the BinaryArchive of about kBlockBytes of instances
+//   index:  per block, offset | payload length | instance num | checksum
+// The file is mmaped on load. The index and the checksum of every payload
+// are checked before any block is read, a file that fails them is ignored
+// and the data file is read again. The cache files of FLAGS_dataset_cache_dir
+// are kept under FLAGS_dataset_cache_max_mb, the least recently used ones are
+// removed.
+namespace paddle {
+namespace framework {
+namespace data_feed_cache {
+
+constexpr uint64_t kMagic = 0x3248434143445050ULL;  // "PPDCACH2"
+constexpr size_t kBlockBytes = 4 << 20;
+constexpr char kSuffix[] = ".pdcache";
+
+template <typename T>
+void WritePod(BinaryArchive* ar, const std::vector<T>& v) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "the cached vectors are copied as bytes");
+  *ar << static_cast<uint64_t>(v.size());
+  ar->Write(v.data(), v.size() * sizeof(T));
+}
+
+template <typename T>
+void ReadPod(BinaryArchive* ar, std::vector<T>* v) {
+  uint64_t size = ar->Get<uint64_t>();
+  // Checked before the allocation, the size comes from the file.
+  PADDLE_ENFORCE_LE(size,
+                    (ar->Finish() - ar->Cursor()) / sizeof(T),
+                    phi::errors::InvalidArgument(
+                        "The dataset cache block is shorter than a vector "
+                        "of %d elements it holds.",
+                        size));
+  v->resize(size);
+  ar->Read(v->data(), v->size() * sizeof(T));
+}
+
+inline uint64_t BlockChecksum(const char* data, size_t length) {
+  return std::hash<std::string_view>()(std::string_view(data, length));
+}
+
+inline void WriteInstance(BinaryArchive* ar, const Record& r) {
+  WritePod(ar, r.uint64_feasigns_);
+  WritePod(ar, r.float_feasigns_);
+  *ar << r.ins_id_ << r.content_ << r.uid_;
+  *ar << r.search_id << r.rank << r.cmatch;
+}
+
+inline void ReadInstance(BinaryArchive* ar, Record* r) {
+  ReadPod(ar, &r->uint64_feasigns_);
+  ReadPod(ar, &r->float_feasigns_);
+  *ar >> r->ins_id_ >> r->content_ >> r->uid_;
+  *ar >> r->search_id >> r->rank >> r->cmatch;
+}
+
+inline void WriteInstance(BinaryArchive* ar, const SlotRecord& r) {
+  WritePod(ar, r->slot_uint64_feasigns_.slot_values);
+  WritePod(ar, r->slot_uint64_feasigns_.slot_offsets);
+  WritePod(ar, r->slot_float_feasigns_.slot_values);
+  WritePod(ar, r->slot_float_feasigns_.slot_offsets);
+  *ar << r->ins_id_;
+  *ar << r->search_id << r->rank << r->cmatch;
+}
+
+inline void ReadInstance(BinaryArchive* ar, SlotRecord* r) {
+  SlotRecord rec = *r;
+  ReadPod(ar, &rec->slot_uint64_feasigns_.slot_values);
+  ReadPod(ar, &rec->slot_uint64_feasigns_.slot_offsets);
+  ReadPod(ar, &rec->slot_float_feasigns_.slot_values);
+  ReadPod(ar, &rec->slot_float_feasigns_.slot_offsets);
+  *ar >> rec->ins_id_;
+  *ar >> rec->search_id >> rec->rank >> rec->cmatch;
+}
+
+inline void NewInstances(size_t num, std::vector<Record>* ins_vec) {
+  ins_vec->resize(num);
+}
+
+inline void NewInstances(size_t num, std::vector<SlotRecord>* ins_vec) {
+  SlotRecordPool().get(ins_vec, static_cast<int>(num));
+}
+
+inline size_t FeasignNum(const Record& r) { return r.uint64_feasigns_.size(); }
+
+inline size_t FeasignNum(const SlotRecord& r) {
+  return r->slot_uint64_feasigns_.slot_values.size();
+}
+
+inline std::string CachePath(const std::string& key) {
+  char name[32];
+  snprintf(name,
+           sizeof(name),
+           "%016llx",
+           static_cast<unsigned long long>(  // NOLINT
+               std::hash<std::string>()(key)));
+  return FLAGS_dataset_cache_dir + "/" + name + kSuffix;
+}
+
+// Removes the least recently used cache files until `incoming` more bytes
+// fit under FLAGS_dataset_cache_max_mb. Returns false if they never fit.
+inline bool EvictCache(size_t incoming) {
+  static std::mutex mutex;
+  std::lock_guard<std::mutex> lock(mutex);
+  const size_t max_bytes =
+      static_cast<size_t>(std::max<int64_t>(FLAGS_dataset_cache_max_mb, 0))
+      << 20;
+  if (incoming > max_bytes) {
+    return false;
+  }
+  DIR* dir = opendir(FLAGS_dataset_cache_dir.c_str());
+  if (dir == nullptr) {
+    return false;
+  }
+  // (mtime, size, path) of the cache files, a hit touches its file.
+  std::vector<std::tuple<time_t, size_t, std::string>> files;
+  size_t total = 0;
+  const size_t suffix_len = sizeof(kSuffix) - 1;
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name.size() <= suffix_len ||
+        name.compare(name.size() - suffix_len, suffix_len, kSuffix) != 0) {
+      continue;
+    }
+    std::string path = FLAGS_dataset_cache_dir + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+      files.emplace_back(st.st_mtime, st.st_size, path);
+      total += st.st_size;
+    }
+  }
+  closedir(dir);
+  std::sort(files.begin(), files.end());
+  for (auto& file : files) {
+    if (total + incoming <= max_bytes) {
+      break;
+    }
+    if (unlink(std::get<2>(file).c_str()) == 0) {
+      VLOG(1) << "evict dataset cache " << std::get<2>(file);
+    }
+    // Removed by another process otherwise, it is gone either way.
+    total -= std::get<1>(file);
+  }
+  return true;
+}
+
+// Writes the instances of one data file to its cache file. The cache file
+// only appears once Finish succeeds, a writer destroyed before that leaves
+// nothing behind.
+template <typename T>
+class CacheWriter {
+ public:
+  explicit CacheWriter(const std::string& key)
+      : key_(key), path_(CachePath(key)) {
+    tmp_path_ = path_ + ".tmp." + std::to_string(getpid()) + "." +
+                std::to_string(
+                    std::hash<std::thread::id>()(std::this_thread::get_id()));
+    fp_ = fopen(tmp_path_.c_str(), "wb");
+    if (fp_ == nullptr) {
+      LOG(WARNING) << "cannot create dataset cache " << tmp_path_;
+      return;
+    }
+    uint64_t zero = 0;
+    Put(&kMagic, sizeof(kMagic));
+    uint64_t key_len = key_.size();
+    Put(&key_len, sizeof(key_len));
+    Put(key_.data(), key_.size());
+    // The block num and the index offset, filled in by Finish.
+    Put(&zero, sizeof(zero));
+    Put(&zero, sizeof(zero));
+  }
+
+  ~CacheWriter() {
+    if (fp_ != nullptr) {
+      fclose(fp_);
+      unlink(tmp_path_.c_str());
+    }
+  }
+
+  void Append(const T& ins) {
+    if (fp_ == nullptr) {
+      return;
+    }
+    WriteInstance(&block_, ins);
+    ++block_ins_num_;
+    if (block_.Length() >= kBlockBytes) {
+      FlushBlock();
+    }
+  }
+
+  void Finish() {
+    if (fp_ == nullptr) {
+      return;
+    }
+    FlushBlock();
+    uint64_t index_offset = offset_;
+    for (auto& entry : index_) {
+      Put(entry.data(), sizeof(uint64_t) * entry.size());
+    }
+    uint64_t block_num = index_.size();
+    bool ok = !failed_ &&
+              fseek(fp_, 2 * sizeof(uint64_t) + key_.size(), SEEK_SET) == 0;
+    ok = ok && fwrite(&block_num, sizeof(block_num), 1, fp_) == 1 &&
+         fwrite(&index_offset, sizeof(index_offset), 1, fp_) == 1;
+    ok = fclose(fp_) == 0 && ok;
+    fp_ = nullptr;
+    if (ok && EvictCache(offset_) &&
+        rename(tmp_path_.c_str(), path_.c_str()) == 0) {
+      VLOG(1) << "write dataset cache " << path_ << ", " << offset_
+              << " bytes";
+      return;
+    }
+    LOG(WARNING) << "cannot write dataset cache " << path_;
+    unlink(tmp_path_.c_str());
+  }
+
+ private:
+  void Put(const void* data, size_t size) {
+    if (!failed_ && fwrite(data, 1, size, fp_) != size) {
+      failed_ = true;
+    }
+    offset_ += size;
+  }
+
+  void FlushBlock() {
+    if (block_ins_num_ == 0) {
+      return;
+    }
+    uint64_t length = block_.Length();
+    index_.push_back({offset_,
+                      length,
+                      block_ins_num_,
+                      BlockChecksum(block_.Buffer(), length)});
+    Put(&length, sizeof(length));
+    Put(&block_ins_num_, sizeof(block_ins_num_));
+    Put(block_.Buffer(), length);
+    block_.Clear();
+    block_ins_num_ = 0;
+  }
+
+  std::string key_;
+  std::string path_;
+  std::string tmp_path_;
+  FILE* fp_ = nullptr;
+  bool failed_ = false;
+  uint64_t offset_ = 0;
+  BinaryArchive block_;
+  uint64_t block_ins_num_ = 0;
+  std::vector<std::array<uint64_t, 4>> index_;
+};
+
+// Reads the cache file of `key` and passes its instances to `consume` one
+// block at a time. Returns false, without calling `consume`, if there is no
+// valid cache file.
+template <typename T>
+bool LoadCache(const std::string& key,
+               const std::function<void(std::vector<T>*)>& consume) {
+  std::string path = CachePath(key);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+  size_t size = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    return false;
+  }
+  char* data = static_cast<char*>(mapped);
+  auto read_u64 = [data, size](size_t offset, uint64_t* v) {
+    if (offset > size || size - offset < sizeof(uint64_t)) {
+      return false;
+    }
+    memcpy(v, data + offset, sizeof(uint64_t));
+    return true;
+  };
+
+  uint64_t magic = 0, key_len = 0, block_num = 0, index_offset = 0;
+  bool valid = read_u64(0, &magic) && magic == kMagic &&
+               read_u64(sizeof(uint64_t), &key_len) &&
+               key_len == key.size() &&
+               2 * sizeof(uint64_t) + key_len <= size &&
+               memcmp(data + 2 * sizeof(uint64_t), key.data(), key_len) == 0;
+  size_t pos = 2 * sizeof(uint64_t) + key_len;
+  valid = valid && read_u64(pos, &block_num) &&
+          read_u64(pos + sizeof(uint64_t), &index_offset) &&
+          index_offset <= size &&
+          (size - index_offset) / (4 * sizeof(uint64_t)) == block_num &&
+          (size - index_offset) % (4 * sizeof(uint64_t)) == 0;
+  std::vector<std::array<uint64_t, 4>> index(valid ? block_num : 0);
+  for (uint64_t i = 0; valid && i < block_num; ++i) {
+    size_t entry = index_offset + i * 4 * sizeof(uint64_t);
+    uint64_t length = 0, ins_num = 0;
+    valid = read_u64(entry, &index[i][0]) &&
+            read_u64(entry + sizeof(uint64_t), &index[i][1]) &&
+            read_u64(entry + 2 * sizeof(uint64_t), &index[i][2]) &&
+            read_u64(entry + 3 * sizeof(uint64_t), &index[i][3]) &&
+            read_u64(index[i][0], &length) && length == index[i][1] &&
+            read_u64(index[i][0] + sizeof(uint64_t), &ins_num) &&
+            ins_num == index[i][2] &&
+            index[i][0] + 2 * sizeof(uint64_t) <= index_offset &&
+            length <= index_offset - index[i][0] - 2 * sizeof(uint64_t) &&
+            BlockChecksum(data + index[i][0] + 2 * sizeof(uint64_t),
+                          length) == index[i][3];
+  }
+  if (!valid) {
+    LOG(WARNING) << "ignore invalid dataset cache " << path;
+    munmap(mapped, size);
+    return false;
+  }
+
+  // Marks the file as recently used for EvictCache.
+  utime(path.c_str(), nullptr);
+  for (auto& entry : index) {
+    BinaryArchive ar;
+    ar.SetReadBuffer(
+        data + entry[0] + 2 * sizeof(uint64_t), entry[1], [](char*) {});
+    std::vector<T> ins_vec;
+    NewInstances(entry[2], &ins_vec);
+    for (auto& ins : ins_vec) {
+      ReadInstance(&ar, &ins);
+    }
+    consume(&ins_vec);
+  }
+  munmap(mapped, size);
+  return true;
+}
+
+}  // namespace data_feed_cache
+}  // namespace framework
+}  // namespace paddle
+#endif
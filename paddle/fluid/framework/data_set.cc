@@ -42,10 +42,17 @@ COMMON_DECLARE_bool(graph_get_neighbor_id);
 COMMON_DECLARE_int32(gpugraph_storage_mode);
 COMMON_DECLARE_string(graph_edges_split_mode);
 COMMON_DECLARE_bool(query_dest_rank_by_multi_node);
+COMMON_DECLARE_bool(enable_slotrecord_columnar_store);
+COMMON_DECLARE_int32(slotrecord_chunk_size);
+COMMON_DECLARE_int64(streaming_shuffle_memory_mb);
+COMMON_DECLARE_string(streaming_shuffle_spill_dir);
 
 namespace paddle {
 namespace framework {
 
+// the client to client messages of PreGlobalShuffle, GlobalShuffle uses 0
+constexpr int kStreamingShuffleMsgType = 1;
+
 // constructor
 template <typename T>
 DatasetImpl<T>::DatasetImpl()
@@ -876,30 +883,19 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
   VLOG(3) << "MultiSlotDataset::GlobalShuffle() input_channel_ size "
           << input_channel_->Size();
 
-  auto get_client_id = [this, fleet_ptr](const Record& data) -> size_t {
-    if (this->merge_by_insid_) {
-      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
-             this->trainer_num_;
-    } else if (this->shuffle_by_uid_) {
-      return XXH64(data.uid_.data(), data.uid_.length(), 0) %
-             this->trainer_num_;
-    } else {
-      return fleet_ptr->LocalRandomEngine()() % this->trainer_num_;
-    }
-  };
-
-  auto global_shuffle_func = [this, get_client_id]() {
+  auto global_shuffle_func = [this]() {
 #ifdef PADDLE_WITH_PSCORE
     auto fleet_ptr = distributed::FleetWrapper::GetInstance();
 #else
     auto fleet_ptr = framework::FleetWrapper::GetInstance();
 #endif
     // auto fleet_ptr = framework::FleetWrapper::GetInstance();
+    auto& engine = fleet_ptr->LocalRandomEngine();
     std::vector<Record> data;
     while (this->input_channel_->Read(data)) {
       std::vector<paddle::framework::BinaryArchive> ars(this->trainer_num_);
       for (auto& t : data) {
-        auto client_id = get_client_id(t);
+        auto client_id = ShuffleClientId(t, &engine);
         ars[client_id] << t;
       }
       std::vector<std::future<int32_t>> total_status;
@@ -953,6 +949,105 @@ void MultiSlotDataset::GlobalShuffle(int thread_num) {
           << timeline.ElapsedSec() << " seconds";
 }
 
+int MultiSlotDataset::ShuffleClientId(const Record& data,
+                                      std::default_random_engine* engine) {
+  if (merge_by_insid_) {
+    return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
+           trainer_num_;
+  } else if (shuffle_by_uid_) {
+    return XXH64(data.uid_.data(), data.uid_.length(), 0) % trainer_num_;
+  } else {
+    return (*engine)() % trainer_num_;
+  }
+}
+
+void MultiSlotDataset::RegisterClientToClientMsgHandler() {
+  DatasetImpl<Record>::RegisterClientToClientMsgHandler();
+  // Created before any trainer starts to send, the caller syncs the trainers
+  // after the handlers are registered.
+  if (shuffle_receiver_ == nullptr) {
+    shuffle_receiver_ = std::make_unique<StreamingShuffleReceiver<Record>>(
+        static_cast<size_t>(FLAGS_streaming_shuffle_memory_mb) << 20,
+        FLAGS_streaming_shuffle_spill_dir);
+  }
+#ifdef PADDLE_WITH_PSCORE
+  auto fleet_ptr = distributed::FleetWrapper::GetInstance();
+#else
+  auto fleet_ptr = framework::FleetWrapper::GetInstance();
+#endif
+  fleet_ptr->RegisterClientToClientMsgHandler(
+      kStreamingShuffleMsgType,
+      [this](int msg_type, int client_id, const std::string& msg) -> int {
+        return this->ReceiveFromClient(msg_type, client_id, msg);
+      });
+}
+
+// The records are sent while the readers load them, call it after
+// PreLoadIntoMemory, or after LoadIntoMemory when there is nothing to
+// overlap with. The received records are kept by shuffle_receiver_ until
+// WaitGlobalShuffleDone.
+void MultiSlotDataset::PreGlobalShuffle(int thread_num) {
+  VLOG(3) << "MultiSlotDataset::PreGlobalShuffle() begin";
+  PADDLE_ENFORCE_NOT_NULL(
+      shuffle_receiver_,
+      phi::errors::PreconditionNotMet(
+          "Call RegisterClientToClientMsgHandler on every trainer before "
+          "PreGlobalShuffle."));
+  PADDLE_ENFORCE_NOT_NULL(
+      input_channel_,
+      phi::errors::PreconditionNotMet(
+          "The input channel is not created, call CreateChannel before "
+          "PreGlobalShuffle."));
+  if (thread_num == -1) {
+    thread_num = thread_num_;
+  }
+#ifdef PADDLE_WITH_PSCORE
+  auto fleet_ptr = distributed::FleetWrapper::GetInstance();
+#else
+  auto fleet_ptr = framework::FleetWrapper::GetInstance();
+#endif
+  auto send = [fleet_ptr](int client_id, const std::string& msg) {
+    return fleet_ptr->SendClientToClientMsg(
+        kStreamingShuffleMsgType, client_id, msg);
+  };
+  // Called by every sender thread, the engine is local to the thread.
+  auto client_id = [this, fleet_ptr](const Record& data) {
+    return ShuffleClientId(data, &fleet_ptr->LocalRandomEngine());
+  };
+  shuffle_sender_ = std::make_unique<StreamingShuffleSender<Record>>(
+      trainer_num_, fleet_send_batch_size_, send, client_id);
+  shuffle_sender_->Start(input_channel_, thread_num);
+  VLOG(3) << "MultiSlotDataset::PreGlobalShuffle() end, thread num "
+          << thread_num;
+}
+
+// Needs the input channel closed, by LoadIntoMemory or WaitPreLoadDone.
+void MultiSlotDataset::WaitGlobalShuffleDone() {
+  VLOG(3) << "MultiSlotDataset::WaitGlobalShuffleDone() begin";
+  PADDLE_ENFORCE_NOT_NULL(
+      shuffle_sender_,
+      phi::errors::PreconditionNotMet(
+          "Call PreGlobalShuffle before WaitGlobalShuffleDone."));
+  PADDLE_ENFORCE_GT(multi_output_channel_.size(),
+                    0UL,
+                    phi::errors::PreconditionNotMet(
+                        "The output channels are not created, call "
+                        "CreateChannel before WaitGlobalShuffleDone."));
+  platform::Timer timeline;
+  timeline.Start();
+  shuffle_sender_->Wait();
+  uint64_t send_num = shuffle_sender_->SendNum();
+  shuffle_sender_.reset();
+  input_channel_->Clear();
+  // Returns once every trainer has sent all of its records here.
+  shuffle_receiver_->Drain(trainer_num_, &multi_output_channel_);
+  timeline.Pause();
+  VLOG(3) << "MultiSlotDataset::WaitGlobalShuffleDone() end, send " << send_num
+          << " records, peak memory " << shuffle_receiver_->PeakMemoryBytes()
+          << " bytes, spill " << shuffle_receiver_->SpillBytes()
+          << " bytes, wait time=" << timeline.ElapsedSec() << " seconds";
+}
+
 template <typename T>
 void DatasetImpl<T>::DynamicAdjustChannelNum(int channel_num,
                                              bool discard_remaining_ins) {
@@ -1284,6 +1379,10 @@ int MultiSlotDataset::ReceiveFromClient(int msg_type,
 #ifdef _LINUX
   VLOG(3) << "ReceiveFromClient msg_type=" << msg_type
           << ", client_id=" << client_id << ", msg length=" << msg.length();
+  if (msg_type == kStreamingShuffleMsgType) {
+    shuffle_receiver_->Receive(msg);
+    return 0;
+  }
   if (msg.length() == 0) {
     return 0;
   }
@@ -1944,6 +2043,7 @@ void SlotRecordDataset::ReleaseMemory() {
     VLOG(3) << "release heterps input records records size: "
             << input_records_.size();
   }
+  column_store_ = nullptr;
 
   readers_.clear();
   readers_.shrink_to_fit();
@@ -1962,6 +2062,61 @@ void SlotRecordDataset::GlobalShuffle(int thread_num) {
   return;
 }
 
+void SlotRecordDataset::LocalShuffle() {
+  if (column_store_ == nullptr) {
+    DatasetImpl<SlotRecord>::LocalShuffle();
+    return;
+  }
+  VLOG(3) << "SlotRecordDataset::LocalShuffle() begin";
+  platform::Timer timeline;
+  timeline.Start();
+  // The loaded data is already in the columnar store, only its index is
+  // shuffled. The batches are then gathered instead of shared.
+  auto fleet_ptr = framework::FleetWrapper::GetInstance();
+  column_store_->Shuffle(fleet_ptr->LocalRandomEngine());
+  timeline.Pause();
+  VLOG(3) << "SlotRecordDataset::LocalShuffle() end, cost time="
+          << timeline.ElapsedSec() << " seconds";
+}
+
+void SlotRecordDataset::BuildColumnStore() {
+#if defined(PADDLE_WITH_CUDA) && defined(PADDLE_WITH_HETERPS)
+  // The readers pack the records for the gpu ps.
+  VLOG(0) << "FLAGS_enable_slotrecord_columnar_store is ignored with heterps";
+#else
+  if (column_store_ != nullptr || input_records_.empty()) {
+    return;
+  }
+  platform::Timer timeline;
+  timeline.Start();
+  int uint64_slot_num = 0;
+  int float_slot_num = 0;
+  const auto& multi_slot_desc = data_feed_desc_.multi_slot_desc();
+  for (int i = 0; i < multi_slot_desc.slots_size(); ++i) {
+    const auto& slot = multi_slot_desc.slots(i);
+    if (!slot.is_used()) {
+      continue;
+    }
+    if (slot.type()[0] == 'u') {
+      ++uint64_slot_num;
+    } else if (slot.type()[0] == 'f') {
+      ++float_slot_num;
+    }
+  }
+  size_t ins_num = input_records_.size();
+  column_store_ = std::make_shared<SlotRecordColumnStore>();
+  column_store_->Build(&input_records_,
+                       uint64_slot_num,
+                       float_slot_num,
+                       FLAGS_slotrecord_chunk_size,
+                       thread_num_);
+  timeline.Pause();
+  VLOG(1) << "build columnar store of " << ins_num << " instances, memory "
+          << column_store_->MemorySize() << " bytes, cost time="
+          << timeline.ElapsedSec() << " seconds";
+#endif
+}
+
 void SlotRecordDataset::DynamicAdjustChannelNum(int channel_num,
                                                 bool discard_remaining_ins) {
   if (channel_num_ == channel_num) {
@@ -1990,8 +2145,13 @@ void SlotRecordDataset::PrepareTrain() {
       VLOG(3) << "read from channel to records with records size: "
               << input_records_.size();
     }
+    if (FLAGS_enable_slotrecord_columnar_store) {
+      BuildColumnStore();
+    }
     VLOG(3) << "input records size: " << input_records_.size();
-    int64_t total_ins_num = input_records_.size();
+    int64_t total_ins_num = column_store_ != nullptr
+                                ? column_store_->size()
+                                : input_records_.size();
     std::vector<std::pair<int, int>> offset;
     int default_batch_size =
         reinterpret_cast<SlotRecordInMemoryDataFeed*>(readers_[0].get())
@@ -2003,8 +2163,13 @@ void SlotRecordDataset::PrepareTrain() {
         thread_num_, total_ins_num, default_batch_size, &offset);
     VLOG(3) << "offset size: " << offset.size();
     for (int i = 0; i < thread_num_; i++) {
-      reinterpret_cast<SlotRecordInMemoryDataFeed*>(readers_[i].get())
-          ->SetRecord(&input_records_[0]);
+      auto* reader =
+          reinterpret_cast<SlotRecordInMemoryDataFeed*>(readers_[i].get());
+      if (column_store_ != nullptr) {
+        reader->SetColumnStore(column_store_);
+      } else {
+        reader->SetRecord(&input_records_[0]);
+      }
     }
     for (size_t i = 0; i < offset.size(); i++) {
       reinterpret_cast<SlotRecordInMemoryDataFeed*>(
@@ -19,6 +19,7 @@
 #include <fstream>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <random>
 #include <set>
 #include <string>
 #include <thread>  // NOLINT
@@ -34,6 +35,7 @@
 #endif
 
 #include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/streaming_shuffle.h"
 
 namespace paddle {
 namespace framework {
@@ -127,6 +129,10 @@ class Dataset {
   virtual void LocalShuffle() = 0;
   // global shuffle data
   virtual void GlobalShuffle(int thread_num = -1) = 0;
+  // global shuffle data in async mode, the data is sent while it is loaded
+  virtual void PreGlobalShuffle(int thread_num = -1) = 0;
+  // wait async global shuffle done
+  virtual void WaitGlobalShuffleDone() = 0;
   virtual void SlotsShuffle(const std::set<std::string>& slots_to_replace) = 0;
   // create readers
   virtual void CreateReaders() = 0;
@@ -248,6 +254,8 @@ class DatasetImpl : public Dataset {
   virtual void ReleaseMemory();
   virtual void LocalShuffle();
   virtual void GlobalShuffle(int thread_num UNUSED = -1) {}
+  virtual void PreGlobalShuffle(int thread_num UNUSED = -1) {}
+  virtual void WaitGlobalShuffleDone() {}
   virtual void SlotsShuffle(
       const std::set<std::string>& slots_to_replace UNUSED) {}
   virtual const std::vector<T>& GetSlotsOriginalData() {
@@ -415,7 +423,10 @@ class MultiSlotDataset : public DatasetImpl<Record> {
       const std::unordered_set<uint16_t>& slots_to_replace,
       std::vector<Record>* result);
   virtual ~MultiSlotDataset() {}
+  virtual void RegisterClientToClientMsgHandler();
   virtual void GlobalShuffle(int thread_num = -1);
+  virtual void PreGlobalShuffle(int thread_num = -1);
+  virtual void WaitGlobalShuffleDone();
   virtual void DynamicAdjustReadersNum(int thread_num);
   virtual void PrepareTrain();
 
@@ -423,6 +434,13 @@ class MultiSlotDataset : public DatasetImpl<Record> {
   virtual int ReceiveFromClient(int msg_type,
                                 int client_id,
                                 const std::string& msg);
+  // the trainer a record is sent to by the global shuffle, `engine` is the
+  // local random engine of the calling thread
+  int ShuffleClientId(const Record& data, std::default_random_engine* engine);
+
+  // the streaming global shuffle of PreGlobalShuffle
+  std::unique_ptr<StreamingShuffleSender<Record>> shuffle_sender_;
+  std::unique_ptr<StreamingShuffleReceiver<Record>> shuffle_receiver_;
 };
 class SlotRecordDataset : public DatasetImpl<SlotRecord> {
  public:
@@ -439,10 +457,16 @@ class SlotRecordDataset : public DatasetImpl<SlotRecord> {
                                        bool discard_remaining_ins);
   virtual void PrepareTrain();
   virtual void DynamicAdjustReadersNum(int thread_num);
+  virtual void LocalShuffle();
   void DynamicAdjustBatchNum();
 
  protected:
+  // Moves input_records_ into column_store_ when
+  // FLAGS_enable_slotrecord_columnar_store is set.
+  void BuildColumnStore();
+
   bool enable_heterps_ = true;
+  std::shared_ptr<SlotRecordColumnStore> column_store_;
 };
 
 }  // end namespace framework
@@ -15,7 +15,9 @@ limitations under the License. */
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <fstream>
+#include <future>  // NOLINT
 #include <map>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -33,6 +35,7 @@ limitations under the License. */
 #include "paddle/common/macros.h"
 #include "paddle/fluid/framework/barrier.h"
 #include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/downpour_prefetch_queue.h"
 #include "paddle/fluid/framework/executor_gc_helper.h"
 #include "paddle/fluid/framework/heter_util.h"
 #include "paddle/fluid/framework/lod_tensor.h"
@@ -362,6 +365,13 @@ class DownpourWorker : public HogwildWorker {
   void CopySparseTable();
   void CopyDenseTable();
   void CopyDenseVars();
+  // prefetch: the batches are read and their sparse values pulled ahead of
+  // the training, see FLAGS_downpour_prefetch_depth
+  bool NeedPrefetch();
+  void StartPrefetch();
+  void EndPrefetch();
+  int NextPrefetchedBatch();
+  void AddPrefetchedSparsePush(size_t begin);
 
   DownpourWorkerParameter param_;
   // copy table
@@ -415,6 +425,22 @@ class DownpourWorker : public HogwildWorker {
   std::vector<float> nid_show_;
   // std::map<uint64_t, uint64_t> table_dependency_;
   // std::vector<std::pair<uint64_t, uint64_t>> copy_dense_tables_;
+
+  // a batch read ahead, with the sparse pulls of its keys in flight
+  struct PrefetchBatch {
+    // holds the feed vars of the batch
+    Scope* scope = nullptr;
+    int batch_size = 0;
+    std::map<uint64_t, std::vector<uint64_t>> features;
+    std::map<uint64_t, std::vector<std::vector<float>>> feature_values;
+    std::map<uint64_t, std::future<int32_t>> pull_status;
+  };
+  bool ReadPrefetchBatch(PrefetchBatch* batch);
+  void PullPrefetchBatch(PrefetchBatch* batch);
+
+  std::unique_ptr<PrefetchQueue<PrefetchBatch>> prefetch_queue_;
+  // the key vars of each table whose sparse values are pulled
+  std::map<uint64_t, std::vector<std::string>> prefetch_key_names_;
 };
 
 // Based on DownpourWorker, remove push pull code into operator
@@ -0,0 +1,150 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The batches DownpourWorker reads ahead of the training, see
+// FLAGS_downpour_prefetch_depth. Up to `depth` batches are read and their
+// sparse values pulled while a batch trains. With a max staleness s >= 0,
+// the pull of batch j waits for the sparse pushes of the batches up to
+// j - 1 - s, so a batch misses the pushes of at most s batches.
+namespace paddle {
+namespace framework {
+
+template <typename Batch>
+class PrefetchQueue {
+ public:
+  struct Callbacks {
+    // Reads the next batch into `batch`, whose buffer may be reused from
+    // an earlier batch. Returns false at the end of the reader.
+    std::function<bool(Batch* batch)> read;
+    // Starts the sparse pulls of a batch read.
+    std::function<void(Batch* batch)> pull;
+    // Frees the buffer of a batch that is no longer used.
+    std::function<void(Batch* batch)> release;
+  };
+
+  // A max staleness < 0 does not wait for the pushes.
+  PrefetchQueue(int depth, int max_staleness, Callbacks callbacks)
+      : depth_(depth),
+        max_staleness_(max_staleness),
+        callbacks_(std::move(callbacks)) {
+    // a batch pulled d batches ahead misses the pushes of the d batches
+    // trained meanwhile
+    if (max_staleness_ >= 0 && max_staleness_ < depth_) {
+      depth_ = max_staleness_;
+    }
+  }
+
+  ~PrefetchQueue() { End(); }
+
+  PrefetchQueue(const PrefetchQueue&) = delete;
+  PrefetchQueue& operator=(const PrefetchQueue&) = delete;
+
+  // Returns the batch to train next, or nullptr at the end of the reader.
+  // The batch returned before is done with.
+  Batch* Next() {
+    // the buffer of the batch trained last is free now
+    std::unique_ptr<Batch> free_batch = std::move(training_batch_);
+    while (!reader_end_ && static_cast<int>(batches_.size()) <= depth_) {
+      if (free_batch == nullptr) {
+        free_batch = std::make_unique<Batch>();
+      }
+      if (!callbacks_.read(free_batch.get())) {
+        reader_end_ = true;
+        break;
+      }
+      int64_t batch_id = read_cnt_++;
+      if (max_staleness_ >= 0) {
+        WaitPush(batch_id - 1 - max_staleness_);
+      }
+      callbacks_.pull(free_batch.get());
+      batches_.push_back(std::move(free_batch));
+    }
+    if (free_batch != nullptr) {
+      callbacks_.release(free_batch.get());
+    }
+    if (batches_.empty()) {
+      return nullptr;
+    }
+    training_batch_ = std::move(batches_.front());
+    batches_.pop_front();
+    ++train_cnt_;
+    return training_batch_.get();
+  }
+
+  // Records the sparse pushes of the batch returned last by Next.
+  void AddPush(std::vector<std::future<int32_t>> status) {
+    if (max_staleness_ < 0) {
+      return;
+    }
+    push_status_.emplace_back(train_cnt_ - 1, std::move(status));
+  }
+
+  // Waits for all the pushes and frees all the batches, the batches read
+  // ahead are dropped when the training stops before the reader ends.
+  void End() {
+    WaitPush(train_cnt_);
+    if (training_batch_ != nullptr) {
+      callbacks_.release(training_batch_.get());
+      training_batch_.reset();
+    }
+    for (auto& batch : batches_) {
+      callbacks_.release(batch.get());
+    }
+    batches_.clear();
+  }
+
+  int depth() const { return depth_; }
+  int max_staleness() const { return max_staleness_; }
+
+ private:
+  void WaitPush(int64_t batch_id) {
+    while (!push_status_.empty() && push_status_.front().first <= batch_id) {
+      for (auto& t : push_status_.front().second) {
+        if (t.valid()) {
+          t.wait();
+        }
+      }
+      push_status_.pop_front();
+    }
+  }
+
+  int depth_;
+  const int max_staleness_;
+  Callbacks callbacks_;
+  bool reader_end_ = false;
+  // the id of the next batch to read ahead
+  int64_t read_cnt_ = 0;
+  // the id of the next batch to train
+  int64_t train_cnt_ = 0;
+  // the batches read ahead, the front is trained next
+  std::deque<std::unique_ptr<Batch>> batches_;
+  // the batch in training, its buffer is reused once the next one starts
+  std::unique_ptr<Batch> training_batch_;
+  // the sparse pushes of the trained batches not yet waited for, by batch id
+  std::deque<std::pair<int64_t, std::vector<std::future<int32_t>>>>
+      push_status_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -17,6 +17,9 @@ limitations under the License. */
 #include "paddle/fluid/operators/isfinite_op.h"
 #include "paddle/fluid/platform/cpu_helper.h"
 
+COMMON_DECLARE_int32(downpour_prefetch_depth);
+COMMON_DECLARE_int32(downpour_prefetch_max_staleness);
+
 namespace phi {
 class DenseTensor;
 }  // namespace phi
@@ -452,6 +455,156 @@ void DownpourWorker::CopyDenseVars() {
   }
 }
 
+bool DownpourWorker::NeedPrefetch() {
+  if (FLAGS_downpour_prefetch_depth <= 0) {
+    return false;
+  }
+  // the dump and the table copy work on the last batch the reader read,
+  // which is no longer the batch in training
+  if (need_dump_field_ || copy_table_config_.need_copy()) {
+    VLOG(0) << "downpour prefetch is disabled with dump field or copy table";
+    return false;
+  }
+  return true;
+}
+
+void DownpourWorker::StartPrefetch() {
+  prefetch_key_names_.clear();
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    auto& key_names = prefetch_key_names_[tid];
+    for (size_t j = 0; j < sparse_key_names_[tid].size(); ++j) {
+      // skip slots which do not have embedding, as PullSparseVarsSync
+      if (thread_scope_->FindVar(sparse_value_names_[tid][j]) != nullptr) {
+        key_names.push_back(sparse_key_names_[tid][j]);
+      }
+    }
+  }
+  PrefetchQueue<PrefetchBatch>::Callbacks callbacks;
+  callbacks.read = [this](PrefetchBatch* batch) {
+    return ReadPrefetchBatch(batch);
+  };
+  callbacks.pull = [this](PrefetchBatch* batch) { PullPrefetchBatch(batch); };
+  callbacks.release = [this](PrefetchBatch* batch) {
+    if (batch->scope != nullptr) {
+      root_scope_->DeleteScope(batch->scope);
+      batch->scope = nullptr;
+    }
+  };
+  prefetch_queue_ = std::make_unique<PrefetchQueue<PrefetchBatch>>(
+      FLAGS_downpour_prefetch_depth,
+      FLAGS_downpour_prefetch_max_staleness,
+      std::move(callbacks));
+  if (prefetch_queue_->depth() < FLAGS_downpour_prefetch_depth) {
+    VLOG(0) << "downpour prefetch depth " << FLAGS_downpour_prefetch_depth
+            << " is bounded by max staleness "
+            << FLAGS_downpour_prefetch_max_staleness;
+  }
+}
+
+void DownpourWorker::EndPrefetch() {
+  prefetch_queue_->End();
+  prefetch_queue_.reset();
+  // the reader feeds the thread scope again
+  BindingDataFeedMemory();
+}
+
+bool DownpourWorker::ReadPrefetchBatch(PrefetchBatch* batch) {
+  if (batch->scope == nullptr) {
+    batch->scope = &root_scope_->NewScope();
+  }
+  for (auto const& name : device_reader_->GetUseSlotAlias()) {
+    device_reader_->AddFeedVar(batch->scope->Var(name), name);
+  }
+  batch->batch_size = device_reader_->Next();
+  return batch->batch_size > 0;
+}
+
+void DownpourWorker::PullPrefetchBatch(PrefetchBatch* batch) {
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    TableParameter table;
+    for (auto const& j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    batch->pull_status[tid] =
+        fleet_ptr_->PullSparseVarsAsync(*batch->scope,
+                                        tid,
+                                        prefetch_key_names_[tid],
+                                        &batch->features[tid],
+                                        &batch->feature_values[tid],
+                                        table.fea_dim());
+  }
+}
+
+int DownpourWorker::NextPrefetchedBatch() {
+  PrefetchBatch* batch = prefetch_queue_->Next();
+  if (batch == nullptr) {
+    return 0;
+  }
+
+  // the feed vars of the thread scope share the buffers of the batch
+  for (auto const& name : device_reader_->GetUseSlotAlias()) {
+    Variable* var = thread_scope_->FindVar(name);
+    if (var == nullptr) {
+      continue;
+    }
+    *var->GetMutable<phi::DenseTensor>() =
+        batch->scope->FindVar(name)->Get<phi::DenseTensor>();
+  }
+  for (int i = 0; i < param_.program_config(0).pull_sparse_table_id_size();
+       ++i) {
+    uint64_t tid = static_cast<uint64_t>(
+        param_.program_config(0).pull_sparse_table_id(i));
+    features_[tid].swap(batch->features[tid]);
+    feature_values_[tid].swap(batch->feature_values[tid]);
+    auto& status = batch->pull_status[tid];
+    // an invalid status means the pull was not started
+    if (status.valid()) {
+      int32_t ret = status.get();
+      if (ret == 0) {
+        continue;
+      }
+      VLOG(0) << "downpour prefetch pull sparse of table " << tid
+              << " failed with " << ret << ", pull it again";
+    }
+    TableParameter table;
+    for (auto const& j : param_.sparse_table()) {
+      if (j.table_id() == tid) {
+        table = j;
+        break;
+      }
+    }
+    fleet_ptr_->PullSparseVarsSync(*thread_scope_,
+                                   tid,
+                                   sparse_key_names_[tid],
+                                   &features_[tid],
+                                   &feature_values_[tid],
+                                   table.fea_dim(),
+                                   sparse_value_names_[tid]);
+  }
+  return batch->batch_size;
+}
+
+void DownpourWorker::AddPrefetchedSparsePush(size_t begin) {
+  if (prefetch_queue_->max_staleness() < 0) {
+    return;
+  }
+  std::vector<std::future<int32_t>> status;
+  for (size_t i = begin; i < push_sparse_status_.size(); ++i) {
+    status.push_back(std::move(push_sparse_status_[i]));
+  }
+  push_sparse_status_.resize(begin);
+  prefetch_queue_->AddPush(std::move(status));
+}
+
 void DownpourWorker::TrainFilesWithProfiler() {
   VLOG(3) << "Begin to train files with profiler";
   platform::SetNumThreads(1);
@@ -806,7 +959,12 @@ void DownpourWorker::TrainFiles() {
   device_reader_->Start();
   int batch_cnt = 0;
   int cur_batch = 0;
-  while ((cur_batch = device_reader_->Next()) > 0) {
+  bool prefetch = NeedPrefetch();
+  if (prefetch) {
+    StartPrefetch();
+  }
+  while ((cur_batch = prefetch ? NextPrefetchedBatch()
+                               : device_reader_->Next()) > 0) {
     if (copy_table_config_.need_copy()) {
       if (batch_cnt % copy_table_config_.batch_num() == 0) {
         CopySparseTable();
@@ -826,13 +984,16 @@ void DownpourWorker::TrainFiles() {
           break;
         }
       }
-      fleet_ptr_->PullSparseVarsSync(*thread_scope_,
-                                     tid,
-                                     sparse_key_names_[tid],
-                                     &features_[tid],
-                                     &feature_values_[tid],
-                                     table.fea_dim(),
-                                     sparse_value_names_[tid]);
+      // the values of a prefetched batch are pulled already
+      if (!prefetch) {
+        fleet_ptr_->PullSparseVarsSync(*thread_scope_,
+                                       tid,
+                                       sparse_key_names_[tid],
+                                       &features_[tid],
+                                       &feature_values_[tid],
+                                       table.fea_dim(),
+                                       sparse_value_names_[tid]);
+      }
       CollectLabelInfo(i);
       FillSparseValue(i);
       auto nid_iter = std::find(sparse_value_names_[tid].begin(),
@@ -930,6 +1091,7 @@ void DownpourWorker::TrainFiles() {
                             "phi::DenseTensor %s contains NAN.", var_name));
     }
 
+    size_t sparse_push_begin = push_sparse_status_.size();
     if (need_to_push_sparse_) {
       // push gradients here
       for (int i = 0; i < param_.program_config(0).push_sparse_table_id_size();
@@ -961,6 +1123,9 @@ void DownpourWorker::TrainFiles() {
             scale_sparse_gradient_with_batch_size_);
       }
     }
+    if (prefetch) {
+      AddPrefetchedSparsePush(sparse_push_begin);
+    }
 
 #ifdef PADDLE_WITH_PSLIB
     if (copy_table_config_.need_copy()) {
@@ -1073,6 +1238,9 @@ void DownpourWorker::TrainFiles() {
     thread_scope_->DropKids();
     ++batch_cnt;
   }
+  if (prefetch) {
+    EndPrefetch();
+  }
   if (need_dump_field_ || need_dump_param_) {
     writer_.Flush();
   }
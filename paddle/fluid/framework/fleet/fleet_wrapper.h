@@ -60,7 +60,8 @@ namespace framework {
 // interface design principles:
 // Pull
 //   Sync: PullSparseVarsSync
-//   Async: PullSparseVarsAsync(not implemented currently)
+//   Async: PullSparseVarsAsync(fills the keys and values only, used by the
+//          prefetch of DownpourWorker)
 // Push
 //   Sync: PushSparseVarsSync
 //   Async: PushSparseVarsAsync(not implemented currently)
@@ -0,0 +1,241 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/mmap_params.h"
+
+#include <cstring>
+#include <fstream>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+template <typename T>
+void WritePod(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+size_t AlignUp(size_t offset, size_t alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+size_t DataSize(const phi::DenseTensor& tensor) {
+  return static_cast<size_t>(tensor.numel()) * phi::SizeOf(tensor.dtype());
+}
+
+size_t RecordSize(const phi::DenseTensor& tensor) {
+  size_t size = sizeof(int32_t) * 2 + sizeof(int64_t) * tensor.dims().size() +
+                sizeof(uint64_t);
+  for (auto& level : tensor.lod()) {
+    size += sizeof(uint64_t) * (level.size() + 1);
+  }
+  return size + sizeof(uint64_t) * 2;
+}
+
+// Reads the header and the records of a mapped file, every read is checked
+// against the end of the file.
+class RecordParser {
+ public:
+  RecordParser(const char* data, size_t size, const std::string& file_path)
+      : data_(data), size_(size), file_path_(file_path) {}
+
+  template <typename T>
+  T Read() {
+    PADDLE_ENFORCE_LE(
+        pos_ + sizeof(T),
+        size_,
+        phi::errors::InvalidArgument(
+            "The mmap params file %s is truncated, please check whether it "
+            "is complete or damaged.",
+            file_path_));
+    T value;
+    memcpy(&value, data_ + pos_, sizeof(T));
+    pos_ += sizeof(T);
+    return value;
+  }
+
+ private:
+  const char* data_;
+  size_t size_;
+  const std::string& file_path_;
+  size_t pos_ = 0;
+};
+
+}  // namespace
+
+bool IsMmapParamsFile(const std::string& file_path) {
+  std::ifstream fin(file_path, std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  char magic[sizeof(kMmapParamsMagic)];
+  fin.read(magic, sizeof(magic));
+  return fin.gcount() == sizeof(magic) &&
+         memcmp(magic, kMmapParamsMagic, sizeof(magic)) == 0;
+}
+
+size_t ConvertToMmapParams(const std::string& params_file,
+                           const std::string& mmap_params_file,
+                           size_t alignment) {
+  PADDLE_ENFORCE_EQ(
+      alignment > 0 && (alignment & (alignment - 1)) == 0,
+      true,
+      phi::errors::InvalidArgument(
+          "The alignment of the mmap params must be a power of 2, but got %d.",
+          alignment));
+  std::ifstream fin(params_file, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
+                    true,
+                    phi::errors::Unavailable(
+                        "Cannot open %s to convert, please check whether the "
+                        "params file exists.",
+                        params_file));
+  std::vector<phi::DenseTensor> tensors;
+  while (fin.peek() != EOF) {
+    tensors.emplace_back();
+    DeserializeFromStream(fin, &tensors.back());
+  }
+
+  size_t offset = sizeof(kMmapParamsMagic) + sizeof(uint32_t) * 2 +
+                  sizeof(uint64_t);
+  for (auto& tensor : tensors) {
+    offset += RecordSize(tensor);
+  }
+  std::vector<uint64_t> data_offsets;
+  for (auto& tensor : tensors) {
+    offset = AlignUp(offset, alignment);
+    data_offsets.push_back(offset);
+    offset += DataSize(tensor);
+  }
+
+  std::ofstream fout(mmap_params_file, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout),
+                    true,
+                    phi::errors::Unavailable("Cannot open %s to write.",
+                                             mmap_params_file));
+  fout.write(kMmapParamsMagic, sizeof(kMmapParamsMagic));
+  WritePod(fout, static_cast<uint32_t>(alignment));
+  WritePod(fout, static_cast<uint32_t>(0));
+  WritePod(fout, static_cast<uint64_t>(tensors.size()));
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto& tensor = tensors[i];
+    WritePod(fout, static_cast<int32_t>(tensor.dtype()));
+    WritePod(fout, static_cast<int32_t>(tensor.dims().size()));
+    for (int j = 0; j < tensor.dims().size(); ++j) {
+      WritePod(fout, static_cast<int64_t>(tensor.dims()[j]));
+    }
+    WritePod(fout, static_cast<uint64_t>(tensor.lod().size()));
+    for (auto& level : tensor.lod()) {
+      WritePod(fout, static_cast<uint64_t>(level.size()));
+      for (size_t value : level) {
+        WritePod(fout, static_cast<uint64_t>(value));
+      }
+    }
+    WritePod(fout, data_offsets[i]);
+    WritePod(fout, static_cast<uint64_t>(DataSize(tensor)));
+  }
+  const std::string padding(alignment, '\0');
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    size_t pos = static_cast<size_t>(fout.tellp());
+    fout.write(padding.data(), data_offsets[i] - pos);
+    if (DataSize(tensors[i]) > 0) {
+      fout.write(static_cast<const char*>(tensors[i].data()),
+                 DataSize(tensors[i]));
+    }
+  }
+  fout.close();
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout),
+                    true,
+                    phi::errors::Unavailable("Fail to write the mmap params "
+                                             "file %s.",
+                                             mmap_params_file));
+  VLOG(3) << "Converted " << tensors.size() << " tensors of " << params_file
+          << " to " << mmap_params_file;
+  return tensors.size();
+}
+
+MmapParamsReader::MmapParamsReader(const std::string& file_path) {
+#ifndef _WIN32
+  file_ = memory::allocation::AllocateMemoryMapFileAllocation(file_path);
+  RecordParser parser(
+      static_cast<const char*>(file_->ptr()), file_->size(), file_path);
+  char magic[sizeof(kMmapParamsMagic)];
+  for (auto& c : magic) {
+    c = parser.Read<char>();
+  }
+  PADDLE_ENFORCE_EQ(
+      memcmp(magic, kMmapParamsMagic, sizeof(magic)),
+      0,
+      phi::errors::InvalidArgument("%s is not a mmap params file.", file_path));
+  parser.Read<uint32_t>();  // alignment
+  parser.Read<uint32_t>();  // reserved
+  uint64_t tensor_num = parser.Read<uint64_t>();
+  for (uint64_t i = 0; i < tensor_num; ++i) {
+    Record record;
+    record.dtype = static_cast<phi::DataType>(parser.Read<int32_t>());
+    int32_t rank = parser.Read<int32_t>();
+    for (int32_t j = 0; j < rank; ++j) {
+      record.dims.push_back(parser.Read<int64_t>());
+    }
+    uint64_t lod_level = parser.Read<uint64_t>();
+    record.lod.resize(lod_level);
+    for (auto& level : record.lod) {
+      uint64_t length = parser.Read<uint64_t>();
+      for (uint64_t j = 0; j < length; ++j) {
+        level.push_back(static_cast<size_t>(parser.Read<uint64_t>()));
+      }
+    }
+    record.data_offset = parser.Read<uint64_t>();
+    record.data_size = parser.Read<uint64_t>();
+    PADDLE_ENFORCE_LE(
+        record.data_offset + record.data_size,
+        file_->size(),
+        phi::errors::InvalidArgument(
+            "The data of tensor %d is out of the mmap params file %s, please "
+            "check whether it is complete or damaged.",
+            i,
+            file_path));
+    records_.push_back(std::move(record));
+  }
+#else
+  PADDLE_THROW(phi::errors::Unimplemented(
+      "Loading mmap params is not supported on Windows."));
+#endif
+}
+
+void MmapParamsReader::GetTensor(size_t i, phi::DenseTensor* tensor) const {
+  PADDLE_ENFORCE_LT(
+      i,
+      records_.size(),
+      phi::errors::OutOfRange("The mmap params file has %d tensors, but the "
+                              "tensor %d is requested.",
+                              records_.size(),
+                              i));
+#ifndef _WIN32
+  const Record& record = records_[i];
+  tensor->set_meta(
+      phi::DenseTensorMeta(record.dtype, common::make_ddim(record.dims)));
+  tensor->set_lod(record.lod);
+  tensor->ResetHolder(memory::allocation::MemoryMapFileView(
+      file_, record.data_offset, record.data_size));
+#endif
+}
+
+}  // namespace framework
+}  // namespace paddle
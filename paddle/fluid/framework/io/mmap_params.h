@@ -0,0 +1,89 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/phi/core/dense_tensor.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+class MemoryMapFileAllocation;
+}  // namespace allocation
+}  // namespace memory
+
+namespace framework {
+
+/*
+ * A combined params file that can be memory mapped. The tensors are stored in
+ * the same order as in a .pdiparams file, but the data of every tensor starts
+ * at an aligned offset, so a CPU tensor can use the mapped pages directly
+ * instead of a copy.
+ *
+ * Layout, integers in host byte order:
+ *   char     magic[8]          "PDMMAPV1"
+ *   uint32_t alignment
+ *   uint32_t reserved
+ *   uint64_t tensor_num
+ *   tensor_num records of
+ *     int32_t  dtype           phi::DataType
+ *     int32_t  rank
+ *     int64_t  dims[rank]
+ *     uint64_t lod_level
+ *     lod_level records of     uint64_t length, uint64_t offsets[length]
+ *     uint64_t data_offset     from the beginning of the file
+ *     uint64_t data_size       in bytes
+ *   padding and tensor data
+ */
+constexpr char kMmapParamsMagic[8] = {'P', 'D', 'M', 'M', 'A', 'P', 'V', '1'};
+constexpr size_t kMmapParamsAlignment = 64;
+
+bool IsMmapParamsFile(const std::string& file_path);
+
+// Converts a combined params file (.pdiparams) of dense tensors into the
+// mmap params format, returns the number of converted tensors.
+size_t ConvertToMmapParams(const std::string& params_file,
+                           const std::string& mmap_params_file,
+                           size_t alignment = kMmapParamsAlignment);
+
+class MmapParamsReader {
+ public:
+  explicit MmapParamsReader(const std::string& file_path);
+
+  size_t TensorNum() const { return records_.size(); }
+
+  // Makes `tensor` a CPU tensor backed by the mapped pages of the i-th
+  // tensor, nothing is copied.
+  void GetTensor(size_t i, phi::DenseTensor* tensor) const;
+
+ private:
+  struct Record {
+    phi::DataType dtype;
+    std::vector<int64_t> dims;
+    phi::LoD lod;
+    uint64_t data_offset;
+    uint64_t data_size;
+  };
+
+  std::shared_ptr<memory::allocation::MemoryMapFileAllocation> file_;
+  std::vector<Record> records_;
+};
+
+}  // namespace framework
+}  // namespace paddle
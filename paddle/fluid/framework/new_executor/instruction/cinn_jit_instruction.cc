@@ -16,6 +16,7 @@
 
 #include "paddle/cinn/hlir/dialect/runtime/ir/jit_kernel_op.h"
 #include "paddle/cinn/hlir/dialect/runtime/ir/runtime_dialect.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specializer.h"
 #include "paddle/cinn/hlir/framework/pir_compiler.h"
 #include "paddle/common/errors.h"
 #include "paddle/common/performance_statistician.h"
@@ -27,6 +28,8 @@ PD_DECLARE_bool(cinn_bucket_compile);
 PD_DECLARE_bool(cinn_measure_kernel_time);
 PD_DECLARE_string(tile_config_policy);
 PD_DECLARE_string(cinn_kernel_execution_label);
+PD_DECLARE_int32(cinn_max_shape_specializations);
+PD_DECLARE_int32(cinn_shape_specialization_threshold);
 
 namespace paddle {
 namespace framework {
@@ -223,6 +226,58 @@ CinnJitInstruction::CinnJitInstruction(
     }
     tensor->Resize(alloc_tensor_type.dims());
   }
+
+  if (cinn::hlir::framework::ShapeSpecializer::IsEnabled() &&
+      cinn::hlir::framework::ShapeSpecializer::Instance().IsRegistered(
+          jit_kernel_op.cinn_kernel_info().fn_name)) {
+    shape_variants_ = std::make_shared<ShapeVariantSet>(
+        FLAGS_cinn_max_shape_specializations,
+        FLAGS_cinn_shape_specialization_threshold);
+  }
+}
+
+std::shared_ptr<CinnJitInstruction::FnPtrImpl>
+CinnJitInstruction::SelectFnPtrImpl() {
+  if (!shape_variants_) return fn_ptr_impl_;
+  // Rank and dims of every input.
+  shape_signature_.clear();
+  for (int32_t i = 0; i < input_tensor_size; ++i) {
+    const auto& dims = tensor_args_[i]->dims();
+    shape_signature_.push_back(dims.size());
+    for (int j = 0; j < dims.size(); ++j) {
+      shape_signature_.push_back(dims[j]);
+    }
+  }
+  auto variant = shape_variants_->Select(
+      shape_signature_, [this](const std::vector<int64_t>& signature) {
+        RequestShapeVariant(signature);
+      });
+  return variant ? variant : fn_ptr_impl_;
+}
+
+void CinnJitInstruction::RequestShapeVariant(
+    const std::vector<int64_t>& signature) {
+  std::vector<std::vector<int64_t>> input_dims;
+  for (int32_t i = 0; i < input_tensor_size; ++i) {
+    input_dims.push_back(common::vectorize(tensor_args_[i]->dims()));
+  }
+  std::weak_ptr<ShapeVariantSet> weak_variants = shape_variants_;
+  const auto& fn_name =
+      op_->dyn_cast<cinn::dialect::JitKernelOp>().cinn_kernel_info().fn_name;
+  VLOG(4) << "Request a static-shape variant of " << fn_name;
+  cinn::hlir::framework::ShapeSpecializer::Instance().SpecializeAsync(
+      fn_name,
+      input_dims,
+      [weak_variants, signature](
+          const std::optional<cinn::hlir::framework::pir::CINNKernelInfo>&
+              kernel_info) {
+        // The instruction may be gone by now.
+        auto variants = weak_variants.lock();
+        if (!variants) return;
+        variants->Finish(signature,
+                         kernel_info ? std::make_shared<FnPtrImpl>(*kernel_info)
+                                     : nullptr);
+      });
 }
 
 void CinnJitInstruction::Run() {
@@ -236,8 +291,10 @@ void CinnJitInstruction::Run() {
         static_cast<void*>(static_cast<phi::GPUContext*>(dev_ctx_)->stream());
   }
 
+  // 1. pick the kernel for the input shapes
+  const auto fn_ptr_impl = SelectFnPtrImpl();
   if (FLAGS_cinn_bucket_compile && need_update_shape) {
-    fn_ptr_impl_->InferShape(
+    fn_ptr_impl->InferShape(
         tensor_args_, input_tensor_size, output_tensor_size);
   }
   for (size_t i = 0; i < tensor_args_.size(); ++i) {
@@ -245,7 +302,7 @@ void CinnJitInstruction::Run() {
   }
 
   // 2. exexute kernel
-  fn_ptr_impl_->Run(tensor_args_, running_stream, is_gpu);
+  fn_ptr_impl->Run(tensor_args_, running_stream, is_gpu);
 #else
   VLOG(0) << "Not Supported: cinn jit instruction currently does not "
              "support non-CUDA kernel";
@@ -15,6 +15,8 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include "paddle/cinn/hlir/framework/pir/shape_variant_set.h"
 #include "paddle/fluid/framework/new_executor/instruction/instruction_base.h"
 
 namespace pir {
@@ -43,8 +45,21 @@ class CinnJitInstruction : public InstructionBase {
  private:
   class FnPtrImpl;
 
+  // The static-shape variants of the kernel, compiled by
+  // cinn::hlir::framework::ShapeSpecializer.
+  using ShapeVariantSet = cinn::hlir::framework::ShapeVariantSet<FnPtrImpl>;
+
+  // Returns the variant for the input shapes of this run if there is one,
+  // otherwise the dynamic-shape kernel.
+  std::shared_ptr<FnPtrImpl> SelectFnPtrImpl();
+  void RequestShapeVariant(const std::vector<int64_t>& signature);
+
   std::shared_ptr<FnPtrImpl> fn_ptr_impl_{nullptr};
 
+  // Null if the kernel is not specialized.
+  std::shared_ptr<ShapeVariantSet> shape_variants_;
+  std::vector<int64_t> shape_signature_;
+
   phi::Place place_;
 
   phi::DeviceContext* dev_ctx_;
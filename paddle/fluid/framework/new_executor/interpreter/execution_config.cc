@@ -23,6 +23,7 @@
 #include "paddle/phi/backends/xpu/xpu_info.h"
 
 PD_DECLARE_bool(new_executor_serial_run);
+PD_DECLARE_bool(new_executor_numa_aware);
 
 namespace paddle::framework::interpreter {
 
@@ -116,6 +117,9 @@ void ExecutionConfig::AnalyzeThreadPoolConfig(const phi::Place& place,
     std::tie(host_num_threads, device_num_threads) =
         GetThreadPoolConfig(place, op_num);
   }
+  if (FLAGS_new_executor_numa_aware && !FLAGS_new_executor_serial_run) {
+    numa_aware_scheduling = true;
+  }
 }
 
 void ExecutionConfig::Log(int log_level) {
@@ -126,7 +130,8 @@ void ExecutionConfig::Log(int log_level) {
           << "used_for_control_flow_op = " << used_for_control_flow_op << "\n"
           << "used_for_jit = " << used_for_jit << "\n"
           << "device_num_threads = " << device_num_threads << "\n"
-          << "host_num_threads = " << host_num_threads << "\n";
+          << "host_num_threads = " << host_num_threads << "\n"
+          << "numa_aware_scheduling = " << numa_aware_scheduling << "\n";
 
   log_str << "force_root_scope_vars = [";
   for (const std::string& var : force_root_scope_vars) {
@@ -35,6 +35,10 @@ struct ExecutionConfig {
   size_t device_num_threads{0};
   size_t host_num_threads{0};
 
+  // Use per NUMA node thread groups for the host work queue, see
+  // WorkQueueOptions::numa_aware.
+  bool numa_aware_scheduling{false};
+
   std::set<std::string> force_root_scope_vars;
   std::set<std::string> jit_input_vars;
   std::set<std::string> skip_gc_vars;
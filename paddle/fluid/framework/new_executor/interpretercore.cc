@@ -23,6 +23,11 @@ PHI_DEFINE_EXPORTED_bool(
     new_executor_serial_run,
     false,
     "Enable serial execution for standalone executor, used for debug.");
+PHI_DEFINE_EXPORTED_bool(
+    new_executor_numa_aware,
+    false,
+    "Split the host work queue of standalone executor into per NUMA node "
+    "thread groups which steal work inside the node first.");
 PHI_DEFINE_EXPORTED_bool(
     new_executor_static_build,
     false,
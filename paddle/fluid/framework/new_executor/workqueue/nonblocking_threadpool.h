@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
 #include <cstdlib>
 #include <vector>
@@ -17,6 +18,7 @@
 #include "paddle/fluid/framework/new_executor/workqueue/event_count.h"
 #include "paddle/fluid/framework/new_executor/workqueue/run_queue.h"
 #include "paddle/fluid/framework/new_executor/workqueue/thread_environment.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 #include "paddle/fluid/platform/os_info.h"
 #include "paddle/fluid/platform/profiler/event_tracing.h"
 
@@ -33,6 +35,7 @@ class ThreadPoolTempl {
                   int num_threads,
                   bool allow_spinning,
                   bool always_spinning,
+                  bool numa_aware = false,
                   Environment env = Environment())
       : env_(env),
         allow_spinning_(allow_spinning),
@@ -58,8 +61,16 @@ class ThreadPoolTempl {
       all_coprimes_.emplace_back(i);
       ComputeCoprimes(i, &(all_coprimes_.back()));
     }
+    // In numa aware mode the threads are split into one group per NUMA node,
+    // each group is pinned to its node and steals inside the group first.
+    if (numa_aware) {
+      InitNumaPartitions();
+    }
     for (int i = 0; i < num_threads_; i++) {
-      SetStealPartition(i, EncodePartition(0, num_threads_));
+      int node = thread_data_[i].numa_node;
+      SetStealPartition(i,
+                        node >= 0 ? numa_partitions_[node]
+                                  : EncodePartition(0, num_threads_));
       thread_data_[i].thread.reset(
           env_.CreateThread([this, i]() { WorkerLoop(i); }));
     }
@@ -102,19 +113,35 @@ class ThreadPoolTempl {
   }
 
   void AddTask(std::function<void()> fn) {
-    AddTaskWithHint(std::move(fn), 0, num_threads_);
+    // Keep the task on the NUMA node of the producer, so that the consumer
+    // reads the producer's outputs from a near cache / memory.
+    AddTaskOnNumaNode(std::move(fn), CurrentThreadNumaNode());
+  }
+
+  // Schedules the task onto the threads of `numa_node`. Falls back to the
+  // whole pool if the pool is not numa aware or the node is unknown.
+  void AddTaskOnNumaNode(std::function<void()> fn, int numa_node) {
+    if (numa_node >= 0 &&
+        numa_node < static_cast<int>(numa_partitions_.size())) {
+      unsigned start, limit;
+      DecodePartition(numa_partitions_[numa_node], &start, &limit);
+      AddTaskWithHint(std::move(fn), start, limit);
+    } else {
+      AddTaskWithHint(std::move(fn), 0, num_threads_);
+    }
   }
 
   void AddTaskWithHint(std::function<void()> fn, int start, int limit) {
     Task t = env_.CreateTask(std::move(fn));
     PerThread* pt = GetPerThread();
-    if (pt->pool == this) {
-      // Worker thread of this pool, push onto the thread's queue.
+    if (pt->pool == this && pt->thread_id >= start && pt->thread_id < limit) {
+      // Worker thread of this pool inside the hinted range, push onto the
+      // thread's queue.
       Queue& q = thread_data_[pt->thread_id].queue;
       t = q.PushFront(std::move(t));
     } else {
-      // A free-standing thread (or worker of another pool), push onto a random
-      // queue.
+      // A free-standing thread, a worker of another pool or a worker outside
+      // the hinted range, push onto a random queue of the range.
       assert(start < limit);
       assert(limit <= num_threads_);
       int num_queues = limit - start;
@@ -156,6 +183,9 @@ class ThreadPoolTempl {
 
   size_t NumThreads() const { return num_threads_; }
 
+  // Number of NUMA thread groups, 0 if the pool is not numa aware.
+  size_t NumNumaNodes() const { return numa_partitions_.size(); }
+
   int CurrentThreadId() const {
     const PerThread* pt = const_cast<ThreadPoolTempl*>(this)->GetPerThread();
     if (pt->pool == this) {
@@ -165,6 +195,13 @@ class ThreadPoolTempl {
     }
   }
 
+  // The NUMA node of the calling thread in this pool, -1 if the caller is not
+  // a worker of this pool or the pool is not numa aware.
+  int CurrentThreadNumaNode() const {
+    int thread_id = CurrentThreadId();
+    return thread_id >= 0 ? thread_data_[thread_id].numa_node : -1;
+  }
+
  private:
   // Create a single atomic<int> that encodes start and limit information for
   // each thread.
@@ -200,6 +237,28 @@ class ThreadPoolTempl {
     return thread_data_[i].steal_partition.load(std::memory_order_relaxed);
   }
 
+  void InitNumaPartitions() {
+    numa_node_cpus_ = GetNumaNodeCpus();
+    int num_nodes =
+        std::min(static_cast<int>(numa_node_cpus_.size()), num_threads_);
+    if (num_nodes <= 1) {
+      // Single socket, the plain work stealing pool is already optimal.
+      numa_node_cpus_.clear();
+      return;
+    }
+    const auto ranges = SplitThreadsByNumaNode(num_threads_, num_nodes);
+    for (int node = 0; node < num_nodes; ++node) {
+      const auto [start, limit] = ranges[node];
+      AssertBounds(start, limit);
+      numa_partitions_.push_back(EncodePartition(start, limit));
+      for (unsigned i = start; i < limit; ++i) {
+        thread_data_[i].numa_node = node;
+      }
+    }
+    VLOG(1) << name_ << " is numa aware, " << num_threads_
+            << " threads are split into " << num_nodes << " nodes";
+  }
+
   inline void ComputeCoprimes(int n, std::vector<unsigned>* coprimes) {
     for (int i = 1; i <= n; i++) {
       unsigned a = i;
@@ -226,9 +285,11 @@ class ThreadPoolTempl {
   };
 
   struct ThreadData {
-    constexpr ThreadData() : thread(), steal_partition(0), queue() {}
+    constexpr ThreadData()
+        : thread(), steal_partition(0), numa_node(-1), queue() {}
     std::unique_ptr<Thread> thread;
     std::atomic<unsigned> steal_partition;
+    int numa_node;  // -1 if the pool is not numa aware
     Queue queue;
   };
 
@@ -244,12 +305,20 @@ class ThreadPoolTempl {
   const int num_threads_;
   std::vector<ThreadData> thread_data_;
   std::string name_;
+  // Encoded [start, limit) thread range and cpus of each NUMA node.
+  std::vector<unsigned> numa_partitions_;
+  std::vector<std::vector<int>> numa_node_cpus_;
 
   // Main worker thread loop.
   void WorkerLoop(int thread_id) {
     std::string thr_name = name_ + "_thread_" + std::to_string(thread_id);
     VLOG(1) << thr_name << " started ";
     platform::SetCurrentThreadName(thr_name);
+    int numa_node = thread_data_[thread_id].numa_node;
+    if (numa_node >= 0 &&
+        !BindCurrentThreadToCpus(numa_node_cpus_[numa_node])) {
+      VLOG(1) << thr_name << " failed to bind to numa node " << numa_node;
+    }
     PerThread* pt = GetPerThread();
     pt->pool = this;
     pt->rand = GlobalThreadIdHash();
@@ -102,6 +102,10 @@ struct WorkQueueOptions {
   // false and set events_waiter.
   bool detached{true};
   EventsWaiter* events_waiter{nullptr};  // not owned
+  // Split the worker threads into one group per NUMA node. Threads are pinned
+  // to their node, steal inside the node first, and tasks added by a pinned
+  // thread stay on the node of that thread.
+  bool numa_aware{false};
 };
 
 class WorkQueue {
@@ -16,6 +16,14 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace paddle::framework {
 
@@ -55,4 +63,80 @@ void AlignedFree(void* mem_ptr) {
 #endif
 }
 
+std::vector<int> ParseCpuList(const std::string& cpulist) {
+  std::vector<int> cpus;
+  std::stringstream ss(cpulist);
+  std::string range;
+  while (std::getline(ss, range, ',')) {
+    if (range.empty() || range == "\n") {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::atoi(range.substr(0, dash).c_str());
+    int last =
+        dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+std::vector<std::pair<unsigned, unsigned>> SplitThreadsByNumaNode(
+    int num_threads, int num_nodes) {
+  std::vector<std::pair<unsigned, unsigned>> ranges;
+  unsigned start = 0;
+  for (int node = 0; node < num_nodes; ++node) {
+    unsigned limit = start + num_threads / num_nodes +
+                     (node < num_threads % num_nodes ? 1 : 0);
+    ranges.emplace_back(start, limit);
+    start = limit;
+  }
+  return ranges;
+}
+
+std::vector<std::vector<int>> GetNumaNodeCpus() {
+  std::vector<std::vector<int>> node_cpus;
+#if defined(__linux__)
+  for (int node = 0;; ++node) {
+    std::ifstream fin("/sys/devices/system/node/node" + std::to_string(node) +
+                      "/cpulist");
+    if (!fin.is_open()) {
+      break;
+    }
+    std::string cpulist;
+    std::getline(fin, cpulist);
+    std::vector<int> cpus = ParseCpuList(cpulist);
+    // Memory-only nodes (e.g. CXL or HBM) have no cpus to schedule on.
+    if (!cpus.empty()) {
+      node_cpus.emplace_back(std::move(cpus));
+    }
+  }
+#endif
+  if (node_cpus.empty()) {
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+    node_cpus.emplace_back();
+    for (int cpu = 0; cpu < num_cpus; ++cpu) {
+      node_cpus.back().push_back(cpu);
+    }
+  }
+  return node_cpus;
+}
+
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus) {
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &cpuset);
+    }
+  }
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) ==
+         0;
+#else
+  return false;
+#endif
+}
+
 }  // namespace paddle::framework
@@ -21,6 +21,8 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "paddle/fluid/framework/new_executor/workqueue/events_waiter.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -69,6 +71,23 @@ void* AlignedMalloc(size_t size, size_t alignment);
 
 void AlignedFree(void* memory_ptr);
 
+// Parses a sysfs cpulist such as "0-15,32-47".
+std::vector<int> ParseCpuList(const std::string& cpulist);
+
+// Splits `num_threads` threads into one contiguous [start, limit) range per
+// NUMA node. The first num_threads % num_nodes nodes get one more thread.
+std::vector<std::pair<unsigned, unsigned>> SplitThreadsByNumaNode(
+    int num_threads, int num_nodes);
+
+// Returns the cpu ids of every NUMA node, read from sysfs on Linux. On other
+// platforms (or if the topology is unavailable) a single node holding all
+// hardware threads is returned.
+std::vector<std::vector<int>> GetNumaNodeCpus();
+
+// Pins the calling thread to `cpus`. Returns false if the affinity could not
+// be changed.
+bool BindCurrentThreadToCpus(const std::vector<int>& cpus);
+
 template <typename Notifier>
 class TaskTracker {
  public:
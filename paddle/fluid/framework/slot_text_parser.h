@@ -0,0 +1,195 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Number parsing for the slot text format of the MultiSlot and SlotRecord
+// data feeds, "num v_1 ... v_num num v_1 ...". The common cases, decimal
+// ids and short decimal floats, are parsed eight digits at a time in a
+// 64-bit word; everything else falls back to strtoull and strtof, so the
+// results are always those of the C library.
+//
+// The functions read [p, end). The char at `end` must be readable and must
+// not continue the number, like the '\0' or '\n' that ends a line.
+namespace paddle {
+namespace framework {
+namespace slot_text {
+
+inline bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+inline const char* SkipSpaces(const char* p, const char* end) {
+  while (p < end && IsSpace(*p)) {
+    ++p;
+  }
+  return p;
+}
+
+namespace detail {
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+// Whether the 8 chars loaded in `v` are all decimal digits.
+inline bool IsEightDigits(uint64_t v) {
+  return ((v & 0xF0F0F0F0F0F0F0F0ULL) |
+          (((v + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+// The value of the 8 decimal digits loaded in `v`, the first digit is the
+// most significant one.
+inline uint32_t ParseEightDigits(uint64_t v) {
+  const uint64_t mask = 0x000000FF000000FFULL;
+  const uint64_t mul1 = 0x000F424000000064ULL;  // 100 + (1000000 << 32)
+  const uint64_t mul2 = 0x0000271000000001ULL;  // 1 + (10000 << 32)
+  v -= 0x3030303030303030ULL;
+  v = (v * 10) + (v >> 8);
+  v = (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
+  return static_cast<uint32_t>(v);
+}
+#endif
+
+// Accumulates the digits at `p` into `value` and returns the end of them.
+// `digits` counts the digits read, `value` is only exact while it is at
+// most 19.
+inline const char* ParseDigits(const char* p,
+                               const char* end,
+                               uint64_t* value,
+                               int* digits) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  while (end - p >= 8) {
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    if (!IsEightDigits(v)) {
+      break;
+    }
+    *value = *value * 100000000 + ParseEightDigits(v);
+    *digits += 8;
+    p += 8;
+  }
+#endif
+  while (p < end && static_cast<unsigned char>(*p - '0') < 10) {
+    *value = *value * 10 + (*p - '0');
+    ++*digits;
+    ++p;
+  }
+  return p;
+}
+
+}  // namespace detail
+
+// Parses an unsigned decimal like strtoull(p, &ret, 10).
+inline const char* ParseUInt64(const char* p, const char* end, uint64_t* v) {
+  const char* start = SkipSpaces(p, end);
+  uint64_t value = 0;
+  int digits = 0;
+  const char* q = detail::ParseDigits(start, end, &value, &digits);
+  if (digits == 0 || digits > 19) {
+    // A sign, no digit or a possible overflow.
+    char* endptr = nullptr;
+    *v = strtoull(p, &endptr, 10);
+    return endptr;
+  }
+  *v = value;
+  return q;
+}
+
+// Parses a decimal like strtol(p, &ret, 10), for the counts of the slots.
+inline const char* ParseInt(const char* p, const char* end, int* v) {
+  uint64_t value = 0;
+  const char* start = SkipSpaces(p, end);
+  int digits = 0;
+  const char* q = detail::ParseDigits(start, end, &value, &digits);
+  if (digits == 0 || digits > 9) {
+    char* endptr = nullptr;
+    *v = static_cast<int>(strtol(p, &endptr, 10));
+    return endptr;
+  }
+  *v = static_cast<int>(value);
+  return q;
+}
+
+// Parses a float like strtof(p, &ret). "[-]digits[.digits]" with at most
+// 24 bits of mantissa and 10 digits of scale is computed with one exactly
+// rounded float operation, the rest goes to strtof.
+inline const char* ParseFloat(const char* p, const char* end, float* v) {
+  static constexpr float kPow10[] = {
+      1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+  const char* q = SkipSpaces(p, end);
+  bool negative = false;
+  if (q < end && *q == '-') {
+    negative = true;
+    ++q;
+  }
+  uint64_t mantissa = 0;
+  int digits = 0;
+  q = detail::ParseDigits(q, end, &mantissa, &digits);
+  int scale = 0;
+  if (q < end && *q == '.') {
+    int int_digits = digits;
+    q = detail::ParseDigits(q + 1, end, &mantissa, &digits);
+    scale = digits - int_digits;
+  }
+  bool fast = digits > 0 && digits <= 19 && scale <= 10 &&
+              mantissa <= (uint64_t(1) << 24);
+  if (fast && q < end) {
+    // An exponent, or "inf" or "nan" after the sign.
+    char c = *q;
+    fast = c != 'e' && c != 'E' && c != 'x' && c != 'X';
+  }
+  if (!fast) {
+    char* endptr = nullptr;
+    *v = strtof(p, &endptr);
+    return endptr;
+  }
+  float value = static_cast<float>(mantissa) / kPow10[scale];
+  *v = negative ? -value : value;
+  return q;
+}
+
+// Splits [data, data + size) into at most `parts` ranges that begin at the
+// start of a line, for parsing a block of lines in parallel. Returns the
+// offsets of the boundaries, the first is 0 and the last is `size`.
+inline std::vector<size_t> SplitLines(const char* data,
+                                      size_t size,
+                                      size_t parts) {
+  std::vector<size_t> bounds(1, 0);
+  for (size_t i = 1; i < parts; ++i) {
+    size_t pos = size / parts * i;
+    if (pos <= bounds.back()) {
+      continue;
+    }
+    const void* nl = std::memchr(data + pos - 1, '\n', size - pos + 1);
+    if (nl == nullptr) {
+      break;
+    }
+    size_t bound = static_cast<const char*>(nl) - data + 1;
+    if (bound >= size) {
+      break;
+    }
+    bounds.push_back(bound);
+  }
+  bounds.push_back(size);
+  return bounds;
+}
+
+}  // namespace slot_text
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,322 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/fluid/framework/archive.h"
+#include "paddle/fluid/framework/channel.h"
+#include "paddle/fluid/platform/enforce.h"
+
+// A global shuffle that exchanges the records while they are loaded, instead
+// of sending them all after the load. Every rank runs a sender, which reads
+// its records from the input channel as the readers parse them, and a
+// receiver, which takes the messages of all the ranks.
+//
+// A message is a kind byte followed by the BinaryArchive of its records. The
+// senders of a rank end with an end message to every rank, so a receiver
+// knows by itself when the shuffle is complete. The receiver keeps up to
+// `memory_bytes` of messages in memory and compresses the later ones into
+// runs of a spill file, which bounds the memory of a shuffle that runs
+// while the previous pass is still in memory for training.
+namespace paddle {
+namespace framework {
+
+constexpr uint8_t kShuffleDataMessage = 'D';
+constexpr uint8_t kShuffleEndMessage = 'E';
+
+template <typename T>
+class StreamingShuffleSender {
+ public:
+  // Sends `msg` to `rank`. `msg` may be reused once it returns, the future
+  // is ready once the receiver has taken it.
+  using SendFunc =
+      std::function<std::future<int32_t>(int rank, const std::string& msg)>;
+  // Picks the rank a record is sent to.
+  using RankFunc = std::function<int(const T& ins)>;
+
+  StreamingShuffleSender(int rank_num,
+                         size_t batch_size,
+                         SendFunc send,
+                         RankFunc rank_of)
+      : rank_num_(rank_num),
+        batch_size_(batch_size),
+        send_(std::move(send)),
+        rank_of_(std::move(rank_of)) {}
+
+  ~StreamingShuffleSender() { Wait(); }
+
+  // Starts `thread_num` threads that send the records of `input`, batch by
+  // batch, until it is closed and empty. `input` may still be written.
+  void Start(Channel<T> input, int thread_num) {
+    PADDLE_ENFORCE_EQ(
+        threads_.empty(),
+        true,
+        phi::errors::PreconditionNotMet(
+            "The streaming shuffle is already started, wait for it first."));
+    // The last sender thread sends the end messages, without any thread the
+    // receivers would wait for them forever.
+    PADDLE_ENFORCE_GT(thread_num,
+                      0,
+                      phi::errors::InvalidArgument(
+                          "The streaming shuffle needs at least one sender "
+                          "thread, but received thread_num = %d.",
+                          thread_num));
+    running_ = thread_num;
+    for (int i = 0; i < thread_num; ++i) {
+      threads_.emplace_back(&StreamingShuffleSender::SendThread, this, input);
+    }
+  }
+
+  // Waits until the records and the end messages are sent.
+  void Wait() {
+    for (auto& t : threads_) {
+      t.join();
+    }
+    threads_.clear();
+  }
+
+  uint64_t SendNum() const { return send_num_; }
+
+ private:
+  void SendThread(Channel<T> input) {
+    std::vector<T> data(batch_size_);
+    std::vector<BinaryArchive> ars(rank_num_);
+    std::vector<std::future<int32_t>> status;
+    std::string msg;
+    size_t n = 0;
+    while ((n = input->Read(data.size(), data.data())) != 0) {
+      for (auto& ar : ars) {
+        ar << kShuffleDataMessage;
+      }
+      for (size_t i = 0; i < n; ++i) {
+        ars[rank_of_(data[i])] << data[i];
+      }
+      for (int rank = 0; rank < rank_num_; ++rank) {
+        if (ars[rank].Length() > sizeof(kShuffleDataMessage)) {
+          msg.assign(ars[rank].Buffer(), ars[rank].Length());
+          status.push_back(send_(rank, msg));
+        }
+        ars[rank].Clear();
+      }
+      for (auto& s : status) {
+        s.wait();
+      }
+      status.clear();
+      send_num_ += n;
+    }
+    // The last thread ends the stream, after every record is taken.
+    if (--running_ == 0) {
+      msg.assign(1, kShuffleEndMessage);
+      for (int rank = 0; rank < rank_num_; ++rank) {
+        status.push_back(send_(rank, msg));
+      }
+      for (auto& s : status) {
+        s.wait();
+      }
+    }
+  }
+
+  int rank_num_;
+  size_t batch_size_;
+  SendFunc send_;
+  RankFunc rank_of_;
+  std::vector<std::thread> threads_;
+  std::atomic<int> running_{0};
+  std::atomic<uint64_t> send_num_{0};
+};
+
+template <typename T>
+class StreamingShuffleReceiver {
+ public:
+  // The spill file is created in `spill_dir` once more than `memory_bytes`
+  // of messages are received.
+  StreamingShuffleReceiver(size_t memory_bytes, const std::string& spill_dir)
+      : memory_limit_(memory_bytes),
+        spill_dir_(spill_dir),
+        messages_(MakeChannel<std::string>()) {}
+
+  ~StreamingShuffleReceiver() { CloseSpill(); }
+
+  // Takes a message of a sender, thread safe.
+  void Receive(const std::string& msg) {
+    PADDLE_ENFORCE_EQ(msg.empty(),
+                      false,
+                      phi::errors::InvalidArgument(
+                          "The streaming shuffle message is empty."));
+    if (static_cast<uint8_t>(msg[0]) == kShuffleEndMessage) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ++end_num_;
+      end_cond_.notify_all();
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (memory_bytes_ + msg.size() <= memory_limit_) {
+        memory_bytes_ += msg.size();
+        peak_memory_bytes_ = std::max(peak_memory_bytes_, memory_bytes_);
+        messages_->Put(msg);
+        return;
+      }
+    }
+    Spill(msg);
+  }
+
+  // Waits for the end messages of `rank_num` ranks, then writes the received
+  // records to `outputs`, the records of a message to one channel and the
+  // messages to the channels in turn.
+  void Drain(int rank_num, std::vector<Channel<T>>* outputs) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      end_cond_.wait(lock, [this, rank_num] { return end_num_ >= rank_num; });
+      end_num_ -= rank_num;
+    }
+    size_t next = 0;
+    auto output = [outputs, &next](const char* data, size_t size) {
+      BinaryArchive ar;
+      ar.SetReadBuffer(const_cast<char*>(data) + sizeof(kShuffleDataMessage),
+                       size - sizeof(kShuffleDataMessage),
+                       [](char*) {});
+      std::vector<T> records;
+      while (ar.Cursor() < ar.Finish()) {
+        records.push_back(ar.Get<T>());
+      }
+      (*outputs)[next++ % outputs->size()]->Write(std::move(records));
+    };
+
+    std::string raw;
+    std::string compressed;
+    // All the senders have ended, the lock orders the reads after the last
+    // Spill.
+    std::unique_lock<std::mutex> spill_lock(spill_mutex_);
+    if (spill_fp_ != nullptr) {
+      PADDLE_ENFORCE_EQ(
+          fflush(spill_fp_) == 0 && fseek(spill_fp_, 0, SEEK_SET) == 0,
+          true,
+          phi::errors::Unavailable("Cannot read the shuffle spill file %s.",
+                                   spill_path_));
+      uint64_t header[2];
+      while (fread(header, sizeof(header), 1, spill_fp_) == 1) {
+        raw.resize(header[0]);
+        compressed.resize(header[1]);
+        uLongf raw_size = raw.size();
+        PADDLE_ENFORCE_EQ(
+            fread(&compressed[0], 1, compressed.size(), spill_fp_) ==
+                    compressed.size() &&
+                uncompress(reinterpret_cast<Bytef*>(&raw[0]),
+                           &raw_size,
+                           reinterpret_cast<const Bytef*>(compressed.data()),
+                           compressed.size()) == Z_OK &&
+                raw_size == raw.size(),
+            true,
+            phi::errors::Unavailable("The shuffle spill file %s is damaged.",
+                                     spill_path_));
+        output(raw.data(), raw.size());
+      }
+      CloseSpill();
+    }
+    spill_lock.unlock();
+    messages_->Close();
+    while (messages_->Get(raw)) {
+      output(raw.data(), raw.size());
+    }
+    messages_->Open();
+    std::lock_guard<std::mutex> lock(mutex_);
+    memory_bytes_ = 0;
+  }
+
+  size_t PeakMemoryBytes() const { return peak_memory_bytes_; }
+  size_t SpillBytes() const { return spill_bytes_; }
+
+ private:
+  void Spill(const std::string& msg) {
+    uLongf size = compressBound(msg.size());
+    std::string run(2 * sizeof(uint64_t) + size, '\0');
+    int ret = compress2(reinterpret_cast<Bytef*>(&run[2 * sizeof(uint64_t)]),
+                        &size,
+                        reinterpret_cast<const Bytef*>(msg.data()),
+                        msg.size(),
+                        Z_BEST_SPEED);
+    PADDLE_ENFORCE_EQ(ret,
+                      Z_OK,
+                      phi::errors::External(
+                          "Compress the streaming shuffle message failed."));
+    uint64_t header[2] = {msg.size(), size};
+    memcpy(&run[0], header, sizeof(header));
+    run.resize(sizeof(header) + size);
+
+    std::lock_guard<std::mutex> lock(spill_mutex_);
+    if (spill_fp_ == nullptr) {
+      spill_path_ =
+          spill_dir_ + "/shuffle_spill." +
+          std::to_string(
+              std::chrono::steady_clock::now().time_since_epoch().count()) +
+          "." + std::to_string(reinterpret_cast<uintptr_t>(this));
+      spill_fp_ = fopen(spill_path_.c_str(), "w+b");
+      PADDLE_ENFORCE_NOT_NULL(
+          spill_fp_,
+          phi::errors::Unavailable("Cannot create the shuffle spill file %s.",
+                                   spill_path_));
+    }
+    PADDLE_ENFORCE_EQ(
+        fwrite(run.data(), 1, run.size(), spill_fp_),
+        run.size(),
+        phi::errors::Unavailable("Cannot write the shuffle spill file %s.",
+                                 spill_path_));
+    spill_bytes_ += run.size();
+  }
+
+  // Called with spill_mutex_ held, or by the destructor.
+  void CloseSpill() {
+    if (spill_fp_ != nullptr) {
+      fclose(spill_fp_);
+      spill_fp_ = nullptr;
+      std::remove(spill_path_.c_str());
+    }
+  }
+
+  size_t memory_limit_;
+  std::string spill_dir_;
+  Channel<std::string> messages_;
+  std::mutex mutex_;
+  std::condition_variable end_cond_;
+  int end_num_ = 0;
+  size_t memory_bytes_ = 0;
+  size_t peak_memory_bytes_ = 0;
+  std::mutex spill_mutex_;
+  std::string spill_path_;
+  FILE* spill_fp_ = nullptr;
+  std::atomic<size_t> spill_bytes_{0};
+};
+
+}  // namespace framework
+}  // namespace paddle
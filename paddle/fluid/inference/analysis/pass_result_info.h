@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -31,7 +32,8 @@ class PassResultInfoForRuntime {
   using PassInfo =
       paddle::variant<std::string,
                       std::vector<std::string>,
-                      std::unordered_map<std::string, std::string>>;
+                      std::unordered_map<std::string, std::string>,
+                      int64_t>;
 
   static PassResultInfoForRuntime* Instance() {
     static PassResultInfoForRuntime info;
@@ -43,6 +45,10 @@ class PassResultInfoForRuntime {
     map[predictor_id].emplace(pass_name, infos);
   }
 
+  bool Has(int predictor_id, const std::string& pass_name) {
+    return map.count(predictor_id) && map[predictor_id].count(pass_name);
+  }
+
   template <typename T>
   T Get(int predictor_id, const std::string& pass_name) {
     PADDLE_ENFORCE_EQ(
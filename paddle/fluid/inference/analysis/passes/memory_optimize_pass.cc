@@ -280,6 +280,15 @@ void MemoryOptimizePass::RunImpl(Argument* argument) {
   auto* pass_res_info = PassResultInfoForRuntime::Instance();
   pass_res_info->Set(
       argument->root_predictor_id(), "memory_optimize_pass", node2cluster);
+  // Every cluster is one buffer of the largest var in it, their sum bounds
+  // the activations of a run with batch size 1.
+  int64_t activation_bytes = 0;
+  for (auto& cluster : cluster_size) {
+    activation_bytes += cluster.second;
+  }
+  pass_res_info->Set(argument->root_predictor_id(),
+                     "memory_optimize_pass_activation_bytes",
+                     activation_bytes);
 
   return;
 }
@@ -17,11 +17,15 @@
 #include <glog/logging.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -30,6 +34,7 @@
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
 #include "paddle/fluid/framework/feed_hook.h"
+#include "paddle/fluid/framework/io/mmap_params.h"
 #include "paddle/fluid/framework/ir/fuse_pass_base.h"
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/naive_executor.h"
@@ -3132,6 +3137,18 @@ uint64_t AnalysisPredictor::TryShrinkMemory() {
   return paddle::memory::Release(place_);
 }
 
+int64_t AnalysisPredictor::GetPlannedActivationBytes() const {
+  auto *pass_res_info =
+      inference::analysis::PassResultInfoForRuntime::Instance();
+  if (!config_.enable_memory_optim_ ||
+      !pass_res_info->Has(root_predictor_id_,
+                          "memory_optimize_pass_activation_bytes")) {
+    return 0;
+  }
+  return pass_res_info->Get<int64_t>(root_predictor_id_,
+                                     "memory_optimize_pass_activation_bytes");
+}
+
 void AnalysisPredictor::ClearIntermediateTensor() {
   PADDLE_ENFORCE_NOT_NULL(inference_program_.get(),
                           phi::errors::PreconditionNotMet(
@@ -3788,6 +3805,11 @@ void ConvertToMixedPrecision(const std::string &model_file,
                                                        white_list);
 }
 
+void ConvertToMmapParams(const std::string &params_file,
+                         const std::string &mmap_params_file) {
+  paddle::framework::ConvertToMmapParams(params_file, mmap_params_file);
+}
+
 }  // namespace paddle_infer
 
 namespace paddle_infer {
@@ -3797,6 +3819,107 @@ std::shared_ptr<Predictor> CreatePredictor(const Config &config) {  // NOLINT
 }
 
 namespace services {
+
+// A lock free stack of the indices of the idle predictors. The head keeps the
+// top index in the low 32 bits and a tag in the high 32 bits that changes on
+// every push, so that a pop fails if the head was popped and pushed again
+// since it was read. A pop of the empty stack spins for a while, then sleeps
+// until a predictor is pushed.
+class PredictorPool::IdleList {
+ public:
+  explicit IdleList(const std::vector<Predictor *> &predictors)
+      : predictors_(predictors),
+        next_(new std::atomic<uint32_t>[predictors.size()]),
+        in_use_(new std::atomic<bool>[predictors.size()]) {
+    for (uint32_t i = 0; i < predictors_.size(); ++i) {
+      indices_.emplace(predictors_[i], i);
+      in_use_[i].store(true, std::memory_order_relaxed);
+      Push(i);
+    }
+  }
+
+  Predictor *Pop() {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (int spin = 0;; ++spin) {
+      uint32_t top = static_cast<uint32_t>(head);
+      if (top == kEmpty) {
+        if (spin >= kMaxSpins) {
+          WaitUntilNotEmpty();
+          spin = 0;
+        }
+        head = head_.load(std::memory_order_acquire);
+        continue;
+      }
+      uint64_t next = (head & ~kIndexMask) |
+                      next_[top].load(std::memory_order_relaxed);
+      if (head_.compare_exchange_weak(
+              head, next, std::memory_order_acquire)) {
+        in_use_[top].store(true, std::memory_order_relaxed);
+        return predictors_[top];
+      }
+    }
+  }
+
+  void Push(Predictor *predictor) {
+    auto iter = indices_.find(predictor);
+    PADDLE_ENFORCE_EQ(iter != indices_.end(),
+                      true,
+                      phi::errors::InvalidArgument(
+                          "The predictor to release is not in the pool."));
+    PADDLE_ENFORCE_EQ(
+        in_use_[iter->second].exchange(false, std::memory_order_relaxed),
+        true,
+        phi::errors::PreconditionNotMet(
+            "The predictor is released twice without being acquired."));
+    Push(iter->second);
+  }
+
+ private:
+  static constexpr uint32_t kEmpty = UINT32_MAX;
+  static constexpr uint64_t kIndexMask = UINT32_MAX;
+  static constexpr int kMaxSpins = 64;
+
+  void Push(uint32_t index) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    uint64_t top;
+    do {
+      next_[index].store(static_cast<uint32_t>(head),
+                         std::memory_order_relaxed);
+      top = ((head & ~kIndexMask) + (kIndexMask + 1)) | index;
+    } while (!head_.compare_exchange_weak(
+        head, top, std::memory_order_seq_cst, std::memory_order_relaxed));
+    // Sequentially consistent with the update of waiters_ in
+    // WaitUntilNotEmpty, so either the waiter sees the new head or this sees
+    // the waiter.
+    if (waiters_.load(std::memory_order_seq_cst) > 0) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      cv_.notify_one();
+    }
+  }
+
+  void WaitUntilNotEmpty() {
+    waiters_.fetch_add(1, std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] {
+        return static_cast<uint32_t>(head_.load(std::memory_order_seq_cst)) !=
+               kEmpty;
+      });
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  const std::vector<Predictor *> predictors_;
+  std::unordered_map<Predictor *, uint32_t> indices_;
+  std::unique_ptr<std::atomic<uint32_t>[]> next_;
+  std::unique_ptr<std::atomic<bool>[]> in_use_;
+  std::atomic<uint64_t> head_{kEmpty};
+  // The callers sleeping in WaitUntilNotEmpty.
+  std::atomic<int> waiters_{0};
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
 PredictorPool::PredictorPool(const Config &config, size_t size) : preds_() {
   PADDLE_ENFORCE_GE(
       size,
@@ -3814,6 +3937,13 @@ PredictorPool::PredictorPool(const Config &config, size_t size) : preds_() {
       preds_.emplace_back(main_pred_->Clone());
     }
   }
+  std::vector<Predictor *> predictors{main_pred_.get()};
+  for (auto &pred : preds_) {
+    predictors.push_back(pred.get());
+  }
+  idle_ = std::make_unique<IdleList>(predictors);
+  VLOG(3) << "Created a predictor pool of " << size << " predictors, "
+          << ActivationBytes() << " bytes of activations planned for each.";
 }
 
 Predictor *PredictorPool::Retrieve(size_t idx) {
@@ -3829,6 +3959,18 @@ Predictor *PredictorPool::Retrieve(size_t idx) {
   }
   return preds_[idx - 1].get();
 }
+Predictor *PredictorPool::Acquire() { return idle_->Pop(); }
+
+void PredictorPool::Release(Predictor *predictor) { idle_->Push(predictor); }
+
+int64_t PredictorPool::ActivationBytes() const {
+  auto *pred =
+      dynamic_cast<paddle::AnalysisPredictor *>(main_pred_->predictor_.get());
+  return pred == nullptr ? 0 : pred->GetPlannedActivationBytes();
+}
+
+PredictorPool::~PredictorPool() = default;
+
 }  // namespace services
 
 namespace experimental {
@@ -266,6 +266,14 @@ class AnalysisPredictor : public PaddlePredictor {
   ///
   void ClearIntermediateTensor() override;
 
+  ///
+  /// \brief Get the bytes of the activations of one run with batch size 1,
+  /// as planned by memory_optimize_pass.
+  ///
+  /// \return The planned bytes, or 0 when memory optim is disabled.
+  ///
+  int64_t GetPlannedActivationBytes() const;
+
   ///
   /// \brief Release all tmp tensor to compress the size of the memory pool.
   /// The memory pool is considered to be composed of a list of chunks, if
@@ -0,0 +1,432 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/fluid/inference/api/paddle_inference_api.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/phi/common/bfloat16.h"
+#include "paddle/phi/common/float16.h"
+
+namespace paddle_infer {
+namespace services {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+size_t SizeOfDType(paddle::PaddleDType dtype) {
+  switch (dtype) {
+    case paddle::PaddleDType::FLOAT32:
+      return sizeof(float);
+    case paddle::PaddleDType::INT64:
+      return sizeof(int64_t);
+    case paddle::PaddleDType::INT32:
+      return sizeof(int32_t);
+    case paddle::PaddleDType::UINT8:
+      return sizeof(uint8_t);
+    case paddle::PaddleDType::INT8:
+      return sizeof(int8_t);
+    case paddle::PaddleDType::FLOAT16:
+      return sizeof(phi::dtype::float16);
+    case paddle::PaddleDType::BOOL:
+      return sizeof(bool);
+    case paddle::PaddleDType::FLOAT64:
+      return sizeof(double);
+    case paddle::PaddleDType::BFLOAT16:
+      return sizeof(phi::dtype::bfloat16);
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Unsupported data type %d of the batching predictor.",
+          static_cast<int>(dtype)));
+  }
+}
+
+void CopyFromBytes(const void *data, paddle::PaddleDType dtype, Tensor *t) {
+  switch (dtype) {
+    case paddle::PaddleDType::FLOAT32:
+      t->CopyFromCpu(static_cast<const float *>(data));
+      break;
+    case paddle::PaddleDType::INT64:
+      t->CopyFromCpu(static_cast<const int64_t *>(data));
+      break;
+    case paddle::PaddleDType::INT32:
+      t->CopyFromCpu(static_cast<const int32_t *>(data));
+      break;
+    case paddle::PaddleDType::UINT8:
+      t->CopyFromCpu(static_cast<const uint8_t *>(data));
+      break;
+    case paddle::PaddleDType::INT8:
+      t->CopyFromCpu(static_cast<const int8_t *>(data));
+      break;
+    case paddle::PaddleDType::FLOAT16:
+      t->CopyFromCpu(static_cast<const phi::dtype::float16 *>(data));
+      break;
+    case paddle::PaddleDType::BOOL:
+      t->CopyFromCpu(static_cast<const bool *>(data));
+      break;
+    case paddle::PaddleDType::FLOAT64:
+      t->CopyFromCpu(static_cast<const double *>(data));
+      break;
+    case paddle::PaddleDType::BFLOAT16:
+      t->CopyFromCpu(static_cast<const phi::dtype::bfloat16 *>(data));
+      break;
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Unsupported data type %d of the batching predictor.",
+          static_cast<int>(dtype)));
+  }
+}
+
+void CopyToBytes(const Tensor &t, void *data) {
+  switch (t.type()) {
+    case paddle::PaddleDType::FLOAT32:
+      t.CopyToCpu(static_cast<float *>(data));
+      break;
+    case paddle::PaddleDType::INT64:
+      t.CopyToCpu(static_cast<int64_t *>(data));
+      break;
+    case paddle::PaddleDType::INT32:
+      t.CopyToCpu(static_cast<int32_t *>(data));
+      break;
+    case paddle::PaddleDType::UINT8:
+      t.CopyToCpu(static_cast<uint8_t *>(data));
+      break;
+    case paddle::PaddleDType::INT8:
+      t.CopyToCpu(static_cast<int8_t *>(data));
+      break;
+    case paddle::PaddleDType::FLOAT16:
+      t.CopyToCpu(static_cast<phi::dtype::float16 *>(data));
+      break;
+    case paddle::PaddleDType::BOOL:
+      t.CopyToCpu(static_cast<bool *>(data));
+      break;
+    case paddle::PaddleDType::FLOAT64:
+      t.CopyToCpu(static_cast<double *>(data));
+      break;
+    case paddle::PaddleDType::BFLOAT16:
+      t.CopyToCpu(static_cast<phi::dtype::bfloat16 *>(data));
+      break;
+    default:
+      PADDLE_THROW(phi::errors::Unimplemented(
+          "Unsupported data type %d of the batching predictor.",
+          static_cast<int>(t.type())));
+  }
+}
+
+int64_t NumElements(const std::vector<int> &shape) {
+  int64_t numel = 1;
+  for (int dim : shape) {
+    numel *= dim;
+  }
+  return numel;
+}
+
+// Pads dim 1 of a [rows, length, ...] tensor with zeros to `length`.
+paddle::PaddleTensor PadSequence(const paddle::PaddleTensor &tensor,
+                                 int length) {
+  paddle::PaddleTensor padded;
+  padded.name = tensor.name;
+  padded.dtype = tensor.dtype;
+  padded.shape = tensor.shape;
+  padded.shape[1] = length;
+  const size_t inner = NumElements(tensor.shape) / tensor.shape[0] /
+                       tensor.shape[1] * SizeOfDType(tensor.dtype);
+  const size_t src_row = inner * tensor.shape[1];
+  const size_t dst_row = inner * length;
+  padded.data.Resize(dst_row * tensor.shape[0]);
+  auto *dst = static_cast<char *>(padded.data.data());
+  auto *src = static_cast<const char *>(tensor.data.data());
+  for (int i = 0; i < tensor.shape[0]; ++i) {
+    memcpy(dst + i * dst_row, src + i * src_row, src_row);
+    memset(dst + i * dst_row + src_row, 0, dst_row - src_row);
+  }
+  return padded;
+}
+
+}  // namespace
+
+class BatchingPredictor::Scheduler {
+ public:
+  Scheduler(const Config &config, const BatchingOptions &options)
+      : options_(options), pool_(config, options.num_workers) {
+    PADDLE_ENFORCE_GT(options_.max_batch_size,
+                      0,
+                      phi::errors::InvalidArgument(
+                          "The max batch size should be greater than 0, but "
+                          "it's (%d).",
+                          options_.max_batch_size));
+    PADDLE_ENFORCE_EQ(std::is_sorted(options_.sequence_buckets.begin(),
+                                     options_.sequence_buckets.end()),
+                      true,
+                      phi::errors::InvalidArgument(
+                          "The sequence buckets should be ascending."));
+    for (size_t i = 0; i < pool_.Size(); ++i) {
+      workers_.emplace_back([this, i]() { WorkLoop(pool_.Retrieve(i)); });
+    }
+  }
+
+  ~Scheduler() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto &worker : workers_) {
+      worker.join();
+    }
+  }
+
+  bool Run(const std::vector<paddle::PaddleTensor> &inputs,
+           std::vector<paddle::PaddleTensor> *outputs) {
+    PADDLE_ENFORCE_NOT_NULL(
+        outputs,
+        phi::errors::InvalidArgument("The outputs should not be nullptr."));
+    Request request;
+    request.outputs = outputs;
+    Prepare(inputs, &request);
+    auto done = request.done.get_future();
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      request.arrival = Clock::now();
+      queue_.push_back(&request);
+    }
+    cv_.notify_all();
+    return done.get();
+  }
+
+ private:
+  struct Request {
+    std::vector<paddle::PaddleTensor> inputs;
+    std::vector<paddle::PaddleTensor> *outputs;
+    // The shapes past dim 0 and the dtypes of the inputs, only the requests
+    // with the same key are merged.
+    std::string key;
+    int rows;
+    Clock::time_point arrival;
+    std::promise<bool> done;
+  };
+
+  void Prepare(const std::vector<paddle::PaddleTensor> &inputs,
+               Request *request) const {
+    PADDLE_ENFORCE_EQ(
+        inputs.empty(),
+        false,
+        phi::errors::InvalidArgument("The request has no input."));
+    std::ostringstream key;
+    request->rows = inputs[0].shape.empty() ? 0 : inputs[0].shape[0];
+    for (auto &input : inputs) {
+      PADDLE_ENFORCE_EQ(
+          !input.shape.empty() && input.shape[0] == request->rows &&
+              request->rows > 0,
+          true,
+          phi::errors::InvalidArgument(
+              "All the inputs of a request should have the same dim 0 greater "
+              "than 0, but the input %s doesn't.",
+              input.name));
+      PADDLE_ENFORCE_EQ(input.lod.empty(),
+                        true,
+                        phi::errors::Unimplemented(
+                            "The input %s has LoD, which is not supported by "
+                            "the batching predictor.",
+                            input.name));
+      PADDLE_ENFORCE_EQ(
+          input.data.length(),
+          NumElements(input.shape) * SizeOfDType(input.dtype),
+          phi::errors::InvalidArgument(
+              "The data size of the input %s doesn't match its shape.",
+              input.name));
+      bool is_sequence = std::find(options_.sequence_inputs.begin(),
+                                   options_.sequence_inputs.end(),
+                                   input.name) != options_.sequence_inputs.end();
+      int length = is_sequence && input.shape.size() > 1 ? input.shape[1] : 0;
+      auto bucket = std::lower_bound(options_.sequence_buckets.begin(),
+                                     options_.sequence_buckets.end(),
+                                     length);
+      if (length > 0 && bucket != options_.sequence_buckets.end() &&
+          *bucket > length) {
+        request->inputs.push_back(PadSequence(input, *bucket));
+      } else {
+        // PaddleBuf copies the data, share it instead.
+        paddle::PaddleTensor shared;
+        shared.name = input.name;
+        shared.shape = input.shape;
+        shared.dtype = input.dtype;
+        shared.data.Reset(const_cast<void *>(input.data.data()),
+                          input.data.length());
+        request->inputs.push_back(std::move(shared));
+      }
+      auto &prepared = request->inputs.back();
+      key << prepared.name << ':' << static_cast<int>(prepared.dtype);
+      for (size_t i = 1; i < prepared.shape.size(); ++i) {
+        key << ',' << prepared.shape[i];
+      }
+      key << ';';
+    }
+    request->key = key.str();
+  }
+
+  // Takes the oldest request and the following ones with the same key, once
+  // they fill a batch or the oldest one has waited long enough.
+  bool NextBatch(std::vector<Request *> *batch) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [this]() { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return false;
+      }
+      const Request *first = queue_.front();
+      int rows = 0;
+      for (auto *request : queue_) {
+        if (request->key == first->key) {
+          rows += request->rows;
+        }
+      }
+      auto deadline = first->arrival +
+                      std::chrono::microseconds(options_.batch_timeout_us);
+      if (rows >= options_.max_batch_size || Clock::now() >= deadline ||
+          stop_) {
+        break;
+      }
+      cv_.wait_until(lock, deadline);
+    }
+    const std::string key = queue_.front()->key;
+    int rows = 0;
+    for (auto iter = queue_.begin(); iter != queue_.end();) {
+      Request *request = *iter;
+      if (request->key == key &&
+          (batch->empty() ||
+           rows + request->rows <= options_.max_batch_size)) {
+        rows += request->rows;
+        batch->push_back(request);
+        iter = queue_.erase(iter);
+      } else {
+        ++iter;
+      }
+    }
+    return true;
+  }
+
+  void WorkLoop(Predictor *predictor) {
+    std::vector<Request *> batch;
+    while (NextBatch(&batch)) {
+      try {
+        bool success = RunBatch(predictor, batch);
+        for (auto *request : batch) {
+          request->done.set_value(success);
+        }
+      } catch (...) {
+        for (auto *request : batch) {
+          request->done.set_exception(std::current_exception());
+        }
+      }
+      batch.clear();
+    }
+  }
+
+  bool RunBatch(Predictor *predictor, const std::vector<Request *> &batch) {
+    int rows = 0;
+    for (auto *request : batch) {
+      rows += request->rows;
+    }
+    VLOG(4) << "Run a batch of " << batch.size() << " requests, " << rows
+            << " rows.";
+    std::vector<char> buffer;
+    for (size_t i = 0; i < batch[0]->inputs.size(); ++i) {
+      auto &first = batch[0]->inputs[i];
+      auto input = predictor->GetInputHandle(first.name);
+      std::vector<int> shape = first.shape;
+      shape[0] = rows;
+      buffer.resize(NumElements(shape) * SizeOfDType(first.dtype));
+      size_t offset = 0;
+      for (auto *request : batch) {
+        auto &data = request->inputs[i].data;
+        memcpy(buffer.data() + offset, data.data(), data.length());
+        offset += data.length();
+      }
+      input->Reshape(shape);
+      CopyFromBytes(buffer.data(), first.dtype, input.get());
+    }
+    if (!predictor->Run()) {
+      return false;
+    }
+    for (auto *request : batch) {
+      request->outputs->clear();
+    }
+    for (auto &name : predictor->GetOutputNames()) {
+      auto output = predictor->GetOutputHandle(name);
+      std::vector<int> shape = output->shape();
+      PADDLE_ENFORCE_EQ(
+          !shape.empty() && shape[0] == rows,
+          true,
+          phi::errors::PreconditionNotMet(
+              "The dim 0 of the output %s should be the batch size %d to be "
+              "split back to the requests.",
+              name,
+              rows));
+      const size_t row_size =
+          NumElements(shape) / rows * SizeOfDType(output->type());
+      buffer.resize(row_size * rows);
+      CopyToBytes(*output, buffer.data());
+      size_t offset = 0;
+      for (auto *request : batch) {
+        paddle::PaddleTensor result;
+        result.name = name;
+        result.dtype = output->type();
+        result.shape = shape;
+        result.shape[0] = request->rows;
+        result.data.Resize(row_size * request->rows);
+        memcpy(result.data.data(), buffer.data() + offset, result.data.length());
+        offset += result.data.length();
+        request->outputs->push_back(std::move(result));
+      }
+    }
+    return true;
+  }
+
+  const BatchingOptions options_;
+  PredictorPool pool_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Request *> queue_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+BatchingPredictor::BatchingPredictor(const Config &config,
+                                     const BatchingOptions &options)
+    : scheduler_(new Scheduler(config, options)) {}
+
+BatchingPredictor::~BatchingPredictor() = default;
+
+bool BatchingPredictor::Run(const std::vector<paddle::PaddleTensor> &inputs,
+                            std::vector<paddle::PaddleTensor> *outputs) {
+  return scheduler_->Run(inputs, outputs);
+}
+
+}  // namespace services
+}  // namespace paddle_infer
@@ -44,6 +44,10 @@ limitations under the License. */
 
 namespace paddle_infer {
 
+namespace services {
+class PredictorPool;
+}  // namespace services
+
 using PrecisionType = paddle::AnalysisConfig::Precision;
 using Config = paddle::AnalysisConfig;
 using DistConfig = paddle::DistConfig;
@@ -214,6 +218,7 @@ class PD_INFER_DECL Predictor {
  private:
   std::unique_ptr<paddle::PaddlePredictor> predictor_;
   friend class paddle_infer::experimental::InternalUtils;
+  friend class paddle_infer::services::PredictorPool;
 };
 
 ///
@@ -248,6 +253,18 @@ PD_INFER_DECL void ConvertToMixedPrecision(
     std::unordered_set<std::string> black_list = {},
     std::unordered_set<std::string> white_list = {});
 
+///
+/// \brief Convert a combined params file into a file that the predictor maps
+/// into memory instead of reading it, so that CPU weights are not copied and
+/// the processes serving the same model share the page cache. The converted
+/// file is used in place of the original one, such as in Config::SetModel.
+///
+/// \param[in] params_file the combined params file, like model.pdiparams
+/// \param[in] mmap_params_file the converted params file
+///
+PD_INFER_DECL void ConvertToMmapParams(const std::string& params_file,
+                                       const std::string& mmap_params_file);
+
 namespace services {
 ///
 /// \class PredictorPool
@@ -257,6 +274,20 @@ namespace services {
 /// corresponding Predictor is taken out from PredictorPool to complete the
 /// prediction.
 ///
+/// The pool can also serve more threads than it has predictors: a thread
+/// takes any idle predictor with Acquire and gives it back with Release when
+/// it has fetched the outputs. All the predictors share the weights, and each
+/// one keeps its activations allocated for the next run, so the memory is
+/// bound by the pool size instead of the number of threads.
+///
+/// \code{cpp}
+///   services::PredictorPool pool(config, std::thread::hardware_concurrency());
+///   // in every serving thread
+///   auto* predictor = pool.Acquire();
+///   ... // feed, predictor->Run(), fetch
+///   pool.Release(predictor);
+/// \endcode
+///
 class PD_INFER_DECL PredictorPool {
  public:
   PredictorPool() = delete;
@@ -266,12 +297,101 @@ class PD_INFER_DECL PredictorPool {
   /// \brief Construct the predictor pool with \param size predictor instances.
   explicit PredictorPool(const Config& config, size_t size = 1);
 
+  ~PredictorPool();
+
   /// \brief Get \param id-th predictor.
   Predictor* Retrieve(size_t idx);
 
+  /// \brief Take an idle predictor without locking, waiting while all of
+  /// them are in use. Do not mix with Retrieve on the same pool.
+  Predictor* Acquire();
+
+  /// \brief Give back a predictor taken by Acquire.
+  void Release(Predictor* predictor);
+
+  /// \brief The number of predictors in the pool.
+  size_t Size() const { return preds_.size() + 1; }
+
+  /// \brief The activation bytes that every predictor of the pool holds for
+  /// a run with batch size 1, as planned by memory_optimize_pass, or 0 when
+  /// memory optim is disabled.
+  int64_t ActivationBytes() const;
+
  private:
+  class IdleList;
+
   std::shared_ptr<Predictor> main_pred_;
   std::vector<std::unique_ptr<Predictor>> preds_;
+  std::unique_ptr<IdleList> idle_;
+};
+
+///
+/// \brief The options of BatchingPredictor.
+///
+struct PD_INFER_DECL BatchingOptions {
+  /// The most rows along the batch dimension (dim 0) of a merged batch.
+  int max_batch_size{32};
+  /// How long the oldest waiting request waits for others to join its batch,
+  /// in microseconds.
+  int64_t batch_timeout_us{1000};
+  /// The number of batches that run at the same time, each one on its own
+  /// predictor of a PredictorPool.
+  size_t num_workers{1};
+  /// The inputs whose dim 1 is a sequence length. Requests of different
+  /// lengths are padded with zeros along dim 1 so that they can be merged,
+  /// the padded positions should be masked out by another input.
+  std::vector<std::string> sequence_inputs;
+  /// Ascending lengths that the sequence inputs are padded to. A request is
+  /// padded to the first bucket that fits and merged only with the requests
+  /// of the same bucket. Without buckets, or past the last one, requests are
+  /// merged only with those of the same length.
+  std::vector<int> sequence_buckets;
+};
+
+///
+/// \class BatchingPredictor
+///
+/// \brief BatchingPredictor merges the requests of concurrent callers into
+/// batches. The requests with the same input shapes past dim 0 are
+/// concatenated along dim 0, up to max_batch_size rows or until the batch
+/// timeout, and run at once. The outputs are split back along dim 0, so every
+/// output of the model must have the batch dimension first. The outputs of
+/// padded requests keep the padding.
+///
+/// \code{cpp}
+///   services::BatchingOptions options;
+///   options.max_batch_size = 16;
+///   services::BatchingPredictor predictor(config, options);
+///   // in every serving thread
+///   std::vector<paddle::PaddleTensor> inputs = ..., outputs;
+///   predictor.Run(inputs, &outputs);
+/// \endcode
+///
+class PD_INFER_DECL BatchingPredictor {
+ public:
+  BatchingPredictor() = delete;
+  BatchingPredictor(const BatchingPredictor&) = delete;
+  BatchingPredictor& operator=(const BatchingPredictor&) = delete;
+
+  BatchingPredictor(const Config& config, const BatchingOptions& options);
+
+  ~BatchingPredictor();
+
+  ///
+  /// \brief Run a request and wait for its outputs, thread safe.
+  ///
+  /// \param[in] inputs The CPU inputs of the request, all of them with the
+  /// same dim 0. LoD is not supported.
+  /// \param[out] outputs The rows of the outputs that belong to the request.
+  /// \return Whether the batch of the request ran successfully.
+  ///
+  bool Run(const std::vector<paddle::PaddleTensor>& inputs,
+           std::vector<paddle::PaddleTensor>* outputs);
+
+ private:
+  class Scheduler;
+
+  std::unique_ptr<Scheduler> scheduler_;
 };
 }  // namespace services
 
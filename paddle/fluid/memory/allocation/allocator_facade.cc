@@ -24,6 +24,7 @@
 #include "paddle/fluid/memory/allocation/cpu_allocator.h"
 #include "paddle/fluid/memory/allocation/naive_best_fit_allocator.h"
 #include "paddle/fluid/memory/allocation/retry_allocator.h"
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
 #include "paddle/fluid/memory/allocation/stat_allocator.h"
 #include "paddle/fluid/platform/device_context.h"
 #include "paddle/fluid/platform/enforce.h"
@@ -207,6 +208,12 @@ class AllocatorFacadePrivate {
 #endif
         allocators_() {
     strategy_ = GetAllocatorStrategy();
+    // auto_growth_slab only differs from auto_growth on CPU, the device
+    // allocators are built as in auto_growth.
+    use_slab_cpu_allocator_ = strategy_ == AllocatorStrategy::kAutoGrowthSlab;
+    if (use_slab_cpu_allocator_) {
+      strategy_ = AllocatorStrategy::kAutoGrowth;
+    }
     is_stream_safe_cuda_allocator_used_ = false;
     is_cuda_malloc_async_allocator_used_ = false;
     VLOG(2) << "selected allocator strategy:" << int(strategy_) << std::endl;
@@ -243,7 +250,11 @@ class AllocatorFacadePrivate {
       }
 
       case AllocatorStrategy::kAutoGrowth: {
-        InitNaiveBestFitCPUAllocator();
+        if (use_slab_cpu_allocator_) {
+          InitSlabCPUAllocator();
+        } else {
+          InitNaiveBestFitCPUAllocator();
+        }
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
         allow_free_idle_chunk_ = allow_free_idle_chunk;
         for (int dev_id = 0; dev_id < platform::GetGPUDeviceCount(); ++dev_id) {
@@ -826,6 +837,21 @@ class AllocatorFacadePrivate {
 #endif
   }
 
+  void InitSlabCPUAllocator() {
+    // A chunk of at least 1MB is requested from the system at once, so that
+    // small allocations are carved from shared chunks.
+    auto chunk_size = std::max<size_t>(FLAGS_auto_growth_chunk_size_in_mb << 20,
+                                       SlabAllocator::kMaxSlabSize * 16);
+    VLOG(4) << "Init SlabAllocator for CPU with chunk size " << chunk_size;
+    auto auto_growth_allocator = std::make_shared<AutoGrowthBestFitAllocator>(
+        std::make_shared<CPUAllocator>(),
+        /*alignment=*/64,
+        chunk_size,
+        /*allow_free_idle_chunk=*/true);
+    allocators_[phi::CPUPlace()] =
+        std::make_shared<SlabAllocator>(auto_growth_allocator);
+  }
+
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
   void InitNaiveBestFitCUDAPinnedAllocator() {
     if (FLAGS_use_auto_growth_pinned_allocator) {
@@ -1595,6 +1621,7 @@ class AllocatorFacadePrivate {
 #endif
 
   AllocatorStrategy strategy_;
+  bool use_slab_cpu_allocator_;
   AllocatorMap allocators_;
   static AllocatorMap zero_size_allocators_;
   static AllocatorMap system_allocators_;
@@ -1645,8 +1672,8 @@ const std::shared_ptr<Allocator>& AllocatorFacade::GetAllocator(
 
 void* AllocatorFacade::GetBasePtr(
     const std::shared_ptr<phi::Allocation>& allocation) {
-  PADDLE_ENFORCE_EQ(GetAllocatorStrategy(),
-                    AllocatorStrategy::kAutoGrowth,
+  PADDLE_ENFORCE_EQ(IsAutoGrowthStrategy(GetAllocatorStrategy()),
+                    true,
                     phi::errors::Unimplemented(
                         "GetBasePtr() is only implemented for auto_growth "
                         "strategy, not support allocator strategy: %d",
@@ -1824,8 +1851,8 @@ void AllocatorFacade::SetDefaultStream(const phi::GPUPlace& place,
 
 #if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
 void AllocatorFacade::PrepareMemoryPoolForCUDAGraph(int64_t id) {
-  PADDLE_ENFORCE_EQ(GetAllocatorStrategy(),
-                    AllocatorStrategy::kAutoGrowth,
+  PADDLE_ENFORCE_EQ(IsAutoGrowthStrategy(GetAllocatorStrategy()),
+                    true,
                     phi::errors::InvalidArgument(
                         "CUDA Graph is only supported when the "
                         "FLAGS_allocator_strategy=\"auto_growth\", but got "
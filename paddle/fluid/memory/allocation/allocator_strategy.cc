@@ -36,9 +36,13 @@ static AllocatorStrategy GetStrategyFromFlag() {
     return AllocatorStrategy::kThreadLocal;
   }
 
+  if (FLAGS_allocator_strategy == "auto_growth_slab") {
+    return AllocatorStrategy::kAutoGrowthSlab;
+  }
+
   PADDLE_THROW(phi::errors::InvalidArgument(
       "Unsupported allocator strategy: %s, candidates are naive_best_fit, "
-      "auto_growth or thread_local.",
+      "auto_growth, thread_local or auto_growth_slab.",
       FLAGS_allocator_strategy));
 }
 
@@ -19,10 +19,22 @@ namespace paddle {
 namespace memory {
 namespace allocation {
 
-enum class AllocatorStrategy { kNaiveBestFit, kAutoGrowth, kThreadLocal };
+enum class AllocatorStrategy {
+  kNaiveBestFit,
+  kAutoGrowth,
+  kThreadLocal,
+  // Same as kAutoGrowth, but CPU memory goes through a SlabAllocator in front
+  // of an AutoGrowthBestFitAllocator.
+  kAutoGrowthSlab
+};
 
 extern AllocatorStrategy GetAllocatorStrategy();
 
+inline bool IsAutoGrowthStrategy(AllocatorStrategy strategy) {
+  return strategy == AllocatorStrategy::kAutoGrowth ||
+         strategy == AllocatorStrategy::kAutoGrowthSlab;
+}
+
 // Do nothing, just make sure linker do not prune this file.
 TEST_API void UseAllocatorStrategyGFlag();
 
@@ -18,6 +18,8 @@
 
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <cstdlib>
 
 #include <atomic>
@@ -325,6 +327,73 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+MemoryMapFileAllocation::~MemoryMapFileAllocation() {
+  if (munmap(this->ptr(), this->size()) == -1) {
+    LOG(WARNING) << "could not unmap the file " << file_name_;
+  }
+}
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(fd,
+                    -1,
+                    phi::errors::Unavailable("File %s open failed, please "
+                                             "check whether the file exists.",
+                                             file_name));
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1 || file_stat.st_size <= 0) {
+    close(fd);
+    PADDLE_THROW(
+        phi::errors::Unavailable("File %s is empty or cannot be stat.",
+                                 file_name));
+  }
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  // PROT_WRITE with MAP_PRIVATE lets passes update the weights in place, the
+  // written pages are copied for this process only.
+  void *ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  close(fd);
+  PADDLE_ENFORCE_NE(
+      ptr,
+      MAP_FAILED,
+      phi::errors::Unavailable("Memory map failed for file %s.", file_name));
+  return std::make_shared<MemoryMapFileAllocation>(ptr, size, file_name);
+}
+
+namespace {
+
+class MemoryMapFileViewAllocation : public Allocation {
+ public:
+  MemoryMapFileViewAllocation(std::shared_ptr<MemoryMapFileAllocation> file,
+                              size_t offset,
+                              size_t size)
+      : Allocation(static_cast<char *>(file->ptr()) + offset,
+                   size,
+                   phi::CPUPlace()),
+        file_(std::move(file)) {}
+
+ private:
+  std::shared_ptr<MemoryMapFileAllocation> file_;
+};
+
+}  // namespace
+
+std::shared_ptr<Allocation> MemoryMapFileView(
+    const std::shared_ptr<MemoryMapFileAllocation> &file,
+    size_t offset,
+    size_t size) {
+  PADDLE_ENFORCE_LE(
+      offset + size,
+      file->size(),
+      phi::errors::OutOfRange("The view [%d, %d) is out of the mapped file %s "
+                              "of %d bytes.",
+                              offset,
+                              offset + size,
+                              file->file_name(),
+                              file->size()));
+  return std::make_shared<MemoryMapFileViewAllocation>(file, offset, size);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
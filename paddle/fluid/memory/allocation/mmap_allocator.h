@@ -154,6 +154,35 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
     const std::string &ipc_name, size_t size);
 
+// Maps a regular file, such as the params of a model, privately (copy on
+// write). Every process mapping the same file shares its page cache copy until
+// it writes to a page.
+class MemoryMapFileAllocation : public Allocation {
+ public:
+  explicit MemoryMapFileAllocation(void *ptr,
+                                   size_t size,
+                                   std::string file_name)
+      : Allocation(ptr, size, phi::CPUPlace()),
+        file_name_(std::move(file_name)) {}
+
+  inline const std::string &file_name() const { return file_name_; }
+
+  ~MemoryMapFileAllocation() override;
+
+ private:
+  std::string file_name_;
+};
+
+std::shared_ptr<MemoryMapFileAllocation> AllocateMemoryMapFileAllocation(
+    const std::string &file_name);
+
+// Returns `size` bytes at `offset` of a mapped file as an allocation that
+// keeps the whole mapping alive.
+std::shared_ptr<Allocation> MemoryMapFileView(
+    const std::shared_ptr<MemoryMapFileAllocation> &file,
+    size_t offset,
+    size_t size);
+
 class MemoryMapFdSet {
  public:
   static MemoryMapFdSet &Instance();  // NOLINT
@@ -0,0 +1,390 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/fluid/memory/allocation/spin_lock.h"
+#include "paddle/fluid/memory/stats.h"
+#include "paddle/fluid/platform/profiler/event_tracing.h"
+
+namespace paddle::memory::allocation {
+
+namespace {
+
+constexpr size_t kSmallClassStep = 64;
+constexpr size_t kNumSmallClasses = 16;  // 64B ~ 1KB
+constexpr size_t kSubClassesPerPower = 4;
+constexpr size_t kFirstPowerBits = 10;  // 1KB
+// Bytes moved between a thread cache and the central cache at once.
+constexpr size_t kBatchBytes = 256 << 10;
+// Number of alloc/free calls of a thread between two maintenance passes.
+constexpr size_t kMaintenanceInterval = 16384;
+
+size_t BatchSize(size_t index) {
+  return std::min<size_t>(
+      std::max<size_t>(kBatchBytes / SlabAllocator::SizeClassSize(index), 2),
+      32);
+}
+
+std::atomic<uint64_t> next_slab_allocator_id{1};
+
+}  // namespace
+
+class SlabAllocator::CentralCache {
+ public:
+  CentralCache(std::shared_ptr<Allocator> underlying_allocator,
+               size_t max_cached_bytes)
+      : underlying_allocator_(std::move(underlying_allocator)),
+        max_cached_bytes_(max_cached_bytes) {}
+
+  ~CentralCache() { ReleaseAll(/*update_stat=*/false); }
+
+  // Moves at most n cached allocations of size class `index` into `out`.
+  void Fetch(size_t index, size_t n, std::vector<phi::Allocation*>* out) {
+    auto& free_list = free_lists_[index];
+    std::lock_guard<SpinLock> guard(free_list.lock);
+    n = std::min(n, free_list.allocations.size());
+    out->insert(out->end(), free_list.allocations.end() - n,
+                free_list.allocations.end());
+    free_list.allocations.resize(free_list.allocations.size() - n);
+    cached_bytes_.fetch_sub(n * SizeClassSize(index),
+                            std::memory_order_relaxed);
+  }
+
+  // Takes over n allocations of size class `index`. The ones exceeding the
+  // capacity of the central cache go back to the underlying allocator.
+  void Put(size_t index,
+           phi::Allocation* const* allocations,
+           size_t n,
+           bool defer_stat = false) {
+    size_t class_size = SizeClassSize(index);
+    size_t num_cached = 0;
+    {
+      auto& free_list = free_lists_[index];
+      std::lock_guard<SpinLock> guard(free_list.lock);
+      while (num_cached < n &&
+             cached_bytes_.load(std::memory_order_relaxed) + class_size <=
+                 max_cached_bytes_) {
+        free_list.allocations.push_back(allocations[num_cached++]);
+        cached_bytes_.fetch_add(class_size, std::memory_order_relaxed);
+      }
+    }
+    for (size_t i = num_cached; i < n; ++i) {
+      underlying_allocator_->Free(allocations[i]);
+    }
+    int64_t delta = -static_cast<int64_t>((n - num_cached) * class_size);
+    if (defer_stat) {
+      DeferStat(delta);
+    } else {
+      UpdateStat(delta);
+    }
+  }
+
+  uint64_t ReleaseAll(bool update_stat = true) {
+    uint64_t bytes = 0;
+    std::vector<phi::Allocation*> allocations;
+    for (size_t index = 0; index < kNumSizeClasses; ++index) {
+      allocations.clear();
+      {
+        auto& free_list = free_lists_[index];
+        std::lock_guard<SpinLock> guard(free_list.lock);
+        allocations.swap(free_list.allocations);
+      }
+      size_t class_size = SizeClassSize(index);
+      for (auto* allocation : allocations) {
+        underlying_allocator_->Free(allocation);
+      }
+      cached_bytes_.fetch_sub(allocations.size() * class_size,
+                              std::memory_order_relaxed);
+      bytes += allocations.size() * class_size;
+    }
+    if (update_stat) {
+      UpdateStat(-static_cast<int64_t>(bytes));
+    }
+    return bytes;
+  }
+
+  // Stat updates of exited threads are deferred to the next update of a
+  // live thread, see ThreadCache::~ThreadCache.
+  void DeferStat(int64_t delta) {
+    deferred_stat_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  void UpdateStat(int64_t delta) {
+    delta += deferred_stat_.exchange(0, std::memory_order_relaxed);
+    if (delta != 0) {
+      HOST_MEMORY_STAT_UPDATE(SlabCached, 0, delta);
+    }
+  }
+
+  size_t CachedBytes() const {
+    return cached_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct FreeList {
+    SpinLock lock;
+    std::vector<phi::Allocation*> allocations;
+  };
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  const size_t max_cached_bytes_;
+  std::atomic<size_t> cached_bytes_{0};
+  std::atomic<int64_t> deferred_stat_{0};
+  std::array<FreeList, kNumSizeClasses> free_lists_;
+};
+
+// The free lists of a thread cache are only touched by the owner thread, so
+// they need no synchronization.
+class SlabAllocator::ThreadCache {
+ public:
+  explicit ThreadCache(std::shared_ptr<CentralCache> central_cache)
+      : central_cache_(std::move(central_cache)) {}
+
+  // Thread local stats may already be destroyed at thread exit, so the stat
+  // updates are deferred.
+  ~ThreadCache() { Flush(/*defer_stat=*/true); }
+
+  // Returns nullptr if neither this thread nor the central cache has a free
+  // allocation of the size class.
+  phi::Allocation* Allocate(size_t index) {
+    auto& free_list = free_lists_[index];
+    if (free_list.allocations.empty()) {
+      central_cache_->Fetch(index, BatchSize(index), &free_list.allocations);
+      if (free_list.allocations.empty()) {
+        Tick();
+        return nullptr;
+      }
+    }
+    phi::Allocation* allocation = free_list.allocations.back();
+    free_list.allocations.pop_back();
+    free_list.low_water =
+        std::min(free_list.low_water, free_list.allocations.size());
+    stat_delta_ -= static_cast<int64_t>(SizeClassSize(index));
+    Tick();
+    return allocation;
+  }
+
+  void Free(size_t index, phi::Allocation* allocation) {
+    auto& free_list = free_lists_[index];
+    auto& allocations = free_list.allocations;
+    allocations.push_back(allocation);
+    stat_delta_ += static_cast<int64_t>(SizeClassSize(index));
+    size_t batch_size = BatchSize(index);
+    if (allocations.size() > 2 * batch_size) {
+      central_cache_->Put(
+          index, allocations.data() + allocations.size() - batch_size,
+          batch_size);
+      allocations.resize(allocations.size() - batch_size);
+      free_list.low_water = std::min(free_list.low_water, allocations.size());
+    }
+    Tick();
+  }
+
+  // Hands every cached allocation to the central cache.
+  void Flush(bool defer_stat = false) {
+    for (size_t index = 0; index < kNumSizeClasses; ++index) {
+      auto& free_list = free_lists_[index];
+      central_cache_->Put(index,
+                          free_list.allocations.data(),
+                          free_list.allocations.size(),
+                          defer_stat);
+      free_list.allocations.clear();
+      free_list.low_water = 0;
+    }
+    if (defer_stat) {
+      central_cache_->DeferStat(stat_delta_);
+    } else {
+      central_cache_->UpdateStat(stat_delta_);
+    }
+    stat_delta_ = 0;
+  }
+
+ private:
+  void Tick() {
+    if (++num_ops_ >= kMaintenanceInterval) {
+      Maintain();
+    }
+  }
+
+  // Allocations which stayed in a free list during a whole maintenance
+  // interval are not needed by this thread, return half of them.
+  void Maintain() {
+    num_ops_ = 0;
+    for (size_t index = 0; index < kNumSizeClasses; ++index) {
+      auto& free_list = free_lists_[index];
+      auto& allocations = free_list.allocations;
+      size_t num_release = (free_list.low_water + 1) / 2;
+      if (num_release > 0) {
+        central_cache_->Put(index,
+                            allocations.data() + allocations.size() -
+                                num_release,
+                            num_release);
+        allocations.resize(allocations.size() - num_release);
+      }
+      free_list.low_water = allocations.size();
+    }
+    central_cache_->UpdateStat(stat_delta_);
+    stat_delta_ = 0;
+  }
+
+  struct FreeList {
+    std::vector<phi::Allocation*> allocations;
+    // The minimal length of the list since last maintenance.
+    size_t low_water{0};
+  };
+
+  std::shared_ptr<CentralCache> central_cache_;
+  std::array<FreeList, kNumSizeClasses> free_lists_;
+  size_t num_ops_{0};
+  int64_t stat_delta_{0};
+};
+
+namespace {
+
+struct ThreadCacheMap {
+  std::unordered_map<uint64_t, std::unique_ptr<SlabAllocator::ThreadCache>>
+      caches;
+  uint64_t last_id{0};
+  SlabAllocator::ThreadCache* last_cache{nullptr};
+};
+
+ThreadCacheMap& GetThreadCacheMap() {
+  static thread_local ThreadCacheMap cache_map;
+  return cache_map;
+}
+
+}  // namespace
+
+size_t SlabAllocator::SizeClassIndex(size_t size) {
+  if (size <= kNumSmallClasses * kSmallClassStep) {
+    return size == 0 ? 0 : (size - 1) / kSmallClassStep;
+  }
+  // size is in (2^bits, 2^(bits + 1)]
+  size_t bits = kFirstPowerBits;
+  while ((size_t{1} << (bits + 1)) < size) {
+    ++bits;
+  }
+  size_t step = size_t{1} << (bits - 2);
+  size_t sub_class = (size - 1 - (size_t{1} << bits)) / step;
+  return kNumSmallClasses + (bits - kFirstPowerBits) * kSubClassesPerPower +
+         sub_class;
+}
+
+size_t SlabAllocator::SizeClassSize(size_t index) {
+  if (index < kNumSmallClasses) {
+    return (index + 1) * kSmallClassStep;
+  }
+  size_t bits = kFirstPowerBits + (index - kNumSmallClasses) /
+                                      kSubClassesPerPower;
+  size_t sub_class = (index - kNumSmallClasses) % kSubClassesPerPower;
+  return (size_t{1} << bits) + (sub_class + 1) * (size_t{1} << (bits - 2));
+}
+
+SlabAllocator::SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                             size_t max_central_cache_bytes)
+    : underlying_allocator_(std::move(underlying_allocator)),
+      central_cache_(std::make_shared<CentralCache>(underlying_allocator_,
+                                                    max_central_cache_bytes)),
+      id_(next_slab_allocator_id.fetch_add(1)) {
+  PADDLE_ENFORCE_NOT_NULL(
+      underlying_allocator_,
+      phi::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator is NULL"));
+  PADDLE_ENFORCE_EQ(
+      underlying_allocator_->IsAllocThreadSafe(),
+      true,
+      phi::errors::InvalidArgument(
+          "Underlying allocator of SlabAllocator must be thread safe"));
+  PADDLE_ENFORCE_EQ(SizeClassSize(kNumSizeClasses - 1),
+                    kMaxSlabSize,
+                    phi::errors::Fatal("Size classes of SlabAllocator do not "
+                                       "end with kMaxSlabSize."));
+}
+
+SlabAllocator::~SlabAllocator() {
+  // The thread caches of other threads keep central_cache_ alive until they
+  // exit, only the cache of the current thread can be dropped here.
+  auto& cache_map = GetThreadCacheMap();
+  cache_map.caches.erase(id_);
+  if (cache_map.last_id == id_) {
+    cache_map.last_id = 0;
+    cache_map.last_cache = nullptr;
+  }
+}
+
+SlabAllocator::ThreadCache* SlabAllocator::GetThreadCache() {
+  auto& cache_map = GetThreadCacheMap();
+  if (LIKELY(cache_map.last_id == id_)) {
+    return cache_map.last_cache;
+  }
+  auto& cache = cache_map.caches[id_];
+  if (cache == nullptr) {
+    cache = std::make_unique<ThreadCache>(central_cache_);
+  }
+  cache_map.last_id = id_;
+  cache_map.last_cache = cache.get();
+  return cache.get();
+}
+
+phi::Allocation* SlabAllocator::AllocateImpl(size_t size) {
+  if (size > kMaxSlabSize) {
+    return underlying_allocator_->Allocate(size).release();
+  }
+  size_t index = SizeClassIndex(size);
+  phi::Allocation* allocation = GetThreadCache()->Allocate(index);
+  if (allocation != nullptr) {
+    return allocation;
+  }
+  platform::RecordEvent record("SlabAllocator::AllocateFromUnderlying",
+                               platform::TracerEventType::UserDefined,
+                               9 /*level*/);
+  return underlying_allocator_->Allocate(SizeClassSize(index)).release();
+}
+
+void SlabAllocator::FreeImpl(phi::Allocation* allocation) {
+  size_t size = allocation->size();
+  if (size <= kMaxSlabSize) {
+    size_t index = SizeClassIndex(size);
+    // Only allocations of exactly a class size can serve that class.
+    if (SizeClassSize(index) == size) {
+      GetThreadCache()->Free(index, allocation);
+      return;
+    }
+  }
+  underlying_allocator_->Free(allocation);
+}
+
+uint64_t SlabAllocator::ReleaseImpl(const phi::Place& place) {
+  auto& cache_map = GetThreadCacheMap();
+  auto iter = cache_map.caches.find(id_);
+  if (iter != cache_map.caches.end()) {
+    iter->second->Flush();
+  }
+  uint64_t bytes = central_cache_->ReleaseAll();
+  return bytes + underlying_allocator_->Release(place);
+}
+
+size_t SlabAllocator::CentralCachedBytes() const {
+  return central_cache_->CachedBytes();
+}
+
+}  // namespace paddle::memory::allocation
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+
+#include "paddle/fluid/memory/allocation/allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+/**
+ * SlabAllocator is a size-class cache in front of a thread-safe allocator
+ * (usually AutoGrowthBestFitAllocator on CPU).
+ *
+ * Requests no larger than `max_slab_size` are rounded up to one of
+ * kNumSizeClasses size classes. Freed allocations of a size class are kept in
+ * a free list owned by the freeing thread, so the common alloc/free path takes
+ * no lock at all. Free lists that grow too long, or whose entries stayed
+ * unused for a whole maintenance period, hand batches of allocations back to
+ * a central cache; the central cache keeps at most `max_central_cache_bytes`
+ * and returns the rest to the underlying allocator, where they are merged
+ * back into their chunks.
+ *
+ * Larger requests bypass the cache.
+ */
+class SlabAllocator : public Allocator {
+ public:
+  static constexpr size_t kNumSizeClasses = 40;
+  static constexpr size_t kMaxSlabSize = 64 << 10;
+
+  explicit SlabAllocator(std::shared_ptr<Allocator> underlying_allocator,
+                         size_t max_central_cache_bytes = 64 << 20);
+
+  ~SlabAllocator() override;
+
+  bool IsAllocThreadSafe() const override { return true; }
+
+  // Size classes are multiples of 64 bytes up to 1KB, then four classes per
+  // power of two up to kMaxSlabSize.
+  static size_t SizeClassIndex(size_t size);
+  static size_t SizeClassSize(size_t index);
+
+  // Bytes kept by the central cache, not counting the thread caches.
+  size_t CentralCachedBytes() const;
+
+  class CentralCache;
+  class ThreadCache;
+
+ protected:
+  phi::Allocation* AllocateImpl(size_t size) override;
+
+  void FreeImpl(phi::Allocation* allocation) override;
+
+  // Drop the central cache and the cache of the calling thread, then release
+  // the idle chunks of the underlying allocator.
+  uint64_t ReleaseImpl(const phi::Place& place) override;
+
+ private:
+  ThreadCache* GetThreadCache();
+
+  std::shared_ptr<Allocator> underlying_allocator_;
+  std::shared_ptr<CentralCache> central_cache_;
+  const uint64_t id_;
+};
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
@@ -229,6 +229,8 @@ DEVICE_MEMORY_STAT_DECLARE(Reserved);
 
 HOST_MEMORY_STAT_DECLARE(Allocated);
 HOST_MEMORY_STAT_DECLARE(Reserved);
+// Bytes kept in the free lists of SlabAllocator.
+HOST_MEMORY_STAT_DECLARE(SlabCached);
 
 }  // namespace memory
 }  // namespace paddle
@@ -21,6 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/convert_utils.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
+#include "paddle/fluid/framework/io/mmap_params.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/string_array.h"
 #include "paddle/fluid/framework/tensor_util.h"
@@ -45,6 +46,12 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                           "it to be greater than 0.",
                           out_var_names.size()));
     if (!model_from_memory) {
+#ifndef _WIN32
+      if (framework::IsMmapParamsFile(filename)) {
+        LoadParamsFromMmap(ctx, place, filename, load_as_fp16, out_var_names);
+        return;
+      }
+#endif
       std::ifstream fin(filename, std::ios::binary);
       PADDLE_ENFORCE_EQ(
           static_cast<bool>(fin),
@@ -67,6 +74,78 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     }
   }
 
+  // The params converted by framework::ConvertToMmapParams are mapped instead
+  // of read, CPU tensors use the mapped pages directly.
+  void LoadParamsFromMmap(const framework::ExecutionContext &context,
+                          const phi::Place &place,
+                          const std::string &filename,
+                          bool load_as_fp16,
+                          const std::vector<std::string> &out_var_names) const {
+    framework::MmapParamsReader reader(filename);
+    PADDLE_ENFORCE_EQ(
+        reader.TensorNum(),
+        out_var_names.size(),
+        phi::errors::InvalidArgument(
+            "The mmap params file %s has %d tensors, but %d variables are "
+            "expected to be loaded.",
+            filename,
+            reader.TensorNum(),
+            out_var_names.size()));
+    auto out_vars = context.MultiOutputVar("Out");
+    for (size_t i = 0; i < out_var_names.size(); i++) {
+      VLOG(4) << "mapping tensor: " << out_var_names[i];
+      PADDLE_ENFORCE_NOT_NULL(
+          out_vars[i],
+          phi::errors::InvalidArgument(
+              "The variable %s to be loaded cannot be found.",
+              out_var_names[i]));
+      PADDLE_ENFORCE_EQ(
+          out_vars[i]->IsType<framework::Vocab>(),
+          false,
+          phi::errors::Unimplemented(
+              "The variable %s is a Vocab, which cannot be loaded from a mmap "
+              "params file.",
+              out_var_names[i]));
+      auto *tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
+      if (phi::is_cpu_place(place)) {
+        reader.GetTensor(i, tensor);
+      } else {
+        phi::DenseTensor cpu_tensor;
+        reader.GetTensor(i, &cpu_tensor);
+        framework::TensorCopySync(cpu_tensor, place, tensor);
+        tensor->set_lod(cpu_tensor.lod());
+      }
+      ConvertToFP16IfNeeded(place, load_as_fp16, out_vars[i], &tensor);
+    }
+  }
+
+  void ConvertToFP16IfNeeded(const phi::Place &place,
+                             bool load_as_fp16,
+                             framework::Variable *out_var,
+                             phi::DenseTensor **tensor) const {
+    auto in_dtype = (*tensor)->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
+      auto out_kernel_type =
+          phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
+      phi::DenseTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod((*tensor)->lod());
+      framework::TransDataType(
+          in_kernel_type, out_kernel_type, **tensor, &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      *tensor = out_var->GetMutable<phi::DenseTensor>();
+      (*tensor)->set_lod(fp16_tensor.lod());
+      (*tensor)->ShareDataWith(fp16_tensor);
+    }
+  }
+
   void LoadParamsFromBuffer(
       const framework::ExecutionContext &context,
       const phi::Place &place,
@@ -116,27 +195,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
         // Get data from fin to tensor
         paddle::framework::DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-        auto in_dtype = tensor->dtype();
-        auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
-
-        if (in_dtype != out_dtype) {
-          // convert to float16 tensor
-          auto in_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, in_dtype);
-          auto out_kernel_type =
-              phi::KernelKey(place, phi::DataLayout::ALL_LAYOUT, out_dtype);
-          phi::DenseTensor fp16_tensor;
-          // copy LoD info to the new tensor
-          fp16_tensor.set_lod(tensor->lod());
-          framework::TransDataType(
-              in_kernel_type, out_kernel_type, *tensor, &fp16_tensor);
-
-          // reset output tensor
-          out_vars[i]->Clear();
-          tensor = out_vars[i]->GetMutable<phi::DenseTensor>();
-          tensor->set_lod(fp16_tensor.lod());
-          tensor->ShareDataWith(fp16_tensor);
-        }
+        ConvertToFP16IfNeeded(place, load_as_fp16, out_vars[i], &tensor);
       }
     }
     buffer->peek();
@@ -0,0 +1,284 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <memory>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// A bounded multi-producer multi-consumer queue with the interface and the
+// close/kill semantics of BlockingQueue. Send and Receive go through a ring
+// buffer of sequenced cells (Dmitry Vyukov's bounded MPMC queue) without any
+// lock. A blocked caller spins for a while and then parks on a condition
+// variable, which is only notified when somebody is parked, so the mutex is
+// never touched while the producers and the consumers keep pace.
+//
+// An element sent concurrently with Close may still be received, like one
+// sent right before it. ReOpen must not race with Send or Receive.
+template <typename T>
+class LockFreeBlockingQueue {
+ public:
+  explicit LockFreeBlockingQueue(size_t capacity)
+      : capacity_(capacity), cells_(new Cell[capacity]) {
+    PADDLE_ENFORCE_GT(
+        capacity_,
+        static_cast<size_t>(0),
+        phi::errors::InvalidArgument(
+            "The capacity of a reader::LockFreeBlockingQueue must be greater "
+            "than 0, but received capacity is %d.",
+            capacity_));
+    for (size_t i = 0; i < capacity_; ++i) {
+      cells_[i].seq.store(2 * i, std::memory_order_relaxed);
+    }
+  }
+
+  bool Send(const T& elem) { return SendImpl(elem); }
+
+  bool Send(T&& elem) { return SendImpl(std::move(elem)); }
+
+  bool Receive(T* elem) {
+    PADDLE_ENFORCE_NOT_NULL(
+        elem,
+        phi::errors::InvalidArgument(
+            "The holder to receive queue data is null pointer."));
+    int spins = 0;
+    while (true) {
+      EnforceNotKilled();
+      if (TryPop(elem)) {
+        Notify(&send_waiters_, &send_cv_);
+        return true;
+      }
+      if (closed_.load(std::memory_order_acquire)) {
+        // Elements sent before Close are still received.
+        if (TryPop(elem)) {
+          Notify(&send_waiters_, &send_cv_);
+          return true;
+        }
+        VLOG(3) << "queue is closed! return nothing.";
+        return false;
+      }
+      Wait(&receive_waiters_, &receive_cv_, &spins, [this] {
+        return CanPop() || closed_.load(std::memory_order_acquire);
+      });
+    }
+  }
+
+  void ReOpen() {
+    EnforceNotKilled();
+    VLOG(1) << "reopen queue";
+    T elem;
+    while (TryPop(&elem)) {
+    }
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    closed_.store(false, std::memory_order_release);
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  void Close() {
+    VLOG(1) << "close queue";
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    closed_.store(true, std::memory_order_release);
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+  bool IsClosed() const { return closed_.load(std::memory_order_acquire); }
+
+  size_t Cap() const { return capacity_; }
+
+  size_t Size() const {
+    size_t dequeue_pos = dequeue_pos_.load(std::memory_order_acquire);
+    size_t enqueue_pos = enqueue_pos_.load(std::memory_order_acquire);
+    return enqueue_pos > dequeue_pos ? enqueue_pos - dequeue_pos : 0;
+  }
+
+  void Kill() {
+    VLOG(1) << "kill queue";
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    closed_.store(true, std::memory_order_release);
+    killed_.store(true, std::memory_order_release);
+    send_cv_.notify_all();
+    receive_cv_.notify_all();
+  }
+
+ private:
+  // A cell is ready to be written at position `pos` when its seq is
+  // `2 * pos`, and ready to be read when its seq is `2 * pos + 1`. Reading it
+  // sets its seq to `2 * (pos + capacity_)` for the position it is written at
+  // next time. The doubling keeps the two states apart when capacity_ is 1.
+  struct Cell {
+    std::atomic<size_t> seq;
+    T data;
+  };
+
+  static constexpr int kSpinCount = 256;
+
+  template <typename U>
+  bool SendImpl(U&& elem) {
+    int spins = 0;
+    while (true) {
+      if (killed_.load(std::memory_order_acquire)) {
+        VLOG(3) << "WARNING:: Sending an element to a killed "
+                   "reader::LockFreeBlockingQueue";
+        return false;
+      }
+      if (closed_.load(std::memory_order_acquire)) {
+        VLOG(5) << "WARNING: Sending an element to a closed "
+                   "reader::LockFreeBlockingQueue.";
+        return false;
+      }
+      if (TryPush(std::forward<U>(elem))) {
+        Notify(&receive_waiters_, &receive_cv_);
+        return true;
+      }
+      Wait(&send_waiters_, &send_cv_, &spins, [this] {
+        return CanPush() || closed_.load(std::memory_order_acquire);
+      });
+    }
+  }
+
+  // `elem` is only moved from when the push succeeds.
+  template <typename U>
+  bool TryPush(U&& elem) {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos % capacity_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      auto diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(2 * pos);
+      if (diff == 0) {
+        if (enqueue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->data = std::forward<U>(elem);
+    cell->seq.store(2 * pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool TryPop(T* elem) {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true) {
+      cell = &cells_[pos % capacity_];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      auto diff =
+          static_cast<intptr_t>(seq) - static_cast<intptr_t>(2 * pos + 1);
+      if (diff == 0) {
+        if (dequeue_pos_.compare_exchange_weak(
+                pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+      }
+    }
+    // Moving out leaves no large buffer behind in the cell.
+    *elem = std::move(cell->data);
+    cell->seq.store(2 * (pos + capacity_), std::memory_order_release);
+    return true;
+  }
+
+  // Whether the next cell is released, rather than whether the positions
+  // say so, a cell is claimed before it is written or read. True is also
+  // returned when the position has moved on, then the caller just retries.
+  bool CanPush() const {
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    size_t seq = cells_[pos % capacity_].seq.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(seq) >= static_cast<intptr_t>(2 * pos);
+  }
+
+  bool CanPop() const {
+    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+    size_t seq = cells_[pos % capacity_].seq.load(std::memory_order_acquire);
+    return static_cast<intptr_t>(seq) >= static_cast<intptr_t>(2 * pos + 1);
+  }
+
+  // Spins until `ready` or kSpinCount rounds, then parks. The caller retries
+  // its operation after every return.
+  template <typename Pred>
+  void Wait(std::atomic<int>* waiters,
+            std::condition_variable* cv,
+            int* spins,
+            Pred ready) {
+    if (*spins < kSpinCount) {
+      ++*spins;
+      std::this_thread::yield();
+      return;
+    }
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    waiters->fetch_add(1, std::memory_order_seq_cst);
+    // Pairs with the fence in Notify: either the waker sees the waiter, or
+    // the waiter sees what the waker has done.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv->wait(lock, [&] {
+      return ready() || killed_.load(std::memory_order_acquire);
+    });
+    waiters->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  void Notify(std::atomic<int>* waiters, std::condition_variable* cv) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters->load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(park_mutex_);
+      cv->notify_one();
+    }
+  }
+
+  inline void EnforceNotKilled() {
+    PADDLE_ENFORCE_NE(killed_.load(std::memory_order_acquire),
+                      true,
+                      phi::errors::Fatal("Blocking queue is killed because the "
+                                         "data reader raises an exception."));
+  }
+
+  const size_t capacity_;
+  std::unique_ptr<Cell[]> cells_;
+  // The positions are on their own cache lines, the producers and the
+  // consumers do not invalidate each other.
+  alignas(64) std::atomic<size_t> enqueue_pos_{0};
+  alignas(64) std::atomic<size_t> dequeue_pos_{0};
+  alignas(64) std::atomic<bool> closed_{false};
+  std::atomic<bool> killed_{false};  // the queue is broken since exception
+
+  std::atomic<int> send_waiters_{0};
+  std::atomic<int> receive_waiters_{0};
+  std::mutex park_mutex_;
+  std::condition_variable receive_cv_;
+  std::condition_variable send_cv_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
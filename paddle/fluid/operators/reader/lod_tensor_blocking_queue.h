@@ -21,60 +21,105 @@
 #include "paddle/common/ddim.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/operators/reader/lock_free_blocking_queue.h"
 #include "paddle/phi/common/place.h"
 
 namespace paddle {
 namespace operators {
 namespace reader {
 
+// With `lock_free`, the batches go through a LockFreeBlockingQueue instead
+// of the locked BlockingQueue. The speed test mode always uses the latter,
+// which keeps the received batch in the queue.
 class LoDTensorBlockingQueue {
  public:
-  explicit LoDTensorBlockingQueue(size_t capacity, bool speed_test_mode = false)
-      : queue_(capacity, speed_test_mode) {}
+  explicit LoDTensorBlockingQueue(size_t capacity,
+                                  bool speed_test_mode = false,
+                                  bool lock_free = false)
+      : queue_(capacity, speed_test_mode) {
+    if (lock_free && !speed_test_mode) {
+      lock_free_queue_ = std::make_unique<
+          LockFreeBlockingQueue<paddle::framework::LoDTensorArray>>(capacity);
+    }
+  }
 
   ~LoDTensorBlockingQueue() { VLOG(10) << "Destruct LoDTensorBlockingQueue"; }
 
   bool Push(const paddle::framework::LoDTensorArray& lod_tensor_vec) {
+    if (lock_free_queue_) {
+      return lock_free_queue_->Send(lod_tensor_vec);
+    }
     return queue_.Send(lod_tensor_vec);
   }
 
   bool Push(paddle::framework::LoDTensorArray&& lod_tensor_vec) {
+    if (lock_free_queue_) {
+      return lock_free_queue_->Send(std::move(lod_tensor_vec));
+    }
     return queue_.Send(std::move(lod_tensor_vec));
   }
 
   paddle::framework::LoDTensorArray Pop(bool* ok = nullptr) {
     paddle::framework::LoDTensorArray lod_tensor_vec;
-    bool success = queue_.Receive(&lod_tensor_vec);
+    bool success = lock_free_queue_ ? lock_free_queue_->Receive(&lod_tensor_vec)
+                                    : queue_.Receive(&lod_tensor_vec);
     if (ok != nullptr) *ok = success;
     return lod_tensor_vec;
   }
 
-  inline size_t Cap() const { return queue_.Cap(); }
+  inline size_t Cap() const {
+    return lock_free_queue_ ? lock_free_queue_->Cap() : queue_.Cap();
+  }
 
-  inline size_t Size() const { return queue_.Size(); }
+  inline size_t Size() const {
+    return lock_free_queue_ ? lock_free_queue_->Size() : queue_.Size();
+  }
 
-  inline void ReOpen() { queue_.ReOpen(); }
+  inline void ReOpen() {
+    if (lock_free_queue_) {
+      lock_free_queue_->ReOpen();
+    } else {
+      queue_.ReOpen();
+    }
+  }
 
   inline void Close() {
     VLOG(1) << "LoDTensorBlockingQueue close";
-    queue_.Close();
+    if (lock_free_queue_) {
+      lock_free_queue_->Close();
+    } else {
+      queue_.Close();
+    }
   }
 
-  inline bool IsClosed() const { return queue_.IsClosed(); }
+  inline bool IsClosed() const {
+    return lock_free_queue_ ? lock_free_queue_->IsClosed() : queue_.IsClosed();
+  }
 
-  inline void Kill() { queue_.Kill(); }
+  inline void Kill() {
+    if (lock_free_queue_) {
+      lock_free_queue_->Kill();
+    } else {
+      queue_.Kill();
+    }
+  }
 
   inline bool WaitForInited(size_t) { return true; }
 
  private:
   BlockingQueue<paddle::framework::LoDTensorArray> queue_;
+  std::unique_ptr<LockFreeBlockingQueue<paddle::framework::LoDTensorArray>>
+      lock_free_queue_;
 };
 
 class OrderedMultiDeviceLoDTensorBlockingQueue {
  public:
   OrderedMultiDeviceLoDTensorBlockingQueue(size_t capacity,
-                                           bool speed_test_mode = false)
-      : capacity_(capacity), speed_test_mode_(speed_test_mode) {}
+                                           bool speed_test_mode = false,
+                                           bool lock_free = false)
+      : capacity_(capacity),
+        speed_test_mode_(speed_test_mode),
+        lock_free_(lock_free) {}
 
   ~OrderedMultiDeviceLoDTensorBlockingQueue() {
     VLOG(10) << "Destruct OrderedMultiDeviceLoDTensorBlockingQueue";
@@ -108,7 +153,8 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
       queues_.resize(dev_cnt);
       for (auto& item : queues_) {
         auto cap = (capacity_ + dev_cnt - 1) / dev_cnt;
-        item = std::make_unique<LoDTensorBlockingQueue>(cap, speed_test_mode_);
+        item = std::make_unique<LoDTensorBlockingQueue>(
+            cap, speed_test_mode_, lock_free_);
       }
     }
     cv_.notify_all();
@@ -158,7 +204,8 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
     auto dev_cnt = queues_.size();
     for (auto& item : queues_) {
       auto cap = (capacity_ + dev_cnt - 1) / dev_cnt;
-      item = std::make_unique<LoDTensorBlockingQueue>(cap, speed_test_mode_);
+      item = std::make_unique<LoDTensorBlockingQueue>(
+          cap, speed_test_mode_, lock_free_);
     }
     data_index_ = 0;
   }
@@ -194,6 +241,7 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
   size_t dev_cnt_{0};
   const size_t capacity_;
   const bool speed_test_mode_;
+  const bool lock_free_;
   bool is_closed_{false};
 
   std::vector<std::function<void()>> reset_methods_;
@@ -205,14 +253,16 @@ class OrderedMultiDeviceLoDTensorBlockingQueue {
 
 class LoDTensorBlockingQueueHolder {
  public:
-  void InitOnce(size_t capacity, bool speed_test_mode = false) {
+  void InitOnce(size_t capacity,
+                bool speed_test_mode = false,
+                bool lock_free = false) {
     PADDLE_ENFORCE_EQ(
         queue_,
         nullptr,
         phi::errors::AlreadyExists("LoDTensorBlockingQueueHolder::"
                                    "InitOnce() can only be called once"));
-    queue_ =
-        std::make_unique<LoDTensorBlockingQueue>(capacity, speed_test_mode);
+    queue_ = std::make_unique<LoDTensorBlockingQueue>(
+        capacity, speed_test_mode, lock_free);
   }
 
   inline const std::shared_ptr<LoDTensorBlockingQueue>& GetQueue() const {
@@ -225,14 +275,16 @@ class LoDTensorBlockingQueueHolder {
 
 class OrderedMultiDeviceLoDTensorBlockingQueueHolder {
  public:
-  void InitOnce(size_t capacity, bool speed_test_mode = false) {
+  void InitOnce(size_t capacity,
+                bool speed_test_mode = false,
+                bool lock_free = false) {
     PADDLE_ENFORCE_EQ(queue_,
                       nullptr,
                       phi::errors::AlreadyExists(
                           "OrderedMultiDeviceLoDTensorBlockingQueueHolder::"
                           "InitOnce() can only be called once"));
     queue_ = std::make_unique<OrderedMultiDeviceLoDTensorBlockingQueue>(
-        capacity, speed_test_mode);
+        capacity, speed_test_mode, lock_free);
   }
 
   inline const std::shared_ptr<OrderedMultiDeviceLoDTensorBlockingQueue>&
@@ -14,7 +14,9 @@ limitations under the License. */
 #include <numeric>
 
 #include "glog/logging.h"
+#include "paddle/fluid/framework/io/mmap_params.h"
 #include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
 #include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
 #include "paddle/phi/common/port.h"
 #include "paddle/phi/kernels/funcs/data_type_transform.h"
@@ -186,11 +188,65 @@ void LoadFunction(const std::string& file_path,
   }
 }
 
+// The params converted by paddle::framework::ConvertToMmapParams are mapped
+// instead of read, CPU tensors use the mapped pages directly.
+void LoadCombineFromMmap(const std::string& file_path,
+                         const std::vector<std::string>& names,
+                         std::vector<phi::DenseTensor*>* out,
+                         bool load_as_fp16,
+                         const phi::DeviceContext* dev_ctx) {
+  paddle::framework::MmapParamsReader reader(file_path);
+  PADDLE_ENFORCE_EQ(
+      reader.TensorNum(),
+      names.size(),
+      phi::errors::InvalidArgument(
+          "The mmap params file %s has %d tensors, but %d variables are "
+          "expected to be loaded.",
+          file_path,
+          reader.TensorNum(),
+          names.size()));
+  const phi::Place place = dev_ctx->GetPlace();
+  for (size_t i = 0; i < names.size(); i++) {
+    auto tensor = out->at(i);
+    if (phi::is_cpu_place(place)) {
+      reader.GetTensor(i, tensor);
+    } else {
+      phi::DenseTensor cpu_tensor;
+      reader.GetTensor(i, &cpu_tensor);
+      paddle::framework::TensorCopySync(cpu_tensor, place, tensor);
+      tensor->set_lod(cpu_tensor.lod());
+    }
+
+    auto in_dtype = tensor->dtype();
+    auto out_dtype = load_as_fp16 ? phi::DataType::FLOAT16 : in_dtype;
+    if (in_dtype != out_dtype) {
+      auto cast_in = *tensor;
+      *tensor = CastTensorType(dev_ctx, cast_in, out_dtype);
+    }
+  }
+}
+
 void LoadCombineFunction(const std::string& file_path,
                          const std::vector<std::string>& names,
                          std::vector<phi::DenseTensor*>* out,
                          bool load_as_fp16,
                          phi::Place place) {
+#ifndef _WIN32
+  if (paddle::framework::IsMmapParamsFile(file_path)) {
+    PADDLE_ENFORCE_GT(out->size(),
+                      0UL,
+                      phi::errors::InvalidArgument(
+                          "The number of variables to be loaded is %d, expect "
+                          "it to be greater than 0.",
+                          out->size()));
+    LoadCombineFromMmap(file_path,
+                        names,
+                        out,
+                        load_as_fp16,
+                        GetDeviceContext(*(out->at(0)), place));
+    return;
+  }
+#endif
   std::ifstream fin(file_path, std::ios::binary);
   PADDLE_ENFORCE_EQ(static_cast<bool>(fin),
                     true,
@@ -287,6 +287,12 @@ void BindDataset(py::module *m) {
       .def("global_shuffle",
            &framework::Dataset::GlobalShuffle,
            py::call_guard<py::gil_scoped_release>())
+      .def("pre_global_shuffle",
+           &framework::Dataset::PreGlobalShuffle,
+           py::call_guard<py::gil_scoped_release>())
+      .def("wait_global_shuffle_done",
+           &framework::Dataset::WaitGlobalShuffleDone,
+           py::call_guard<py::gil_scoped_release>())
       .def("get_memory_data_size",
            &framework::Dataset::GetMemoryDataSize,
            py::call_guard<py::gil_scoped_release>())
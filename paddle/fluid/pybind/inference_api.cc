@@ -564,6 +564,10 @@ void BindInferenceApi(py::module *m) {
          py::arg("keep_io_types") = true,
          py::arg("black_list") = std::unordered_set<std::string>(),
          py::arg("white_list") = std::unordered_set<std::string>());
+  m->def("convert_to_mmap_params",
+         &paddle_infer::ConvertToMmapParams,
+         py::arg("params_file"),
+         py::arg("mmap_params_file"));
 }
 
 namespace {
@@ -1257,7 +1261,15 @@ void BindPredictorPool(py::module *m) {
       .def(py::init<const paddle_infer::Config &, size_t>())
       .def("retrieve",
            &paddle_infer::services::PredictorPool::Retrieve,
-           py::return_value_policy::reference);
+           py::return_value_policy::reference)
+      .def("acquire",
+           &paddle_infer::services::PredictorPool::Acquire,
+           py::return_value_policy::reference,
+           py::call_guard<py::gil_scoped_release>())
+      .def("release", &paddle_infer::services::PredictorPool::Release)
+      .def("size", &paddle_infer::services::PredictorPool::Size)
+      .def("activation_bytes",
+           &paddle_infer::services::PredictorPool::ActivationBytes);
 }
 
 void BindPaddlePassBuilder(py::module *m) {
@@ -35,6 +35,7 @@
 #include "pybind11/stl.h"
 
 COMMON_DECLARE_bool(reader_queue_speed_test_mode);
+COMMON_DECLARE_bool(reader_queue_lock_free);
 
 // disable auto conversion to list in Python
 PYBIND11_MAKE_OPAQUE(paddle::framework::LoDTensorArray);
@@ -433,11 +434,15 @@ void BindReader(py::module *module) {
         if (is_ordered) {
           auto *holder = var.GetMutable<
               reader::OrderedMultiDeviceLoDTensorBlockingQueueHolder>();
-          holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode);
+          holder->InitOnce(capacity,
+                           FLAGS_reader_queue_speed_test_mode,
+                           FLAGS_reader_queue_lock_free);
           return py::cast(holder->GetQueue());
         } else {
           auto *holder = var.GetMutable<reader::LoDTensorBlockingQueueHolder>();
-          holder->InitOnce(capacity, FLAGS_reader_queue_speed_test_mode);
+          holder->InitOnce(capacity,
+                           FLAGS_reader_queue_speed_test_mode,
+                           FLAGS_reader_queue_lock_free);
           return py::cast(holder->GetQueue());
         }
       },
@@ -16,17 +16,56 @@
 
 #include <thread>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #include "glog/logging.h"
 #include "paddle/common/flags.h"
 #include "paddle/phi/core/enforce.h"
 
 COMMON_DECLARE_int32(dist_threadpool_size);
+COMMON_DECLARE_bool(threadpool_bind_cpu);
 PD_DEFINE_int32(io_threadpool_size,
                 100,
                 "number of threads used for doing IO, default 100");
 
 namespace phi {
 
+std::vector<int> GetAllowedCpus() {
+  std::vector<int> cpus;
+#if defined(__linux__)
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  if (sched_getaffinity(0, sizeof(cpu_set_t), &cpuset) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &cpuset)) cpus.push_back(cpu);
+    }
+  }
+#endif
+  if (cpus.empty()) {
+    int num_cpus = static_cast<int>(std::thread::hardware_concurrency());
+    for (int cpu = 0; cpu < num_cpus; ++cpu) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+bool BindCurrentThreadToCpu(int index) {
+#if defined(__linux__)
+  // Read before this function pins any thread.
+  static const std::vector<int> allowed_cpus = GetAllowedCpus();
+  if (allowed_cpus.empty() || index < 0) return false;
+  cpu_set_t cpuset;
+  CPU_ZERO(&cpuset);
+  CPU_SET(allowed_cpus[index % allowed_cpus.size()], &cpuset);
+  return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) ==
+         0;
+#else
+  return false;
+#endif
+}
+
 std::unique_ptr<ThreadPool> ThreadPool::threadpool_(nullptr);
 std::once_flag ThreadPool::init_flag_;
 
@@ -53,9 +92,13 @@ void ThreadPool::Init() {
 
 ThreadPool::ThreadPool(int num_threads) : running_(true) {
   threads_.resize(num_threads);
-  for (auto& thread : threads_) {
-    // TODO(Yancey1989): binding the thread on the specify CPU number
-    thread = std::make_unique<std::thread>([this] { ThreadPool::TaskLoop(); });
+  for (int i = 0; i < num_threads; ++i) {
+    threads_[i] = std::make_unique<std::thread>([this, i] {
+      if (FLAGS_threadpool_bind_cpu && !BindCurrentThreadToCpu(i)) {
+        VLOG(1) << "Failed to pin thread " << i << " of ThreadPool to a cpu";
+      }
+      ThreadPool::TaskLoop();
+    });
   }
 }
 
@@ -134,6 +134,14 @@ class ThreadPoolIO : ThreadPool {
   static std::once_flag io_init_flag_;
 };
 
+// Returns the cpus the calling thread may run on, in increasing order.
+std::vector<int> GetAllowedCpus();
+
+// Pins the calling thread to the (index % n)-th of the n allowed cpus.
+// Returns false if the affinity could not be changed. Thread pools call it
+// for their threads when FLAGS_threadpool_bind_cpu is set.
+bool BindCurrentThreadToCpu(int index);
+
 // Run a function asynchronously.
 // NOTE: The function must return void. If the function need to return a value,
 // you can use lambda to capture a value pointer.
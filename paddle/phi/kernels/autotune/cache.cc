@@ -14,12 +14,182 @@
 
 #include "paddle/phi/kernels/autotune/cache.h"
 
+#include <cstdio>
+#include <fstream>
 #include <iomanip>
+#include <map>
+#include <sstream>
+#include <thread>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#else
+#include <process.h>
+#endif
 
 #include "glog/logging.h"
+#include "paddle/phi/backends/cpu/cpu_info.h"
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+#include "paddle/phi/backends/gpu/gpu_info.h"
+#endif
+
+COMMON_DECLARE_string(autotune_cache_file);
 
 namespace phi::autotune {
 
+namespace {
+
+// A cache file is the header lines
+//   paddle_autotune_cache <version>
+//   fingerprint <hardware fingerprint>
+// followed by one record per line, the key fields and the tuned result are
+// separated by a tab:
+//   algo <algo_type> <key>\t<algo>
+//   matmul <key>\t<algo>
+//   conv <algo_type> <x_dims> <w_dims> <strides> <paddings> <dilations>
+//        <dtype> <groups> <data_layout>\t<algo> <workspace_size> <exhaustive>
+// where every vector is its size followed by the elements. The keys are the
+// hash values the kernels compute, so bump the version whenever GenKey or a
+// kernel key changes, or the candidates of a tuner are reordered.
+constexpr char kCacheFileMagic[] = "paddle_autotune_cache";
+constexpr int kCacheFileVersion = 1;
+
+using CacheRecords = std::map<std::string, std::string>;
+
+// The algorithms are only valid on the hardware and the libraries they are
+// tuned with.
+std::string HardwareFingerprint() {
+  std::ostringstream os;
+#if defined(__linux__)
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (std::getline(cpuinfo, line)) {
+    if (line.compare(0, 10, "model name") == 0) {
+      auto pos = line.find_first_not_of(" \t", line.find(':') + 1);
+      os << (pos == std::string::npos ? "" : line.substr(pos));
+      break;
+    }
+  }
+#endif
+  os << " avx2:" << backends::cpu::MayIUse(backends::cpu::avx2)
+     << " avx512f:" << backends::cpu::MayIUse(backends::cpu::avx512f)
+     << " threads:" << std::thread::hardware_concurrency();
+#if defined(PADDLE_WITH_CUDA) || defined(PADDLE_WITH_HIP)
+  int device_count = backends::gpu::GetGPUDeviceCount();
+  for (int i = 0; i < device_count; ++i) {
+    os << " gpu" << i << ":" << backends::gpu::GetGPUComputeCapability(i)
+       << "x" << backends::gpu::GetGPUMultiProcessors(i);
+  }
+  if (device_count > 0) {
+    os << " runtime:" << backends::gpu::GetGPURuntimeVersion(0)
+       << " driver:" << backends::gpu::GetGPUDriverVersion(0)
+       << " dnn:" << backends::gpu::DnnVersion();
+  }
+#endif
+  std::string fingerprint = os.str();
+  std::replace(fingerprint.begin(), fingerprint.end(), '\n', ' ');
+  return fingerprint;
+}
+
+// Reads the records of the cache file at `path` into `records`. Returns false
+// if the file does not exist, or is of another version or hardware.
+bool ReadCacheFile(const std::string& path,
+                   const std::string& fingerprint,
+                   CacheRecords* records) {
+  std::ifstream fin(path);
+  if (!fin) {
+    return false;
+  }
+  std::string magic;
+  int version = 0;
+  std::string line;
+  fin >> magic >> version;
+  std::getline(fin, line);
+  if (magic != kCacheFileMagic || version != kCacheFileVersion) {
+    LOG(WARNING) << "Ignore the autotune cache " << path
+                 << ", its version is " << version << " but "
+                 << kCacheFileVersion << " is expected.";
+    return false;
+  }
+  const std::string fingerprint_prefix = "fingerprint ";
+  if (!std::getline(fin, line) ||
+      line.compare(0, fingerprint_prefix.size(), fingerprint_prefix) != 0 ||
+      line.substr(fingerprint_prefix.size()) != fingerprint) {
+    LOG(WARNING) << "Ignore the autotune cache " << path
+                 << ", it is tuned on different hardware.";
+    return false;
+  }
+  while (std::getline(fin, line)) {
+    auto pos = line.find('\t');
+    if (pos == std::string::npos) {
+      continue;
+    }
+    (*records)[line.substr(0, pos)] = line.substr(pos + 1);
+  }
+  return true;
+}
+
+template <typename T>
+void WriteVector(std::ostream& os, const std::vector<T>& values) {  // NOLINT
+  os << " " << values.size();
+  for (auto& value : values) {
+    os << " " << value;
+  }
+}
+
+template <typename T>
+bool ReadVector(std::istream& is, std::vector<T>* values) {  // NOLINT
+  size_t size = 0;
+  if (!(is >> size) || size > 64) {
+    return false;
+  }
+  values->resize(size);
+  for (auto& value : *values) {
+    if (!(is >> value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Serializes the writers of a cache file in different processes.
+class FileLock {
+ public:
+  explicit FileLock(const std::string& path) {
+#if !defined(_WIN32)
+    fd_ = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ >= 0 && flock(fd_, LOCK_EX) != 0) {
+      close(fd_);
+      fd_ = -1;
+    }
+#endif
+  }
+
+  ~FileLock() {
+#if !defined(_WIN32)
+    if (fd_ >= 0) {
+      flock(fd_, LOCK_UN);
+      close(fd_);
+    }
+#endif
+  }
+
+ private:
+  int fd_{-1};
+};
+
+int ProcessId() {
+#if !defined(_WIN32)
+  return static_cast<int>(getpid());
+#else
+  return _getpid();
+#endif
+}
+
+}  // namespace
+
 size_t TransposeKey(const std::vector<int64_t>& x_dims,
                     const std::vector<int32_t>& perm,
                     phi::DataType dtype) {
@@ -36,6 +206,8 @@ std::string AlgorithmTypeString(int64_t algo_type) {
   } else if (algo_type ==
              static_cast<int64_t>(AlgorithmType::kConvBackwardFilter)) {
     return "conv_backward_filter";
+  } else if (algo_type == static_cast<int64_t>(AlgorithmType::kMatmulCpu)) {
+    return "matmul_cpu";
   }
 #ifdef PADDLE_WITH_CUDNN_FRONTEND
   if (algo_type == static_cast<int64_t>(AlgorithmType::kConvForwardV8)) {
@@ -115,4 +287,128 @@ void AutoTuneCache::UpdateStatus() {
   total_cache_misses_ = cache_misses;
 }
 
+bool AutoTuneCache::Save(const std::string& path) {
+  // The writers in this process share the temporary file.
+  static std::mutex save_mutex;
+  std::lock_guard<std::mutex> guard(save_mutex);
+  FileLock lock(path + ".lock");
+
+  const std::string fingerprint = HardwareFingerprint();
+  CacheRecords records;
+  ReadCacheFile(path, fingerprint, &records);
+  for (auto& v : auto_tune_map_) {
+    for (auto& item : v.second.Items()) {
+      records["algo " + std::to_string(v.first) + " " +
+              std::to_string(item.first)] = std::to_string(item.second);
+    }
+  }
+  for (auto& item : matmul_auto_tune_map_.Items()) {
+    records["matmul " + std::to_string(item.first)] =
+        std::to_string(item.second);
+  }
+  for (auto& v : conv_auto_tune_map_) {
+    for (auto& item : v.second.Items()) {
+      const ConvCacheKey& key = item.first;
+      std::ostringstream os;
+      os << "conv " << v.first;
+      WriteVector(os, key.x_dims);
+      WriteVector(os, key.w_dims);
+      WriteVector(os, key.strides);
+      WriteVector(os, key.paddings);
+      WriteVector(os, key.dilations);
+      os << " " << static_cast<int>(key.dtype) << " " << key.groups << " "
+         << key.data_layout;
+      records[os.str()] = std::to_string(item.second.algo) + " " +
+                          std::to_string(item.second.workspace_size) + " " +
+                          std::to_string(item.second.exhaustive_search);
+    }
+  }
+
+  // Readers never see a partial file, the complete file is renamed to `path`.
+  const std::string tmp_path = path + ".tmp." + std::to_string(ProcessId());
+  std::ofstream fout(tmp_path, std::ios::trunc);
+  fout << kCacheFileMagic << " " << kCacheFileVersion << "\n"
+       << "fingerprint " << fingerprint << "\n";
+  for (auto& record : records) {
+    fout << record.first << "\t" << record.second << "\n";
+  }
+  fout.close();
+  if (!fout || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+    LOG(WARNING) << "Fail to save the autotune cache to " << path;
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  VLOG(3) << "Save " << records.size() << " autotune configs to " << path;
+  return true;
+}
+
+int64_t AutoTuneCache::Load(const std::string& path) {
+  CacheRecords records;
+  if (!ReadCacheFile(path, HardwareFingerprint(), &records)) {
+    return 0;
+  }
+  int64_t loaded = 0;
+  for (auto& record : records) {
+    std::istringstream key_is(record.first);
+    std::istringstream value_is(record.second);
+    std::string kind;
+    int64_t algo_type = 0;
+    key_is >> kind;
+    bool valid = false;
+    if (kind == "algo") {
+      size_t key = 0;
+      int64_t algo = 0;
+      valid = (key_is >> algo_type >> key) && (value_is >> algo) &&
+              auto_tune_map_.count(algo_type);
+      if (valid) {
+        auto_tune_map_[algo_type].Set(key, algo);
+      }
+    } else if (kind == "matmul") {
+      size_t key = 0;
+      int64_t algo = 0;
+      valid = (key_is >> key) && (value_is >> algo);
+      if (valid) {
+        matmul_auto_tune_map_.Set(key, algo);
+      }
+    } else if (kind == "conv") {
+      ConvCacheKey key;
+      ConvAutoTuneResult result;
+      int dtype = 0;
+      valid = (key_is >> algo_type) && ReadVector(key_is, &key.x_dims) &&
+              ReadVector(key_is, &key.w_dims) &&
+              ReadVector(key_is, &key.strides) &&
+              ReadVector(key_is, &key.paddings) &&
+              ReadVector(key_is, &key.dilations) &&
+              (key_is >> dtype >> key.groups >> key.data_layout) &&
+              (value_is >> result.algo >> result.workspace_size >>
+               result.exhaustive_search) &&
+              conv_auto_tune_map_.count(algo_type);
+      if (valid) {
+        key.dtype = static_cast<phi::DataType>(dtype);
+        conv_auto_tune_map_[algo_type].Set(key, result);
+      }
+    }
+    if (valid) {
+      ++loaded;
+    } else {
+      LOG(WARNING) << "Skip the invalid record \"" << record.first
+                   << "\" of the autotune cache " << path;
+    }
+  }
+  VLOG(3) << "Load " << loaded << " autotune configs from " << path;
+  return loaded;
+}
+
+void AutoTuneCache::LoadFromFlag() {
+  if (!FLAGS_autotune_cache_file.empty()) {
+    Load(FLAGS_autotune_cache_file);
+  }
+}
+
+void AutoTuneCache::SaveToFlag() {
+  if (!FLAGS_autotune_cache_file.empty()) {
+    Save(FLAGS_autotune_cache_file);
+  }
+}
+
 }  // namespace phi::autotune
@@ -16,6 +16,7 @@
 
 #include <algorithm>
 #include <numeric>
+#include <string>
 
 #include "paddle/phi/common/data_type.h"
 #include "paddle/phi/kernels/autotune/cache_base.h"
@@ -49,21 +50,22 @@ enum class AlgorithmType {
   kGatherGemmScatterFP32NN = 7,
   kGatherGemmScatterFP32TN = 8,
   kGatherGemmScatterFP32NT = 9,
+  kMatmulCpu = 10,
 #if !defined(PADDLE_WITH_CUDNN_FRONTEND)
-  kAlgorithmCount = 10
+  kAlgorithmCount = 11
 #else
-  kConvForwardV8 = 10,
-  kConvBackwardDataV8 = 11,
-  kConvBackwardFilterV8 = 12,
-  kScaleBiasReluConvBNstats = 13,
-  kBNFinalize = 14,
-  kScaleBiasAddRelu = 15,
-  kDgradDreluBnBwdWeight = 16,
-  kDbnApply = 17,
-  kBnActWgrad = 18,
-  kPoolingForwardV8 = 19,
-  kPoolingBackwardV8 = 20,
-  kAlgorithmCount = 21
+  kConvForwardV8 = 11,
+  kConvBackwardDataV8 = 12,
+  kConvBackwardFilterV8 = 13,
+  kScaleBiasReluConvBNstats = 14,
+  kBNFinalize = 15,
+  kScaleBiasAddRelu = 16,
+  kDgradDreluBnBwdWeight = 17,
+  kDbnApply = 18,
+  kBnActWgrad = 19,
+  kPoolingForwardV8 = 20,
+  kPoolingBackwardV8 = 21,
+  kAlgorithmCount = 22
 #endif
 };
 
@@ -151,6 +153,20 @@ class AutoTuneCache {
 
   void UpdateStatus();
 
+  // Saves the cached algorithms to `path`, merged with the ones other
+  // processes have saved there. The cudnn frontend plans and the cublasLt
+  // algorithms of matmul are not saved, they hold device objects. Returns
+  // false if the file can not be written.
+  bool Save(const std::string& path);
+
+  // Loads the algorithms saved by Save. A file of another version, or saved
+  // on different hardware, is ignored. Returns the number of loaded configs.
+  int64_t Load(const std::string& path);
+
+  // Load and Save with FLAGS_autotune_cache_file, do nothing if it is empty.
+  void LoadFromFlag();
+  void SaveToFlag();
+
   // The number of total config cached
   int64_t Size() const { return total_size_; }
 
@@ -173,6 +189,7 @@ class AutoTuneCache {
     for (int i = 1; i < static_cast<int>(AlgorithmType::kAlgorithmCount); ++i) {
       Register(static_cast<AlgorithmType>(i));
     }
+    LoadFromFlag();
   }
 
   void Register(const AlgorithmType& algo_type) {
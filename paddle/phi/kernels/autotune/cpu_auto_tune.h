@@ -0,0 +1,111 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <chrono>
+#include <limits>
+#include <vector>
+
+#include "glog/logging.h"
+#include "paddle/phi/kernels/autotune/switch_autotune.h"
+#ifdef PADDLE_WITH_MKLML
+#include "paddle/phi/backends/dynload/mklml.h"
+#endif
+
+namespace phi {
+namespace autotune {
+
+// Tunes the number of threads the blas library runs a CPU kernel with, small
+// or skinny problems are often faster with fewer threads than the default.
+// The winners are cached in AutoTuneCache like the GPU algorithms, so they
+// are persisted with it too. Only MKL supports a thread local number of
+// threads, with other blas libraries the kernel always runs as is.
+class CpuBlasThreadsAutoTuner {
+ public:
+  // `fn` must overwrite its outputs, it runs several times while tuning.
+  template <typename Fn>
+  static void Run(const AlgorithmType& algo, const size_t key, Fn&& fn) {
+#ifdef PADDLE_WITH_MKLML
+    auto& cache = AutoTuneCache::Instance().Get(algo);
+    if (cache.Find(key)) {
+      RunWithThreads(cache.Get(key), fn);
+    } else if (AutoTuneStatus::Instance().UseAutoTune()) {
+      cache.Set(key, PickBestThreads(fn));
+    } else {
+      fn();
+    }
+#else
+    fn();
+#endif
+  }
+
+ private:
+#ifdef PADDLE_WITH_MKLML
+  class ScopedThreads {
+   public:
+    explicit ScopedThreads(int threads)
+        : prev_threads_(dynload::MKL_Set_Num_Threads_Local(threads)) {}
+    ~ScopedThreads() { dynload::MKL_Set_Num_Threads_Local(prev_threads_); }
+
+   private:
+    int prev_threads_;
+  };
+
+  // 0 means the default number of threads.
+  template <typename Fn>
+  static void RunWithThreads(int64_t threads, Fn&& fn) {
+    ScopedThreads scoped_threads(static_cast<int>(threads));
+    fn();
+  }
+
+  // The candidates are the default and the halves of the max threads.
+  template <typename Fn>
+  static int64_t PickBestThreads(Fn&& fn) {
+    std::vector<int64_t> candidates = {0};
+    for (int64_t threads = dynload::MKL_Get_Max_Threads() / 2; threads >= 1;
+         threads /= 2) {
+      candidates.push_back(threads);
+    }
+
+    // Regard 1st run as warmup.
+    constexpr int repeats = 5;
+    int64_t best_threads = 0;
+    double min_time = std::numeric_limits<double>::max();
+    for (auto threads : candidates) {
+      ScopedThreads scoped_threads(static_cast<int>(threads));
+      double time_cost = 0;
+      for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        if (i > 0) {
+          time_cost += std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+        }
+      }
+      VLOG(3) << "blas threads " << threads << " time cost is " << time_cost;
+      if (time_cost < min_time) {
+        min_time = time_cost;
+        best_threads = threads;
+      }
+    }
+    VLOG(3) << "best blas threads is " << best_threads;
+    return best_threads;
+  }
+#endif
+};
+
+}  // namespace autotune
+}  // namespace phi
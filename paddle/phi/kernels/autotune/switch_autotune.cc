@@ -55,6 +55,10 @@ void AutoTuneStatus::Update() {
             << static_cast<int>(StepHitRate() * 100) << "%";
   } else {
     use_autotune_ = false;
+    // Persists the winners once the tuning range ends.
+    if (current_steps_id_ + 1 == stop_step_id_) {
+      AutoTuneCache::Instance().SaveToFlag();
+    }
     // Set a small tolerance to avoid performance degradation
     // due to large cache size under dynamic shape.
     // TODO(limingshu): Currently works for conv op only, this
@@ -85,6 +85,7 @@ class AutoTuneStatus {
     previous_misses_ = 0;
     step_hit_rates_.clear();
     AutoTuneCache::Instance().Clean();
+    AutoTuneCache::Instance().LoadFromFlag();
   }
 
   bool use_autotune_{false};
@@ -117,6 +117,13 @@ void BenchAllImpls(const typename KernelTuple::attr_type& attr, Args... args) {
   for (auto const& f : funcs) {
     infos.push_back(std::make_pair(f.first, benchmark(f.second, args...)));
   }
+  // Every ISA of the jitcode, named like JitCode(VXXJitCode_..._AVX512).
+  auto codes = jit::GetAllJitCodes<KernelTuple, PlaceType>(attr);
+  for (auto const& code : codes) {
+    auto func = code->template getCode<typename KernelTuple::func_type>();
+    infos.push_back(std::make_pair("JitCode(" + code->name() + ")",
+                                   benchmark(func, args...)));
+  }
 
   // Test result from Get function
   auto tgt = jit::KernelFuncs<KernelTuple, PlaceType>::Cache().At(attr);
@@ -47,13 +47,23 @@ int ALIGN32_BEG g_tmp_mem[16] ALIGN32_END = {0};      // NOLINT
 
 void VActJitCode::genCode() {
   int offset = 0;
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
+  int rest = num_;
+  if (UseZmm(isa_)) {
+    for (int i = 0; i < rest / ZMM_FLOAT_BLOCK; ++i) {
+      vmovups(zmm_src, ptr[param1 + offset]);
+      act<zmm_t>(zmm_dst, zmm_src, type_);
+      vmovups(ptr[param2 + offset], zmm_dst);
+      offset += sizeof(float) * ZMM_FLOAT_BLOCK;
+    }
+    rest %= ZMM_FLOAT_BLOCK;
+  }
+  for (int i = 0; i < rest / YMM_FLOAT_BLOCK; ++i) {
     vmovups(ymm_src, ptr[param1 + offset]);
     act<ymm_t>(ymm_dst, ymm_src, type_);
     vmovups(ptr[param2 + offset], ymm_dst);
     offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
-  int rest = num_ % YMM_FLOAT_BLOCK;
+  rest %= YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
@@ -81,12 +91,13 @@ void VActJitCode::genCode() {
 }
 
 #define DECLARE_ACT_CREATOR(name)                                            \
+  template <phi::backends::cpu::cpu_isa_t isa>                               \
   class name##Creator : public JitCodeCreator<int> {                         \
    public:                                                                   \
     bool CanBeUsed(const int& attr) const override;                          \
     size_t CodeSize(const int& d) const override;                            \
     std::unique_ptr<GenBase> CreateJitCode(const int& attr) const override { \
-      return make_unique<name##JitCode>(attr, CodeSize(attr));               \
+      return make_unique<name##JitCode>(attr, isa, CodeSize(attr));          \
     }                                                                        \
   }
 
@@ -98,52 +109,64 @@ DECLARE_ACT_CREATOR(VSigmoid);
 DECLARE_ACT_CREATOR(VTanh);
 
 // TODO(TJ): tuning use me
-bool VReluCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VReluCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa);
 }
 
-bool VSquareCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VSquareCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa);
 }
 
-bool VIdentityCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VIdentityCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa);
 }
 
-bool VExpCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx) && d < 32;
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VExpCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa) && d < 32;
 }
 
-bool VSigmoidCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VSigmoidCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa);
 }
 
-bool VTanhCreator::CanBeUsed(const int& d) const {
-  return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+template <phi::backends::cpu::cpu_isa_t isa>
+bool VTanhCreator<isa>::CanBeUsed(const int& d) const {
+  return phi::backends::cpu::MayIUse(isa);
 }
 
-size_t VReluCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VReluCreator<isa>::CodeSize(const int& d) const {
   return 96 /* init size */ + (d / YMM_FLOAT_BLOCK + 3) * 4 /* instructions */ *
                                   8 /* average bytes for each instruction */;
 }
 
-size_t VSquareCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VSquareCreator<isa>::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 4 * 8;
 }
 
-size_t VIdentityCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VIdentityCreator<isa>::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 4 * 8;
 }
 
-size_t VExpCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VExpCreator<isa>::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 70 * 8;
 }
 
-size_t VSigmoidCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VSigmoidCreator<isa>::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 82 * 8;
 }
 
-size_t VTanhCreator::CodeSize(const int& d) const {
+template <phi::backends::cpu::cpu_isa_t isa>
+size_t VTanhCreator<isa>::CodeSize(const int& d) const {
   return 96 + (d / YMM_FLOAT_BLOCK + 3) * 84 * 8;
 }
 
@@ -154,10 +177,23 @@ size_t VTanhCreator::CodeSize(const int& d) const {
 }  // namespace phi
 
 namespace gen = phi::jit::gen;
-
-REGISTER_JITKERNEL_GEN(kVRelu, gen::VReluCreator);
-REGISTER_JITKERNEL_GEN(kVSquare, gen::VSquareCreator);
-REGISTER_JITKERNEL_GEN(kVIdentity, gen::VIdentityCreator);
-REGISTER_JITKERNEL_GEN(kVExp, gen::VExpCreator);
-REGISTER_JITKERNEL_GEN(kVSigmoid, gen::VSigmoidCreator);
-REGISTER_JITKERNEL_GEN(kVTanh, gen::VTanhCreator);
+namespace cpu = phi::backends::cpu;
+
+REGISTER_JITKERNEL_GEN(kVRelu,
+                       gen::VReluCreator<cpu::avx512f>,
+                       gen::VReluCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVSquare,
+                       gen::VSquareCreator<cpu::avx512f>,
+                       gen::VSquareCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVIdentity,
+                       gen::VIdentityCreator<cpu::avx512f>,
+                       gen::VIdentityCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVExp,
+                       gen::VExpCreator<cpu::avx512f>,
+                       gen::VExpCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVSigmoid,
+                       gen::VSigmoidCreator<cpu::avx512f>,
+                       gen::VSigmoidCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVTanh,
+                       gen::VTanhCreator<cpu::avx512f>,
+                       gen::VTanhCreator<cpu::avx>);
@@ -23,35 +23,32 @@ namespace phi::jit::gen {
 void VXXJitCode::genCode() {
   // do not need push stack, and do not need save avx512reg if do not use avx512
   int offset = 0;
-  if (with_relu_) {
-    vxorps(ymm_zero, ymm_zero, ymm_zero);
-  }
-  if (scalar_index_ == 1) {
-    vbroadcastss(ymm_src1, ptr[param1]);
-  } else if (scalar_index_ == 2) {
-    vbroadcastss(ymm_src2, ptr[param2]);
-  }
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
-    if (scalar_index_ != 1) {
-      vmovups(ymm_src1, ptr[param1 + offset]);
-    }
-    if (scalar_index_ != 2) {
-      vmovups(ymm_src2, ptr[param2 + offset]);
+  int rest = num_;
+  // The scalar and zero are prepared in the widest register, the narrower
+  // loops below read their lower lanes.
+  if (UseZmm(isa_)) {
+    if (with_relu_) {
+      zero_jmm(zmm_zero);
     }
-    if (type_ == operand_type::MUL) {
-      vmulps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::ADD) {
-      vaddps(ymm_dst, ymm_src1, ymm_src2);
-    } else if (type_ == operand_type::SUB) {
-      vsubps(ymm_dst, ymm_src1, ymm_src2);
+    if (scalar_index_ == 1) {
+      vbroadcastss(zmm_src1, ptr[param1]);
+    } else if (scalar_index_ == 2) {
+      vbroadcastss(zmm_src2, ptr[param2]);
     }
+    offset = compute_blocks<zmm_t>(rest / ZMM_FLOAT_BLOCK, offset);
+    rest %= ZMM_FLOAT_BLOCK;
+  } else {
     if (with_relu_) {
-      vmaxps(ymm_dst, ymm_zero, ymm_dst);
+      vxorps(ymm_zero, ymm_zero, ymm_zero);
+    }
+    if (scalar_index_ == 1) {
+      vbroadcastss(ymm_src1, ptr[param1]);
+    } else if (scalar_index_ == 2) {
+      vbroadcastss(ymm_src2, ptr[param2]);
     }
-    vmovups(ptr[param3 + offset], ymm_dst);
-    offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
-  int rest = num_ % YMM_FLOAT_BLOCK;
+  offset = compute_blocks<ymm_t>(rest / YMM_FLOAT_BLOCK, offset);
+  rest %= YMM_FLOAT_BLOCK;
   while (rest > 0) {
     int block = XMM_FLOAT_BLOCK;
     if (rest >= 4) {
@@ -109,17 +106,17 @@ void VXXJitCode::genCode() {
 }
 
 #define DECLARE_BLAS_CREATOR(name)                                           \
+  template <phi::backends::cpu::cpu_isa_t isa>                               \
   class name##Creator : public JitCodeCreator<int> {                         \
    public:                                                                   \
     bool CanBeUsed(const int& attr) const override {                         \
-      return phi::backends::cpu::MayIUse(phi::backends::cpu::avx) &&         \
-             attr <= 1024;                                                   \
+      return phi::backends::cpu::MayIUse(isa) && attr <= 1024;               \
     }                                                                        \
     size_t CodeSize(const int& d) const override {                           \
       return 96 + d / YMM_FLOAT_BLOCK * 4 * 8;                               \
     }                                                                        \
     std::unique_ptr<GenBase> CreateJitCode(const int& attr) const override { \
-      return make_unique<name##JitCode>(attr, CodeSize(attr));               \
+      return make_unique<name##JitCode>(attr, isa, CodeSize(attr));          \
     }                                                                        \
   }
 
@@ -135,10 +132,23 @@ DECLARE_BLAS_CREATOR(VAddBias);
 }  // namespace phi::jit::gen
 
 namespace gen = phi::jit::gen;
+namespace cpu = phi::backends::cpu;
 
-REGISTER_JITKERNEL_GEN(kVMul, gen::VMulCreator);
-REGISTER_JITKERNEL_GEN(kVAdd, gen::VAddCreator);
-REGISTER_JITKERNEL_GEN(kVSub, gen::VSubCreator);
-REGISTER_JITKERNEL_GEN(kVAddRelu, gen::VAddReluCreator);
-REGISTER_JITKERNEL_GEN(kVScal, gen::VScalCreator);
-REGISTER_JITKERNEL_GEN(kVAddBias, gen::VAddBiasCreator);
+REGISTER_JITKERNEL_GEN(kVMul,
+                       gen::VMulCreator<cpu::avx512f>,
+                       gen::VMulCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVAdd,
+                       gen::VAddCreator<cpu::avx512f>,
+                       gen::VAddCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVSub,
+                       gen::VSubCreator<cpu::avx512f>,
+                       gen::VSubCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVAddRelu,
+                       gen::VAddReluCreator<cpu::avx512f>,
+                       gen::VAddReluCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVScal,
+                       gen::VScalCreator<cpu::avx512f>,
+                       gen::VScalCreator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kVAddBias,
+                       gen::VAddBiasCreator<cpu::avx512f>,
+                       gen::VAddBiasCreator<cpu::avx>);
@@ -31,13 +31,15 @@ class VXXJitCode : public JitCode {
                       operand_type type,
                       int scalar_index,
                       bool with_relu,
+                      phi::backends::cpu::cpu_isa_t isa,
                       size_t code_size = 256 * 1024,
                       void* code_ptr = nullptr)
       : JitCode(code_size, code_ptr),
         num_(d),
         type_(type),
         scalar_index_(scalar_index),
-        with_relu_(with_relu) {
+        with_relu_(with_relu),
+        isa_(isa) {
     if (!(type_ == operand_type::MUL || type_ == operand_type::ADD ||
           type_ == operand_type::SUB)) {
       PADDLE_THROW(phi::errors::Unimplemented(
@@ -67,15 +69,47 @@ class VXXJitCode : public JitCode {
     }
     base += (with_relu_ ? "_Relu" : "");
     base += "_D" + std::to_string(num_);
-    return base;
+    return base + IsaSuffix(isa_);
   }
   void genCode() override;
 
  private:
+  // Computes num_blocks JMM registers of floats from offset, returns the
+  // offset after them.
+  template <typename JMM>
+  int compute_blocks(int num_blocks, int offset) {
+    JMM jmm_src1 = JMM(0);
+    JMM jmm_src2 = JMM(1);
+    JMM jmm_dst = JMM(2);
+    JMM jmm_zero = JMM(3);
+    for (int i = 0; i < num_blocks; ++i) {
+      if (scalar_index_ != 1) {
+        vmovups(jmm_src1, ptr[param1 + offset]);
+      }
+      if (scalar_index_ != 2) {
+        vmovups(jmm_src2, ptr[param2 + offset]);
+      }
+      if (type_ == operand_type::MUL) {
+        vmulps(jmm_dst, jmm_src1, jmm_src2);
+      } else if (type_ == operand_type::ADD) {
+        vaddps(jmm_dst, jmm_src1, jmm_src2);
+      } else if (type_ == operand_type::SUB) {
+        vsubps(jmm_dst, jmm_src1, jmm_src2);
+      }
+      if (with_relu_) {
+        vmaxps(jmm_dst, jmm_zero, jmm_dst);
+      }
+      vmovups(ptr[param3 + offset], jmm_dst);
+      offset += sizeof(float) * float_block<JMM>();
+    }
+    return offset;
+  }
+
   int num_;
   operand_type type_;
   int scalar_index_;
   bool with_relu_;
+  phi::backends::cpu::cpu_isa_t isa_;
   reg64_t param1{abi_param1};
   reg64_t param2{abi_param2};
   reg64_t param3{abi_param3};
@@ -87,16 +121,23 @@ class VXXJitCode : public JitCode {
 
   ymm_t ymm_src1 = ymm_t(0);
   ymm_t ymm_src2 = ymm_t(1);
-  ymm_t ymm_dst = ymm_t(2);
   ymm_t ymm_zero = ymm_t(3);
+
+  zmm_t zmm_src1 = zmm_t(0);
+  zmm_t zmm_src2 = zmm_t(1);
+  zmm_t zmm_zero = zmm_t(3);
 };
 
-#define DECLARE_BLAS_JITCODE(name, op_type, scalar_idx, with_relu)             \
-  class name##JitCode : public VXXJitCode {                                    \
-   public:                                                                     \
-    explicit name##JitCode(int d, size_t code_size, void* code_ptr = nullptr)  \
-        : VXXJitCode(d, op_type, scalar_idx, with_relu, code_size, code_ptr) { \
-    }                                                                          \
+#define DECLARE_BLAS_JITCODE(name, op_type, scalar_idx, with_relu)           \
+  class name##JitCode : public VXXJitCode {                                  \
+   public:                                                                   \
+    explicit name##JitCode(int d,                                            \
+                           phi::backends::cpu::cpu_isa_t isa,                \
+                           size_t code_size,                                 \
+                           void* code_ptr = nullptr)                         \
+        : VXXJitCode(                                                        \
+              d, op_type, scalar_idx, with_relu, isa, code_size, code_ptr) { \
+    }                                                                        \
   };
 
 DECLARE_BLAS_JITCODE(VMul, operand_type::MUL, 0, false);
@@ -24,105 +24,115 @@ namespace phi {
 namespace jit {
 namespace gen {
 
-void EmbSeqPoolJitCode::genCode() {
-  preCode();
-  constexpr int block = YMM_FLOAT_BLOCK;
-  constexpr int max_num_regs = 8;
-  const int num_block = tbl_w_ / block;
-  const int num_groups = num_block / max_num_regs;
-  const size_t block_size = sizeof(float) * block;
-  std::vector<int> groups(num_groups, max_num_regs);
-  int rest_num_regs = num_block % max_num_regs;
-  if (rest_num_regs > 0) {
-    groups.push_back(rest_num_regs);
-  }
-
-  // protect param_dst
-  mov(reg_ptr_param_dst, param_dst);
-  mov(reg_idx_width_in_byte,
-      qword[param_attr + offsetof(emb_seq_pool_attr_t, index_width)]);
-  mov(reg_idx_height,
-      qword[param_attr + offsetof(emb_seq_pool_attr_t, index_height)]);
-  mov(rax, sizeof(int64_t));
-  mul(reg_idx_width_in_byte);
-  mov(reg_idx_width_in_byte, rax);
+template <typename JMM>
+void EmbSeqPoolJitCode::pool_group(int num_regs) {
+  const size_t block_size = sizeof(float) * float_block<JMM>();
   const size_t tbl_width_in_byte = sizeof(float) * tbl_w_;
-  int acc_num_regs = 0;
-  for (int num_regs : groups) {
-    Label l_next_idx_w, l_next_idx_h, l_save_now;
-    xor_(reg_idx_w_i_in_byte, reg_idx_w_i_in_byte);
-    mov(reg_ptr_dst_i, reg_ptr_param_dst);
-    add(reg_ptr_dst_i, acc_num_regs * block_size);
+  Label l_next_idx_w, l_next_idx_h, l_save_now;
+  xor_(reg_idx_w_i_in_byte, reg_idx_w_i_in_byte);
+  mov(reg_ptr_dst_i, reg_ptr_param_dst);
+  add(reg_ptr_dst_i, dst_offset_);
+
+  L(l_next_idx_w);
+  {
+    // h == 0
+    mov(reg_ptr_idx_i, param_idx);
+    add(reg_ptr_idx_i, reg_idx_w_i_in_byte);
+    mov(reg_idx, qword[reg_ptr_idx_i]);
+    mov(rax, tbl_width_in_byte);
+    mul(reg_idx);
+    mov(reg_ptr_tbl_i, rax);        // reg is offset now
+    add(reg_ptr_tbl_i, param_tbl);  // reg is ptr_i now
+    size_t w_offset = 0;
+    for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+      vmovups(JMM(reg_i + num_regs), ptr[reg_ptr_tbl_i + w_offset]);
+      w_offset += block_size;
+    }
+    add(reg_ptr_idx_i, reg_idx_width_in_byte);
 
-    L(l_next_idx_w);
+    // end condition of idx h
+    mov(reg_idx_h_end, reg_idx_height);
+    mov(rax, reg_idx_width_in_byte);
+    mul(reg_idx_h_end);
+    mov(reg_idx_h_end, rax);
+    add(reg_idx_h_end, reg_idx_w_i_in_byte);
+    add(reg_idx_h_end, param_idx);
+
+    cmp(reg_ptr_idx_i, reg_idx_h_end);
+    jge(l_save_now, T_NEAR);
+    L(l_next_idx_h);
     {
-      // h == 0
-      mov(reg_ptr_idx_i, param_idx);
-      add(reg_ptr_idx_i, reg_idx_w_i_in_byte);
       mov(reg_idx, qword[reg_ptr_idx_i]);
+      mov(reg_ptr_tbl_i, reg_idx);
       mov(rax, tbl_width_in_byte);
       mul(reg_idx);
-      mov(reg_ptr_tbl_i, rax);        // reg is offset now
-      add(reg_ptr_tbl_i, param_tbl);  // reg is ptr_i now
+      mov(reg_ptr_tbl_i, rax);
+      add(reg_ptr_tbl_i, param_tbl);
       size_t w_offset = 0;
       for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-        vmovups(ymm_t(reg_i + num_regs), ptr[reg_ptr_tbl_i + w_offset]);
+        vmovups(JMM(reg_i), ptr[reg_ptr_tbl_i + w_offset]);
+        vaddps(JMM(reg_i + num_regs), JMM(reg_i + num_regs), JMM(reg_i));
         w_offset += block_size;
       }
       add(reg_ptr_idx_i, reg_idx_width_in_byte);
+      cmp(reg_ptr_idx_i, reg_idx_h_end);
+      jl(l_next_idx_h, T_NEAR);
+    }  // end of idx h
+    L(l_save_now);
+    // avg or sqrt here, if needed
+    w_offset = 0;
+    for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
+      vmovups(ptr[reg_ptr_dst_i + w_offset], JMM(reg_i + num_regs));
+      w_offset += block_size;
+    }
+    add(reg_ptr_dst_i, tbl_width_in_byte);
+    add(reg_idx_w_i_in_byte, sizeof(int64_t));
+    cmp(reg_idx_w_i_in_byte, reg_idx_width_in_byte);
+    jl(l_next_idx_w, T_NEAR);
+  }  // end of idx w
 
-      // end condition of idx h
-      mov(reg_idx_h_end, reg_idx_height);
-      mov(rax, reg_idx_width_in_byte);
-      mul(reg_idx_h_end);
-      mov(reg_idx_h_end, rax);
-      add(reg_idx_h_end, reg_idx_w_i_in_byte);
-      add(reg_idx_h_end, param_idx);
+  dst_offset_ += num_regs * block_size;
+  add(param_tbl, num_regs * block_size);
+}
 
-      cmp(reg_ptr_idx_i, reg_idx_h_end);
-      jge(l_save_now, T_NEAR);
-      L(l_next_idx_h);
-      {
-        mov(reg_idx, qword[reg_ptr_idx_i]);
-        mov(reg_ptr_tbl_i, reg_idx);
-        mov(rax, tbl_width_in_byte);
-        mul(reg_idx);
-        mov(reg_ptr_tbl_i, rax);
-        add(reg_ptr_tbl_i, param_tbl);
-        size_t w_offset = 0;
-        for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-          vmovups(ymm_t(reg_i), ptr[reg_ptr_tbl_i + w_offset]);
-          vaddps(
-              ymm_t(reg_i + num_regs), ymm_t(reg_i + num_regs), ymm_t(reg_i));
-          w_offset += block_size;
-        }
-        add(reg_ptr_idx_i, reg_idx_width_in_byte);
-        cmp(reg_ptr_idx_i, reg_idx_h_end);
-        jl(l_next_idx_h, T_NEAR);
-      }  // end of idx h
-      L(l_save_now);
-      // avg or sqrt here, if needed
-      w_offset = 0;
-      for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-        vmovups(ptr[reg_ptr_dst_i + w_offset], ymm_t(reg_i + num_regs));
-        w_offset += block_size;
-      }
-      add(reg_ptr_dst_i, tbl_width_in_byte);
-      add(reg_idx_w_i_in_byte, sizeof(int64_t));
-      cmp(reg_idx_w_i_in_byte, reg_idx_width_in_byte);
-      jl(l_next_idx_w, T_NEAR);
-    }  // end of idx w
+template <typename JMM>
+int EmbSeqPoolJitCode::pool_groups(int w, int max_num_regs) {
+  const int num_block = w / float_block<JMM>();
+  for (int i = 0; i < num_block / max_num_regs; ++i) {
+    pool_group<JMM>(max_num_regs);
+  }
+  if (num_block % max_num_regs > 0) {
+    pool_group<JMM>(num_block % max_num_regs);
+  }
+  return w % float_block<JMM>();
+}
 
-    acc_num_regs += num_regs;
-    add(param_tbl, num_regs * block_size);  // do not use acc_num_regs
-  }                                         // end of groups
+void EmbSeqPoolJitCode::genCode() {
+  preCode();
+  // protect param_dst
+  mov(reg_ptr_param_dst, param_dst);
+  mov(reg_idx_width_in_byte,
+      qword[param_attr + offsetof(emb_seq_pool_attr_t, index_width)]);
+  mov(reg_idx_height,
+      qword[param_attr + offsetof(emb_seq_pool_attr_t, index_height)]);
+  mov(rax, sizeof(int64_t));
+  mul(reg_idx_width_in_byte);
+  mov(reg_idx_width_in_byte, rax);
+  dst_offset_ = 0;
+  int rest_w = tbl_w_;
+  // zmm uses zmm16~zmm31 too, so a group has twice as many registers.
+  if (UseZmm(isa_)) {
+    rest_w = pool_groups<zmm_t>(rest_w, 16);
+  }
+  pool_groups<ymm_t>(rest_w, 8);
   postCode();
 }
 
+template <phi::backends::cpu::cpu_isa_t isa>
 class EmbSeqPoolCreator : public JitCodeCreator<emb_seq_pool_attr_t> {
  public:
   bool CanBeUsed(const emb_seq_pool_attr_t& attr) const override {
-    return phi::backends::cpu::MayIUse(phi::backends::cpu::avx) &&
+    return phi::backends::cpu::MayIUse(isa) &&
            attr.table_width % YMM_FLOAT_BLOCK == 0;
   }
   size_t CodeSize(const emb_seq_pool_attr_t& attr) const override {
@@ -160,7 +170,7 @@ class EmbSeqPoolCreator : public JitCodeCreator<emb_seq_pool_attr_t> {
                           "The attribute out_width of EmbSeqPool should be "
                           "larger than 0. But it is %d.",
                           attr.out_width));
-    return make_unique<EmbSeqPoolJitCode>(attr, CodeSize(attr));
+    return make_unique<EmbSeqPoolJitCode>(attr, isa, CodeSize(attr));
   }
 };
 
@@ -169,5 +179,8 @@ class EmbSeqPoolCreator : public JitCodeCreator<emb_seq_pool_attr_t> {
 }  // namespace phi
 
 namespace gen = phi::jit::gen;
+namespace cpu = phi::backends::cpu;
 
-REGISTER_JITKERNEL_GEN(kEmbSeqPool, gen::EmbSeqPoolCreator);
+REGISTER_JITKERNEL_GEN(kEmbSeqPool,
+                       gen::EmbSeqPoolCreator<cpu::avx512f>,
+                       gen::EmbSeqPoolCreator<cpu::avx>);
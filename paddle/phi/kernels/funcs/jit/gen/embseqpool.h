@@ -27,11 +27,13 @@ namespace gen {
 class EmbSeqPoolJitCode : public JitCode {
  public:
   explicit EmbSeqPoolJitCode(const emb_seq_pool_attr_t& attr,
+                             phi::backends::cpu::cpu_isa_t isa,
                              size_t code_size = 256 * 1024,
                              void* code_ptr = nullptr)
       : JitCode(code_size, code_ptr),
         tbl_w_(attr.table_width),
-        type_(attr.pool_type) {
+        type_(attr.pool_type),
+        isa_(isa) {
     if (type_ != SeqPoolType::kSum) {
       PADDLE_THROW(phi::errors::Unimplemented("Only supports sum pool yet."));
     }
@@ -48,13 +50,24 @@ class EmbSeqPoolJitCode : public JitCode {
       base += "_Sqrt";
     }
     base += ("_W" + std::to_string(tbl_w_));
-    return base;
+    return base + IsaSuffix(isa_);
   }
   void genCode() override;
 
  private:
+  // Pools the part of width w that fills whole JMM registers, in groups of at
+  // most max_num_regs registers. Returns the rest width.
+  template <typename JMM>
+  int pool_groups(int w, int max_num_regs);
+  // Pools num_regs JMM registers of the table from param_tbl to dst_offset_.
+  template <typename JMM>
+  void pool_group(int num_regs);
+
   int tbl_w_;
   SeqPoolType type_;
+  phi::backends::cpu::cpu_isa_t isa_;
+  // The offset in bytes of the current group in a row of dst.
+  size_t dst_offset_ = 0;
   reg64_t param_tbl{abi_param1};
   reg64_t param_idx{abi_param2};
   reg64_t param_dst{abi_param3};
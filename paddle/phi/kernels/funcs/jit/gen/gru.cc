@@ -22,81 +22,97 @@
 
 namespace phi::jit::gen {
 
+template <typename JMM>
+void GRUJitCode::compute_block(int offset) {
+  int d = num_ * sizeof(float);  // NOLINT
+  JMM jmm_u = JMM(1);
+  JMM jmm_r = JMM(2);
+  JMM jmm_s = JMM(3);
+  JMM jmm_ht_1 = JMM(4);
+  // W: {W_update, W_reset; W_state}
+  if (id_ == 0 || id_ == 2) {
+    vmovups(jmm_u, ptr[reg_ptr_gates + offset]);
+    vmovups(jmm_s, ptr[reg_ptr_gates + offset + 2 * d]);
+  }
+  if (id_ == 1) {
+    vmovups(jmm_r, ptr[reg_ptr_gates + offset + d]);
+  }
+  if (id_ == 1 || id_ == 2) {
+    vmovups(jmm_ht_1, ptr[reg_ptr_ht_1 + offset]);
+  }
+
+  if (id_ == 0) {
+    // ht = act_gate(u) * act_cand(s)
+    act<JMM>(jmm_u, jmm_u, act_gate_);
+    act<JMM>(jmm_s, jmm_s, act_cand_);
+    vmulps(jmm_s, jmm_s, jmm_u);
+    vmovups(ptr[reg_ptr_ht + offset], jmm_s);
+  } else if (id_ == 1) {
+    // ht = act_gate(r) * ht_1
+    act<JMM>(jmm_r, jmm_r, act_gate_);
+    vmulps(jmm_r, jmm_r, jmm_ht_1);
+    vmovups(ptr[reg_ptr_ht + offset], jmm_r);
+  } else if (id_ == 2) {
+    // ht = act_gate(u) * act_cand(s) + (1-act_gate(u)) * ht_1
+    JMM jmm_one = JMM(0);
+    act<JMM>(jmm_u, jmm_u, act_gate_);
+    act<JMM>(jmm_s, jmm_s, act_cand_);
+    vmulps(jmm_s, jmm_s, jmm_u);
+    vsubps(jmm_u, jmm_one, jmm_u);
+    vmulps(jmm_u, jmm_ht_1, jmm_u);
+    vaddps(jmm_u, jmm_s, jmm_u);
+    vmovups(ptr[reg_ptr_ht + offset], jmm_u);
+  }
+}
+
 void GRUJitCode::genCode() {
-  reg64_t reg_ptr_gates = rax;
-  reg64_t reg_ptr_ht_1 = r9;
-  reg64_t reg_ptr_ht = r10;
   mov(reg_ptr_gates, ptr[param1 + offsetof(gru_t, gates)]);
   mov(reg_ptr_ht_1, ptr[param1 + offsetof(gru_t, ht_1)]);
   mov(reg_ptr_ht, ptr[param1 + offsetof(gru_t, ht)]);
-  ymm_t ymm_one = ymm_t(0);
-
   if (id_ == 2) {
+    // Loaded once in the widest register, the narrower blocks read its lower
+    // lanes.
     reg64_t reg_ptr_tmp = r11;
     mov(reg_ptr_tmp, reinterpret_cast<size_t>(exp_float_consts));
-    vmovaps(ymm_one, ptr[reg_ptr_tmp + OFFSET_EXP_ONE]);
+    if (UseZmm(isa_)) {
+      zmm_t zmm_one = zmm_t(0);
+      load_const(zmm_one, reg_ptr_tmp, OFFSET_EXP_ONE);
+    } else {
+      ymm_t ymm_one = ymm_t(0);
+      vmovaps(ymm_one, ptr[reg_ptr_tmp + OFFSET_EXP_ONE]);
+    }
   }
   int offset = 0;
-  int d = num_ * sizeof(float);  // NOLINT
-  for (int i = 0; i < num_ / YMM_FLOAT_BLOCK; ++i) {
-    ymm_t ymm_u = ymm_t(1);
-    ymm_t ymm_r = ymm_t(2);
-    ymm_t ymm_s = ymm_t(3);
-    ymm_t ymm_ht_1 = ymm_t(4);
-    // W: {W_update, W_reset; W_state}
-    if (id_ == 0 || id_ == 2) {
-      vmovups(ymm_u, ptr[reg_ptr_gates + offset]);
-      vmovups(ymm_s, ptr[reg_ptr_gates + offset + 2 * d]);
-    }
-    if (id_ == 1) {
-      vmovups(ymm_r, ptr[reg_ptr_gates + offset + d]);
-    }
-    if (id_ == 1 || id_ == 2) {
-      vmovups(ymm_ht_1, ptr[reg_ptr_ht_1 + offset]);
-    }
-
-    if (id_ == 0) {
-      // ht = act_gate(u) * act_cand(s)
-      act<ymm_t>(ymm_u, ymm_u, act_gate_);
-      act<ymm_t>(ymm_s, ymm_s, act_cand_);
-      vmulps(ymm_s, ymm_s, ymm_u);
-      vmovups(ptr[reg_ptr_ht + offset], ymm_s);
-    } else if (id_ == 1) {
-      // ht = act_gate(r) * ht_1
-      act<ymm_t>(ymm_r, ymm_r, act_gate_);
-      vmulps(ymm_r, ymm_r, ymm_ht_1);
-      vmovups(ptr[reg_ptr_ht + offset], ymm_r);
-    } else if (id_ == 2) {
-      // ht = act_gate(u) * act_cand(s) + (1-act_gate(u)) * ht_1
-      ymm_t ymm_one_inner = ymm_t(ymm_one.getIdx());
-      act<ymm_t>(ymm_u, ymm_u, act_gate_);
-      act<ymm_t>(ymm_s, ymm_s, act_cand_);
-      vmulps(ymm_s, ymm_s, ymm_u);
-      vsubps(ymm_u, ymm_one_inner, ymm_u);
-      vmulps(ymm_u, ymm_ht_1, ymm_u);
-      vaddps(ymm_u, ymm_s, ymm_u);
-      vmovups(ptr[reg_ptr_ht + offset], ymm_u);
+  int rest = num_;
+  if (UseZmm(isa_)) {
+    for (int i = 0; i < rest / ZMM_FLOAT_BLOCK; ++i) {
+      compute_block<zmm_t>(offset);
+      offset += sizeof(float) * ZMM_FLOAT_BLOCK;
     }
+    rest %= ZMM_FLOAT_BLOCK;
+  }
+  for (int i = 0; i < rest / YMM_FLOAT_BLOCK; ++i) {
+    compute_block<ymm_t>(offset);
     offset += sizeof(float) * YMM_FLOAT_BLOCK;
   }
   ret();
 }
 
-#define DECLARE_GRU_CREATOR(name)                                    \
-  class name##Creator : public JitCodeCreator<gru_attr_t> {          \
-   public:                                                           \
-    /* TODO(TJ): enable more */                                      \
-    bool CanBeUsed(const gru_attr_t& attr) const override {          \
-      return phi::backends::cpu::MayIUse(phi::backends::cpu::avx) && \
-             attr.d % 8 == 0;                                        \
-    }                                                                \
-    size_t CodeSize(const gru_attr_t& attr) const override {         \
-      return 96 + attr.d / YMM_FLOAT_BLOCK * 96 * 2 * 8;             \
-    }                                                                \
-    std::unique_ptr<GenBase> CreateJitCode(                          \
-        const gru_attr_t& attr) const override {                     \
-      return make_unique<name##JitCode>(attr, CodeSize(attr));       \
-    }                                                                \
+#define DECLARE_GRU_CREATOR(name)                                   \
+  template <phi::backends::cpu::cpu_isa_t isa>                      \
+  class name##Creator : public JitCodeCreator<gru_attr_t> {         \
+   public:                                                          \
+    /* TODO(TJ): enable more */                                     \
+    bool CanBeUsed(const gru_attr_t& attr) const override {         \
+      return phi::backends::cpu::MayIUse(isa) && attr.d % 8 == 0;   \
+    }                                                               \
+    size_t CodeSize(const gru_attr_t& attr) const override {        \
+      return 96 + attr.d / YMM_FLOAT_BLOCK * 96 * 2 * 8;            \
+    }                                                               \
+    std::unique_ptr<GenBase> CreateJitCode(                         \
+        const gru_attr_t& attr) const override {                    \
+      return make_unique<name##JitCode>(attr, isa, CodeSize(attr)); \
+    }                                                               \
   }
 
 DECLARE_GRU_CREATOR(GRUH1);
@@ -108,7 +124,14 @@ DECLARE_GRU_CREATOR(GRUHtPart2);
 }  // namespace phi::jit::gen
 
 namespace gen = phi::jit::gen;
+namespace cpu = phi::backends::cpu;
 
-REGISTER_JITKERNEL_GEN(kGRUH1, gen::GRUH1Creator);
-REGISTER_JITKERNEL_GEN(kGRUHtPart1, gen::GRUHtPart1Creator);
-REGISTER_JITKERNEL_GEN(kGRUHtPart2, gen::GRUHtPart2Creator);
+REGISTER_JITKERNEL_GEN(kGRUH1,
+                       gen::GRUH1Creator<cpu::avx512f>,
+                       gen::GRUH1Creator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kGRUHtPart1,
+                       gen::GRUHtPart1Creator<cpu::avx512f>,
+                       gen::GRUHtPart1Creator<cpu::avx>);
+REGISTER_JITKERNEL_GEN(kGRUHtPart2,
+                       gen::GRUHtPart2Creator<cpu::avx512f>,
+                       gen::GRUHtPart2Creator<cpu::avx>);
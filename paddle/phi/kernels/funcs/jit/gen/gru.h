@@ -28,9 +28,10 @@ class GRUJitCode : public VActFunc {
  public:
   explicit GRUJitCode(int id,
                       const gru_attr_t& attr,
+                      phi::backends::cpu::cpu_isa_t isa,
                       size_t code_size,
                       void* code_ptr = nullptr)
-      : VActFunc(code_size, code_ptr), id_(id), num_(attr.d) {
+      : VActFunc(code_size, code_ptr), id_(id), num_(attr.d), isa_(isa) {
     auto typeExchange = [](KernelType type) -> gen::operand_type {
       if (type == KernelType::kVSigmoid) {
         return operand_type::SIGMOID;
@@ -84,25 +85,34 @@ class GRUJitCode : public VActFunc {
     };
     AddTypeStr(act_gate_);
     AddTypeStr(act_cand_);
-    return base;
+    return base + IsaSuffix(isa_);
   }
   void genCode() override;
 
  protected:
+  // Computes ht of one JMM register from offset.
+  template <typename JMM>
+  void compute_block(int offset);
+
   int id_;
   int num_;
+  phi::backends::cpu::cpu_isa_t isa_;
   operand_type act_gate_;
   operand_type act_cand_;
   reg64_t param1{abi_param1};
+  reg64_t reg_ptr_gates{rax};
+  reg64_t reg_ptr_ht_1{r9};
+  reg64_t reg_ptr_ht{r10};
 };
 
-#define DECLARE_GRU_JITCODE(name, id)                  \
-  class name##JitCode : public GRUJitCode {            \
-   public:                                             \
-    explicit name##JitCode(const gru_attr_t& attr,     \
-                           size_t code_size,           \
-                           void* code_ptr = nullptr)   \
-        : GRUJitCode(id, attr, code_size, code_ptr) {} \
+#define DECLARE_GRU_JITCODE(name, id)                         \
+  class name##JitCode : public GRUJitCode {                   \
+   public:                                                    \
+    explicit name##JitCode(const gru_attr_t& attr,            \
+                           phi::backends::cpu::cpu_isa_t isa, \
+                           size_t code_size,                  \
+                           void* code_ptr = nullptr)          \
+        : GRUJitCode(id, attr, isa, code_size, code_ptr) {}   \
   };
 
 DECLARE_GRU_JITCODE(GRUH1, 0);
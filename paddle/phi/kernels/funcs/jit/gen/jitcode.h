@@ -19,6 +19,7 @@
 
 #include "paddle/phi/backends/cpu/cpu_info.h"
 #include "paddle/phi/kernels/funcs/jit/gen_base.h"
+#include "paddle/phi/kernels/funcs/jit/macro.h"
 
 #define XBYAK_USE_MMAP_ALLOCATOR
 #include "xbyak/xbyak.h"
@@ -67,6 +68,17 @@ typedef enum {
 #define DECLARE_JIT_CODE(codename) \
   std::string name() const override { return #codename; }
 
+// The jitcodes that have both AVX and AVX-512 variants take the isa they are
+// generated for. The AVX-512 creators are registered first, so GetJitCode
+// picks them when the CPU supports AVX-512 and falls back to AVX otherwise.
+inline bool UseZmm(phi::backends::cpu::cpu_isa_t isa) {
+  return isa == phi::backends::cpu::avx512f;
+}
+
+inline std::string IsaSuffix(phi::backends::cpu::cpu_isa_t isa) {
+  return UseZmm(isa) ? "_AVX512" : "";
+}
+
 class JitCode : public GenBase, public Xbyak::CodeGenerator {
  public:
   explicit JitCode(size_t code_size, void* code_ptr = nullptr)
@@ -103,6 +115,29 @@ class JitCode : public GenBase, public Xbyak::CodeGenerator {
   }
   void L(const char* label) { Xbyak::CodeGenerator::L(label); }
   void L(Xbyak::Label& label) { Xbyak::CodeGenerator::L(label); }  // NOLINT
+  template <typename JMM>
+  static constexpr bool is_zmm() {
+    return std::is_same<typename std::remove_const<JMM>::type,
+                        Xbyak::Zmm>::value;
+  }
+  // The number of floats in a JMM register.
+  template <typename JMM>
+  static constexpr int float_block() {
+    return is_zmm<JMM>() ? ZMM_FLOAT_BLOCK
+                         : (std::is_same<typename std::remove_const<JMM>::type,
+                                         Xbyak::Ymm>::value
+                                ? YMM_FLOAT_BLOCK
+                                : XMM_FLOAT_BLOCK);
+  }
+  // vxorps of zmm needs AVX512DQ, while vpxord only needs AVX512F.
+  template <typename JMM>
+  void zero_jmm(const JMM& jmm) {
+    if (is_zmm<JMM>()) {
+      vpxord(jmm, jmm, jmm);
+    } else {
+      vxorps(jmm, jmm, jmm);
+    }
+  }
   // Enhanced vector extension
   Xbyak::Address EVEX_compress_addr(Xbyak::Reg64 base,
                                     int offt,
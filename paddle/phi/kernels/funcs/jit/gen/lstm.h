@@ -28,12 +28,14 @@ class LSTMJitCode : public VActFunc {
  public:
   explicit LSTMJitCode(bool compute_c1h1,
                        const lstm_attr_t& attr,
+                       phi::backends::cpu::cpu_isa_t isa,
                        size_t code_size,
                        void* code_ptr = nullptr)
       : VActFunc(code_size, code_ptr),
         num_(attr.d),
         compute_c1h1_(compute_c1h1),
-        use_peephole_(attr.use_peephole) {
+        use_peephole_(attr.use_peephole),
+        isa_(isa) {
     auto typeExchange = [](KernelType type) -> gen::operand_type {
       if (type == KernelType::kVSigmoid) {
         return operand_type::SIGMOID;
@@ -88,27 +90,38 @@ class LSTMJitCode : public VActFunc {
     AddTypeStr(act_gate_);
     AddTypeStr(act_cand_);
     AddTypeStr(act_cell_);
-    return base;
+    return base + IsaSuffix(isa_);
   }
   void genCode() override;
 
  protected:
+  // Computes ct and ht of one JMM register from offset.
+  template <typename JMM>
+  void compute_block(int offset);
+
   int num_;
   bool compute_c1h1_;
   bool use_peephole_;
+  phi::backends::cpu::cpu_isa_t isa_;
   operand_type act_gate_;
   operand_type act_cand_;
   operand_type act_cell_;
   reg64_t param1{abi_param1};
+  reg64_t reg_ptr_gates{rax};
+  reg64_t reg_ptr_ct_1{r9};
+  reg64_t reg_ptr_ct{r10};
+  reg64_t reg_ptr_ht{r11};
+  reg64_t reg_ptr_wp{r12};
 };
 
-#define DECLARE_LSTM_JITCODE(name, compute_c1h1)                  \
-  class name##JitCode : public LSTMJitCode {                      \
-   public:                                                        \
-    explicit name##JitCode(const lstm_attr_t& attr,               \
-                           size_t code_size,                      \
-                           void* code_ptr = nullptr)              \
-        : LSTMJitCode(compute_c1h1, attr, code_size, code_ptr) {} \
+#define DECLARE_LSTM_JITCODE(name, compute_c1h1)                       \
+  class name##JitCode : public LSTMJitCode {                           \
+   public:                                                             \
+    explicit name##JitCode(const lstm_attr_t& attr,                    \
+                           phi::backends::cpu::cpu_isa_t isa,          \
+                           size_t code_size,                           \
+                           void* code_ptr = nullptr)                   \
+        : LSTMJitCode(compute_c1h1, attr, isa, code_size, code_ptr) {} \
   };
 
 DECLARE_LSTM_JITCODE(LSTMCtHt, false);
@@ -21,11 +21,6 @@
 namespace phi::jit::gen {
 
 void SeqPoolJitCode::genCode() {
-  constexpr int block = YMM_FLOAT_BLOCK;
-  constexpr int max_num_regs = 8;
-  const int num_block = w_ / block;
-  const int num_groups = num_block / max_num_regs;
-  int rest_num_regs = num_block % max_num_regs;
   mov(reg32_int_h, dword[param_attr]);
   if (type_ == SeqPoolType::kAvg || type_ == SeqPoolType::kSqrt) {
     mov(reg_tmp, reinterpret_cast<size_t>(exp_float_consts));
@@ -40,24 +35,25 @@ void SeqPoolJitCode::genCode() {
     vdivps(xmm_t(1), xmm_t(1), xmm_t(0));
     vmovss(ptr[reg_tmp], xmm_t(1));
   }
-  const int group_len = max_num_regs * block * sizeof(float);
-  for (int g = 0; g < num_groups; ++g) {
-    pool_height<ymm_t>(g * group_len, block, max_num_regs);
-  }
-  if (rest_num_regs > 0) {
-    pool_height<ymm_t>(num_groups * group_len, block, rest_num_regs);
+  int w_offset = 0;
+  int rest_w = w_;
+  // zmm uses zmm16~zmm31 for loading, so it has twice as many accumulators.
+  if (UseZmm(isa_)) {
+    rest_w = pool_width<zmm_t>(w_offset, rest_w, 16);
+    w_offset = (w_ - rest_w) * sizeof(float);
   }
+  rest_w = pool_width<ymm_t>(w_offset, rest_w, 8);
   // part of rest_w * height
-  const int rest = w_ % block;
   pool_height_of_rest_width(
-      rest, static_cast<int>((w_ - rest) * sizeof(float)), max_num_regs);
+      rest_w, static_cast<int>((w_ - rest_w) * sizeof(float)), 8);
   ret();
 }
 
+template <phi::backends::cpu::cpu_isa_t isa>
 class SeqPoolCreator : public JitCodeCreator<seq_pool_attr_t> {
  public:
   bool CanBeUsed(const seq_pool_attr_t& attr) const override {
-    return phi::backends::cpu::MayIUse(phi::backends::cpu::avx);
+    return phi::backends::cpu::MayIUse(isa);
   }
   size_t CodeSize(const seq_pool_attr_t& attr) const override {
     return 96 + ((attr.w / YMM_FLOAT_BLOCK + 4 /* for rest */) *
@@ -79,12 +75,15 @@ class SeqPoolCreator : public JitCodeCreator<seq_pool_attr_t> {
         phi::errors::InvalidArgument("The attribute height of SeqPool should "
                                      "be larger than 0. But it is %d.",
                                      attr.h));
-    return make_unique<SeqPoolJitCode>(attr, CodeSize(attr));
+    return make_unique<SeqPoolJitCode>(attr, isa, CodeSize(attr));
   }
 };
 
 }  // namespace phi::jit::gen
 
 namespace gen = phi::jit::gen;
+namespace cpu = phi::backends::cpu;
 
-REGISTER_JITKERNEL_GEN(kSeqPool, gen::SeqPoolCreator);
+REGISTER_JITKERNEL_GEN(kSeqPool,
+                       gen::SeqPoolCreator<cpu::avx512f>,
+                       gen::SeqPoolCreator<cpu::avx>);
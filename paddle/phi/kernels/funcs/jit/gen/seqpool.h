@@ -27,9 +27,13 @@ namespace gen {
 class SeqPoolJitCode : public JitCode {
  public:
   explicit SeqPoolJitCode(const seq_pool_attr_t& attr,
+                          phi::backends::cpu::cpu_isa_t isa,
                           size_t code_size = 256 * 1024,
                           void* code_ptr = nullptr)
-      : JitCode(code_size, code_ptr), w_(attr.w), type_(attr.type) {
+      : JitCode(code_size, code_ptr),
+        w_(attr.w),
+        type_(attr.type),
+        isa_(isa) {
     if (!(type_ == SeqPoolType::kSum || type_ == SeqPoolType::kAvg ||
           type_ == SeqPoolType::kSqrt)) {
       PADDLE_THROW(phi::errors::Unimplemented(
@@ -49,11 +53,30 @@ class SeqPoolJitCode : public JitCode {
       base += "_Sqrt";
     }
     base += ("_W" + std::to_string(w_));
-    return base;
+    return base + IsaSuffix(isa_);
   }
   void genCode() override;
 
  protected:
+  // Pools the part of width w from w_offset that fills whole JMM registers,
+  // returns the rest width.
+  template <typename JMM>
+  int pool_width(int w_offset, int w, int max_num_regs) {
+    constexpr int block = float_block<JMM>();
+    const int num_block = w / block;
+    const int num_groups = num_block / max_num_regs;
+    const int rest_num_regs = num_block % max_num_regs;
+    const int group_len = max_num_regs * block * sizeof(float);
+    for (int g = 0; g < num_groups; ++g) {
+      pool_height<JMM>(w_offset + g * group_len, block, max_num_regs);
+    }
+    if (rest_num_regs > 0) {
+      pool_height<JMM>(
+          w_offset + num_groups * group_len, block, rest_num_regs);
+    }
+    return w % block;
+  }
+
   template <typename JMM>
   void pool_height(int w_offset, int block, int max_num_regs) {
     int offset = w_offset;
@@ -206,6 +229,7 @@ class SeqPoolJitCode : public JitCode {
   float ALIGN32_BEG fp_h_[1] ALIGN32_END;
   int w_;
   SeqPoolType type_;
+  phi::backends::cpu::cpu_isa_t isa_;
   reg64_t param_src{abi_param1};
   reg64_t param_dst{abi_param2};
   reg64_t param_attr{abi_param3};
@@ -23,40 +23,48 @@ namespace phi {
 namespace jit {
 namespace gen {
 
+template <typename JMM>
 void SgdJitCode::mainCode(int num_regs) {
-  constexpr size_t block_size = sizeof(float) * YMM_FLOAT_BLOCK;
+  constexpr size_t block_size = sizeof(float) * float_block<JMM>();
+  // lr is broadcasted to the widest register, whose lower lanes are the same.
+  JMM jmm_lr = JMM(ymm_lr.getIdx());
   // load grad
   for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-    vmovups(ymm_t(reg_i), ptr[reg_ptr_grad_i]);
+    vmovups(JMM(reg_i), ptr[reg_ptr_grad_i]);
     add(reg_ptr_grad_i, block_size);
   }
   // load param
   for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-    vmovups(ymm_t(reg_i + num_regs), ptr[reg_ptr_param_i]);
+    vmovups(JMM(reg_i + num_regs), ptr[reg_ptr_param_i]);
     add(reg_ptr_param_i, block_size);
   }
   // compute out
   for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-    vmulps(ymm_t(reg_i), ymm_t(reg_i), ymm_lr);
-    vsubps(ymm_t(reg_i + num_regs), ymm_t(reg_i + num_regs), ymm_t(reg_i));
+    vmulps(JMM(reg_i), JMM(reg_i), jmm_lr);
+    vsubps(JMM(reg_i + num_regs), JMM(reg_i + num_regs), JMM(reg_i));
   }
   // save out
   for (int reg_i = 0; reg_i < num_regs; ++reg_i) {
-    vmovups(ptr[reg_ptr_out_i], ymm_t(reg_i + num_regs));
+    vmovups(ptr[reg_ptr_out_i], JMM(reg_i + num_regs));
     add(reg_ptr_out_i, block_size);
   }
 }
 
 void SgdJitCode::genCode() {
   preCode();
-  constexpr int block = YMM_FLOAT_BLOCK;
+  const bool use_zmm = UseZmm(isa_);
+  const int block = use_zmm ? ZMM_FLOAT_BLOCK : YMM_FLOAT_BLOCK;
   constexpr int max_num_regs = 7;
   const int num_block = w_ / block;
   const int num_groups = num_block / max_num_regs;
   int rest_num_regs = num_block % max_num_regs;
   const size_t width_size = w_ * sizeof(float);
 
-  vbroadcastss(ymm_lr, ptr[param_lr]);
+  if (use_zmm) {
+    vbroadcastss(zmm_lr, ptr[param_lr]);
+  } else {
+    vbroadcastss(ymm_lr, ptr[param_lr]);
+  }
 
   mov(reg_ptr_grad_i, param_grad);
   mov(reg_ptr_rows_i, param_rows);
@@ -89,13 +97,23 @@ void SgdJitCode::genCode() {
       cmp(rax, num_groups);
       jnb(escape_loop, T_NEAR);
 
-      mainCode(max_num_regs);
+      if (use_zmm) {
+        mainCode<zmm_t>(max_num_regs);
+      } else {
+        mainCode<ymm_t>(max_num_regs);
+      }
 
       inc(rax);
       jmp(inner_loop, T_NEAR);
     }
     L(escape_loop);
-    mainCode(rest_num_regs);
+    if (use_zmm) {
+      mainCode<zmm_t>(rest_num_regs);
+      // the width is a multiple of 8, at most one ymm is left
+      mainCode<ymm_t>(w_ % ZMM_FLOAT_BLOCK / YMM_FLOAT_BLOCK);
+    } else {
+      mainCode<ymm_t>(rest_num_regs);
+    }
 
     add(reg_ptr_rows_i, sizeof(int64_t));
 
@@ -105,10 +123,11 @@ void SgdJitCode::genCode() {
   postCode();
 }
 
+template <phi::backends::cpu::cpu_isa_t isa>
 class SgdCreator : public JitCodeCreator<sgd_attr_t> {
  public:
   bool CanBeUsed(const sgd_attr_t& attr) const override {
-    return phi::backends::cpu::MayIUse(phi::backends::cpu::avx) &&
+    return phi::backends::cpu::MayIUse(isa) &&
            attr.grad_width % YMM_FLOAT_BLOCK == 0;
   }
   size_t CodeSize(const sgd_attr_t& attr) const override { return 96 + 32 * 8; }
@@ -137,7 +156,7 @@ class SgdCreator : public JitCodeCreator<sgd_attr_t> {
             "The attribute selected_rows_size of Sgd should be "
             "equal to or larger than 0. But selected_rows_size is %d.",
             attr.selected_rows_size));
-    return make_unique<SgdJitCode>(attr, CodeSize(attr));
+    return make_unique<SgdJitCode>(attr, isa, CodeSize(attr));
   }
 };
 
@@ -146,5 +165,8 @@ class SgdCreator : public JitCodeCreator<sgd_attr_t> {
 }  // namespace phi
 
 namespace gen = phi::jit::gen;
+namespace cpu = phi::backends::cpu;
 
-REGISTER_JITKERNEL_GEN(kSgd, gen::SgdCreator);
+REGISTER_JITKERNEL_GEN(kSgd,
+                       gen::SgdCreator<cpu::avx512f>,
+                       gen::SgdCreator<cpu::avx>);
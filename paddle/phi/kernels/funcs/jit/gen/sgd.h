@@ -27,18 +27,21 @@ namespace gen {
 class SgdJitCode : public JitCode {
  public:
   explicit SgdJitCode(const sgd_attr_t& attr,
+                      phi::backends::cpu::cpu_isa_t isa,
                       size_t code_size = 256 * 1024,
                       void* code_ptr = nullptr)
-      : JitCode(code_size, code_ptr), w_(attr.grad_width) {
+      : JitCode(code_size, code_ptr), w_(attr.grad_width), isa_(isa) {
     this->genCode();
   }
 
-  DECLARE_JIT_CODE(SgdJitCode);
+  std::string name() const override { return "SgdJitCode" + IsaSuffix(isa_); }
   void genCode() override;
+  template <typename JMM>
   void mainCode(int num_regs);
 
  private:
   int w_;
+  phi::backends::cpu::cpu_isa_t isa_;
   reg64_t param_lr{abi_param1};
   reg64_t param_param{abi_param2};
   reg64_t param_grad{abi_param3};
@@ -47,6 +50,7 @@ class SgdJitCode : public JitCode {
   reg64_t param_attr{abi_param6};
 
   ymm_t ymm_lr = ymm_t(15);
+  zmm_t zmm_lr = zmm_t(15);
 
   reg64_t reg_ptr_grad_i{r10};
   reg64_t reg_ptr_rows_i{r11};
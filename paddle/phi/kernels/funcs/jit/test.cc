@@ -79,6 +79,13 @@ void TestAllImpls(const typename KernelTuple::attr_type& attr,
     VLOG(10) << "Test Kernel " << f.first;
     verifier(f.second, args...);
   }
+  // GetAllCandidateFuncsWithTypes only has the jitcode of the best ISA.
+  auto codes = jit::GetAllJitCodes<KernelTuple, PlaceType>(attr);
+  for (auto const& code : codes) {
+    VLOG(10) << "Test JitCode " << code->name();
+    verifier(code->template getCode<typename KernelTuple::func_type>(),
+             args...);
+  }
 }
 
 template <typename KernelTuple, typename PlaceType>
@@ -1145,6 +1152,19 @@ TEST(JITKernel_helper, GetAllCandidateFuncsWithTypes) {
 #endif
 }
 
+TEST(JITKernel_helper, GetAllJitCodes) {
+  auto codes = jit::GetAllJitCodes<jit::VAddTuple<float>, CPUPlace>(100);
+#if !defined(_WIN32) && !defined(__APPLE__) && !defined(__OSX__)
+  if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx512f)) {
+    EXPECT_EQ(codes.size(), 2UL);  // AVX-512, AVX
+  } else if (phi::backends::cpu::MayIUse(phi::backends::cpu::avx)) {
+    EXPECT_EQ(codes.size(), 1UL);  // AVX
+  }
+#endif
+  auto db_codes = jit::GetAllJitCodes<jit::VAddTuple<double>, CPUPlace>(100);
+  EXPECT_EQ(db_codes.size(), 0UL);
+}
+
 TEST(JITKernel_helper, KernelFuncs) {
   auto f1 = jit::KernelFuncs<jit::VAddTuple<float>, CPUPlace>::Cache().At(3);
   auto f2 = jit::KernelFuncs<jit::VAddTuple<float>, CPUPlace>::Cache()[3];
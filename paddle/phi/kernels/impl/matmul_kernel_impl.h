@@ -29,6 +29,10 @@ limitations under the License. */
 #if defined(PADDLE_WITH_CUDA) && CUDA_VERSION >= 11060
 #include "paddle/phi/kernels/autotune/auto_tune_base.h"
 #endif
+#ifdef PADDLE_WITH_MKLML
+#include "paddle/phi/backends/cpu/cpu_context.h"
+#include "paddle/phi/kernels/autotune/cpu_auto_tune.h"
+#endif
 
 namespace phi {
 
@@ -956,6 +960,40 @@ struct MatMulDispatcher<phi::GPUContext, T> {
 
 #endif  // PADDLE_WITH_CUDA
 
+#ifdef PADDLE_WITH_MKLML
+template <typename T>
+struct MatMulDispatcher<phi::CPUContext, T> {
+  void operator()(const phi::CPUContext& ctx,
+                  const DenseTensor& x,
+                  const DenseTensor& y,
+                  const std::vector<std::int64_t>& x_dims,
+                  const std::vector<std::int64_t>& y_dims,
+                  DenseTensor* out,
+                  bool trans_x,
+                  bool trans_y,
+                  bool flag = false) {
+    auto run = [&]() {
+      MatMulFunctionImplWithBlas<phi::CPUContext, T>(
+          ctx, x, y, x_dims, y_dims, out, trans_x, trans_y, flag);
+    };
+    // The tuner runs the matmul several times, it can not accumulate into
+    // the output.
+    if (flag) {
+      run();
+      return;
+    }
+    size_t key = phi::autotune::GenKey(
+        x_dims,
+        y_dims,
+        trans_x,
+        trans_y,
+        static_cast<int64_t>(phi::CppTypeToDataType<T>::Type()));
+    phi::autotune::CpuBlasThreadsAutoTuner::Run(
+        phi::autotune::AlgorithmType::kMatmulCpu, key, run);
+  }
+};
+#endif  // PADDLE_WITH_MKLML
+
 template <typename Context, typename T>
 void MatMulFunction(const Context& ctx,
                     const DenseTensor& x,
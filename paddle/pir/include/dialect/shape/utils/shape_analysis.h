@@ -15,6 +15,7 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include "paddle/pir/include/core/builtin_attribute.h"
 #include "paddle/pir/include/core/builtin_op.h"
@@ -228,6 +229,8 @@ class IR_API ShapeAnalysisManager {
 
  private:
   ShapeAnalysisManager() {}
+  // Kernels of new input shapes are compiled on a background thread.
+  std::mutex mutex_;
   std::unordered_map<uint64_t, std::shared_ptr<ShapeConstraintIRAnalysis>>
       tables_;
 };
@@ -709,6 +709,7 @@ ShapeAnalysisManager& ShapeAnalysisManager::Instance() {
 
 ShapeConstraintIRAnalysis& ShapeAnalysisManager::Get(
     const pir::Program* program) {
+  std::lock_guard<std::mutex> guard(mutex_);
   auto it = tables_.find(program->module_op().operation()->id());
 
   if (it == tables_.end()) {
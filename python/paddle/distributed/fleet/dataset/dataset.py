@@ -1069,6 +1069,93 @@ class InMemoryDataset(DatasetBase):
         if fleet is not None:
             fleet._role_maker.barrier_worker()
 
+    def preload_global_shuffle(self, fleet=None, thread_num=12):
+        """
+        :api_attr: Static Graph
+
+        Global shuffle in async mode.
+        The data is sent to the other trainers while it is loaded by
+        preload_into_memory, so that the shuffle overlaps the training of the
+        current pass. The received data beyond
+        FLAGS_streaming_shuffle_memory_mb is spilled to
+        FLAGS_streaming_shuffle_spill_dir until wait_global_shuffle_done.
+
+        Args:
+            fleet(Fleet): fleet singleton. Default None.
+            thread_num(int): shuffle thread num. Default is 12.
+
+        Examples:
+            .. code-block:: python
+
+                >>> # doctest: +SKIP('No files to read')
+                >>> import paddle
+                >>> paddle.enable_static()
+
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> slots = ["slot1", "slot2", "slot3", "slot4"]
+                >>> slots_vars = []
+                >>> for slot in slots:
+                ...     var = paddle.static.data(
+                ...         name=slot, shape=[None, 1], dtype="int64", lod_level=1)
+                ...     slots_vars.append(var)
+                >>> dataset.init(
+                ...     batch_size=1,
+                ...     thread_num=2,
+                ...     input_type=1,
+                ...     pipe_command="cat",
+                ...     use_var=slots_vars)
+                >>> filelist = ["a.txt", "b.txt"]
+                >>> dataset.set_filelist(filelist)
+                >>> dataset.preload_into_memory()
+                >>> dataset.preload_global_shuffle()
+                >>> dataset.wait_preload_done()
+                >>> dataset.wait_global_shuffle_done()
+
+        """
+        trainer_num = 1
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+            trainer_num = fleet.worker_num()
+        if self.fleet_send_batch_size is None:
+            self.fleet_send_batch_size = 1024
+        self.dataset.register_client2client_msg_handler()
+        self.dataset.set_trainer_num(trainer_num)
+        self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+        self.dataset.pre_global_shuffle(thread_num)
+
+    def wait_global_shuffle_done(self, fleet=None):
+        """
+        :api_attr: Static Graph
+
+        Wait preload_global_shuffle done. Call it after wait_preload_done.
+
+        Args:
+            fleet(Fleet): fleet singleton. Default None.
+
+        Examples:
+            .. code-block:: python
+
+                >>> # doctest: +SKIP('No files to read')
+                >>> import paddle
+                >>> paddle.enable_static()
+
+                >>> dataset = paddle.distributed.InMemoryDataset()
+                >>> filelist = ["a.txt", "b.txt"]
+                >>> dataset.set_filelist(filelist)
+                >>> dataset.preload_into_memory()
+                >>> dataset.preload_global_shuffle()
+                >>> dataset.wait_preload_done()
+                >>> dataset.wait_global_shuffle_done()
+
+        """
+        self.dataset.wait_global_shuffle_done()
+        if self.merge_by_lineid:
+            self.dataset.merge_by_lineid()
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+
     def release_memory(self):
         """
         :api_attr: Static Graph
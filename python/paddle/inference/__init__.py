@@ -17,6 +17,7 @@ from paddle.base.core import (
     PredictorPool,
     XpuConfig,
     _get_phi_kernel_name,
+    convert_to_mmap_params,
     create_predictor,
     get_num_bytes_of_data_type,
     get_trt_compile_version,
@@ -46,6 +47,7 @@ __all__ = [
     '_get_phi_kernel_name',
     'get_trt_compile_version',
     'convert_to_mixed_precision',
+    'convert_to_mmap_params',
     'get_trt_runtime_version',
     'get_num_bytes_of_data_type',
     'PredictorPool',
@@ -3993,9 +3993,10 @@ def sparse_embedding(
         "CommonSparseTable",
         "SSDSparseTable",
         "MemorySparseTable",
+        "MemoryFlatSparseTable",
     ]:
         raise ValueError(
-            "table_class must be in [CommonSparseTable, SSDSparseTable, MemorySparseTable]"
+            "table_class must be in [CommonSparseTable, SSDSparseTable, MemorySparseTable, MemoryFlatSparseTable]"
         )
 
     entry_str = "none"
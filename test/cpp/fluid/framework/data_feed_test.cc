@@ -20,8 +20,11 @@
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>  // NOLINT
+#include <random>
 #include <set>
+#include <string>
 #include <thread>  // NOLINT
 #include <utility>
 #include <vector>
@@ -29,6 +32,7 @@
 #include "google/protobuf/io/zero_copy_stream_impl.h"
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/data_feed_cache.h"
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/scope.h"
@@ -344,3 +348,267 @@ TEST(DataFeed, MultiSlotUnitTest) {
   // GetElemSetFromFile(&file_elem_set, data_feed_desc, filelist);
   // CheckIsUnorderedSame(reader_elem_set, file_elem_set);
 }
+
+TEST(DataFeed, SlotRecordColumnStore) {
+  const int ins_num = 10;
+  std::vector<paddle::framework::SlotRecord> records;
+  paddle::framework::SlotRecordPool().get(&records, ins_num);
+  for (int i = 0; i < ins_num; ++i) {
+    auto& r = records[i];
+    r->ins_id_ = std::to_string(i);
+    // The first uint64 slot is empty for the odd instances.
+    std::vector<std::vector<uint64_t>> uint64_feasigns(2);
+    if (i % 2 == 0) {
+      uint64_feasigns[0] = {static_cast<uint64_t>(i + 1)};
+    }
+    uint64_feasigns[1] = {static_cast<uint64_t>(i), static_cast<uint64_t>(i)};
+    r->slot_uint64_feasigns_.add_slot_feasigns(uint64_feasigns, 3);
+    std::vector<std::vector<float>> float_feasigns(1);
+    float_feasigns[0].assign(i % 3, static_cast<float>(i));
+    r->slot_float_feasigns_.add_slot_feasigns(float_feasigns, i % 3);
+  }
+
+  paddle::framework::SlotRecordColumnStore store;
+  store.Build(&records, 2, 1, 4, 2);
+  EXPECT_TRUE(records.empty());
+  ASSERT_EQ(store.size(), static_cast<size_t>(ins_num));
+  for (int i = 0; i < ins_num; ++i) {
+    const auto& row = store.row(i);
+    EXPECT_EQ(row.chunk, static_cast<uint32_t>(i / 4));
+    EXPECT_EQ(row.row, static_cast<uint32_t>(i % 4));
+    const auto& chunk = *store.chunk(row.chunk);
+    EXPECT_EQ(chunk.ins_id(row.row), std::to_string(i));
+    const auto& empty_or_one = chunk.uint64_column(0);
+    size_t begin = empty_or_one.offsets[row.row];
+    ASSERT_EQ(empty_or_one.offsets[row.row + 1] - begin, 1UL);
+    // An empty uint64 slot is filled with 0.
+    EXPECT_EQ(empty_or_one.values[begin],
+              i % 2 == 0 ? static_cast<uint64_t>(i + 1) : 0UL);
+    const auto& two = chunk.uint64_column(1);
+    EXPECT_EQ(two.offsets[row.row + 1] - two.offsets[row.row], 2UL);
+    const auto& floats = chunk.float_column(0);
+    EXPECT_EQ(floats.offsets[row.row + 1] - floats.offsets[row.row],
+              static_cast<size_t>(i % 3));
+  }
+  EXPECT_TRUE(store.IsContiguous(0, 4));
+  EXPECT_TRUE(store.IsContiguous(8, 2));
+  EXPECT_FALSE(store.IsContiguous(2, 4));
+
+  store.Shuffle(std::mt19937(0));
+  EXPECT_FALSE(store.IsContiguous(0, 4));
+  std::set<std::string> ins_ids;
+  for (size_t i = 0; i < store.size(); ++i) {
+    const auto& row = store.row(i);
+    ins_ids.insert(store.chunk(row.chunk)->ins_id(row.row));
+  }
+  EXPECT_EQ(ins_ids.size(), static_cast<size_t>(ins_num));
+}
+
+#ifdef _LINUX
+TEST(DataFeed, DatasetCache) {
+  namespace cache = paddle::framework::data_feed_cache;
+  char dir[] = "/tmp/dataset_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  FLAGS_dataset_cache_dir = dir;
+  FLAGS_dataset_cache_max_mb = 16;
+
+  // Enough instances for several blocks.
+  const int ins_num = 20000;
+  std::vector<paddle::framework::Record> records(ins_num);
+  for (int i = 0; i < ins_num; ++i) {
+    auto& r = records[i];
+    paddle::framework::FeatureFeasign sign;
+    for (int j = 0; j < i % 50; ++j) {
+      sign.uint64_feasign_ = static_cast<uint64_t>(i + j);
+      r.uint64_feasigns_.emplace_back(sign, j % 3);
+    }
+    sign.float_feasign_ = static_cast<float>(i);
+    r.float_feasigns_.emplace_back(sign, 0);
+    r.ins_id_ = std::to_string(i);
+    r.search_id = i;
+    r.rank = i % 7;
+    r.cmatch = 0;
+  }
+  std::vector<paddle::framework::Record> loaded;
+  auto consume = [&loaded](std::vector<paddle::framework::Record>* ins_vec) {
+    loaded.insert(loaded.end(), ins_vec->begin(), ins_vec->end());
+  };
+  {
+    cache::CacheWriter<paddle::framework::Record> writer("a");
+    for (auto& r : records) {
+      writer.Append(r);
+    }
+    // Destroyed without Finish, nothing is cached.
+  }
+  EXPECT_FALSE(cache::LoadCache<paddle::framework::Record>("a", consume));
+  {
+    cache::CacheWriter<paddle::framework::Record> writer("a");
+    for (auto& r : records) {
+      writer.Append(r);
+    }
+    writer.Finish();
+  }
+  EXPECT_FALSE(cache::LoadCache<paddle::framework::Record>("b", consume));
+  ASSERT_TRUE(cache::LoadCache<paddle::framework::Record>("a", consume));
+  ASSERT_EQ(loaded.size(), records.size());
+  for (int i = 0; i < ins_num; ++i) {
+    ASSERT_EQ(loaded[i].uint64_feasigns_.size(),
+              records[i].uint64_feasigns_.size());
+    for (size_t j = 0; j < loaded[i].uint64_feasigns_.size(); ++j) {
+      EXPECT_EQ(loaded[i].uint64_feasigns_[j].sign().uint64_feasign_,
+                records[i].uint64_feasigns_[j].sign().uint64_feasign_);
+      EXPECT_EQ(loaded[i].uint64_feasigns_[j].slot(),
+                records[i].uint64_feasigns_[j].slot());
+    }
+    EXPECT_EQ(loaded[i].float_feasigns_[0].sign().float_feasign_,
+              static_cast<float>(i));
+    EXPECT_EQ(loaded[i].ins_id_, records[i].ins_id_);
+    EXPECT_EQ(loaded[i].search_id, records[i].search_id);
+    EXPECT_EQ(loaded[i].rank, records[i].rank);
+  }
+
+  // A corrupted payload is ignored, here the size of the first vector.
+  std::string path = cache::CachePath("a");
+  const size_t payload = 4 * sizeof(uint64_t) + 1 + 2 * sizeof(uint64_t);
+  char origin = 0;
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekg(payload + sizeof(uint64_t) - 1);
+    file.get(origin);
+    file.seekp(payload + sizeof(uint64_t) - 1);
+    file.put(static_cast<char>(0x7f));
+  }
+  loaded.clear();
+  EXPECT_FALSE(cache::LoadCache<paddle::framework::Record>("a", consume));
+  EXPECT_TRUE(loaded.empty());
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(payload + sizeof(uint64_t) - 1);
+    file.put(origin);
+  }
+  ASSERT_TRUE(cache::LoadCache<paddle::framework::Record>("a", consume));
+
+  // A truncated file is ignored.
+  struct stat st;
+  ASSERT_EQ(stat(path.c_str(), &st), 0);
+  ASSERT_EQ(truncate(path.c_str(), st.st_size - 1), 0);
+  loaded.clear();
+  EXPECT_FALSE(cache::LoadCache<paddle::framework::Record>("a", consume));
+  EXPECT_TRUE(loaded.empty());
+
+  // Only the most recent files stay under the cap.
+  FLAGS_dataset_cache_max_mb = 1;
+  std::vector<paddle::framework::Record> small(records.begin(),
+                                               records.begin() + 2000);
+  for (const std::string key : {"c", "d", "e"}) {
+    cache::CacheWriter<paddle::framework::Record> writer(key);
+    for (auto& r : small) {
+      writer.Append(r);
+    }
+    writer.Finish();
+    // The mtimes of the files are at least a second apart.
+    sleep(1);
+  }
+  EXPECT_NE(stat(path.c_str(), &st), 0);
+  EXPECT_NE(stat(cache::CachePath("c").c_str(), &st), 0);
+  EXPECT_EQ(stat(cache::CachePath("e").c_str(), &st), 0);
+  EXPECT_LE(st.st_size, 1 << 20);
+
+  for (const std::string key : {"a", "b", "c", "d", "e"}) {
+    unlink(cache::CachePath(key).c_str());
+  }
+  rmdir(dir);
+  FLAGS_dataset_cache_dir = "";
+}
+#endif
+
+#ifdef _LINUX
+TEST(DataFeed, SlotRecordColumnStoreFeed) {
+  paddle::framework::DataFeedDesc data_feed_desc;
+  data_feed_desc.set_name("SlotRecordInMemoryDataFeed");
+  data_feed_desc.set_batch_size(4);
+  for (const auto& name_type :
+       std::vector<std::pair<std::string, std::string>>{{"u", "uint64"},
+                                                        {"f", "float"}}) {
+    auto* slot = data_feed_desc.mutable_multi_slot_desc()->add_slots();
+    slot->set_name(name_type.first);
+    slot->set_type(name_type.second);
+    slot->set_is_dense(false);
+    slot->set_is_used(true);
+  }
+
+  const int ins_num = 10;
+  std::vector<paddle::framework::SlotRecord> records;
+  paddle::framework::SlotRecordPool().get(&records, ins_num);
+  for (int i = 0; i < ins_num; ++i) {
+    auto& r = records[i];
+    std::vector<std::vector<uint64_t>> uint64_feasigns = {
+        {static_cast<uint64_t>(i), static_cast<uint64_t>(i + 100)}};
+    r->slot_uint64_feasigns_.add_slot_feasigns(uint64_feasigns, 2);
+    std::vector<std::vector<float>> float_feasigns(1);
+    float_feasigns[0].assign(i % 2, static_cast<float>(i));
+    r->slot_float_feasigns_.add_slot_feasigns(float_feasigns, i % 2);
+  }
+  auto store = std::make_shared<paddle::framework::SlotRecordColumnStore>();
+  store->Build(&records, 1, 1, 4, 1);
+
+  std::mutex file_mutex;
+  auto channel = paddle::framework::MakeChannel<paddle::framework::SlotRecord>();
+  auto data_feed = paddle::framework::DataFeedFactory::CreateDataFeed(
+      data_feed_desc.name());
+  auto* slot_feed =
+      dynamic_cast<paddle::framework::SlotRecordInMemoryDataFeed*>(
+          data_feed.get());
+  ASSERT_NE(slot_feed, nullptr);
+  data_feed->Init(data_feed_desc);
+  data_feed->SetFileListMutex(&file_mutex);
+  data_feed->SetFileList({});
+  data_feed->SetInputChannel(channel.get());
+  data_feed->SetPlace(phi::CPUPlace());
+  slot_feed->SetColumnStore(store);
+  // In one chunk, in one chunk, across two chunks.
+  const std::vector<std::pair<int, int>> batches = {{0, 4}, {4, 3}, {6, 4}};
+  for (const auto& batch : batches) {
+    slot_feed->AddBatchOffset(batch);
+  }
+  paddle::framework::Scope scope;
+  scope.Var("u");
+  scope.Var("f");
+  data_feed->AssignFeedVar(scope);
+  data_feed->Start();
+
+  for (const auto& batch : batches) {
+    ASSERT_EQ(data_feed->Next(), batch.second);
+    auto* u = scope.FindVar("u")->GetMutable<phi::DenseTensor>();
+    auto* f = scope.FindVar("f")->GetMutable<phi::DenseTensor>();
+    std::vector<int64_t> expect_u;
+    std::vector<float> expect_f;
+    std::vector<size_t> expect_u_lod = {0};
+    std::vector<size_t> expect_f_lod = {0};
+    for (int i = batch.first; i < batch.first + batch.second; ++i) {
+      expect_u.push_back(i);
+      expect_u.push_back(i + 100);
+      expect_u_lod.push_back(expect_u.size());
+      expect_f.insert(expect_f.end(), i % 2, static_cast<float>(i));
+      expect_f_lod.push_back(expect_f.size());
+    }
+    ASSERT_EQ(u->numel(), static_cast<int64_t>(expect_u.size()));
+    EXPECT_EQ(std::vector<int64_t>(u->data<int64_t>(),
+                                   u->data<int64_t>() + u->numel()),
+              expect_u);
+    EXPECT_EQ(u->lod()[0], expect_u_lod);
+    ASSERT_EQ(f->numel(), static_cast<int64_t>(expect_f.size()));
+    EXPECT_EQ(
+        std::vector<float>(f->data<float>(), f->data<float>() + f->numel()),
+        expect_f);
+    EXPECT_EQ(f->lod()[0], expect_f_lod);
+    // The program may write its feed, which must not reach the store.
+    u->data<int64_t>()[0] = -1;
+    const auto& row = store->row(batch.first);
+    const auto& column = store->chunk(row.chunk)->uint64_column(0);
+    EXPECT_EQ(column.values[column.offsets[row.row]],
+              static_cast<uint64_t>(batch.first));
+  }
+  EXPECT_EQ(data_feed->Next(), 0);
+}
+#endif
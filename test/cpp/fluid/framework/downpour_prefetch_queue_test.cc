@@ -0,0 +1,207 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/downpour_prefetch_queue.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+struct FakeBatch {
+  int id = -1;
+  // the number of batches read into this buffer
+  int reuse = 0;
+};
+
+// A reader of `num_batches` batches whose pulls and pushes are logged, the
+// pushes are acked by another thread.
+class FakeWorker {
+ public:
+  explicit FakeWorker(int num_batches) : num_batches_(num_batches) {}
+
+  ~FakeWorker() {
+    for (auto& t : ack_threads_) {
+      t.join();
+    }
+  }
+
+  PrefetchQueue<FakeBatch>::Callbacks Callbacks() {
+    PrefetchQueue<FakeBatch>::Callbacks callbacks;
+    callbacks.read = [this](FakeBatch* batch) {
+      if (num_read_ == num_batches_) {
+        return false;
+      }
+      batch->id = num_read_++;
+      ++batch->reuse;
+      return true;
+    };
+    callbacks.pull = [this](FakeBatch* batch) {
+      Log("pull " + std::to_string(batch->id));
+    };
+    callbacks.release = [this](FakeBatch*) { ++num_released_; };
+    return callbacks;
+  }
+
+  // Pushes the sparse grads of batch `id`, acked after `delay_ms`.
+  std::vector<std::future<int32_t>> Push(int id, int delay_ms) {
+    auto promise = std::make_shared<std::promise<int32_t>>();
+    std::vector<std::future<int32_t>> status;
+    status.push_back(promise->get_future());
+    ack_threads_.emplace_back([this, promise, id, delay_ms] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+      Log("ack " + std::to_string(id));
+      promise->set_value(0);
+    });
+    return status;
+  }
+
+  int Position(const std::string& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < events_.size(); ++i) {
+      if (events_[i] == event) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+  int num_read() const { return num_read_; }
+  int num_released() const { return num_released_; }
+
+ private:
+  void Log(const std::string& event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.push_back(event);
+  }
+
+  const int num_batches_;
+  int num_read_ = 0;
+  int num_released_ = 0;
+  std::mutex mutex_;
+  std::vector<std::string> events_;
+  std::vector<std::thread> ack_threads_;
+};
+
+TEST(PrefetchQueue, ReadsDepthBatchesAhead) {
+  const int depth = 3;
+  FakeWorker worker(10);
+  PrefetchQueue<FakeBatch> queue(depth, -1, worker.Callbacks());
+  EXPECT_EQ(queue.depth(), depth);
+
+  FakeBatch* batch = queue.Next();
+  ASSERT_NE(batch, nullptr);
+  EXPECT_EQ(batch->id, 0);
+  // the batch in training and depth batches behind it
+  EXPECT_EQ(worker.num_read(), depth + 1);
+
+  for (int i = 1; i < 10; ++i) {
+    batch = queue.Next();
+    ASSERT_NE(batch, nullptr);
+    EXPECT_EQ(batch->id, i);
+    EXPECT_EQ(worker.num_read(), std::min(10, i + depth + 1));
+    // the buffers of the trained batches are reused
+    if (i > depth) {
+      EXPECT_GT(batch->reuse, 1);
+    }
+  }
+  EXPECT_EQ(queue.Next(), nullptr);
+  // only depth + 1 buffers are used, all freed once the reader ended
+  EXPECT_EQ(worker.num_released(), depth + 1);
+  queue.End();
+  EXPECT_EQ(worker.num_released(), depth + 1);
+}
+
+TEST(PrefetchQueue, DepthBoundedByStaleness) {
+  FakeWorker worker(10);
+  PrefetchQueue<FakeBatch> queue(4, 1, worker.Callbacks());
+  EXPECT_EQ(queue.depth(), 1);
+  ASSERT_NE(queue.Next(), nullptr);
+  EXPECT_EQ(worker.num_read(), 2);
+}
+
+TEST(PrefetchQueue, PullWaitsForStalePushes) {
+  const int max_staleness = 2;
+  const int num_batches = 12;
+  FakeWorker worker(num_batches);
+  PrefetchQueue<FakeBatch> queue(4, max_staleness, worker.Callbacks());
+  for (int i = 0; i < num_batches; ++i) {
+    FakeBatch* batch = queue.Next();
+    ASSERT_NE(batch, nullptr);
+    EXPECT_EQ(batch->id, i);
+    // the acks are late, the pulls have to wait for them
+    queue.AddPush(worker.Push(i, 5));
+  }
+  EXPECT_EQ(queue.Next(), nullptr);
+  queue.End();
+
+  for (int j = 0; j < num_batches; ++j) {
+    int pull = worker.Position("pull " + std::to_string(j));
+    ASSERT_GE(pull, 0);
+    int stale = j - 1 - max_staleness;
+    if (stale >= 0) {
+      EXPECT_GT(pull, worker.Position("ack " + std::to_string(stale)))
+          << "batch " << j << " is pulled before the push of batch " << stale;
+    }
+  }
+  // End waits for all the pushes
+  for (int j = 0; j < num_batches; ++j) {
+    EXPECT_GE(worker.Position("ack " + std::to_string(j)), 0);
+  }
+}
+
+TEST(PrefetchQueue, PushesInterleaveWithPulls) {
+  // with max staleness 0 the pull of a batch follows the push of the batch
+  // before it, as without prefetch
+  const int num_batches = 6;
+  FakeWorker worker(num_batches);
+  PrefetchQueue<FakeBatch> queue(2, 0, worker.Callbacks());
+  EXPECT_EQ(queue.depth(), 0);
+  for (int i = 0; i < num_batches; ++i) {
+    FakeBatch* batch = queue.Next();
+    ASSERT_NE(batch, nullptr);
+    EXPECT_EQ(batch->id, i);
+    queue.AddPush(worker.Push(i, 1));
+  }
+  EXPECT_EQ(queue.Next(), nullptr);
+  queue.End();
+  for (int j = 1; j < num_batches; ++j) {
+    EXPECT_LT(worker.Position("ack " + std::to_string(j - 1)),
+              worker.Position("pull " + std::to_string(j)));
+  }
+}
+
+TEST(PrefetchQueue, EndDropsBatchesReadAhead) {
+  FakeWorker worker(10);
+  {
+    PrefetchQueue<FakeBatch> queue(3, -1, worker.Callbacks());
+    ASSERT_NE(queue.Next(), nullptr);
+    ASSERT_NE(queue.Next(), nullptr);
+    // pushes are not kept without a max staleness
+    queue.AddPush(worker.Push(1, 0));
+  }
+  // every buffer allocated is freed by the destructor
+  EXPECT_EQ(worker.num_released(), 4);
+}
+
+}  // namespace framework
+}  // namespace paddle
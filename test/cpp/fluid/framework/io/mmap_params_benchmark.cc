@@ -0,0 +1,123 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the time to get the params of a model ready in CPU tensors by
+// reading the .pdiparams file, as load_combine does, with mapping the
+// converted file. Run with --mmap_params_benchmark_mb=4096 for a large
+// model.
+
+#include <unistd.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/io/mmap_params.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+PD_DEFINE_int64(mmap_params_benchmark_mb, 256, "total size of the params");
+PD_DEFINE_int32(mmap_params_benchmark_tensors, 64, "number of the params");
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+size_t ResidentBytes() {
+  std::ifstream statm("/proc/self/statm");
+  size_t pages = 0, resident = 0;
+  statm >> pages >> resident;
+  return resident * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+}  // namespace
+
+TEST(MmapParamsBenchmark, StreamVersusMmap) {
+  const int num = FLAGS_mmap_params_benchmark_tensors;
+  const int64_t numel = FLAGS_mmap_params_benchmark_mb * 1024 * 1024 /
+                        sizeof(float) / num;
+  const std::string params_file = "mmap_params_benchmark.pdiparams";
+  const std::string mmap_file = "mmap_params_benchmark.mmap.pdiparams";
+  {
+    phi::CPUPlace place;
+    std::ofstream fout(params_file, std::ios::binary);
+    for (int i = 0; i < num; ++i) {
+      phi::DenseTensor tensor;
+      tensor.Resize({numel});
+      float* data = tensor.mutable_data<float>(place);
+      for (int64_t j = 0; j < numel; ++j) {
+        data[j] = static_cast<float>(i + j);
+      }
+      SerializeToStream(fout, tensor);
+    }
+  }
+  ConvertToMmapParams(params_file, mmap_file);
+
+  size_t rss_before = ResidentBytes();
+  auto start = std::chrono::steady_clock::now();
+  std::vector<phi::DenseTensor> loaded(num);
+  {
+    std::ifstream fin(params_file, std::ios::binary);
+    for (auto& tensor : loaded) {
+      DeserializeFromStream(fin, &tensor);
+    }
+  }
+  double stream_ms = ElapsedMs(start);
+  double stream_rss = static_cast<double>(ResidentBytes()) - rss_before;
+
+  rss_before = ResidentBytes();
+  start = std::chrono::steady_clock::now();
+  std::vector<phi::DenseTensor> mapped(num);
+  {
+    MmapParamsReader reader(mmap_file);
+    for (int i = 0; i < num; ++i) {
+      reader.GetTensor(i, &mapped[i]);
+    }
+  }
+  double mmap_ms = ElapsedMs(start);
+  double mmap_rss = static_cast<double>(ResidentBytes()) - rss_before;
+
+  LOG(INFO) << FLAGS_mmap_params_benchmark_mb << " MB in " << num
+            << " tensors: stream load " << stream_ms << " ms, +"
+            << stream_rss / 1048576 << " MB resident; mmap load " << mmap_ms
+            << " ms, +" << mmap_rss / 1048576 << " MB resident";
+
+  // Touch every page of the mapped params, as the first run would.
+  start = std::chrono::steady_clock::now();
+  double sum = 0;
+  for (auto& tensor : mapped) {
+    const float* data = tensor.data<float>();
+    for (int64_t j = 0; j < numel; j += 1024) {
+      sum += data[j];
+    }
+  }
+  LOG(INFO) << "first touch of the mapped params " << ElapsedMs(start)
+            << " ms";
+  EXPECT_EQ(mapped.back().data<float>()[numel - 1],
+            loaded.back().data<float>()[numel - 1]);
+  EXPECT_GT(sum, 0);
+}
+
+}  // namespace framework
+}  // namespace paddle
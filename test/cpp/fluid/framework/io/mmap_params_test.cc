@@ -0,0 +1,121 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/io/mmap_params.h"
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+void WriteParams(const std::string& file_path,
+                 const std::vector<phi::DenseTensor>& tensors) {
+  std::ofstream fout(file_path, std::ios::binary);
+  for (auto& tensor : tensors) {
+    SerializeToStream(fout, tensor);
+  }
+}
+
+}  // namespace
+
+TEST(MmapParams, ConvertAndMap) {
+  phi::CPUPlace place;
+  std::vector<phi::DenseTensor> tensors(3);
+  tensors[0].Resize({3, 5});
+  float* data0 = tensors[0].mutable_data<float>(place);
+  for (int i = 0; i < 15; ++i) {
+    data0[i] = static_cast<float>(i) * 0.5f;
+  }
+  tensors[0].set_lod({{0, 1, 3}});
+  tensors[1].Resize({7});
+  int64_t* data1 = tensors[1].mutable_data<int64_t>(place);
+  for (int i = 0; i < 7; ++i) {
+    data1[i] = i * 1000000007LL;
+  }
+  tensors[2].Resize({0, 4});
+  tensors[2].mutable_data<float>(place);
+
+  const std::string params_file = "mmap_params_test.pdiparams";
+  const std::string mmap_file = "mmap_params_test.mmap.pdiparams";
+  WriteParams(params_file, tensors);
+  EXPECT_FALSE(IsMmapParamsFile(params_file));
+  EXPECT_EQ(ConvertToMmapParams(params_file, mmap_file), 3UL);
+  EXPECT_TRUE(IsMmapParamsFile(mmap_file));
+
+  MmapParamsReader reader(mmap_file);
+  ASSERT_EQ(reader.TensorNum(), 3UL);
+  phi::DenseTensor mapped0, mapped1, mapped2;
+  reader.GetTensor(0, &mapped0);
+  reader.GetTensor(1, &mapped1);
+  reader.GetTensor(2, &mapped2);
+
+  EXPECT_EQ(mapped0.dims(), tensors[0].dims());
+  EXPECT_EQ(mapped0.dtype(), phi::DataType::FLOAT32);
+  EXPECT_EQ(mapped0.lod(), tensors[0].lod());
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped0.data()) %
+                kMmapParamsAlignment,
+            0UL);
+  for (int i = 0; i < 15; ++i) {
+    EXPECT_EQ(mapped0.data<float>()[i], data0[i]);
+  }
+  EXPECT_EQ(mapped1.dtype(), phi::DataType::INT64);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped1.data()) %
+                kMmapParamsAlignment,
+            0UL);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_EQ(mapped1.data<int64_t>()[i], data1[i]);
+  }
+  EXPECT_EQ(mapped2.numel(), 0);
+
+  // The mapping is private, writing to a tensor leaves the file unchanged.
+  mapped0.data<float>()[0] = 42.0f;
+  MmapParamsReader another_reader(mmap_file);
+  phi::DenseTensor another0;
+  another_reader.GetTensor(0, &another0);
+  EXPECT_EQ(another0.data<float>()[0], data0[0]);
+
+  EXPECT_ANY_THROW(reader.GetTensor(3, &another0));
+  EXPECT_ANY_THROW(MmapParamsReader reader_of_params(params_file));
+}
+
+TEST(MmapParams, TruncatedFile) {
+  phi::CPUPlace place;
+  std::vector<phi::DenseTensor> tensors(1);
+  tensors[0].Resize({256});
+  tensors[0].mutable_data<float>(place);
+  const std::string params_file = "mmap_params_truncated.pdiparams";
+  const std::string mmap_file = "mmap_params_truncated.mmap.pdiparams";
+  WriteParams(params_file, tensors);
+  ConvertToMmapParams(params_file, mmap_file);
+
+  std::ifstream fin(mmap_file, std::ios::binary);
+  std::string content((std::istreambuf_iterator<char>(fin)),
+                      std::istreambuf_iterator<char>());
+  std::ofstream fout(mmap_file, std::ios::binary | std::ios::trunc);
+  fout.write(content.data(), content.size() - 1);
+  fout.close();
+  EXPECT_ANY_THROW(MmapParamsReader reader(mmap_file));
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,170 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the default work stealing pool with the numa aware one on a large
+// synthetic static graph. The graph is scheduled the same way as the
+// standalone executor does it: an instruction whose dependencies are all
+// finished is either run inline by the producer thread or added to the work
+// queue by the producer thread.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
+#include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr size_t kNumLayers = 200;
+constexpr size_t kOpsPerLayer = 64;
+constexpr size_t kNumInputs = 2;
+constexpr size_t kTensorNumel = 1024;  // 4 KiB per output
+constexpr int kRepeat = 5;
+
+struct FakeInstruction {
+  std::vector<size_t> inputs;
+  std::vector<size_t> outputs;
+  std::vector<float> buffer;
+  size_t num_deps{0};
+  std::atomic<size_t> remain_deps{0};
+};
+
+class FakeStaticGraph {
+ public:
+  FakeStaticGraph() : instrs_(kNumLayers * kOpsPerLayer) {
+    std::mt19937 rng(2024);
+    std::uniform_int_distribution<size_t> dist(0, kOpsPerLayer - 1);
+    for (size_t layer = 0; layer < kNumLayers; ++layer) {
+      for (size_t i = 0; i < kOpsPerLayer; ++i) {
+        size_t id = layer * kOpsPerLayer + i;
+        instrs_[id].buffer.resize(kTensorNumel, 1.0f);
+        if (layer == 0) {
+          continue;
+        }
+        for (size_t k = 0; k < kNumInputs; ++k) {
+          size_t input = (layer - 1) * kOpsPerLayer + dist(rng);
+          instrs_[id].inputs.push_back(input);
+          instrs_[input].outputs.push_back(id);
+        }
+        instrs_[id].num_deps = instrs_[id].inputs.size();
+      }
+    }
+  }
+
+  double Run(WorkQueue* queue) {
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < kRepeat; ++r) {
+      for (auto& instr : instrs_) {
+        instr.remain_deps = instr.num_deps;
+      }
+      unfinished_ = instrs_.size();
+      std::promise<void> done;
+      done_ = &done;
+      auto finished = done.get_future();
+      for (size_t i = 0; i < kOpsPerLayer; ++i) {
+        queue->AddTask([this, queue, i]() { RunAsync(queue, i); });
+      }
+      finished.wait();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() /
+           kRepeat;
+  }
+
+ private:
+  void RunInstruction(size_t id) {
+    auto& instr = instrs_[id];
+    float* out = instr.buffer.data();
+    for (size_t input : instr.inputs) {
+      const float* in = instrs_[input].buffer.data();
+      for (size_t j = 0; j < kTensorNumel; ++j) {
+        out[j] = out[j] * 0.5f + in[j] * 0.5f;
+      }
+    }
+  }
+
+  void RunAsync(WorkQueue* queue, size_t id) {
+    while (true) {
+      RunInstruction(id);
+      if (unfinished_.fetch_sub(1) == 1) {
+        done_->set_value();
+        return;
+      }
+      // The first ready consumer runs inline, the others go through the queue
+      // from this (producer) thread.
+      size_t next = instrs_.size();
+      for (size_t out : instrs_[id].outputs) {
+        if (instrs_[out].remain_deps.fetch_sub(1) != 1) {
+          continue;
+        }
+        if (next == instrs_.size()) {
+          next = out;
+        } else {
+          queue->AddTask([this, queue, out]() { RunAsync(queue, out); });
+        }
+      }
+      if (next == instrs_.size()) {
+        return;
+      }
+      id = next;
+    }
+  }
+
+  std::vector<FakeInstruction> instrs_;
+  std::atomic<size_t> unfinished_{0};
+  std::promise<void>* done_{nullptr};
+};
+
+double RunGraph(FakeStaticGraph* graph, size_t num_threads, bool numa_aware) {
+  WorkQueueOptions options(/*name*/ "HostTasks",
+                           /*num_threads*/ num_threads,
+                           /*allow_spinning*/ true,
+                           /*track_task*/ false);
+  options.numa_aware = numa_aware;
+  auto queue = CreateMultiThreadedWorkQueue(options);
+  // warm up
+  graph->Run(queue.get());
+  return graph->Run(queue.get());
+}
+
+}  // namespace
+
+TEST(WorkQueueBenchmark, NumaAwareStaticGraph) {
+  size_t num_threads =
+      std::max<size_t>(std::thread::hardware_concurrency(), 2u);
+  FakeStaticGraph graph;
+  double default_ms = RunGraph(&graph, num_threads, false);
+  double numa_ms = RunGraph(&graph, num_threads, true);
+  LOG(INFO) << "Static graph of " << kNumLayers * kOpsPerLayer
+            << " instructions, " << num_threads << " threads, "
+            << GetNumaNodeCpus().size() << " numa nodes";
+  LOG(INFO) << "default pool: " << default_ms << " ms/run";
+  LOG(INFO) << "numa aware pool: " << numa_ms << " ms/run";
+  EXPECT_GT(default_ms, 0.0);
+  EXPECT_GT(numa_ms, 0.0);
+}
+
+}  // namespace framework
+}  // namespace paddle
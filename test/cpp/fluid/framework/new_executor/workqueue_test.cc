@@ -15,10 +15,14 @@
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue.h"
 
 #include <atomic>
+#include <set>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/framework/new_executor/workqueue/nonblocking_threadpool.h"
 #include "paddle/fluid/framework/new_executor/workqueue/workqueue_utils.h"
 
 TEST(WorkQueueUtils, TestEventsWaiter) {
@@ -203,3 +207,118 @@ TEST(WorkQueue, TestWorkQueueGroup) {
   queue_group.reset();
   waiter_thread.join();
 }
+
+TEST(WorkQueue, TestNumaAwareWorkQueue) {
+  using paddle::framework::CreateMultiThreadedWorkQueue;
+  using paddle::framework::EventsWaiter;
+  using paddle::framework::WorkQueueOptions;
+  // Threads are only pinned on machines with more than one NUMA node.
+  if (paddle::framework::GetNumaNodeCpus().size() < 2) {
+    GTEST_SKIP() << "Requires more than one NUMA node.";
+  }
+  std::atomic<unsigned> counter{0};
+  constexpr unsigned kExternalLoopNum = 100;
+  constexpr unsigned kNestedLoopNum = 10;
+  EventsWaiter events_waiter;
+  WorkQueueOptions options(/*name*/ "NumaAwareWorkQueueForTesting",
+                           /*num_threads*/ 8,
+                           /*allow_spinning*/ true,
+                           /*always_spinning*/ false,
+                           /*track_task*/ true,
+                           /*detached*/ true,
+                           &events_waiter);
+  options.numa_aware = true;
+  auto work_queue = CreateMultiThreadedWorkQueue(options);
+  EXPECT_EQ(work_queue->NumThreads(), 8u);
+  auto* queue = work_queue.get();
+  auto count = [&counter]() { ++counter; };
+  for (unsigned i = 0; i < kExternalLoopNum; ++i) {
+    work_queue->AddTask([queue, count]() {
+      count();
+      for (unsigned j = 0; j < kNestedLoopNum; ++j) {
+        queue->AddTask(count);
+      }
+    });
+  }
+  events_waiter.WaitEvent();
+  EXPECT_EQ(counter.load(), kExternalLoopNum * (kNestedLoopNum + 1));
+  auto handle = work_queue->AddAwaitableTask([]() { return 4321; });
+  EXPECT_EQ(handle.get(), 4321);
+}
+
+TEST(WorkQueue, TestNumaNodeHint) {
+  using paddle::framework::NonblockingThreadPool;
+  if (paddle::framework::GetNumaNodeCpus().size() < 2) {
+    GTEST_SKIP() << "Requires more than one NUMA node.";
+  }
+  constexpr unsigned kLoopNum = 200;
+  std::atomic<unsigned> finished{0};
+  std::atomic<unsigned> misplaced{0};
+  NonblockingThreadPool pool(/*name*/ "NumaHintPoolForTesting",
+                             /*num_threads*/ 8,
+                             /*allow_spinning*/ true,
+                             /*always_spinning*/ false,
+                             /*numa_aware*/ true);
+  // Destroyed first, its workers add tasks to the pool.
+  NonblockingThreadPool other(/*name*/ "OtherPoolForTesting",
+                              /*num_threads*/ 2,
+                              /*allow_spinning*/ true,
+                              /*always_spinning*/ false,
+                              /*numa_aware*/ true);
+  ASSERT_GE(pool.NumNumaNodes(), 2u);
+  const int num_nodes = static_cast<int>(pool.NumNumaNodes());
+  EXPECT_EQ(pool.CurrentThreadNumaNode(), -1);
+  // Every worker of the pool is on a node, the node of a thread is only
+  // known to its own pool.
+  auto check = [&]() {
+    int node = pool.CurrentThreadNumaNode();
+    if (node < 0 || node >= num_nodes || other.CurrentThreadNumaNode() != -1) {
+      ++misplaced;
+    }
+    ++finished;
+  };
+  for (unsigned i = 0; i < kLoopNum; ++i) {
+    other.AddTask([&, i]() {
+      if (pool.CurrentThreadNumaNode() != -1) {
+        ++misplaced;
+      }
+      // Workers of the pool add tasks to their own node and to the others.
+      pool.AddTask([&, i]() {
+        check();
+        pool.AddTask(check);
+        pool.AddTaskOnNumaNode(check, static_cast<int>(i) % num_nodes);
+      });
+    });
+  }
+  while (finished.load() < 3 * kLoopNum) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(misplaced.load(), 0u);
+}
+
+TEST(WorkQueueUtils, TestNumaNodeCpus) {
+  using paddle::framework::ParseCpuList;
+  EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"),
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(ParseCpuList("5"), std::vector<int>({5}));
+  EXPECT_TRUE(ParseCpuList("").empty());
+
+  // Every node of this host has cpus, and no cpu is on two nodes.
+  std::set<int> seen_cpus;
+  for (const auto& cpus : paddle::framework::GetNumaNodeCpus()) {
+    EXPECT_FALSE(cpus.empty());
+    for (int cpu : cpus) {
+      EXPECT_GE(cpu, 0);
+      EXPECT_TRUE(seen_cpus.insert(cpu).second) << "cpu " << cpu;
+    }
+  }
+  EXPECT_FALSE(seen_cpus.empty());
+}
+
+TEST(WorkQueueUtils, TestSplitThreadsByNumaNode) {
+  using paddle::framework::SplitThreadsByNumaNode;
+  using Ranges = std::vector<std::pair<unsigned, unsigned>>;
+  EXPECT_EQ(SplitThreadsByNumaNode(8, 2), Ranges({{0, 4}, {4, 8}}));
+  EXPECT_EQ(SplitThreadsByNumaNode(8, 3), Ranges({{0, 3}, {3, 6}, {6, 8}}));
+  EXPECT_EQ(SplitThreadsByNumaNode(3, 3), Ranges({{0, 1}, {1, 2}, {2, 3}}));
+}
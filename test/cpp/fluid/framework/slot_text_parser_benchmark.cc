@@ -0,0 +1,204 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares strtoull/strtof with slot_text on a synthetic MultiSlot text
+// file, parsed from an mmaped buffer by several threads that each take a
+// range of lines.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/framework/slot_text_parser.h"
+
+PD_DEFINE_int64(slot_text_benchmark_mb, 2048, "size of the synthetic file");
+PD_DEFINE_string(slot_text_benchmark_file,
+                 "/tmp/slot_text_benchmark.txt",
+                 "path of the synthetic file");
+
+namespace paddle {
+namespace framework {
+namespace slot_text {
+
+namespace {
+
+constexpr int kUInt64Slots = 20;
+constexpr int kFloatSlots = 4;
+
+// Lines like "2 6107293851 27194 1 0.25 ...", ids of a few slots per
+// instance and short floats for the dense slots.
+void WriteFile(const std::string& path, size_t bytes) {
+  FILE* fp = fopen(path.c_str(), "w");
+  ASSERT_NE(fp, nullptr);
+  std::mt19937_64 rng(0);
+  std::string line;
+  size_t written = 0;
+  while (written < bytes) {
+    line.clear();
+    for (int i = 0; i < kUInt64Slots; ++i) {
+      int num = static_cast<int>(rng() % 4) + 1;
+      line += std::to_string(num);
+      for (int j = 0; j < num; ++j) {
+        line += ' ';
+        line += std::to_string(rng() >> (rng() % 48));
+      }
+      line += ' ';
+    }
+    for (int i = 0; i < kFloatSlots; ++i) {
+      line += "1 ";
+      line += std::to_string(static_cast<double>(rng() % 100000) / 1000);
+      line += ' ';
+    }
+    line.back() = '\n';
+    fwrite(line.data(), 1, line.size(), fp);
+    written += line.size();
+  }
+  fclose(fp);
+}
+
+struct Checksum {
+  uint64_t ids = 0;
+  double floats = 0;
+};
+
+// Parses the lines of [p, end) the way the data feeds do, slot by slot.
+template <typename Parser>
+Checksum ParseLines(const char* p, const char* end, Parser parser) {
+  Checksum sum;
+  while (p < end) {
+    const char* line_end =
+        static_cast<const char*>(memchr(p, '\n', end - p));
+    if (line_end == nullptr) {
+      line_end = end;
+    }
+    for (int i = 0; i < kUInt64Slots + kFloatSlots; ++i) {
+      uint64_t num = 0;
+      p = parser.ParseUInt64(p, line_end, &num);
+      for (uint64_t j = 0; j < num; ++j) {
+        if (i < kUInt64Slots) {
+          uint64_t id = 0;
+          p = parser.ParseUInt64(p, line_end, &id);
+          sum.ids += id;
+        } else {
+          float value = 0;
+          p = parser.ParseFloat(p, line_end, &value);
+          sum.floats += value;
+        }
+      }
+    }
+    p = line_end + 1;
+  }
+  return sum;
+}
+
+struct LibcParser {
+  const char* ParseUInt64(const char* p, const char*, uint64_t* v) const {
+    char* endptr = nullptr;
+    *v = strtoull(p, &endptr, 10);
+    return endptr;
+  }
+  const char* ParseFloat(const char* p, const char*, float* v) const {
+    char* endptr = nullptr;
+    *v = strtof(p, &endptr);
+    return endptr;
+  }
+};
+
+struct SlotTextParser {
+  const char* ParseUInt64(const char* p, const char* end, uint64_t* v) const {
+    return slot_text::ParseUInt64(p, end, v);
+  }
+  const char* ParseFloat(const char* p, const char* end, float* v) const {
+    return slot_text::ParseFloat(p, end, v);
+  }
+};
+
+template <typename Parser>
+Checksum ParseInParallel(const char* data,
+                         size_t size,
+                         int thread_num,
+                         Parser parser,
+                         double* mb_per_second) {
+  auto start = std::chrono::steady_clock::now();
+  auto bounds = SplitLines(data, size, thread_num);
+  std::vector<Checksum> sums(bounds.size() - 1);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      sums[i] = ParseLines(data + bounds[i], data + bounds[i + 1], parser);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  *mb_per_second = size / 1024.0 / 1024.0 / seconds;
+  Checksum total;
+  for (auto& sum : sums) {
+    total.ids += sum.ids;
+    total.floats += sum.floats;
+  }
+  return total;
+}
+
+}  // namespace
+
+TEST(SlotTextParserBenchmark, MultiSlotFile) {
+  const std::string path = FLAGS_slot_text_benchmark_file;
+  WriteFile(path, FLAGS_slot_text_benchmark_mb << 20);
+  int fd = open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  struct stat st;
+  ASSERT_EQ(fstat(fd, &st), 0);
+  size_t size = st.st_size;
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ASSERT_NE(mapped, MAP_FAILED);
+  const char* data = static_cast<const char*>(mapped);
+
+  int max_threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  for (int thread_num : {1, max_threads}) {
+    double libc_rate = 0;
+    double slot_text_rate = 0;
+    auto libc_sum =
+        ParseInParallel(data, size, thread_num, LibcParser(), &libc_rate);
+    auto slot_text_sum = ParseInParallel(
+        data, size, thread_num, SlotTextParser(), &slot_text_rate);
+    EXPECT_EQ(libc_sum.ids, slot_text_sum.ids);
+    EXPECT_DOUBLE_EQ(libc_sum.floats, slot_text_sum.floats);
+    LOG(INFO) << thread_num << " threads: strtoull/strtof " << libc_rate
+              << " MB/s, slot_text " << slot_text_rate << " MB/s";
+  }
+  munmap(mapped, size);
+  close(fd);
+  unlink(path.c_str());
+}
+
+}  // namespace slot_text
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,158 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/slot_text_parser.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace slot_text {
+
+namespace {
+
+void CheckUInt64(const std::string& text) {
+  const char* str = text.c_str();
+  char* expected_end = nullptr;
+  uint64_t expected = strtoull(str, &expected_end, 10);
+  uint64_t value = 1;
+  const char* end = ParseUInt64(str, str + text.size(), &value);
+  EXPECT_EQ(value, expected) << text;
+  EXPECT_EQ(end, expected_end) << text;
+}
+
+void CheckFloat(const std::string& text) {
+  const char* str = text.c_str();
+  char* expected_end = nullptr;
+  float expected = strtof(str, &expected_end);
+  float value = 1;
+  const char* end = ParseFloat(str, str + text.size(), &value);
+  // Compares the bits, which tells -0 from 0.
+  EXPECT_EQ(std::memcmp(&value, &expected, sizeof(float)), 0)
+      << text << " " << value << " " << expected;
+  EXPECT_EQ(end, expected_end) << text;
+}
+
+}  // namespace
+
+TEST(SlotTextParser, UInt64) {
+  for (const char* text : {"0",
+                           " 1",
+                           "12345678",
+                           "123456789",
+                           "18446744073709551615",
+                           "18446744073709551616",
+                           "99999999999999999999",
+                           "0000000000000000000012",
+                           "-1",
+                           "+7",
+                           "",
+                           " ",
+                           "abc",
+                           "42 43",
+                           "4242424242424242 1"}) {
+    CheckUInt64(text);
+  }
+  std::mt19937_64 rng(0);
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t v = rng() >> (rng() % 64);
+    CheckUInt64(" " + std::to_string(v) + " 1");
+  }
+}
+
+TEST(SlotTextParser, Int) {
+  const std::string text = "3 2147483647 12345678901 -5";
+  const char* end = text.c_str() + text.size();
+  int num = 0;
+  const char* p = ParseInt(text.c_str(), end, &num);
+  EXPECT_EQ(num, 3);
+  p = ParseInt(p, end, &num);
+  EXPECT_EQ(num, 2147483647);
+  char* expected_end = nullptr;
+  int expected = static_cast<int>(strtol(p, &expected_end, 10));
+  p = ParseInt(p, end, &num);
+  EXPECT_EQ(num, expected);
+  EXPECT_EQ(p, expected_end);
+  p = ParseInt(p, end, &num);
+  EXPECT_EQ(num, -5);
+  EXPECT_EQ(p, end);
+}
+
+TEST(SlotTextParser, Float) {
+  for (const char* text : {"0",
+                           "-0",
+                           "0.0",
+                           "1.5",
+                           "-2.25",
+                           "0.1",
+                           "0.3333333",
+                           "16777216",
+                           "16777217",
+                           "0.00000000001",
+                           "123456789.123",
+                           "1e10",
+                           "1.5E-3",
+                           ".5",
+                           "-.5",
+                           "5.",
+                           ".",
+                           "-",
+                           "inf",
+                           "-nan",
+                           "0x1p3",
+                           "+1.5",
+                           "3.4028235e38",
+                           "1 2"}) {
+    CheckFloat(text);
+  }
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-1000.0f, 1000.0f);
+  char buf[64];
+  for (int i = 0; i < 10000; ++i) {
+    snprintf(buf, sizeof(buf), " %.*f 1", static_cast<int>(rng() % 8),
+             dist(rng));
+    CheckFloat(buf);
+  }
+}
+
+TEST(SlotTextParser, SplitLines) {
+  std::string text;
+  for (int i = 0; i < 100; ++i) {
+    text += std::string(i % 7 + 1, 'a') + "\n";
+  }
+  for (size_t parts : {1, 2, 3, 8, 1000}) {
+    auto bounds = SplitLines(text.data(), text.size(), parts);
+    ASSERT_GE(bounds.size(), 2UL);
+    EXPECT_LE(bounds.size(), parts + 1);
+    EXPECT_EQ(bounds.front(), 0UL);
+    EXPECT_EQ(bounds.back(), text.size());
+    for (size_t i = 1; i < bounds.size(); ++i) {
+      EXPECT_LT(bounds[i - 1], bounds[i]);
+      EXPECT_EQ(text[bounds[i] - 1], '\n');
+    }
+  }
+  // A last line without '\n' stays in the last range.
+  std::string no_newline = "1 2\n3 4";
+  auto bounds = SplitLines(no_newline.data(), no_newline.size(), 4);
+  EXPECT_EQ(bounds, std::vector<size_t>({0, 4, 7}));
+}
+
+}  // namespace slot_text
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,172 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/streaming_shuffle.h"
+
+#include <future>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+using Ins = std::pair<uint64_t, std::string>;
+
+// Shuffles the records of `rank_num` ranks in one process, the senders call
+// the receivers directly. Returns the records each rank receives.
+std::vector<std::vector<Ins>> Shuffle(int rank_num,
+                                      uint64_t ins_num,
+                                      size_t memory_bytes,
+                                      std::vector<size_t>* spill_bytes) {
+  std::vector<std::unique_ptr<StreamingShuffleReceiver<Ins>>> receivers;
+  for (int r = 0; r < rank_num; ++r) {
+    receivers.emplace_back(
+        new StreamingShuffleReceiver<Ins>(memory_bytes, "/tmp"));
+  }
+  auto send = [&receivers](int rank, const std::string& msg) {
+    receivers[rank]->Receive(msg);
+    std::promise<int32_t> done;
+    done.set_value(0);
+    return done.get_future();
+  };
+  auto rank_of = [rank_num](const Ins& ins) {
+    return static_cast<int>(ins.first % rank_num);
+  };
+
+  std::vector<std::unique_ptr<StreamingShuffleSender<Ins>>> senders;
+  std::vector<std::thread> loaders;
+  for (int r = 0; r < rank_num; ++r) {
+    senders.emplace_back(
+        new StreamingShuffleSender<Ins>(rank_num, 100, send, rank_of));
+    auto input = MakeChannel<Ins>();
+    senders.back()->Start(input, 2);
+    // The records are sent while they are still being loaded.
+    loaders.emplace_back([input, r, ins_num]() {
+      for (uint64_t i = 0; i < ins_num; ++i) {
+        uint64_t id = r * ins_num + i;
+        input->Put(Ins(id, std::to_string(id)));
+      }
+      input->Close();
+    });
+  }
+  for (auto& t : loaders) {
+    t.join();
+  }
+
+  // Every rank drains once all the end messages arrive, without waiting for
+  // the senders.
+  std::vector<std::vector<Ins>> received(rank_num);
+  std::vector<std::thread> drains;
+  for (int r = 0; r < rank_num; ++r) {
+    drains.emplace_back([&, r]() {
+      std::vector<Channel<Ins>> outputs;
+      for (int i = 0; i < 3; ++i) {
+        outputs.push_back(MakeChannel<Ins>());
+      }
+      receivers[r]->Drain(rank_num, &outputs);
+      for (auto& output : outputs) {
+        std::vector<Ins> data;
+        output->Close();
+        output->ReadAll(data);
+        received[r].insert(received[r].end(), data.begin(), data.end());
+      }
+    });
+  }
+  for (auto& t : drains) {
+    t.join();
+  }
+  for (int r = 0; r < rank_num; ++r) {
+    senders[r]->Wait();
+    EXPECT_EQ(senders[r]->SendNum(), ins_num);
+    EXPECT_LE(receivers[r]->PeakMemoryBytes(), memory_bytes);
+    spill_bytes->push_back(receivers[r]->SpillBytes());
+  }
+  return received;
+}
+
+void CheckReceived(const std::vector<std::vector<Ins>>& received,
+                   uint64_t ins_num) {
+  const int rank_num = received.size();
+  std::vector<bool> seen(rank_num * ins_num, false);
+  for (int r = 0; r < rank_num; ++r) {
+    for (auto& ins : received[r]) {
+      ASSERT_LT(ins.first, seen.size());
+      EXPECT_EQ(ins.first % rank_num, static_cast<uint64_t>(r));
+      EXPECT_EQ(ins.second, std::to_string(ins.first));
+      EXPECT_FALSE(seen[ins.first]);
+      seen[ins.first] = true;
+    }
+  }
+  for (size_t i = 0; i < seen.size(); ++i) {
+    EXPECT_TRUE(seen[i]) << i;
+  }
+}
+
+}  // namespace
+
+TEST(StreamingShuffle, InMemory) {
+  const uint64_t ins_num = 10000;
+  std::vector<size_t> spill_bytes;
+  auto received = Shuffle(4, ins_num, 64 << 20, &spill_bytes);
+  CheckReceived(received, ins_num);
+  for (size_t bytes : spill_bytes) {
+    EXPECT_EQ(bytes, 0UL);
+  }
+}
+
+TEST(StreamingShuffle, Spill) {
+  const uint64_t ins_num = 10000;
+  std::vector<size_t> spill_bytes;
+  // Far less than the records of a rank, most of them are spilled.
+  auto received = Shuffle(4, ins_num, 16 << 10, &spill_bytes);
+  CheckReceived(received, ins_num);
+  for (size_t bytes : spill_bytes) {
+    EXPECT_GT(bytes, 0UL);
+  }
+}
+
+TEST(StreamingShuffle, NoSenderThread) {
+  StreamingShuffleReceiver<Ins> receiver(64 << 20, "/tmp");
+  auto send = [&receiver](int, const std::string& msg) {
+    receiver.Receive(msg);
+    std::promise<int32_t> done;
+    done.set_value(0);
+    return done.get_future();
+  };
+  StreamingShuffleSender<Ins> sender(
+      1, 100, send, [](const Ins&) { return 0; });
+  auto input = MakeChannel<Ins>();
+  input->Close();
+  // Without a sender thread no end message is sent.
+  ASSERT_THROW(sender.Start(input, 0), paddle::platform::EnforceNotMet);
+  ASSERT_THROW(sender.Start(input, -1), paddle::platform::EnforceNotMet);
+
+  // The sender can still be started, and ends the empty stream.
+  sender.Start(input, 1);
+  std::vector<Channel<Ins>> outputs = {MakeChannel<Ins>()};
+  receiver.Drain(1, &outputs);
+  sender.Wait();
+  EXPECT_EQ(sender.SendNum(), 0UL);
+  EXPECT_EQ(outputs[0]->Size(), 0UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Multi-threaded alloc/free throughput of small CPU allocations, with and
+// without a SlabAllocator in front of AutoGrowthBestFitAllocator.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/memory/allocation/auto_growth_best_fit_allocator.h"
+#include "paddle/fluid/memory/allocation/cpu_allocator.h"
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+namespace {
+
+constexpr int kNumOpsPerThread = 200000;
+constexpr int kLiveAllocations = 64;
+
+// Returns million alloc/free pairs per second.
+double RunBenchmark(const std::shared_ptr<Allocator>& allocator,
+                    int num_threads) {
+  auto worker = [&allocator](int seed) {
+    std::mt19937 rng(seed);
+    // Activation sized requests, mostly below 16KB.
+    std::geometric_distribution<size_t> dist(1.0 / 4096);
+    std::vector<AllocationPtr> live(kLiveAllocations);
+    for (int i = 0; i < kNumOpsPerThread; ++i) {
+      size_t size = std::min<size_t>(dist(rng) + 1, SlabAllocator::kMaxSlabSize);
+      live[i % kLiveAllocations] = allocator->Allocate(size);
+    }
+  };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back(worker, t);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  return num_threads * kNumOpsPerThread / seconds / 1e6;
+}
+
+std::shared_ptr<Allocator> MakeAutoGrowthAllocator() {
+  return std::make_shared<AutoGrowthBestFitAllocator>(
+      std::make_shared<CPUAllocator>(),
+      /*alignment=*/64,
+      /*chunk_size=*/1 << 20);
+}
+
+}  // namespace
+
+TEST(SlabAllocatorBenchmark, MultiThreadSmallAllocations) {
+  int max_threads =
+      std::max(static_cast<int>(std::thread::hardware_concurrency()), 2);
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    double auto_growth = RunBenchmark(MakeAutoGrowthAllocator(), num_threads);
+    double slab = RunBenchmark(
+        std::make_shared<SlabAllocator>(MakeAutoGrowthAllocator()),
+        num_threads);
+    LOG(INFO) << num_threads << " threads, auto_growth: " << auto_growth
+              << " M ops/s, auto_growth_slab: " << slab << " M ops/s";
+    EXPECT_GT(auto_growth, 0.0);
+    EXPECT_GT(slab, 0.0);
+  }
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
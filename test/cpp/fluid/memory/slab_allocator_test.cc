@@ -0,0 +1,130 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/memory/allocation/slab_allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace memory {
+namespace allocation {
+
+class CountingAllocator : public Allocator {
+ public:
+  bool IsAllocThreadSafe() const override { return true; }
+
+  size_t AllocatedSize() const { return allocated_size_; }
+
+  size_t AllocTimes() const { return alloc_times_; }
+
+ protected:
+  phi::Allocation *AllocateImpl(size_t size) override {
+    allocated_size_ += size;
+    ++alloc_times_;
+    return new Allocation(malloc(size), size, phi::CPUPlace());  // NOLINT
+  }
+
+  void FreeImpl(phi::Allocation *allocation) override {
+    allocated_size_ -= allocation->size();
+    free(allocation->ptr());  // NOLINT
+    delete allocation;
+  }
+
+ private:
+  std::atomic<size_t> allocated_size_{0};
+  std::atomic<size_t> alloc_times_{0};
+};
+
+TEST(SlabAllocator, SizeClass) {
+  EXPECT_EQ(SlabAllocator::SizeClassSize(0), 64UL);
+  EXPECT_EQ(
+      SlabAllocator::SizeClassSize(SlabAllocator::kNumSizeClasses - 1),
+      SlabAllocator::kMaxSlabSize);
+  for (size_t size = 1; size <= SlabAllocator::kMaxSlabSize; ++size) {
+    size_t index = SlabAllocator::SizeClassIndex(size);
+    ASSERT_LT(index, SlabAllocator::kNumSizeClasses);
+    ASSERT_GE(SlabAllocator::SizeClassSize(index), size);
+    if (index > 0) {
+      ASSERT_LT(SlabAllocator::SizeClassSize(index - 1), size);
+    }
+  }
+}
+
+TEST(SlabAllocator, ReuseFreedAllocation) {
+  auto underlying = std::make_shared<CountingAllocator>();
+  auto allocator = std::make_shared<SlabAllocator>(underlying);
+
+  auto allocation = allocator->Allocate(1000);
+  EXPECT_GE(allocation->size(), 1000UL);
+  void *ptr = allocation->ptr();
+  allocation.reset();
+  // The freed allocation is cached by the thread and served again.
+  allocation = allocator->Allocate(1000);
+  EXPECT_EQ(allocation->ptr(), ptr);
+  EXPECT_EQ(underlying->AllocTimes(), 1UL);
+
+  // Large requests bypass the cache.
+  auto large_allocation = allocator->Allocate(SlabAllocator::kMaxSlabSize + 1);
+  EXPECT_EQ(underlying->AllocTimes(), 2UL);
+  large_allocation.reset();
+  allocation.reset();
+
+  allocator->Release(phi::CPUPlace());
+  EXPECT_EQ(underlying->AllocatedSize(), 0UL);
+  EXPECT_EQ(allocator->CentralCachedBytes(), 0UL);
+}
+
+TEST(SlabAllocator, CrossThreadFree) {
+  auto underlying = std::make_shared<CountingAllocator>();
+  auto allocator = std::make_shared<SlabAllocator>(underlying);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumAllocations = 2000;
+
+  // Every thread frees the allocations made by its neighbour.
+  std::vector<std::vector<AllocationPtr>> allocations(kNumThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < kNumAllocations; ++i) {
+        size_t size = 1 + (i * 7919 + t) % 4096;
+        allocations[t].emplace_back(allocator->Allocate(size));
+        ASSERT_GE(allocations[t].back()->size(), size);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  for (int t = 0; t < kNumThreads; ++t) {
+    threads.emplace_back(
+        [&, t]() { allocations[(t + 1) % kNumThreads].clear(); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // The exited threads handed their caches back to the central cache.
+  allocator->Release(phi::CPUPlace());
+  EXPECT_EQ(underlying->AllocatedSize(), 0UL);
+}
+
+}  // namespace allocation
+}  // namespace memory
+}  // namespace paddle
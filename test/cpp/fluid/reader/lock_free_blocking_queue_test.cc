@@ -0,0 +1,161 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/lock_free_blocking_queue.h"
+
+#include <algorithm>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using paddle::operators::reader::LockFreeBlockingQueue;
+
+TEST(LockFreeBlockingQueue, CapacityTest) {
+  LockFreeBlockingQueue<int> q(3);
+  EXPECT_EQ(q.Cap(), 3UL);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(q.Send(i));
+  }
+  EXPECT_EQ(q.Size(), 3UL);
+  int elem = 0;
+  EXPECT_TRUE(q.Receive(&elem));
+  EXPECT_EQ(elem, 0);
+  EXPECT_EQ(q.Size(), 2UL);
+}
+
+TEST(LockFreeBlockingQueue, SenderBlockingTest) {
+  const size_t queue_cap = 2;
+  LockFreeBlockingQueue<size_t> q(queue_cap);
+  size_t send_count = 0;
+  std::thread sender([&]() {
+    for (size_t i = 0; i < 5; ++i) {
+      if (!q.Send(i)) {
+        break;
+      }
+      ++send_count;
+    }
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  q.Close();
+  sender.join();
+  EXPECT_EQ(send_count, queue_cap);
+  // The elements sent before Close are still received.
+  std::vector<size_t> res;
+  size_t elem = 0;
+  while (q.Receive(&elem)) {
+    res.push_back(elem);
+  }
+  EXPECT_EQ(res, std::vector<size_t>({0, 1}));
+  EXPECT_FALSE(q.Send(2));
+}
+
+TEST(LockFreeBlockingQueue, ReceiverBlockingTest) {
+  LockFreeBlockingQueue<size_t> q(5);
+  std::vector<size_t> receive_res;
+  std::thread receiver([&]() {
+    size_t elem = 0;
+    while (q.Receive(&elem)) {
+      receive_res.push_back(elem);
+    }
+  });
+  std::vector<size_t> to_send{2, 1, 7};
+  for (auto e : to_send) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_TRUE(q.Send(e));
+  }
+  q.Close();
+  receiver.join();
+  EXPECT_EQ(receive_res, to_send);
+  EXPECT_TRUE(q.IsClosed());
+}
+
+TEST(LockFreeBlockingQueue, KillTest) {
+  LockFreeBlockingQueue<size_t> q(2);
+  EXPECT_TRUE(q.Send(1));
+  std::thread sender([&]() {
+    EXPECT_TRUE(q.Send(2));
+    // Blocks on the full queue until it is killed.
+    EXPECT_FALSE(q.Send(3));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  q.Kill();
+  sender.join();
+  size_t elem = 0;
+  EXPECT_ANY_THROW(q.Receive(&elem));
+  EXPECT_ANY_THROW(q.ReOpen());
+}
+
+TEST(LockFreeBlockingQueue, ReOpenTest) {
+  LockFreeBlockingQueue<size_t> q(4);
+  EXPECT_TRUE(q.Send(1));
+  q.Close();
+  EXPECT_FALSE(q.Send(2));
+  q.ReOpen();
+  EXPECT_FALSE(q.IsClosed());
+  EXPECT_EQ(q.Size(), 0UL);
+  EXPECT_TRUE(q.Send(3));
+  size_t elem = 0;
+  EXPECT_TRUE(q.Receive(&elem));
+  EXPECT_EQ(elem, 3UL);
+}
+
+TEST(LockFreeBlockingQueue, MultiSenderMultiReceiverTest) {
+  const size_t sender_num = 4;
+  const size_t receiver_num = 3;
+  const size_t elem_num = 20000;
+  for (size_t queue_cap : {1, 3, 64}) {
+    LockFreeBlockingQueue<size_t> q(queue_cap);
+    std::vector<std::thread> senders;
+    for (size_t s_idx = 0; s_idx < sender_num; ++s_idx) {
+      senders.emplace_back([&, s_idx] {
+        for (size_t i = 0; i < elem_num; ++i) {
+          EXPECT_TRUE(q.Send(s_idx * elem_num + i));
+        }
+      });
+    }
+    std::mutex mu;
+    std::vector<size_t> res;
+    std::vector<std::thread> receivers;
+    for (size_t r_idx = 0; r_idx < receiver_num; ++r_idx) {
+      receivers.emplace_back([&] {
+        std::vector<size_t> receiver_res;
+        std::vector<size_t> last(sender_num, 0);
+        size_t elem = 0;
+        while (q.Receive(&elem)) {
+          // The elements of a sender arrive in order.
+          size_t sender = elem / elem_num;
+          EXPECT_GE(elem + 1, last[sender]);
+          last[sender] = elem + 1;
+          receiver_res.push_back(elem);
+        }
+        std::lock_guard<std::mutex> lock(mu);
+        res.insert(res.end(), receiver_res.begin(), receiver_res.end());
+      });
+    }
+    for (auto& t : senders) {
+      t.join();
+    }
+    q.Close();
+    for (auto& t : receivers) {
+      t.join();
+    }
+    std::sort(res.begin(), res.end());
+    ASSERT_EQ(res.size(), sender_num * elem_num);
+    for (size_t i = 0; i < res.size(); ++i) {
+      EXPECT_EQ(res[i], i);
+    }
+  }
+}
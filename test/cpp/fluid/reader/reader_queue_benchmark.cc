@@ -0,0 +1,99 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the throughput of BlockingQueue and LockFreeBlockingQueue with
+// small batches, one or several senders and receivers.
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/reader/blocking_queue.h"
+#include "paddle/fluid/operators/reader/lock_free_blocking_queue.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+namespace {
+
+// Like a LoDTensorArray, a batch is a small vector of handles.
+using Batch = std::vector<std::shared_ptr<int>>;
+
+constexpr size_t kBatchNum = 400000;
+
+template <typename Queue>
+double BatchesPerSecond(Queue* q, size_t sender_num, size_t receiver_num) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> senders;
+  for (size_t i = 0; i < sender_num; ++i) {
+    senders.emplace_back([&]() {
+      auto tensor = std::make_shared<int>(0);
+      for (size_t j = 0; j < kBatchNum / sender_num; ++j) {
+        q->Send(Batch(2, tensor));
+      }
+    });
+  }
+  std::atomic<size_t> received{0};
+  std::vector<std::thread> receivers;
+  for (size_t i = 0; i < receiver_num; ++i) {
+    receivers.emplace_back([&]() {
+      Batch batch;
+      while (q->Receive(&batch)) {
+        received.fetch_add(1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& t : senders) {
+    t.join();
+  }
+  q->Close();
+  for (auto& t : receivers) {
+    t.join();
+  }
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  EXPECT_EQ(received.load(), kBatchNum / sender_num * sender_num);
+  return received.load() / seconds;
+}
+
+void Compare(size_t capacity, size_t sender_num, size_t receiver_num) {
+  BlockingQueue<Batch> locked(capacity);
+  LockFreeBlockingQueue<Batch> lock_free(capacity);
+  double locked_rate = BatchesPerSecond(&locked, sender_num, receiver_num);
+  double lock_free_rate =
+      BatchesPerSecond(&lock_free, sender_num, receiver_num);
+  LOG(INFO) << "capacity " << capacity << ", " << sender_num << " senders, "
+            << receiver_num << " receivers: BlockingQueue " << locked_rate
+            << " batches/s, LockFreeBlockingQueue " << lock_free_rate
+            << " batches/s";
+}
+
+}  // namespace
+
+TEST(ReaderQueueBenchmark, Throughput) {
+  Compare(2, 1, 1);
+  Compare(64, 1, 1);
+  Compare(64, 4, 1);
+  Compare(64, 4, 4);
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,201 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>  // NOLINT
+
+#include "test/cpp/inference/api/analyzer_ernie_tester.h"
+
+PD_DEFINE_bool(batching_benchmark,
+               false,
+               "run the batching benchmark, which is skipped by ctest");
+PD_DEFINE_int32(batching_clients, 16, "concurrent clients of the benchmark");
+PD_DEFINE_int32(batching_requests, 200, "requests sent by every client");
+PD_DEFINE_double(batching_qps,
+                 400,
+                 "mean requests per second of all the clients, the requests "
+                 "arrive as a poisson process");
+PD_DEFINE_int32(batching_workers, 2, "predictors that run at the same time");
+PD_DEFINE_int32(batching_max_batch_size, 16, "max batch size");
+PD_DEFINE_int64(batching_timeout_us, 2000, "batch timeout in microseconds");
+
+namespace paddle {
+namespace inference {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::vector<std::string> SequenceInputs() {
+  auto input_name = FLAGS_ernie_large ? "eval_placeholder_" : "placeholder_";
+  std::vector<std::string> names;
+  for (int i = 0; i < 4; ++i) {
+    names.push_back(input_name + std::to_string(i));
+  }
+  return names;
+}
+
+void CopyToInput(const PaddleTensor &tensor, paddle_infer::Tensor *input) {
+  input->Reshape(tensor.shape);
+  if (tensor.dtype == PaddleDType::INT64) {
+    input->CopyFromCpu(static_cast<const int64_t *>(tensor.data.data()));
+  } else {
+    input->CopyFromCpu(static_cast<const float *>(tensor.data.data()));
+  }
+}
+
+struct LoadStats {
+  double seconds;
+  std::vector<double> latency_ms;
+};
+
+// Every client sends its requests at exponentially distributed intervals and
+// waits for each one, `send` runs a request and returns when it is done.
+template <typename SendFn>
+LoadStats GenerateLoad(const std::vector<std::vector<PaddleTensor>> &samples,
+                       SendFn &&send) {
+  const double client_qps = FLAGS_batching_qps / FLAGS_batching_clients;
+  std::vector<std::vector<double>> latency(FLAGS_batching_clients);
+  std::vector<std::thread> clients;
+  auto start = Clock::now();
+  for (int c = 0; c < FLAGS_batching_clients; ++c) {
+    clients.emplace_back([&, c]() {
+      std::mt19937 rng(c);
+      std::exponential_distribution<double> interval(client_qps);
+      auto next = Clock::now();
+      for (int i = 0; i < FLAGS_batching_requests; ++i) {
+        next += std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(interval(rng)));
+        std::this_thread::sleep_until(next);
+        auto sent = Clock::now();
+        send(samples[(c + i) % samples.size()]);
+        latency[c].push_back(
+            std::chrono::duration<double, std::milli>(Clock::now() - sent)
+                .count());
+      }
+    });
+  }
+  for (auto &client : clients) {
+    client.join();
+  }
+  LoadStats stats;
+  stats.seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  for (auto &client_latency : latency) {
+    stats.latency_ms.insert(stats.latency_ms.end(),
+                            client_latency.begin(),
+                            client_latency.end());
+  }
+  std::sort(stats.latency_ms.begin(), stats.latency_ms.end());
+  return stats;
+}
+
+void ReportStats(const std::string &name, const LoadStats &stats) {
+  auto percentile = [&stats](double p) {
+    return stats.latency_ms[static_cast<size_t>(
+        p * (stats.latency_ms.size() - 1))];
+  };
+  LOG(INFO) << name << ": " << stats.latency_ms.size() / stats.seconds
+            << " requests/s, latency p50 " << percentile(0.5) << " ms, p99 "
+            << percentile(0.99) << " ms, max " << stats.latency_ms.back()
+            << " ms";
+}
+
+}  // namespace
+
+// The outputs of the merged requests are the same as those of the requests
+// run one by one.
+TEST(Analyzer_ernie, batching_compare) {
+  std::vector<std::vector<PaddleTensor>> inputs;
+  LoadInputData(&inputs);
+
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+  auto predictor = CreatePaddlePredictor<AnalysisConfig>(cfg);
+  std::vector<std::vector<PaddleTensor>> ref_outputs(inputs.size());
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    ASSERT_TRUE(predictor->Run(inputs[i], &ref_outputs[i]));
+  }
+
+  paddle_infer::services::BatchingOptions options;
+  options.max_batch_size = 4;
+  options.batch_timeout_us = 5000;
+  options.sequence_inputs = SequenceInputs();
+  paddle_infer::services::BatchingPredictor batching(cfg, options);
+  std::vector<std::vector<PaddleTensor>> outputs(inputs.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    threads.emplace_back([&, i]() {
+      ASSERT_TRUE(batching.Run(inputs[i], &outputs[i]));
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    CompareResult(outputs[i], ref_outputs[i]);
+  }
+}
+
+// Compares serving the synthetic load by the predictors of a pool, one
+// request at a time, with merging the requests. Only run with
+// --batching_benchmark, add larger --batching_qps and --batching_clients to
+// see the saturation throughput.
+TEST(Analyzer_ernie, batching_benchmark) {
+  if (!FLAGS_batching_benchmark) {
+    GTEST_SKIP() << "Run with --batching_benchmark to run the benchmark.";
+  }
+  std::vector<std::vector<PaddleTensor>> samples;
+  LoadInputData(&samples);
+
+  AnalysisConfig cfg;
+  SetConfig(&cfg);
+  {
+    paddle_infer::services::PredictorPool pool(cfg, FLAGS_batching_workers);
+    auto stats = GenerateLoad(samples, [&pool](const auto &sample) {
+      auto *predictor = pool.Acquire();
+      for (auto &tensor : sample) {
+        CopyToInput(tensor, predictor->GetInputHandle(tensor.name).get());
+      }
+      predictor->Run();
+      auto output = predictor->GetOutputHandle(predictor->GetOutputNames()[0]);
+      std::vector<float> result(VecReduceToInt(output->shape()));
+      output->CopyToCpu(result.data());
+      pool.Release(predictor);
+    });
+    ReportStats("PredictorPool", stats);
+  }
+  {
+    paddle_infer::services::BatchingOptions options;
+    options.max_batch_size = FLAGS_batching_max_batch_size;
+    options.batch_timeout_us = FLAGS_batching_timeout_us;
+    options.num_workers = FLAGS_batching_workers;
+    options.sequence_inputs = SequenceInputs();
+    options.sequence_buckets = {16, 32, 64, 128};
+    paddle_infer::services::BatchingPredictor batching(cfg, options);
+    auto stats = GenerateLoad(samples, [&batching](const auto &sample) {
+      std::vector<PaddleTensor> outputs;
+      batching.Run(sample, &outputs);
+    });
+    ReportStats("BatchingPredictor", stats);
+    EXPECT_EQ(stats.latency_ms.size(),
+              static_cast<size_t>(FLAGS_batching_clients) *
+                  FLAGS_batching_requests);
+  }
+}
+
+}  // namespace inference
+}  // namespace paddle
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <cmath>
+#include <cstdio>
 #include <functional>
 
 #include "paddle/phi/kernels/autotune/cache.h"
@@ -66,3 +67,46 @@ TEST(AlgosCache, AlgosCache) {
   EXPECT_EQ(autotune_cache.CacheMisses(), 2);
   EXPECT_LT(std::abs(cache_hit_rate - autotune_cache.CacheHitRate()), 1e-5);
 }
+
+TEST(AlgosCache, SaveAndLoad) {
+  auto& autotune_cache = phi::autotune::AutoTuneCache::Instance();
+  auto& transpose_cache =
+      autotune_cache.Get(phi::autotune::AlgorithmType::kTranspose);
+  auto& conv_cache =
+      autotune_cache.GetConv(phi::autotune::AlgorithmType::kConvForward);
+  const std::string path = "autotune_cache_test";
+  std::remove(path.c_str());
+  autotune_cache.Clean();
+
+  phi::autotune::ConvCacheKey key({4, 224, 224, 3},
+                                  {32, 3, 3, 3},
+                                  {2, 2},
+                                  {0, 0},
+                                  {1, 1},
+                                  phi::DataType::FLOAT16,
+                                  1,
+                                  0);
+  conv_cache.Set(key, phi::autotune::ConvAutoTuneResult(2, 4096, true));
+  transpose_cache.Set(1001, 3);
+  EXPECT_TRUE(autotune_cache.Save(path));
+
+  // Another process adds its configs to the same file.
+  autotune_cache.Clean();
+  transpose_cache.Set(1002, 1);
+  EXPECT_TRUE(autotune_cache.Save(path));
+
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load(path), 3);
+  EXPECT_EQ(transpose_cache.Get(1001), 3);
+  EXPECT_EQ(transpose_cache.Get(1002), 1);
+  ASSERT_TRUE(conv_cache.Find(key));
+  auto result = conv_cache.Get(key);
+  EXPECT_EQ(result.algo, 2);
+  EXPECT_EQ(result.workspace_size, 4096UL);
+  EXPECT_TRUE(result.exhaustive_search);
+
+  autotune_cache.Clean();
+  EXPECT_EQ(autotune_cache.Load("autotune_cache_not_exist"), 0);
+  std::remove(path.c_str());
+  std::remove((path + ".lock").c_str());
+}
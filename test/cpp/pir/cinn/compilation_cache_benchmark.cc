@@ -0,0 +1,132 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compiles the fusion groups of a program for x86 with an empty on-disk
+// compile cache (cold startup), then again after dropping everything the
+// process holds in memory, as a new process would (warm startup), and
+// reports both times. Set --compile_cache_benchmark_groups for more groups.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/hlir/framework/pir_compiler.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_string(cinn_compile_cache_dir);
+PD_DEFINE_int32(compile_cache_benchmark_groups,
+                16,
+                "fusion groups of the compiled program");
+
+using cinn::hlir::framework::CompilationCache;
+using cinn::hlir::framework::DiskCompilationCache;
+using cinn::hlir::framework::PirCompiler;
+using cinn::hlir::framework::pir::CINNKernelInfo;
+using cinn::hlir::framework::pir::CompatibleInfo;
+using cinn::hlir::framework::pir::OpLoweringGroup;
+using cinn::hlir::framework::pir::OpLoweringGroupPtr;
+
+namespace {
+
+using ProgramInfo = std::tuple<std::shared_ptr<::pir::Program>,
+                               std::vector<OpLoweringGroupPtr>>;
+
+// Every group is full -> tan -> relu -> exp with its own shape, so no two
+// groups share a kernel.
+ProgramInfo BuildProgram(int num_groups) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  std::vector<OpLoweringGroupPtr> groups;
+  for (int i = 0; i < num_groups; ++i) {
+    auto full = builder.Build<paddle::dialect::FullOp>(
+        std::vector<int64_t>{64, 128 + i},
+        1.0,
+        phi::DataType::FLOAT32,
+        phi::CPUPlace());
+    auto tan = builder.Build<paddle::dialect::TanOp>(full->result(0));
+    auto relu = builder.Build<paddle::dialect::ReluOp>(tan->result(0));
+    auto exp = builder.Build<paddle::dialect::ExpOp>(relu->result(0));
+    const auto ops = std::vector<::pir::Operation*>({full.operation(),
+                                                     tan.operation(),
+                                                     relu.operation(),
+                                                     exp.operation()});
+    groups.emplace_back(std::make_shared<OpLoweringGroup>(
+        ops, CompatibleInfo::GroupOpsName(ops)));
+    groups.back()->mut_output_values().push_back(exp->result(0));
+  }
+  return {program, groups};
+}
+
+double BuildSeconds(const std::vector<OpLoweringGroupPtr>& groups,
+                    std::vector<CINNKernelInfo>* kernel_infos) {
+  const auto start = std::chrono::steady_clock::now();
+  PirCompiler pir_compiler(cinn::common::DefaultHostTarget());
+  *kernel_infos = pir_compiler.Build(groups);
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+      .count();
+}
+
+}  // namespace
+
+TEST(CompilationCacheBenchmark, ColdAndWarmStartup) {
+  char cache_dir[] = "/tmp/cinn_compile_cache_benchmark_XXXXXX";
+  ASSERT_NE(mkdtemp(cache_dir), nullptr);
+  FLAGS_cinn_compile_cache_dir = cache_dir;
+  auto& disk_cache = DiskCompilationCache::Instance();
+  ASSERT_TRUE(disk_cache.IsEnabled(cinn::common::DefaultHostTarget()));
+
+  auto [program, groups] = BuildProgram(FLAGS_compile_cache_benchmark_groups);
+
+  std::vector<CINNKernelInfo> cold_infos;
+  const double cold_seconds = BuildSeconds(groups, &cold_infos);
+  const int64_t cached_bytes = disk_cache.cached_bytes();
+  EXPECT_GT(cached_bytes, 0);
+
+  CompilationCache::Instance().Clear();
+  disk_cache.ClearLoaded();
+  std::vector<CINNKernelInfo> warm_infos;
+  const double warm_seconds = BuildSeconds(groups, &warm_infos);
+  // Nothing is compiled on a warm startup.
+  EXPECT_EQ(disk_cache.cached_bytes(), cached_bytes);
+
+  ASSERT_EQ(cold_infos.size(), warm_infos.size());
+  for (size_t i = 0; i < warm_infos.size(); ++i) {
+    EXPECT_EQ(cold_infos[i].fn_name, warm_infos[i].fn_name);
+    EXPECT_NE(warm_infos[i].fn_ptr, nullptr);
+    EXPECT_NE(warm_infos[i].infer_shape_fn_ptr, nullptr);
+  }
+
+  LOG(INFO) << groups.size() << " groups, " << cached_bytes
+            << " bytes of object code cached";
+  LOG(INFO) << "cold startup: " << cold_seconds << "s";
+  LOG(INFO) << "warm startup: " << warm_seconds << "s ("
+            << cold_seconds / warm_seconds << "x)";
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compiles the groups of a program for x86 into the on-disk compile cache,
+// drops the results of the process and compiles the program again, so that
+// the kernels are linked from the cached object code and run.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(cinn_compile_cache_dir);
+
+namespace {
+
+using cinn::hlir::framework::CompilationCache;
+using cinn::hlir::framework::DiskCompilationCache;
+
+const std::vector<int64_t> kXShape = {37, 131};
+const std::vector<int64_t> kYShape = {64, 256};
+
+// A reduce of x and an elementwise op of y, which are separate groups.
+std::shared_ptr<::pir::Program> BuildProgram() {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", kXShape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto y = builder
+               .Build<paddle::dialect::DataOp>(
+                   "y", kYShape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto sum = builder
+                 .Build<paddle::dialect::SumOp>(x,
+                                                std::vector<int64_t>{-1},
+                                                phi::DataType::FLOAT32,
+                                                true)
+                 .result(0);
+  auto relu = builder
+                  .Build<paddle::dialect::ReluOp>(
+                      builder.Build<paddle::dialect::ExpOp>(y).result(0))
+                  .result(0);
+  builder.Build<paddle::dialect::FetchOp>(sum, "sum", 0);
+  builder.Build<paddle::dialect::FetchOp>(relu, "relu", 1);
+  return program;
+}
+
+std::vector<float> Output(const cinn::ir::search::Measurer& measurer,
+                          const std::string& name) {
+  const phi::DenseTensor& out = measurer.HostOutput(name);
+  const float* data = out.data<float>();
+  return std::vector<float>(data, data + out.numel());
+}
+
+}  // namespace
+
+TEST(DiskCompilationCache, ReloadCompiledGroups) {
+  if (!(cinn::common::DefaultDeviceTarget() ==
+        cinn::common::DefaultHostTarget())) {
+    GTEST_SKIP() << "The cache only holds x86 kernels.";
+  }
+  char dir[] = "/tmp/cinn_compile_cache_reload_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  // Read once by the first DiskCompilationCache::Instance.
+  FLAGS_cinn_compile_cache_dir = dir;
+  FLAGS_enable_cinn_compile_cache = true;
+  auto& disk_cache = DiskCompilationCache::Instance();
+  ASSERT_EQ(disk_cache.cache_dir(), std::string(dir));
+  ASSERT_TRUE(disk_cache.IsEnabled(cinn::common::DefaultHostTarget()));
+
+  auto program = BuildProgram();
+  const std::unordered_map<std::string, std::vector<int64_t>> shapes = {
+      {"x", kXShape}, {"y", kYShape}};
+
+  cinn::ir::search::Measurer compiled(program.get(),
+                                      cinn::common::DefaultHostTarget());
+  compiled.Compile();
+  compiled.Run(shapes, /* repeat = */ 1);
+  EXPECT_EQ(disk_cache.disk_hits(), 0);
+  EXPECT_GT(disk_cache.cached_bytes(), 0);
+
+  // As in a new process, only the disk holds the kernels.
+  CompilationCache::Instance().Clear();
+  disk_cache.ClearLoaded();
+  cinn::ir::search::Measurer reloaded(program.get(),
+                                      cinn::common::DefaultHostTarget());
+  reloaded.Compile();
+  EXPECT_GE(disk_cache.disk_hits(), 2);
+  reloaded.Run(shapes, /* repeat = */ 1);
+
+  // The inputs of both runs are the same.
+  for (const std::string name : {"sum", "relu"}) {
+    const std::vector<float> expected = Output(compiled, name);
+    const std::vector<float> actual = Output(reloaded, name);
+    ASSERT_EQ(actual.size(), expected.size()) << name;
+    for (size_t i = 0; i < expected.size(); ++i) {
+      ASSERT_EQ(actual[i], expected[i]) << name << " at " << i;
+    }
+  }
+}
@@ -0,0 +1,158 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the x86 kernels of a reduce and an elementwise program with the
+// default tile config, searches the vectorize width, parallel grain and
+// reduce unroll factor on the host, reports the speedup and writes the best
+// config of every bucket to the file database.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+#include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
+#include "paddle/cinn/ir/group_schedule/search/config_searcher.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/cinn/utils/string.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_bool(cinn_measure_kernel_time);
+PD_DECLARE_bool(cinn_cpu_tile_tactic);
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(tile_config_policy);
+
+namespace {
+
+constexpr int kRepeats = 20;
+
+std::shared_ptr<::pir::Program> BuildProgram(int spatial_size,
+                                             int reduce_size,
+                                             bool is_reduce) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  const std::vector<int64_t> shape = {spatial_size, reduce_size};
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", shape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto out =
+      is_reduce
+          ? builder
+                .Build<paddle::dialect::SumOp>(
+                    x, std::vector<int64_t>{-1}, phi::DataType::FLOAT32, true)
+                .result(0)
+          : builder
+                .Build<paddle::dialect::ReluOp>(
+                    builder.Build<paddle::dialect::ExpOp>(x).result(0))
+                .result(0);
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+  return program;
+}
+
+double DefaultConfigScore(::pir::Program* program,
+                          const std::vector<int64_t>& shape) {
+  FLAGS_tile_config_policy = "default";
+  cinn::ir::ScheduleConfigManager::Instance().SetPolicy("default");
+  cinn::ir::search::Measurer measurer(program,
+                                      cinn::common::DefaultHostTarget());
+  measurer.Compile();
+  measurer.Run({{"x", shape}}, kRepeats);
+  return measurer.Result().avg_kernel_execute_time.count();
+}
+
+bool IsPowerOfTwo(int64_t x) { return x > 0 && (x & (x - 1)) == 0; }
+
+}  // namespace
+
+TEST(CpuTileConfigBenchmark, DefaultAndSearchedConfig) {
+  FLAGS_cinn_measure_kernel_time = true;
+  FLAGS_enable_cinn_compile_cache = false;
+  FLAGS_cinn_cpu_tile_tactic = true;
+  const auto target = cinn::common::DefaultHostTarget();
+
+  // {spatial, reduce, is_reduce}
+  const std::vector<std::tuple<int, int, bool>> cases = {
+      {1024, 1024, true}, {64, 16384, true}, {4096, 256, false}};
+  for (const auto& [spatial_size, reduce_size, is_reduce] : cases) {
+    auto program = BuildProgram(spatial_size, reduce_size, is_reduce);
+    const std::vector<int64_t> shape = {spatial_size, reduce_size};
+    const double default_score = DefaultConfigScore(program.get(), shape);
+
+    FLAGS_tile_config_policy = "search";
+    cinn::ir::ScheduleConfigManager::Instance().SetPolicy("search");
+    // Elementwise groups only have a spatial dimension.
+    cinn::ir::BucketInfo bucket_info =
+        is_reduce ? cinn::ir::BucketInfo(spatial_size,
+                                         spatial_size,
+                                         reduce_size,
+                                         reduce_size,
+                                         false,
+                                         false)
+                  : cinn::ir::BucketInfo(spatial_size * reduce_size,
+                                         spatial_size * reduce_size,
+                                         1,
+                                         1,
+                                         false,
+                                         false);
+    std::unique_ptr<cinn::ir::search::BaseObjectiveFunc> obj_func =
+        std::make_unique<cinn::ir::search::WeightedSamplingTrailObjectiveFunc>(
+            program.get(),
+            bucket_info,
+            /* sampling_prob = */ 1.0,
+            /* max_sampling_times = */ 1,
+            kRepeats,
+            std::vector<std::vector<double>>{},
+            target);
+
+    // {vectorize_width, parallel_grain, tree_reduce_num}
+    std::vector<std::pair<int, int>> candidate_range{
+        {1, 16}, {0, 1024}, {1, is_reduce ? 8 : 1}};
+    std::vector<cinn::ir::search::ConstraintFunc> constraints;
+    constraints.emplace_back(
+        [](const cinn::ir::search::CandidateType& candidate) -> bool {
+          return IsPowerOfTwo(candidate[0]) && IsPowerOfTwo(candidate[2]);
+        });
+    constraints.emplace_back(
+        [](const cinn::ir::search::CandidateType& candidate) -> bool {
+          return candidate[1] == 0 ||
+                 candidate[1] >= 64 && IsPowerOfTwo(candidate[1]);
+        });
+    cinn::ir::search::ScheduleConfigSearcher searcher(
+        std::move(obj_func), candidate_range, constraints);
+    auto search_res = searcher.Search();
+
+    LOG(INFO) << (is_reduce ? "reduce_sum " : "exp_relu ") << spatial_size
+              << "x" << reduce_size << ": default " << default_score
+              << ", searched " << search_res.first << " ("
+              << default_score / search_res.first << "x), best candidate: "
+              << cinn::utils::Join<int64_t>(search_res.second, ", ");
+    cinn::ir::search::SaveBestCandidate(
+        target, bucket_info, search_res.second);
+  }
+}
@@ -0,0 +1,222 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compiles reduce, softmax, layer norm and elementwise programs for x86 with
+// and without the CpuTileTactic and compares the outputs of the kernels on
+// the same random inputs.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/database.h"
+#include "paddle/cinn/ir/group_schedule/config/group_tile_config.h"
+#include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_bool(cinn_cpu_tile_tactic);
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(tile_config_policy);
+
+namespace {
+
+enum class Pattern { kReduceSum, kSoftmax, kLayerNorm, kElementwise };
+
+std::string PatternName(Pattern pattern) {
+  switch (pattern) {
+    case Pattern::kReduceSum:
+      return "reduce_sum";
+    case Pattern::kSoftmax:
+      return "softmax";
+    case Pattern::kLayerNorm:
+      return "layer_norm";
+    case Pattern::kElementwise:
+      return "exp_relu";
+  }
+  return "";
+}
+
+// Softmax and layer norm are built from the primitive ops they are
+// decomposed into before CINN, all of them over the last axis of x.
+std::shared_ptr<::pir::Program> BuildProgram(
+    Pattern pattern, const std::vector<int64_t>& shape) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  const std::vector<int64_t> axes = {-1};
+  const float inv_size = 1.0f / static_cast<float>(shape.back());
+  const auto Sum = [&](::pir::Value x) {
+    return builder
+        .Build<paddle::dialect::SumOp>(x, axes, phi::DataType::FLOAT32, true)
+        .result(0);
+  };
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", shape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  ::pir::Value out;
+  switch (pattern) {
+    case Pattern::kReduceSum: {
+      out = Sum(x);
+      break;
+    }
+    case Pattern::kSoftmax: {
+      auto max = builder.Build<paddle::dialect::MaxOp>(x, axes, true).result(0);
+      auto sub = builder.Build<paddle::dialect::SubtractOp>(x, max).result(0);
+      auto exp = builder.Build<paddle::dialect::ExpOp>(sub).result(0);
+      out = builder.Build<paddle::dialect::DivideOp>(exp, Sum(exp)).result(0);
+      break;
+    }
+    case Pattern::kLayerNorm: {
+      auto mean =
+          builder.Build<paddle::dialect::ScaleOp>(Sum(x), inv_size, 0.0f)
+              .result(0);
+      auto diff = builder.Build<paddle::dialect::SubtractOp>(x, mean).result(0);
+      auto square =
+          builder.Build<paddle::dialect::MultiplyOp>(diff, diff).result(0);
+      auto var =
+          builder.Build<paddle::dialect::ScaleOp>(Sum(square), inv_size, 1e-5f)
+              .result(0);
+      auto stddev = builder.Build<paddle::dialect::SqrtOp>(var).result(0);
+      out = builder.Build<paddle::dialect::DivideOp>(diff, stddev).result(0);
+      break;
+    }
+    case Pattern::kElementwise: {
+      out = builder
+                .Build<paddle::dialect::ReluOp>(
+                    builder.Build<paddle::dialect::ExpOp>(x).result(0))
+                .result(0);
+      break;
+    }
+  }
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+  return program;
+}
+
+std::vector<float> CompileAndRun(::pir::Program* program,
+                                 const std::vector<int64_t>& shape) {
+  cinn::ir::search::Measurer measurer(program,
+                                      cinn::common::DefaultHostTarget());
+  measurer.Compile();
+  measurer.Run({{"x", shape}}, /* repeat = */ 1);
+  const phi::DenseTensor& out = measurer.HostOutput("out");
+  const float* data = out.data<float>();
+  return std::vector<float>(data, data + out.numel());
+}
+
+std::vector<float> RunWithoutTactic(::pir::Program* program,
+                                    const std::vector<int64_t>& shape) {
+  FLAGS_cinn_cpu_tile_tactic = false;
+  FLAGS_tile_config_policy = "default";
+  cinn::ir::ScheduleConfigManager::Instance().SetPolicy("default");
+  return CompileAndRun(program, shape);
+}
+
+// {vectorize_width, parallel_grain, tree_reduce_num} is stored for every
+// reduce and elementwise group.
+std::vector<float> RunWithTactic(
+    ::pir::Program* program,
+    const std::vector<int64_t>& shape,
+    const cinn::ir::ScheduleConfig::TileConfig& tile_config) {
+  const auto target = cinn::common::DefaultHostTarget();
+  auto database = std::make_shared<cinn::ir::NaiveTileConfigDatabase>();
+  database->AddConfig(
+      target,
+      cinn::ir::BucketInfo(1, INT_MAX, 1, INT_MAX, false, false),
+      tile_config);
+  database->AddConfig(
+      target,
+      cinn::ir::BucketInfo(std::vector<cinn::ir::BucketInfo::Dimension>{
+          cinn::ir::BucketInfo::Dimension(1, INT_MAX, "S", false)}),
+      tile_config);
+  cinn::ir::ScheduleConfigManager::Instance().AddConfigDatabase("search",
+                                                                database);
+  FLAGS_cinn_cpu_tile_tactic = true;
+  FLAGS_tile_config_policy = "search";
+  cinn::ir::ScheduleConfigManager::Instance().SetPolicy("search");
+  return CompileAndRun(program, shape);
+}
+
+cinn::ir::ScheduleConfig::TileConfig MakeTileConfig(int64_t vectorize_width,
+                                                    int64_t parallel_grain,
+                                                    int64_t tree_reduce_num) {
+  cinn::ir::ScheduleConfig::TileConfig config;
+  config.vectorize_width = vectorize_width;
+  config.parallel_grain = parallel_grain;
+  config.tree_reduce_num = tree_reduce_num;
+  return config;
+}
+
+}  // namespace
+
+TEST(CpuTileTactic, MatchesKernelsWithoutTactic) {
+  if (!(cinn::common::DefaultDeviceTarget() ==
+        cinn::common::DefaultHostTarget())) {
+    GTEST_SKIP() << "The kernels are run on the host.";
+  }
+  FLAGS_enable_cinn_compile_cache = false;
+
+  // 37x131 is a multiple of none of the factors, 128x1000 of most of them
+  // and 3x5 is smaller than all of them.
+  const std::vector<std::vector<int64_t>> shapes = {
+      {37, 131}, {128, 1000}, {3, 5}};
+  const std::vector<cinn::ir::ScheduleConfig::TileConfig> configs = {
+      // Only fuses the loops.
+      MakeTileConfig(1, 0, 1),
+      // A task per spatial iteration.
+      MakeTileConfig(8, 1, 4),
+      // A grain and an unroll factor that divide none of the extents.
+      MakeTileConfig(4, 3, 3),
+      MakeTileConfig(16, 64, 8),
+      // A grain larger than every extent, not parallelized.
+      MakeTileConfig(8, 1 << 20, 2)};
+  for (Pattern pattern : {Pattern::kReduceSum,
+                          Pattern::kSoftmax,
+                          Pattern::kLayerNorm,
+                          Pattern::kElementwise}) {
+    for (const auto& shape : shapes) {
+      auto program = BuildProgram(pattern, shape);
+      const std::vector<float> expected =
+          RunWithoutTactic(program.get(), shape);
+      for (const auto& config : configs) {
+        const std::vector<float> actual =
+            RunWithTactic(program.get(), shape, config);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+          // The reductions may sum in another order.
+          ASSERT_NEAR(actual[i],
+                      expected[i],
+                      1e-4 * std::max(1.0f, std::abs(expected[i])))
+              << PatternName(pattern) << " " << shape[0] << "x" << shape[1]
+              << " with {" << config.vectorize_width << ", "
+              << config.parallel_grain << ", " << config.tree_reduce_num
+              << "} at " << i;
+        }
+      }
+    }
+  }
+}
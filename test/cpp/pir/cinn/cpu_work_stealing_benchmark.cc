@@ -0,0 +1,120 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compiles a reduction for x86 and measures its kernel on the work-stealing
+// pool, split into one task per thread or into chunks, and on the OpenMP
+// backend. The load is skewed: the rows are not a multiple of the threads
+// and a busy thread takes one of the cores, so the threads of a static split
+// finish at different times.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <memory>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/ir/group_schedule/config/schedule_config_manager.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/cinn/runtime/cpu/thread_backend.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PD_DECLARE_bool(cinn_measure_kernel_time);
+PD_DECLARE_bool(cinn_cpu_tile_tactic);
+PD_DECLARE_bool(cinn_cpu_work_stealing);
+PD_DECLARE_int32(cinn_cpu_tasks_per_thread);
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(tile_config_policy);
+
+namespace {
+
+constexpr int kRepeats = 20;
+
+std::shared_ptr<::pir::Program> BuildProgram(
+    const std::vector<int64_t>& shape) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::DataOp>(
+                   "x", shape, phi::DataType::FLOAT32, phi::CPUPlace())
+               .result(0);
+  auto out = builder
+                 .Build<paddle::dialect::SumOp>(x,
+                                                std::vector<int64_t>{-1},
+                                                phi::DataType::FLOAT32,
+                                                true)
+                 .result(0);
+  builder.Build<paddle::dialect::FetchOp>(out, "out", 0);
+  return program;
+}
+
+// The parallel loops of the kernel call the runtime, so the backend is
+// switched between the runs without compiling again.
+double KernelUs(cinn::ir::search::Measurer* measurer,
+                const std::vector<int64_t>& shape) {
+  measurer->Run({{"x", shape}}, kRepeats);
+  return measurer->Result().avg_kernel_execute_time.count();
+}
+
+}  // namespace
+
+TEST(CpuWorkStealingBenchmark, SkewedReduction) {
+  FLAGS_cinn_measure_kernel_time = true;
+  FLAGS_enable_cinn_compile_cache = false;
+  FLAGS_cinn_cpu_tile_tactic = true;
+  FLAGS_tile_config_policy = "default";
+  cinn::ir::ScheduleConfigManager::Instance().SetPolicy("default");
+
+  const int threads = max_concurrency();
+  const std::vector<int64_t> shape = {threads * 16 + 7, 16384};
+  auto program = BuildProgram(shape);
+  cinn::ir::search::Measurer measurer(program.get(),
+                                      cinn::common::DefaultHostTarget());
+  measurer.Compile();
+
+  std::atomic<bool> stop{false};
+  std::thread busy([&stop] {
+    while (!stop.load(std::memory_order_relaxed)) {
+    }
+  });
+
+  const int tasks_per_thread = FLAGS_cinn_cpu_tasks_per_thread;
+  FLAGS_cinn_cpu_tasks_per_thread = 1;
+  const double static_us = KernelUs(&measurer, shape);
+  FLAGS_cinn_cpu_tasks_per_thread = tasks_per_thread;
+  const double chunked_us = KernelUs(&measurer, shape);
+  FLAGS_cinn_cpu_work_stealing = false;
+  const double openmp_us = KernelUs(&measurer, shape);
+  FLAGS_cinn_cpu_work_stealing = true;
+
+  stop.store(true);
+  busy.join();
+
+  LOG(INFO) << threads << " threads, reduce_sum " << shape[0] << "x"
+            << shape[1] << " with a busy thread";
+  LOG(INFO) << "one task per thread: " << static_us << "us";
+  LOG(INFO) << tasks_per_thread << " tasks per thread: " << chunked_us
+            << "us (" << static_us / chunked_us << "x)";
+  LOG(INFO) << "without work stealing: " << openmp_us << "us ("
+            << openmp_us / chunked_us << "x)";
+}
@@ -0,0 +1,162 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <dirent.h>
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+
+using cinn::hlir::framework::DiskCompilationCache;
+
+namespace {
+
+std::string MakeTempDir() {
+  char path[] = "/tmp/cinn_compile_cache_XXXXXX";
+  CHECK(mkdtemp(path) != nullptr);
+  return path;
+}
+
+DiskCompilationCache::Entry MakeEntry(const std::string& fn_name,
+                                      size_t object_size) {
+  DiskCompilationCache::Entry entry;
+  entry.host_fn_name = fn_name;
+  entry.infer_fn_name = fn_name + "_infer_shape";
+  entry.int_args_map[2] = {0, 1};
+  entry.int_args_map[3] = {1, 0};
+  entry.object_code = std::string(object_size, 'o');
+  return entry;
+}
+
+int CountEntries(const std::string& dir) {
+  int count = 0;
+  DIR* root = opendir(dir.c_str());
+  while (struct dirent* sub = readdir(root)) {
+    const std::string sub_name = sub->d_name;
+    if (sub_name.size() != 2) continue;
+    DIR* sub_dir = opendir((dir + "/" + sub_name).c_str());
+    while (struct dirent* file = readdir(sub_dir)) {
+      if (std::string(file->d_name).find(".cinnobj") != std::string::npos) {
+        ++count;
+      }
+    }
+    closedir(sub_dir);
+  }
+  closedir(root);
+  return count;
+}
+
+}  // namespace
+
+TEST(DiskCompilationCache, WriteAndRead) {
+  const std::string dir = MakeTempDir();
+  DiskCompilationCache writer(dir, 1 << 20);
+  ASSERT_TRUE(writer.WriteEntry("key_0", MakeEntry("fn_0", 100)));
+
+  // Another instance stands for another process sharing the directory.
+  DiskCompilationCache reader(dir, 1 << 20);
+  EXPECT_GT(reader.cached_bytes(), 100);
+  DiskCompilationCache::Entry entry;
+  ASSERT_TRUE(reader.ReadEntry("key_0", &entry));
+  EXPECT_EQ(entry.host_fn_name, "fn_0");
+  EXPECT_EQ(entry.infer_fn_name, "fn_0_infer_shape");
+  ASSERT_EQ(entry.int_args_map.size(), 2UL);
+  EXPECT_EQ(entry.int_args_map.at(2).arg_idx, 0);
+  EXPECT_EQ(entry.int_args_map.at(2).dim_idx, 1);
+  EXPECT_EQ(entry.int_args_map.at(3).arg_idx, 1);
+  EXPECT_EQ(entry.int_args_map.at(3).dim_idx, 0);
+  EXPECT_EQ(entry.object_code, std::string(100, 'o'));
+
+  EXPECT_FALSE(reader.ReadEntry("key_1", &entry));
+}
+
+TEST(DiskCompilationCache, IgnoreCorruptedEntry) {
+  const std::string dir = MakeTempDir();
+  DiskCompilationCache cache(dir, 1 << 20);
+  ASSERT_TRUE(cache.WriteEntry("key_0", MakeEntry("fn_0", 100)));
+
+  // Truncate the only entry.
+  DIR* root = opendir(dir.c_str());
+  std::string path;
+  while (struct dirent* sub = readdir(root)) {
+    const std::string sub_name = sub->d_name;
+    if (sub_name.size() != 2) continue;
+    DIR* sub_dir = opendir((dir + "/" + sub_name).c_str());
+    while (struct dirent* file = readdir(sub_dir)) {
+      const std::string name = file->d_name;
+      if (name.find(".cinnobj") != std::string::npos) {
+        path = dir + "/" + sub_name + "/" + name;
+      }
+    }
+    closedir(sub_dir);
+  }
+  closedir(root);
+  ASSERT_FALSE(path.empty());
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << "CINNOBJ2";
+
+  DiskCompilationCache::Entry entry;
+  EXPECT_FALSE(cache.ReadEntry("key_0", &entry));
+}
+
+TEST(DiskCompilationCache, ConcurrentWriters) {
+  const std::string dir = MakeTempDir();
+  DiskCompilationCache cache(dir, 1 << 30);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&cache, t] {
+      for (int i = 0; i < 32; ++i) {
+        // Half of the keys are written by every thread.
+        const int k = i % 2 == 0 ? i : 1000 + i * 8 + t;
+        cache.WriteEntry("key_" + std::to_string(k),
+                         MakeEntry("fn_" + std::to_string(k), 64));
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  for (int i = 0; i < 32; i += 2) {
+    DiskCompilationCache::Entry entry;
+    ASSERT_TRUE(cache.ReadEntry("key_" + std::to_string(i), &entry));
+    EXPECT_EQ(entry.host_fn_name, "fn_" + std::to_string(i));
+  }
+  EXPECT_EQ(CountEntries(dir), 16 + 16 * 8);
+}
+
+TEST(DiskCompilationCache, EvictLeastRecentlyUsed) {
+  const std::string dir = MakeTempDir();
+  // An entry takes about 1100 bytes, ten of them fit in the cache.
+  DiskCompilationCache cache(dir, 10 * 1200);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(cache.WriteEntry("key_" + std::to_string(i),
+                                 MakeEntry("fn_" + std::to_string(i), 1000)));
+  }
+  // Reading an entry makes it the most recently used one. Sleep so that the
+  // modification times differ.
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  DiskCompilationCache::Entry entry;
+  ASSERT_TRUE(cache.ReadEntry("key_0", &entry));
+
+  ASSERT_TRUE(cache.WriteEntry("key_10", MakeEntry("fn_10", 1000)));
+  EXPECT_LE(cache.cached_bytes(), 10 * 1200);
+  EXPECT_LT(CountEntries(dir), 11);
+  EXPECT_TRUE(cache.ReadEntry("key_0", &entry));
+  EXPECT_TRUE(cache.ReadEntry("key_10", &entry));
+}
@@ -155,3 +155,29 @@ TEST(ConfigSearcher, TestReduceDemo) {
                           "GetConfigs function gets wrong tree_reduce_num"));
   }
 }
+
+TEST(ConfigSearcher, TestX86TileConfig) {
+  const auto target = cinn::common::DefaultHostTarget();
+  cinn::ir::BucketInfo bucket_info(
+      1, cinn::ir::kMaxNumel, 1, cinn::ir::kMaxNumel, true, false);
+  cinn::ir::IterSpaceType iter_space_type = {std::make_pair("S", "dynamic"),
+                                             std::make_pair("R", "static")};
+
+  cinn::ir::ScheduleConfig::TileConfig tile_config;
+  tile_config.tree_reduce_num = 4;
+  tile_config.vectorize_width = 16;
+  tile_config.parallel_grain = 512;
+  cinn::ir::FileTileConfigDatabase file_database;
+  file_database.AddConfig(target, bucket_info, tile_config, 2);
+  cinn::ir::TileConfigMap tile_config_map =
+      file_database.GetConfigs(target, iter_space_type);
+  RemoveDir(target, iter_space_type);
+
+  // Buckets read from the file database have the priority of best configs.
+  bucket_info.bucket_priority = 0;
+  ASSERT_EQ(tile_config_map.count(bucket_info), 1);
+  const auto& read_config = tile_config_map.at(bucket_info);
+  EXPECT_EQ(read_config.tree_reduce_num, tile_config.tree_reduce_num);
+  EXPECT_EQ(read_config.vectorize_width, tile_config.vectorize_width);
+  EXPECT_EQ(read_config.parallel_grain, tile_config.parallel_grain);
+}
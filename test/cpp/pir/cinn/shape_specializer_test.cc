@@ -0,0 +1,271 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/op_lowering_group.h"
+#include "paddle/cinn/hlir/framework/pir/shape_specializer.h"
+#include "paddle/cinn/hlir/framework/pir/shape_variant_set.h"
+#include "paddle/cinn/hlir/framework/pir/utils.h"
+#include "paddle/cinn/hlir/framework/pir_compiler.h"
+#include "paddle/cinn/runtime/cinn_runtime.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+#include "paddle/pir/include/dialect/shape/utils/shape_analysis.h"
+
+PD_DECLARE_int32(cinn_max_shape_specializations);
+
+using cinn::hlir::framework::ShapeSpecializer;
+using cinn::hlir::framework::ShapeVariantSet;
+using cinn::hlir::framework::pir::CINNKernelInfo;
+using cinn::hlir::framework::pir::OpLoweringGroup;
+using cinn::hlir::framework::pir::OpLoweringGroupPtr;
+
+namespace {
+
+struct GroupInfo {
+  std::shared_ptr<::pir::Program> program;
+  OpLoweringGroupPtr group;
+  std::vector<::pir::Value> inputs;
+};
+
+// exp -> relu of a tensor of shape [S0, 128].
+GroupInfo BuildDynamicGroup(const std::string& fn_name) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  GroupInfo info;
+  info.program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, info.program->block());
+
+  auto x = builder
+               .Build<paddle::dialect::DataOp>("x",
+                                               std::vector<int64_t>{-1, 128},
+                                               phi::DataType::FLOAT32,
+                                               phi::CPUPlace())
+               .result(0);
+  auto exp = builder.Build<paddle::dialect::ExpOp>(x);
+  auto relu = builder.Build<paddle::dialect::ReluOp>(exp->result(0));
+  const auto ops =
+      std::vector<::pir::Operation*>({exp.operation(), relu.operation()});
+  info.group = std::make_shared<OpLoweringGroup>(ops, fn_name);
+  info.group->mut_output_values().push_back(relu->result(0));
+  info.inputs = {x};
+
+  const symbol::ShapeOrDataDimExprs shape{symbol::TensorShapeOrDataDimExprs(
+      {symbol::DimExpr("S0"), symbol::DimExpr(128)})};
+  auto& shape_analysis =
+      ::pir::ShapeAnalysisManager::Instance().Get(info.program.get());
+  for (auto value : {x, exp->result(0), relu->result(0)}) {
+    info.group->SetShapeOrDataExprs(value, shape);
+    shape_analysis.SetShapeOrDataForValue(value, shape);
+  }
+  return info;
+}
+
+// Runs the kernel of the group built by BuildDynamicGroup on the host.
+std::vector<float> RunOnHost(const CINNKernelInfo& kernel_info,
+                             const std::vector<float>& x) {
+  const int64_t rows = x.size() / 128;
+  const std::vector<std::vector<int64_t>> dims = {{rows, 128}, {rows, 128}};
+  std::vector<float> out(x.size());
+  std::vector<cinn_buffer_t> buffers(2);
+  buffers[0].memory = reinterpret_cast<uint8_t*>(const_cast<float*>(x.data()));
+  buffers[1].memory = reinterpret_cast<uint8_t*>(out.data());
+  std::vector<cinn_pod_value_t> args;
+  for (auto& buffer : buffers) {
+    args.emplace_back(&buffer);
+  }
+  for (const auto& int_arg : kernel_info.int_args_map) {
+    args.emplace_back(dims[int_arg.second.arg_idx][int_arg.second.dim_idx]);
+  }
+  using KernelFunc = void (*)(void*, int32_t, void*);
+  reinterpret_cast<KernelFunc>(kernel_info.fn_ptr)(
+      static_cast<void*>(args.data()), args.size(), nullptr);
+  return out;
+}
+
+CINNKernelInfo MakeKernelInfo(const std::string& fn_name) {
+  CINNKernelInfo kernel_info;
+  kernel_info.fn_name = fn_name;
+  return kernel_info;
+}
+
+}  // namespace
+
+TEST(ShapeSpecializer, RegisterDynamicGroup) {
+  FLAGS_cinn_max_shape_specializations = 0;
+  auto disabled = BuildDynamicGroup("fn_disabled");
+  ShapeSpecializer::Instance().Register(
+      disabled.group, disabled.inputs, MakeKernelInfo("fn_disabled"));
+  EXPECT_FALSE(ShapeSpecializer::Instance().IsRegistered("fn_disabled"));
+
+  FLAGS_cinn_max_shape_specializations = 2;
+  auto info = BuildDynamicGroup("fn_dynamic");
+  ShapeSpecializer::Instance().Register(
+      info.group, info.inputs, MakeKernelInfo("fn_dynamic"));
+  EXPECT_TRUE(ShapeSpecializer::Instance().IsRegistered("fn_dynamic"));
+  // The registered group is a copy, the origin program may go away.
+  info.program.reset();
+
+  // Dim 1 of the input is 128 in the group.
+  EXPECT_FALSE(ShapeSpecializer::Instance()
+                   .Specialize("fn_dynamic", {{64, 256}})
+                   .has_value());
+  EXPECT_FALSE(ShapeSpecializer::Instance()
+                   .Specialize("fn_dynamic", {{64, 128, 1}})
+                   .has_value());
+  EXPECT_FALSE(ShapeSpecializer::Instance()
+                   .Specialize("fn_unknown", {{64, 128}})
+                   .has_value());
+}
+
+TEST(ShapeSpecializer, SpecializeInBackground) {
+  FLAGS_cinn_max_shape_specializations = 2;
+  auto info = BuildDynamicGroup("fn_background");
+  ShapeSpecializer::Instance().Register(
+      info.group, info.inputs, MakeKernelInfo("fn_background"));
+  ASSERT_TRUE(ShapeSpecializer::Instance().IsRegistered("fn_background"));
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::optional<CINNKernelInfo>> results;
+  const auto Done = [&](const std::optional<CINNKernelInfo>& kernel_info) {
+    std::lock_guard<std::mutex> guard(mutex);
+    results.push_back(kernel_info);
+    cv.notify_one();
+  };
+  ShapeSpecializer::Instance().SpecializeAsync(
+      "fn_background", {{64, 128}}, Done);
+  ShapeSpecializer::Instance().SpecializeAsync(
+      "fn_background", {{64, 256}}, Done);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  cv.wait(lock, [&] { return results.size() == 2; });
+  ASSERT_TRUE(results[0].has_value());
+  EXPECT_NE(results[0]->fn_name, "fn_background");
+  EXPECT_NE(results[0]->infer_shape_fn_ptr, nullptr);
+  // The variant has no symbolic dim to read from the inputs.
+  EXPECT_TRUE(results[0]->int_args_map.empty());
+  EXPECT_FALSE(results[1].has_value());
+}
+
+TEST(ShapeSpecializer, VariantMatchesDynamicKernel) {
+  const auto target = cinn::common::DefaultDeviceTarget();
+  if (!(target == cinn::common::DefaultHostTarget())) {
+    GTEST_SKIP() << "The kernels are run on the host.";
+  }
+  FLAGS_cinn_max_shape_specializations = 2;
+  auto info = BuildDynamicGroup("fn_compare");
+  // Registered first, compiling the group may erase its ops.
+  ShapeSpecializer::Instance().Register(
+      info.group, info.inputs, MakeKernelInfo("fn_compare"));
+  cinn::hlir::framework::PirCompiler pir_compiler(target);
+  const CINNKernelInfo dynamic_kernel = pir_compiler.Build({info.group})[0];
+  const auto variant_kernel =
+      ShapeSpecializer::Instance().Specialize("fn_compare", {{64, 128}});
+  ASSERT_TRUE(variant_kernel.has_value());
+
+  std::vector<float> x(64 * 128);
+  for (size_t i = 0; i < x.size(); ++i) {
+    x[i] = static_cast<float>(i % 17) * 0.25f - 2.0f;
+  }
+  const auto expected = RunOnHost(dynamic_kernel, x);
+  const auto actual = RunOnHost(variant_kernel.value(), x);
+  for (size_t i = 0; i < x.size(); ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 1e-5) << "at " << i;
+  }
+}
+
+// ShapeVariantSet is how CinnJitInstruction selects and installs variants.
+TEST(ShapeVariantSet, SelectAndInstall) {
+  using VariantSet = ShapeVariantSet<int>;
+  VariantSet variants(/* max_variants = */ 2, /* threshold = */ 3);
+  std::vector<VariantSet::Signature> requests;
+  const auto Request = [&](const VariantSet::Signature& signature) {
+    requests.push_back(signature);
+  };
+  const VariantSet::Signature hot{2, 64, 128};
+  const VariantSet::Signature failed{2, 32, 128};
+  const VariantSet::Signature cold{2, 16, 128};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(variants.Select(hot, Request), nullptr);
+    EXPECT_EQ(variants.Select(failed, Request), nullptr);
+  }
+  EXPECT_EQ(variants.Select(cold, Request), nullptr);
+  // Each hot shape is requested once, on its third run.
+  ASSERT_EQ(requests.size(), 2UL);
+  EXPECT_EQ(requests[0], hot);
+  EXPECT_EQ(requests[1], failed);
+  EXPECT_EQ(variants.num_requested(), 2);
+
+  // Finished on the compile thread, installed by the next Select.
+  std::thread([&] {
+    variants.Finish(hot, std::make_shared<int>(1));
+    variants.Finish(failed, nullptr);
+  }).join();
+  EXPECT_EQ(variants.size(), 0UL);
+  const auto kernel = variants.Select(hot, Request);
+  ASSERT_NE(kernel, nullptr);
+  EXPECT_EQ(*kernel, 1);
+  EXPECT_EQ(variants.size(), 1UL);
+  EXPECT_EQ(variants.num_requested(), 0);
+
+  // A shape that failed to compile is not requested again.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(variants.Select(failed, Request), nullptr);
+  }
+  EXPECT_EQ(requests.size(), 2UL);
+
+  // The runs of cold were not counted while no variant could be requested.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(variants.Select(cold, Request), nullptr);
+  }
+  ASSERT_EQ(requests.size(), 3UL);
+  variants.Finish(cold, std::make_shared<int>(3));
+  EXPECT_NE(variants.Select(cold, Request), nullptr);
+  EXPECT_EQ(variants.size(), 2UL);
+
+  // No more shapes are requested once max_variants are kept.
+  const VariantSet::Signature other{2, 8, 128};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(variants.Select(other, Request), nullptr);
+  }
+  EXPECT_EQ(requests.size(), 3UL);
+}
+
+// Runs last, it drops the groups registered by the other tests.
+TEST(ShapeSpecializer, DropOldestEntry) {
+  FLAGS_cinn_max_shape_specializations = 2;
+  for (size_t i = 0; i <= ShapeSpecializer::kMaxEntries; ++i) {
+    const std::string fn_name = "fn_entry_" + std::to_string(i);
+    auto info = BuildDynamicGroup(fn_name);
+    ShapeSpecializer::Instance().Register(
+        info.group, info.inputs, MakeKernelInfo(fn_name));
+    ASSERT_TRUE(ShapeSpecializer::Instance().IsRegistered(fn_name));
+  }
+  EXPECT_FALSE(ShapeSpecializer::Instance().IsRegistered("fn_entry_0"));
+  EXPECT_TRUE(ShapeSpecializer::Instance().IsRegistered("fn_entry_1"));
+}
@@ -0,0 +1,167 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compiles several groups of a program for x86 on the compile threads, which
+// lower all the groups before the backend compiles any of them, while one of
+// the groups is linked from the on-disk compile cache. The kernels must
+// compute the same as the groups compiled one by one without any cache.
+
+#include <glog/logging.h>
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "paddle/cinn/common/target.h"
+#include "paddle/cinn/hlir/framework/pir/compilation_cache.h"
+#include "paddle/cinn/hlir/framework/pir/disk_compilation_cache.h"
+#include "paddle/cinn/ir/group_schedule/search/measurer.h"
+#include "paddle/common/flags.h"
+#include "paddle/fluid/pir/dialect/operator/ir/op_dialect.h"
+#include "paddle/fluid/pir/dialect/operator/ir/pd_op.h"
+#include "paddle/pir/include/core/ir_context.h"
+#include "paddle/pir/include/core/program.h"
+
+PHI_DECLARE_bool(enable_cinn_compile_cache);
+PD_DECLARE_string(cinn_compile_cache_dir);
+PD_DECLARE_int64(cinn_compile_thread_num);
+
+namespace {
+
+using cinn::hlir::framework::CompilationCache;
+using cinn::hlir::framework::DiskCompilationCache;
+
+const std::vector<int64_t> kXShape = {37, 131};
+const std::vector<int64_t> kYShape = {64, 256};
+const std::vector<int64_t> kZShape = {96, 48};
+
+::pir::Value Data(::pir::Builder* builder,
+                  const std::string& name,
+                  const std::vector<int64_t>& shape) {
+  return builder
+      ->Build<paddle::dialect::DataOp>(
+          name, shape, phi::DataType::FLOAT32, phi::CPUPlace())
+      .result(0);
+}
+
+::pir::Value Sum(::pir::Builder* builder, ::pir::Value x, int64_t axis) {
+  return builder
+      ->Build<paddle::dialect::SumOp>(
+          x, std::vector<int64_t>{axis}, phi::DataType::FLOAT32, true)
+      .result(0);
+}
+
+// The row sum of x, which is the group of the program compiled first. With
+// `all_groups`, also an elementwise op of y and the column sum of z, which
+// are separate groups.
+std::shared_ptr<::pir::Program> BuildProgram(bool all_groups) {
+  ::pir::IrContext* ctx = ::pir::IrContext::Instance();
+  ctx->GetOrRegisterDialect<paddle::dialect::OperatorDialect>();
+  auto program = std::make_shared<::pir::Program>(ctx);
+  ::pir::Builder builder = ::pir::Builder(ctx, program->block());
+
+  auto x = Data(&builder, "x", kXShape);
+  builder.Build<paddle::dialect::FetchOp>(Sum(&builder, x, -1), "row_sum", 0);
+  if (all_groups) {
+    auto y = Data(&builder, "y", kYShape);
+    auto z = Data(&builder, "z", kZShape);
+    auto relu = builder
+                    .Build<paddle::dialect::ReluOp>(
+                        builder.Build<paddle::dialect::ExpOp>(y).result(0))
+                    .result(0);
+    builder.Build<paddle::dialect::FetchOp>(relu, "relu", 1);
+    builder.Build<paddle::dialect::FetchOp>(Sum(&builder, z, 0), "col_sum", 2);
+  }
+  return program;
+}
+
+using Outputs = std::unordered_map<std::string, std::vector<float>>;
+
+// Compiles and runs the program with all the groups.
+Outputs CompileAndRun(::pir::Program* program) {
+  const std::unordered_map<std::string, std::vector<int64_t>> shapes = {
+      {"x", kXShape}, {"y", kYShape}, {"z", kZShape}};
+  cinn::ir::search::Measurer measurer(program,
+                                      cinn::common::DefaultHostTarget());
+  measurer.Compile();
+  measurer.Run(shapes, /* repeat = */ 1);
+  Outputs outputs;
+  for (const std::string name : {"row_sum", "relu", "col_sum"}) {
+    const phi::DenseTensor& out = measurer.HostOutput(name);
+    const float* data = out.data<float>();
+    outputs[name] = std::vector<float>(data, data + out.numel());
+  }
+  return outputs;
+}
+
+void ExpectEqual(const Outputs& expected, const Outputs& actual) {
+  for (const auto& [name, values] : expected) {
+    ASSERT_EQ(actual.at(name).size(), values.size()) << name;
+    for (size_t i = 0; i < values.size(); ++i) {
+      ASSERT_EQ(actual.at(name)[i], values[i]) << name << " at " << i;
+    }
+  }
+}
+
+// As in a new process, only the disk holds the kernels.
+void ClearProcessCaches() {
+  CompilationCache::Instance().Clear();
+  DiskCompilationCache::Instance().ClearLoaded();
+}
+
+}  // namespace
+
+TEST(TwoStageCompile, DiskHitsMixedWithMisses) {
+  if (!(cinn::common::DefaultDeviceTarget() ==
+        cinn::common::DefaultHostTarget())) {
+    GTEST_SKIP() << "The cache only holds x86 kernels.";
+  }
+  char dir[] = "/tmp/cinn_two_stage_compile_XXXXXX";
+  ASSERT_NE(mkdtemp(dir), nullptr);
+  // Read once by the first DiskCompilationCache::Instance.
+  FLAGS_cinn_compile_cache_dir = dir;
+  auto& disk_cache = DiskCompilationCache::Instance();
+  ASSERT_EQ(disk_cache.cache_dir(), std::string(dir));
+  FLAGS_cinn_compile_thread_num = 3;
+
+  auto program = BuildProgram(/* all_groups = */ true);
+  // Without the cache the groups are compiled one by one, on one thread.
+  FLAGS_enable_cinn_compile_cache = false;
+  ASSERT_FALSE(disk_cache.IsEnabled(cinn::common::DefaultHostTarget()));
+  const Outputs expected = CompileAndRun(program.get());
+
+  FLAGS_enable_cinn_compile_cache = true;
+  ASSERT_TRUE(disk_cache.IsEnabled(cinn::common::DefaultHostTarget()));
+  auto row_sum_program = BuildProgram(/* all_groups = */ false);
+  cinn::ir::search::Measurer row_sum(row_sum_program.get(),
+                                     cinn::common::DefaultHostTarget());
+  row_sum.Compile();
+  row_sum.Run({{"x", kXShape}}, /* repeat = */ 1);
+  ASSERT_EQ(disk_cache.disk_hits(), 0);
+  ASSERT_GT(disk_cache.cached_bytes(), 0);
+
+  // The row sum is linked from the disk, the two other groups are lowered
+  // and then compiled by the backend on the compile threads.
+  ClearProcessCaches();
+  ExpectEqual(expected, CompileAndRun(program.get()));
+  EXPECT_EQ(disk_cache.disk_hits(), 1);
+
+  // All the groups compiled in parallel were written to the disk.
+  ClearProcessCaches();
+  ExpectEqual(expected, CompileAndRun(program.get()));
+  EXPECT_EQ(disk_cache.disk_hits(), 4);
+}
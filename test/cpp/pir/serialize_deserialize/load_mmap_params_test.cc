@@ -0,0 +1,75 @@
+// Copyright (c) 2024 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/io/mmap_params.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/pir/serialize_deserialize/include/interface.h"
+
+TEST(load_combine_function, mmap_params) {
+  phi::CPUPlace place;
+  std::vector<phi::DenseTensor> tensors(2);
+  tensors[0].Resize({3, 5});
+  float* data0 = tensors[0].mutable_data<float>(place);
+  for (int i = 0; i < 15; ++i) {
+    data0[i] = static_cast<float>(i) * 0.5f;
+  }
+  tensors[1].Resize({7});
+  int64_t* data1 = tensors[1].mutable_data<int64_t>(place);
+  for (int i = 0; i < 7; ++i) {
+    data1[i] = i * 1000000007LL;
+  }
+
+  const std::string params_file = "load_mmap_params_test.pdiparams";
+  const std::string mmap_file = "load_mmap_params_test.mmap.pdiparams";
+  {
+    std::ofstream fout(params_file, std::ios::binary);
+    for (auto& tensor : tensors) {
+      paddle::framework::SerializeToStream(fout, tensor);
+    }
+  }
+  paddle::framework::ConvertToMmapParams(params_file, mmap_file);
+
+  // Both files load to the same tensors.
+  for (const auto& file : {params_file, mmap_file}) {
+    std::vector<phi::DenseTensor> loaded(2);
+    std::vector<phi::DenseTensor*> out = {&loaded[0], &loaded[1]};
+    pir::LoadCombineFunction(file, {"w0", "w1"}, &out, false, place);
+    ASSERT_EQ(loaded[0].dims(), tensors[0].dims()) << file;
+    ASSERT_EQ(loaded[0].dtype(), phi::DataType::FLOAT32) << file;
+    for (int i = 0; i < 15; ++i) {
+      EXPECT_EQ(loaded[0].data<float>()[i], data0[i]) << file;
+    }
+    ASSERT_EQ(loaded[1].dtype(), phi::DataType::INT64) << file;
+    for (int i = 0; i < 7; ++i) {
+      EXPECT_EQ(loaded[1].data<int64_t>()[i], data1[i]) << file;
+    }
+  }
+
+  std::vector<phi::DenseTensor> fp16(2);
+  std::vector<phi::DenseTensor*> fp16_out = {&fp16[0], &fp16[1]};
+  pir::LoadCombineFunction(mmap_file, {"w0", "w1"}, &fp16_out, true, place);
+  EXPECT_EQ(fp16[0].dtype(), phi::DataType::FLOAT16);
+
+  // The file has two tensors.
+  std::vector<phi::DenseTensor> one(1);
+  std::vector<phi::DenseTensor*> one_out = {&one[0]};
+  EXPECT_ANY_THROW(
+      pir::LoadCombineFunction(mmap_file, {"w0"}, &one_out, false, place));
+}
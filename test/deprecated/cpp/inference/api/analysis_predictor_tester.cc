@@ -20,7 +20,9 @@
 #include <glog/logging.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -455,6 +457,44 @@ TEST(Predictor, Run) {
   predictor->TryShrinkMemory();
 }
 
+TEST(PredictorPool, AcquireRelease) {
+  Config config;
+  config.SetModel(FLAGS_dirname);
+  config.EnableMemoryOptim();
+  services::PredictorPool pool(config, 2);
+  ASSERT_EQ(pool.Size(), 2UL);
+  EXPECT_GT(pool.ActivationBytes(), 0);
+
+  // More threads than predictors share the pool.
+  std::vector<std::thread> threads;
+  std::atomic<int> runs{0};
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&pool, &runs]() {
+      for (int i = 0; i < 4; ++i) {
+        auto* predictor = pool.Acquire();
+        for (auto& name : {"firstw", "secondw", "thirdw", "forthw"}) {
+          auto input = predictor->GetInputHandle(name);
+          input->Reshape({4, 1});
+          std::vector<int64_t> data = {0, 1, 2, 3};
+          input->CopyFromCpu(data.data());
+        }
+        if (predictor->Run()) {
+          ++runs;
+        }
+        pool.Release(predictor);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(runs, 32);
+
+  auto* predictor = pool.Acquire();
+  pool.Release(predictor);
+  ASSERT_ANY_THROW(pool.Release(predictor));
+}
+
 TEST(Predictor, EnableONNXRuntime) {
   Config config;
   config.SetModel(FLAGS_dirname);